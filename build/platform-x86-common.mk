@@ -19,5 +19,8 @@ ifeq ($(USE_ASM),Yes)
 CFLAGS += -DX86_ASM
 ASM_ARCH = x86
 endif
+ifeq ($(USE_INTRINSICS),Yes)
+CFLAGS += -DX86_INTRINSICS
+endif
 ASM = nasm
 ASMFLAGS += $(ASMFLAGS_PLATFORM)
@@ -54,7 +54,7 @@ typedef unsigned char bool;
 class ISVCEncoder {
  public:
   /*
-   * return: CM_RETURN: 0 - success; otherwise - failed;
+   * return: CM_RETURN: 0 - success; cmOutputPending - get encoded frames before reinitializing; otherwise - failed;
    */
   virtual int EXTAPI Initialize (const SEncParamBase* pParam) = 0;
   virtual int EXTAPI InitializeExt (const SEncParamExt* pParam) = 0;
@@ -86,10 +86,24 @@ class ISVCEncoder {
    * InDataFormat, IDRInterval, SVC Encode Param, Frame Rate, Bitrate,..
    ************************************************************************/
   /*
-   * return: CM_RETURN: 0 - success; otherwise - failed;
+   * return: CM_RETURN: 0 - success; cmOutputPending - get encoded frames before a reset of the encoder; otherwise - failed;
    */
   virtual int EXTAPI SetOption (ENCODER_OPTION eOptionId, void* pOption) = 0;
   virtual int EXTAPI GetOption (ENCODER_OPTION eOptionId, void* pOption) = 0;
+
+  /*
+   * pipelined encoding: SubmitFrame() copies and preprocesses the picture while an internal thread codes the
+   * frames submitted before, GetEncodedFrame() returns their bitstreams in order, identical to EncodeFrame();
+   * other methods wait until the frames submitted so far are coded
+   * return: CM_RETURN: 0 - success; cmOutputPending - get encoded frames before submitting more; otherwise - failed;
+   */
+  virtual int EXTAPI SubmitFrame (const SSourcePicture* kpSrcPic) = 0;
+  /*
+   * pBsInfo stays valid until the next call, its eOutputFrameType is videoFrameTypeInvalid when no frame is returned:
+   * none submitted, or the oldest one is still being coded and bWait is false
+   * return: result of encoding the returned frame as for EncodeFrame()
+   */
+  virtual int EXTAPI GetEncodedFrame (SFrameBSInfo* pBsInfo, bool bWait) = 0;
 };
 
 class ISVCDecoder {
@@ -155,6 +169,9 @@ struct ISVCEncoderVtbl {
 
   int (*SetOption) (ISVCEncoder*, ENCODER_OPTION eOptionId, void* pOption);
   int (*GetOption) (ISVCEncoder*, ENCODER_OPTION eOptionId, void* pOption);
+
+  int (*SubmitFrame) (ISVCEncoder*, const SSourcePicture* kpSrcPic);
+  int (*GetEncodedFrame) (ISVCEncoder*, SFrameBSInfo* pBsInfo, bool bWait);
 };
 
 typedef struct ISVCDecoderVtbl ISVCDecoderVtbl;
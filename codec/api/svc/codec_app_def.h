@@ -92,7 +92,9 @@ typedef enum {
 
   ENCODER_OPTION_CURRENT_PATH,
   ENCODER_OPTION_DUMP_FILE,
-  ENCODER_OPTION_TRACE_LEVEL
+  ENCODER_OPTION_TRACE_LEVEL,
+  ENCODER_OPTION_MEMORY_USAGE,	// get only, SMemoryUsage of the encoder instance
+  ENCODER_OPTION_ZERO_COPY_SOURCE	// SZeroCopySource, source pictures referenced instead of copied, set after initialization
 } ENCODER_OPTION;
 
 /* Option types introduced in decoder application */
@@ -106,6 +108,11 @@ typedef enum {
   DECODER_OPTION_LTR_MARKING_FLAG,	// feedback wether current frame mark a LTR
   DECODER_OPTION_LTR_MARKED_FRAME_NUM,	// feedback frame num marked by current Frame
   DECODER_OPTION_ERROR_CON_IDC, //not finished yet, indicate decoder error concealment status, in progress
+  DECODER_OPTION_ZERO_COPY_INPUT,	// parse NALs without emulation prevention bytes in the input buffer itself, which the
+  // application then keeps unchanged until the first NAL of the next access unit or the end of stream has been passed
+  // to the decoder; nothing past the end of the buffer is read
+  DECODER_OPTION_MEMORY_USAGE,	// get only, SMemoryUsage of the decoder instance
+  DECODER_OPTION_BUFFER_PROVIDER,	// SPictureBufferProvider the frames are reconstructed into, set before decoding starts
 
 } DECODER_OPTION;
 
@@ -312,6 +319,9 @@ typedef struct TagEncParamExt
   bool    bEnableAdaptiveQuant; // adaptive quantization control
   bool	  bEnableFrameCroppingFlag;// enable frame cropping flag: TRUE always in application
   bool    bEnableSceneChangeDetect;
+
+  bool    bParallelSpatialLayers; // code the spatial layers of a frame concurrently, each without inter-layer prediction; camera video without LTR only
+  bool    bEnableHierarchicalMe; // seed the motion search from the next lower spatial layer, or from a half resolution search in single layer
 }SEncParamExt;
 
 //Define a new struct to show the property of video bitstream.
@@ -324,13 +334,23 @@ typedef struct {
 typedef struct TagSVCDecodingParam {
   char*		pFileNameRestructed;	// File name of restructed frame used for PSNR calculation based debug
 
-  int				iOutputColorFormat;	// color space format to be outputed, EVideoFormatType specified in codec_def.h
+  int				iOutputColorFormat;	// color space format to be outputed, EVideoFormatType specified in codec_def.h:
+  // videoFormatI420 (or videoFormatInternal), videoFormatNV12, videoFormatRGBA or videoFormatBGRA
   unsigned int	uiCpuLoad;		// CPU load
   unsigned char	uiTargetDqLayer;	// Setting target dq layer id
 
   unsigned char	uiEcActiveFlag;		// Whether active error concealment feature in decoder
 
   SVideoProperty   sVideoProperty;
+
+  int				iThreadCount;		// reconstruction threads for frame level parallel decoding, 0 or 1 decodes in caller thread
+  int				iRowThreadCount;	// threads reconstructing MB rows of a slice as a wavefront, 0 or 1 disables
+  int				iSliceThreadCount;	// threads decoding the slices of a picture concurrently, 0 or 1 disables
+  bool			bPipelineDeblocking;	// deblock and pad each MB row once the row below is reconstructed
+  int				iMaxWidth;		// picture buffers are sized for at least iMaxWidth x iMaxHeight, resolution changes within
+  int				iMaxHeight;		// it reuse them; 0 sizes them to the largest resolution decoded so far
+  int				iOutputWidth;	// frames are output downscaled to iOutputWidth x iOutputHeight, 0 outputs the cropped size;
+  int				iOutputHeight;	// I420 and NV12 get even sizes, the size is never larger than the cropped frame
 } SDecodingParam, *PDecodingParam;
 
 /* Bitstream inforamtion of a layer being encoded */
@@ -378,4 +398,40 @@ typedef struct Dump_Layer_s{
 	int iLayer;
 	char *pFileName;
 }SDumpLayer;
+
+/* Memory allocated by a codec instance, in bytes */
+typedef struct {
+  unsigned int uiCurrentBytes;	// blocks in use
+  unsigned int uiPeakBytes;	// highest uiCurrentBytes since initialization
+  unsigned int uiIdleBytes;	// freed blocks kept for reuse, e.g. by a re-initialization at the same resolution
+} SMemoryUsage;
+
+/*
+ * Picture buffers supplied by the application: every frame is reconstructed into a buffer of pGetBuffer() and output
+ * from there without a copy. The decoder holds one reference to each buffer it got and drops it with pReleaseBuffer()
+ * once the frame left the DPB; the application keeps the frames it was given by reference counting its buffers, so a
+ * buffer is only reused after the decoder and the application released it.
+ */
+typedef struct {
+  void* pCtx;	// passed to the callbacks
+  /* iSize bytes, 16 byte aligned, for the padded planes of a frame, or NULL on failure; *ppOpaque may be set to a
+   * handle, which is passed back with the buffer and given in SBufferInfo::pOpaque of the frame output from it */
+  void* (*pGetBuffer) (void* pCtx, int iSize, void** ppOpaque);
+  void (*pReleaseBuffer) (void* pCtx, void* pBuffer, void* pOpaque);
+} SPictureBufferProvider;
+
+/*
+ * Source pictures coded from the planes of the application instead of a copy. An I420 picture is referenced when it
+ * has the size of the highest spatial layer, both multiples of 16, the strides of iStride[], 16 byte aligned planes and
+ * iPadding (luma, iPadding / 2 chroma) readable samples around them, and neither scaling, cropping nor denoising is
+ * done; any other picture is copied as before. Every picture given to the encoder is passed back to pReleaseSource()
+ * by its pData[0], right after the copy or once the encoder neither codes nor analyses against it any more, which is
+ * when a later picture takes its place or the encoder is uninitialized; the planes must stay unchanged until then.
+ */
+typedef struct {
+  void* pCtx;	// passed to pReleaseSource
+  void (*pReleaseSource) (void* pCtx, unsigned char* pData);	// NULL copies every picture
+  int iStride[2];	// get only: luma and chroma strides of a picture to be referenced
+  int iPadding;	// get only
+} SZeroCopySource;
 #endif//WELS_VIDEO_CODEC_APPLICATION_DEFINITION_H__
@@ -73,6 +73,7 @@ typedef enum {
   cmMallocMemeError,                /*Malloc a memory error*/
   cmInitExpected,			  /*Initial action is expected*/
   cmUnsupportedData,
+  cmOutputPending,			/*encoded frames are expected to be got before submitting more*/
 } CM_RETURN;
 
 /* nal unit type */
@@ -169,6 +170,7 @@ typedef struct TagBufferInfo {
   union {
     SSysMEMBuffer sSystemBuffer;
   } UsrData;
+  void* pOpaque;	// handle of the application buffer holding the frame, see DECODER_OPTION_BUFFER_PROVIDER
 } SBufferInfo;
 
 /* Constants related to transmission rate at various resolutions */
@@ -56,6 +56,7 @@ typedef    LPTHREAD_START_ROUTINE    LPWELS_THREAD_ROUTINE;
 
 typedef    CRITICAL_SECTION          WELS_MUTEX;
 typedef    HANDLE                    WELS_EVENT;
+typedef    CONDITION_VARIABLE        WELS_COND;
 
 #define    WELS_THREAD_ROUTINE_TYPE         DWORD  WINAPI
 #define    WELS_THREAD_ROUTINE_RETURN(rc)   return (DWORD)rc;
@@ -80,6 +81,7 @@ typedef  void* (*LPWELS_THREAD_ROUTINE) (void*);
 
 typedef   pthread_mutex_t           WELS_MUTEX;
 typedef   sem_t*                    WELS_EVENT;
+typedef   pthread_cond_t            WELS_COND;
 
 #define   WELS_THREAD_ROUTINE_TYPE         void *
 #define   WELS_THREAD_ROUTINE_RETURN(rc)   return (void*)(intptr_t)rc;
@@ -104,6 +106,12 @@ WELS_THREAD_ERROR_CODE    WelsMutexLock (WELS_MUTEX*    mutex);
 WELS_THREAD_ERROR_CODE    WelsMutexUnlock (WELS_MUTEX* mutex);
 WELS_THREAD_ERROR_CODE    WelsMutexDestroy (WELS_MUTEX* mutex);
 
+WELS_THREAD_ERROR_CODE    WelsCondInit (WELS_COND* cond);
+WELS_THREAD_ERROR_CODE    WelsCondDestroy (WELS_COND* cond);
+WELS_THREAD_ERROR_CODE    WelsCondWait (WELS_COND* cond, WELS_MUTEX* mutex);
+WELS_THREAD_ERROR_CODE    WelsCondSignal (WELS_COND* cond);
+WELS_THREAD_ERROR_CODE    WelsCondBroadcast (WELS_COND* cond);
+
 WELS_THREAD_ERROR_CODE    WelsEventOpen (WELS_EVENT* p_event, const char* event_name);
 WELS_THREAD_ERROR_CODE    WelsEventClose (WELS_EVENT* event, const char* event_name);
 WELS_THREAD_ERROR_CODE    WelsEventSignal (WELS_EVENT* event);
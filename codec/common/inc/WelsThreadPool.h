@@ -0,0 +1,96 @@
+/*!
+ * \copy
+ *     Copyright (c)  2014, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file	WelsThreadPool.h
+ *
+ * \brief	task based thread pool shared within the process, every worker owns a task queue and
+ *			steals from the queues of the others when its own one runs empty
+ *
+ * \date	10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#ifndef   _WELS_THREAD_POOL_H_
+#define   _WELS_THREAD_POOL_H_
+
+#include "typedefs.h"
+#include "WelsThreadLib.h"
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define    WELS_THREAD_POOL_MAX_THREADS		16
+#define    WELS_THREAD_POOL_QUEUE_SIZE		64	// tasks per worker queue, submitter runs the task itself when all are full
+
+typedef void (*PWelsTaskProc) (void* pArg);
+
+/* tasks to be waited for together, zero initialized before the first submission */
+typedef struct TagWelsTaskGroup {
+  int32_t		iPending;	// tasks submitted and not finished yet, guarded by the pool lock
+} SWelsTaskGroup;
+
+typedef struct TagWelsThreadPool SWelsThreadPool;
+
+/*!
+ * \brief	get a reference to the pool of the process, created on first use and grown to
+ *			kiThreadNum workers if it has less
+ * \return	the pool; NULL - no worker could be started
+ */
+SWelsThreadPool*          WelsThreadPoolAcquire (const int32_t kiThreadNum);
+
+/*!
+ * \brief	drop a reference, the last one stops the workers; every task group must have been waited for
+ */
+void                      WelsThreadPoolRelease (SWelsThreadPool* pPool);
+
+/*!
+ * \brief	workers running in the pool
+ */
+int32_t                   WelsThreadPoolThreadNum (SWelsThreadPool* pPool);
+
+/*!
+ * \brief	queue pProc (pArg) to be run by any worker
+ * \note	pProc may block only on the progress of tasks already running which do not call WelsThreadPoolWait()
+ */
+void                      WelsThreadPoolSubmit (SWelsThreadPool* pPool, SWelsTaskGroup* pGroup, PWelsTaskProc pProc,
+    void* pArg);
+
+/*!
+ * \brief	block until every task of pGroup is finished, running queued tasks in the calling thread meanwhile
+ */
+void                      WelsThreadPoolWait (SWelsThreadPool* pPool, SWelsTaskGroup* pGroup);
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif//_WELS_THREAD_POOL_H_
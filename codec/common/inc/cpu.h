@@ -48,7 +48,7 @@
 extern "C" {
 #endif//__cplusplus
 
-#if defined(X86_ASM)
+#if defined(X86_ASM) || defined(X86_INTRINSICS)
 /*
  *	cpuid support verify routine
  *  return 0 if cpuid is not supported by cpu
@@ -59,7 +59,9 @@ void WelsCPUId (uint32_t uiIndex, uint32_t* pFeatureA, uint32_t* pFeatureB, uint
 
 int32_t WelsCPUSupportAVX (uint32_t eax, uint32_t ecx);
 int32_t WelsCPUSupportFMA (uint32_t eax, uint32_t ecx);
+#endif//X86_ASM || X86_INTRINSICS
 
+#if defined(X86_ASM)
 void WelsEmms();
 
 /*
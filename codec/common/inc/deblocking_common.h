@@ -1,6 +1,7 @@
 #ifndef WELS_DEBLOCKING_COMMON_H__
 #define WELS_DEBLOCKING_COMMON_H__
 #include "typedefs.h"
+#include "macros.h"
 void DeblockLumaLt4V_c (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta, int8_t* pTc);
 void DeblockLumaEq4V_c (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta);
 
@@ -52,4 +53,21 @@ void DeblockChromaEq4H_neon(uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride, i
 }
 #endif//__cplusplus
 
+#if defined(X86_INTRINSICS)
+// intrinsics, selected when WELS_CPU_AVX2 is reported
+void DeblockLumaLt4V_avx2 (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta, int8_t* pTc);
+void DeblockLumaEq4V_avx2 (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta);
+void DeblockLumaLt4H_avx2 (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta, int8_t* pTc);
+void DeblockLumaEq4H_avx2 (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta);
+void DeblockChromaLt4V_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride, int32_t iAlpha, int32_t iBeta,
+                             int8_t* pTc);
+void DeblockChromaEq4V_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride, int32_t iAlpha, int32_t iBeta);
+void DeblockChromaLt4H_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride, int32_t iAlpha, int32_t iBeta,
+                             int8_t* pTc);
+void DeblockChromaEq4H_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride, int32_t iAlpha, int32_t iBeta);
+
+void DeblockingBSInsideMB_avx2 (const int8_t* pNnzTab, const int8_t* pRefIndex, const int16_t* pMv,
+                                uint8_t uiBS[2][4][4]);
+#endif//X86_INTRINSICS
+
 #endif //WELS_DEBLOCKING_COMMON_H__
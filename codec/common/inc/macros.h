@@ -88,6 +88,23 @@ __declspec(align(alignment)) type name[(sizex)*(sizey)]
 	type name[(sizex)*(sizey)] __attribute__((aligned(alignment)))
 #endif//_MSC_VER
 
+/*
+ * X86_INTRINSICS: SSE2/AVX2 routines written with compiler intrinsics, set by the build on x86 targets
+ * (USE_INTRINSICS) independently of the nasm routines (X86_ASM), and selected at run time via
+ * WELS_CPU_SSE2/WELS_CPU_AVX2
+ */
+#if defined(X86_INTRINSICS)
+#if defined(_MSC_VER)
+/* SSE2 and AVX2 intrinsics are usable without extra compiler flags */
+#define WELS_TARGET_SSE2
+#define WELS_TARGET_AVX2
+#else
+/* compile single routines for SSE2/AVX2 */
+#define WELS_TARGET_SSE2 __attribute__ ((target ("sse2")))
+#define WELS_TARGET_AVX2 __attribute__ ((target ("avx2")))
+#endif//_MSC_VER
+#endif//X86_INTRINSICS
+
 
 #ifndef	WELS_ALIGN
 #define WELS_ALIGN(x, n)	(((x)+(n)-1)&~((n)-1))
@@ -259,6 +276,9 @@ return r;
 #define BUTTERFLY4x8(dw) (((uint64_t)(dw)<<32) | (dw))
 #endif//BUTTERFLY4x8
 
+/* true when none of the 8 bytes of the 64 bits word is 0 */
+#define WELS_NO_ZERO_BYTE_64(x)	((((x) - 0x0101010101010101ULL) & ~(x) & 0x8080808080808080ULL) == 0)
+
 static inline bool WELS_POWER2_IF (uint32_t v) {
 return (v && ! (v & (v - 1)));
 }
@@ -30,17 +30,25 @@
  *
  */
 
-#if !defined(WELS_ENCODER_MEMORY_ALIGN_H__)
-#define WELS_ENCODER_MEMORY_ALIGN_H__
+#if !defined(WELS_COMMON_MEMORY_ALIGN_H__)
+#define WELS_COMMON_MEMORY_ALIGN_H__
 
 #include "typedefs.h"
-#include "as264_common.h"
+#include "WelsThreadLib.h"
 #ifdef MEMORY_CHECK
 #include <stdio.h>
 #endif//MEMORY_CHECK
 
-namespace WelsSVCEnc {
+struct TagIdleBlock;
 
+/*!
+ * \brief	cache line aligned allocator of a codec instance
+ *
+ * Big blocks (pictures, MB arrays) are not returned to the system when freed but kept
+ * idle to serve later requests of the same size class, so re-initializing the codec
+ * reuses memory that is already mapped. WelsReleaseIdleBlocks() gives them back once
+ * the new configuration has taken what it needs. All methods are thread safe.
+ */
 class CMemoryAlign {
  public:
 CMemoryAlign (const uint32_t kuiCacheLineSize);
@@ -49,8 +57,11 @@ virtual ~CMemoryAlign();
 void* WelsMallocz (const uint32_t kuiSize, const char* kpTag);
 void* WelsMalloc (const uint32_t kuiSize, const char* kpTag);
 void WelsFree (void* pPointer, const char* kpTag);
+void WelsReleaseIdleBlocks();
 const uint32_t WelsGetCacheLineSize() const;
-const uint32_t WelsGetMemoryUsage() const;
+const uint32_t WelsGetMemoryUsage() const;		// bytes of the blocks in use
+const uint32_t WelsGetPeakMemoryUsage() const;	// highest WelsGetMemoryUsage() so far
+const uint32_t WelsGetIdleMemoryUsage() const;	// bytes of the freed blocks kept for reuse
 
  private:
 // private copy & assign constructors adding to fix klocwork scan issues
@@ -59,10 +70,11 @@ CMemoryAlign& operator= (const CMemoryAlign& kcMa);
 
  protected:
 uint32_t	m_nCacheLineSize;
-
-#ifdef MEMORY_MONITOR
 uint32_t	m_nMemoryUsageInBytes;
-#endif//MEMORY_MONITOR
+uint32_t	m_nPeakMemoryUsageInBytes;
+uint32_t	m_nIdleMemoryInBytes;
+struct TagIdleBlock*	m_pIdleBlocks;
+mutable WELS_MUTEX	m_hMutex;
 
 #ifdef MEMORY_CHECK
 FILE*		m_fpMemChkPoint;
@@ -70,6 +82,4 @@ uint32_t	m_nCountRequestNum;
 #endif//MEMORY_CHECK
 };
 
-}
-
-#endif//WELS_ENCODER_MEMORY_ALIGN_H__
+#endif//WELS_COMMON_MEMORY_ALIGN_H__
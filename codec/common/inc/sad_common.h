@@ -34,6 +34,7 @@
 #define WELS_SAD_COMMON_H_
 
 #include "typedefs.h"
+#include "macros.h"
 
 
 //===================SAD=====================//
@@ -53,6 +54,19 @@ void WelsSampleSadFour8x16_c (uint8_t* iSample1, int32_t iStride1, uint8_t* iSam
 void WelsSampleSadFour8x8_c (uint8_t* iSample1, int32_t iStride1, uint8_t* iSample2, int32_t iStride2, int32_t* pSad);
 void WelsSampleSadFour4x4_c (uint8_t* iSample1, int32_t iStride1, uint8_t* iSample2, int32_t iStride2, int32_t* pSad);
 
+#if defined (X86_INTRINSICS)
+// intrinsics, selected when WELS_CPU_AVX2 is reported
+int32_t WelsSampleSad16x16_avx2 (uint8_t*, int32_t, uint8_t*, int32_t);
+int32_t WelsSampleSad16x8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t);
+int32_t WelsSampleSad8x16_avx2 (uint8_t*, int32_t, uint8_t*, int32_t);
+int32_t WelsSampleSad8x8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t);
+
+void WelsSampleSadFour16x16_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*);
+void WelsSampleSadFour16x8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*);
+void WelsSampleSadFour8x16_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*);
+void WelsSampleSadFour8x8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*);
+#endif//X86_INTRINSICS
+
 #if defined(__cplusplus)
 extern "C" {
 #endif//__cplusplus
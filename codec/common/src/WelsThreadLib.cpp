@@ -105,6 +105,36 @@ WELS_THREAD_ERROR_CODE    WelsMutexDestroy (WELS_MUTEX* mutex) {
   return WELS_THREAD_ERROR_OK;
 }
 
+WELS_THREAD_ERROR_CODE    WelsCondInit (WELS_COND* cond) {
+  InitializeConditionVariable (cond);
+
+  return WELS_THREAD_ERROR_OK;
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondDestroy (WELS_COND* cond) {
+  // nothing to release for condition variables on windows
+  return WELS_THREAD_ERROR_OK;
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondWait (WELS_COND* cond, WELS_MUTEX* mutex) {
+  if (SleepConditionVariableCS (cond, mutex, INFINITE))
+    return WELS_THREAD_ERROR_OK;
+
+  return WELS_THREAD_ERROR_GENERAL;
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondSignal (WELS_COND* cond) {
+  WakeConditionVariable (cond);
+
+  return WELS_THREAD_ERROR_OK;
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondBroadcast (WELS_COND* cond) {
+  WakeAllConditionVariable (cond);
+
+  return WELS_THREAD_ERROR_OK;
+}
+
 #else /* _WIN32 */
 
 WELS_THREAD_ERROR_CODE    WelsMutexInit (WELS_MUTEX*    mutex) {
@@ -123,6 +153,26 @@ WELS_THREAD_ERROR_CODE    WelsMutexDestroy (WELS_MUTEX* mutex) {
   return pthread_mutex_destroy (mutex);
 }
 
+WELS_THREAD_ERROR_CODE    WelsCondInit (WELS_COND* cond) {
+  return pthread_cond_init (cond, NULL);
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondDestroy (WELS_COND* cond) {
+  return pthread_cond_destroy (cond);
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondWait (WELS_COND* cond, WELS_MUTEX* mutex) {
+  return pthread_cond_wait (cond, mutex);
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondSignal (WELS_COND* cond) {
+  return pthread_cond_signal (cond);
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondBroadcast (WELS_COND* cond) {
+  return pthread_cond_broadcast (cond);
+}
+
 #endif /* !_WIN32 */
 
 #ifdef _WIN32
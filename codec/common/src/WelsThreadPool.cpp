@@ -0,0 +1,308 @@
+/*!
+ * \copy
+ *     Copyright (c)  2014, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file	WelsThreadPool.cpp
+ *
+ * \brief	task based thread pool shared within the process, every worker owns a task queue and
+ *			steals from the queues of the others when its own one runs empty
+ *
+ * \date	10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#include "macros.h"
+#include "WelsThreadPool.h"
+
+typedef struct TagWelsTask {
+  PWelsTaskProc		pProc;
+  void*				pArg;
+  SWelsTaskGroup*	pGroup;
+} SWelsTask;
+
+/* ring of tasks, the owner takes from the head and thieves from the tail */
+typedef struct TagWelsTaskQueue {
+  WELS_MUTEX		hLock;
+  SWelsTask			sTasks[WELS_THREAD_POOL_QUEUE_SIZE];
+  uint32_t			uiHead;
+  uint32_t			uiTail;
+} SWelsTaskQueue;
+
+struct TagWelsThreadPool {
+  WELS_THREAD_HANDLE	hThreads[WELS_THREAD_POOL_MAX_THREADS];
+  SWelsTaskQueue		sQueues[WELS_THREAD_POOL_MAX_THREADS];	// [i] owned by hThreads[i]
+  WELS_MUTEX			hLock;			// guards everything below and SWelsTaskGroup::iPending
+  int32_t				iThreadNum;		// only grows while workers run, changed under the process lock as well
+  WELS_COND			hTaskCond;		// signaled on new task or exit request
+  WELS_COND			hDoneCond;		// broadcast when a task group is finished
+  int32_t				iQueuedNum;		// tasks in the queues, might get below 0 for a moment
+  uint32_t			uiNextQueue;	// round robin for submissions
+  bool				bExit;
+
+  int32_t				iRefCount;		// guarded by the process lock
+};
+
+static SWelsThreadPool s_sThreadPool;
+
+#if defined(_WIN32)
+static volatile LONG s_lPoolProcessLock = 0;
+
+static void LockPoolProcess() {
+  while (InterlockedCompareExchange (&s_lPoolProcessLock, 1, 0) != 0)
+    Sleep (0);
+}
+
+static void UnlockPoolProcess() {
+  InterlockedExchange (&s_lPoolProcessLock, 0);
+}
+#else
+static pthread_mutex_t s_hPoolProcessLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void LockPoolProcess() {
+  pthread_mutex_lock (&s_hPoolProcessLock);
+}
+
+static void UnlockPoolProcess() {
+  pthread_mutex_unlock (&s_hPoolProcessLock);
+}
+#endif//_WIN32
+
+static bool PushTask (SWelsTaskQueue* pQueue, const SWelsTask* kpTask) {
+  bool bPushed = false;
+  WelsMutexLock (&pQueue->hLock);
+  if (pQueue->uiTail - pQueue->uiHead < WELS_THREAD_POOL_QUEUE_SIZE) {
+    pQueue->sTasks[pQueue->uiTail % WELS_THREAD_POOL_QUEUE_SIZE] = *kpTask;
+    ++ pQueue->uiTail;
+    bPushed = true;
+  }
+  WelsMutexUnlock (&pQueue->hLock);
+  return bPushed;
+}
+
+static bool PopTask (SWelsTaskQueue* pQueue, SWelsTask* pTask, const bool kbSteal) {
+  bool bPopped = false;
+  WelsMutexLock (&pQueue->hLock);
+  if (pQueue->uiTail != pQueue->uiHead) {
+    if (kbSteal) {
+      -- pQueue->uiTail;
+      *pTask = pQueue->sTasks[pQueue->uiTail % WELS_THREAD_POOL_QUEUE_SIZE];
+    } else {
+      *pTask = pQueue->sTasks[pQueue->uiHead % WELS_THREAD_POOL_QUEUE_SIZE];
+      ++ pQueue->uiHead;
+    }
+    bPopped = true;
+  }
+  WelsMutexUnlock (&pQueue->hLock);
+  return bPopped;
+}
+
+/* own queue first, then the others starting with the next one, kiSelf < 0 for threads out of the pool */
+static bool TakeTask (SWelsThreadPool* pPool, const int32_t kiSelf, SWelsTask* pTask) {
+  int32_t iThreadNum = 0;
+  int32_t iIdx = 0;
+  bool bTaken = false;
+
+  // the lock also makes the queue of a worker just added visible
+  WelsMutexLock (&pPool->hLock);
+  iThreadNum = pPool->iThreadNum;
+  WelsMutexUnlock (&pPool->hLock);
+
+  if (kiSelf >= 0)
+    bTaken = PopTask (&pPool->sQueues[kiSelf], pTask, false);
+  for (iIdx = 1; !bTaken && iIdx <= iThreadNum; iIdx++) {
+    const int32_t kiVictim = (WELS_MAX (kiSelf, 0) + iIdx) % iThreadNum;
+    if (kiVictim != kiSelf)
+      bTaken = PopTask (&pPool->sQueues[kiVictim], pTask, true);
+  }
+  if (bTaken) {
+    WelsMutexLock (&pPool->hLock);
+    -- pPool->iQueuedNum;
+    WelsMutexUnlock (&pPool->hLock);
+  }
+  return bTaken;
+}
+
+static void RunTask (SWelsThreadPool* pPool, const SWelsTask* kpTask) {
+  kpTask->pProc (kpTask->pArg);
+
+  WelsMutexLock (&pPool->hLock);
+  if (-- kpTask->pGroup->iPending == 0)
+    WelsCondBroadcast (&pPool->hDoneCond);
+  WelsMutexUnlock (&pPool->hLock);
+}
+
+static WELS_THREAD_ROUTINE_TYPE ThreadPoolWorkerProc (void* pArg) {
+  SWelsThreadPool* pPool = &s_sThreadPool;
+  const int32_t kiSelf = (int32_t) (intptr_t)pArg;
+  SWelsTask sTask;
+
+  for (;;) {
+    if (TakeTask (pPool, kiSelf, &sTask)) {
+      RunTask (pPool, &sTask);
+      continue;
+    }
+    WelsMutexLock (&pPool->hLock);
+    while (pPool->iQueuedNum <= 0 && !pPool->bExit)
+      WelsCondWait (&pPool->hTaskCond, &pPool->hLock);
+    const bool kbExit = pPool->bExit && pPool->iQueuedNum <= 0;
+    WelsMutexUnlock (&pPool->hLock);
+    if (kbExit)
+      break;
+  }
+  WELS_THREAD_ROUTINE_RETURN (0);
+}
+
+static void StopWorkers (SWelsThreadPool* pPool) {
+  int32_t iIdx = 0;
+
+  WelsMutexLock (&pPool->hLock);
+  pPool->bExit = true;
+  WelsCondBroadcast (&pPool->hTaskCond);
+  WelsMutexUnlock (&pPool->hLock);
+
+  for (iIdx = 0; iIdx < pPool->iThreadNum; iIdx++) {
+    WelsThreadJoin (pPool->hThreads[iIdx]);
+    WelsMutexDestroy (&pPool->sQueues[iIdx].hLock);
+  }
+  pPool->iThreadNum = 0;
+
+  WelsCondDestroy (&pPool->hDoneCond);
+  WelsCondDestroy (&pPool->hTaskCond);
+  WelsMutexDestroy (&pPool->hLock);
+}
+
+SWelsThreadPool* WelsThreadPoolAcquire (const int32_t kiThreadNum) {
+  SWelsThreadPool* pPool = &s_sThreadPool;
+  const int32_t kiWanted = WELS_CLIP3 (kiThreadNum, 1, WELS_THREAD_POOL_MAX_THREADS);
+
+  LockPoolProcess();
+  if (pPool->iRefCount == 0) {
+    pPool->iThreadNum = 0;
+    pPool->iQueuedNum = 0;
+    pPool->uiNextQueue = 0;
+    pPool->bExit = false;
+    WelsMutexInit (&pPool->hLock);
+    WelsCondInit (&pPool->hTaskCond);
+    WelsCondInit (&pPool->hDoneCond);
+  }
+  while (pPool->iThreadNum < kiWanted) {
+    const int32_t kiIdx = pPool->iThreadNum;
+    SWelsTaskQueue* pQueue = &pPool->sQueues[kiIdx];
+    pQueue->uiHead = pQueue->uiTail = 0;
+    WelsMutexInit (&pQueue->hLock);
+    if (WelsThreadCreate (&pPool->hThreads[kiIdx], ThreadPoolWorkerProc, (void*) (intptr_t)kiIdx, 0) != WELS_THREAD_ERROR_OK) {
+      WelsMutexDestroy (&pQueue->hLock);
+      break;
+    }
+    WelsMutexLock (&pPool->hLock);
+    ++ pPool->iThreadNum;
+    WelsMutexUnlock (&pPool->hLock);
+  }
+  if (pPool->iThreadNum == 0) {	// tasks would wait for their caller only, better fail
+    if (pPool->iRefCount == 0)
+      StopWorkers (pPool);
+    UnlockPoolProcess();
+    return NULL;
+  }
+  ++ pPool->iRefCount;
+  UnlockPoolProcess();
+  return pPool;
+}
+
+void WelsThreadPoolRelease (SWelsThreadPool* pPool) {
+  if (NULL == pPool)
+    return;
+  LockPoolProcess();
+  if (-- pPool->iRefCount == 0)
+    StopWorkers (pPool);
+  UnlockPoolProcess();
+}
+
+int32_t WelsThreadPoolThreadNum (SWelsThreadPool* pPool) {
+  int32_t iThreadNum = 0;
+  WelsMutexLock (&pPool->hLock);
+  iThreadNum = pPool->iThreadNum;
+  WelsMutexUnlock (&pPool->hLock);
+  return iThreadNum;
+}
+
+void WelsThreadPoolSubmit (SWelsThreadPool* pPool, SWelsTaskGroup* pGroup, PWelsTaskProc pProc, void* pArg) {
+  SWelsTask sTask;
+  int32_t iThreadNum = 0;
+  uint32_t uiFirst = 0;
+  int32_t iIdx = 0;
+  bool bPushed = false;
+
+  sTask.pProc = pProc;
+  sTask.pArg = pArg;
+  sTask.pGroup = pGroup;
+
+  WelsMutexLock (&pPool->hLock);
+  ++ pGroup->iPending;
+  iThreadNum = pPool->iThreadNum;
+  uiFirst = pPool->uiNextQueue ++;
+  WelsMutexUnlock (&pPool->hLock);
+
+  for (iIdx = 0; !bPushed && iIdx < iThreadNum; iIdx++)
+    bPushed = PushTask (&pPool->sQueues[ (uiFirst + iIdx) % iThreadNum], &sTask);
+  if (!bPushed) {	// every queue is full, no point in waiting for room
+    RunTask (pPool, &sTask);
+    return;
+  }
+
+  WelsMutexLock (&pPool->hLock);
+  ++ pPool->iQueuedNum;
+  WelsCondSignal (&pPool->hTaskCond);
+  WelsMutexUnlock (&pPool->hLock);
+}
+
+void WelsThreadPoolWait (SWelsThreadPool* pPool, SWelsTaskGroup* pGroup) {
+  SWelsTask sTask;
+
+  for (;;) {
+    WelsMutexLock (&pPool->hLock);
+    const bool kbDone = (pGroup->iPending == 0);
+    WelsMutexUnlock (&pPool->hLock);
+    if (kbDone)
+      break;
+
+    // help instead of sleeping, tasks of other groups included: a task may only block on the progress of
+    // tasks already running that never wait for the pool themselves (DeblockingMbRowsTask() claims its rows
+    // in order), so what it waits for is never buried beneath it in this thread
+    if (TakeTask (pPool, -1, &sTask)) {
+      RunTask (pPool, &sTask);
+      continue;
+    }
+    WelsMutexLock (&pPool->hLock);
+    if (pGroup->iPending > 0 && pPool->iQueuedNum <= 0)
+      WelsCondWait (&pPool->hDoneCond, &pPool->hLock);
+    WelsMutexUnlock (&pPool->hLock);
+  }
+}
@@ -51,7 +51,62 @@
 #define    CPU_Vendor_INTEL  "GenuineIntel"
 #define    CPU_Vendor_CYRIX  "CyrixInstead"
 
-#if defined(X86_ASM)
+#if !defined(X86_ASM) && defined(X86_INTRINSICS)
+/* built without nasm, cpuid and xgetbv come from the compiler */
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif//_MSC_VER
+
+int32_t WelsCPUIdVerify() {
+#if defined(_MSC_VER)
+  return 1;
+#else
+  return __get_cpuid_max (0, NULL) != 0;
+#endif//_MSC_VER
+}
+
+void WelsCPUId (uint32_t uiIndex, uint32_t* pFeatureA, uint32_t* pFeatureB, uint32_t* pFeatureC, uint32_t* pFeatureD) {
+#if defined(_MSC_VER)
+  int32_t iRegs[4];
+  __cpuidex (iRegs, uiIndex, 0);
+  *pFeatureA = iRegs[0];
+  *pFeatureB = iRegs[1];
+  *pFeatureC = iRegs[2];
+  *pFeatureD = iRegs[3];
+#else
+  __cpuid_count (uiIndex, 0, *pFeatureA, *pFeatureB, *pFeatureC, *pFeatureD);
+#endif//_MSC_VER
+}
+
+/* OS has enabled both XMM and YMM state support */
+static int32_t WelsCPUSupportYmmState() {
+#if defined(_MSC_VER)
+  return (_xgetbv (0) & 0x06) == 0x06;
+#else
+  uint32_t uiXcr0 = 0, uiXcr0High = 0;
+  __asm__ volatile ("xgetbv" : "=a" (uiXcr0), "=d" (uiXcr0High) : "c" (0));
+  return (uiXcr0 & 0x06) == 0x06;
+#endif//_MSC_VER
+}
+
+int32_t WelsCPUSupportAVX (uint32_t eax, uint32_t ecx) {
+  // check both OSXSAVE and AVX feature flags before XGETBV
+  if ((ecx & 0x18000000) != 0x18000000)
+    return 0;
+  return WelsCPUSupportYmmState();
+}
+
+int32_t WelsCPUSupportFMA (uint32_t eax, uint32_t ecx) {
+  // check OSXSAVE, AVX, FMA feature flags before XGETBV
+  if ((ecx & 0x18001000) != 0x18001000)
+    return 0;
+  return WelsCPUSupportYmmState();
+}
+#endif//!X86_ASM && X86_INTRINSICS
+
+#if defined(X86_ASM) || defined(X86_INTRINSICS)
 
 uint32_t WelsCPUFeatureDetect (int32_t* pNumberOfLogicProcessors) {
   uint32_t uiCPU = 0;
@@ -123,6 +178,15 @@ uint32_t WelsCPUFeatureDetect (int32_t* pNumberOfLogicProcessors) {
     /* AVX supported */
     uiCPU |= WELS_CPU_AVX;
   }
+  if ((uiCPU & WELS_CPU_AVX) && uiMaxCpuidLevel >= 7) {
+    uint32_t uiExtFeatureA = 0, uiExtFeatureB = 0, uiExtFeatureC = 0, uiExtFeatureD = 0;
+    /* structured extended feature flags, sub-leaf 0 passed in ecx */
+    WelsCPUId (7, &uiExtFeatureA, &uiExtFeatureB, &uiExtFeatureC, &uiExtFeatureD);
+    if (uiExtFeatureB & 0x00000020) {
+      /* AVX2 supported, the OS ymm state check is shared with AVX above */
+      uiCPU |= WELS_CPU_AVX2;
+    }
+  }
   if (WelsCPUSupportFMA (uiFeatureA, uiFeatureC)) {
     /* AVX FMA supported */
     uiCPU |= WELS_CPU_FMA;
@@ -200,12 +264,13 @@ uint32_t WelsCPUFeatureDetect (int32_t* pNumberOfLogicProcessors) {
   return uiCPU;
 }
 
-
+#if defined(X86_ASM)
 void WelsCPURestore (const uint32_t kuiCPU) {
   if (kuiCPU & (WELS_CPU_MMX | WELS_CPU_MMXEXT | WELS_CPU_3DNOW | WELS_CPU_3DNOWEXT)) {
     WelsEmms();
   }
 }
+#endif//X86_ASM
 
 #elif defined(HAVE_NEON) //For supporting both android platform and iOS platform
 #if defined(ANDROID_NDK)
@@ -282,7 +347,7 @@ uint32_t WelsCPUFeatureDetect (int32_t* pNumberOfLogicProcessors) {
          WELS_CPU_NEON;
 }
 #endif
-#else /* Neither X86_ASM nor HAVE_NEON */
+#else /* Neither x86 nor HAVE_NEON */
 
 uint32_t WelsCPUFeatureDetect (int32_t* pNumberOfLogicProcessors) {
   return 0;
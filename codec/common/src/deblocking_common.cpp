@@ -1,5 +1,8 @@
 #include "deblocking_common.h"
 #include "macros.h"
+#if defined(X86_INTRINSICS)
+#include <immintrin.h>
+#endif//X86_INTRINSICS
 //  C code only
 void DeblockLumaLt4_c (uint8_t* pPix, int32_t iStrideX, int32_t iStrideY, int32_t iAlpha, int32_t iBeta,
                          int8_t* pTc) {
@@ -202,3 +205,393 @@ extern "C" {
 
 #endif
 
+
+#if defined(X86_INTRINSICS)
+//***************************************************************************//
+//                       AVX2 implementation                                 //
+//***************************************************************************//
+// Every kernel widens the samples to 16 bit, so one ymm holds a whole 16-pixel
+// luma edge, or the 8-pixel Cb edge in its low half and the Cr edge in its high
+// half; both chroma planes are filtered by the same instruction stream.
+
+static inline WELS_TARGET_AVX2 __m256i Widen_avx2 (__m128i xRow) {
+  return _mm256_cvtepu8_epi16 (xRow);
+}
+
+static inline WELS_TARGET_AVX2 __m128i Narrow_avx2 (__m256i yRow) {
+  return _mm_packus_epi16 (_mm256_castsi256_si128 (yRow), _mm256_extracti128_si256 (yRow, 1));
+}
+
+static inline WELS_TARGET_AVX2 __m256i AbsDiffLess_avx2 (__m256i a, __m256i b, __m256i yThreshold) {
+  return _mm256_cmpgt_epi16 (yThreshold, _mm256_abs_epi16 (_mm256_sub_epi16 (a, b)));
+}
+
+// tc0 per pixel: pTc[i >> 2] for luma, pTc[i >> 1] for each of the two chroma halves
+static inline WELS_TARGET_AVX2 __m256i LoadTc_avx2 (const int8_t* pTc, bool bChroma) {
+  const __m128i kxLumaIdx   = _mm_setr_epi8 (0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+  const __m128i kxChromaIdx = _mm_setr_epi8 (0, 0, 1, 1, 2, 2, 3, 3, 0, 0, 1, 1, 2, 2, 3, 3);
+  __m128i xTc = _mm_cvtsi32_si128 (* (const int32_t*)pTc);
+  return _mm256_cvtepi8_epi16 (_mm_shuffle_epi8 (xTc, bChroma ? kxChromaIdx : kxLumaIdx));
+}
+
+// filter mask shared by all kernels: |p0 - q0| < alpha, |p1 - p0| < beta, |q1 - q0| < beta
+static inline WELS_TARGET_AVX2 __m256i FilterMask_avx2 (__m256i p1, __m256i p0, __m256i q0, __m256i q1,
+    __m256i yAlpha, __m256i yBeta) {
+  __m256i yMask = AbsDiffLess_avx2 (p0, q0, yAlpha);
+  yMask = _mm256_and_si256 (yMask, AbsDiffLess_avx2 (p1, p0, yBeta));
+  return _mm256_and_si256 (yMask, AbsDiffLess_avx2 (q1, q0, yBeta));
+}
+
+// p0/q0 update of the bS < 4 filter; p0/q0 are overwritten where yMask is set
+static inline WELS_TARGET_AVX2 void FilterP0Q0Lt4_avx2 (__m256i p1, __m256i& p0, __m256i& q0, __m256i q1,
+    __m256i yTc, __m256i yMask) {
+  const __m256i kyZero = _mm256_setzero_si256();
+  const __m256i ky255  = _mm256_set1_epi16 (255);
+  __m256i yDelta = _mm256_sub_epi16 (_mm256_slli_epi16 (_mm256_sub_epi16 (q0, p0), 2), _mm256_sub_epi16 (q1, p1));
+  yDelta = _mm256_srai_epi16 (_mm256_add_epi16 (yDelta, _mm256_set1_epi16 (4)), 3);
+  yDelta = _mm256_min_epi16 (_mm256_max_epi16 (yDelta, _mm256_sub_epi16 (kyZero, yTc)), yTc);
+  __m256i yP0 = _mm256_min_epi16 (_mm256_max_epi16 (_mm256_add_epi16 (p0, yDelta), kyZero), ky255);
+  __m256i yQ0 = _mm256_min_epi16 (_mm256_max_epi16 (_mm256_sub_epi16 (q0, yDelta), kyZero), ky255);
+  p0 = _mm256_blendv_epi8 (p0, yP0, yMask);
+  q0 = _mm256_blendv_epi8 (q0, yQ0, yMask);
+}
+
+// luma bS < 4 on rows pRow[0..5] = p2, p1, p0, q0, q1, q2
+static inline WELS_TARGET_AVX2 void DeblockLumaLt4Rows_avx2 (__m256i pRow[6], int32_t iAlpha, int32_t iBeta,
+    int8_t* pTc) {
+  const __m256i kyZero = _mm256_setzero_si256();
+  __m256i p2 = pRow[0], p1 = pRow[1], p0 = pRow[2], q0 = pRow[3], q1 = pRow[4], q2 = pRow[5];
+  __m256i yBeta = _mm256_set1_epi16 ((int16_t)iBeta);
+  __m256i yTc0  = LoadTc_avx2 (pTc, false);
+  __m256i yNegTc0 = _mm256_sub_epi16 (kyZero, yTc0);
+  __m256i yMask = FilterMask_avx2 (p1, p0, q0, q1, _mm256_set1_epi16 ((int16_t)iAlpha), yBeta);
+  yMask = _mm256_andnot_si256 (_mm256_cmpgt_epi16 (kyZero, yTc0), yMask);
+
+  __m256i yAp = _mm256_and_si256 (AbsDiffLess_avx2 (p2, p0, yBeta), yMask);
+  __m256i yAq = _mm256_and_si256 (AbsDiffLess_avx2 (q2, q0, yBeta), yMask);
+  __m256i yAvg = _mm256_avg_epu16 (p0, q0);
+  __m256i yDp1 = _mm256_srai_epi16 (_mm256_sub_epi16 (_mm256_add_epi16 (p2, yAvg), _mm256_add_epi16 (p1, p1)), 1);
+  __m256i yDq1 = _mm256_srai_epi16 (_mm256_sub_epi16 (_mm256_add_epi16 (q2, yAvg), _mm256_add_epi16 (q1, q1)), 1);
+  yDp1 = _mm256_min_epi16 (_mm256_max_epi16 (yDp1, yNegTc0), yTc0);
+  yDq1 = _mm256_min_epi16 (_mm256_max_epi16 (yDq1, yNegTc0), yTc0);
+  // the masks are -1 where set, so subtracting them counts the extra tc
+  __m256i yTc = _mm256_sub_epi16 (_mm256_sub_epi16 (yTc0, yAp), yAq);
+
+  FilterP0Q0Lt4_avx2 (p1, p0, q0, q1, yTc, yMask);
+  pRow[1] = _mm256_blendv_epi8 (p1, _mm256_add_epi16 (p1, yDp1), yAp);
+  pRow[2] = p0;
+  pRow[3] = q0;
+  pRow[4] = _mm256_blendv_epi8 (q1, _mm256_add_epi16 (q1, yDq1), yAq);
+}
+
+// luma bS == 4 on rows pRow[0..7] = p3, p2, p1, p0, q0, q1, q2, q3
+static inline WELS_TARGET_AVX2 void DeblockLumaEq4Rows_avx2 (__m256i pRow[8], int32_t iAlpha, int32_t iBeta) {
+  __m256i p3 = pRow[0], p2 = pRow[1], p1 = pRow[2], p0 = pRow[3];
+  __m256i q0 = pRow[4], q1 = pRow[5], q2 = pRow[6], q3 = pRow[7];
+  __m256i yBeta = _mm256_set1_epi16 ((int16_t)iBeta);
+  __m256i yMask = FilterMask_avx2 (p1, p0, q0, q1, _mm256_set1_epi16 ((int16_t)iAlpha), yBeta);
+  __m256i yStrong = _mm256_and_si256 (AbsDiffLess_avx2 (p0, q0, _mm256_set1_epi16 ((int16_t) ((iAlpha >> 2) + 2))),
+                                      yMask);
+  __m256i yAp = _mm256_and_si256 (AbsDiffLess_avx2 (p2, p0, yBeta), yStrong);
+  __m256i yAq = _mm256_and_si256 (AbsDiffLess_avx2 (q2, q0, yBeta), yStrong);
+  const __m256i ky2 = _mm256_set1_epi16 (2);
+  const __m256i ky4 = _mm256_set1_epi16 (4);
+
+  __m256i yP0Q0 = _mm256_add_epi16 (p0, q0);
+  // weak results, also used by the strong filter when the p2/q2 side test fails
+  __m256i yP0Weak = _mm256_srai_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (p1, p1), p0),
+                                       _mm256_add_epi16 (q1, ky2)), 2);
+  __m256i yQ0Weak = _mm256_srai_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (q1, q1), q0),
+                                       _mm256_add_epi16 (p1, ky2)), 2);
+
+  __m256i yP2P1P0Q0 = _mm256_add_epi16 (_mm256_add_epi16 (p2, p1), yP0Q0);
+  __m256i yP0Strong = _mm256_srai_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (yP2P1P0Q0, _mm256_add_epi16 (p1, yP0Q0)),
+                                         _mm256_add_epi16 (q1, ky4)), 3);
+  __m256i yP1Strong = _mm256_srai_epi16 (_mm256_add_epi16 (yP2P1P0Q0, ky2), 2);
+  __m256i yP2Strong = _mm256_srai_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (_mm256_slli_epi16 (_mm256_add_epi16 (p3,
+                                         p2), 1), yP2P1P0Q0), ky4), 3);
+
+  __m256i yQ2Q1Q0P0 = _mm256_add_epi16 (_mm256_add_epi16 (q2, q1), yP0Q0);
+  __m256i yQ0Strong = _mm256_srai_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (yQ2Q1Q0P0, _mm256_add_epi16 (q1, yP0Q0)),
+                                         _mm256_add_epi16 (p1, ky4)), 3);
+  __m256i yQ1Strong = _mm256_srai_epi16 (_mm256_add_epi16 (yQ2Q1Q0P0, ky2), 2);
+  __m256i yQ2Strong = _mm256_srai_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (_mm256_slli_epi16 (_mm256_add_epi16 (q3,
+                                         q2), 1), yQ2Q1Q0P0), ky4), 3);
+
+  pRow[1] = _mm256_blendv_epi8 (p2, yP2Strong, yAp);
+  pRow[2] = _mm256_blendv_epi8 (p1, yP1Strong, yAp);
+  pRow[3] = _mm256_blendv_epi8 (_mm256_blendv_epi8 (p0, yP0Weak, yMask), yP0Strong, yAp);
+  pRow[4] = _mm256_blendv_epi8 (_mm256_blendv_epi8 (q0, yQ0Weak, yMask), yQ0Strong, yAq);
+  pRow[5] = _mm256_blendv_epi8 (q1, yQ1Strong, yAq);
+  pRow[6] = _mm256_blendv_epi8 (q2, yQ2Strong, yAq);
+}
+
+// chroma on rows pRow[0..3] = p1, p0, q0, q1, Cb in the low and Cr in the high half
+static inline WELS_TARGET_AVX2 void DeblockChromaLt4Rows_avx2 (__m256i pRow[4], int32_t iAlpha, int32_t iBeta,
+    int8_t* pTc) {
+  __m256i yTc = LoadTc_avx2 (pTc, true);
+  __m256i yMask = FilterMask_avx2 (pRow[0], pRow[1], pRow[2], pRow[3], _mm256_set1_epi16 ((int16_t)iAlpha),
+                                   _mm256_set1_epi16 ((int16_t)iBeta));
+  yMask = _mm256_and_si256 (yMask, _mm256_cmpgt_epi16 (yTc, _mm256_setzero_si256()));
+  FilterP0Q0Lt4_avx2 (pRow[0], pRow[1], pRow[2], pRow[3], yTc, yMask);
+}
+
+static inline WELS_TARGET_AVX2 void DeblockChromaEq4Rows_avx2 (__m256i pRow[4], int32_t iAlpha, int32_t iBeta) {
+  __m256i p1 = pRow[0], p0 = pRow[1], q0 = pRow[2], q1 = pRow[3];
+  const __m256i ky2 = _mm256_set1_epi16 (2);
+  __m256i yMask = FilterMask_avx2 (p1, p0, q0, q1, _mm256_set1_epi16 ((int16_t)iAlpha),
+                                   _mm256_set1_epi16 ((int16_t)iBeta));
+  __m256i yP0 = _mm256_srai_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (p1, p1), p0),
+                                   _mm256_add_epi16 (q1, ky2)), 2);
+  __m256i yQ0 = _mm256_srai_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (_mm256_add_epi16 (q1, q1), q0),
+                                   _mm256_add_epi16 (p1, ky2)), 2);
+  pRow[1] = _mm256_blendv_epi8 (p0, yP0, yMask);
+  pRow[2] = _mm256_blendv_epi8 (q0, yQ0, yMask);
+}
+
+// 16 rows of 8 bytes starting at pPix <-> 8 rows of 16 bytes
+static inline WELS_TARGET_AVX2 void TransposeLoad16x8_avx2 (uint8_t* pPix, int32_t iStride, __m128i pCol[8]) {
+  __m128i a[8], b[8], c[4];
+  for (int32_t i = 0; i < 8; i++) {
+    a[i] = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i*) (pPix + (2 * i) * iStride)),
+                              _mm_loadl_epi64 ((const __m128i*) (pPix + (2 * i + 1) * iStride)));
+  }
+  for (int32_t i = 0; i < 4; i++) {
+    b[2 * i]     = _mm_unpacklo_epi16 (a[2 * i], a[2 * i + 1]);
+    b[2 * i + 1] = _mm_unpackhi_epi16 (a[2 * i], a[2 * i + 1]);
+  }
+  // b[0]/b[1]: columns 0-3/4-7 of rows 0-3, b[2]/b[3] rows 4-7 and so on
+  for (int32_t i = 0; i < 2; i++) {
+    c[0] = _mm_unpacklo_epi32 (b[i], b[i + 2]);
+    c[1] = _mm_unpackhi_epi32 (b[i], b[i + 2]);
+    c[2] = _mm_unpacklo_epi32 (b[i + 4], b[i + 6]);
+    c[3] = _mm_unpackhi_epi32 (b[i + 4], b[i + 6]);
+    pCol[4 * i + 0] = _mm_unpacklo_epi64 (c[0], c[2]);
+    pCol[4 * i + 1] = _mm_unpackhi_epi64 (c[0], c[2]);
+    pCol[4 * i + 2] = _mm_unpacklo_epi64 (c[1], c[3]);
+    pCol[4 * i + 3] = _mm_unpackhi_epi64 (c[1], c[3]);
+  }
+}
+
+static inline WELS_TARGET_AVX2 void TransposeStore8x16_avx2 (uint8_t* pPix, int32_t iStride, __m128i pCol[8]) {
+  __m128i a[8], b[8];
+  for (int32_t i = 0; i < 4; i++) {
+    a[i]     = _mm_unpacklo_epi8 (pCol[2 * i], pCol[2 * i + 1]);
+    a[i + 4] = _mm_unpackhi_epi8 (pCol[2 * i], pCol[2 * i + 1]);
+  }
+  // a[0..3]: column pairs of rows 0-7, a[4..7] of rows 8-15
+  for (int32_t i = 0; i < 2; i++) {
+    b[4 * i + 0] = _mm_unpacklo_epi16 (a[4 * i], a[4 * i + 1]);
+    b[4 * i + 1] = _mm_unpackhi_epi16 (a[4 * i], a[4 * i + 1]);
+    b[4 * i + 2] = _mm_unpacklo_epi16 (a[4 * i + 2], a[4 * i + 3]);
+    b[4 * i + 3] = _mm_unpackhi_epi16 (a[4 * i + 2], a[4 * i + 3]);
+  }
+  for (int32_t i = 0; i < 4; i++) {
+    const int32_t kiLow = (i >> 1) * 4 + (i & 1);
+    __m128i xRows01 = _mm_unpacklo_epi32 (b[kiLow], b[kiLow + 2]);
+    __m128i xRows23 = _mm_unpackhi_epi32 (b[kiLow], b[kiLow + 2]);
+    uint8_t* pRow = pPix + (4 * i) * iStride;
+    _mm_storel_epi64 ((__m128i*)pRow, xRows01);
+    _mm_storel_epi64 ((__m128i*) (pRow + iStride), _mm_srli_si128 (xRows01, 8));
+    _mm_storel_epi64 ((__m128i*) (pRow + 2 * iStride), xRows23);
+    _mm_storel_epi64 ((__m128i*) (pRow + 3 * iStride), _mm_srli_si128 (xRows23, 8));
+  }
+}
+
+// 8 Cb rows then 8 Cr rows of 4 bytes <-> 4 rows of 16 bytes
+static inline WELS_TARGET_AVX2 void TransposeLoadChroma_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride,
+    __m128i pCol[4]) {
+  __m128i a[8], b[4];
+  for (int32_t i = 0; i < 8; i++) {
+    uint8_t* pRow = (i < 4 ? pPixCb : pPixCr) + (2 * (i & 3)) * iStride;
+    a[i] = _mm_unpacklo_epi8 (_mm_cvtsi32_si128 (* (const int32_t*)pRow),
+                              _mm_cvtsi32_si128 (* (const int32_t*) (pRow + iStride)));
+  }
+  for (int32_t i = 0; i < 4; i++)
+    b[i] = _mm_unpacklo_epi16 (a[2 * i], a[2 * i + 1]);
+  __m128i xLo0 = _mm_unpacklo_epi32 (b[0], b[1]);
+  __m128i xHi0 = _mm_unpackhi_epi32 (b[0], b[1]);
+  __m128i xLo1 = _mm_unpacklo_epi32 (b[2], b[3]);
+  __m128i xHi1 = _mm_unpackhi_epi32 (b[2], b[3]);
+  pCol[0] = _mm_unpacklo_epi64 (xLo0, xLo1);
+  pCol[1] = _mm_unpackhi_epi64 (xLo0, xLo1);
+  pCol[2] = _mm_unpacklo_epi64 (xHi0, xHi1);
+  pCol[3] = _mm_unpackhi_epi64 (xHi0, xHi1);
+}
+
+static inline WELS_TARGET_AVX2 void TransposeStoreChroma_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride,
+    __m128i pCol[4]) {
+  __m128i xLo01 = _mm_unpacklo_epi8 (pCol[0], pCol[1]);
+  __m128i xHi01 = _mm_unpackhi_epi8 (pCol[0], pCol[1]);
+  __m128i xLo23 = _mm_unpacklo_epi8 (pCol[2], pCol[3]);
+  __m128i xHi23 = _mm_unpackhi_epi8 (pCol[2], pCol[3]);
+  __m128i xRows[4] = { _mm_unpacklo_epi16 (xLo01, xLo23), _mm_unpackhi_epi16 (xLo01, xLo23),
+                       _mm_unpacklo_epi16 (xHi01, xHi23), _mm_unpackhi_epi16 (xHi01, xHi23)
+                     };
+  for (int32_t i = 0; i < 4; i++) {
+    uint8_t* pRow = (i < 2 ? pPixCb : pPixCr) + (4 * (i & 1)) * iStride;
+    for (int32_t j = 0; j < 4; j++) {
+      * (int32_t*) (pRow + j * iStride) = _mm_cvtsi128_si32 (xRows[i]);
+      xRows[i] = _mm_srli_si128 (xRows[i], 4);
+    }
+  }
+}
+
+WELS_TARGET_AVX2 void DeblockLumaLt4V_avx2 (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta,
+    int8_t* pTc) {
+  __m256i yRow[6];
+  for (int32_t i = 0; i < 6; i++)
+    yRow[i] = Widen_avx2 (_mm_loadu_si128 ((const __m128i*) (pPixY + (i - 3) * iStride)));
+  DeblockLumaLt4Rows_avx2 (yRow, iAlpha, iBeta, pTc);
+  for (int32_t i = 1; i < 5; i++)
+    _mm_storeu_si128 ((__m128i*) (pPixY + (i - 3) * iStride), Narrow_avx2 (yRow[i]));
+}
+
+WELS_TARGET_AVX2 void DeblockLumaEq4V_avx2 (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta) {
+  __m256i yRow[8];
+  for (int32_t i = 0; i < 8; i++)
+    yRow[i] = Widen_avx2 (_mm_loadu_si128 ((const __m128i*) (pPixY + (i - 4) * iStride)));
+  DeblockLumaEq4Rows_avx2 (yRow, iAlpha, iBeta);
+  for (int32_t i = 1; i < 7; i++)
+    _mm_storeu_si128 ((__m128i*) (pPixY + (i - 4) * iStride), Narrow_avx2 (yRow[i]));
+}
+
+WELS_TARGET_AVX2 void DeblockLumaLt4H_avx2 (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta,
+    int8_t* pTc) {
+  __m128i xCol[8];
+  __m256i yRow[6];
+  TransposeLoad16x8_avx2 (pPixY - 4, iStride, xCol);
+  for (int32_t i = 0; i < 6; i++)
+    yRow[i] = Widen_avx2 (xCol[i + 1]);
+  DeblockLumaLt4Rows_avx2 (yRow, iAlpha, iBeta, pTc);
+  for (int32_t i = 1; i < 5; i++)
+    xCol[i + 1] = Narrow_avx2 (yRow[i]);
+  TransposeStore8x16_avx2 (pPixY - 4, iStride, xCol);
+}
+
+WELS_TARGET_AVX2 void DeblockLumaEq4H_avx2 (uint8_t* pPixY, int32_t iStride, int32_t iAlpha, int32_t iBeta) {
+  __m128i xCol[8];
+  __m256i yRow[8];
+  TransposeLoad16x8_avx2 (pPixY - 4, iStride, xCol);
+  for (int32_t i = 0; i < 8; i++)
+    yRow[i] = Widen_avx2 (xCol[i]);
+  DeblockLumaEq4Rows_avx2 (yRow, iAlpha, iBeta);
+  for (int32_t i = 1; i < 7; i++)
+    xCol[i] = Narrow_avx2 (yRow[i]);
+  TransposeStore8x16_avx2 (pPixY - 4, iStride, xCol);
+}
+
+static inline WELS_TARGET_AVX2 void LoadChromaRowsV_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride,
+    __m256i pRow[4]) {
+  for (int32_t i = 0; i < 4; i++) {
+    const int32_t kiOffset = (i - 2) * iStride;
+    pRow[i] = Widen_avx2 (_mm_unpacklo_epi64 (_mm_loadl_epi64 ((const __m128i*) (pPixCb + kiOffset)),
+                          _mm_loadl_epi64 ((const __m128i*) (pPixCr + kiOffset))));
+  }
+}
+
+static inline WELS_TARGET_AVX2 void StoreChromaRowsV_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride,
+    __m256i pRow[4]) {
+  for (int32_t i = 1; i < 3; i++) {
+    const int32_t kiOffset = (i - 2) * iStride;
+    __m128i xRow = Narrow_avx2 (pRow[i]);
+    _mm_storel_epi64 ((__m128i*) (pPixCb + kiOffset), xRow);
+    _mm_storel_epi64 ((__m128i*) (pPixCr + kiOffset), _mm_srli_si128 (xRow, 8));
+  }
+}
+
+WELS_TARGET_AVX2 void DeblockChromaLt4V_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride, int32_t iAlpha,
+    int32_t iBeta, int8_t* pTc) {
+  __m256i yRow[4];
+  LoadChromaRowsV_avx2 (pPixCb, pPixCr, iStride, yRow);
+  DeblockChromaLt4Rows_avx2 (yRow, iAlpha, iBeta, pTc);
+  StoreChromaRowsV_avx2 (pPixCb, pPixCr, iStride, yRow);
+}
+
+WELS_TARGET_AVX2 void DeblockChromaEq4V_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride, int32_t iAlpha,
+    int32_t iBeta) {
+  __m256i yRow[4];
+  LoadChromaRowsV_avx2 (pPixCb, pPixCr, iStride, yRow);
+  DeblockChromaEq4Rows_avx2 (yRow, iAlpha, iBeta);
+  StoreChromaRowsV_avx2 (pPixCb, pPixCr, iStride, yRow);
+}
+
+WELS_TARGET_AVX2 void DeblockChromaLt4H_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride, int32_t iAlpha,
+    int32_t iBeta, int8_t* pTc) {
+  __m128i xCol[4];
+  __m256i yRow[4];
+  TransposeLoadChroma_avx2 (pPixCb - 2, pPixCr - 2, iStride, xCol);
+  for (int32_t i = 0; i < 4; i++)
+    yRow[i] = Widen_avx2 (xCol[i]);
+  DeblockChromaLt4Rows_avx2 (yRow, iAlpha, iBeta, pTc);
+  xCol[1] = Narrow_avx2 (yRow[1]);
+  xCol[2] = Narrow_avx2 (yRow[2]);
+  TransposeStoreChroma_avx2 (pPixCb - 2, pPixCr - 2, iStride, xCol);
+}
+
+WELS_TARGET_AVX2 void DeblockChromaEq4H_avx2 (uint8_t* pPixCb, uint8_t* pPixCr, int32_t iStride, int32_t iAlpha,
+    int32_t iBeta) {
+  __m128i xCol[4];
+  __m256i yRow[4];
+  TransposeLoadChroma_avx2 (pPixCb - 2, pPixCr - 2, iStride, xCol);
+  for (int32_t i = 0; i < 4; i++)
+    yRow[i] = Widen_avx2 (xCol[i]);
+  DeblockChromaEq4Rows_avx2 (yRow, iAlpha, iBeta);
+  xCol[1] = Narrow_avx2 (yRow[1]);
+  xCol[2] = Narrow_avx2 (yRow[2]);
+  TransposeStoreChroma_avx2 (pPixCb - 2, pPixCr - 2, iStride, xCol);
+}
+
+// Inner-edge boundary strength of a non-16x16 inter MB, laid out as the C
+// DeblockingBSInsideMBNormal: uiBS[0][edge][row] and uiBS[1][edge][col].
+// pMv holds 16 (x, y) pairs in raster order; pRefIndex may be NULL when the
+// caller does not compare reference indices inside a MB. uiBS[dir][0] is kept.
+WELS_TARGET_AVX2 void DeblockingBSInsideMB_avx2 (const int8_t* pNnzTab, const int8_t* pRefIndex, const int16_t* pMv,
+    uint8_t uiBS[2][4][4]) {
+  // the packs below leave the blocks as 0-3, 8-11, 4-7, 12-15
+  const __m128i kxPackOrder = _mm_setr_epi8 (0, 1, 2, 3, 8, 9, 10, 11, 4, 5, 6, 7, 12, 13, 14, 15);
+  const __m128i kxTranspose = _mm_setr_epi8 (0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+  const __m128i kxOne = _mm_set1_epi8 (1);
+  const __m256i ky3 = _mm256_set1_epi16 (3);
+
+  // one 128-bit lane per row of 4x4 blocks
+  __m256i yMv01 = _mm256_loadu_si256 ((const __m256i*)pMv);
+  __m256i yMv23 = _mm256_loadu_si256 ((const __m256i*) (pMv + 16));
+  __m256i yLeft01 = _mm256_slli_si256 (yMv01, 4);
+  __m256i yLeft23 = _mm256_slli_si256 (yMv23, 4);
+  __m256i yTop01  = _mm256_permute2x128_si256 (yMv01, yMv01, 0x08);
+  __m256i yTop23  = _mm256_permute2x128_si256 (yMv01, yMv23, 0x21);
+  __m256i yMvL01 = _mm256_cmpgt_epi16 (_mm256_abs_epi16 (_mm256_sub_epi16 (yMv01, yLeft01)), ky3);
+  __m256i yMvL23 = _mm256_cmpgt_epi16 (_mm256_abs_epi16 (_mm256_sub_epi16 (yMv23, yLeft23)), ky3);
+  __m256i yMvT01 = _mm256_cmpgt_epi16 (_mm256_abs_epi16 (_mm256_sub_epi16 (yMv01, yTop01)), ky3);
+  __m256i yMvT23 = _mm256_cmpgt_epi16 (_mm256_abs_epi16 (_mm256_sub_epi16 (yMv23, yTop23)), ky3);
+  // signed saturation keeps any set half of a (x, y) pair non-zero
+  __m256i yMvL = _mm256_packs_epi32 (yMvL01, yMvL23);
+  __m256i yMvT = _mm256_packs_epi32 (yMvT01, yMvT23);
+  __m128i xMvL = _mm_packs_epi16 (_mm256_castsi256_si128 (yMvL), _mm256_extracti128_si256 (yMvL, 1));
+  __m128i xMvT = _mm_packs_epi16 (_mm256_castsi256_si128 (yMvT), _mm256_extracti128_si256 (yMvT, 1));
+  xMvL = _mm_min_epu8 (_mm_shuffle_epi8 (xMvL, kxPackOrder), kxOne);
+  xMvT = _mm_min_epu8 (_mm_shuffle_epi8 (xMvT, kxPackOrder), kxOne);
+
+  if (pRefIndex != NULL) {
+    __m128i xRef = _mm_loadu_si128 ((const __m128i*)pRefIndex);
+    xMvL = _mm_or_si128 (xMvL, _mm_min_epu8 (_mm_xor_si128 (xRef, _mm_slli_si128 (xRef, 1)), kxOne));
+    xMvT = _mm_or_si128 (xMvT, _mm_min_epu8 (_mm_xor_si128 (xRef, _mm_slli_si128 (xRef, 4)), kxOne));
+  }
+
+  // non-zero coefficients on either side give bS 2, otherwise the motion test decides
+  __m128i xNnz = _mm_loadu_si128 ((const __m128i*)pNnzTab);
+  __m128i xNnzL = _mm_min_epu8 (_mm_or_si128 (xNnz, _mm_slli_si128 (xNnz, 1)), kxOne);
+  __m128i xNnzT = _mm_min_epu8 (_mm_or_si128 (xNnz, _mm_slli_si128 (xNnz, 4)), kxOne);
+  __m128i xBsL = _mm_max_epu8 (_mm_add_epi8 (xNnzL, xNnzL), xMvL);
+  __m128i xBsT = _mm_max_epu8 (_mm_add_epi8 (xNnzT, xNnzT), xMvT);
+
+  // vertical edges are stored edge-major, i.e. transposed to the raster order
+  xBsL = _mm_shuffle_epi8 (xBsL, kxTranspose);
+  __m128i* pBsV = (__m128i*)uiBS[0];
+  __m128i* pBsH = (__m128i*)uiBS[1];
+  _mm_storeu_si128 (pBsV, _mm_blend_epi16 (xBsL, _mm_loadu_si128 (pBsV), 0x03));
+  _mm_storeu_si128 (pBsH, _mm_blend_epi16 (xBsT, _mm_loadu_si128 (pBsH), 0x03));
+}
+
+#endif//X86_INTRINSICS
@@ -0,0 +1,240 @@
+/*!
+ * \copy
+ *     Copyright (c)  2013, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file	mc_common.cpp
+ *
+ * \brief	luma and chroma interpolation kernels shared by encoder and decoder
+ *
+ *************************************************************************************
+ */
+
+#include "mc_common.h"
+#include "macros.h"
+#if defined(X86_INTRINSICS)
+#include <immintrin.h>
+#endif//X86_INTRINSICS
+
+#if defined(X86_INTRINSICS)
+//***************************************************************************//
+//                       AVX2 implementation                                 //
+//***************************************************************************//
+// The 8-pixel wide kernels process two rows per ymm; for an odd iHeight the
+// last row is computed twice, so they are usable for the 9/17 row cases too.
+
+static inline WELS_TARGET_AVX2 __m128i Load8x2_avx2 (const uint8_t* pRow0, const uint8_t* pRow1) {
+  return _mm_unpacklo_epi64 (_mm_loadl_epi64 ((const __m128i*)pRow0), _mm_loadl_epi64 ((const __m128i*)pRow1));
+}
+
+static inline WELS_TARGET_AVX2 __m256i Load16To16Bit_avx2 (const uint8_t* pSrc) {
+  return _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i*)pSrc));
+}
+
+static inline WELS_TARGET_AVX2 __m256i Load8x2To16Bit_avx2 (const uint8_t* pRow0, const uint8_t* pRow1) {
+  return _mm256_cvtepu8_epi16 (Load8x2_avx2 (pRow0, pRow1));
+}
+
+static inline WELS_TARGET_AVX2 void Store8x2_avx2 (uint8_t* pRow0, uint8_t* pRow1, const __m128i kPix) {
+  _mm_storel_epi64 ((__m128i*)pRow1, _mm_unpackhi_epi64 (kPix, kPix));
+  _mm_storel_epi64 ((__m128i*)pRow0, kPix);
+}
+
+// (1, -5, 20, 20, -5, 1) on 16-bit taps; exact for 8-bit input (-2550..10710)
+static inline WELS_TARGET_AVX2 __m256i Filter6Tap_avx2 (const __m256i kTap0, const __m256i kTap1, const __m256i kTap2,
+    const __m256i kTap3, const __m256i kTap4, const __m256i kTap5) {
+  const __m256i kPix05 = _mm256_add_epi16 (kTap0, kTap5);
+  const __m256i kPix14 = _mm256_add_epi16 (kTap1, kTap4);
+  const __m256i kPix23 = _mm256_add_epi16 (kTap2, kTap3);
+  return _mm256_sub_epi16 (_mm256_add_epi16 (kPix05, _mm256_mullo_epi16 (kPix23, _mm256_set1_epi16 (20))),
+                           _mm256_mullo_epi16 (kPix14, _mm256_set1_epi16 (5)));
+}
+
+// (x + 16) >> 5 with clipping to [0, 255]; lane 0 ends up in the low 8 bytes
+static inline WELS_TARGET_AVX2 __m128i RoundPack5_avx2 (const __m256i kSum) {
+  const __m256i kRes = _mm256_srai_epi16 (_mm256_add_epi16 (kSum, _mm256_set1_epi16 (16)), 5);
+  return _mm_packus_epi16 (_mm256_castsi256_si128 (kRes), _mm256_extracti128_si256 (kRes, 1));
+}
+
+static inline WELS_TARGET_AVX2 __m256i VerFilter16_avx2 (const uint8_t* pSrc, const int32_t kiStride) {
+  return Filter6Tap_avx2 (Load16To16Bit_avx2 (pSrc - 2 * kiStride), Load16To16Bit_avx2 (pSrc - kiStride),
+                          Load16To16Bit_avx2 (pSrc), Load16To16Bit_avx2 (pSrc + kiStride),
+                          Load16To16Bit_avx2 (pSrc + 2 * kiStride), Load16To16Bit_avx2 (pSrc + 3 * kiStride));
+}
+
+// second filter pass of the centre position on the 16-bit vertical taps:
+// per lane, kLow holds taps 0..7 and kHigh taps 8..15, output n uses taps n..n+5
+static inline WELS_TARGET_AVX2 __m128i HorFilterInput16Bit_avx2 (const __m256i kLow, const __m256i kHigh) {
+  const __m256i kPix05 = _mm256_add_epi16 (kLow, _mm256_alignr_epi8 (kHigh, kLow, 10));
+  const __m256i kPix14 = _mm256_add_epi16 (_mm256_alignr_epi8 (kHigh, kLow, 2), _mm256_alignr_epi8 (kHigh, kLow, 8));
+  const __m256i kPix23 = _mm256_add_epi16 (_mm256_alignr_epi8 (kHigh, kLow, 4), _mm256_alignr_epi8 (kHigh, kLow, 6));
+  // the sums leave the 16-bit range, so finish in 32 bits: (1, -5) and (10, 10) pairs through madd
+  const __m256i kCoef0514 = _mm256_unpacklo_epi16 (_mm256_set1_epi16 (1), _mm256_set1_epi16 (-5));
+  const __m256i kCoef2323 = _mm256_set1_epi16 (10);
+  const __m256i kRound = _mm256_set1_epi32 (512);
+  __m256i iLo = _mm256_add_epi32 (_mm256_madd_epi16 (_mm256_unpacklo_epi16 (kPix05, kPix14), kCoef0514),
+                                  _mm256_madd_epi16 (_mm256_unpacklo_epi16 (kPix23, kPix23), kCoef2323));
+  __m256i iHi = _mm256_add_epi32 (_mm256_madd_epi16 (_mm256_unpackhi_epi16 (kPix05, kPix14), kCoef0514),
+                                  _mm256_madd_epi16 (_mm256_unpackhi_epi16 (kPix23, kPix23), kCoef2323));
+  iLo = _mm256_srai_epi32 (_mm256_add_epi32 (iLo, kRound), 10);
+  iHi = _mm256_srai_epi32 (_mm256_add_epi32 (iHi, kRound), 10);
+  const __m256i kRes = _mm256_packs_epi32 (iLo, iHi);
+  return _mm_packus_epi16 (_mm256_castsi256_si128 (kRes), _mm256_extracti128_si256 (kRes, 1));
+}
+
+//horizontal filter to gain half sample, that is (2, 0) location in quarter sample
+WELS_TARGET_AVX2 void McHorVer20WidthEq16_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst,
+    int32_t iDstStride, int32_t iHeight) {
+  for (int32_t i = 0; i < iHeight; i++) {
+    const __m256i kSum = Filter6Tap_avx2 (Load16To16Bit_avx2 (pSrc - 2), Load16To16Bit_avx2 (pSrc - 1),
+                                          Load16To16Bit_avx2 (pSrc), Load16To16Bit_avx2 (pSrc + 1),
+                                          Load16To16Bit_avx2 (pSrc + 2), Load16To16Bit_avx2 (pSrc + 3));
+    _mm_storeu_si128 ((__m128i*)pDst, RoundPack5_avx2 (kSum));
+    pSrc += iSrcStride;
+    pDst += iDstStride;
+  }
+}
+
+WELS_TARGET_AVX2 void McHorVer20WidthEq8_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst,
+    int32_t iDstStride, int32_t iHeight) {
+  for (int32_t i = 0; i < iHeight; i += 2) {
+    const uint8_t* pSrc1 = (i + 1 < iHeight) ? pSrc + iSrcStride : pSrc;
+    uint8_t* pDst1 = (i + 1 < iHeight) ? pDst + iDstStride : pDst;
+    const __m256i kSum = Filter6Tap_avx2 (Load8x2To16Bit_avx2 (pSrc - 2, pSrc1 - 2),
+                                          Load8x2To16Bit_avx2 (pSrc - 1, pSrc1 - 1),
+                                          Load8x2To16Bit_avx2 (pSrc, pSrc1),
+                                          Load8x2To16Bit_avx2 (pSrc + 1, pSrc1 + 1),
+                                          Load8x2To16Bit_avx2 (pSrc + 2, pSrc1 + 2),
+                                          Load8x2To16Bit_avx2 (pSrc + 3, pSrc1 + 3));
+    Store8x2_avx2 (pDst, pDst1, RoundPack5_avx2 (kSum));
+    pSrc += iSrcStride << 1;
+    pDst += iDstStride << 1;
+  }
+}
+
+//vertical filter to gain half sample, that is (0, 2) location in quarter sample
+WELS_TARGET_AVX2 void McHorVer02WidthEq16_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst,
+    int32_t iDstStride, int32_t iHeight) {
+  __m256i iRow0 = Load16To16Bit_avx2 (pSrc - 2 * iSrcStride);
+  __m256i iRow1 = Load16To16Bit_avx2 (pSrc - iSrcStride);
+  __m256i iRow2 = Load16To16Bit_avx2 (pSrc);
+  __m256i iRow3 = Load16To16Bit_avx2 (pSrc + iSrcStride);
+  __m256i iRow4 = Load16To16Bit_avx2 (pSrc + 2 * iSrcStride);
+  pSrc += 3 * iSrcStride;
+  for (int32_t i = 0; i < iHeight; i++) {
+    const __m256i kRow5 = Load16To16Bit_avx2 (pSrc);
+    _mm_storeu_si128 ((__m128i*)pDst, RoundPack5_avx2 (Filter6Tap_avx2 (iRow0, iRow1, iRow2, iRow3, iRow4, kRow5)));
+    iRow0 = iRow1;
+    iRow1 = iRow2;
+    iRow2 = iRow3;
+    iRow3 = iRow4;
+    iRow4 = kRow5;
+    pSrc += iSrcStride;
+    pDst += iDstStride;
+  }
+}
+
+WELS_TARGET_AVX2 void McHorVer02WidthEq8_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst,
+    int32_t iDstStride, int32_t iHeight) {
+  for (int32_t i = 0; i < iHeight; i += 2) {
+    const uint8_t* pSrc1 = (i + 1 < iHeight) ? pSrc + iSrcStride : pSrc;
+    uint8_t* pDst1 = (i + 1 < iHeight) ? pDst + iDstStride : pDst;
+    const __m256i kSum = Filter6Tap_avx2 (Load8x2To16Bit_avx2 (pSrc - 2 * iSrcStride, pSrc1 - 2 * iSrcStride),
+                                          Load8x2To16Bit_avx2 (pSrc - iSrcStride, pSrc1 - iSrcStride),
+                                          Load8x2To16Bit_avx2 (pSrc, pSrc1),
+                                          Load8x2To16Bit_avx2 (pSrc + iSrcStride, pSrc1 + iSrcStride),
+                                          Load8x2To16Bit_avx2 (pSrc + 2 * iSrcStride, pSrc1 + 2 * iSrcStride),
+                                          Load8x2To16Bit_avx2 (pSrc + 3 * iSrcStride, pSrc1 + 3 * iSrcStride));
+    Store8x2_avx2 (pDst, pDst1, RoundPack5_avx2 (kSum));
+    pSrc += iSrcStride << 1;
+    pDst += iDstStride << 1;
+  }
+}
+
+//horizontal and vertical filter to gain half sample, that is (2, 2) location in quarter sample
+WELS_TARGET_AVX2 void McHorVer22WidthEq16_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst,
+    int32_t iDstStride, int32_t iHeight) {
+  for (int32_t i = 0; i < iHeight; i++) {
+    // vertical taps of columns -2..13, then 14..21 (only 14..18 are used)
+    const __m256i kVer0 = VerFilter16_avx2 (pSrc - 2, iSrcStride);
+    const __m256i kVer1 = Filter6Tap_avx2 (
+                            _mm256_cvtepu8_epi16 (_mm_loadl_epi64 ((const __m128i*) (pSrc + 14 - 2 * iSrcStride))),
+                            _mm256_cvtepu8_epi16 (_mm_loadl_epi64 ((const __m128i*) (pSrc + 14 - iSrcStride))),
+                            _mm256_cvtepu8_epi16 (_mm_loadl_epi64 ((const __m128i*) (pSrc + 14))),
+                            _mm256_cvtepu8_epi16 (_mm_loadl_epi64 ((const __m128i*) (pSrc + 14 + iSrcStride))),
+                            _mm256_cvtepu8_epi16 (_mm_loadl_epi64 ((const __m128i*) (pSrc + 14 + 2 * iSrcStride))),
+                            _mm256_cvtepu8_epi16 (_mm_loadl_epi64 ((const __m128i*) (pSrc + 14 + 3 * iSrcStride))));
+    _mm_storeu_si128 ((__m128i*)pDst,
+                      HorFilterInput16Bit_avx2 (kVer0, _mm256_permute2x128_si256 (kVer0, kVer1, 0x21)));
+    pSrc += iSrcStride;
+    pDst += iDstStride;
+  }
+}
+
+WELS_TARGET_AVX2 void McHorVer22WidthEq8_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst,
+    int32_t iDstStride, int32_t iHeight) {
+  for (int32_t i = 0; i < iHeight; i += 2) {
+    const uint8_t* pSrc1 = (i + 1 < iHeight) ? pSrc + iSrcStride : pSrc;
+    uint8_t* pDst1 = (i + 1 < iHeight) ? pDst + iDstStride : pDst;
+    const __m256i kVer0 = VerFilter16_avx2 (pSrc - 2, iSrcStride);
+    const __m256i kVer1 = VerFilter16_avx2 (pSrc1 - 2, iSrcStride);
+    Store8x2_avx2 (pDst, pDst1, HorFilterInput16Bit_avx2 (_mm256_permute2x128_si256 (kVer0, kVer1, 0x20),
+                   _mm256_permute2x128_si256 (kVer0, kVer1, 0x31)));
+    pSrc += iSrcStride << 1;
+    pDst += iDstStride << 1;
+  }
+}
+
+// kpABCD as in g_kuiABCD; iHeight is even
+WELS_TARGET_AVX2 void McChromaWidthEq8_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst,
+    int32_t iDstStride, const uint8_t* kpABCD, int32_t iHeight) {
+  const __m256i kCoefAB = _mm256_set1_epi16 ((int16_t) (kpABCD[0] | (kpABCD[1] << 8)));
+  const __m256i kCoefCD = _mm256_set1_epi16 ((int16_t) (kpABCD[2] | (kpABCD[3] << 8)));
+  const __m256i kRound = _mm256_set1_epi16 (32);
+  // each row as the byte pairs (p[j], p[j + 1]) so that maddubs applies two weights at once
+  __m128i iRow0 = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i*)pSrc),
+                                     _mm_loadl_epi64 ((const __m128i*) (pSrc + 1)));
+  for (int32_t i = 0; i < iHeight; i += 2) {
+    const __m128i kRow1 = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i*) (pSrc + iSrcStride)),
+                          _mm_loadl_epi64 ((const __m128i*) (pSrc + iSrcStride + 1)));
+    const __m128i kRow2 = _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i*) (pSrc + 2 * iSrcStride)),
+                          _mm_loadl_epi64 ((const __m128i*) (pSrc + 2 * iSrcStride + 1)));
+    const __m256i kTop = _mm256_inserti128_si256 (_mm256_castsi128_si256 (iRow0), kRow1, 1);
+    const __m256i kBottom = _mm256_inserti128_si256 (_mm256_castsi128_si256 (kRow1), kRow2, 1);
+    __m256i iSum = _mm256_add_epi16 (_mm256_maddubs_epi16 (kTop, kCoefAB), _mm256_maddubs_epi16 (kBottom, kCoefCD));
+    iSum = _mm256_srli_epi16 (_mm256_add_epi16 (iSum, kRound), 6);
+    Store8x2_avx2 (pDst, pDst + iDstStride,
+                   _mm_packus_epi16 (_mm256_castsi256_si128 (iSum), _mm256_extracti128_si256 (iSum, 1)));
+    iRow0 = kRow2;
+    pSrc += iSrcStride << 1;
+    pDst += iDstStride << 1;
+  }
+}
+
+#endif//X86_INTRINSICS
@@ -35,18 +35,41 @@
 #include "memory_align.h"
 #include "macros.h"
 
-namespace WelsSVCEnc {
+#define POOLED_BLOCK_MIN_SIZE	4096	// smaller blocks are cheap to get from malloc() again
+#define POOLED_BLOCK_MAX_SIZE	(1 << 30)	// keeps the rounding in BlockSize() within 32 bits
+
+/* header written over a block while it is idle */
+typedef struct TagIdleBlock {
+  struct TagIdleBlock*	pNext;
+  uint32_t			uiSize;
+} SIdleBlock;
+
+/*
+ * pooled blocks are rounded up to 1/8 of the next lower power of two, so that a block
+ * is reused by requests a little different in size while wasting at most 12.5%
+ */
+static inline uint32_t BlockSize (const uint32_t kuiSize) {
+  uint32_t uiStep = POOLED_BLOCK_MIN_SIZE >> 3;
+
+  if (kuiSize < POOLED_BLOCK_MIN_SIZE || kuiSize > POOLED_BLOCK_MAX_SIZE)
+    return kuiSize;
+  while ((uiStep << 4) <= kuiSize)
+    uiStep <<= 1;
+  return (kuiSize + uiStep - 1) & ~ (uiStep - 1);
+}
 
 CMemoryAlign::CMemoryAlign (const uint32_t kuiCacheLineSize)
-#ifdef MEMORY_MONITOR
-  :	m_nMemoryUsageInBytes (0)
-#endif//MEMORY_MONITOR
-{
+  :	m_nMemoryUsageInBytes (0),
+    m_nPeakMemoryUsageInBytes (0),
+    m_nIdleMemoryInBytes (0),
+    m_pIdleBlocks (NULL) {
   if ((kuiCacheLineSize == 0) || (kuiCacheLineSize & 0x0f))
     m_nCacheLineSize	= 0x10;
   else
     m_nCacheLineSize	= kuiCacheLineSize;
 
+  WelsMutexInit (&m_hMutex);
+
 #ifdef MEMORY_CHECK
   m_fpMemChkPoint		= fopen ("./enc_mem_check_point.txt",  "wt+");
   m_nCountRequestNum	= 0;
@@ -54,9 +77,8 @@ CMemoryAlign::CMemoryAlign (const uint32_t kuiCacheLineSize)
 }
 
 CMemoryAlign::~CMemoryAlign() {
-#ifdef MEMORY_MONITOR
-  assert (m_nMemoryUsageInBytes == 0);
-#endif//MEMORY_MONITOR
+  WelsReleaseIdleBlocks();
+  WelsMutexDestroy (&m_hMutex);
 
 #ifdef MEMORY_CHECK
   fclose (m_fpMemChkPoint);
@@ -84,8 +106,23 @@ void* CMemoryAlign::WelsMalloc (const uint32_t kuiSize, const char* kpTag) {
   const int32_t kiTrialRequestedSize	= kuiSize + kiAlignedBytes + kiSizeOfVoidPointer + kiSizeOfInt;
   const int32_t kiActualRequestedSize	= kiTrialRequestedSize;
   const uint32_t kiPayloadSize			= kuiSize;
-
-  uint8_t* pBuf		= (uint8_t*) malloc (kiActualRequestedSize);
+  const uint32_t kuiBlockSize			= BlockSize (kiActualRequestedSize);
+  uint8_t* pBuf = NULL;
+
+  if (kuiBlockSize >= POOLED_BLOCK_MIN_SIZE && kuiBlockSize <= POOLED_BLOCK_MAX_SIZE) {
+    WelsMutexLock (&m_hMutex);
+    SIdleBlock** ppIdle = &m_pIdleBlocks;
+    while (NULL != *ppIdle && (*ppIdle)->uiSize != kuiBlockSize)
+      ppIdle = & (*ppIdle)->pNext;
+    if (NULL != *ppIdle) {
+      pBuf = (uint8_t*) (*ppIdle);
+      *ppIdle = (*ppIdle)->pNext;
+      m_nIdleMemoryInBytes -= kuiBlockSize;
+    }
+    WelsMutexUnlock (&m_hMutex);
+  }
+  if (NULL == pBuf)
+    pBuf = (uint8_t*) malloc (kuiBlockSize);
 #ifdef MEMORY_CHECK
   if (m_fpMemChkPoint != NULL) {
     if (kpTag != NULL)
@@ -107,31 +144,59 @@ void* CMemoryAlign::WelsMalloc (const uint32_t kuiSize, const char* kpTag) {
   * ((void**) (pAlignedBuffer - kiSizeOfVoidPointer)) = pBuf;
   * ((int32_t*) (pAlignedBuffer - (kiSizeOfVoidPointer + kiSizeOfInt))) = kiPayloadSize;
 
-#ifdef MEMORY_MONITOR
+  WelsMutexLock (&m_hMutex);
   m_nMemoryUsageInBytes += kiActualRequestedSize;
-#endif//MEMORY_MONITOR
+  if (m_nMemoryUsageInBytes > m_nPeakMemoryUsageInBytes)
+    m_nPeakMemoryUsageInBytes = m_nMemoryUsageInBytes;
+  WelsMutexUnlock (&m_hMutex);
 
   return pAlignedBuffer;
 }
 
 void CMemoryAlign::WelsFree (void* pPointer, const char* kpTag) {
   if (pPointer) {
-#ifdef MEMORY_MONITOR
     const int32_t kiMemoryLength = * ((int32_t*) ((uint8_t*)pPointer - sizeof (void**) - sizeof (
                                         int32_t))) + m_nCacheLineSize - 1 + sizeof (void**) + sizeof (int32_t);
-    m_nMemoryUsageInBytes -= kiMemoryLength;
-#endif//MEMORY_MONITOR
+    const uint32_t kuiBlockSize = BlockSize (kiMemoryLength);
+    void* pBuf = * (((void**) pPointer) - 1);
 #ifdef MEMORY_CHECK
     if (m_fpMemChkPoint != NULL) {
       if (kpTag != NULL)
-        fprintf (m_fpMemChkPoint, "WelsFree(), 0x%x - %s: \t%d\t bytes \n", (void*) (* (((void**) pPointer) - 1)), kpTag,
-                 kiMemoryLength);
+        fprintf (m_fpMemChkPoint, "WelsFree(), 0x%x - %s: \t%d\t bytes \n", pBuf, kpTag, kiMemoryLength);
       else
-        fprintf (m_fpMemChkPoint, "WelsFree(), 0x%x \n", (void*) (* (((void**) pPointer) - 1)));
+        fprintf (m_fpMemChkPoint, "WelsFree(), 0x%x \n", pBuf);
       fflush (m_fpMemChkPoint);
     }
 #endif
-    free (* (((void**) pPointer) - 1));
+    WelsMutexLock (&m_hMutex);
+    m_nMemoryUsageInBytes -= kiMemoryLength;
+    // keep it for reuse, never holding more idle than the peak in use plus the rounding of the blocks
+    if (kuiBlockSize >= POOLED_BLOCK_MIN_SIZE && kuiBlockSize <= POOLED_BLOCK_MAX_SIZE
+        && m_nIdleMemoryInBytes + kuiBlockSize <= m_nPeakMemoryUsageInBytes + (m_nPeakMemoryUsageInBytes >> 3)) {
+      SIdleBlock* pIdle	= (SIdleBlock*)pBuf;
+      pIdle->pNext		= m_pIdleBlocks;
+      pIdle->uiSize		= kuiBlockSize;
+      m_pIdleBlocks		= pIdle;
+      m_nIdleMemoryInBytes += kuiBlockSize;
+      pBuf = NULL;
+    }
+    WelsMutexUnlock (&m_hMutex);
+    if (NULL != pBuf)
+      free (pBuf);
+  }
+}
+
+void CMemoryAlign::WelsReleaseIdleBlocks() {
+  WelsMutexLock (&m_hMutex);
+  SIdleBlock* pIdle		= m_pIdleBlocks;
+  m_pIdleBlocks			= NULL;
+  m_nIdleMemoryInBytes	= 0;
+  WelsMutexUnlock (&m_hMutex);
+
+  while (NULL != pIdle) {
+    SIdleBlock* pNext = pIdle->pNext;
+    free (pIdle);
+    pIdle = pNext;
   }
 }
 
@@ -140,7 +205,22 @@ const uint32_t CMemoryAlign::WelsGetCacheLineSize() const {
 }
 
 const uint32_t CMemoryAlign::WelsGetMemoryUsage() const {
-  return m_nMemoryUsageInBytes;
+  WelsMutexLock (&m_hMutex);
+  const uint32_t kuiUsage = m_nMemoryUsageInBytes;
+  WelsMutexUnlock (&m_hMutex);
+  return kuiUsage;
+}
+
+const uint32_t CMemoryAlign::WelsGetPeakMemoryUsage() const {
+  WelsMutexLock (&m_hMutex);
+  const uint32_t kuiUsage = m_nPeakMemoryUsageInBytes;
+  WelsMutexUnlock (&m_hMutex);
+  return kuiUsage;
 }
 
-} // end of namespace WelsSVCEnc
+const uint32_t CMemoryAlign::WelsGetIdleMemoryUsage() const {
+  WelsMutexLock (&m_hMutex);
+  const uint32_t kuiUsage = m_nIdleMemoryInBytes;
+  WelsMutexUnlock (&m_hMutex);
+  return kuiUsage;
+}
@@ -40,6 +40,9 @@
 
 #include "sad_common.h"
 #include "macros.h"
+#if defined(X86_INTRINSICS)
+#include <immintrin.h>
+#endif//X86_INTRINSICS
 
 int32_t WelsSampleSad4x4_c (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2, int32_t iStride2) {
   int32_t iSadSum = 0;
@@ -136,4 +139,134 @@ void WelsSampleSadFour4x4_c (uint8_t* iSample1, int32_t iStride1, uint8_t* iSamp
     * (pSad + 1) = WelsSampleSad4x4_c (iSample1, iStride1, (iSample2 + iStride2), iStride2);
     * (pSad + 2) = WelsSampleSad4x4_c (iSample1, iStride1, (iSample2 - 1), iStride2);
     * (pSad + 3) = WelsSampleSad4x4_c (iSample1, iStride1, (iSample2 + 1), iStride2);
-}
\ No newline at end of file
+}
+
+#if defined(X86_INTRINSICS)
+// two 8-pixel rows packed into one xmm
+static inline WELS_TARGET_AVX2 __m128i Load8x2_avx2 (const uint8_t* pRow0, const uint8_t* pRow1) {
+  return _mm_unpacklo_epi64 (_mm_loadl_epi64 ((const __m128i*)pRow0), _mm_loadl_epi64 ((const __m128i*)pRow1));
+}
+
+static inline WELS_TARGET_AVX2 __m256i Combine128_avx2 (const __m128i kLow, const __m128i kHigh) {
+  return _mm256_inserti128_si256 (_mm256_castsi128_si256 (kLow), kHigh, 1);
+}
+
+// sum of the four 64-bit partial sums left by _mm256_sad_epu8
+static inline WELS_TARGET_AVX2 int32_t SumSad_avx2 (const __m256i kSad) {
+  const __m128i kSum = _mm_add_epi32 (_mm256_castsi256_si128 (kSad), _mm256_extracti128_si256 (kSad, 1));
+  return _mm_cvtsi128_si32 (_mm_add_epi32 (kSum, _mm_unpackhi_epi64 (kSum, kSum)));
+}
+
+// 16 pixels wide, two rows per ymm
+static inline WELS_TARGET_AVX2 int32_t SampleSad16xN_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, const int32_t kiHeight) {
+  __m256i iSad = _mm256_setzero_si256();
+  for (int32_t i = 0; i < kiHeight; i += 2) {
+    const __m256i kSrc = Combine128_avx2 (_mm_loadu_si128 ((const __m128i*)pSample1),
+                                          _mm_loadu_si128 ((const __m128i*) (pSample1 + iStride1)));
+    const __m256i kRef = Combine128_avx2 (_mm_loadu_si128 ((const __m128i*)pSample2),
+                                          _mm_loadu_si128 ((const __m128i*) (pSample2 + iStride2)));
+    iSad = _mm256_add_epi64 (iSad, _mm256_sad_epu8 (kSrc, kRef));
+    pSample1 += iStride1 << 1;
+    pSample2 += iStride2 << 1;
+  }
+  return SumSad_avx2 (iSad);
+}
+
+// 8 pixels wide, four rows per ymm
+static inline WELS_TARGET_AVX2 int32_t SampleSad8xN_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, const int32_t kiHeight) {
+  __m256i iSad = _mm256_setzero_si256();
+  for (int32_t i = 0; i < kiHeight; i += 4) {
+    const __m256i kSrc = Combine128_avx2 (Load8x2_avx2 (pSample1, pSample1 + iStride1),
+                                          Load8x2_avx2 (pSample1 + (iStride1 << 1), pSample1 + 3 * iStride1));
+    const __m256i kRef = Combine128_avx2 (Load8x2_avx2 (pSample2, pSample2 + iStride2),
+                                          Load8x2_avx2 (pSample2 + (iStride2 << 1), pSample2 + 3 * iStride2));
+    iSad = _mm256_add_epi64 (iSad, _mm256_sad_epu8 (kSrc, kRef));
+    pSample1 += iStride1 << 2;
+    pSample2 += iStride2 << 2;
+  }
+  return SumSad_avx2 (iSad);
+}
+
+WELS_TARGET_AVX2 int32_t WelsSampleSad16x16_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2) {
+  return SampleSad16xN_avx2 (pSample1, iStride1, pSample2, iStride2, 16);
+}
+WELS_TARGET_AVX2 int32_t WelsSampleSad16x8_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2) {
+  return SampleSad16xN_avx2 (pSample1, iStride1, pSample2, iStride2, 8);
+}
+WELS_TARGET_AVX2 int32_t WelsSampleSad8x16_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2) {
+  return SampleSad8xN_avx2 (pSample1, iStride1, pSample2, iStride2, 16);
+}
+WELS_TARGET_AVX2 int32_t WelsSampleSad8x8_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2) {
+  return SampleSad8xN_avx2 (pSample1, iStride1, pSample2, iStride2, 8);
+}
+
+// the up/down references share one ymm and the left/right ones another, lane order matching pSad[]
+static inline WELS_TARGET_AVX2 void StoreSadFour_avx2 (const __m256i kSadUpDown, const __m256i kSadLeftRight,
+    int32_t* pSad) {
+  const __m256i kSum = _mm256_add_epi32 (_mm256_unpacklo_epi64 (kSadUpDown, kSadLeftRight),
+                                         _mm256_unpackhi_epi64 (kSadUpDown, kSadLeftRight));
+  pSad[0] = _mm256_extract_epi32 (kSum, 0);
+  pSad[1] = _mm256_extract_epi32 (kSum, 4);
+  pSad[2] = _mm256_extract_epi32 (kSum, 2);
+  pSad[3] = _mm256_extract_epi32 (kSum, 6);
+}
+
+static inline WELS_TARGET_AVX2 void SampleSadFour16xN_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, int32_t* pSad, const int32_t kiHeight) {
+  __m256i iSadUpDown = _mm256_setzero_si256();
+  __m256i iSadLeftRight = _mm256_setzero_si256();
+  for (int32_t i = 0; i < kiHeight; i++) {
+    const __m256i kSrc = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i*)pSample1));
+    const __m256i kRefUpDown = Combine128_avx2 (_mm_loadu_si128 ((const __m128i*) (pSample2 - iStride2)),
+                               _mm_loadu_si128 ((const __m128i*) (pSample2 + iStride2)));
+    const __m256i kRefLeftRight = Combine128_avx2 (_mm_loadu_si128 ((const __m128i*) (pSample2 - 1)),
+                                  _mm_loadu_si128 ((const __m128i*) (pSample2 + 1)));
+    iSadUpDown = _mm256_add_epi64 (iSadUpDown, _mm256_sad_epu8 (kSrc, kRefUpDown));
+    iSadLeftRight = _mm256_add_epi64 (iSadLeftRight, _mm256_sad_epu8 (kSrc, kRefLeftRight));
+    pSample1 += iStride1;
+    pSample2 += iStride2;
+  }
+  StoreSadFour_avx2 (iSadUpDown, iSadLeftRight, pSad);
+}
+
+static inline WELS_TARGET_AVX2 void SampleSadFour8xN_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, int32_t* pSad, const int32_t kiHeight) {
+  __m256i iSadUpDown = _mm256_setzero_si256();
+  __m256i iSadLeftRight = _mm256_setzero_si256();
+  for (int32_t i = 0; i < kiHeight; i += 2) {
+    const __m256i kSrc = _mm256_broadcastsi128_si256 (Load8x2_avx2 (pSample1, pSample1 + iStride1));
+    const __m256i kRefUpDown = Combine128_avx2 (Load8x2_avx2 (pSample2 - iStride2, pSample2),
+                               Load8x2_avx2 (pSample2 + iStride2, pSample2 + (iStride2 << 1)));
+    const __m256i kRefLeftRight = Combine128_avx2 (Load8x2_avx2 (pSample2 - 1, pSample2 + iStride2 - 1),
+                                  Load8x2_avx2 (pSample2 + 1, pSample2 + iStride2 + 1));
+    iSadUpDown = _mm256_add_epi64 (iSadUpDown, _mm256_sad_epu8 (kSrc, kRefUpDown));
+    iSadLeftRight = _mm256_add_epi64 (iSadLeftRight, _mm256_sad_epu8 (kSrc, kRefLeftRight));
+    pSample1 += iStride1 << 1;
+    pSample2 += iStride2 << 1;
+  }
+  StoreSadFour_avx2 (iSadUpDown, iSadLeftRight, pSad);
+}
+
+WELS_TARGET_AVX2 void WelsSampleSadFour16x16_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, int32_t* pSad) {
+  SampleSadFour16xN_avx2 (pSample1, iStride1, pSample2, iStride2, pSad, 16);
+}
+WELS_TARGET_AVX2 void WelsSampleSadFour16x8_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, int32_t* pSad) {
+  SampleSadFour16xN_avx2 (pSample1, iStride1, pSample2, iStride2, pSad, 8);
+}
+WELS_TARGET_AVX2 void WelsSampleSadFour8x16_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, int32_t* pSad) {
+  SampleSadFour8xN_avx2 (pSample1, iStride1, pSample2, iStride2, pSad, 16);
+}
+WELS_TARGET_AVX2 void WelsSampleSadFour8x8_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, int32_t* pSad) {
+  SampleSadFour8xN_avx2 (pSample1, iStride1, pSample2, iStride2, pSad, 8);
+}
+#endif//X86_INTRINSICS
@@ -33,7 +33,7 @@
 #include "d3d9_utils.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-void Write2File (FILE* pFp, unsigned char* pData[3], int iStride[2], int iWidth, int iHeight);
+void Write2File (FILE* pFp, unsigned char* pData[3], int iStride[2], int iWidth, int iHeight, int iFormat);
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #ifdef ENABLE_DISPLAY_MODULE
@@ -174,7 +174,7 @@ HRESULT CD3D9Utils::Dump (void* pDst[3], SBufferInfo* pInfo, FILE* pFp) {
   iStride[1] = pInfo->UsrData.sSystemBuffer.iStride[1];
 
   if (pDst[0] && pDst[1] && pDst[2])
-    Write2File (pFp, (unsigned char**)pDst, iStride, iWidth, iHeight);
+    Write2File (pFp, (unsigned char**)pDst, iStride, iWidth, iHeight, pInfo->UsrData.sSystemBuffer.iFormat);
 
   return hResult;
 }
@@ -343,7 +343,7 @@ HRESULT CD3D9ExUtils::Dump (void* pDst[3], SBufferInfo* pInfo, FILE* pFp) {
     iStride[1] = pInfo->UsrData.sSystemBuffer.iStride[1];
 
   if (pDst[0] && pDst[1] && pDst[2])
-    Write2File (pFp, (unsigned char**)pDst, iStride, iWidth, iHeight);
+    Write2File (pFp, (unsigned char**)pDst, iStride, iWidth, iHeight, pInfo->UsrData.sSystemBuffer.iFormat);
 
   return hResult;
 }
@@ -534,14 +534,14 @@ int CUtils::Process (void* pDst[3], SBufferInfo* pInfo, FILE* pFp) {
   int iRet = 0;
 
   if (iOSType == OS_UNSUPPORTED) {
-    if (pFp && pDst[0] && pDst[1] && pDst[2] && pInfo) {
+    if (pFp && pDst[0] && pInfo) {
       int iStride[2];
       int iWidth = pInfo->UsrData.sSystemBuffer.iWidth;
       int iHeight = pInfo->UsrData.sSystemBuffer.iHeight;
       iStride[0] = pInfo->UsrData.sSystemBuffer.iStride[0];
       iStride[1] = pInfo->UsrData.sSystemBuffer.iStride[1];
 
-      Write2File (pFp, (unsigned char**)pDst, iStride, iWidth, iHeight);
+      Write2File (pFp, (unsigned char**)pDst, iStride, iWidth, iHeight, pInfo->UsrData.sSystemBuffer.iFormat);
     }
   }
 
@@ -601,17 +601,29 @@ int CUtils::CheckOS() {
   return iType;
 }
 
-void Write2File (FILE* pFp, unsigned char* pData[3], int iStride[2], int iWidth, int iHeight) {
+void Write2File (FILE* pFp, unsigned char* pData[3], int iStride[2], int iWidth, int iHeight, int iFormat) {
   int   i;
   unsigned char*  pPtr = NULL;
+  const bool kbPacked = (iFormat == videoFormatRGBA || iFormat == videoFormatBGRA);
 
   pPtr = pData[0];
   for (i = 0; i < iHeight; i++) {
-    fwrite (pPtr, 1, iWidth, pFp);
+    fwrite (pPtr, 1, kbPacked ? iWidth * 4 : iWidth, pFp);
     pPtr += iStride[0];
   }
+  if (kbPacked)
+    return;
 
   iHeight = iHeight / 2;
+  if (iFormat == videoFormatNV12) {
+    // interleaved chroma rows as wide as the luma ones
+    pPtr = pData[1];
+    for (i = 0; i < iHeight; i++) {
+      fwrite (pPtr, 1, iWidth, pFp);
+      pPtr += iStride[1];
+    }
+    return;
+  }
   iWidth = iWidth / 2;
   pPtr = pData[1];
   for (i = 0; i < iHeight; i++) {
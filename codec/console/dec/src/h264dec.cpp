@@ -86,7 +86,6 @@ void H264DecodeInstance (ISVCDecoder* pDecoder, const char* kpH264FileName, cons
   int32_t iLastWidth = 0, iLastHeight = 0;
   int32_t iFrameCount = 0;
   int32_t iEndOfStreamFlag = 0;
-  int32_t iColorFormat = videoFormatInternal;
 
   CUtils cOutputModule;
   double dElapsed = 0;
@@ -149,11 +148,6 @@ void H264DecodeInstance (ISVCDecoder* pDecoder, const char* kpH264FileName, cons
 
   memcpy (pBuf + iFileSize, &uiStartCode[0], 4); //confirmed_safe_unsafe_usage
 
-  if (pDecoder->SetOption (DECODER_OPTION_DATAFORMAT,  &iColorFormat)) {
-    fprintf (stderr, "SetOption() failed, opt_id : %d  ..\n", DECODER_OPTION_DATAFORMAT);
-    goto label_exit;
-  }
-
 #if defined ( STICK_STREAM_SIZE )
   FILE* fpTrack = fopen ("3.len", "rb");
 
@@ -239,34 +233,36 @@ void H264DecodeInstance (ISVCDecoder* pDecoder, const char* kpH264FileName, cons
     ++ iSliceIndex;
   }
 
-  // Get pending last frame
-  pData[0] = NULL;
-  pData[1] = NULL;
-  pData[2] = NULL;
-  memset (&sDstBufInfo, 0, sizeof (SBufferInfo));
-
-  pDecoder->DecodeFrame2 (NULL, 0, pData, &sDstBufInfo);
-  if (sDstBufInfo.iBufferStatus == 1) {
-    pDst[0] = (uint8_t*)pData[0];
-    pDst[1] = (uint8_t*)pData[1];
-    pDst[2] = (uint8_t*)pData[2];
-  }
+  // Get pending last frames, frame level threading keeps several in flight
+  do {
+    pData[0] = NULL;
+    pData[1] = NULL;
+    pData[2] = NULL;
+    memset (&sDstBufInfo, 0, sizeof (SBufferInfo));
 
-  if (sDstBufInfo.iBufferStatus == 1) {
-    cOutputModule.Process ((void**)pDst, &sDstBufInfo, pYuvFile);
-    iWidth  = sDstBufInfo.UsrData.sSystemBuffer.iWidth;
-    iHeight = sDstBufInfo.UsrData.sSystemBuffer.iHeight;
-
-    if (pOptionFile != NULL) {
-      /* Anyway, we need write in case of final frame decoding */
-      fwrite (&iFrameCount, sizeof (iFrameCount), 1, pOptionFile);
-      fwrite (&iWidth , sizeof (iWidth) , 1, pOptionFile);
-      fwrite (&iHeight, sizeof (iHeight), 1, pOptionFile);
-      iLastWidth	= iWidth;
-      iLastHeight	= iHeight;
+    pDecoder->DecodeFrame2 (NULL, 0, pData, &sDstBufInfo);
+    if (sDstBufInfo.iBufferStatus == 1) {
+      pDst[0] = (uint8_t*)pData[0];
+      pDst[1] = (uint8_t*)pData[1];
+      pDst[2] = (uint8_t*)pData[2];
     }
-    ++ iFrameCount;
-  }
+
+    if (sDstBufInfo.iBufferStatus == 1) {
+      cOutputModule.Process ((void**)pDst, &sDstBufInfo, pYuvFile);
+      iWidth  = sDstBufInfo.UsrData.sSystemBuffer.iWidth;
+      iHeight = sDstBufInfo.UsrData.sSystemBuffer.iHeight;
+
+      if (pOptionFile != NULL) {
+        /* Anyway, we need write in case of final frame decoding */
+        fwrite (&iFrameCount, sizeof (iFrameCount), 1, pOptionFile);
+        fwrite (&iWidth , sizeof (iWidth) , 1, pOptionFile);
+        fwrite (&iHeight, sizeof (iHeight), 1, pOptionFile);
+        iLastWidth	= iWidth;
+        iLastHeight	= iHeight;
+      }
+      ++ iFrameCount;
+    }
+  } while (sDstBufInfo.iBufferStatus == 1);
 
 
 #if defined ( STICK_STREAM_SIZE )
@@ -356,6 +352,22 @@ int32_t main (int32_t iArgC, char* pArgV[]) {
             sDecParam.uiCpuLoad	= (uint32_t)atol (strTag[1].c_str());
           } else if (strTag[0].compare ("VideoBitstreamType") == 0) {
             sDecParam.sVideoProperty.eVideoBsType = (VIDEO_BITSTREAM_TYPE)atol (strTag[1].c_str());
+          } else if (strTag[0].compare ("ThreadCount") == 0) {
+            sDecParam.iThreadCount = atol (strTag[1].c_str());
+          } else if (strTag[0].compare ("RowThreadCount") == 0) {
+            sDecParam.iRowThreadCount = atol (strTag[1].c_str());
+          } else if (strTag[0].compare ("SliceThreadCount") == 0) {
+            sDecParam.iSliceThreadCount = atol (strTag[1].c_str());
+          } else if (strTag[0].compare ("PipelineDeblocking") == 0) {
+            sDecParam.bPipelineDeblocking = (atol (strTag[1].c_str()) != 0);
+          } else if (strTag[0].compare ("MaxWidth") == 0) {
+            sDecParam.iMaxWidth = atol (strTag[1].c_str());
+          } else if (strTag[0].compare ("MaxHeight") == 0) {
+            sDecParam.iMaxHeight = atol (strTag[1].c_str());
+          } else if (strTag[0].compare ("OutputWidth") == 0) {
+            sDecParam.iOutputWidth = atol (strTag[1].c_str());
+          } else if (strTag[0].compare ("OutputHeight") == 0) {
+            sDecParam.iOutputHeight = atol (strTag[1].c_str());
           }
         }
       }
@@ -396,6 +408,52 @@ int32_t main (int32_t iArgC, char* pArgV[]) {
             printf ("trace level not specified.\n");
             return 1;
           }
+        } else if (!strcmp (cmd, "-threads")) {
+          if (i + 1 < iArgC)
+            sDecParam.iThreadCount = atoi (pArgV[++i]);
+          else {
+            printf ("thread count not specified.\n");
+            return 1;
+          }
+        } else if (!strcmp (cmd, "-rowthreads")) {
+          if (i + 1 < iArgC)
+            sDecParam.iRowThreadCount = atoi (pArgV[++i]);
+          else {
+            printf ("row thread count not specified.\n");
+            return 1;
+          }
+        } else if (!strcmp (cmd, "-slicethreads")) {
+          if (i + 1 < iArgC)
+            sDecParam.iSliceThreadCount = atoi (pArgV[++i]);
+          else {
+            printf ("slice thread count not specified.\n");
+            return 1;
+          }
+        } else if (!strcmp (cmd, "-pipelinedeblock")) {
+          sDecParam.bPipelineDeblocking = true;
+        } else if (!strcmp (cmd, "-maxsize")) {
+          if (i + 2 < iArgC) {
+            sDecParam.iMaxWidth = atoi (pArgV[++i]);
+            sDecParam.iMaxHeight = atoi (pArgV[++i]);
+          } else {
+            printf ("max width and height not specified.\n");
+            return 1;
+          }
+        } else if (!strcmp (cmd, "-outformat")) {
+          if (i + 1 < iArgC)
+            sDecParam.iOutputColorFormat = atoi (pArgV[++i]);
+          else {
+            printf ("output color format not specified.\n");
+            return 1;
+          }
+        } else if (!strcmp (cmd, "-outsize")) {
+          if (i + 2 < iArgC) {
+            sDecParam.iOutputWidth = atoi (pArgV[++i]);
+            sDecParam.iOutputHeight = atoi (pArgV[++i]);
+          } else {
+            printf ("output width and height not specified.\n");
+            return 1;
+          }
         }
       }
     }
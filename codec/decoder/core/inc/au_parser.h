@@ -64,6 +64,21 @@ namespace WelsDec {
  */
 uint8_t* DetectStartCodePrefix (const uint8_t* kpBuf, int32_t* pOffset, int32_t iBufSize);
 
+/*!
+ *************************************************************************************
+ * \brief	find the first 00 00 0x (x <= 3) pattern, i.e. a start code prefix or an
+ *			emulation prevention byte candidate
+ *
+ * \param 	kpBuf		bitstream payload buffer
+ * \param	kiBufSize	count size of buffer
+ *
+ * \return	offset of the first zero byte of the pattern, kiBufSize if there is none
+ *
+ * \note	N/A
+ *************************************************************************************
+ */
+int32_t FindStartCodeCandidate (const uint8_t* kpBuf, const int32_t kiBufSize);
+
 /*!
  *************************************************************************************
  * \brief	to parse network abstraction layer unit,
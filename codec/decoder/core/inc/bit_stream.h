@@ -46,11 +46,9 @@ uint8_t*		pStartBuf;	// buffer to start position
 uint8_t*		pEndBuf;	// buffer + length
 int32_t     iBits;       // count bits of overall bitstreaming input
 
-int32_t     iIndex;      //only for cavlc usage
-uint8_t*		pCurBuf;	// current reading position
-uint32_t    uiCurBits;
-int32_t		iLeftBits;	// count number of available bits left ([1, 8]),
-// need pointer to next byte start position in case 0 bit left then 8 instead
+uint8_t*		pCurBuf;	// next byte to be loaded into uiCurBits
+uint64_t    uiCurBits;	// cached bits, MSB first
+int32_t		iLeftBits;	// count number of valid bits in uiCurBits ([0, 64])
 } SBitStringAux, *PBitStringAux;
 
 /*!
@@ -64,6 +62,9 @@ int32_t		iLeftBits;	// count number of available bits left ([1, 8]),
  */
 int32_t InitBits (PBitStringAux pBitString, const uint8_t* kpBuf, const int32_t kiSize);
 
+/*!
+ * \brief	(re)start reading at pCurBuf, e.g. after the samples of an I_PCM macroblock
+ */
 void InitReadBits (PBitStringAux pBitString);
 
 
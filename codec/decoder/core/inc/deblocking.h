@@ -60,11 +60,37 @@ void  DeblockingInit (PDeblockingFunc pDeblockingFunc,  int32_t iCpu);
 /*!
  * \brief	deblocking filtering target slice
  *
- * \param	dec			Wels decoder context
+ * \param	pCtx		Wels decoder context
+ * \param	pCurDqLayer	dq layer holding the slice to be filtered
  *
  * \return	NONE
  */
-void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDeblockingFilterMbFunc pDeblockMb);
+void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDqLayer pCurDqLayer, PDeblockingFilterMbFunc pDeblockMb);
+
+/*!
+ * \brief	deblocking filtering the MBs of target slice within one MB row, for slices in raster scan order
+ *
+ * \param	pCtx		Wels decoder context
+ * \param	pCurDqLayer	dq layer holding the slice to be filtered
+ * \param	kiMbY		MB row to be filtered, the rows above it in the slice filtered already
+ *
+ * \return	NONE
+ */
+void WelsDeblockingFilterSliceRow (PWelsDecoderContext pCtx, PDqLayer pCurDqLayer, PDeblockingFilterMbFunc pDeblockMb,
+                                   const int32_t kiMbY);
+
+/*!
+ * \brief	deblocking filtering the MBs [kiStartMb, kiEndMb) of target slice, all within one MB row
+ *
+ * \param	pCtx		Wels decoder context
+ * \param	pCurDqLayer	dq layer holding the slice to be filtered
+ * \param	kiStartMb	first MB to be filtered, the MBs left of and above it filtered already
+ * \param	kiEndMb		MB following the last one to be filtered
+ *
+ * \return	NONE
+ */
+void WelsDeblockingFilterSliceMbs (PWelsDecoderContext pCtx, PDqLayer pCurDqLayer, PDeblockingFilterMbFunc pDeblockMb,
+                                   const int32_t kiStartMb, const int32_t kiEndMb);
 
 /*!
  * \brief	pixel deblocking filtering
@@ -78,6 +104,9 @@ void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDeblockingFilterMbFun
  */
 
 uint32_t DeblockingBsMarginalMBAvcbase (PDqLayer pCurDqLayer, int32_t iEdge, int32_t iNeighMb, int32_t iMbXy);
+#if defined(X86_INTRINSICS)
+uint32_t DeblockingBsMarginalMBAvcbase_avx2 (PDqLayer pCurDqLayer, int32_t iEdge, int32_t iNeighMb, int32_t iMbXy);
+#endif//X86_INTRINSICS
 
 int32_t DeblockingAvailableNoInterlayer (PDqLayer pCurDqLayer, int32_t iFilterIdc);
 
@@ -89,6 +89,7 @@ struct TagDqLayer {
   int32_t iMbXyIndex;
   int32_t	iMbWidth;		// MB width of this picture, equal to sSps.iMbWidth
   int32_t	iMbHeight;		// MB height of this picture, equal to sSps.iMbHeight;
+  int32_t	iSliceMbLimit;	// slice jobs: first MB of the slice queued after this one, 0 for no limit
 
   /* Common syntax elements across all slices of a DQLayer */
   int32_t					iSliceIdcBackup;
@@ -105,6 +106,8 @@ struct TagDqLayer {
 
   PPicture				pRef;			// reference picture pointer
   PPicture				pDec;			// reconstruction picture pointer for layer
+  PPicture*				pRefPicList;	// reference list [LIST_0] used for motion compensation of this layer
+  int32_t*				pRefReadyLines;	// luma lines known ready per reference index, NULL without frame threading
 
   bool					bStoreRefBasePicFlag;				// iCurTid == 0 && iCurQid = 0 && bEncodeKeyPic = 1
   bool					bTCoeffLevelPredFlag;
@@ -116,6 +119,16 @@ struct TagDqLayer {
   bool					bUseRefBasePicFlag;	// whether reference pic or reference base pic is referred?
 };
 
+/*
+ * whether MB kiXy, decoded before the current MB, belongs to the slice being decoded; a slice without FMO covers
+ * the MBs from its first one on, so pSliceIdc, which slices decoded concurrently write, is only read with FMO
+ */
+static inline bool IsMbInCurSlice (PDqLayer pCurLayer, const int32_t kiXy) {
+  if (pCurLayer->sLayerInfo.pPps->uiNumSliceGroups > 1)
+    return pCurLayer->pSliceIdc[kiXy] == pCurLayer->pSliceIdc[pCurLayer->iMbXyIndex];
+  return kiXy >= pCurLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.iFirstMbInSlice;
+}
+
 typedef struct TagGpuAvcLayer {
   SLayerInfo				sLayerInfo;
   PBitStringAux			pBitStringAux;	// pointer to SBitStringAux
@@ -54,32 +54,64 @@ namespace WelsDec {
   if( uiRetTmp != ERR_NONE ) \
     return uiRetTmp; \
 }while(0)
-#define GET_WORD(iCurBits, pBufPtr, iLeftBits, iAllowedBytes, iReadBytes) { \
-  if (iReadBytes > iAllowedBytes+1) { \
-    return ERR_INFO_READ_OVERFLOW; \
-  } \
-	iCurBits |= ((uint32_t)((pBufPtr[0] << 8) | pBufPtr[1])) << (iLeftBits); \
-	iLeftBits -= 16; \
-	pBufPtr +=2; \
+
+/*
+ *	64 bits cache reader: uiCurBits holds the next bits of the stream MSB first, iLeftBits of them valid,
+ *	pCurBuf points to the first byte not loaded yet; a refill tops the cache up to at least 57 bits
+ */
+static inline uint64_t BsLoadBE64 (const uint8_t* kpBuf) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+  return __builtin_bswap64 (LD64 (kpBuf));
+#else
+  return ((uint64_t)kpBuf[0] << 56) | ((uint64_t)kpBuf[1] << 48) | ((uint64_t)kpBuf[2] << 40) |
+         ((uint64_t)kpBuf[3] << 32) | ((uint64_t)kpBuf[4] << 24) | ((uint64_t)kpBuf[5] << 16) |
+         ((uint64_t)kpBuf[6] << 8) | (uint64_t)kpBuf[7];
+#endif
 }
-#define NEED_BITS(iCurBits, pBufPtr, iLeftBits, iAllowedBytes, iReadBytes) { \
-	if( iLeftBits > 0 ) { \
-	GET_WORD(iCurBits, pBufPtr, iLeftBits, iAllowedBytes, iReadBytes); \
-	} \
+
+/* bits consumed so far */
+static inline int32_t BsGetUsedBits (PBitStringAux pBs) {
+  return (int32_t) ((pBs->pCurBuf - pBs->pStartBuf) << 3) - pBs->iLeftBits;
 }
-#define UBITS(iCurBits, iNumBits) (iCurBits>>(32-(iNumBits)))
-#define DUMP_BITS(iCurBits, pBufPtr, iLeftBits, iNumBits, iAllowedBytes, iReadBytes) { \
-	iCurBits <<= (iNumBits); \
-	iLeftBits += (iNumBits); \
-	NEED_BITS(iCurBits, pBufPtr, iLeftBits, iAllowedBytes, iReadBytes); \
+
+/* only the refills touching the last 8 bytes check the end of buffer, bytes past pEndBuf read as 0 */
+static inline int32_t BsRefillBits (PBitStringAux pBs) {
+  uint64_t uiValue;
+  int32_t iBytes;
+  if (pBs->pCurBuf + 8 <= pBs->pEndBuf) {
+    uiValue = BsLoadBE64 (pBs->pCurBuf);
+  } else {
+    const int32_t kiLeftBytes = (int32_t) (pBs->pEndBuf - pBs->pCurBuf);
+    if (BsGetUsedBits (pBs) > ((pBs->pEndBuf - pBs->pStartBuf) << 3)) {
+      return ERR_INFO_READ_OVERFLOW;
+    }
+    uiValue = 0;
+    for (iBytes = 0; iBytes < 8; iBytes++) {
+      uiValue = (uiValue << 8) | (iBytes < kiLeftBytes ? pBs->pCurBuf[iBytes] : 0);
+    }
+  }
+  pBs->uiCurBits |= uiValue >> pBs->iLeftBits;
+  iBytes = (64 - pBs->iLeftBits) >> 3;
+  pBs->pCurBuf += iBytes;
+  pBs->iLeftBits += iBytes << 3;
+  return ERR_NONE;
+}
+
+#define NEED_BITS(pBs, iNumBits) { \
+  if ((pBs)->iLeftBits < (iNumBits)) { \
+    WELS_READ_VERIFY (BsRefillBits (pBs)); \
+  } \
+}
+#define UBITS(pBs, iNumBits) ((uint32_t)((pBs)->uiCurBits >> (64 - (iNumBits)))) //1 to 32 bits
+#define DUMP_BITS(pBs, iNumBits) { \
+  (pBs)->uiCurBits <<= (iNumBits); \
+  (pBs)->iLeftBits -= (iNumBits); \
 }
 
 static inline int32_t BsGetBits (PBitStringAux pBs, int32_t iNumBits, uint32_t* pCode) {
-  int32_t iRc = UBITS (pBs->uiCurBits, iNumBits);
-  int32_t iAllowedBytes = pBs->pEndBuf - pBs->pStartBuf; //actual stream bytes
-  int32_t iReadBytes = pBs->pCurBuf - pBs->pStartBuf;
-  DUMP_BITS (pBs->uiCurBits, pBs->pCurBuf, pBs->iLeftBits, iNumBits, iAllowedBytes, iReadBytes);
-  *pCode = iRc;
+  NEED_BITS (pBs, iNumBits);
+  *pCode = UBITS (pBs, iNumBits);
+  DUMP_BITS (pBs, iNumBits);
   return ERR_NONE;
 }
 
@@ -127,19 +159,22 @@ static inline uint32_t BsGetOneBit (PBitStringAux pBs, uint32_t* pCode) {
 }
 
 static inline int32_t GetLeadingZeroBits (uint32_t iCurBits) { //<=32 bits
+#if defined(__GNUC__)
+  return iCurBits ? __builtin_clz (iCurBits) : -1;
+#else
   uint32_t  uiValue;
 
-  uiValue = UBITS (iCurBits, 8); //ShowBits( bs, 8 );
+  uiValue = iCurBits >> 24; //ShowBits( bs, 8 );
   if (uiValue) {
     return g_kuiLeadingZeroTable[uiValue];
   }
 
-  uiValue = UBITS (iCurBits, 16); //ShowBits( bs, 16 );
+  uiValue = iCurBits >> 16; //ShowBits( bs, 16 );
   if (uiValue) {
     return (g_kuiLeadingZeroTable[uiValue] + 8);
   }
 
-  uiValue = UBITS (iCurBits, 24); //ShowBits( bs, 24 );
+  uiValue = iCurBits >> 8; //ShowBits( bs, 24 );
   if (uiValue) {
     return (g_kuiLeadingZeroTable[uiValue] + 16);
   }
@@ -150,34 +185,26 @@ static inline int32_t GetLeadingZeroBits (uint32_t iCurBits) { //<=32 bits
   }
 //ASSERT(false);  // should not go here
   return -1;
+#endif
 }
 
 static inline uint32_t BsGetUe (PBitStringAux pBs, uint32_t* pCode) {
-  uint32_t iValue = 0;
-  int32_t  iLeadingZeroBits = GetLeadingZeroBits (pBs->uiCurBits);
-  int32_t iAllowedBytes, iReadBytes;
-  iAllowedBytes = pBs->pEndBuf - pBs->pStartBuf; //actual stream bytes
+  int32_t iLeadingZeroBits;
 
+  NEED_BITS (pBs, 33);
+  iLeadingZeroBits = GetLeadingZeroBits ((uint32_t) (pBs->uiCurBits >> 32));
   if (iLeadingZeroBits == -1) { //bistream error
     return ERR_INFO_READ_LEADING_ZERO;//-1
-  } else if (iLeadingZeroBits >
-             16) { //rarely into this condition (even may be bitstream error), prevent from 16-bit reading overflow
-    //using two-step reading instead of one time reading of >16 bits.
-    iReadBytes = pBs->pCurBuf - pBs->pStartBuf;
-    DUMP_BITS (pBs->uiCurBits, pBs->pCurBuf, pBs->iLeftBits, 16, iAllowedBytes, iReadBytes);
-    iReadBytes = pBs->pCurBuf - pBs->pStartBuf;
-    DUMP_BITS (pBs->uiCurBits, pBs->pCurBuf, pBs->iLeftBits, iLeadingZeroBits + 1 - 16, iAllowedBytes, iReadBytes);
+  } else if (iLeadingZeroBits > 16) { //rarely into this condition (even may be bitstream error), code over 33 bits
+    uint32_t uiValue;
+    DUMP_BITS (pBs, iLeadingZeroBits + 1);
+    WELS_READ_VERIFY (BsGetBits (pBs, iLeadingZeroBits, &uiValue));
+    *pCode = ((1 << iLeadingZeroBits) - 1 + uiValue);
   } else {
-    iReadBytes = pBs->pCurBuf - pBs->pStartBuf;
-    DUMP_BITS (pBs->uiCurBits, pBs->pCurBuf, pBs->iLeftBits, iLeadingZeroBits + 1, iAllowedBytes, iReadBytes);
-  }
-  if (iLeadingZeroBits) {
-    iValue = UBITS (pBs->uiCurBits, iLeadingZeroBits);
-    iReadBytes = pBs->pCurBuf - pBs->pStartBuf;
-    DUMP_BITS (pBs->uiCurBits, pBs->pCurBuf, pBs->iLeftBits, iLeadingZeroBits, iAllowedBytes, iReadBytes);
+    //the whole code word is cached, its value is 1 << iLeadingZeroBits plus the info bits
+    *pCode = UBITS (pBs, (iLeadingZeroBits << 1) + 1) - 1;
+    DUMP_BITS (pBs, (iLeadingZeroBits << 1) + 1);
   }
-
-  *pCode = ((1 << iLeadingZeroBits) - 1 + iValue);
   return ERR_NONE;
 }
 
@@ -0,0 +1,320 @@
+/*!
+ * \copy
+ *     Copyright (c)  2014, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file	dec_multi_threading.h
+ *
+ * \brief	frame level parallel decoding: the calling thread parses access units and hands the
+ *			target layer reconstruction (MC, residual, deblocking and expansion) to worker threads;
+ *			wavefront reconstruction of the MB rows of one slice over helper threads; slice level parallel
+ *			decoding of the slices of one picture, deblocked across slice edges as a row wavefront afterwards
+ *
+ * \date	10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+#ifndef WELS_DEC_MULTI_THREADING_H__
+#define WELS_DEC_MULTI_THREADING_H__
+
+#include "typedefs.h"
+#include "codec_def.h"
+#include "WelsThreadLib.h"
+#include "decoder_context.h"
+
+namespace WelsDec {
+
+/* snapshot of one parsed slice of the target layer waiting for reconstruction */
+typedef struct TagDecSliceTask {
+  SDqLayer		sLayer;		// dq layer copy, MB arrays point to the frame task buffers
+  SSps			sSps;		// parameter sets copies, safe against overwriting by later NALs
+  SPps			sPps;
+  PPicture		pRefList[MAX_REF_PIC_COUNT];
+  int32_t			iRefReadyLines[MAX_REF_PIC_COUNT];	// luma lines known ready per reference index
+} SDecSliceTask, *PDecSliceTask;
+
+enum EDecFrameTaskState {
+  FRAME_TASK_IDLE = 0,	// slot free
+  FRAME_TASK_PARSING,		// slices of the frame are still being parsed
+  FRAME_TASK_QUEUED,		// handed to the worker threads
+  FRAME_TASK_DONE,		// reconstruction finished, output pending
+  FRAME_TASK_DELIVERED	// output handed to application, released at next call
+};
+
+/* one picture in flight, from parsing up to delivery to the application */
+typedef struct TagDecFrameTask {
+  EDecFrameTaskState	eState;
+  PPicture		pDec;			// picture being reconstructed, holding a uiRefCount
+  PPicture		pRefPic[MAX_REF_PIC_COUNT];	// unique references of all slices, each holding a uiRefCount
+  int32_t			iRefPicNum;
+  bool			bRef;			// expand the picture when done as it is used for reference
+  bool			bSync;			// must be reconstructed in the parsing thread (FMO)
+
+  PDecSliceTask	pSliceTask;
+  int32_t			iSliceTaskNum;
+  int32_t			iSliceTaskCapacity;
+
+  /* MB level syntax buffers, parsing of next frames must not overwrite them before reconstruction */
+  void*			pMbBuffer;
+  int32_t			iMbBufferMbNum;
+  SDqLayer		sMbArrays;		// only the MB array pointers are valid
+
+  uint8_t*		pDst[3];		// output planes filled by DecodeFrameConstruction
+  SBufferInfo		sDstInfo;
+  uint32_t		uiSeq;			// decoding order of the frame
+} SDecFrameTask, *PDecFrameTask;
+
+typedef struct TagDecThreadCtx {
+  WELS_THREAD_HANDLE	hThreads[MAX_DEC_THREADS_NUM];
+  int32_t			iThreadNum;
+
+  WELS_MUTEX		hLock;			// guards the queue, task states and SPicture::iReadyLines
+  WELS_COND		hTaskCond;		// signaled on new queued task or exit request
+  WELS_COND		hProgressCond;	// broadcast on reconstruction progress or task completion
+
+  SDecFrameTask	sTasks[MAX_DEC_THREADS_NUM + 2];	// ring of frame tasks in decoding order
+  int32_t			iTaskNum;
+  uint32_t		uiTaskFirst;	// oldest slot in use
+  uint32_t		uiTaskNext;		// next slot to be acquired
+  PDecFrameTask	pCurTask;		// task being parsed, NULL when none
+
+  PDecFrameTask	pQueue[MAX_DEC_THREADS_NUM + 2];	// FIFO of tasks waiting for a worker
+  uint32_t		uiQueueHead;
+  uint32_t		uiQueueTail;
+  bool			bExit;
+
+  PPicBuff		pRetiredPicBuff[MAX_DEC_THREADS_NUM + 2];	// picture buffers of previous resolutions
+  uint32_t		uiRetiredUntil[MAX_DEC_THREADS_NUM + 2];	// freed once every task before this seq is released
+  int32_t			iRetiredNum;
+
+  PWelsDecoderContext	pCtx;
+} SDecThreadCtx, *PDecThreadCtx;
+
+/* private state of one thread taking part in the wavefront reconstruction of a slice */
+typedef struct TagDecRowWorker {
+  SDqLayer		sLayer;		// layer copy, the current MB position is per thread
+  int32_t			iRefReadyLines[MAX_REF_PIC_COUNT];
+} SDecRowWorker, *PDecRowWorker;
+
+/* helpers reconstructing the MB rows of one slice at a time, each row staying 2 MBs behind the row above */
+typedef struct TagDecRowThreadCtx {
+  WELS_THREAD_HANDLE	hThreads[MAX_DEC_THREADS_NUM];
+  int32_t			iThreadNum;
+
+  WELS_MUTEX		hLock;			// guards everything below
+  WELS_COND		hJobCond;		// signaled on new slice or exit request
+  WELS_COND		hRowCond;		// broadcast on MB progress or when a helper leaves the slice
+  bool			bExit;
+
+  bool			bBusy;			// a slice is being reconstructed, later callers fall back to raster order
+  uint32_t		uiJobSeq;		// incremented per slice so every helper joins it once at most
+  PDqLayer		pLayer;			// slice being reconstructed
+  int32_t			iFirstMbX;
+  int32_t			iFirstRow;
+  int32_t			iLastMbX;
+  int32_t			iLastRow;
+  int32_t			iNextRow;		// next row to be taken by a thread
+  int32_t			iJoined;		// helpers joined the slice so far, picking their worker state
+  int32_t			iActive;		// helpers working on the slice
+  int32_t			iWaiting;		// threads blocked on the progress of the row above
+  bool			bError;
+
+  bool			bPipeline;		// deblock rows along, see SWelsDecoderContext::bPipelineDeblocking
+  bool			bDeblocking;	// a thread is filtering rows
+  int32_t			iDeblockRow;	// next row to be filtered
+
+  int32_t*		pRowProgress;	// MBs done per row, counting from column 0
+  int32_t			iRowProgressSize;
+
+  SDecRowWorker	sWorker[MAX_DEC_THREADS_NUM + 1];	// [0] for the thread owning the slice
+
+  PWelsDecoderContext	pCtx;
+} SDecRowThreadCtx, *PDecRowThreadCtx;
+
+/* one slice of the picture, parsed and reconstructed by a slice thread */
+typedef struct TagDecSliceJob {
+  SDqLayer		sLayer;			// layer copy, bitstream reader and MB position are per slice
+  PNalUnit		pNal;
+  int32_t			iTotalNumMbRec;	// MBs reconstructed
+  int32_t			iRet;
+} SDecSliceJob, *PDecSliceJob;
+
+/* threads decoding whole slices of the picture being decoded, then filtering it across slice edges row by row,
+ * each row staying 2 MBs behind the row above */
+typedef struct TagDecSliceThreadCtx {
+  WELS_THREAD_HANDLE	hThreads[MAX_DEC_THREADS_NUM];
+  int32_t			iThreadNum;
+
+  WELS_MUTEX		hLock;			// guards everything below
+  WELS_COND		hJobCond;		// signaled on new slice, picture deblocking or exit request
+  WELS_COND		hDoneCond;		// broadcast on slice completion, deblocking progress or when a helper leaves
+  bool			bExit;
+
+  PDecSliceJob	pJobs;			// slices of the current picture in decoding order
+  int32_t			iJobNum;
+  int32_t			iJobCapacity;
+  int32_t			iNextJob;		// next slice to be taken by a thread
+  bool			bLastJob;		// no slice follows the last one queued, so it may be taken
+  int32_t			iDoneJobs;
+  int32_t			iActive;		// helpers decoding a slice or filtering rows
+
+  PDecSliceJob*	ppSortedJobs;	// successfully decoded slices by first MB, for picture deblocking
+  int32_t			iSortedJobNum;
+  bool			bDeblocking;	// rows of the picture being filtered
+  uint32_t		uiDeblockSeq;	// incremented per picture so every helper joins its deblocking once at most
+  int32_t			iNextRow;		// next row to be filtered
+  int32_t			iMbWidth;
+  int32_t			iMbHeight;
+  int32_t			iWaiting;		// threads blocked on the progress of the row above
+  int32_t*		pRowProgress;	// MBs filtered per row, counting from column 0
+  int32_t			iRowProgressSize;
+
+  PWelsDecoderContext	pCtx;
+} SDecSliceThreadCtx, *PDecSliceThreadCtx;
+
+/*!
+ * \brief	start worker threads, iThreadCount <= 1 keeps reconstruction in the calling thread
+ * \return	0 - successful; none 0 - failed
+ */
+int32_t InitDecThreads (PWelsDecoderContext pCtx, const int32_t kiThreadCount);
+
+/*!
+ * \brief	wait for pending tasks, stop worker threads and free related memory
+ */
+void UninitDecThreads (PWelsDecoderContext pCtx);
+
+/*!
+ * \brief	acquire a frame task for the access unit to be decoded, binding its MB buffers to pCurDqLayer
+ *			and redirecting the output of DecodeFrameConstruction to the task
+ * \return	0 - successful; none 0 - failed
+ */
+int32_t PrepareFrameTask (PWelsDecoderContext pCtx, uint8_t*** pppDst, SBufferInfo** ppDstInfo);
+
+/*!
+ * \brief	snapshot the parsed slice in pCurLayer for later reconstruction
+ * \return	0 - successful; none 0 - failed
+ */
+int32_t AddSliceTask (PWelsDecoderContext pCtx, PDqLayer pCurLayer);
+
+/*!
+ * \brief	hand the target layer of the current access unit over to the worker threads
+ * \return	true - queued; false - reconstructed synchronously, pCtx->pDec is complete on return
+ */
+bool SubmitFrameTask (PWelsDecoderContext pCtx, const bool kbRef);
+
+/*!
+ * \brief	finish the current task in the calling thread after all queued ones, used when decoding of
+ *			the access unit was interrupted; the frame keeps its output if DecodeFrameConstruction made one
+ */
+void CompleteFrameTask (PWelsDecoderContext pCtx);
+
+/*!
+ * \brief	wait until every queued task is reconstructed
+ */
+void DrainFrameTasks (PWelsDecoderContext pCtx);
+
+/*!
+ * \brief	output the oldest reconstructed frame in decoding order if any, blocking at the end of stream
+ *			or when no task slot is left for the next access unit
+ */
+void FetchFrameTaskOutput (PWelsDecoderContext pCtx, uint8_t** ppDst, SBufferInfo* pDstInfo);
+
+/*!
+ * \brief	block until the first kiLines luma lines of pRefPic are finally reconstructed
+ * \return	luma lines ready in pRefPic
+ */
+int32_t WaitRefPicLines (PWelsDecoderContext pCtx, PPicture pRefPic, const int32_t kiLines);
+
+/*!
+ * \brief	publish that the first kiLines luma lines of a picture under reconstruction are final
+ */
+void PublishPicLines (PWelsDecoderContext pCtx, PPicture pPic, const int32_t kiLines);
+
+/*!
+ * \brief	keep a picture buffer replaced by WelsRequestMem alive until tasks using it are released
+ * \return	true - retired; false - nothing in flight, caller destroys it right away
+ */
+bool RetirePicBuff (PWelsDecoderContext pCtx, PPicBuff pPicBuff);
+
+/*!
+ * \brief	start wavefront helper threads, iRowThreadCount <= 1 keeps reconstruction of a slice in raster order
+ * \return	0 - successful; none 0 - failed
+ */
+int32_t InitDecRowThreads (PWelsDecoderContext pCtx, const int32_t kiRowThreadCount);
+
+/*!
+ * \brief	stop wavefront helper threads and free related memory
+ */
+void UninitDecRowThreads (PWelsDecoderContext pCtx);
+
+/*!
+ * \brief	reconstruct the MBs of the parsed slice in pCurLayer as a wavefront over the helper threads, deblocking
+ *			the rows along if kbPipeline
+ * \return	true - done, *pRet tells the result; false - helpers busy or slice unsuitable, reconstruct in raster order
+ */
+bool ReconstructSliceWavefront (PWelsDecoderContext pCtx, PDqLayer pCurLayer, const bool kbPipeline, int32_t* pRet);
+
+/*!
+ * \brief	start slice threads, iSliceThreadCount <= 1 decodes the slices of a picture one after the other
+ * \return	0 - successful; none 0 - failed
+ */
+int32_t InitDecSliceThreads (PWelsDecoderContext pCtx, const int32_t kiSliceThreadCount);
+
+/*!
+ * \brief	wait for pending slices, stop slice threads and free related memory
+ */
+void UninitDecSliceThreads (PWelsDecoderContext pCtx);
+
+/*!
+ * \brief	hand the slice of pNalCur, its header applied to pCurLayer, to the slice threads for parsing and
+ *			reconstruction; slices filtered across their edges (idc 0) are deblocked by FinishSliceJobs
+ * \return	0 - successful; none 0 - failed
+ */
+int32_t AddSliceJob (PWelsDecoderContext pCtx, PDqLayer pCurLayer, PNalUnit pNalCur);
+
+/*!
+ * \brief	number of slices handed to the slice threads for the current picture
+ */
+int32_t GetSliceJobNum (PWelsDecoderContext pCtx);
+
+/*!
+ * \brief	first MB a slice handed to the slice threads next may start at; slices decoded concurrently never share
+ *			MBs, each stopping with an error where the slice queued after it starts
+ */
+int32_t GetSliceJobMinFirstMb (PWelsDecoderContext pCtx);
+
+/*!
+ * \brief	decode the slices left with the slice threads, then deblock the picture across slice edges; with
+ *			kbDrop, wait for the slices only as decoding of the access unit was interrupted
+ * \return	0 - successful; none 0 - a slice failed, *ppErrNal being the first one in decoding order
+ */
+int32_t FinishSliceJobs (PWelsDecoderContext pCtx, const bool kbDrop, PNalUnit* ppErrNal);
+
+} // namespace WelsDec
+
+#endif//WELS_DEC_MULTI_THREADING_H__
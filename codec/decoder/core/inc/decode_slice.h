@@ -37,19 +37,23 @@
 
 namespace WelsDec {
 
-int32_t WelsActualDecodeMbCavlcISlice (PWelsDecoderContext pCtx);
-int32_t WelsDecodeMbCavlcISlice (PWelsDecoderContext pCtx, PNalUnit pNalCur);
+int32_t WelsActualDecodeMbCavlcISlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer);
+int32_t WelsDecodeMbCavlcISlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer, PNalUnit pNalCur);
 
-int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx);
-int32_t WelsDecodeMbCavlcPSlice (PWelsDecoderContext pCtx, PNalUnit pNalCur);
-typedef int32_t (*PWelsDecMbCavlcFunc) (PWelsDecoderContext pCtx, PNalUnit pNalCur);
+int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer);
+int32_t WelsDecodeMbCavlcPSlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer, PNalUnit pNalCur);
+typedef int32_t (*PWelsDecMbCavlcFunc) (PWelsDecoderContext pCtx, PDqLayer pCurLayer, PNalUnit pNalCur);
 
-int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx); //construction based on slice
+int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx, PDqLayer pCurLayer, int32_t* pTotalNumMbRec,
+                                     const bool kbConcurrent); //construction based on slice, kbConcurrent on slice threads
 
-int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, bool bFirstSliceInLayer, PNalUnit pNalCur);
+void WelsFinishSliceRow (PWelsDecoderContext pCtx, PDqLayer pCurLayer,
+                         const int32_t kiMbY); //pipelined deblocking and expansion of one MB row
 
+int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer, bool bFirstSliceInLayer, PNalUnit pNalCur);
 
-int32_t WelsTargetMbConstruction (PWelsDecoderContext pCtx);
+
+int32_t WelsTargetMbConstruction (PWelsDecoderContext pCtx, PDqLayer pCurLayer);
 
 int32_t WelsMbIntraPredictionConstruction (PWelsDecoderContext pCtx, PDqLayer pCurLayer, bool bOutput);
 int32_t WelsMbInterSampleConstruction (PWelsDecoderContext pCtx, PDqLayer pCurLayer,
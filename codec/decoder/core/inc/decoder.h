@@ -114,6 +114,16 @@ int32_t WelsRequestMem (PWelsDecoderContext pCtx, const int32_t kiMbWidth, const
  */
 void WelsFreeMem (PWelsDecoderContext pCtx);
 
+/*
+ *	free a picture buffer and the pictures in it
+ */
+void DestroyPicBuff (PPicBuff* ppPicBuf, CMemoryAlign* pMa);
+
+/*
+ *	get a buffer of the application for the next frame of pPic, see DECODER_OPTION_BUFFER_PROVIDER
+ */
+int32_t RenewPictureBuffer (PWelsDecoderContext pCtx, PPicture pPic);
+
 /*
  * set colorspace format in decoder
  */
@@ -53,6 +53,7 @@
 #include "as264_common.h" // for LONG_TERM_REF macro,can be delete if not need this macro
 #include "crt_util_safe_x.h"
 #include "mb_cache.h"
+#include "memory_align.h"
 
 namespace WelsDec {
 
@@ -104,6 +105,18 @@ typedef struct TagCopyFunc {
   PCopyFunc pCopyChromaFunc;
 } SCopyFunc;
 
+typedef void (*PInterleaveUVFunc) (uint8_t* pDstUV, const uint8_t* pSrcU, const uint8_t* pSrcV, const int32_t kiWidth);
+typedef void (*PYuvToRgbRowFunc) (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU, const uint8_t* pSrcV,
+                                  const int32_t kiWidth);
+typedef void (*PScaleRowFunc) (uint8_t* pDst, const int32_t kiDstWidth, const uint8_t* pSrc0, const uint8_t* pSrc1,
+                               const int32_t kiSrcWidth, const int32_t kiStepX, const int32_t kiFracY);
+typedef struct TagOutputFormatFunc {
+  PInterleaveUVFunc	pfInterleaveUV;		// NV12 chroma row out of the U and V rows
+  PYuvToRgbRowFunc	pfYuvToRgbaRow;		// 32 bit pixels of one luma row, chroma upsampled horizontally by 2
+  PYuvToRgbRowFunc	pfYuvToBgraRow;
+  PScaleRowFunc		pfScaleRow;			// bilinear downscaling of one row, positions in 1/65536
+} SOutputFormatFunc;
+
 //deblock module defination
 struct TagDeblockingFunc;
 
@@ -126,6 +139,8 @@ typedef void (*PChromaDeblockingLT4Func) (uint8_t* iSampleCb, uint8_t* iSampleCr
     int32_t iBeta, int8_t* iTc);
 typedef void (*PChromaDeblockingEQ4Func) (uint8_t* iSampleCb, uint8_t* iSampleCr, int32_t iStride, int32_t iAlpha,
     int32_t iBeta);
+typedef void (*PDeblockingBSInsideMBFunc) (PDqLayer pCurDqLayer, uint8_t nBS[2][4][4], int8_t* pNnzTab, int32_t iMbXy);
+typedef uint32_t (*PDeblockingBSMarginalMBFunc) (PDqLayer pCurDqLayer, int32_t iEdge, int32_t iNeighMb, int32_t iMbXy);
 
 typedef struct TagDeblockingFunc {
   PLumaDeblockingLT4Func    pfLumaDeblockingLT4Ver;
@@ -137,6 +152,9 @@ typedef struct TagDeblockingFunc {
   PChromaDeblockingEQ4Func  pfChromaDeblockingEQ4Ver;
   PChromaDeblockingLT4Func  pfChromaDeblockingLT4Hor;
   PChromaDeblockingEQ4Func  pfChromaDeblockingEQ4Hor;
+
+  PDeblockingBSInsideMBFunc   pfDeblockingBSInsideMBNormal;
+  PDeblockingBSMarginalMBFunc pfDeblockingBSMarginalMB;
 } SDeblockingFunc, *PDeblockingFunc;
 
 typedef void (*PWelsNonZeroCountFunc) (int16_t* pBlock, int8_t* pNonZeroCount);
@@ -173,13 +191,18 @@ typedef struct TagWelsDecoderContext {
 
   SDataBuffer       	sRawData;
 
+  CMemoryAlign*		pMemAlign;			// allocator of the decoder instance, set up before WelsInitDecoder()
+
   // Configuration
   SDecodingParam*    	pParam;
   uint32_t			uiCpuFlag;			// CPU compatibility detected
 
   int32_t				iOutputColorFormat;		// color space format to be outputed
+  int32_t				iOutputWidth;			// output size of the cropped frames, 0 for no scaling
+  int32_t				iOutputHeight;
   VIDEO_BITSTREAM_TYPE eVideoType; //indicate the type of video to decide whether or not to do qp_delta error detection.
   bool				bErrorResilienceFlag;		// error resilience flag
+  bool				bPipelineDeblocking;		// deblocking and expansion run one MB row behind reconstruction
   bool				bHaveGotMemory;	// global memory for decoder context related ever requested?
 
   int32_t				iImgWidthInPixel;	// width of image in pixel reconstruction picture to be output
@@ -244,6 +267,7 @@ typedef struct TagWelsDecoderContext {
 
   PPicBuff	        pPicBuff[LIST_A];	// Initially allocated memory for pictures which are used in decoding.
   int32_t				iPicQueueNumber;
+  int32_t				iPicBufferSize;		// bytes of the largest picture buffer so far, new ones get as big for later resolutions to fit in
 
   SSubsetSps			sSubsetSpsBuffer[MAX_SPS_COUNT + 1];
   SNalUnit            sPrefixNal;
@@ -262,6 +286,8 @@ typedef struct TagWelsDecoderContext {
   uint8_t				uiTargetDqId;		// maximal DQ ID in current access unit, meaning target layer ID
   bool				bAvcBasedFlag;		// For decoding bitstream:
   bool				bEndOfStreamFlag;	// Flag on end of stream requested by external application layer
+  bool				bZeroCopyInput;		// NALs without emulation prevention bytes are parsed in the input buffer
+  SPictureBufferProvider	sBufferProvider;	// frames are reconstructed into buffers of the application if pGetBuffer is set
   bool				bInitialDqLayersMem;	// dq layers related memory is available?
 
   bool              bOnlyOneLayerInCurAuFlag; //only one layer in current AU: 1
@@ -300,6 +326,7 @@ typedef struct TagWelsDecoderContext {
   /* For Deblocking */
   SDeblockingFunc     sDeblockingFunc;
   SExpandPicFunc	    sExpandPicFunc;
+  SOutputFormatFunc	sOutputFormatFunc;
 
   /* For Block */
   SBlockFunc          sBlockFunc;
@@ -308,10 +335,6 @@ typedef struct TagWelsDecoderContext {
   int32_t iCurSeqIntervalMaxPicWidth;
   int32_t iCurSeqIntervalMaxPicHeight;
 
-  PWelsFillNeighborMbInfoIntra4x4Func  pFillInfoCacheIntra4x4Func;
-  PWelsParseIntra4x4ModeFunc           pParseIntra4x4ModeFunc;
-  PWelsParseIntra16x16ModeFunc         pParseIntra16x16ModeFunc;
-
   //feedback whether or not have VCL in current AU, and the temporal ID
   int32_t iFeedbackVclNalInAu;
   int32_t iFeedbackTidInAu;
@@ -321,6 +344,13 @@ typedef struct TagWelsDecoderContext {
   //trace handle
   void*      pTraceHandle;
 
+  // frame level parallel decoding, NULL when pictures are reconstructed in the calling thread
+  struct TagDecThreadCtx* pThreadCtx;
+  // wavefront reconstruction of MB rows within a slice, NULL when slices are reconstructed in raster order
+  struct TagDecRowThreadCtx* pRowThreadCtx;
+  // slices of a picture parsed and reconstructed concurrently, NULL when decoded one after the other
+  struct TagDecSliceThreadCtx* pSliceThreadCtx;
+
 #ifdef NO_WAITING_AU
   //Save the last nal header info
   SNalUnitHeaderExt sLastNalHdrExt;
@@ -50,6 +50,18 @@ namespace WelsDec {
 void ExpandReferencingPicture (PPicture pPic, PExpandPictureFunc pExpandPictureLuma,
                                  PExpandPictureFunc pExpandPictureChroma[2]);
 
+/*
+ * pad the border next to the luma lines from pPic->iExpandedLines up to kiEndLine, and the corresponding chroma lines;
+ * lines given must be final, i.e. deblocked with the MB row below them filtered as well
+ */
+void ExpandReferencingPictureLines (PPicture pPic, const int32_t kiEndLine);
+
+/*
+ * pad what pipelined deblocking left of the border, or the whole border if it padded nothing
+ */
+void ExpandReferencingPictureRemaining (PPicture pPic, PExpandPictureFunc pExpandPictureLuma,
+                                        PExpandPictureFunc pExpandPictureChroma[2]);
+
 void InitExpandPictureFunc (SExpandPicFunc* pExpandPicFunc, const uint32_t kuiCpuFlags);
 
 } // namespace WelsDec
@@ -43,6 +43,7 @@
 #include "typedefs.h"
 #include "wels_const.h"
 #include "parameter_sets.h"
+#include "memory_align.h"
 
 namespace WelsDec {
 
@@ -70,10 +71,11 @@ uint8_t		uiReserved[3];		// reserved padding bytes
  * \param	pPps		PPps
  * \param	kiMbWidth	mb width
  * \param	kiMbHeight	mb height
+ * \param	pMa			decoder memory allocator
  *
  * \return	0 - successful; none 0 - failed;
  */
-int32_t	InitFmo (PFmo pFmo, PPps pPps, const int32_t kiMbWidth, const int32_t kiMbHeight);
+int32_t	InitFmo (PFmo pFmo, PPps pPps, const int32_t kiMbWidth, const int32_t kiMbHeight, CMemoryAlign* pMa);
 
 /*!
  * \brief	Uninitialize Wels Flexible Macroblock Ordering (FMO) list
@@ -81,10 +83,11 @@ int32_t	InitFmo (PFmo pFmo, PPps pPps, const int32_t kiMbWidth, const int32_t ki
  * \param	pFmo		Wels base fmo ptr to be uninitialized
  * \param	kiCnt		count number of PPS per list
  * \param	kiAvail		count available number of PPS in list
+ * \param	pMa			decoder memory allocator
  *
  * \return	NONE
  */
-void UninitFmoList (PFmo pFmo, const int32_t kiCnt, const int32_t kiAvail);
+void UninitFmoList (PFmo pFmo, const int32_t kiCnt, const int32_t kiAvail, CMemoryAlign* pMa);
 
 /*!
  * \brief	update/insert FMO parameter unit
@@ -93,10 +96,11 @@ void UninitFmoList (PFmo pFmo, const int32_t kiCnt, const int32_t kiAvail);
  * \param	pSps	PSps
  * \param	pPps	PPps
  * \param	pActiveFmoNum	int32_t* [in/out]
+ * \param	pMa		decoder memory allocator
  *
  * \return	true - update/insert successfully; false - failed;
  */
-bool FmoParamUpdate (PFmo pFmo, PSps pSps, PPps pPps, int32_t* pActiveFmoNum);
+bool FmoParamUpdate (PFmo pFmo, PSps pSps, PPps pPps, int32_t* pActiveFmoNum, CMemoryAlign* pMa);
 
 /*!
  * \brief	Get successive mb to be processed with given current mb_xy
@@ -0,0 +1,91 @@
+/*!
+ * \copy
+ *     Copyright (c)  2009-2013, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file		output_format.h
+ *
+ * \brief		Interface for converting decoded pictures to the output color format and size
+ *
+ * \date	10/18/2026 Created
+ *************************************************************************************
+ */
+
+#ifndef WELS_OUTPUT_FORMAT_H__
+#define WELS_OUTPUT_FORMAT_H__
+
+#include "decoder_context.h"
+#include "picture.h"
+
+namespace WelsDec {
+
+/*
+ * whether frames can be output in kiColorFormat, an EVideoFormatType
+ */
+bool IsOutputFormatSupported (const int32_t kiColorFormat);
+
+/*
+ * set up the output of pPic starting to be decoded for the current output format and size, allocating the memory
+ * of the output if it is converted or scaled
+ */
+int32_t InitPicOutput (PWelsDecoderContext pCtx, PPicture pPic, const SPosOffset* pCrop);
+
+/*
+ * convert the output rows of pPic computed from luma lines up to kiEndLine and the corresponding chroma lines;
+ * lines given must be final, the same as for ExpandReferencingPictureLines
+ */
+void ConvertPicOutputLines (SOutputFormatFunc* pFunc, PPicture pPic, const int32_t kiEndLine);
+
+/*
+ * convert what is left of the output of the complete pPic
+ */
+void ConvertPicOutputRemaining (SOutputFormatFunc* pFunc, PPicture pPic);
+
+void InitOutputFormatFunc (SOutputFormatFunc* pFunc, const uint32_t kuiCpuFlags);
+
+void InterleaveUV_c (uint8_t* pDstUV, const uint8_t* pSrcU, const uint8_t* pSrcV, const int32_t kiWidth);
+void YuvToRgbaRow_c (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU, const uint8_t* pSrcV,
+                     const int32_t kiWidth);
+void YuvToBgraRow_c (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU, const uint8_t* pSrcV,
+                     const int32_t kiWidth);
+void ScaleRowBilinear_c (uint8_t* pDst, const int32_t kiDstWidth, const uint8_t* pSrc0, const uint8_t* pSrc1,
+                         const int32_t kiSrcWidth, const int32_t kiStepX, const int32_t kiFracY);
+
+#if defined(X86_INTRINSICS)
+// intrinsics, selected when WELS_CPU_SSE2 is reported
+void InterleaveUV_sse2 (uint8_t* pDstUV, const uint8_t* pSrcU, const uint8_t* pSrcV, const int32_t kiWidth);
+void YuvToRgbaRow_sse2 (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU, const uint8_t* pSrcV,
+                        const int32_t kiWidth);
+void YuvToBgraRow_sse2 (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU, const uint8_t* pSrcV,
+                        const int32_t kiWidth);
+#endif//X86_INTRINSICS
+
+} // namespace WelsDec
+
+#endif//WELS_OUTPUT_FORMAT_H__
@@ -55,15 +55,6 @@ namespace WelsDec {
 #define CHROMA_DC    4
 #define CHROMA_AC    5
 
-typedef struct TagReadBitsCache {
-  uint32_t uiCache32Bit;
-  uint8_t  uiRemainBits;
-  uint8_t*  pBuf;
-} SReadBitsCache;
-
-#define SHIFT_BUFFER(pBitsCache)	{	pBitsCache->pBuf+=2; pBitsCache->uiRemainBits += 16; pBitsCache->uiCache32Bit |= (((pBitsCache->pBuf[2] << 8) | pBitsCache->pBuf[3]) << (32 - pBitsCache->uiRemainBits));	}
-#define POP_BUFFER(pBitsCache, iCount)	{ pBitsCache->uiCache32Bit <<= iCount;	pBitsCache->uiRemainBits -= iCount;	}
-
 static const uint8_t g_kuiZigzagScan[16] = { //4*4block residual zig-zag scan order
   0,  1,  4,  8,
   5,  2,  3,  6,
@@ -173,8 +164,6 @@ int32_t CheckIntraChromaPredMode (uint8_t uiSampleAvail, int8_t* pMode);
 int32_t PredIntra4x4Mode (int8_t* pIntraPredMode, int32_t iIdx4);
 
 
-void BsStartCavlc (PBitStringAux pBs);
-void BsEndCavlc (PBitStringAux pBs);
 
 int32_t WelsResidualBlockCavlc (SVlcTable* pVlcTable,
                                 uint8_t* pNonZeroCountCache,
@@ -203,11 +192,11 @@ int32_t ParseIntra16x16ModeConstrain1 (PNeighAvail pNeighAvail, PBitStringAux pB
 
 /*!
  * \brief   parsing inter info (including ref_index and mvd)
- * \param 	input : decoding context, current mb, bit-stream
+ * \param 	input : decoding context, layer of the current mb, bit-stream
  * \param 	output: 0 indicating decoding correctly; -1 means error
  */
-int32_t ParseInterInfo (PWelsDecoderContext pCtx, int16_t iMvArray[LIST_A][30][MV_A], int8_t iRefIdxArray[LIST_A][30],
-                        PBitStringAux pBs);
+int32_t ParseInterInfo (PWelsDecoderContext pCtx, PDqLayer pCurDqLayer, int16_t iMvArray[LIST_A][30][MV_A],
+                        int8_t iRefIdxArray[LIST_A][30], PBitStringAux pBs);
 
 } // namespace WelsDec
 #endif//WELS_PARSE_MB_SYN_CAVLC_H__
@@ -35,9 +35,28 @@
 #define WELS_PICTURE_H__
 
 #include "typedefs.h"
+#include "codec_app_def.h"
 
 namespace WelsDec {
 
+/*
+ *	Conversion of a picture to the output format, see SWelsDecoderContext::iOutputColorFormat; it runs row by row
+ *	behind deblocking where that is pipelined, else once the picture is complete
+ */
+typedef struct TagPicOutput {
+int32_t		iFormat;		// EVideoFormatType written to pDst
+int32_t		iSrcX;			// top left luma sample of the cropped picture
+int32_t		iSrcY;
+int32_t		iSrcWidth;		// size of the cropped picture
+int32_t		iSrcHeight;
+int32_t		iWidth;			// size of the output, downscaled if smaller than the cropped picture
+int32_t		iHeight;
+uint8_t*	pDst[3];		// planes of the output, pDst[0] is NULL if the picture is output as it is
+int32_t		iStride[3];
+uint8_t*	pRow[3];		// scaled Y, U and V rows of the output row being converted
+int32_t		iLines;			// output rows converted so far
+} SPicOutput;
+
 /*
  *	Reconstructed Picture definition
  *	It is used to express reference picture, also consequent reconstruction picture for output
@@ -48,6 +67,12 @@ uint8_t*		pBuffer[4];		// pointer to the first allocated byte, basical offset of
 uint8_t*		pData[4];		// pointer to picture planes respectively
 int32_t		iLinesize[4];// linesize of picture planes respectively used currently
 int32_t		iPlanes;			// How many planes are introduced due to color space format?
+int32_t		iBufferSize;		// bytes allocated at pBuffer[0], any resolution fitting in is laid out over it
+SPictureBufferProvider*	pBufferProvider;	// where pBuffer[0] comes from if the application supplied it, else NULL
+void*		pOpaque;		// handle of the application buffer
+SPicOutput	sOutput;		// the frame as output if converted or scaled
+uint8_t*	pOutBuffer;		// memory of sOutput
+int32_t		iOutBufferSize;
 // picture information
 
 /*******************************from other standard syntax****************************/
@@ -60,7 +85,7 @@ int32_t		iFramePoc;		// frame POC
 /*******************************sef_definition for misc use****************************/
 bool		bUsedAsRef;							//for ref pic management
 bool		bIsLongRef;	// long term reference frame flag	//for ref pic management
-uint8_t		uiRefCount;
+uint8_t		uiRefCount;	// number of in-flight frame decoding tasks holding this picture
 bool		bAvailableFlag;	// indicate whether it is available in this picture memory block.
 
 /*******************************for future use****************************/
@@ -70,6 +95,9 @@ uint8_t		uiQualityId;
 
 int32_t		iFrameNum;		// frame number			//for ref pic management
 int32_t		iLongTermFrameIdx;					//id for long term ref pic
+int32_t		iReadyLines;	// luma lines finally reconstructed so far, guarded by the thread lock when frame threading
+int32_t		iDeblockedMbs;	// MBs deblocked in raster order so far, by pipelined deblocking
+int32_t		iExpandedLines;	// luma lines padded into the border so far, by pipelined deblocking
 
 int32_t     iSpsId; //against mosaic caused by cross-IDR interval reference.
 int32_t     iPpsId;
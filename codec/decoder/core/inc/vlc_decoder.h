@@ -112,6 +112,11 @@ extern const uint8_t g_kuiZeroLeftBitNumMap[16];
 	__asm neg		eax\
 	__asm mov		outval,	eax\
 }
+#elif defined(__GNUC__)
+#define WELS_GET_PREFIX_BITS(inval, outval){\
+	uint32_t local = inval;\
+	outval = local ? __builtin_clz (local) + 1 : 32;\
+}
 #else
 #define WELS_GET_PREFIX_BITS(inval, outval) outval = GetPrefixBits(inval)
 #endif
@@ -44,6 +44,13 @@
 #include "memmgr_nal_unit.h"
 #include "decoder_core.h"
 #include "decoder_core.h"
+#include "ls_defines.h"
+#include "macros.h"
+#if defined(X86_INTRINSICS) && (defined(__SSE2__) || defined(_M_X64))
+// SSE2 is part of the target baseline, the scanner needs no cpu dispatch
+#define START_CODE_SCAN_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace WelsDec {
 /*!
@@ -61,28 +68,76 @@ namespace WelsDec {
  *************************************************************************************
  */
 uint8_t* DetectStartCodePrefix (const uint8_t* kpBuf, int32_t* pOffset, int32_t iBufSize) {
-  uint8_t* pBits = (uint8_t*)kpBuf;
+  int32_t iPos = 0;
 
-  do {
-    int32_t iIdx = 0;
-    while ((iIdx < iBufSize) && (! (*pBits))) {
-      ++ pBits;
-      ++ iIdx;
+  while (iPos < iBufSize) {
+    iPos += FindStartCodeCandidate (kpBuf + iPos, iBufSize - iPos);
+    if (iPos >= iBufSize)
+      break;
+
+    if (kpBuf[iPos + 2] == 0x01) {
+      *pOffset = iPos + 3;
+      return (uint8_t*)kpBuf + iPos + 3;
     }
-    if (iIdx >= iBufSize)  break;
+    ++ iPos;
+  }
 
-    ++ iIdx;
-    ++ pBits;
+  return NULL;
+}
 
-    if ((iIdx >= 3) && ((* (pBits - 1)) == 0x1)) {
-      *pOffset = ((uintptr_t)pBits) - ((uintptr_t)kpBuf);
-      return pBits;
+/*!
+ *************************************************************************************
+ * \brief	find the first 00 00 0x (x <= 3) pattern, i.e. a start code prefix or an
+ *			emulation prevention byte candidate
+ *
+ * \param 	kpBuf		bitstream payload buffer
+ * \param	kiBufSize	count size of buffer
+ *
+ * \return	offset of the first zero byte of the pattern, kiBufSize if there is none
+ *
+ * \note	16 bytes are skipped at a time as long as they hold no 00 00 pair with SSE2,
+ *			otherwise 8 bytes as long as none of them is zero
+ *************************************************************************************
+ */
+#if defined(START_CODE_SCAN_SSE2)
+static inline int32_t SkipBlocksWithoutZeroPair_sse2 (const uint8_t* kpBuf, int32_t iPos, const int32_t kiBufSize) {
+  const __m128i kxZero = _mm_setzero_si128();
+
+  while (iPos + 16 <= kiBufSize) {
+    const int32_t kiZeros = _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i*) (kpBuf + iPos)),
+                            kxZero));
+    if (kiZeros & (kiZeros >> 1))
+      break;
+    // a zero in the last byte may start a pair with the next block
+    iPos += (kiZeros & 0x8000) ? 15 : 16;
+  }
+  return iPos;
+}
+#endif//START_CODE_SCAN_SSE2
+
+int32_t FindStartCodeCandidate (const uint8_t* kpBuf, const int32_t kiBufSize) {
+  const int32_t kiLastPos = kiBufSize - 2;	// the pattern needs 3 bytes
+  int32_t iPos = 0;
+
+  while (iPos < kiLastPos) {
+#if defined(START_CODE_SCAN_SSE2)
+    const int32_t kiWordSize = 16;
+    iPos = SkipBlocksWithoutZeroPair_sse2 (kpBuf, iPos, kiBufSize);
+#else
+    const int32_t kiWordSize = 8;
+    while ((iPos + 8 <= kiBufSize) && WELS_NO_ZERO_BYTE_64 (LD64 (kpBuf + iPos))) {
+      iPos += 8;
     }
+#endif//START_CODE_SCAN_SSE2
 
-    iBufSize -= iIdx;
-  }  while (1);
+    const int32_t kiWordEnd = (iPos + kiWordSize < kiLastPos) ? (iPos + kiWordSize) : kiLastPos;
+    for (; iPos < kiWordEnd; ++ iPos) {
+      if ((0 == kpBuf[iPos]) && (0 == kpBuf[iPos + 1]) && (kpBuf[iPos + 2] <= 0x03))
+        return iPos;
+    }
+  }
 
-  return NULL;
+  return kiBufSize;
 }
 
 /*!
@@ -237,7 +292,7 @@ uint8_t* ParseNalHeader (PWelsDecoderContext pCtx, SNalUnitHeader* pNalUnitHeade
   case NAL_UNIT_CODED_SLICE_IDR: {
     PAccessUnit pCurAu		= NULL;
     uint32_t uiAvailNalNum;
-    pCurNal = MemGetNextNal (&pCtx->pAccessUnitList);
+    pCurNal = MemGetNextNal (&pCtx->pAccessUnitList, pCtx->pMemAlign);
     if (NULL == pCurNal) {
       WelsLog (pCtx, WELS_LOG_WARNING, "MemGetNextNal() fail due out of memory.\n");
       pCtx->iErrorCode	|= dsOutOfMemory;
@@ -1185,7 +1240,7 @@ int32_t ResetFmoList (PWelsDecoderContext pCtx) {
   int32_t iCountNum = 0;
   if (NULL != pCtx) {
     // Fixed memory leak due to PPS_ID might not be continuous sometimes, 1/5/2010
-    UninitFmoList (&pCtx->sFmoList[0], MAX_PPS_COUNT, pCtx->iActiveFmoNum);
+    UninitFmoList (&pCtx->sFmoList[0], MAX_PPS_COUNT, pCtx->iActiveFmoNum, pCtx->pMemAlign);
     iCountNum	= pCtx->iActiveFmoNum;
     pCtx->iActiveFmoNum	= 0;
   }
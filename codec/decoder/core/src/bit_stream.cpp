@@ -37,20 +37,14 @@
  *
  *************************************************************************************
  */
-#include "bit_stream.h"
+#include "dec_golomb.h"
 
 namespace WelsDec {
 
-inline uint32_t GetValue4Bytes (uint8_t* pDstNal) {
-  uint32_t uiValue = 0;
-  uiValue = (pDstNal[0] << 24) | (pDstNal[1] << 16) | (pDstNal[2] << 8) | (pDstNal[3]);
-  return uiValue;
-}
-
 void InitReadBits (PBitStringAux pBitString) {
-  pBitString->uiCurBits  = GetValue4Bytes (pBitString->pCurBuf);
-  pBitString->pCurBuf  += 4;
-  pBitString->iLeftBits = -16;
+  pBitString->uiCurBits = 0;
+  pBitString->iLeftBits = 0;
+  BsRefillBits (pBitString);
 }
 
 /*!
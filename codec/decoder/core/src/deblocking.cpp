@@ -41,6 +41,9 @@
 #include "deblocking.h"
 #include "deblocking_common.h"
 #include "cpu_core.h"
+#if defined(X86_INTRINSICS)
+#include <immintrin.h>
+#endif//X86_INTRINSICS
 
 namespace WelsDec {
 
@@ -248,6 +251,42 @@ uint32_t DeblockingBsMarginalMBAvcbase (PDqLayer pCurDqLayer, int32_t iEdge, int
   }
   return uiBSx4;
 }
+
+#if defined(X86_INTRINSICS)
+static void DeblockingBSInsideMBNormal_avx2 (PDqLayer pCurDqLayer, uint8_t nBS[2][4][4], int8_t* pNnzTab,
+    int32_t iMbXy) {
+#if defined(SAME_MB_DIFF_REFIDX)
+  const int8_t* pRefIndex = pCurDqLayer->pRefIndex[LIST_0][iMbXy];
+#else
+  const int8_t* pRefIndex = NULL;
+#endif
+  DeblockingBSInsideMB_avx2 (pNnzTab, pRefIndex, &pCurDqLayer->pMv[LIST_0][iMbXy][0][0], nBS);
+}
+
+// the four edge blocks are picked with pshufb/gather from g_kuiTableBIdx
+WELS_TARGET_AVX2 uint32_t DeblockingBsMarginalMBAvcbase_avx2 (PDqLayer pCurDqLayer, int32_t iEdge, int32_t iNeighMb,
+    int32_t iMbXy) {
+  const __m128i kxOne = _mm_set1_epi8 (1);
+  const __m128i xBIdx  = _mm_cvtsi32_si128 (* (const int32_t*)&g_kuiTableBIdx[iEdge][0]);
+  const __m128i xBnIdx = _mm_cvtsi32_si128 (* (const int32_t*)&g_kuiTableBIdx[iEdge][4]);
+
+  __m128i xNnz = _mm_or_si128 (_mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*)pCurDqLayer->pNzc[iMbXy]), xBIdx),
+                               _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*)pCurDqLayer->pNzc[iNeighMb]), xBnIdx));
+  __m128i xRef = _mm_xor_si128 (
+                   _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*)pCurDqLayer->pRefIndex[LIST_0][iMbXy]), xBIdx),
+                   _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*)pCurDqLayer->pRefIndex[LIST_0][iNeighMb]), xBnIdx));
+  __m128i xMv = _mm_sub_epi16 (
+                  _mm_i32gather_epi32 ((const int*)pCurDqLayer->pMv[LIST_0][iMbXy], _mm_cvtepu8_epi32 (xBIdx), 4),
+                  _mm_i32gather_epi32 ((const int*)pCurDqLayer->pMv[LIST_0][iNeighMb], _mm_cvtepu8_epi32 (xBnIdx), 4));
+  xMv = _mm_cmpgt_epi16 (_mm_abs_epi16 (xMv), _mm_set1_epi16 (3));
+  xMv = _mm_packs_epi16 (_mm_packs_epi32 (xMv, xMv), xMv);
+
+  xNnz = _mm_min_epu8 (xNnz, kxOne);
+  __m128i xBs = _mm_max_epu8 (_mm_add_epi8 (xNnz, xNnz), _mm_min_epu8 (_mm_or_si128 (xMv, xRef), kxOne));
+  return (uint32_t)_mm_cvtsi128_si32 (xBs);
+}
+#endif//X86_INTRINSICS
+
 int32_t DeblockingAvailableNoInterlayer (PDqLayer pCurDqLayer, int32_t iFilterIdc) {
   int32_t iMbY = pCurDqLayer->iMbY;
   int32_t iMbX = pCurDqLayer->iMbX;
@@ -256,8 +295,8 @@ int32_t DeblockingAvailableNoInterlayer (PDqLayer pCurDqLayer, int32_t iFilterId
   bool bTopFlag  = false;
 
   if (2 == iFilterIdc) {
-    bLeftFlag = (iMbX > 0) && (pCurDqLayer->pSliceIdc[iMbXy] == pCurDqLayer->pSliceIdc[iMbXy - 1]);
-    bTopFlag  = (iMbY > 0) && (pCurDqLayer->pSliceIdc[iMbXy] == pCurDqLayer->pSliceIdc[iMbXy - pCurDqLayer->iMbWidth]);
+    bLeftFlag = (iMbX > 0) && IsMbInCurSlice (pCurDqLayer, iMbXy - 1);
+    bTopFlag  = (iMbY > 0) && IsMbInCurSlice (pCurDqLayer, iMbXy - pCurDqLayer->iMbWidth);
   } else { //if ( 0 == iFilterIdc )
     bLeftFlag = (iMbX > 0);
     bTopFlag  = (iMbY > 0);
@@ -589,15 +628,15 @@ void WelsDeblockingMb (PDqLayer pCurDqLayer, PDeblockingFilter  pFilter, int32_t
 
     if (iBoundryFlag & LEFT_FLAG_MASK) {
       iMbNb = iMbXyIndex - 1;
-      * (uint32_t*)nBS[0][0] = IS_INTRA (pCurDqLayer->pMbType[iMbNb]) ? 0x04040404 : DeblockingBsMarginalMBAvcbase (
-                                 pCurDqLayer, 0, iMbNb, iMbXyIndex);
+      * (uint32_t*)nBS[0][0] = IS_INTRA (pCurDqLayer->pMbType[iMbNb]) ? 0x04040404 :
+                               pFilter->pLoopf->pfDeblockingBSMarginalMB (pCurDqLayer, 0, iMbNb, iMbXyIndex);
     } else {
       * (uint32_t*)nBS[0][0] = 0;
     }
     if (iBoundryFlag & TOP_FLAG_MASK) {
       iMbNb = iMbXyIndex - pCurDqLayer->iMbWidth;
-      * (uint32_t*)nBS[1][0] = IS_INTRA (pCurDqLayer->pMbType[iMbNb]) ? 0x04040404 : DeblockingBsMarginalMBAvcbase (
-                                 pCurDqLayer, 1, iMbNb, iMbXyIndex);
+      * (uint32_t*)nBS[1][0] = IS_INTRA (pCurDqLayer->pMbType[iMbNb]) ? 0x04040404 :
+                               pFilter->pLoopf->pfDeblockingBSMarginalMB (pCurDqLayer, 1, iMbNb, iMbXyIndex);
     } else {
       * (uint32_t*)nBS[1][0] = 0;
     }
@@ -606,7 +645,7 @@ void WelsDeblockingMb (PDqLayer pCurDqLayer, PDeblockingFilter  pFilter, int32_t
       if (iCurMbType == MB_TYPE_16x16) {
         DeblockingBSInsideMBAvsbase (pCurDqLayer->pNzc[iMbXyIndex], nBS, 1);
       } else {
-        DeblockingBSInsideMBNormal (pCurDqLayer, nBS, pCurDqLayer->pNzc[iMbXyIndex], iMbXyIndex);
+        pFilter->pLoopf->pfDeblockingBSInsideMBNormal (pCurDqLayer, nBS, pCurDqLayer->pNzc[iMbXyIndex], iMbXyIndex);
       }
     } else {
       * (uint32_t*)nBS[0][1] = * (uint32_t*)nBS[0][2] = * (uint32_t*)nBS[0][3] =
@@ -617,22 +656,41 @@ void WelsDeblockingMb (PDqLayer pCurDqLayer, PDeblockingFilter  pFilter, int32_t
   }
 }
 
+static void InitDeblockingFilter (PWelsDecoderContext pCtx, PDqLayer pCurDqLayer, SDeblockingFilter* pFilter) {
+  PSliceHeaderExt pSliceHeaderExt = &pCurDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt;
+
+  memset (pFilter, 0, sizeof (SDeblockingFilter));
+
+  pFilter->pCsData[0] = pCurDqLayer->pDec->pData[0];
+  pFilter->pCsData[1] = pCurDqLayer->pDec->pData[1];
+  pFilter->pCsData[2] = pCurDqLayer->pDec->pData[2];
+
+  pFilter->iCsStride[0] = pCurDqLayer->pDec->iLinesize[0];
+  pFilter->iCsStride[1] = pCurDqLayer->pDec->iLinesize[1];
+
+  pFilter->eSliceType = (ESliceType) pCurDqLayer->sLayerInfo.sSliceInLayer.eSliceType;
+
+  pFilter->iSliceAlphaC0Offset = pSliceHeaderExt->sSliceHeader.iSliceAlphaC0Offset;
+  pFilter->iSliceBetaOffset     = pSliceHeaderExt->sSliceHeader.iSliceBetaOffset;
+
+  pFilter->pLoopf = &pCtx->sDeblockingFunc;
+}
+
 /*!
  * \brief	AVC slice deblocking filtering target layer
  *
- * \param	dec			Wels avc decoder context
+ * \param	pCtx		Wels avc decoder context
+ * \param	pCurDqLayer	dq layer holding the slice to be filtered
  *
  * \return	NONE
  */
-void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDeblockingFilterMbFunc pDeblockMb) {
-  PDqLayer pCurDqLayer = pCtx->pCurDqLayer;
+void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDqLayer pCurDqLayer, PDeblockingFilterMbFunc pDeblockMb) {
   PSliceHeaderExt pSliceHeaderExt = &pCurDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt;
   int32_t iMbWidth  = pCurDqLayer->iMbWidth;
   int32_t iTotalMbCount = pSliceHeaderExt->sSliceHeader.pSps->uiTotalMbCount;
 
   SDeblockingFilter pFilter;
-  memset (&pFilter, 0, sizeof(pFilter));
-  PFmo pFmo = pCtx->pFmo;
+  PFmo pFmo = pCurDqLayer->pFmo;
   int32_t iNextMbXyIndex = 0;
   int32_t iTotalNumMb = pCurDqLayer->sLayerInfo.sSliceInLayer.iTotalMbInCurSlice;
   int32_t iCountNumMb = 0;
@@ -640,19 +698,7 @@ void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDeblockingFilterMbFun
   int32_t iFilterIdc = pCurDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.uiDisableDeblockingFilterIdc;
 
   /* Step1: parameters set */
-  pFilter.pCsData[0] = pCtx->pDec->pData[0];
-  pFilter.pCsData[1] = pCtx->pDec->pData[1];
-  pFilter.pCsData[2] = pCtx->pDec->pData[2];
-
-  pFilter.iCsStride[0] = pCtx->pDec->iLinesize[0];
-  pFilter.iCsStride[1] = pCtx->pDec->iLinesize[1];
-
-  pFilter.eSliceType = (ESliceType) pCurDqLayer->sLayerInfo.sSliceInLayer.eSliceType;
-
-  pFilter.iSliceAlphaC0Offset = pSliceHeaderExt->sSliceHeader.iSliceAlphaC0Offset;
-  pFilter.iSliceBetaOffset     = pSliceHeaderExt->sSliceHeader.iSliceBetaOffset;
-
-  pFilter.pLoopf = &pCtx->sDeblockingFunc;
+  InitDeblockingFilter (pCtx, pCurDqLayer, &pFilter);
 
   /* Step2: macroblock deblocking */
   if (0 == iFilterIdc || 2 == iFilterIdc) {
@@ -686,6 +732,46 @@ void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDeblockingFilterMbFun
     } while (1);
   }
 }
+
+/*!
+ * \brief	AVC slice deblocking filtering the MBs of one row, one row behind reconstruction
+ */
+void WelsDeblockingFilterSliceRow (PWelsDecoderContext pCtx, PDqLayer pCurDqLayer, PDeblockingFilterMbFunc pDeblockMb,
+                                   const int32_t kiMbY) {
+  PSlice pSlice = &pCurDqLayer->sLayerInfo.sSliceInLayer;
+  int32_t iMbWidth  = pCurDqLayer->iMbWidth;
+  int32_t iFirstMb  = pSlice->sSliceHeaderExt.sSliceHeader.iFirstMbInSlice;
+  int32_t iStartMb  = WELS_MAX (iFirstMb, kiMbY * iMbWidth);
+  int32_t iEndMb    = WELS_MIN (iFirstMb + pSlice->iTotalMbInCurSlice, (kiMbY + 1) * iMbWidth);
+
+  WelsDeblockingFilterSliceMbs (pCtx, pCurDqLayer, pDeblockMb, iStartMb, iEndMb);
+}
+
+/*!
+ * \brief	AVC slice deblocking filtering a run of MBs of the slice within one row
+ */
+void WelsDeblockingFilterSliceMbs (PWelsDecoderContext pCtx, PDqLayer pCurDqLayer, PDeblockingFilterMbFunc pDeblockMb,
+                                   const int32_t kiStartMb, const int32_t kiEndMb) {
+  int32_t iMbWidth  = pCurDqLayer->iMbWidth;
+  int32_t iFilterIdc = pCurDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.uiDisableDeblockingFilterIdc;
+  int32_t iMbXy;
+
+  SDeblockingFilter pFilter;
+
+  if (0 != iFilterIdc && 2 != iFilterIdc)
+    return;
+
+  InitDeblockingFilter (pCtx, pCurDqLayer, &pFilter);
+
+  pCurDqLayer->iMbY = kiStartMb / iMbWidth;
+  for (iMbXy = kiStartMb; iMbXy < kiEndMb; ++ iMbXy) {
+    pCurDqLayer->iMbX  = iMbXy % iMbWidth;
+    pCurDqLayer->iMbXyIndex = iMbXy;
+
+    pDeblockMb (pCurDqLayer, &pFilter, DeblockingAvailableNoInterlayer (pCurDqLayer, iFilterIdc));
+  }
+}
+
 /*!
  * \brief	deblocking module initialize
  *
@@ -706,6 +792,9 @@ void  DeblockingInit (SDeblockingFunc*  pFunc,  int32_t iCpu) {
   pFunc->pfChromaDeblockingLT4Hor	    = DeblockChromaLt4H_c;
   pFunc->pfChromaDeblockingEQ4Hor	    = DeblockChromaEq4H_c;
 
+  pFunc->pfDeblockingBSInsideMBNormal = DeblockingBSInsideMBNormal;
+  pFunc->pfDeblockingBSMarginalMB     = DeblockingBsMarginalMBAvcbase;
+
 #ifdef X86_ASM
   if (iCpu & WELS_CPU_SSSE3) {
     pFunc->pfLumaDeblockingLT4Ver	= DeblockLumaLt4V_ssse3;
@@ -717,7 +806,23 @@ void  DeblockingInit (SDeblockingFunc*  pFunc,  int32_t iCpu) {
     pFunc->pfChromaDeblockingLT4Hor	= DeblockChromaLt4H_ssse3;
     pFunc->pfChromaDeblockingEQ4Hor	= DeblockChromaEq4H_ssse3;
   }
-#endif
+#endif//X86_ASM
+
+#if defined(X86_INTRINSICS)
+  if (iCpu & WELS_CPU_AVX2) {
+    pFunc->pfLumaDeblockingLT4Ver	= DeblockLumaLt4V_avx2;
+    pFunc->pfLumaDeblockingEQ4Ver	= DeblockLumaEq4V_avx2;
+    pFunc->pfLumaDeblockingLT4Hor   = DeblockLumaLt4H_avx2;
+    pFunc->pfLumaDeblockingEQ4Hor   = DeblockLumaEq4H_avx2;
+    pFunc->pfChromaDeblockingLT4Ver	= DeblockChromaLt4V_avx2;
+    pFunc->pfChromaDeblockingEQ4Ver	= DeblockChromaEq4V_avx2;
+    pFunc->pfChromaDeblockingLT4Hor	= DeblockChromaLt4H_avx2;
+    pFunc->pfChromaDeblockingEQ4Hor	= DeblockChromaEq4H_avx2;
+
+    pFunc->pfDeblockingBSInsideMBNormal = DeblockingBSInsideMBNormal_avx2;
+    pFunc->pfDeblockingBSMarginalMB     = DeblockingBsMarginalMBAvcbase_avx2;
+  }
+#endif//X86_INTRINSICS
 
 #if defined(HAVE_NEON)
   if ( iCpu & WELS_CPU_NEON )
@@ -0,0 +1,1199 @@
+/*!
+ * \copy
+ *     Copyright (c)  2014, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *	dec_multi_threading.cpp:	frame level parallel reconstruction for Wels decoder
+ *
+ *	The calling thread keeps doing everything order dependent: bitstream parsing, reference list construction,
+ *	marking and error concealment. The reconstruction of the target layer of every access unit is queued as a
+ *	frame task; a worker publishes the luma lines finally reconstructed in SPicture::iReadyLines and motion
+ *	compensation of later frames blocks in WaitRefPicLines only for the reference rows it actually reads.
+ */
+
+#include "dec_multi_threading.h"
+#include "decode_slice.h"
+#include "deblocking.h"
+#include "decoder.h"
+#include "expand_pic.h"
+#include "output_format.h"
+#include "error_concealment.h"
+#include "utils.h"
+
+namespace WelsDec {
+
+#define SLICE_TASK_NUM_INIT	8
+
+static inline PDecFrameTask TaskAt (PDecThreadCtx pThCtx, const uint32_t kuiSeq) {
+  return &pThCtx->sTasks[kuiSeq % pThCtx->iTaskNum];
+}
+
+static void ReleaseFrameTask (PDecFrameTask pTask) {
+  int32_t i;
+
+  if (NULL != pTask->pDec) {
+    -- pTask->pDec->uiRefCount;
+    pTask->pDec = NULL;
+  }
+  for (i = 0; i < pTask->iRefPicNum; ++ i) {
+    -- pTask->pRefPic[i]->uiRefCount;
+    pTask->pRefPic[i] = NULL;
+  }
+  pTask->iRefPicNum		= 0;
+  pTask->iSliceTaskNum	= 0;
+  pTask->eState			= FRAME_TASK_IDLE;
+}
+
+/* release leading tasks which are output already or have nothing to output, called with hLock held */
+static void RecycleFrameTasks (PDecThreadCtx pThCtx) {
+  int32_t i = 0;
+
+  while (pThCtx->uiTaskFirst != pThCtx->uiTaskNext) {
+    PDecFrameTask pTask = TaskAt (pThCtx, pThCtx->uiTaskFirst);
+    if (pTask->eState != FRAME_TASK_DELIVERED
+        && ! (pTask->eState == FRAME_TASK_DONE && 0 == pTask->sDstInfo.iBufferStatus))
+      break;
+    ReleaseFrameTask (pTask);
+    ++ pThCtx->uiTaskFirst;
+  }
+
+  while (i < pThCtx->iRetiredNum) {
+    if ((int32_t) (pThCtx->uiTaskFirst - pThCtx->uiRetiredUntil[i]) >= 0) {
+      DestroyPicBuff (&pThCtx->pRetiredPicBuff[i], pThCtx->pCtx->pMemAlign);
+      -- pThCtx->iRetiredNum;
+      pThCtx->pRetiredPicBuff[i] = pThCtx->pRetiredPicBuff[pThCtx->iRetiredNum];
+      pThCtx->uiRetiredUntil[i]  = pThCtx->uiRetiredUntil[pThCtx->iRetiredNum];
+    } else {
+      ++ i;
+    }
+  }
+}
+
+static bool HasQueuedFrameTask (PDecThreadCtx pThCtx) {
+  uint32_t uiSeq;
+
+  for (uiSeq = pThCtx->uiTaskFirst; uiSeq != pThCtx->uiTaskNext; ++ uiSeq) {
+    if (TaskAt (pThCtx, uiSeq)->eState == FRAME_TASK_QUEUED)
+      return true;
+  }
+  return false;
+}
+
+static inline uint8_t* AlignMbArray (uint8_t** ppCur, const int32_t kiSize) {
+  uint8_t* pArray = *ppCur;
+
+  *ppCur += WELS_ALIGN (kiSize, 16);
+  return pArray;
+}
+
+/* carve the MB level arrays of a frame task out of one block, as InitialDqLayersContext does with sMb */
+static int32_t RequestFrameTaskMbBuffer (PDecFrameTask pTask, const int32_t kiMbNum, CMemoryAlign* pMa) {
+  SDqLayer* pArrays = &pTask->sMbArrays;
+  int32_t iSize = 0;
+  uint8_t* pCur;
+
+  if (pTask->iMbBufferMbNum >= kiMbNum)
+    return ERR_NONE;
+
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int8_t), 16);									// pMbType
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int32_t), 16);									// pSliceIdc
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int16_t) * MB_BLOCK4x4_NUM * MV_A, 16);			// pMv[0]
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int8_t) * MB_BLOCK4x4_NUM, 16);					// pRefIndex[0]
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int8_t), 16) * 2;								// pLumaQp, pChromaQp
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int8_t) * 24, 16) * 2;							// pNzc, pNzcRs
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int16_t) * MB_COEFF_LIST_SIZE, 16);				// pScaledTCoeff
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int8_t) * 8, 16);								// pIntraPredMode
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int8_t) * MB_BLOCK4x4_NUM, 16);					// pIntra4x4FinalMode
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int8_t), 16) * 2;								// pChromaPredMode, pCbp
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int8_t) * MB_SUB_PARTITION_SIZE, 16);			// pSubMbType
+  iSize += WELS_ALIGN (kiMbNum * sizeof (int8_t), 16) * 2;				// pResidualPredFlag, pInterPredictionDoneFlag
+  iSize += WELS_ALIGN (kiMbNum * sizeof (bool), 16);										// pMbCorrectlyDecodedFlag
+
+  pMa->WelsFree (pTask->pMbBuffer, "pTask->pMbBuffer");
+  pTask->iMbBufferMbNum = 0;
+  pTask->pMbBuffer = pMa->WelsMallocz (iSize, "pTask->pMbBuffer");
+  WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == pTask->pMbBuffer)
+
+  pCur = (uint8_t*)pTask->pMbBuffer;
+  pArrays->pMbType			= (int8_t*)AlignMbArray (&pCur, kiMbNum * sizeof (int8_t));
+  pArrays->pSliceIdc			= (int32_t*)AlignMbArray (&pCur, kiMbNum * sizeof (int32_t));
+  pArrays->pMv[0]			= (int16_t (*)[MB_BLOCK4x4_NUM][MV_A])AlignMbArray (&pCur,
+                              kiMbNum * sizeof (int16_t) * MB_BLOCK4x4_NUM * MV_A);
+  pArrays->pRefIndex[0]		= (int8_t (*)[MB_BLOCK4x4_NUM])AlignMbArray (&pCur,
+                              kiMbNum * sizeof (int8_t) * MB_BLOCK4x4_NUM);
+  pArrays->pLumaQp			= (int8_t*)AlignMbArray (&pCur, kiMbNum * sizeof (int8_t));
+  pArrays->pChromaQp			= (int8_t*)AlignMbArray (&pCur, kiMbNum * sizeof (int8_t));
+  pArrays->pNzc				= (int8_t (*)[24])AlignMbArray (&pCur, kiMbNum * sizeof (int8_t) * 24);
+  pArrays->pNzcRs			= (int8_t (*)[24])AlignMbArray (&pCur, kiMbNum * sizeof (int8_t) * 24);
+  pArrays->pScaledTCoeff		= (int16_t (*)[MB_COEFF_LIST_SIZE])AlignMbArray (&pCur,
+                              kiMbNum * sizeof (int16_t) * MB_COEFF_LIST_SIZE);
+  pArrays->pIntraPredMode	= (int8_t (*)[8])AlignMbArray (&pCur, kiMbNum * sizeof (int8_t) * 8);
+  pArrays->pIntra4x4FinalMode	= (int8_t (*)[MB_BLOCK4x4_NUM])AlignMbArray (&pCur,
+                                kiMbNum * sizeof (int8_t) * MB_BLOCK4x4_NUM);
+  pArrays->pChromaPredMode	= (int8_t*)AlignMbArray (&pCur, kiMbNum * sizeof (int8_t));
+  pArrays->pCbp				= (int8_t*)AlignMbArray (&pCur, kiMbNum * sizeof (int8_t));
+  pArrays->pSubMbType		= (int8_t (*)[MB_SUB_PARTITION_SIZE])AlignMbArray (&pCur,
+                              kiMbNum * sizeof (int8_t) * MB_SUB_PARTITION_SIZE);
+  pArrays->pResidualPredFlag	= (int8_t*)AlignMbArray (&pCur, kiMbNum * sizeof (int8_t));
+  pArrays->pInterPredictionDoneFlag	= (int8_t*)AlignMbArray (&pCur, kiMbNum * sizeof (int8_t));
+  pArrays->pMbCorrectlyDecodedFlag	= (bool*)AlignMbArray (&pCur, kiMbNum * sizeof (bool));
+  memset (pArrays->pSliceIdc, 0xff, kiMbNum * sizeof (int32_t));
+
+  pTask->iMbBufferMbNum = kiMbNum;
+  return ERR_NONE;
+}
+
+static void BindFrameTaskMbBuffer (PDqLayer pCurDq, PDecFrameTask pTask) {
+  const SDqLayer* kpArrays = &pTask->sMbArrays;
+
+  pCurDq->pMbType			= kpArrays->pMbType;
+  pCurDq->pSliceIdc		= kpArrays->pSliceIdc;
+  pCurDq->pMv[0]			= kpArrays->pMv[0];
+  pCurDq->pRefIndex[0]    = kpArrays->pRefIndex[0];
+  pCurDq->pLumaQp         = kpArrays->pLumaQp;
+  pCurDq->pChromaQp       = kpArrays->pChromaQp;
+  pCurDq->pNzc			= kpArrays->pNzc;
+  pCurDq->pNzcRs			= kpArrays->pNzcRs;
+  pCurDq->pScaledTCoeff   = kpArrays->pScaledTCoeff;
+  pCurDq->pIntraPredMode  = kpArrays->pIntraPredMode;
+  pCurDq->pIntra4x4FinalMode = kpArrays->pIntra4x4FinalMode;
+  pCurDq->pChromaPredMode = kpArrays->pChromaPredMode;
+  pCurDq->pCbp            = kpArrays->pCbp;
+  pCurDq->pSubMbType      = kpArrays->pSubMbType;
+  pCurDq->pInterPredictionDoneFlag = kpArrays->pInterPredictionDoneFlag;
+  pCurDq->pResidualPredFlag = kpArrays->pResidualPredFlag;
+  pCurDq->pMbCorrectlyDecodedFlag = kpArrays->pMbCorrectlyDecodedFlag;
+}
+
+/*
+ * reconstruct all slices of a frame task in parsing order; a worker (kbPublish) publishes the rows no later
+ * slice can touch any more while slices arrive in order, the deblocking of the next MB row may still modify
+ * the last 3 luma lines above it
+ */
+static void ReconstructFrameTask (PDecThreadCtx pThCtx, PDecFrameTask pTask, const bool kbPublish) {
+  PWelsDecoderContext pCtx = pThCtx->pCtx;
+  PPicture pDec = pTask->pDec;
+  int32_t iNextMb = 0;
+  bool bInOrder = kbPublish;
+  int32_t i;
+
+  for (i = 0; i < pTask->iSliceTaskNum; ++ i) {
+    PDqLayer pLayer = &pTask->pSliceTask[i].sLayer;
+    PSlice pSlice = &pLayer->sLayerInfo.sSliceInLayer;
+    int32_t iTotalNumMbRec = 0;
+
+    if (!kbPublish)
+      pLayer->pRefReadyLines = NULL;	// references are all complete when reconstructing synchronously
+
+    WelsTargetSliceConstruction (pCtx, pLayer, &iTotalNumMbRec, false);
+
+    if (bInOrder && pSlice->sSliceHeaderExt.sSliceHeader.iFirstMbInSlice == iNextMb) {
+      const int32_t kiReadyLines = ((iNextMb + pSlice->iTotalMbInCurSlice) / pLayer->iMbWidth << 4) - 3;
+      iNextMb += pSlice->iTotalMbInCurSlice;
+      if (kiReadyLines > 0)
+        PublishPicLines (pCtx, pDec, kiReadyLines);
+    } else {
+      bInOrder = false;	// arbitrary slice order, the picture gets ready as a whole
+    }
+  }
+  ConvertPicOutputRemaining (&pCtx->sOutputFormatFunc, pDec);
+}
+
+static WELS_THREAD_ROUTINE_TYPE DecThreadProc (void* pArg) {
+  PDecThreadCtx pThCtx = (PDecThreadCtx)pArg;
+
+  WelsMutexLock (&pThCtx->hLock);
+  while (true) {
+    PDecFrameTask pTask;
+
+    while (!pThCtx->bExit && pThCtx->uiQueueHead == pThCtx->uiQueueTail)
+      WelsCondWait (&pThCtx->hTaskCond, &pThCtx->hLock);
+    if (pThCtx->uiQueueHead == pThCtx->uiQueueTail)
+      break;
+
+    pTask = pThCtx->pQueue[pThCtx->uiQueueHead % pThCtx->iTaskNum];
+    ++ pThCtx->uiQueueHead;
+    WelsMutexUnlock (&pThCtx->hLock);
+
+    ReconstructFrameTask (pThCtx, pTask, true);
+    if (pTask->bRef) {
+      ExpandReferencingPictureRemaining (pTask->pDec, pThCtx->pCtx->sExpandPicFunc.pExpandLumaPicture,
+                                         pThCtx->pCtx->sExpandPicFunc.pExpandChromaPicture);
+    }
+
+    WelsMutexLock (&pThCtx->hLock);
+    pTask->pDec->iReadyLines = pTask->pDec->iHeightInPixel;
+    pTask->eState = FRAME_TASK_DONE;
+    WelsCondBroadcast (&pThCtx->hProgressCond);
+  }
+  WelsMutexUnlock (&pThCtx->hLock);
+
+  WELS_THREAD_ROUTINE_RETURN (0);
+}
+
+int32_t InitDecThreads (PWelsDecoderContext pCtx, const int32_t kiThreadCount) {
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  PDecThreadCtx pThCtx = NULL;
+  int32_t iThreadNum = WELS_MIN (kiThreadCount, MAX_DEC_THREADS_NUM);
+  int32_t i;
+
+  UninitDecThreads (pCtx);
+  if (iThreadNum <= 1)
+    return ERR_NONE;
+
+  pThCtx = (PDecThreadCtx)pMa->WelsMallocz (sizeof (SDecThreadCtx), "pThreadCtx");
+  WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == pThCtx)
+
+  pThCtx->pCtx = pCtx;
+  pThCtx->iTaskNum = iThreadNum + 2;	// one frame being parsed and one output held by the application
+  WelsMutexInit (&pThCtx->hLock);
+  WelsCondInit (&pThCtx->hTaskCond);
+  WelsCondInit (&pThCtx->hProgressCond);
+  pCtx->pThreadCtx = pThCtx;
+
+  for (i = 0; i < iThreadNum; ++ i) {
+    if (WELS_THREAD_ERROR_OK != WelsThreadCreate (&pThCtx->hThreads[i], DecThreadProc, pThCtx, 0))
+      break;
+    ++ pThCtx->iThreadNum;
+  }
+  if (pThCtx->iThreadNum == 0) {
+    WelsLog (pCtx, WELS_LOG_WARNING, "InitDecThreads()::no thread created, decoding in the calling thread.\n");
+    UninitDecThreads (pCtx);
+    return ERR_INFO_INVALID_PARAM;
+  }
+
+  WelsLog (pCtx, WELS_LOG_INFO, "InitDecThreads()::%d reconstruction threads.\n", pThCtx->iThreadNum);
+  return ERR_NONE;
+}
+
+void UninitDecThreads (PWelsDecoderContext pCtx) {
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+  int32_t i;
+
+  if (NULL == pThCtx)
+    return;
+
+  DrainFrameTasks (pCtx);
+
+  WelsMutexLock (&pThCtx->hLock);
+  pThCtx->bExit = true;
+  WelsCondBroadcast (&pThCtx->hTaskCond);
+  WelsMutexUnlock (&pThCtx->hLock);
+  for (i = 0; i < pThCtx->iThreadNum; ++ i)
+    WelsThreadJoin (pThCtx->hThreads[i]);
+
+  for (i = 0; i < pThCtx->iTaskNum; ++ i) {
+    PDecFrameTask pTask = &pThCtx->sTasks[i];
+    if (pTask->eState != FRAME_TASK_IDLE)
+      ReleaseFrameTask (pTask);
+    pMa->WelsFree (pTask->pSliceTask, "pTask->pSliceTask");
+    pMa->WelsFree (pTask->pMbBuffer, "pTask->pMbBuffer");
+  }
+  for (i = 0; i < pThCtx->iRetiredNum; ++ i)
+    DestroyPicBuff (&pThCtx->pRetiredPicBuff[i], pMa);
+
+  WelsCondDestroy (&pThCtx->hProgressCond);
+  WelsCondDestroy (&pThCtx->hTaskCond);
+  WelsMutexDestroy (&pThCtx->hLock);
+
+  pMa->WelsFree (pThCtx, "pThreadCtx");
+  pCtx->pThreadCtx = NULL;
+}
+
+int32_t PrepareFrameTask (PWelsDecoderContext pCtx, uint8_t*** pppDst, SBufferInfo** ppDstInfo) {
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+  PDecFrameTask pTask;
+  int32_t iRet;
+
+  if (NULL != pThCtx->pCurTask)
+    CompleteFrameTask (pCtx);
+
+  WelsMutexLock (&pThCtx->hLock);
+  RecycleFrameTasks (pThCtx);
+  if (pThCtx->uiTaskNext - pThCtx->uiTaskFirst == (uint32_t)pThCtx->iTaskNum) {
+    // more than one access unit per call without output fetched in between, give up the oldest frame
+    pTask = TaskAt (pThCtx, pThCtx->uiTaskFirst);
+    while (pTask->eState == FRAME_TASK_QUEUED)
+      WelsCondWait (&pThCtx->hProgressCond, &pThCtx->hLock);
+    WelsLog (pCtx, WELS_LOG_WARNING, "PrepareFrameTask()::output of frame %d dropped as it was never fetched.\n",
+             pTask->uiSeq);
+    ReleaseFrameTask (pTask);
+    ++ pThCtx->uiTaskFirst;
+  }
+  pTask = TaskAt (pThCtx, pThCtx->uiTaskNext);
+  pTask->eState = FRAME_TASK_PARSING;
+  pTask->uiSeq = pThCtx->uiTaskNext;
+  ++ pThCtx->uiTaskNext;
+  WelsMutexUnlock (&pThCtx->hLock);
+
+  pTask->bRef = false;
+  pTask->bSync = false;
+  pTask->pDst[0] = pTask->pDst[1] = pTask->pDst[2] = NULL;
+  memset (&pTask->sDstInfo, 0, sizeof (SBufferInfo));
+  pThCtx->pCurTask = pTask;
+
+  iRet = RequestFrameTaskMbBuffer (pTask, pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight, pCtx->pMemAlign);
+  if (ERR_NONE != iRet) {
+    WelsLog (pCtx, WELS_LOG_ERROR, "PrepareFrameTask()::MB buffer allocation failed.\n");
+    return iRet;
+  }
+  BindFrameTaskMbBuffer (pCtx->pCurDqLayer, pTask);
+
+  // a picture kept by the last access unit may still be in flight or waiting for output
+  if (NULL != pCtx->pDec && pCtx->pDec->uiRefCount > 0)
+    pCtx->pDec = NULL;
+
+  *pppDst = pTask->pDst;
+  *ppDstInfo = &pTask->sDstInfo;
+  return ERR_NONE;
+}
+
+/* point the layer snapshot to the copies kept in the slice task itself */
+static void BindSliceTask (PDecSliceTask pSliceTask) {
+  PSliceHeader pSh = &pSliceTask->sLayer.sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader;
+
+  pSliceTask->sLayer.sLayerInfo.pSps	= pSh->pSps = &pSliceTask->sSps;
+  pSliceTask->sLayer.sLayerInfo.pPps	= pSh->pPps = &pSliceTask->sPps;
+  pSliceTask->sLayer.pRefPicList		= pSliceTask->pRefList;
+  pSliceTask->sLayer.pRefReadyLines	= pSliceTask->iRefReadyLines;
+}
+
+int32_t AddSliceTask (PWelsDecoderContext pCtx, PDqLayer pCurLayer) {
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+  PDecFrameTask pTask = pThCtx->pCurTask;
+  PDecSliceTask pSliceTask;
+  int32_t i, j;
+
+  if (pTask->iSliceTaskNum == pTask->iSliceTaskCapacity) {
+    const int32_t kiCapacity = WELS_MAX (SLICE_TASK_NUM_INIT, pTask->iSliceTaskCapacity << 1);
+    PDecSliceTask pNew = (PDecSliceTask)pMa->WelsMallocz (kiCapacity * sizeof (SDecSliceTask), "pTask->pSliceTask");
+    WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == pNew)
+    if (pTask->iSliceTaskNum > 0)
+      memcpy (pNew, pTask->pSliceTask, pTask->iSliceTaskNum * sizeof (SDecSliceTask));
+    for (i = 0; i < pTask->iSliceTaskNum; ++ i)
+      BindSliceTask (&pNew[i]);
+    pMa->WelsFree (pTask->pSliceTask, "pTask->pSliceTask");
+    pTask->pSliceTask = pNew;
+    pTask->iSliceTaskCapacity = kiCapacity;
+  }
+  pSliceTask = &pTask->pSliceTask[pTask->iSliceTaskNum];
+
+  memcpy (&pSliceTask->sLayer, pCurLayer, sizeof (SDqLayer));
+  memcpy (&pSliceTask->sSps, pCurLayer->sLayerInfo.pSps, sizeof (SSps));
+  memcpy (&pSliceTask->sPps, pCurLayer->sLayerInfo.pPps, sizeof (SPps));
+  memcpy (pSliceTask->pRefList, pCurLayer->pRefPicList, MAX_REF_PIC_COUNT * sizeof (PPicture));
+
+  BindSliceTask (pSliceTask);
+
+  if (pSliceTask->sPps.uiNumSliceGroups > 1)
+    pTask->bSync = true;	// FMO maps are shared in pCtx->sFmoList and updated by later slices
+
+  WelsMutexLock (&pThCtx->hLock);
+  for (i = 0; i < MAX_REF_PIC_COUNT; ++ i) {
+    PPicture pRef = pSliceTask->pRefList[i];
+
+    pSliceTask->iRefReadyLines[i] = 0;
+    if (NULL == pRef)
+      continue;
+    pSliceTask->iRefReadyLines[i] = pRef->iReadyLines;
+
+    for (j = 0; j < pTask->iRefPicNum; ++ j) {
+      if (pTask->pRefPic[j] == pRef)
+        break;
+    }
+    if (j < pTask->iRefPicNum)
+      continue;
+    if (pTask->iRefPicNum < MAX_REF_PIC_COUNT) {
+      ++ pRef->uiRefCount;
+      pTask->pRefPic[pTask->iRefPicNum++] = pRef;
+    } else {
+      pTask->bSync = true;	// can not keep the picture alive, reconstruct before it may be recycled
+    }
+  }
+  WelsMutexUnlock (&pThCtx->hLock);
+
+  ++ pTask->iSliceTaskNum;
+  return ERR_NONE;
+}
+
+/* reconstruct the current task in the calling thread once everything queued before it is done */
+static void ReconstructCurrentTaskSync (PWelsDecoderContext pCtx, PDecFrameTask pTask) {
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+
+  DrainFrameTasks (pCtx);
+  if (NULL != pTask->pDec)
+    ReconstructFrameTask (pThCtx, pTask, false);
+
+  WelsMutexLock (&pThCtx->hLock);
+  pTask->eState = FRAME_TASK_DONE;
+  WelsMutexUnlock (&pThCtx->hLock);
+}
+
+bool SubmitFrameTask (PWelsDecoderContext pCtx, const bool kbRef) {
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+  PDecFrameTask pTask = pThCtx->pCurTask;
+
+  pThCtx->pCurTask = NULL;
+  pTask->pDec = pCtx->pDec;
+  ++ pTask->pDec->uiRefCount;
+  pTask->bRef = kbRef;
+
+  // error concealment right after this access unit works on the whole picture in the calling thread
+  if (pTask->bSync || NeedErrorCon (pCtx)) {
+    ReconstructCurrentTaskSync (pCtx, pTask);
+    return false;
+  }
+
+  WelsMutexLock (&pThCtx->hLock);
+  pTask->pDec->iReadyLines = 0;
+  pTask->eState = FRAME_TASK_QUEUED;
+  pThCtx->pQueue[pThCtx->uiQueueTail % pThCtx->iTaskNum] = pTask;
+  ++ pThCtx->uiQueueTail;
+  WelsCondSignal (&pThCtx->hTaskCond);
+  WelsMutexUnlock (&pThCtx->hLock);
+
+  return true;
+}
+
+void CompleteFrameTask (PWelsDecoderContext pCtx) {
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+  PDecFrameTask pTask = pThCtx->pCurTask;
+
+  if (NULL == pTask)
+    return;
+
+  pThCtx->pCurTask = NULL;
+  if (NULL != pCtx->pDec && (pTask->iSliceTaskNum > 0 || 1 == pTask->sDstInfo.iBufferStatus)) {
+    pTask->pDec = pCtx->pDec;
+    ++ pTask->pDec->uiRefCount;
+  } else {
+    pTask->sDstInfo.iBufferStatus = 0;
+  }
+  ReconstructCurrentTaskSync (pCtx, pTask);
+}
+
+void DrainFrameTasks (PWelsDecoderContext pCtx) {
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+
+  WelsMutexLock (&pThCtx->hLock);
+  while (HasQueuedFrameTask (pThCtx))
+    WelsCondWait (&pThCtx->hProgressCond, &pThCtx->hLock);
+  WelsMutexUnlock (&pThCtx->hLock);
+}
+
+void FetchFrameTaskOutput (PWelsDecoderContext pCtx, uint8_t** ppDst, SBufferInfo* pDstInfo) {
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+
+  WelsMutexLock (&pThCtx->hLock);
+  RecycleFrameTasks (pThCtx);
+  while (pThCtx->uiTaskFirst != pThCtx->uiTaskNext) {
+    PDecFrameTask pTask = TaskAt (pThCtx, pThCtx->uiTaskFirst);
+
+    if (pTask->eState == FRAME_TASK_PARSING)
+      break;
+    if (pTask->eState == FRAME_TASK_QUEUED) {
+      // keep decoding ahead unless flushing or every task slot is taken
+      if (!pCtx->bEndOfStreamFlag && pThCtx->uiTaskNext - pThCtx->uiTaskFirst < (uint32_t)pThCtx->iTaskNum)
+        break;
+      WelsCondWait (&pThCtx->hProgressCond, &pThCtx->hLock);
+      continue;
+    }
+    if (1 == pTask->sDstInfo.iBufferStatus) {
+      ppDst[0] = pTask->pDst[0];
+      ppDst[1] = pTask->pDst[1];
+      ppDst[2] = pTask->pDst[2];
+      memcpy (pDstInfo, &pTask->sDstInfo, sizeof (SBufferInfo));
+      pTask->eState = FRAME_TASK_DELIVERED;
+      break;
+    }
+    ReleaseFrameTask (pTask);
+    ++ pThCtx->uiTaskFirst;
+  }
+  WelsMutexUnlock (&pThCtx->hLock);
+}
+
+int32_t WaitRefPicLines (PWelsDecoderContext pCtx, PPicture pRefPic, const int32_t kiLines) {
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+  const int32_t kiNeededLines = WELS_MIN (kiLines, pRefPic->iHeightInPixel);
+  int32_t iReadyLines;
+
+  WelsMutexLock (&pThCtx->hLock);
+  while (pRefPic->iReadyLines < kiNeededLines)
+    WelsCondWait (&pThCtx->hProgressCond, &pThCtx->hLock);
+  iReadyLines = pRefPic->iReadyLines;
+  WelsMutexUnlock (&pThCtx->hLock);
+
+  return iReadyLines;
+}
+
+void PublishPicLines (PWelsDecoderContext pCtx, PPicture pPic, const int32_t kiLines) {
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+
+  WelsMutexLock (&pThCtx->hLock);
+  if (kiLines > pPic->iReadyLines) {
+    pPic->iReadyLines = kiLines;
+    WelsCondBroadcast (&pThCtx->hProgressCond);
+  }
+  WelsMutexUnlock (&pThCtx->hLock);
+}
+
+bool RetirePicBuff (PWelsDecoderContext pCtx, PPicBuff pPicBuff) {
+  PDecThreadCtx pThCtx = pCtx->pThreadCtx;
+
+  if (NULL == pThCtx || pThCtx->uiTaskFirst == pThCtx->uiTaskNext
+      || pThCtx->iRetiredNum >= MAX_DEC_THREADS_NUM + 2)
+    return false;
+
+  DrainFrameTasks (pCtx);
+  pThCtx->pRetiredPicBuff[pThCtx->iRetiredNum] = pPicBuff;
+  pThCtx->uiRetiredUntil[pThCtx->iRetiredNum] = pThCtx->uiTaskNext;
+  ++ pThCtx->iRetiredNum;
+  return true;
+}
+
+static inline int32_t SliceRowEnd (PDecRowThreadCtx pRowCtx, const int32_t kiRow) {
+  return (kiRow == pRowCtx->iLastRow) ? pRowCtx->iLastMbX + 1 : pRowCtx->pLayer->iMbWidth;
+}
+
+/*
+ * reconstruct one MB row of the slice; intra prediction reads the top right neighbour, so the row above has to be
+ * 2 MBs ahead unless it is done
+ */
+static int32_t ReconstructSliceRow (PDecRowThreadCtx pRowCtx, PDecRowWorker pWorker, const int32_t kiRow) {
+  PDqLayer pLayer = &pWorker->sLayer;
+  const int32_t kiMbWidth = pLayer->iMbWidth;
+  const int32_t kiStartX = (kiRow == pRowCtx->iFirstRow) ? pRowCtx->iFirstMbX : 0;
+  const int32_t kiEndX = SliceRowEnd (pRowCtx, kiRow);
+  int32_t iAboveDone = (kiRow == pRowCtx->iFirstRow) ? kiMbWidth : 0;
+  int32_t iMbX;
+
+  for (iMbX = kiStartX; iMbX < kiEndX; ++ iMbX) {
+    const int32_t kiNeeded = WELS_MIN (iMbX + 2, kiMbWidth);
+
+    if (iAboveDone < kiNeeded) {
+      bool bError;
+      WelsMutexLock (&pRowCtx->hLock);
+      while (pRowCtx->pRowProgress[kiRow - 1] < kiNeeded && !pRowCtx->bError) {
+        ++ pRowCtx->iWaiting;
+        WelsCondWait (&pRowCtx->hRowCond, &pRowCtx->hLock);
+        -- pRowCtx->iWaiting;
+      }
+      iAboveDone = pRowCtx->pRowProgress[kiRow - 1];
+      bError = pRowCtx->bError;
+      WelsMutexUnlock (&pRowCtx->hLock);
+      if (bError)
+        return -1;
+    }
+
+    pLayer->iMbX		= iMbX;
+    pLayer->iMbY		= kiRow;
+    pLayer->iMbXyIndex	= kiRow * kiMbWidth + iMbX;
+    if (WelsTargetMbConstruction (pRowCtx->pCtx, pLayer)) {
+      WelsLog (pRowCtx->pCtx, WELS_LOG_WARNING, "ReconstructSliceRow():::MB(%d, %d) construction error.\n",
+               iMbX, kiRow);
+      WelsMutexLock (&pRowCtx->hLock);
+      pRowCtx->bError = true;
+      WelsCondBroadcast (&pRowCtx->hRowCond);
+      WelsMutexUnlock (&pRowCtx->hLock);
+      return -1;
+    }
+
+    WelsMutexLock (&pRowCtx->hLock);
+    pRowCtx->pRowProgress[kiRow] = iMbX + 1;
+    if (pRowCtx->iWaiting > 0)
+      WelsCondBroadcast (&pRowCtx->hRowCond);
+    WelsMutexUnlock (&pRowCtx->hLock);
+  }
+
+  return 0;
+}
+
+/*
+ * pipelined deblocking: filter the rows whose row below is reconstructed, in order and by one thread at a time;
+ * called with hLock held
+ */
+static void DeblockSliceRows (PDecRowThreadCtx pRowCtx, PDecRowWorker pWorker) {
+  if (pRowCtx->bDeblocking)
+    return;	// the thread filtering now checks the progress again before leaving
+
+  pRowCtx->bDeblocking = true;
+  while (!pRowCtx->bError && pRowCtx->iDeblockRow < pRowCtx->iLastRow) {
+    const int32_t kiRow = pRowCtx->iDeblockRow;
+
+    // a partial last row below does not imply the row itself is complete
+    if (pRowCtx->pRowProgress[kiRow] < SliceRowEnd (pRowCtx, kiRow)
+        || pRowCtx->pRowProgress[kiRow + 1] < SliceRowEnd (pRowCtx, kiRow + 1))
+      break;
+
+    WelsMutexUnlock (&pRowCtx->hLock);
+    WelsFinishSliceRow (pRowCtx->pCtx, &pWorker->sLayer, kiRow);
+    WelsMutexLock (&pRowCtx->hLock);
+    ++ pRowCtx->iDeblockRow;
+  }
+  pRowCtx->bDeblocking = false;
+}
+
+/* take rows of the current slice until none is left, called with hLock held */
+static void ReconstructSliceRows (PDecRowThreadCtx pRowCtx, PDecRowWorker pWorker) {
+  PDqLayer pLayer = &pWorker->sLayer;
+
+  memcpy (pLayer, pRowCtx->pLayer, sizeof (SDqLayer));
+  if (NULL != pLayer->pRefReadyLines) {
+    memcpy (pWorker->iRefReadyLines, pLayer->pRefReadyLines, MAX_REF_PIC_COUNT * sizeof (int32_t));
+    pLayer->pRefReadyLines = pWorker->iRefReadyLines;
+  }
+
+  while (!pRowCtx->bError && pRowCtx->iNextRow <= pRowCtx->iLastRow) {
+    const int32_t kiRow = pRowCtx->iNextRow ++;
+
+    WelsMutexUnlock (&pRowCtx->hLock);
+    ReconstructSliceRow (pRowCtx, pWorker, kiRow);
+    WelsMutexLock (&pRowCtx->hLock);
+    if (pRowCtx->bPipeline)
+      DeblockSliceRows (pRowCtx, pWorker);
+  }
+}
+
+static WELS_THREAD_ROUTINE_TYPE DecRowThreadProc (void* pArg) {
+  PDecRowThreadCtx pRowCtx = (PDecRowThreadCtx)pArg;
+  uint32_t uiJobSeq = 0;
+
+  WelsMutexLock (&pRowCtx->hLock);
+  while (true) {
+    while (!pRowCtx->bExit && ! (pRowCtx->bBusy && uiJobSeq != pRowCtx->uiJobSeq
+                                  && pRowCtx->iNextRow <= pRowCtx->iLastRow && !pRowCtx->bError))
+      WelsCondWait (&pRowCtx->hJobCond, &pRowCtx->hLock);
+    if (pRowCtx->bExit)
+      break;
+
+    uiJobSeq = pRowCtx->uiJobSeq;
+    ++ pRowCtx->iActive;
+    ReconstructSliceRows (pRowCtx, &pRowCtx->sWorker[1 + pRowCtx->iJoined++]);
+    -- pRowCtx->iActive;
+    WelsCondBroadcast (&pRowCtx->hRowCond);
+  }
+  WelsMutexUnlock (&pRowCtx->hLock);
+
+  WELS_THREAD_ROUTINE_RETURN (0);
+}
+
+int32_t InitDecRowThreads (PWelsDecoderContext pCtx, const int32_t kiRowThreadCount) {
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  PDecRowThreadCtx pRowCtx = NULL;
+  int32_t iHelperNum = WELS_MIN (kiRowThreadCount, MAX_DEC_THREADS_NUM + 1) - 1;
+  int32_t i;
+
+  UninitDecRowThreads (pCtx);
+  if (iHelperNum <= 0)
+    return ERR_NONE;
+
+  pRowCtx = (PDecRowThreadCtx)pMa->WelsMallocz (sizeof (SDecRowThreadCtx), "pRowThreadCtx");
+  WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == pRowCtx)
+
+  pRowCtx->pCtx = pCtx;
+  WelsMutexInit (&pRowCtx->hLock);
+  WelsCondInit (&pRowCtx->hJobCond);
+  WelsCondInit (&pRowCtx->hRowCond);
+  pCtx->pRowThreadCtx = pRowCtx;
+
+  for (i = 0; i < iHelperNum; ++ i) {
+    if (WELS_THREAD_ERROR_OK != WelsThreadCreate (&pRowCtx->hThreads[i], DecRowThreadProc, pRowCtx, 0))
+      break;
+    ++ pRowCtx->iThreadNum;
+  }
+  if (pRowCtx->iThreadNum == 0) {
+    WelsLog (pCtx, WELS_LOG_WARNING, "InitDecRowThreads()::no thread created, reconstructing in raster order.\n");
+    UninitDecRowThreads (pCtx);
+    return ERR_INFO_INVALID_PARAM;
+  }
+
+  WelsLog (pCtx, WELS_LOG_INFO, "InitDecRowThreads()::%d wavefront helper threads.\n", pRowCtx->iThreadNum);
+  return ERR_NONE;
+}
+
+void UninitDecRowThreads (PWelsDecoderContext pCtx) {
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  PDecRowThreadCtx pRowCtx = pCtx->pRowThreadCtx;
+  int32_t i;
+
+  if (NULL == pRowCtx)
+    return;
+
+  WelsMutexLock (&pRowCtx->hLock);
+  pRowCtx->bExit = true;
+  WelsCondBroadcast (&pRowCtx->hJobCond);
+  WelsMutexUnlock (&pRowCtx->hLock);
+  for (i = 0; i < pRowCtx->iThreadNum; ++ i)
+    WelsThreadJoin (pRowCtx->hThreads[i]);
+
+  pMa->WelsFree (pRowCtx->pRowProgress, "pRowCtx->pRowProgress");
+
+  WelsCondDestroy (&pRowCtx->hRowCond);
+  WelsCondDestroy (&pRowCtx->hJobCond);
+  WelsMutexDestroy (&pRowCtx->hLock);
+
+  pMa->WelsFree (pRowCtx, "pRowThreadCtx");
+  pCtx->pRowThreadCtx = NULL;
+}
+
+bool ReconstructSliceWavefront (PWelsDecoderContext pCtx, PDqLayer pCurLayer, const bool kbPipeline, int32_t* pRet) {
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  PDecRowThreadCtx pRowCtx = pCtx->pRowThreadCtx;
+  PSlice pSlice = &pCurLayer->sLayerInfo.sSliceInLayer;
+  PSliceHeader pSliceHeader = &pSlice->sSliceHeaderExt.sSliceHeader;
+  const int32_t kiMbWidth = pCurLayer->iMbWidth;
+  const int32_t kiFirstMb = pSliceHeader->iFirstMbInSlice;
+  const int32_t kiLastMb = kiFirstMb + pSlice->iTotalMbInCurSlice - 1;
+
+  // FMO slices are not in raster order, a slice within one row gains nothing
+  if (pSliceHeader->pPps->uiNumSliceGroups > 1 || kiLastMb >= (int32_t)pSliceHeader->pSps->uiTotalMbCount
+      || kiLastMb / kiMbWidth == kiFirstMb / kiMbWidth)
+    return false;
+
+  WelsMutexLock (&pRowCtx->hLock);
+  if (pRowCtx->bBusy) {
+    WelsMutexUnlock (&pRowCtx->hLock);	// taken by another frame thread
+    return false;
+  }
+  if (pRowCtx->iRowProgressSize < pCurLayer->iMbHeight) {
+    pMa->WelsFree (pRowCtx->pRowProgress, "pRowCtx->pRowProgress");
+    pRowCtx->iRowProgressSize = 0;
+    pRowCtx->pRowProgress = (int32_t*)pMa->WelsMallocz (pCurLayer->iMbHeight * sizeof (int32_t), "pRowCtx->pRowProgress");
+    if (NULL == pRowCtx->pRowProgress) {
+      WelsMutexUnlock (&pRowCtx->hLock);
+      return false;
+    }
+    pRowCtx->iRowProgressSize = pCurLayer->iMbHeight;
+  }
+
+  pRowCtx->bBusy		= true;
+  pRowCtx->bError		= false;
+  pRowCtx->pLayer		= pCurLayer;
+  pRowCtx->iFirstMbX	= kiFirstMb % kiMbWidth;
+  pRowCtx->iFirstRow	= kiFirstMb / kiMbWidth;
+  pRowCtx->iLastMbX		= kiLastMb % kiMbWidth;
+  pRowCtx->iLastRow		= kiLastMb / kiMbWidth;
+  pRowCtx->iNextRow		= pRowCtx->iFirstRow;
+  pRowCtx->iDeblockRow	= pRowCtx->iFirstRow;
+  pRowCtx->bPipeline	= kbPipeline;
+  pRowCtx->iJoined		= 0;
+  memset (pRowCtx->pRowProgress + pRowCtx->iFirstRow, 0,
+          (pRowCtx->iLastRow - pRowCtx->iFirstRow + 1) * sizeof (int32_t));
+  pRowCtx->pRowProgress[pRowCtx->iFirstRow] = pRowCtx->iFirstMbX;
+  ++ pRowCtx->uiJobSeq;
+  WelsCondBroadcast (&pRowCtx->hJobCond);
+
+  ReconstructSliceRows (pRowCtx, &pRowCtx->sWorker[0]);
+  while (pRowCtx->iActive > 0)
+    WelsCondWait (&pRowCtx->hRowCond, &pRowCtx->hLock);
+
+  *pRet = pRowCtx->bError ? -1 : 0;
+  if (pRowCtx->bPipeline && !pRowCtx->bError) {
+    // the last row has no row below, nobody else touches the slice any more
+    WelsMutexUnlock (&pRowCtx->hLock);
+    while (pRowCtx->iDeblockRow <= pRowCtx->iLastRow)
+      WelsFinishSliceRow (pCtx, &pRowCtx->sWorker[0].sLayer, pRowCtx->iDeblockRow++);
+    WelsMutexLock (&pRowCtx->hLock);
+  }
+  pRowCtx->pLayer	= NULL;
+  pRowCtx->bBusy	= false;
+  WelsMutexUnlock (&pRowCtx->hLock);
+
+  return true;
+}
+
+/* parse and reconstruct one slice, filtering it unless its edges to the neighbouring slices are filtered */
+static void DecodeSliceJob (PWelsDecoderContext pCtx, PDecSliceJob pJob) {
+  PDqLayer pLayer = &pJob->sLayer;
+  PSliceHeader pSliceHeader = &pLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader;
+
+  pJob->iRet = WelsDecodeSlice (pCtx, pLayer, false, pJob->pNal);
+  if (ERR_NONE != pJob->iRet) {
+    WelsLog (pCtx, WELS_LOG_WARNING, "DecodeSliceJob() failed (%d) in frame: %d first MB: %d\n",
+             pJob->iRet, pSliceHeader->iFrameNum, pSliceHeader->iFirstMbInSlice);
+    return;
+  }
+  if (WelsTargetSliceConstruction (pCtx, pLayer, &pJob->iTotalNumMbRec, true))
+    pJob->iRet = -1;
+}
+
+static inline int32_t SliceFirstMb (PDecSliceJob pJob) {
+  return pJob->sLayer.sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.iFirstMbInSlice;
+}
+
+/* a slice is taken once the one after it is queued, which limits its MBs, or once it is known to be the last */
+static inline int32_t ReadySliceJobNum (PDecSliceThreadCtx pSliceCtx) {
+  return pSliceCtx->bLastJob ? pSliceCtx->iJobNum : pSliceCtx->iJobNum - 1;
+}
+
+/* take slices of the picture until none is left, called with hLock held */
+static void DecodeSliceJobs (PDecSliceThreadCtx pSliceCtx) {
+  while (pSliceCtx->iNextJob < ReadySliceJobNum (pSliceCtx)) {
+    PDecSliceJob pJob = &pSliceCtx->pJobs[pSliceCtx->iNextJob++];
+
+    pJob->sLayer.iSliceMbLimit = 0;
+    if (pSliceCtx->iNextJob < pSliceCtx->iJobNum)
+      pJob->sLayer.iSliceMbLimit = SliceFirstMb (&pSliceCtx->pJobs[pSliceCtx->iNextJob]);
+    WelsMutexUnlock (&pSliceCtx->hLock);
+    DecodeSliceJob (pSliceCtx->pCtx, pJob);
+    WelsMutexLock (&pSliceCtx->hLock);
+    ++ pSliceCtx->iDoneJobs;
+    WelsCondBroadcast (&pSliceCtx->hDoneCond);
+  }
+}
+
+static inline int32_t SliceFilterIdc (PDqLayer pLayer) {
+  return pLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.uiDisableDeblockingFilterIdc;
+}
+
+static void PublishDeblockProgress (PDecSliceThreadCtx pSliceCtx, const int32_t kiRow, const int32_t kiDone) {
+  WelsMutexLock (&pSliceCtx->hLock);
+  pSliceCtx->pRowProgress[kiRow] = kiDone;
+  if (pSliceCtx->iWaiting > 0)
+    WelsCondBroadcast (&pSliceCtx->hDoneCond);
+  WelsMutexUnlock (&pSliceCtx->hLock);
+}
+
+/*
+ * filter the MBs of row kiRow in slices filtered across their edges; filtering an MB modifies the bottom lines of
+ * the MB above, which the MB above right modifies as well, so the row above has to be 2 MBs ahead unless it is done
+ */
+static void DeblockPictureRow (PDecSliceThreadCtx pSliceCtx, const int32_t kiRow) {
+  const int32_t kiMbWidth = pSliceCtx->iMbWidth;
+  const int32_t kiRowStart = kiRow * kiMbWidth;
+  const int32_t kiRowEnd = kiRowStart + kiMbWidth;
+  int32_t iAboveDone = (0 == kiRow) ? kiMbWidth : 0;
+  SDqLayer sLayer;	// filtering keeps the current MB position in the layer
+  int32_t i;
+
+  for (i = 0; i < pSliceCtx->iSortedJobNum; ++ i) {
+    PDqLayer pJobLayer = &pSliceCtx->ppSortedJobs[i]->sLayer;
+    PSlice pSlice = &pJobLayer->sLayerInfo.sSliceInLayer;
+    const int32_t kiFirstMb = pSlice->sSliceHeaderExt.sSliceHeader.iFirstMbInSlice;
+    const int32_t kiEndMb = WELS_MIN (kiFirstMb + pSlice->iTotalMbInCurSlice, kiRowEnd);
+    int32_t iMb = WELS_MAX (kiFirstMb, kiRowStart);
+
+    if (kiFirstMb >= kiRowEnd)
+      break;
+    if (iMb >= kiEndMb || 0 != SliceFilterIdc (pJobLayer)
+        || (pSlice->eSliceType != I_SLICE && pSlice->eSliceType != P_SLICE))
+      continue;
+
+    memcpy (&sLayer, pJobLayer, sizeof (SDqLayer));
+    while (iMb < kiEndMb) {
+      const int32_t kiNeeded = WELS_MIN (iMb - kiRowStart + 2, kiMbWidth);
+      int32_t iEndMb;
+
+      if (iAboveDone < kiNeeded) {
+        // MBs skipped so far need no filtering, the row below must not wait for them
+        PublishDeblockProgress (pSliceCtx, kiRow, iMb - kiRowStart);
+        WelsMutexLock (&pSliceCtx->hLock);
+        while (pSliceCtx->pRowProgress[kiRow - 1] < kiNeeded) {
+          ++ pSliceCtx->iWaiting;
+          WelsCondWait (&pSliceCtx->hDoneCond, &pSliceCtx->hLock);
+          -- pSliceCtx->iWaiting;
+        }
+        iAboveDone = pSliceCtx->pRowProgress[kiRow - 1];
+        WelsMutexUnlock (&pSliceCtx->hLock);
+      }
+
+      iEndMb = (iAboveDone >= kiMbWidth) ? kiEndMb : WELS_MIN (kiEndMb, kiRowStart + iAboveDone - 1);
+      WelsDeblockingFilterSliceMbs (pSliceCtx->pCtx, &sLayer, WelsDeblockingMb, iMb, iEndMb);
+      iMb = iEndMb;
+      PublishDeblockProgress (pSliceCtx, kiRow, iMb - kiRowStart);
+    }
+  }
+
+  PublishDeblockProgress (pSliceCtx, kiRow, kiMbWidth);
+}
+
+/* take rows of the picture to be filtered until none is left, called with hLock held */
+static void DeblockPictureRows (PDecSliceThreadCtx pSliceCtx) {
+  while (pSliceCtx->iNextRow < pSliceCtx->iMbHeight) {
+    const int32_t kiRow = pSliceCtx->iNextRow ++;
+
+    WelsMutexUnlock (&pSliceCtx->hLock);
+    DeblockPictureRow (pSliceCtx, kiRow);
+    WelsMutexLock (&pSliceCtx->hLock);
+  }
+}
+
+static WELS_THREAD_ROUTINE_TYPE DecSliceThreadProc (void* pArg) {
+  PDecSliceThreadCtx pSliceCtx = (PDecSliceThreadCtx)pArg;
+  uint32_t uiDeblockSeq = 0;
+
+  WelsMutexLock (&pSliceCtx->hLock);
+  while (true) {
+    while (!pSliceCtx->bExit && pSliceCtx->iNextJob >= ReadySliceJobNum (pSliceCtx)
+           && ! (pSliceCtx->bDeblocking && uiDeblockSeq != pSliceCtx->uiDeblockSeq
+                 && pSliceCtx->iNextRow < pSliceCtx->iMbHeight))
+      WelsCondWait (&pSliceCtx->hJobCond, &pSliceCtx->hLock);
+    if (pSliceCtx->bExit)
+      break;
+
+    ++ pSliceCtx->iActive;
+    if (pSliceCtx->iNextJob < ReadySliceJobNum (pSliceCtx)) {
+      DecodeSliceJobs (pSliceCtx);
+    } else {
+      uiDeblockSeq = pSliceCtx->uiDeblockSeq;
+      DeblockPictureRows (pSliceCtx);
+    }
+    -- pSliceCtx->iActive;
+    WelsCondBroadcast (&pSliceCtx->hDoneCond);
+  }
+  WelsMutexUnlock (&pSliceCtx->hLock);
+
+  WELS_THREAD_ROUTINE_RETURN (0);
+}
+
+int32_t InitDecSliceThreads (PWelsDecoderContext pCtx, const int32_t kiSliceThreadCount) {
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  PDecSliceThreadCtx pSliceCtx = NULL;
+  int32_t iHelperNum = WELS_MIN (kiSliceThreadCount, MAX_DEC_THREADS_NUM + 1) - 1;
+  int32_t i;
+
+  UninitDecSliceThreads (pCtx);
+  if (iHelperNum <= 0)
+    return ERR_NONE;
+
+  pSliceCtx = (PDecSliceThreadCtx)pMa->WelsMallocz (sizeof (SDecSliceThreadCtx), "pSliceThreadCtx");
+  WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == pSliceCtx)
+
+  pSliceCtx->pCtx = pCtx;
+  WelsMutexInit (&pSliceCtx->hLock);
+  WelsCondInit (&pSliceCtx->hJobCond);
+  WelsCondInit (&pSliceCtx->hDoneCond);
+  pCtx->pSliceThreadCtx = pSliceCtx;
+
+  for (i = 0; i < iHelperNum; ++ i) {
+    if (WELS_THREAD_ERROR_OK != WelsThreadCreate (&pSliceCtx->hThreads[i], DecSliceThreadProc, pSliceCtx, 0))
+      break;
+    ++ pSliceCtx->iThreadNum;
+  }
+  if (pSliceCtx->iThreadNum == 0) {
+    WelsLog (pCtx, WELS_LOG_WARNING, "InitDecSliceThreads()::no thread created, decoding slices one by one.\n");
+    UninitDecSliceThreads (pCtx);
+    return ERR_INFO_INVALID_PARAM;
+  }
+
+  WelsLog (pCtx, WELS_LOG_INFO, "InitDecSliceThreads()::%d slice helper threads.\n", pSliceCtx->iThreadNum);
+  return ERR_NONE;
+}
+
+void UninitDecSliceThreads (PWelsDecoderContext pCtx) {
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  PDecSliceThreadCtx pSliceCtx = pCtx->pSliceThreadCtx;
+  PNalUnit pErrNal = NULL;
+  int32_t i;
+
+  if (NULL == pSliceCtx)
+    return;
+
+  FinishSliceJobs (pCtx, true, &pErrNal);
+
+  WelsMutexLock (&pSliceCtx->hLock);
+  pSliceCtx->bExit = true;
+  WelsCondBroadcast (&pSliceCtx->hJobCond);
+  WelsMutexUnlock (&pSliceCtx->hLock);
+  for (i = 0; i < pSliceCtx->iThreadNum; ++ i)
+    WelsThreadJoin (pSliceCtx->hThreads[i]);
+
+  pMa->WelsFree (pSliceCtx->pRowProgress, "pSliceCtx->pRowProgress");
+  pMa->WelsFree (pSliceCtx->ppSortedJobs, "pSliceCtx->ppSortedJobs");
+  pMa->WelsFree (pSliceCtx->pJobs, "pSliceCtx->pJobs");
+
+  WelsCondDestroy (&pSliceCtx->hDoneCond);
+  WelsCondDestroy (&pSliceCtx->hJobCond);
+  WelsMutexDestroy (&pSliceCtx->hLock);
+
+  pMa->WelsFree (pSliceCtx, "pSliceThreadCtx");
+  pCtx->pSliceThreadCtx = NULL;
+}
+
+int32_t AddSliceJob (PWelsDecoderContext pCtx, PDqLayer pCurLayer, PNalUnit pNalCur) {
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  PDecSliceThreadCtx pSliceCtx = pCtx->pSliceThreadCtx;
+  PDecSliceJob pJob;
+
+  WelsMutexLock (&pSliceCtx->hLock);
+  if (pSliceCtx->iJobNum == pSliceCtx->iJobCapacity) {
+    const int32_t kiCapacity = WELS_MAX (SLICE_TASK_NUM_INIT, pSliceCtx->iJobCapacity << 1);
+    PDecSliceJob pNew = (PDecSliceJob)pMa->WelsMallocz (kiCapacity * sizeof (SDecSliceJob), "pSliceCtx->pJobs");
+    PDecSliceJob* ppNewSorted = (PDecSliceJob*)pMa->WelsMallocz (kiCapacity * sizeof (PDecSliceJob),
+                                "pSliceCtx->ppSortedJobs");
+    if (NULL == pNew || NULL == ppNewSorted) {
+      pMa->WelsFree (ppNewSorted, "pSliceCtx->ppSortedJobs");
+      pMa->WelsFree (pNew, "pSliceCtx->pJobs");
+      WelsMutexUnlock (&pSliceCtx->hLock);
+      return ERR_INFO_OUT_OF_MEMORY;
+    }
+    // slices being decoded work on their entry of the old array
+    while (pSliceCtx->iDoneJobs < pSliceCtx->iNextJob)
+      WelsCondWait (&pSliceCtx->hDoneCond, &pSliceCtx->hLock);
+    if (pSliceCtx->iJobNum > 0)
+      memcpy (pNew, pSliceCtx->pJobs, pSliceCtx->iJobNum * sizeof (SDecSliceJob));
+    pMa->WelsFree (pSliceCtx->ppSortedJobs, "pSliceCtx->ppSortedJobs");
+    pMa->WelsFree (pSliceCtx->pJobs, "pSliceCtx->pJobs");
+    pSliceCtx->pJobs = pNew;
+    pSliceCtx->ppSortedJobs = ppNewSorted;
+    pSliceCtx->iJobCapacity = kiCapacity;
+  }
+  pJob = &pSliceCtx->pJobs[pSliceCtx->iJobNum];
+
+  memcpy (&pJob->sLayer, pCurLayer, sizeof (SDqLayer));
+  pJob->pNal				= pNalCur;
+  pJob->iTotalNumMbRec	= 0;
+  pJob->iRet				= ERR_NONE;
+
+  ++ pSliceCtx->iJobNum;
+  WelsCondSignal (&pSliceCtx->hJobCond);
+  WelsMutexUnlock (&pSliceCtx->hLock);
+
+  return ERR_NONE;
+}
+
+int32_t GetSliceJobNum (PWelsDecoderContext pCtx) {
+  return (NULL == pCtx->pSliceThreadCtx) ? 0 : pCtx->pSliceThreadCtx->iJobNum;
+}
+
+int32_t GetSliceJobMinFirstMb (PWelsDecoderContext pCtx) {
+  PDecSliceThreadCtx pSliceCtx = pCtx->pSliceThreadCtx;
+
+  if (NULL == pSliceCtx || 0 == pSliceCtx->iJobNum)
+    return 0;
+  return SliceFirstMb (&pSliceCtx->pJobs[pSliceCtx->iJobNum - 1]) + 1;
+}
+
+/* filter the picture across the edges of the slices in ppSortedJobs, called with hLock held */
+static void DeblockPicture (PDecSliceThreadCtx pSliceCtx) {
+  CMemoryAlign* pMa = pSliceCtx->pCtx->pMemAlign;
+  PDqLayer pLayer = &pSliceCtx->ppSortedJobs[0]->sLayer;
+  int32_t i, j;
+
+  // slices mostly come in raster order
+  for (i = 1; i < pSliceCtx->iSortedJobNum; ++ i) {
+    PDecSliceJob pJob = pSliceCtx->ppSortedJobs[i];
+    const int32_t kiFirstMb = pJob->sLayer.sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.iFirstMbInSlice;
+
+    for (j = i; j > 0
+         && pSliceCtx->ppSortedJobs[j - 1]->sLayer.sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.iFirstMbInSlice >
+         kiFirstMb; -- j)
+      pSliceCtx->ppSortedJobs[j] = pSliceCtx->ppSortedJobs[j - 1];
+    pSliceCtx->ppSortedJobs[j] = pJob;
+  }
+
+  if (pSliceCtx->iRowProgressSize < pLayer->iMbHeight) {
+    pMa->WelsFree (pSliceCtx->pRowProgress, "pSliceCtx->pRowProgress");
+    pSliceCtx->iRowProgressSize = 0;
+    pSliceCtx->pRowProgress = (int32_t*)pMa->WelsMallocz (pLayer->iMbHeight * sizeof (int32_t),
+                              "pSliceCtx->pRowProgress");
+    if (NULL == pSliceCtx->pRowProgress) {
+      WelsLog (pSliceCtx->pCtx, WELS_LOG_WARNING, "DeblockPicture()::no memory, slice edges left unfiltered.\n");
+      return;
+    }
+    pSliceCtx->iRowProgressSize = pLayer->iMbHeight;
+  }
+
+  pSliceCtx->iMbWidth		= pLayer->iMbWidth;
+  pSliceCtx->iMbHeight	= pLayer->iMbHeight;
+  pSliceCtx->iNextRow		= 0;
+  memset (pSliceCtx->pRowProgress, 0, pLayer->iMbHeight * sizeof (int32_t));
+  pSliceCtx->bDeblocking	= true;
+  ++ pSliceCtx->uiDeblockSeq;
+  WelsCondBroadcast (&pSliceCtx->hJobCond);
+
+  DeblockPictureRows (pSliceCtx);
+  while (pSliceCtx->iActive > 0)
+    WelsCondWait (&pSliceCtx->hDoneCond, &pSliceCtx->hLock);
+  pSliceCtx->bDeblocking	= false;
+}
+
+int32_t FinishSliceJobs (PWelsDecoderContext pCtx, const bool kbDrop, PNalUnit* ppErrNal) {
+  PDecSliceThreadCtx pSliceCtx = pCtx->pSliceThreadCtx;
+  int32_t iTotalNumMbRec = pCtx->iTotalNumMbRec;
+  int32_t iTotalMbCount;
+  bool bDeblock = false;
+  int32_t iRet = ERR_NONE;
+  int32_t i;
+
+  *ppErrNal = NULL;
+  if (NULL == pSliceCtx || 0 == pSliceCtx->iJobNum)
+    return ERR_NONE;
+  iTotalMbCount = pSliceCtx->pJobs[0].sLayer.sLayerInfo.pSps->uiTotalMbCount;
+
+  WelsMutexLock (&pSliceCtx->hLock);
+  if (kbDrop) {
+    pSliceCtx->iJobNum = pSliceCtx->iNextJob;
+  } else {
+    pSliceCtx->bLastJob = true;
+    DecodeSliceJobs (pSliceCtx);
+  }
+  while (pSliceCtx->iDoneJobs < pSliceCtx->iJobNum)
+    WelsCondWait (&pSliceCtx->hDoneCond, &pSliceCtx->hLock);
+
+  // same checks as after each slice when decoding them one after the other, in decoding order
+  pSliceCtx->iSortedJobNum = 0;
+  for (i = 0; i < pSliceCtx->iJobNum && !kbDrop; ++ i) {
+    PDecSliceJob pJob = &pSliceCtx->pJobs[i];
+
+    if (ERR_NONE == pJob->iRet && iTotalNumMbRec + pJob->iTotalNumMbRec > iTotalMbCount) {
+      WelsLog (pCtx, WELS_LOG_WARNING, "FinishSliceJobs():::iTotalNumMbRec:%d, iTotalMbTargetLayer:%d\n",
+               iTotalNumMbRec + pJob->iTotalNumMbRec, iTotalMbCount);
+      pJob->iRet = -1;
+    }
+    if (ERR_NONE != pJob->iRet) {
+      if (NULL == *ppErrNal) {
+        *ppErrNal = pJob->pNal;
+        iRet = pJob->iRet;
+      }
+      continue;
+    }
+
+    iTotalNumMbRec += pJob->iTotalNumMbRec;
+    pSliceCtx->ppSortedJobs[pSliceCtx->iSortedJobNum++] = pJob;
+    if (0 == SliceFilterIdc (&pJob->sLayer))
+      bDeblock = true;
+  }
+  if (bDeblock)
+    DeblockPicture (pSliceCtx);
+
+  pSliceCtx->iJobNum	= 0;
+  pSliceCtx->iNextJob	= 0;
+  pSliceCtx->iDoneJobs	= 0;
+  pSliceCtx->bLastJob	= false;
+  pSliceCtx->iSortedJobNum	= 0;
+  WelsMutexUnlock (&pSliceCtx->hLock);
+
+  if (!kbDrop)
+    pCtx->iTotalNumMbRec = iTotalNumMbRec;
+  return iRet;
+}
+
+} // namespace WelsDec
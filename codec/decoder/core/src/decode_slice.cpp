@@ -42,6 +42,9 @@
 #include "deblocking.h"
 
 #include "decode_slice.h"
+#include "dec_multi_threading.h"
+#include "expand_pic.h"
+#include "output_format.h"
 
 #include "parse_mb_syn_cavlc.h"
 #include "rec_mb.h"
@@ -51,74 +54,120 @@
 
 namespace WelsDec {
 
-int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx) {
-  PDqLayer pCurLayer = pCtx->pCurDqLayer;
+/*
+ * deblock MB row kiMbY of the slice, the row below being reconstructed already, and pad and convert to the output
+ * format the lines of the picture no later deblocking modifies any more
+ */
+void WelsFinishSliceRow (PWelsDecoderContext pCtx, PDqLayer pCurLayer, const int32_t kiMbY) {
   PSlice pCurSlice = &pCurLayer->sLayerInfo.sSliceInLayer;
   PSliceHeader pSliceHeader = &pCurSlice->sSliceHeaderExt.sSliceHeader;
+  PPicture pDec = pCurLayer->pDec;
+  const int32_t kiMbWidth = pCurLayer->iMbWidth;
+  const int32_t kiStartMb = WELS_MAX (pSliceHeader->iFirstMbInSlice, kiMbY * kiMbWidth);
+  const int32_t kiEndMb = WELS_MIN (pSliceHeader->iFirstMbInSlice + pCurSlice->iTotalMbInCurSlice,
+                                    (kiMbY + 1) * kiMbWidth);
+  int32_t iFinalLines;
+
+  if ((pCurSlice->eSliceType == I_SLICE) || (pCurSlice->eSliceType == P_SLICE))
+    WelsDeblockingFilterSliceRow (pCtx, pCurLayer, WelsDeblockingMb, kiMbY);
+
+  if (pDec->iDeblockedMbs != kiStartMb)
+    return;	// slices out of raster order, the rest gets padded once the picture is complete
+  pDec->iDeblockedMbs = kiEndMb;
+
+  // deblocking the next MB row modifies up to 3 luma lines above it
+  if (kiEndMb >= (int32_t)pSliceHeader->pSps->uiTotalMbCount)
+    iFinalLines = pDec->iHeightInPixel;
+  else
+    iFinalLines = ((kiEndMb / kiMbWidth) << 4) - 3;
+  if (iFinalLines <= 0)
+    return;
+
+  if (pCurLayer->sLayerInfo.sNalHeaderExt.sNalUnitHeader.uiNalRefIdc > 0)
+    ExpandReferencingPictureLines (pDec, iFinalLines);
+  ConvertPicOutputLines (&pCtx->sOutputFormatFunc, pDec, iFinalLines);
+  if (NULL != pCtx->pThreadCtx && pDec->iReadyLines < iFinalLines)
+    PublishPicLines (pCtx, pDec, iFinalLines);
+}
 
-  int32_t iTotalMbTargetLayer = pSliceHeader->pSps->uiTotalMbCount;
+int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx, PDqLayer pCurLayer, int32_t* pTotalNumMbRec,
+                                     const bool kbConcurrent) {
+  PSlice pCurSlice = &pCurLayer->sLayerInfo.sSliceInLayer;
+  PSliceHeader pSliceHeader = &pCurSlice->sSliceHeaderExt.sSliceHeader;
 
-  int32_t iCurLayerWidth  = pCurLayer->iMbWidth << 4;
-  int32_t iCurLayerHeight = pCurLayer->iMbHeight << 4;
+  int32_t iTotalMbTargetLayer = pSliceHeader->pSps->uiTotalMbCount;
 
   int32_t iNextMbXyIndex = 0;
-  PFmo pFmo = pCtx->pFmo;
+  PFmo pFmo = pCurLayer->pFmo;
 
   int32_t iTotalNumMb = pCurSlice->iTotalMbInCurSlice;
   int32_t iCountNumMb = 0;
   PDeblockingFilterMbFunc pDeblockMb;
+  int32_t iRet = 0;
+  // rows of a slice reconstructed next to others of the picture get filtered once all of them are done
+  const bool kbPipeline = !kbConcurrent && pCtx->bPipelineDeblocking && pSliceHeader->pPps->uiNumSliceGroups == 1;
+  int32_t iDeblockMbY = pSliceHeader->iFirstMbInSlice / pCurLayer->iMbWidth;
+  int32_t iLastMbY = iDeblockMbY;
+
+  if (NULL != pCtx->pRowThreadCtx && *pTotalNumMbRec + iTotalNumMb <= iTotalMbTargetLayer
+      && ReconstructSliceWavefront (pCtx, pCurLayer, kbPipeline, &iRet)) {
+    if (iRet)
+      return -1;
+    *pTotalNumMbRec += iTotalNumMb;
+    if (kbPipeline)
+      return 0;	// rows deblocked by the wavefront
+  } else {
+    iNextMbXyIndex   = pSliceHeader->iFirstMbInSlice;
+    pCurLayer->iMbX  = iNextMbXyIndex % pCurLayer->iMbWidth;
+    pCurLayer->iMbY  = iNextMbXyIndex / pCurLayer->iMbWidth;
+    pCurLayer->iMbXyIndex = iNextMbXyIndex;
 
-  if (!pCtx->bAvcBasedFlag && iCurLayerWidth != pCtx->iCurSeqIntervalMaxPicWidth) {
-    return -1;
-  }
-
-  iNextMbXyIndex   = pSliceHeader->iFirstMbInSlice;
-  pCurLayer->iMbX  = iNextMbXyIndex % pCurLayer->iMbWidth;
-  pCurLayer->iMbY  = iNextMbXyIndex / pCurLayer->iMbWidth;
-  pCurLayer->iMbXyIndex = iNextMbXyIndex;
-
-  if (0 == iNextMbXyIndex) {
-    pCurLayer->pDec->iSpsId = pSliceHeader->iSpsId;
-    pCurLayer->pDec->iPpsId = pSliceHeader->iPpsId;
-
-    pCurLayer->pDec->uiQualityId = pCurLayer->sLayerInfo.sNalHeaderExt.uiQualityId;
-  }
+    do {
+      if (WelsTargetMbConstruction (pCtx, pCurLayer)) {
+        WelsLog (pCtx, WELS_LOG_WARNING,
+                 "WelsTargetSliceConstruction():::MB(%d, %d) construction error. pCurSlice_type:%d\n",
+                 pCurLayer->iMbX, pCurLayer->iMbY, pCurSlice->eSliceType);
 
-  do {
-    if (WelsTargetMbConstruction (pCtx)) {
-      WelsLog (pCtx, WELS_LOG_WARNING, "WelsTargetSliceConstruction():::MB(%d, %d) construction error. pCurSlice_type:%d\n",
-               pCurLayer->iMbX, pCurLayer->iMbY, pCurSlice->eSliceType);
+        return -1;
+      }
 
-      return -1;
-    }
+      ++iCountNumMb;
+      ++ (*pTotalNumMbRec);
+      iLastMbY = pCurLayer->iMbY;
+      if (kbPipeline && pCurLayer->iMbX == pCurLayer->iMbWidth - 1) {
+        // intra prediction of this row read the unfiltered bottom lines of the row above
+        while (iDeblockMbY < iLastMbY)
+          WelsFinishSliceRow (pCtx, pCurLayer, iDeblockMbY++);
+      }
+      if (iCountNumMb >= iTotalNumMb) {
+        break;
+      }
+      if (*pTotalNumMbRec > iTotalMbTargetLayer) {
+        WelsLog (pCtx, WELS_LOG_WARNING, "WelsTargetSliceConstruction():::iTotalNumMbRec:%d, iTotalMbTargetLayer:%d\n",
+                 *pTotalNumMbRec, iTotalMbTargetLayer);
 
-    ++iCountNumMb;
-    ++pCtx->iTotalNumMbRec;
-    if (iCountNumMb >= iTotalNumMb) {
-      break;
-    }
-    if (pCtx->iTotalNumMbRec > iTotalMbTargetLayer) {
-      WelsLog (pCtx, WELS_LOG_WARNING, "WelsTargetSliceConstruction():::pCtx->iTotalNumMbRec:%d, iTotalMbTargetLayer:%d\n",
-               pCtx->iTotalNumMbRec, iTotalMbTargetLayer);
+        return -1;
+      }
 
-      return -1;
-    }
+      if (pSliceHeader->pPps->uiNumSliceGroups > 1) {
+        iNextMbXyIndex = FmoNextMb (pFmo, iNextMbXyIndex);
+      } else {
+        ++iNextMbXyIndex;
+      }
+      if (-1 == iNextMbXyIndex || iNextMbXyIndex >= iTotalMbTargetLayer) {	// slice group boundary or end of a frame
+        break;
+      }
+      pCurLayer->iMbX  = iNextMbXyIndex % pCurLayer->iMbWidth;
+      pCurLayer->iMbY  = iNextMbXyIndex / pCurLayer->iMbWidth;
+      pCurLayer->iMbXyIndex = iNextMbXyIndex;
+    } while (1);
 
-    if (pSliceHeader->pPps->uiNumSliceGroups > 1) {
-      iNextMbXyIndex = FmoNextMb (pFmo, iNextMbXyIndex);
-    } else {
-      ++iNextMbXyIndex;
-    }
-    if (-1 == iNextMbXyIndex || iNextMbXyIndex >= iTotalMbTargetLayer) {	// slice group boundary or end of a frame
-      break;
+    if (kbPipeline) {
+      while (iDeblockMbY <= iLastMbY)
+        WelsFinishSliceRow (pCtx, pCurLayer, iDeblockMbY++);
+      return 0;
     }
-    pCurLayer->iMbX  = iNextMbXyIndex % pCurLayer->iMbWidth;
-    pCurLayer->iMbY  = iNextMbXyIndex / pCurLayer->iMbWidth;
-    pCurLayer->iMbXyIndex = iNextMbXyIndex;
-  } while (1);
-
-  pCtx->pDec->iWidthInPixel  = iCurLayerWidth;
-  pCtx->pDec->iHeightInPixel = iCurLayerHeight;
+  }
 
   if ((pCurSlice->eSliceType != I_SLICE) && (pCurSlice->eSliceType != P_SLICE))
     return 0;
@@ -127,8 +176,10 @@ int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx) {
 
   if (1 == pSliceHeader->uiDisableDeblockingFilterIdc) {
     return 0;//NO_SUPPORTED_FILTER_IDX
+  } else if (kbConcurrent && 0 == pSliceHeader->uiDisableDeblockingFilterIdc) {
+    return 0;	// edges to the neighbouring slices filtered by FinishSliceJobs
   } else {
-    WelsDeblockingFilterSlice (pCtx, pDeblockMb);
+    WelsDeblockingFilterSlice (pCtx, pCurLayer, pDeblockMb);
 
   }
   // any other filter_idc not supported here, 7/22/2010
@@ -173,14 +224,14 @@ int32_t WelsMbInterConstruction (PWelsDecoderContext pCtx, PDqLayer pCurLayer) {
   int32_t iMbY = pCurLayer->iMbY;
   uint8_t*  pDstY, *pDstCb, *pDstCr;
 
-  int32_t iLumaStride   = pCtx->pDec->iLinesize[0];
-  int32_t iChromaStride = pCtx->pDec->iLinesize[1];
+  int32_t iLumaStride   = pCurLayer->pDec->iLinesize[0];
+  int32_t iChromaStride = pCurLayer->pDec->iLinesize[1];
 
   pDstY  = pCurLayer->pDec->pData[0] + ((iMbY * iLumaStride + iMbX) << 4);
   pDstCb = pCurLayer->pDec->pData[1] + ((iMbY * iChromaStride + iMbX) << 3);
   pDstCr = pCurLayer->pDec->pData[2] + ((iMbY * iChromaStride + iMbX) << 3);
 
-  GetInterPred (pDstY, pDstCb, pDstCr, pCtx);
+  GetInterPred (pDstY, pDstCb, pDstCr, pCtx, pCurLayer);
   WelsMbInterSampleConstruction (pCtx, pCurLayer, pDstY, pDstCb, pDstCr, iLumaStride, iChromaStride);
 
   pCtx->sBlockFunc.pWelsSetNonZeroCountFunc (NULL,
@@ -254,20 +305,19 @@ int32_t WelsMbInterPrediction (PWelsDecoderContext pCtx, PDqLayer pCurLayer) {
   int32_t iMbY = pCurLayer->iMbY;
   uint8_t*  pDstY, *pDstCb, *pDstCr;
 
-  int32_t iLumaStride   = pCtx->pDec->iLinesize[0];
-  int32_t iChromaStride = pCtx->pDec->iLinesize[1];
+  int32_t iLumaStride   = pCurLayer->pDec->iLinesize[0];
+  int32_t iChromaStride = pCurLayer->pDec->iLinesize[1];
 
   pDstY  = pCurLayer->pDec->pData[0] + ((iMbY * iLumaStride + iMbX) << 4);
   pDstCb = pCurLayer->pDec->pData[1] + ((iMbY * iChromaStride + iMbX) << 3);
   pDstCr = pCurLayer->pDec->pData[2] + ((iMbY * iChromaStride + iMbX) << 3);
 
-  GetInterPred (pDstY, pDstCb, pDstCr, pCtx);
+  GetInterPred (pDstY, pDstCb, pDstCr, pCtx, pCurLayer);
 
   return 0;
 }
 
-int32_t WelsTargetMbConstruction (PWelsDecoderContext pCtx) {
-  PDqLayer pCurLayer = pCtx->pCurDqLayer;
+int32_t WelsTargetMbConstruction (PWelsDecoderContext pCtx, PDqLayer pCurLayer) {
   if (MB_TYPE_INTRA_PCM == pCurLayer->pMbType[pCurLayer->iMbXyIndex]) {
     //already decoded and reconstructed when parsing
     return 0;
@@ -311,9 +361,12 @@ void WelsChromaDcIdct (int16_t* pBlock) {
   pBlk[iStride1] = (iE - iB) >> 1;
 }
 
-int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, bool bFirstSliceInLayer, PNalUnit pNalCur) {
-  PDqLayer pCurLayer = pCtx->pCurDqLayer;
-  PFmo pFmo = pCtx->pFmo;
+/*
+ * parse the MBs of the slice of pNalCur into the MB arrays of pCurLayer; only reads pCtx, so slices of a picture
+ * may be parsed concurrently, each with its own copy of the layer
+ */
+int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer, bool bFirstSliceInLayer, PNalUnit pNalCur) {
+  PFmo pFmo = pCurLayer->pFmo;
   int32_t i, iRet;
   int32_t iNextMbXyIndex, iSliceIdc;
 
@@ -335,18 +388,6 @@ int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, bool bFirstSliceInLayer, PNal
     pDecMbCavlcFunc = WelsDecodeMbCavlcISlice;
   }
 
-  if (pSliceHeader->pPps->bConstainedIntraPredFlag) {
-    pCtx->pFillInfoCacheIntra4x4Func = WelsFillCacheConstrain1Intra4x4;
-    pCtx->pParseIntra4x4ModeFunc      = ParseIntra4x4ModeConstrain1;
-    pCtx->pParseIntra16x16ModeFunc    = ParseIntra16x16ModeConstrain1;
-  } else {
-    pCtx->pFillInfoCacheIntra4x4Func = WelsFillCacheConstrain0Intra4x4;
-    pCtx->pParseIntra4x4ModeFunc      = ParseIntra4x4ModeConstrain0;
-    pCtx->pParseIntra16x16ModeFunc    = ParseIntra16x16ModeConstrain0;
-  }
-
-  pCtx->eSliceType = pSliceHeader->eSliceType;
-
   if (pCurLayer->sLayerInfo.pPps->bEntropyCodingModeFlag == 1) {
     //CABAC encoding is unsupported yet!
     return -1;
@@ -364,6 +405,8 @@ int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, bool bFirstSliceInLayer, PNal
 
   if (pSliceHeaderExt->bSliceSkipFlag == 1) {
     for (i = 0; i < (int32_t)pSliceHeaderExt->uiNumMbsInSlice; i++) {
+      if (0 != pCurLayer->iSliceMbLimit && iNextMbXyIndex >= pCurLayer->iSliceMbLimit)
+        return -1;	// MBs of the slice decoded next to this one
       pCurLayer->pSliceIdc[iNextMbXyIndex] = iSliceIdc;
 
 
@@ -387,7 +430,7 @@ int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, bool bFirstSliceInLayer, PNal
 
   do {
     pCurLayer->pSliceIdc[iNextMbXyIndex] = iSliceIdc;
-    iRet = pDecMbCavlcFunc (pCtx,  pNalCur);
+    iRet = pDecMbCavlcFunc (pCtx, pCurLayer, pNalCur);
 
     if (iRet != ERR_NONE) {
       return iRet;
@@ -406,7 +449,7 @@ int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, bool bFirstSliceInLayer, PNal
     }
 
     // check whether there is left bits to read next time in case multiple slices
-    iUsedBits = ((pBs->pCurBuf - pBs->pStartBuf) << 3) - (16 - pBs->iLeftBits);
+    iUsedBits = BsGetUsedBits (pBs);
     if (iUsedBits == pBs->iBits && 0 >= pCurLayer->sLayerInfo.sSliceInLayer.iMbSkipRun) {	// slice boundary
       break;
     }
@@ -416,6 +459,11 @@ int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, bool bFirstSliceInLayer, PNal
                iUsedBits, pBs->iBits);
       return -1;
     }
+    if (0 != pCurLayer->iSliceMbLimit && iNextMbXyIndex >= pCurLayer->iSliceMbLimit) {
+      WelsLog (pCtx, WELS_LOG_WARNING,
+               "WelsDecodeSlice()::::slice runs into the next one at MB %d, MUST stop decoding.\n", iNextMbXyIndex);
+      return -1;
+    }
     iMbX = iNextMbXyIndex % pCurLayer->iMbWidth;
     iMbY = iNextMbXyIndex / pCurLayer->iMbWidth;
     pCurLayer->iMbX =  iMbX;
@@ -426,12 +474,18 @@ int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, bool bFirstSliceInLayer, PNal
   return ERR_NONE;
 }
 
-int32_t WelsActualDecodeMbCavlcISlice (PWelsDecoderContext pCtx) {
+int32_t WelsActualDecodeMbCavlcISlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer) {
   SVlcTable* pVlcTable     = &pCtx->sVlcTable;
-  PDqLayer pCurLayer		 = pCtx->pCurDqLayer;
   PBitStringAux pBs		 = pCurLayer->pBitStringAux;
   PSlice pSlice			 = &pCurLayer->sLayerInfo.sSliceInLayer;
   PSliceHeader pSliceHeader		     = &pSlice->sSliceHeaderExt.sSliceHeader;
+  const bool kbConstrainedIntra = pSliceHeader->pPps->bConstainedIntraPredFlag;
+  PWelsFillNeighborMbInfoIntra4x4Func pFillInfoCacheIntra4x4 = kbConstrainedIntra ? WelsFillCacheConstrain1Intra4x4 :
+      WelsFillCacheConstrain0Intra4x4;
+  PWelsParseIntra4x4ModeFunc pParseIntra4x4Mode = kbConstrainedIntra ? ParseIntra4x4ModeConstrain1 :
+      ParseIntra4x4ModeConstrain0;
+  PWelsParseIntra16x16ModeFunc pParseIntra16x16Mode = kbConstrainedIntra ? ParseIntra16x16ModeConstrain1 :
+      ParseIntra16x16ModeConstrain0;
 
   SNeighAvail sNeighAvail;
 
@@ -474,12 +528,10 @@ int32_t WelsActualDecodeMbCavlcISlice (PWelsDecoderContext pCtx) {
     int32_t iCopySizeY  = (sizeof (uint8_t) << 4);
     int32_t iCopySizeUV = (sizeof (uint8_t) << 3);
 
-    int32_t iIndex = ((-pBs->iLeftBits) >> 3) + 2;
-
     pCurLayer->pMbType[iMbXy] = MB_TYPE_INTRA_PCM;
 
     //step 1: locating bit-stream pointer [must align into integer byte]
-    pBs->pCurBuf -= iIndex;
+    pBs->pCurBuf = pBs->pStartBuf + ((BsGetUsedBits (pBs) + 7) >> 3);
 
     //step 2: copy pixel from bit-stream into fdec [reconstruction]
     pTmpBsBuf = pBs->pCurBuf;
@@ -510,8 +562,8 @@ int32_t WelsActualDecodeMbCavlcISlice (PWelsDecoderContext pCtx) {
   } else if (0 == uiMbType) { //reference to JM
     ENFORCE_STACK_ALIGN_1D (int8_t, pIntraPredMode, 48, 16);
     pCurLayer->pMbType[iMbXy] = MB_TYPE_INTRA4x4;
-    pCtx->pFillInfoCacheIntra4x4Func (&sNeighAvail, pNonZeroCount, pIntraPredMode, pCurLayer);
-    if (pCtx->pParseIntra4x4ModeFunc (&sNeighAvail, pIntraPredMode, pBs, pCurLayer)) {
+    pFillInfoCacheIntra4x4 (&sNeighAvail, pNonZeroCount, pIntraPredMode, pCurLayer);
+    if (pParseIntra4x4Mode (&sNeighAvail, pIntraPredMode, pBs, pCurLayer)) {
       return -1;
     }
 
@@ -534,7 +586,7 @@ int32_t WelsActualDecodeMbCavlcISlice (PWelsDecoderContext pCtx) {
     uiCbpC = pCurLayer->pCbp[iMbXy] >> 4;
     uiCbpL = pCurLayer->pCbp[iMbXy] & 15;
     WelsFillCacheNonZeroCount (&sNeighAvail, pNonZeroCount, pCurLayer);
-    if (pCtx->pParseIntra16x16ModeFunc (&sNeighAvail, pBs, pCurLayer)) {
+    if (pParseIntra16x16Mode (&sNeighAvail, pBs, pCurLayer)) {
       return -1;
     }
   }
@@ -582,8 +634,6 @@ int32_t WelsActualDecodeMbCavlcISlice (PWelsDecoderContext pCtx) {
                                   51)];
 
 
-    BsStartCavlc (pBs);
-
     if (MB_TYPE_INTRA16x16 == pCurLayer->pMbType[iMbXy]) {
       //step1: Luma DC
       if (WelsResidualBlockCavlc (pVlcTable, pNonZeroCount, pBs, 0, 16,
@@ -658,14 +708,12 @@ int32_t WelsActualDecodeMbCavlcISlice (PWelsDecoderContext pCtx) {
       ST16 (&pCurLayer->pNzc[iMbXy][18], LD16 (&pNonZeroCount[6 + 8 * 4]));
       ST16 (&pCurLayer->pNzc[iMbXy][22], LD16 (&pNonZeroCount[6 + 8 * 5]));
     }
-    BsEndCavlc (pBs);
   }
 
   return 0;
 }
 
-int32_t WelsDecodeMbCavlcISlice (PWelsDecoderContext pCtx, PNalUnit pNalCur) {
-  PDqLayer pCurLayer = pCtx->pCurDqLayer;
+int32_t WelsDecodeMbCavlcISlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer, PNalUnit pNalCur) {
   PBitStringAux pBs = pCurLayer->pBitStringAux;
   PSliceHeaderExt pSliceHeaderExt = &pCurLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt;
   int32_t iBaseModeFlag;
@@ -679,7 +727,7 @@ int32_t WelsDecodeMbCavlcISlice (PWelsDecoderContext pCtx, PNalUnit pNalCur) {
     iBaseModeFlag = pSliceHeaderExt->bDefaultBaseModeFlag;
   }
   if (!iBaseModeFlag) {
-    iRet = WelsActualDecodeMbCavlcISlice (pCtx);
+    iRet = WelsActualDecodeMbCavlcISlice (pCtx, pCurLayer);
   } else {
     WelsLog (pCtx, WELS_LOG_WARNING, "iBaseModeFlag (%d) != 0, inter-layer prediction not supported.\n", iBaseModeFlag);
     return GENERATE_ERROR_NO (ERR_LEVEL_SLICE_HEADER, ERR_INFO_UNSUPPORTED_ILP);
@@ -691,12 +739,18 @@ int32_t WelsDecodeMbCavlcISlice (PWelsDecoderContext pCtx, PNalUnit pNalCur) {
   return 0;
 }
 
-int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx) {
+int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer) {
   SVlcTable* pVlcTable     = &pCtx->sVlcTable;
-  PDqLayer pCurLayer		 = pCtx->pCurDqLayer;
   PBitStringAux pBs		 = pCurLayer->pBitStringAux;
   PSlice pSlice			 = &pCurLayer->sLayerInfo.sSliceInLayer;
   PSliceHeader pSliceHeader		     = &pSlice->sSliceHeaderExt.sSliceHeader;
+  const bool kbConstrainedIntra = pSliceHeader->pPps->bConstainedIntraPredFlag;
+  PWelsFillNeighborMbInfoIntra4x4Func pFillInfoCacheIntra4x4 = kbConstrainedIntra ? WelsFillCacheConstrain1Intra4x4 :
+      WelsFillCacheConstrain0Intra4x4;
+  PWelsParseIntra4x4ModeFunc pParseIntra4x4Mode = kbConstrainedIntra ? ParseIntra4x4ModeConstrain1 :
+      ParseIntra4x4ModeConstrain0;
+  PWelsParseIntra16x16ModeFunc pParseIntra16x16Mode = kbConstrainedIntra ? ParseIntra16x16ModeConstrain1 :
+      ParseIntra16x16ModeConstrain0;
 
   SNeighAvail sNeighAvail;
 
@@ -723,7 +777,7 @@ int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx) {
     int8_t	iRefIndex[LIST_A][30];
     pCurLayer->pMbType[iMbXy] = g_ksInterMbTypeInfo[uiMbType].iType;
     WelsFillCacheInter (&sNeighAvail, pNonZeroCount, iMotionVector, iRefIndex, pCurLayer);
-    if (ParseInterInfo (pCtx, iMotionVector, iRefIndex, pBs)) {
+    if (ParseInterInfo (pCtx, pCurLayer, iMotionVector, iRefIndex, pBs)) {
       return -1;//abnormal
     }
 
@@ -763,12 +817,10 @@ int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx) {
       int32_t iCopySizeY  = (sizeof (uint8_t) << 4);
       int32_t iCopySizeUV = (sizeof (uint8_t) << 3);
 
-      int32_t iIndex = ((-pBs->iLeftBits) >> 3) + 2;
-
       pCurLayer->pMbType[iMbXy] = MB_TYPE_INTRA_PCM;
 
       //step 1: locating bit-stream pointer [must align into integer byte]
-      pBs->pCurBuf -= iIndex;
+      pBs->pCurBuf = pBs->pStartBuf + ((BsGetUsedBits (pBs) + 7) >> 3);
 
       //step 2: copy pixel from bit-stream into fdec [reconstruction]
       pTmpBsBuf = pBs->pCurBuf;
@@ -807,8 +859,8 @@ int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx) {
       if (0 == uiMbType) {
         ENFORCE_STACK_ALIGN_1D (int8_t, pIntraPredMode, 48, 16);
         pCurLayer->pMbType[iMbXy] = MB_TYPE_INTRA4x4;
-        pCtx->pFillInfoCacheIntra4x4Func (&sNeighAvail, pNonZeroCount, pIntraPredMode, pCurLayer);
-        if (pCtx->pParseIntra4x4ModeFunc (&sNeighAvail, pIntraPredMode, pBs, pCurLayer)) {
+        pFillInfoCacheIntra4x4 (&sNeighAvail, pNonZeroCount, pIntraPredMode, pCurLayer);
+        if (pParseIntra4x4Mode (&sNeighAvail, pIntraPredMode, pBs, pCurLayer)) {
           return -1;
         }
       } else { //I_PCM exclude, we can ignore it
@@ -818,7 +870,7 @@ int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx) {
         uiCbpC = pCurLayer->pCbp[iMbXy] >> 4;
         uiCbpL = pCurLayer->pCbp[iMbXy] & 15;
         WelsFillCacheNonZeroCount (&sNeighAvail, pNonZeroCount, pCurLayer);
-        if (pCtx->pParseIntra16x16ModeFunc (&sNeighAvail, pBs, pCurLayer)) {
+        if (pParseIntra16x16Mode (&sNeighAvail, pBs, pCurLayer)) {
           return -1;
         }
       }
@@ -884,8 +936,6 @@ int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx) {
     pCurLayer->pChromaQp[iMbXy] = g_kuiChromaQp[WELS_CLIP3 (pSlice->iLastMbQp + pSliceHeader->pPps->iChromaQpIndexOffset, 0,
                                   51)];
 
-    BsStartCavlc (pBs);
-
     if (MB_TYPE_INTRA16x16 == pCurLayer->pMbType[iMbXy]) {
       //step1: Luma DC
       if (WelsResidualBlockCavlc (pVlcTable, pNonZeroCount, pBs, 0, 16, g_kuiLumaDcZigzagScan,
@@ -961,14 +1011,12 @@ int32_t WelsActualDecodeMbCavlcPSlice (PWelsDecoderContext pCtx) {
       ST16 (&pCurLayer->pNzc[iMbXy][18], LD16 (&pNonZeroCount[6 + 8 * 4]));
       ST16 (&pCurLayer->pNzc[iMbXy][22], LD16 (&pNonZeroCount[6 + 8 * 5]));
     }
-    BsEndCavlc (pBs);
   }
 
   return 0;
 }
 
-int32_t WelsDecodeMbCavlcPSlice (PWelsDecoderContext pCtx, PNalUnit pNalCur) {
-  PDqLayer pCurLayer		 = pCtx->pCurDqLayer;
+int32_t WelsDecodeMbCavlcPSlice (PWelsDecoderContext pCtx, PDqLayer pCurLayer, PNalUnit pNalCur) {
   PBitStringAux pBs		 = pCurLayer->pBitStringAux;
   PSlice pSlice			 = &pCurLayer->sLayerInfo.sSliceInLayer;
   PSliceHeader pSliceHeader		    = &pSlice->sSliceHeaderExt.sSliceHeader;
@@ -1030,7 +1078,7 @@ int32_t WelsDecodeMbCavlcPSlice (PWelsDecoderContext pCtx, PNalUnit pNalCur) {
     iBaseModeFlag = pSlice->sSliceHeaderExt.bDefaultBaseModeFlag;
   }
   if (!iBaseModeFlag) {
-    iRet = WelsActualDecodeMbCavlcPSlice (pCtx);
+    iRet = WelsActualDecodeMbCavlcPSlice (pCtx, pCurLayer);
   } else {
     WelsLog (pCtx, WELS_LOG_WARNING, "iBaseModeFlag (%d) != 0, inter-layer prediction not supported.\n", iBaseModeFlag);
     return GENERATE_ERROR_NO (ERR_LEVEL_SLICE_HEADER, ERR_INFO_UNSUPPORTED_ILP);
@@ -49,36 +49,59 @@
 #include "decoder_core.h"
 #include "deblocking.h"
 #include "expand_pic.h"
+#include "output_format.h"
 #include "decode_slice.h"
 #include "error_concealment.h"
-#include "mem_align.h"
+#include "dec_multi_threading.h"
 #include "ls_defines.h"
 
 namespace WelsDec {
 
 extern PPicture AllocPicture (PWelsDecoderContext pCtx, const int32_t kiPicWidth, const int32_t kiPicHeight);
 
-extern void FreePicture (PPicture pPic);
+extern void FreePicture (PPicture pPic, CMemoryAlign* pMa);
+
+extern int32_t ResizePicture (PWelsDecoderContext pCtx, PPicture pPic, const int32_t kiPicWidth,
+                              const int32_t kiPicHeight);
 
 inline void GetValueOf4Bytes (uint8_t* pDstNal, int32_t iDdstIdx) {
   ST32 (pDstNal, iDdstIdx);
 }
 
+/* size of the NAL at kpSrc up to the next start code, -1 if it holds an emulation prevention byte */
+static inline int32_t GetNalSizeWithoutEscape (const uint8_t* kpSrc, const int32_t kiSrcLen) {
+  int32_t iPos = 0;
+
+  while (iPos < kiSrcLen) {
+    iPos += FindStartCodeCandidate (kpSrc + iPos, kiSrcLen - iPos);
+    if (iPos >= kiSrcLen)
+      break;
+    if (kpSrc[iPos + 2] == 0x01)
+      return iPos;
+    if (kpSrc[iPos + 2] == 0x03)
+      return -1;
+    ++ iPos;
+  }
+
+  return kiSrcLen;
+}
+
 static int32_t CreatePicBuff (PWelsDecoderContext pCtx, PPicBuff* ppPicBuf, const int32_t kiSize,
                               const int32_t kiPicWidth, const int32_t kiPicHeight) {
   PPicBuff pPicBuf = NULL;
   int32_t iPicIdx = 0;
+  CMemoryAlign* pMa = pCtx->pMemAlign;
   if (kiSize <= 0 || kiPicWidth <= 0 || kiPicHeight <= 0) {
     return 1;
   }
 
-  pPicBuf	= (PPicBuff)WelsMalloc (sizeof (SPicBuff), "PPicBuff");
+  pPicBuf	= (PPicBuff)pMa->WelsMallocz (sizeof (SPicBuff), "PPicBuff");
 
   if (NULL == pPicBuf) {
     return 1;
   }
 
-  pPicBuf->ppPic = (PPicture*)WelsMalloc (kiSize * sizeof (PPicture), "PPicture*");
+  pPicBuf->ppPic = (PPicture*)pMa->WelsMallocz (kiSize * sizeof (PPicture), "PPicture*");
 
   if (NULL == pPicBuf->ppPic) {
     return 1;
@@ -99,7 +122,50 @@ static int32_t CreatePicBuff (PWelsDecoderContext pCtx, PPicBuff* ppPicBuf, cons
   return 0;
 }
 
-static void DestroyPicBuff (PPicBuff* ppPicBuf) {
+/*
+ * change resolution and size of a picture queue in place: pictures are kept and laid out for the new resolution,
+ * only those not fitting in their buffer any more get a bigger one
+ */
+static int32_t ResizePicBuff (PWelsDecoderContext pCtx, PPicBuff pPicBuf, const int32_t kiSize,
+                              const int32_t kiPicWidth, const int32_t kiPicHeight) {
+  int32_t iPicIdx = 0;
+  CMemoryAlign* pMa = pCtx->pMemAlign;
+  if (kiSize <= 0 || kiPicWidth <= 0 || kiPicHeight <= 0) {
+    return 1;
+  }
+
+  if (kiSize != pPicBuf->iCapacity) {
+    PPicture* ppPic = (PPicture*)pMa->WelsMallocz (kiSize * sizeof (PPicture), "PPicture*");
+    if (NULL == ppPic) {
+      return 1;
+    }
+    for (iPicIdx = 0; iPicIdx < pPicBuf->iCapacity; ++ iPicIdx) {
+      if (iPicIdx < kiSize)
+        ppPic[iPicIdx] = pPicBuf->ppPic[iPicIdx];
+      else
+        FreePicture (pPicBuf->ppPic[iPicIdx], pMa);
+    }
+    pMa->WelsFree (pPicBuf->ppPic, "pPicBuf->queue");
+    pPicBuf->ppPic		= ppPic;
+    pPicBuf->iCapacity	= kiSize;
+  }
+
+  for (iPicIdx = 0; iPicIdx < kiSize; ++ iPicIdx) {
+    if (NULL == pPicBuf->ppPic[iPicIdx]) {
+      pPicBuf->ppPic[iPicIdx] = AllocPicture (pCtx, kiPicWidth, kiPicHeight);
+      if (NULL == pPicBuf->ppPic[iPicIdx]) {
+        return 1;
+      }
+    } else if (ResizePicture (pCtx, pPicBuf->ppPic[iPicIdx], kiPicWidth, kiPicHeight)) {
+      return 1;
+    }
+  }
+  pPicBuf->iCurrentIdx = 0;
+
+  return 0;
+}
+
+void DestroyPicBuff (PPicBuff* ppPicBuf, CMemoryAlign* pMa) {
   PPicBuff pPicBuf = NULL;
 
   if (NULL == ppPicBuf || NULL == *ppPicBuf)
@@ -111,20 +177,20 @@ static void DestroyPicBuff (PPicBuff* ppPicBuf) {
     while (iPicIdx < pPicBuf->iCapacity) {
       PPicture pPic = pPicBuf->ppPic[iPicIdx];
       if (pPic != NULL) {
-        FreePicture (pPic);
+        FreePicture (pPic, pMa);
       }
       pPic = NULL;
       ++ iPicIdx;
     }
 
-    WelsFree (pPicBuf->ppPic, "pPicBuf->queue");
+    pMa->WelsFree (pPicBuf->ppPic, "pPicBuf->queue");
 
     pPicBuf->ppPic	= NULL;
   }
   pPicBuf->iCapacity	= 0;
   pPicBuf->iCurrentIdx = 0;
 
-  WelsFree (pPicBuf, "pPicBuf");
+  pMa->WelsFree (pPicBuf, "pPicBuf");
 
   pPicBuf = NULL;
   *ppPicBuf = NULL;
@@ -134,8 +200,11 @@ static void DestroyPicBuff (PPicBuff* ppPicBuf) {
  */
 void WelsDecoderDefaults (PWelsDecoderContext pCtx) {
   int32_t iCpuCores               = 1;
+  CMemoryAlign* pMemAlign		= pCtx->pMemAlign;
   memset (pCtx, 0, sizeof (SWelsDecoderContext));	// fill zero first
 
+  pCtx->pMemAlign				= pMemAlign;
+
   pCtx->pArgDec                   = NULL;
 
   pCtx->iOutputColorFormat		= videoFormatI420;	// yuv in default
@@ -192,6 +261,16 @@ static inline int32_t GetTargetRefListSize (PWelsDecoderContext pCtx) {
   }
 #endif
 
+  // pictures held by frame tasks in flight or waiting for output can not be prefetched
+  if (NULL != pCtx && NULL != pCtx->pThreadCtx) {
+    iNumRefFrames += pCtx->pThreadCtx->iTaskNum;
+  }
+
+  // the last frame output from a buffer of the application is kept for error concealment
+  if (NULL != pCtx && NULL != pCtx->sBufferProvider.pGetBuffer) {
+    ++ iNumRefFrames;
+  }
+
   return iNumRefFrames;
 }
 
@@ -223,19 +302,29 @@ int32_t WelsRequestMem (PWelsDecoderContext pCtx, const int32_t kiMbWidth, const
 
   // sync update pRefList
   WelsResetRefPic (pCtx);	// added to sync update ref list due to pictures are free
+  pCtx->pPreviousDecodedPictureInDpb = NULL;	// may be freed or laid out for the new resolution
 
   // for Recycled_Pic_Queue
   for (iListIdx = LIST_0; iListIdx < LIST_A; ++ iListIdx) {
     PPicBuff* ppPic = &pCtx->pPicBuff[iListIdx];
     if (NULL != ppPic && NULL != *ppPic) {
-      DestroyPicBuff (ppPic);
+      if (RetirePicBuff (pCtx, *ppPic))
+        *ppPic = NULL;	// still used by frame tasks, freed once they are released
+      else if (iListIdx != LIST_0)
+        DestroyPicBuff (ppPic, pCtx->pMemAlign);
     }
   }
 
-  // currently only active for LIST_0 due to have no B frames
-  iErr = CreatePicBuff (pCtx, &pCtx->pPicBuff[LIST_0], iPicQueueSize, kiPicWidth, kiPicHeight);
-  if (iErr != ERR_NONE)
+  // currently only active for LIST_0 due to have no B frames, its pictures are reused unless held by frame tasks
+  if (NULL != pCtx->pPicBuff[LIST_0])
+    iErr = ResizePicBuff (pCtx, pCtx->pPicBuff[LIST_0], iPicQueueSize, kiPicWidth, kiPicHeight);
+  else
+    iErr = CreatePicBuff (pCtx, &pCtx->pPicBuff[LIST_0], iPicQueueSize, kiPicWidth, kiPicHeight);
+  if (iErr != ERR_NONE) {
+    DestroyPicBuff (&pCtx->pPicBuff[LIST_0], pCtx->pMemAlign);
+    pCtx->bHaveGotMemory = false;
     return iErr;
+  }
 
 
   pCtx->iImgWidthInPixel	= kiPicWidth;	// target width of image to be reconstruted while decoding
@@ -261,7 +350,7 @@ void WelsFreeMem (PWelsDecoderContext pCtx) {
   for (iListIdx = LIST_0; iListIdx < LIST_A; ++ iListIdx) {
     PPicBuff* pPicBuff = &pCtx->pPicBuff[iListIdx];
     if (NULL != pPicBuff && NULL != *pPicBuff) {
-      DestroyPicBuff (pPicBuff);
+      DestroyPicBuff (pPicBuff, pCtx->pMemAlign);
     }
   }
 
@@ -281,6 +370,7 @@ void WelsOpenDecoder (PWelsDecoderContext pCtx) {
   InitMcFunc (& (pCtx->sMcFunc), pCtx->uiCpuFlag);
 
   InitExpandPictureFunc (& (pCtx->sExpandPicFunc), pCtx->uiCpuFlag);
+  InitOutputFormatFunc (& (pCtx->sOutputFormatFunc), pCtx->uiCpuFlag);
   AssignFuncPointerForRec (pCtx);
 
   // vlc tables
@@ -301,6 +391,10 @@ void WelsOpenDecoder (PWelsDecoderContext pCtx) {
  * \brief	Close decoder
  */
 void WelsCloseDecoder (PWelsDecoderContext pCtx) {
+  UninitDecThreads (pCtx);
+  UninitDecRowThreads (pCtx);
+  UninitDecSliceThreads (pCtx);
+
   WelsFreeMem (pCtx);
 
   WelsFreeMemory (pCtx);
@@ -321,14 +415,22 @@ int32_t DecoderConfigParam (PWelsDecoderContext pCtx, const SDecodingParam* kpPa
   if (NULL == pCtx || NULL == kpParam)
     return 1;
 
-  pCtx->pParam	= (SDecodingParam*)WelsMalloc (sizeof (SDecodingParam), "SDecodingParam");
+  pCtx->pParam	= (SDecodingParam*)pCtx->pMemAlign->WelsMallocz (sizeof (SDecodingParam), "SDecodingParam");
 
   if (NULL == pCtx->pParam)
     return 1;
 
   memcpy (pCtx->pParam, kpParam, sizeof (SDecodingParam));
   pCtx->iOutputColorFormat	= pCtx->pParam->iOutputColorFormat;
+  if (!IsOutputFormatSupported (pCtx->iOutputColorFormat)) {
+    WelsLog (pCtx, WELS_LOG_WARNING, "DecoderConfigParam()::output color format %d unsupported, I420 output.\n",
+             pCtx->iOutputColorFormat);
+    pCtx->iOutputColorFormat	= videoFormatI420;
+  }
+  pCtx->iOutputWidth		= WELS_MAX (pCtx->pParam->iOutputWidth, 0);
+  pCtx->iOutputHeight		= WELS_MAX (pCtx->pParam->iOutputHeight, 0);
   pCtx->bErrorResilienceFlag	= pCtx->pParam->uiEcActiveFlag ? true : false;
+  pCtx->bPipelineDeblocking	= pCtx->pParam->bPipelineDeblocking;
 
   if (VIDEO_BITSTREAM_SVC == pCtx->pParam->sVideoProperty.eVideoBsType ||
       VIDEO_BITSTREAM_AVC == pCtx->pParam->sVideoProperty.eVideoBsType) {
@@ -339,6 +441,16 @@ int32_t DecoderConfigParam (PWelsDecoderContext pCtx, const SDecodingParam* kpPa
 
   WelsLog (pCtx, WELS_LOG_INFO, "eVideoType: %d\n", pCtx->eVideoType);
 
+  if (ERR_NONE != InitDecThreads (pCtx, pCtx->pParam->iThreadCount)) {
+    WelsLog (pCtx, WELS_LOG_WARNING, "DecoderConfigParam()::frame level threading disabled.\n");
+  }
+  if (ERR_NONE != InitDecRowThreads (pCtx, pCtx->pParam->iRowThreadCount)) {
+    WelsLog (pCtx, WELS_LOG_WARNING, "DecoderConfigParam()::wavefront reconstruction disabled.\n");
+  }
+  if (ERR_NONE != InitDecSliceThreads (pCtx, pCtx->pParam->iSliceThreadCount)) {
+    WelsLog (pCtx, WELS_LOG_WARNING, "DecoderConfigParam()::slice level threading disabled.\n");
+  }
+
   return 0;
 }
 
@@ -429,7 +541,7 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
     uint8_t* pSrcNal       = NULL;
     uint8_t* pDstNal       = NULL;
     uint8_t* pNalPayload   = NULL;
-
+    bool bNalInPlace       = false; //current NAL is parsed in the source buffer without copy
 
     if (NULL == DetectStartCodePrefix (kpBsBuf, &iOffset,
                                        kiBsLen)) {  //CAN'T find the 00 00 01 start prefix from the source buffer
@@ -449,6 +561,26 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
     pDstNal = pRawData->pCurPos + 4; //4-bytes used to write the length of current NAL rbsp
 
     while (iSrcConsumed < iSrcLength) {
+      if (pCtx->bZeroCopyInput && (0 == iSrcIdx) && !bNalInPlace) {
+        const int32_t kiNalSize = GetNalSizeWithoutEscape (pSrcNal, iSrcLength - iSrcConsumed);
+        if (kiNalSize >= 0) {
+          bNalInPlace   = true;
+          pDstNal       = pSrcNal;
+          iDstIdx       = kiNalSize;
+          iSrcIdx       = kiNalSize;
+          iSrcConsumed += kiNalSize;
+          continue;
+        }
+      }
+      //bulk copy of the bytes before the next 00 00 0x pattern
+      const int32_t kiRunLen = FindStartCodeCandidate (pSrcNal + iSrcIdx, iSrcLength - iSrcConsumed);
+      if (kiRunLen > 0) {
+        memcpy (pDstNal + iDstIdx, pSrcNal + iSrcIdx, kiRunLen);
+        iDstIdx += kiRunLen;
+        iSrcIdx += kiRunLen;
+        iSrcConsumed += kiRunLen;
+        continue;
+      }
       if ((2 + iSrcConsumed < iSrcLength) &&
           (0 == LD16 (pSrcNal + iSrcIdx)) &&
           ((pSrcNal[2 + iSrcIdx] == 0x03) || (pSrcNal[2 + iSrcIdx] == 0x01))) {
@@ -458,7 +590,9 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
           iSrcIdx	+= 3;
           iSrcConsumed += 3;
         } else {
-          GetValueOf4Bytes (pDstNal - 4, iDstIdx);  //pDstNal-4 (non-aligned by 4) in Solaris10(SPARC). Given value by byte.
+          if (!bNalInPlace) {
+            GetValueOf4Bytes (pDstNal - 4, iDstIdx);  //pDstNal-4 (non-aligned by 4) in Solaris10(SPARC).
+          }
 
           iConsumedBytes = 0;
           pNalPayload	= ParseNalHeader (pCtx, &pCtx->sCurNalHead, pDstNal, iDstIdx, pSrcNal - 3, iSrcIdx + 3, &iConsumedBytes);
@@ -496,13 +630,16 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
             return pCtx->iErrorCode;
           }
 
-          pDstNal += iDstIdx; //update current position
-          if ((iSrcLength - iSrcConsumed + 4) > (pRawData->pEnd - pDstNal)) {
-            pRawData->pCurPos = pRawData->pHead;
-          } else {
-            pRawData->pCurPos = pDstNal;
+          if (!bNalInPlace) {
+            pDstNal += iDstIdx; //update current position
+            if ((iSrcLength - iSrcConsumed + 4) > (pRawData->pEnd - pDstNal)) {
+              pRawData->pCurPos = pRawData->pHead;
+            } else {
+              pRawData->pCurPos = pDstNal;
+            }
           }
           pDstNal = pRawData->pCurPos + 4; //init, 4 bytes used to store the next NAL
+          bNalInPlace = false;
 
           pSrcNal += iSrcIdx + 3;
           iSrcConsumed += 3;
@@ -516,7 +653,9 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
     }
 
     //last NAL decoding
-    GetValueOf4Bytes (pDstNal - 4, iDstIdx); //pDstNal-4 (non-aligned by 4) in Solaris10(SPARC). Given value by byte.
+    if (!bNalInPlace) {
+      GetValueOf4Bytes (pDstNal - 4, iDstIdx); //pDstNal-4 (non-aligned by 4) in Solaris10(SPARC). Given value by byte.
+    }
 
     iConsumedBytes = 0;
     pNalPayload = ParseNalHeader (pCtx, &pCtx->sCurNalHead, pDstNal, iDstIdx, pSrcNal - 3, iSrcIdx + 3, &iConsumedBytes);
@@ -550,8 +689,10 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
       }
       return pCtx->iErrorCode;
     }
-    pDstNal += iDstIdx;
-    pRawData->pCurPos = pDstNal; //init the pCurPos for next NAL(s) storage
+    if (!bNalInPlace) {
+      pDstNal += iDstIdx;
+      pRawData->pCurPos = pDstNal; //init the pCurPos for next NAL(s) storage
+    }
   } else { /* no supplementary picture payload input, but stored a picture */
     PAccessUnit pCurAu	=
       pCtx->pAccessUnitList;	// current access unit, it will never point to NULL after decode's successful initialization
@@ -584,6 +725,7 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
  */
 int32_t DecoderSetCsp (PWelsDecoderContext pCtx, const int32_t kiColorFormat) {
   WELS_VERIFY_RETURN_IF (1, (NULL == pCtx));
+  WELS_VERIFY_RETURN_IF (1, !IsOutputFormatSupported (kiColorFormat));
 
   pCtx->iOutputColorFormat	= kiColorFormat;
   if (pCtx->pParam != NULL) {
@@ -614,12 +756,20 @@ int32_t SyncPictureResolutionExt (PWelsDecoderContext pCtx, const int32_t kiMbWi
     return iErr;
   }
 
-  iErr = InitialDqLayersContext (pCtx, kiPicWidth, kiPicHeight);
+  // MB level buffers are sized for the maximal resolution configured too, smaller ones reuse them
+  if (NULL != pCtx->pParam && pCtx->pParam->iMaxWidth > 0 && pCtx->pParam->iMaxHeight > 0)
+    iErr = InitialDqLayersContext (pCtx, WELS_MAX (kiPicWidth, pCtx->pParam->iMaxWidth),
+                                   WELS_MAX (kiPicHeight, pCtx->pParam->iMaxHeight));
+  else
+    iErr = InitialDqLayersContext (pCtx, kiPicWidth, kiPicHeight);
   if (ERR_NONE != iErr) {
     WelsLog (pCtx, WELS_LOG_WARNING, "SyncPictureResolutionExt()::InitialDqLayersContext--buffer allocated failure.\n");
     pCtx->iErrorCode = dsOutOfMemory;
   }
 
+  // blocks of the former resolution not taken again go back to the system
+  pCtx->pMemAlign->WelsReleaseIdleBlocks();
+
   return iErr;
 }
 
@@ -38,10 +38,11 @@
 #include "decode_slice.h"
 #include "manage_dec_ref.h"
 #include "expand_pic.h"
+#include "output_format.h"
 #include "decoder.h"
 #include "decode_mb_aux.h"
-#include "mem_align.h"
 #include "error_concealment.h"
+#include "dec_multi_threading.h"
 
 namespace WelsDec {
 
@@ -88,6 +89,38 @@ static inline int32_t DecodeFrameConstruction (PWelsDecoderContext pCtx, uint8_t
              pCtx->sFrameCrop.iBottomOffset);
   }
 
+  if (NULL != pPic->sOutput.pDst[0]) {
+    SPicOutput* pOut = &pPic->sOutput;
+
+    // queued pictures get converted by the worker thread once reconstructed
+    if (NULL == pCtx->pThreadCtx)
+      ConvertPicOutputRemaining (&pCtx->sOutputFormatFunc, pPic);
+
+    ppDst[0] = pOut->pDst[0];
+    ppDst[1] = pOut->pDst[1];
+    ppDst[2] = pOut->pDst[2];
+    *pDstLen = pOut->iStride[0];
+    * (pDstLen + 1) = pOut->iStride[1];
+    *pWidth  = pOut->iWidth;
+    *pHeight = pOut->iHeight;
+
+    pDstInfo->UsrData.sSystemBuffer.iFormat = pOut->iFormat;
+    pDstInfo->UsrData.sSystemBuffer.iWidth = pOut->iWidth;
+    pDstInfo->UsrData.sSystemBuffer.iHeight = pOut->iHeight;
+    pDstInfo->UsrData.sSystemBuffer.iStride[0] = pOut->iStride[0];
+    pDstInfo->UsrData.sSystemBuffer.iStride[1] = pOut->iStride[1];
+    pDstInfo->pOpaque = pPic->pOpaque;
+    pDstInfo->iBufferStatus = 1;
+
+    if (pCtx->iErrorConMethod == ERROR_CON_DISABLE)
+      pDstInfo->iBufferStatus = (int32_t) bFrameCompleteFlag;
+    if (!bFrameCompleteFlag) {
+      pCtx->iErrorCode |= dsBitstreamError;
+      return -1;
+    }
+    return 0;
+  }
+
   //////output:::normal path
   ppDst[0]      = pPic->pData[0];
   ppDst[1]      = pPic->pData[1];
@@ -106,6 +139,7 @@ static inline int32_t DecodeFrameConstruction (PWelsDecoderContext pCtx, uint8_t
   ppDst[0] = ppDst[0] + pCtx->sFrameCrop.iTopOffset * 2 * pPic->iLinesize[0] + pCtx->sFrameCrop.iLeftOffset * 2;
   ppDst[1] = ppDst[1] + pCtx->sFrameCrop.iTopOffset  * pPic->iLinesize[1] + pCtx->sFrameCrop.iLeftOffset;
   ppDst[2] = ppDst[2] + pCtx->sFrameCrop.iTopOffset  * pPic->iLinesize[1] + pCtx->sFrameCrop.iLeftOffset;
+  pDstInfo->pOpaque = pPic->pOpaque;
   pDstInfo->iBufferStatus = 1;
 
   if (pCtx->iErrorConMethod == ERROR_CON_DISABLE) //no buffer output if EC is disabled and frame incomplete
@@ -154,8 +188,46 @@ inline void    HandleReferenceLost (PWelsDecoderContext pCtx, PNalUnit pCurNal)
   pCtx->iErrorCode |= dsRefLost;
 }
 
-inline int32_t  WelsDecodeConstructSlice (PWelsDecoderContext pCtx, PNalUnit pCurNal) {
-  int32_t  iRet = WelsTargetSliceConstruction (pCtx);
+inline int32_t  WelsDecodeConstructSlice (PWelsDecoderContext pCtx, PNalUnit pCurNal, const bool kbSliceJob) {
+  PDqLayer pCurLayer = pCtx->pCurDqLayer;
+  PSliceHeader pSliceHeader = &pCurLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader;
+  const int32_t kiTotalMbInCurSlice = pCurLayer->sLayerInfo.sSliceInLayer.iTotalMbInCurSlice;
+  int32_t  iRet = 0;
+
+  if (!pCtx->bAvcBasedFlag && (pCurLayer->iMbWidth << 4) != pCtx->iCurSeqIntervalMaxPicWidth) {
+    iRet = -1;
+  } else {
+    if (0 == pSliceHeader->iFirstMbInSlice) {
+      pCurLayer->pDec->iSpsId = pSliceHeader->iSpsId;
+      pCurLayer->pDec->iPpsId = pSliceHeader->iPpsId;
+
+      pCurLayer->pDec->uiQualityId = pCurLayer->sLayerInfo.sNalHeaderExt.uiQualityId;
+    }
+    pCurLayer->pDec->iWidthInPixel  = pCurLayer->iMbWidth << 4;
+    pCurLayer->pDec->iHeightInPixel = pCurLayer->iMbHeight << 4;
+    if (0 == pCtx->iTotalNumMbRec && 0 == GetSliceJobNum (pCtx)
+        && ERR_NONE != InitPicOutput (pCtx, pCurLayer->pDec, &pSliceHeader->pSps->sFrameCrop)) {
+      WelsLog (pCtx, WELS_LOG_ERROR, "WelsDecodeConstructSlice():::no memory for the output.\n");
+      pCtx->iErrorCode |= dsOutOfMemory;
+      return ERR_INFO_OUT_OF_MEMORY;
+    }
+
+    if (kbSliceJob) {
+      iRet = AddSliceJob (pCtx, pCurLayer, pCurNal);	// slice not parsed yet, MBs counted by FinishSliceJobs
+    } else if (NULL == pCtx->pThreadCtx) {
+      iRet = WelsTargetSliceConstruction (pCtx, pCurLayer, &pCtx->iTotalNumMbRec, false);
+    } else if (kiTotalMbInCurSlice > 1
+               && pCtx->iTotalNumMbRec + kiTotalMbInCurSlice - 1 > (int32_t)pSliceHeader->pSps->uiTotalMbCount) {
+      // same check as WelsTargetSliceConstruction, done ahead as the slice is reconstructed later
+      WelsLog (pCtx, WELS_LOG_WARNING, "WelsDecodeConstructSlice():::iTotalNumMbRec:%d, iTotalMbTargetLayer:%d\n",
+               pCtx->iTotalNumMbRec + kiTotalMbInCurSlice, pSliceHeader->pSps->uiTotalMbCount);
+      iRet = -1;
+    } else {
+      iRet = AddSliceTask (pCtx, pCurLayer);
+      if (ERR_NONE == iRet)
+        pCtx->iTotalNumMbRec += kiTotalMbInCurSlice;
+    }
+  }
 
   if (iRet) {
     HandleReferenceLostL0 (pCtx, pCurNal);
@@ -164,6 +236,16 @@ inline int32_t  WelsDecodeConstructSlice (PWelsDecoderContext pCtx, PNalUnit pCu
   return iRet;
 }
 
+/* wait for the slices handed to the slice threads, failures handled as for slices decoded in this thread */
+static inline int32_t WelsFinishSliceJobs (PWelsDecoderContext pCtx) {
+  PNalUnit pErrNal = NULL;
+  const int32_t kiRet = FinishSliceJobs (pCtx, false, &pErrNal);
+
+  if (ERR_NONE != kiRet)
+    HandleReferenceLostL0 (pCtx, pErrNal);
+  return kiRet;
+}
+
 /*
  *	Predeclared function routines ..
  */
@@ -315,10 +397,10 @@ int32_t WelsInitMemory (PWelsDecoderContext pCtx) {
     return ERR_INFO_INVALID_PTR;
   }
 
-  if (MemInitNalList (&pCtx->pAccessUnitList, MAX_NAL_UNIT_NUM_IN_AU) != 0)
+  if (MemInitNalList (&pCtx->pAccessUnitList, MAX_NAL_UNIT_NUM_IN_AU, pCtx->pMemAlign) != 0)
     return ERR_INFO_OUT_OF_MEMORY;
 
-  if ((pCtx->sRawData.pHead = static_cast<uint8_t*> (WelsMalloc (MAX_ACCESS_UNIT_CAPACITY,
+  if ((pCtx->sRawData.pHead = static_cast<uint8_t*> (pCtx->pMemAlign->WelsMallocz (MAX_ACCESS_UNIT_CAPACITY,
                               "pCtx->sRawData->pHead"))) == NULL) {
     return ERR_INFO_OUT_OF_MEMORY;
   }
@@ -344,15 +426,15 @@ void WelsFreeMemory (PWelsDecoderContext pCtx) {
     return;
 
   if (NULL != pCtx->pParam) {
-    WelsFree (pCtx->pParam, "pCtx->pParam");
+    pCtx->pMemAlign->WelsFree (pCtx->pParam, "pCtx->pParam");
 
     pCtx->pParam = NULL;
   }
 
-  MemFreeNalList (&pCtx->pAccessUnitList);
+  MemFreeNalList (&pCtx->pAccessUnitList, pCtx->pMemAlign);
 
   if (pCtx->sRawData.pHead) {
-    WelsFree (pCtx->sRawData.pHead, "pCtx->sRawData->pHead");
+    pCtx->pMemAlign->WelsFree (pCtx->sRawData.pHead, "pCtx->sRawData->pHead");
   }
   pCtx->sRawData.pHead                = NULL;
   pCtx->sRawData.pEnd                 = NULL;
@@ -929,50 +1011,52 @@ int32_t InitialDqLayersContext (PWelsDecoderContext pCtx, const int32_t kiMaxWid
   UninitialDqLayersContext (pCtx);
 
   do {
-    PDqLayer pDq = (PDqLayer)WelsMalloc (sizeof (SDqLayer), "PDqLayer");
+    PDqLayer pDq = (PDqLayer)pCtx->pMemAlign->WelsMallocz (sizeof (SDqLayer), "PDqLayer");
 
     if (pDq == NULL)
       return ERR_INFO_OUT_OF_MEMORY;
 
     memset (pDq, 0, sizeof (SDqLayer));
 
-    pCtx->sMb.pMbType[i] = (int8_t*)WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
+    // arrays an MB writes before reading them itself need no clearing; those read for neighbouring MBs, which may
+    // belong to a slice lost in the first picture, are cleared, e.g. pLumaQp indexes the deblocking tables
+    pCtx->sMb.pMbType[i] = (int8_t*)pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
                            "pCtx->sMb.pMbType[]");
-    pCtx->sMb.pMv[i][0] = (int16_t (*)[16][2])WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
+    pCtx->sMb.pMv[i][0] = (int16_t (*)[16][2])pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
                             int16_t) * MV_A * MB_BLOCK4x4_NUM, "pCtx->sMb.pMv[][]");
-    pCtx->sMb.pRefIndex[i][0] = (int8_t (*)[MB_BLOCK4x4_NUM])WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
+    pCtx->sMb.pRefIndex[i][0] = (int8_t (*)[MB_BLOCK4x4_NUM])pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
                                   int8_t) * MB_BLOCK4x4_NUM, "pCtx->sMb.pRefIndex[][]");
-    pCtx->sMb.pLumaQp[i] = (int8_t*)WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
+    pCtx->sMb.pLumaQp[i] = (int8_t*)pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
                            "pCtx->sMb.pLumaQp[]");
-    pCtx->sMb.pChromaQp[i] = (int8_t*)WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
+    pCtx->sMb.pChromaQp[i] = (int8_t*)pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
                              "pCtx->sMb.pChromaQp[]");
-    pCtx->sMb.pNzc[i] = (int8_t (*)[24])WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t) * 24,
+    pCtx->sMb.pNzc[i] = (int8_t (*)[24])pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t) * 24,
                         "pCtx->sMb.pNzc[]");
-    pCtx->sMb.pNzcRs[i] = (int8_t (*)[24])WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t) * 24,
+    pCtx->sMb.pNzcRs[i] = (int8_t (*)[24])pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t) * 24,
                           "pCtx->sMb.pNzcRs[]");
-    pCtx->sMb.pScaledTCoeff[i] = (int16_t (*)[MB_COEFF_LIST_SIZE])WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight *
+    pCtx->sMb.pScaledTCoeff[i] = (int16_t (*)[MB_COEFF_LIST_SIZE])pCtx->pMemAlign->WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight *
                                  sizeof (int16_t) * MB_COEFF_LIST_SIZE, "pCtx->sMb.pScaledTCoeff[]");
-    pCtx->sMb.pIntraPredMode[i] = (int8_t (*)[8])WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t) * 8,
+    pCtx->sMb.pIntraPredMode[i] = (int8_t (*)[8])pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t) * 8,
                                   "pCtx->sMb.pIntraPredMode[]");
-    pCtx->sMb.pIntra4x4FinalMode[i] = (int8_t (*)[MB_BLOCK4x4_NUM])WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight *
+    pCtx->sMb.pIntra4x4FinalMode[i] = (int8_t (*)[MB_BLOCK4x4_NUM])pCtx->pMemAlign->WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight *
                                       sizeof (int8_t) * MB_BLOCK4x4_NUM, "pCtx->sMb.pIntra4x4FinalMode[]");
-    pCtx->sMb.pChromaPredMode[i] = (int8_t*)WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
+    pCtx->sMb.pChromaPredMode[i] = (int8_t*)pCtx->pMemAlign->WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
                                    "pCtx->sMb.pChromaPredMode[]");
-    pCtx->sMb.pCbp[i] = (int8_t*)WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
+    pCtx->sMb.pCbp[i] = (int8_t*)pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
                         "pCtx->sMb.pCbp[]");
-    pCtx->sMb.pSubMbType[i] = (int8_t (*)[MB_PARTITION_SIZE])WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
+    pCtx->sMb.pSubMbType[i] = (int8_t (*)[MB_PARTITION_SIZE])pCtx->pMemAlign->WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
                                 int8_t) * MB_PARTITION_SIZE, "pCtx->sMb.pSubMbType[]");
-    pCtx->sMb.pSliceIdc[i] = (int32_t*) WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int32_t),
+    pCtx->sMb.pSliceIdc[i] = (int32_t*) pCtx->pMemAlign->WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int32_t),
                              "pCtx->sMb.pSliceIdc[]");	// using int32_t for slice_idc, 4/21/2010
     if (pCtx->sMb.pSliceIdc[i] != NULL)
       memset (pCtx->sMb.pSliceIdc[i], 0xff, (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int32_t)));
-    pCtx->sMb.pResidualPredFlag[i] = (int8_t*) WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
+    pCtx->sMb.pResidualPredFlag[i] = (int8_t*) pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
                                      "pCtx->sMb.pResidualPredFlag[]");
     //pCtx->sMb.pMotionPredFlag[i] = (uint8_t *) WelsMalloc(pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof(uint8_t), "pCtx->sMb.pMotionPredFlag[]");
-    pCtx->sMb.pInterPredictionDoneFlag[i] = (int8_t*) WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
+    pCtx->sMb.pInterPredictionDoneFlag[i] = (int8_t*) pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
         int8_t), "pCtx->sMb.pInterPredictionDoneFlag[]");
 
-    pCtx->sMb.pMbCorrectlyDecodedFlag[i] = (bool*) WelsMalloc (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (bool), "pCtx->sMb.pMbCorrectlyDecodedFlag[]");
+    pCtx->sMb.pMbCorrectlyDecodedFlag[i] = (bool*) pCtx->pMemAlign->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (bool), "pCtx->sMb.pMbCorrectlyDecodedFlag[]");
 
     // check memory block valid due above allocated..
     WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY,
@@ -1019,73 +1103,73 @@ void UninitialDqLayersContext (PWelsDecoderContext pCtx) {
     }
 
     if (pCtx->sMb.pMbType[i]) {
-      WelsFree (pCtx->sMb.pMbType[i], "pCtx->sMb.pMbType[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pMbType[i], "pCtx->sMb.pMbType[]");
 
       pCtx->sMb.pMbType[i] = NULL;
     }
 
     if (pCtx->sMb.pMv[i][0]) {
-      WelsFree (pCtx->sMb.pMv[i][0], "pCtx->sMb.pMv[][]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pMv[i][0], "pCtx->sMb.pMv[][]");
 
       pCtx->sMb.pMv[i][0] = NULL;
     }
 
     if (pCtx->sMb.pRefIndex[i][0]) {
-      WelsFree (pCtx->sMb.pRefIndex[i][0], "pCtx->sMb.pRefIndex[][]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pRefIndex[i][0], "pCtx->sMb.pRefIndex[][]");
 
       pCtx->sMb.pRefIndex[i][0] = NULL;
     }
 
     if (pCtx->sMb.pLumaQp[i]) {
-      WelsFree (pCtx->sMb.pLumaQp[i], "pCtx->sMb.pLumaQp[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pLumaQp[i], "pCtx->sMb.pLumaQp[]");
 
       pCtx->sMb.pLumaQp[i] = NULL;
     }
 
     if (pCtx->sMb.pChromaQp[i]) {
-      WelsFree (pCtx->sMb.pChromaQp[i], "pCtx->sMb.pChromaQp[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pChromaQp[i], "pCtx->sMb.pChromaQp[]");
 
       pCtx->sMb.pChromaQp[i] = NULL;
     }
 
     if (pCtx->sMb.pNzc[i]) {
-      WelsFree (pCtx->sMb.pNzc[i], "pCtx->sMb.pNzc[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pNzc[i], "pCtx->sMb.pNzc[]");
 
       pCtx->sMb.pNzc[i] = NULL;
     }
 
     if (pCtx->sMb.pNzcRs[i]) {
-      WelsFree (pCtx->sMb.pNzcRs[i], "pCtx->sMb.pNzcRs[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pNzcRs[i], "pCtx->sMb.pNzcRs[]");
 
       pCtx->sMb.pNzcRs[i] = NULL;
     }
 
     if (pCtx->sMb.pScaledTCoeff[i]) {
-      WelsFree (pCtx->sMb.pScaledTCoeff[i], "pCtx->sMb.pScaledTCoeff[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pScaledTCoeff[i], "pCtx->sMb.pScaledTCoeff[]");
 
       pCtx->sMb.pScaledTCoeff[i] = NULL;
     }
 
     if (pCtx->sMb.pIntraPredMode[i]) {
-      WelsFree (pCtx->sMb.pIntraPredMode[i], "pCtx->sMb.pIntraPredMode[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pIntraPredMode[i], "pCtx->sMb.pIntraPredMode[]");
 
       pCtx->sMb.pIntraPredMode[i] = NULL;
     }
 
     if (pCtx->sMb.pIntra4x4FinalMode[i]) {
-      WelsFree (pCtx->sMb.pIntra4x4FinalMode[i], "pCtx->sMb.pIntra4x4FinalMode[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pIntra4x4FinalMode[i], "pCtx->sMb.pIntra4x4FinalMode[]");
 
       pCtx->sMb.pIntra4x4FinalMode[i] = NULL;
     }
 
     if (pCtx->sMb.pChromaPredMode[i]) {
-      WelsFree (pCtx->sMb.pChromaPredMode[i], "pCtx->sMb.pChromaPredMode[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pChromaPredMode[i], "pCtx->sMb.pChromaPredMode[]");
 
       pCtx->sMb.pChromaPredMode[i] = NULL;
     }
 
     if (pCtx->sMb.pCbp[i]) {
-      WelsFree (pCtx->sMb.pCbp[i], "pCtx->sMb.pCbp[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pCbp[i], "pCtx->sMb.pCbp[]");
 
       pCtx->sMb.pCbp[i] = NULL;
     }
@@ -1098,35 +1182,35 @@ void UninitialDqLayersContext (PWelsDecoderContext pCtx) {
     //}
 
     if (pCtx->sMb.pSubMbType[i]) {
-      WelsFree (pCtx->sMb.pSubMbType[i], "pCtx->sMb.pSubMbType[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pSubMbType[i], "pCtx->sMb.pSubMbType[]");
 
       pCtx->sMb.pSubMbType[i] = NULL;
     }
 
     if (pCtx->sMb.pSliceIdc[i]) {
-      WelsFree (pCtx->sMb.pSliceIdc[i], "pCtx->sMb.pSliceIdc[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pSliceIdc[i], "pCtx->sMb.pSliceIdc[]");
 
       pCtx->sMb.pSliceIdc[i] = NULL;
     }
 
     if (pCtx->sMb.pResidualPredFlag[i]) {
-      WelsFree (pCtx->sMb.pResidualPredFlag[i], "pCtx->sMb.pResidualPredFlag[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pResidualPredFlag[i], "pCtx->sMb.pResidualPredFlag[]");
 
       pCtx->sMb.pResidualPredFlag[i] = NULL;
     }
 
     if (pCtx->sMb.pInterPredictionDoneFlag[i]) {
-      WelsFree (pCtx->sMb.pInterPredictionDoneFlag[i], "pCtx->sMb.pInterPredictionDoneFlag[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pInterPredictionDoneFlag[i], "pCtx->sMb.pInterPredictionDoneFlag[]");
 
       pCtx->sMb.pInterPredictionDoneFlag[i] = NULL;
     }
 
     if (pCtx->sMb.pMbCorrectlyDecodedFlag[i]) {
-      WelsFree (pCtx->sMb.pMbCorrectlyDecodedFlag[i], "pCtx->sMb.pMbCorrectlyDecodedFlag[]");
+      pCtx->pMemAlign->WelsFree (pCtx->sMb.pMbCorrectlyDecodedFlag[i], "pCtx->sMb.pMbCorrectlyDecodedFlag[]");
       pCtx->sMb.pMbCorrectlyDecodedFlag[i] = NULL;
     }
 
-    WelsFree (pDq, "pDq");
+    pCtx->pMemAlign->WelsFree (pDq, "pDq");
 
     pDq = NULL;
     pCtx->pDqLayersList[i] = NULL;
@@ -1583,6 +1667,8 @@ int32_t ConstructAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, SBufferI
   //try to allocate or relocate DPB memory only when IDR arrival.
   if (NAL_UNIT_CODED_SLICE_IDR == pCurAu->pNalUnitsList[pCurAu->uiStartPos]->sNalHeaderExt.sNalUnitHeader.eNalUnitType ||
       pCurAu->pNalUnitsList[pCurAu->uiStartPos]->sNalHeaderExt.bIdrFlag) {
+    if (NULL != pCtx->pThreadCtx)
+      DrainFrameTasks (pCtx);
     WelsResetRefPic (pCtx); //clear ref pPic when IDR NAL
     iErr = SyncPictureResolutionExt (pCtx, pCtx->pSps->iMbWidth, pCtx->pSps->iMbHeight);
 
@@ -1595,6 +1681,12 @@ int32_t ConstructAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, SBufferI
 
 
   iErr = DecodeCurrentAccessUnit (pCtx, ppDst, iStride, &iWidth, &iHeight, pDstInfo);
+  if (NULL != pCtx->pThreadCtx)
+    CompleteFrameTask (pCtx);	// no-op unless the access unit was not submitted
+  if (NULL != pCtx->pSliceThreadCtx) {
+    PNalUnit pErrNal = NULL;
+    FinishSliceJobs (pCtx, true, &pErrNal);	// no-op unless decoding stopped in the middle of a picture
+  }
 
   WelsDecodeAccessUnitEnd (pCtx);
   pCtx->bNewSeqBegin = false;
@@ -1691,6 +1783,8 @@ void InitCurDqLayerData (PWelsDecoderContext pCtx, PDqLayer pCurDq) {
     pCurDq->pInterPredictionDoneFlag = pCtx->sMb.pInterPredictionDoneFlag[0];
     pCurDq->pResidualPredFlag = pCtx->sMb.pResidualPredFlag[0];
     pCurDq->pMbCorrectlyDecodedFlag = pCtx->sMb.pMbCorrectlyDecodedFlag[0];
+    pCurDq->pRefPicList		= pCtx->sRefPic.pRefList[LIST_0];
+    pCurDq->pRefReadyLines	= NULL;
   }
 }
 
@@ -1732,6 +1826,14 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, int3
   }
 
   InitCurDqLayerData (pCtx, pCtx->pCurDqLayer);
+  if (NULL != pCtx->pThreadCtx) {
+    // MB arrays and output of this access unit are owned by a frame task till it is reconstructed
+    iRet = PrepareFrameTask (pCtx, &ppDst, &pDstInfo);
+    if (ERR_NONE != iRet) {
+      pCtx->iErrorCode |= dsOutOfMemory;
+      return iRet;
+    }
+  }
 
   pNalCur = pCurAu->pNalUnitsList[iIdx];
   while (iIdx <= iEndIdx) {
@@ -1740,6 +1842,10 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, int3
     PSliceHeaderExt pShExt					= NULL;
     PSliceHeader pSh							= NULL;
 
+    // a frame output from a buffer of the application is never overwritten, the next one takes another picture
+    if (NULL != pCtx->pDec && pCtx->pDec == pCtx->pPreviousDecodedPictureInDpb
+        && NULL != pCtx->sBufferProvider.pGetBuffer)
+      pCtx->pDec = NULL;
     if (pCtx->pDec == NULL) {
       pCtx->pDec = PrefetchPic (pCtx->pPicBuff[0]);
 
@@ -1763,11 +1869,29 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, int3
     pCtx->iTotalNumMbRec = 0;
 #endif
     if (pCtx->iTotalNumMbRec == 0) { //Picture start to decode
-      for (int32_t i = 0; i < LAYER_NUM_EXCHANGEABLE; ++ i)
-        memset (pCtx->sMb.pSliceIdc[i], 0xff, (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int32_t)));
+      if (NULL != pCtx->sBufferProvider.pGetBuffer) {
+        iRet = RenewPictureBuffer (pCtx, pCtx->pDec);
+        if (ERR_NONE != iRet) {
+          WelsLog (pCtx, WELS_LOG_ERROR, "DecodeCurrentAccessUnit()::::::no picture buffer from the application.\n");
+          pCtx->iErrorCode |= dsOutOfMemory;
+          return iRet;
+        }
+      }
+      memset (pCtx->pCurDqLayer->pSliceIdc, 0xff, (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int32_t)));
       memset (pCtx->pCurDqLayer->pMbCorrectlyDecodedFlag, 0, pCtx->pSps->iMbWidth * pCtx->pSps->iMbHeight);
+      pCtx->pDec->iDeblockedMbs	= 0;
+      pCtx->pDec->iExpandedLines	= 0;
+    }
+    if (NULL == pCtx->pThreadCtx) {
+      GetI4LumaIChromaAddrTable (pCtx->iDecBlockOffsetArray, pCtx->pDec->iLinesize[0], pCtx->pDec->iLinesize[1]);
+    } else {
+      int32_t iBlockOffset[24];
+      GetI4LumaIChromaAddrTable (iBlockOffset, pCtx->pDec->iLinesize[0], pCtx->pDec->iLinesize[1]);
+      if (memcmp (iBlockOffset, pCtx->iDecBlockOffsetArray, sizeof (iBlockOffset))) {
+        DrainFrameTasks (pCtx);	// table is shared with the reconstruction of queued frames
+        memcpy (pCtx->iDecBlockOffsetArray, iBlockOffset, sizeof (iBlockOffset));
+      }
     }
-    GetI4LumaIChromaAddrTable (pCtx->iDecBlockOffsetArray, pCtx->pDec->iLinesize[0], pCtx->pDec->iLinesize[1]);
 
     if (pNalCur->sNalHeaderExt.uiLayerDqId > kuiTargetLayerDqId) { // confirmed pNalCur will never be NULL
       break;	// Per formance it need not to decode the remaining bits any more due to given uiLayerDqId required, 9/2/2009
@@ -1780,6 +1904,7 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, int3
      */
     while (iIdx <= iEndIdx) {
       bool         bReconstructSlice;
+      bool         bSliceJob;
       iCurrIdQ	= pNalCur->sNalHeaderExt.uiQualityId;
       iCurrIdD	= pNalCur->sNalHeaderExt.uiDependencyId;
       pSh		= &pNalCur->sNalData.sVclNal.sSliceHeaderExt.sSliceHeader;
@@ -1806,12 +1931,13 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, int3
       pLayerInfo.pSubsetSps = pShExt->pSubsetSps;
 
       pCtx->pFmo = &pCtx->sFmoList[iPpsId];
-      if (!FmoParamUpdate (pCtx->pFmo, pLayerInfo.pSps, pLayerInfo.pPps, &pCtx->iActiveFmoNum)) {
+      if (!FmoParamUpdate (pCtx->pFmo, pLayerInfo.pSps, pLayerInfo.pPps, &pCtx->iActiveFmoNum, pCtx->pMemAlign)) {
         pCtx->iErrorCode |= dsBitstreamError;
         WelsLog (pCtx, WELS_LOG_WARNING, "DecodeCurrentAccessUnit(), FmoParamUpdate failed, eSliceType: %d.\n",
                  pSh->eSliceType);
         return GENERATE_ERROR_NO (ERR_LEVEL_SLICE_HEADER, ERR_INFO_FMO_INIT_FAIL);
       }
+      dq_cur->pFmo = pCtx->pFmo;
 
       bFreshSliceAvailable	= (iCurrIdD != iLastIdD
                                || iCurrIdQ != iLastIdQ);	// do not need condition of (first_mb == 0) due multiple slices might be disorder
@@ -1860,19 +1986,38 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, int3
           }
         }
 
-        iRet = WelsDecodeSlice (pCtx, bFreshSliceAvailable, pNalCur);
-
-        //Output good store_base reconstruction when enhancement quality layer occurred error for MGS key picture case
-        if (iRet != ERR_NONE) {
-          WelsLog (pCtx, WELS_LOG_WARNING, "DecodeCurrentAccessUnit() failed (%d) in frame: %d uiDId: %d uiQId: %d\n",
-                   iRet, pSh->iFrameNum, iCurrIdD, iCurrIdQ);
-          HandleReferenceLostL0 (pCtx, pNalCur);
-          return iRet;
-        }
-        if (bReconstructSlice)	{
-          if (WelsDecodeConstructSlice (pCtx, pNalCur)) {
+        // target layer pictures of several slices get them parsed and reconstructed concurrently, FMO excepted;
+        // a slice not starting after those queued (corrupt first_mb_in_slice) goes in sequence after them
+        bSliceJob = bReconstructSlice && NULL != pCtx->pSliceThreadCtx && NULL == pCtx->pThreadCtx
+                    && 1 == pLayerInfo.pPps->uiNumSliceGroups && pSh->iFirstMbInSlice >= GetSliceJobMinFirstMb (pCtx)
+                    && (GetSliceJobNum (pCtx) > 0 || (iIdx < iEndIdx
+                        && iCurrIdD == pCurAu->pNalUnitsList[iIdx + 1]->sNalHeaderExt.uiDependencyId
+                        && iCurrIdQ == pCurAu->pNalUnitsList[iIdx + 1]->sNalHeaderExt.uiQualityId));
+        if (bSliceJob) {
+          if (WelsDecodeConstructSlice (pCtx, pNalCur, true)) {
             return -1;
           }
+        } else {
+          if (GetSliceJobNum (pCtx) > 0) {
+            iRet = WelsFinishSliceJobs (pCtx);	// FMO slices and misplaced ones go in sequence after them
+            if (iRet != ERR_NONE)
+              return iRet;
+          }
+
+          iRet = WelsDecodeSlice (pCtx, dq_cur, bFreshSliceAvailable, pNalCur);
+
+          //Output good store_base reconstruction when enhancement quality layer occurred error for MGS key picture case
+          if (iRet != ERR_NONE) {
+            WelsLog (pCtx, WELS_LOG_WARNING, "DecodeCurrentAccessUnit() failed (%d) in frame: %d uiDId: %d uiQId: %d\n",
+                     iRet, pSh->iFrameNum, iCurrIdD, iCurrIdQ);
+            HandleReferenceLostL0 (pCtx, pNalCur);
+            return iRet;
+          }
+          if (bReconstructSlice)	{
+            if (WelsDecodeConstructSlice (pCtx, pNalCur, false)) {
+              return -1;
+            }
+          }
         }
       }
 #if defined (_DEBUG) &&  !defined (CODEC_FOR_TESTBED)
@@ -1896,6 +2041,12 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, int3
         break;
     }
 
+    if (GetSliceJobNum (pCtx) > 0) {
+      iRet = WelsFinishSliceJobs (pCtx);
+      if (iRet != ERR_NONE)
+        return iRet;
+    }
+
     // A dq layer decoded here
 #if defined (_DEBUG) &&  !defined (CODEC_FOR_TESTBED)
 #undef fprintf
@@ -1920,14 +2071,20 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, int3
 
       pCtx->pPreviousDecodedPictureInDpb = pCtx->pDec; //store latest decoded picture for EC
 
+      // queued pictures get expanded by the worker thread once reconstructed
+      const bool kbQueued = (NULL != pCtx->pThreadCtx) && SubmitFrameTask (pCtx, uiNalRefIdc > 0);
+
       if (uiNalRefIdc > 0) {
         iRet = WelsMarkAsRef (pCtx);
         if (iRet != ERR_NONE) {
           pCtx->pDec = NULL;
           return iRet;
         }
-        ExpandReferencingPicture (pCtx->pDec, pCtx->sExpandPicFunc.pExpandLumaPicture,
-                                  pCtx->sExpandPicFunc.pExpandChromaPicture);
+        if (!kbQueued)
+          ExpandReferencingPictureRemaining (pCtx->pDec, pCtx->sExpandPicFunc.pExpandLumaPicture,
+                                             pCtx->sExpandPicFunc.pExpandChromaPicture);
+        pCtx->pDec = NULL;
+      } else if (kbQueued) {
         pCtx->pDec = NULL;
       }
     }
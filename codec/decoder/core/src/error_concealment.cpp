@@ -33,9 +33,11 @@
 
 #include "error_code.h"
 #include "expand_pic.h"
+#include "output_format.h"
 #include "manage_dec_ref.h"
 #include "copy_mb.h"
 #include "error_concealment.h"
+#include "dec_multi_threading.h"
 #include "cpu_core.h"
 
 namespace WelsDec {
@@ -174,6 +176,9 @@ void ImplementErrorCon (PWelsDecoderContext pCtx) {
   if (!NeedErrorCon (pCtx))
     return;
 
+  if (NULL != pCtx->pThreadCtx)
+    DrainFrameTasks (pCtx);	// source pictures may still be under reconstruction
+
   if (ERROR_CON_DISABLE == pCtx->iErrorConMethod) {
     pCtx->iErrorCode |= dsBitstreamError;
     return;
@@ -183,6 +188,10 @@ void ImplementErrorCon (PWelsDecoderContext pCtx) {
     DoErrorConSliceCopy (pCtx);
   } //TODO add other EC methods here in the future
 
+  // rows converted to the output format before concealment may have been incomplete
+  pCtx->pDec->sOutput.iLines = 0;
+  ConvertPicOutputRemaining (&pCtx->sOutputFormatFunc, pCtx->pDec);
+
   //mark the erroneous frame as Ref pic in DPB
   MarkECFrameAsRef (pCtx);
   //need update frame_num due current frame is well decoded
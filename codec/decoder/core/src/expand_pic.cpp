@@ -117,6 +117,35 @@ static inline void ExpandPictureChroma_c (uint8_t* pDst, const int32_t kiStride,
   } while (i < kiPicHeight);
 }
 
+/* pad lines [kiStartLine, kiEndLine) left and right, the top border from line 0, the bottom one from the last line */
+static void ExpandPictureLines_c (uint8_t* pDst, const int32_t kiStride, const int32_t kiPicWidth,
+                                  const int32_t kiPicHeight, const int32_t kiPaddingLen,
+                                  const int32_t kiStartLine, const int32_t kiEndLine) {
+  uint8_t* pTmp	= pDst + kiStartLine * kiStride;
+  int32_t i		= kiStartLine;
+
+  if (kiEndLine <= kiStartLine)
+    return;
+
+  for (; i < kiEndLine; ++ i) {
+    memset (pTmp - kiPaddingLen, pTmp[0], kiPaddingLen);
+    memset (pTmp + kiPicWidth, pTmp[kiPicWidth - 1], kiPaddingLen);
+    pTmp += kiStride;
+  }
+
+  // line 0 and the last line are padded already, copy them with their corners
+  if (0 == kiStartLine) {
+    for (i = 1; i <= kiPaddingLen; ++ i)
+      memcpy (pDst - i * kiStride - kiPaddingLen, pDst - kiPaddingLen, kiPicWidth + (kiPaddingLen << 1));
+  }
+  if (kiPicHeight == kiEndLine) {
+    uint8_t* pDstLastLine = pDst + (kiPicHeight - 1) * kiStride;
+    for (i = 1; i <= kiPaddingLen; ++ i)
+      memcpy (pDstLastLine + i * kiStride - kiPaddingLen, pDstLastLine - kiPaddingLen,
+              kiPicWidth + (kiPaddingLen << 1));
+  }
+}
+
 void InitExpandPictureFunc (SExpandPicFunc* pExpandPicFunc, const uint32_t kuiCpuFlags) {
   pExpandPicFunc->pExpandLumaPicture	= ExpandPictureLuma_c;
   pExpandPicFunc->pExpandChromaPicture[0] = ExpandPictureChroma_c;
@@ -154,4 +183,29 @@ void ExpandReferencingPicture (PPicture pPic, PExpandPictureFunc pExpLuma, PExpa
   }
 }
 
+void ExpandReferencingPictureLines (PPicture pPic, const int32_t kiEndLine) {
+  const int32_t kiWidthY	= pPic->iWidthInPixel;
+  const int32_t kiHeightY	= pPic->iHeightInPixel;
+  const int32_t kiStartLine	= pPic->iExpandedLines;
+  const int32_t kiEndLineY	= WELS_MIN (kiEndLine, kiHeightY);
+
+  if (kiEndLineY <= kiStartLine)
+    return;
+
+  ExpandPictureLines_c (pPic->pData[0], pPic->iLinesize[0], kiWidthY, kiHeightY, PADDING_LENGTH,
+                        kiStartLine, kiEndLineY);
+  ExpandPictureLines_c (pPic->pData[1], pPic->iLinesize[1], kiWidthY >> 1, kiHeightY >> 1, PADDING_LENGTH >> 1,
+                        kiStartLine >> 1, kiEndLineY >> 1);
+  ExpandPictureLines_c (pPic->pData[2], pPic->iLinesize[2], kiWidthY >> 1, kiHeightY >> 1, PADDING_LENGTH >> 1,
+                        kiStartLine >> 1, kiEndLineY >> 1);
+  pPic->iExpandedLines = kiEndLineY;
+}
+
+void ExpandReferencingPictureRemaining (PPicture pPic, PExpandPictureFunc pExpLuma, PExpandPictureFunc pExpChroma[2]) {
+  if (pPic->iExpandedLines > 0)
+    ExpandReferencingPictureLines (pPic, pPic->iHeightInPixel);
+  else
+    ExpandReferencingPicture (pPic, pExpLuma, pExpChroma);
+}
+
 } // namespace WelsDec
@@ -652,6 +652,191 @@ void McChroma_sse2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int3
 }
 
 #endif //X86_ASM
+
+#if defined(X86_INTRINSICS)
+//***************************************************************************//
+//                       AVX2 implement                                      //
+//***************************************************************************//
+// copies, averages and 4-pixel wide blocks keep the MMX/SSE2 paths, or C without nasm
+static inline void PixelAvg_avx2 (uint8_t* pDst, int32_t iDstStride, const uint8_t* pSrcA, int32_t iSrcAStride,
+                                  const uint8_t* pSrcB, int32_t iSrcBStride, int32_t iWidth, int32_t iHeight) {
+#if defined(X86_ASM)
+  if (iWidth == 16)
+    PixelAvgWidthEq16_sse2 (pDst, iDstStride, pSrcA, iSrcAStride, pSrcB, iSrcBStride, iHeight);
+  else if (iWidth == 8)
+    PixelAvgWidthEq8_mmx (pDst, iDstStride, pSrcA, iSrcAStride, pSrcB, iSrcBStride, iHeight);
+  else
+    PixelAvgWidthEq4_mmx (pDst, iDstStride, pSrcA, iSrcAStride, pSrcB, iSrcBStride, iHeight);
+#else
+  PixelAvg_c (pDst, iDstStride, pSrcA, iSrcAStride, pSrcB, iSrcBStride, iWidth, iHeight);
+#endif//X86_ASM
+}
+
+static inline void McCopy_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                int32_t iWidth, int32_t iHeight) {
+#if defined(X86_ASM)
+  McCopy_sse2 (pSrc, iSrcStride, pDst, iDstStride, iWidth, iHeight);
+#else
+  McCopy_c (pSrc, iSrcStride, pDst, iDstStride, iWidth, iHeight);
+#endif//X86_ASM
+}
+
+static inline void McHorVer20_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  if (iWidth == 16)
+    McHorVer20WidthEq16_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+  else if (iWidth == 8)
+    McHorVer20WidthEq8_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+  else
+#if defined(X86_ASM)
+    McHorVer20WidthEq4_mmx (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+#else
+    McHorVer20_c (pSrc, iSrcStride, pDst, iDstStride, 4, iHeight);
+#endif//X86_ASM
+}
+
+static inline void McHorVer02_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  if (iWidth == 16)
+    McHorVer02WidthEq16_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+  else if (iWidth == 8)
+    McHorVer02WidthEq8_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+  else
+    McHorVer02_c (pSrc, iSrcStride, pDst, iDstStride, 4, iHeight);
+}
+
+static inline void McHorVer22_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  if (iWidth == 16)
+    McHorVer22WidthEq16_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+  else if (iWidth == 8)
+    McHorVer22WidthEq8_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+  else
+    McHorVer22_c (pSrc, iSrcStride, pDst, iDstStride, 4, iHeight);
+}
+
+static inline void McHorVer01_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pTmp, 256, 16);
+  McHorVer02_avx2 (pSrc, iSrcStride, pTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pSrc, iSrcStride, pTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer03_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pTmp, 256, 16);
+  McHorVer02_avx2 (pSrc, iSrcStride, pTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pSrc + iSrcStride, iSrcStride, pTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer10_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pTmp, 256, 16);
+  McHorVer20_avx2 (pSrc, iSrcStride, pTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pSrc, iSrcStride, pTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer11_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pHorTmp, 256, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pVerTmp, 256, 16);
+  McHorVer20_avx2 (pSrc, iSrcStride, pHorTmp, 16, iWidth, iHeight);
+  McHorVer02_avx2 (pSrc, iSrcStride, pVerTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pHorTmp, 16, pVerTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer12_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pVerTmp, 256, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pCtrTmp, 256, 16);
+  McHorVer02_avx2 (pSrc, iSrcStride, pVerTmp, 16, iWidth, iHeight);
+  McHorVer22_avx2 (pSrc, iSrcStride, pCtrTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pVerTmp, 16, pCtrTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer13_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pHorTmp, 256, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pVerTmp, 256, 16);
+  McHorVer20_avx2 (pSrc + iSrcStride, iSrcStride, pHorTmp, 16, iWidth, iHeight);
+  McHorVer02_avx2 (pSrc, iSrcStride, pVerTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pHorTmp, 16, pVerTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer21_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pHorTmp, 256, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pCtrTmp, 256, 16);
+  McHorVer20_avx2 (pSrc, iSrcStride, pHorTmp, 16, iWidth, iHeight);
+  McHorVer22_avx2 (pSrc, iSrcStride, pCtrTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pHorTmp, 16, pCtrTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer23_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pHorTmp, 256, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pCtrTmp, 256, 16);
+  McHorVer20_avx2 (pSrc + iSrcStride, iSrcStride, pHorTmp, 16, iWidth, iHeight);
+  McHorVer22_avx2 (pSrc, iSrcStride, pCtrTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pHorTmp, 16, pCtrTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer30_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pTmp, 256, 16);
+  McHorVer20_avx2 (pSrc, iSrcStride, pTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pSrc + 1, iSrcStride, pTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer31_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pHorTmp, 256, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pVerTmp, 256, 16);
+  McHorVer20_avx2 (pSrc, iSrcStride, pHorTmp, 16, iWidth, iHeight);
+  McHorVer02_avx2 (pSrc + 1, iSrcStride, pVerTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pHorTmp, 16, pVerTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer32_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pVerTmp, 256, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pCtrTmp, 256, 16);
+  McHorVer02_avx2 (pSrc + 1, iSrcStride, pVerTmp, 16, iWidth, iHeight);
+  McHorVer22_avx2 (pSrc, iSrcStride, pCtrTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pVerTmp, 16, pCtrTmp, 16, iWidth, iHeight);
+}
+static inline void McHorVer33_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                      int32_t iWidth, int32_t iHeight) {
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pHorTmp, 256, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, pVerTmp, 256, 16);
+  McHorVer20_avx2 (pSrc + iSrcStride, iSrcStride, pHorTmp, 16, iWidth, iHeight);
+  McHorVer02_avx2 (pSrc + 1, iSrcStride, pVerTmp, 16, iWidth, iHeight);
+  PixelAvg_avx2 (pDst, iDstStride, pHorTmp, 16, pVerTmp, 16, iWidth, iHeight);
+}
+
+void McLuma_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                  int16_t iMvX, int16_t iMvY, int32_t iWidth, int32_t iHeight)
+//pSrc has been added the offset of mv
+{
+  static const PWelsMcWidthHeightFunc pWelsMcFunc[4][4] = { //[x][y]
+    {McCopy_avx2,     McHorVer01_avx2, McHorVer02_avx2, McHorVer03_avx2},
+    {McHorVer10_avx2, McHorVer11_avx2, McHorVer12_avx2, McHorVer13_avx2},
+    {McHorVer20_avx2, McHorVer21_avx2, McHorVer22_avx2, McHorVer23_avx2},
+    {McHorVer30_avx2, McHorVer31_avx2, McHorVer32_avx2, McHorVer33_avx2},
+  };
+
+  pWelsMcFunc[iMvX & 0x03][iMvY & 0x03] (pSrc, iSrcStride, pDst, iDstStride, iWidth, iHeight);
+}
+
+void McChroma_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                    int16_t iMvX, int16_t iMvY, int32_t iWidth, int32_t iHeight) {
+  const int32_t kiD8x = iMvX & 0x07;
+  const int32_t kiD8y = iMvY & 0x07;
+  if (kiD8x == 0 && kiD8y == 0) {
+    McCopy_avx2 (pSrc, iSrcStride, pDst, iDstStride, iWidth, iHeight);
+    return;
+  }
+  if (iWidth == 8)
+    McChromaWidthEq8_avx2 (pSrc, iSrcStride, pDst, iDstStride, g_kuiABCD[kiD8y][kiD8x], iHeight);
+#if defined(X86_ASM)
+  else if (iWidth == 4)
+    McChromaWidthEq4_mmx (pSrc, iSrcStride, pDst, iDstStride, g_kuiABCD[kiD8y][kiD8x], iHeight);
+#endif//X86_ASM
+  else
+    McChromaWithFragMv_c (pSrc, iSrcStride, pDst, iDstStride, iMvX, iMvY, iWidth, iHeight);
+}
+
+#endif //X86_INTRINSICS
 //***************************************************************************//
 //                       NEON implementation                      //
 //***************************************************************************//
@@ -983,6 +1168,13 @@ void InitMcFunc (SMcFunc* pMcFunc, int32_t iCpu) {
   pMcFunc->pMcChromaFunc = McChroma_sse2;
   }
 #endif //(X86_ASM)
+
+#if defined(X86_INTRINSICS)
+  if (iCpu & WELS_CPU_AVX2) {
+    pMcFunc->pMcLumaFunc   = McLuma_avx2;
+    pMcFunc->pMcChromaFunc = McChroma_avx2;
+  }
+#endif //(X86_INTRINSICS)
 }
 
 } // namespace WelsDec
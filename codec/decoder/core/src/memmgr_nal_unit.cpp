@@ -39,11 +39,10 @@
  *
  *****************************************************************************/
 #include "memmgr_nal_unit.h"
-#include "mem_align.h"
 
 namespace WelsDec {
 
-int32_t MemInitNalList (PAccessUnit* ppAu, const uint32_t kuiSize) {
+int32_t MemInitNalList (PAccessUnit* ppAu, const uint32_t kuiSize, CMemoryAlign* pMa) {
   uint32_t uiIdx = 0;
   uint8_t* pBase = NULL, *pPtr = NULL;
   const uint32_t kuiSizeAu = sizeof (SAccessUnit);
@@ -55,10 +54,10 @@ int32_t MemInitNalList (PAccessUnit* ppAu, const uint32_t kuiSize) {
     return 1;
 
   if (*ppAu != NULL) {
-    MemFreeNalList (ppAu);
+    MemFreeNalList (ppAu, pMa);
   }
 
-  pBase = (uint8_t*)WelsMalloc (kuiCountSize, "Access Unit");
+  pBase = (uint8_t*)pMa->WelsMallocz (kuiCountSize, "Access Unit");
   if (pBase == NULL)
     return 1;
   pPtr = pBase;
@@ -81,11 +80,11 @@ int32_t MemInitNalList (PAccessUnit* ppAu, const uint32_t kuiSize) {
   return 0;
 }
 
-int32_t MemFreeNalList (PAccessUnit* ppAu) {
+int32_t MemFreeNalList (PAccessUnit* ppAu, CMemoryAlign* pMa) {
   if (ppAu != NULL) {
     PAccessUnit pAu = *ppAu;
     if (pAu != NULL) {
-      WelsFree (pAu, "Access Unit");
+      pMa->WelsFree (pAu, "Access Unit");
       *ppAu = NULL;
     }
   }
@@ -93,14 +92,14 @@ int32_t MemFreeNalList (PAccessUnit* ppAu) {
 }
 
 
-int32_t ExpandNalUnitList (PAccessUnit* ppAu, const int32_t kiOrgSize, const int32_t kiExpSize) {
+int32_t ExpandNalUnitList (PAccessUnit* ppAu, const int32_t kiOrgSize, const int32_t kiExpSize, CMemoryAlign* pMa) {
   if (kiExpSize <= kiOrgSize)
     return 1;
   else {
     PAccessUnit pTmp = NULL;
     int32_t iIdx = 0;
 
-    if (MemInitNalList (&pTmp, kiExpSize))	// request new list with expanding
+    if (MemInitNalList (&pTmp, kiExpSize, pMa))	// request new list with expanding
       return 1;
 
     do {
@@ -114,7 +113,7 @@ int32_t ExpandNalUnitList (PAccessUnit* ppAu, const int32_t kiOrgSize, const int
     pTmp->uiEndPos		    = (*ppAu)->uiEndPos;
     pTmp->bCompletedAuFlag	= (*ppAu)->bCompletedAuFlag;
 
-    MemFreeNalList (ppAu);	// free old list
+    MemFreeNalList (ppAu, pMa);	// free old list
     *ppAu = pTmp;
     return 0;
   }
@@ -125,13 +124,13 @@ int32_t ExpandNalUnitList (PAccessUnit* ppAu, const int32_t kiOrgSize, const int
  *	Get next NAL Unit for using.
  *	Need expand NAL Unit list if exceeding count number of available NAL Units withing an Access Unit
  */
-PNalUnit MemGetNextNal (PAccessUnit* ppAu) {
+PNalUnit MemGetNextNal (PAccessUnit* ppAu, CMemoryAlign* pMa) {
   PAccessUnit pAu = *ppAu;
   PNalUnit pNu = NULL;
 
   if (pAu->uiAvailUnitsNum >= pAu->uiCountUnitsNum) {	// need expand list
     const uint32_t kuiExpandingSize = pAu->uiCountUnitsNum + (MAX_NAL_UNIT_NUM_IN_AU >> 1);
-    if (ExpandNalUnitList (ppAu, pAu->uiCountUnitsNum, kuiExpandingSize))
+    if (ExpandNalUnitList (ppAu, pAu->uiCountUnitsNum, kuiExpandingSize, pMa))
       return NULL;	// out of memory
     pAu = *ppAu;
   }
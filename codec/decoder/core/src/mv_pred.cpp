@@ -46,7 +46,6 @@ namespace WelsDec {
 void PredPSkipMvFromNeighbor (PDqLayer pCurLayer, int16_t iMvp[2]) {
   bool bTopAvail, bLeftTopAvail, bRightTopAvail, bLeftAvail;
 
-  int32_t iCurSliceIdc, iTopSliceIdc, iLeftTopSliceIdc, iRightTopSliceIdc, iLeftSliceIdc;
   int32_t iLeftTopType, iRightTopType, iTopType, iLeftType;
   int32_t iCurX, iCurY, iCurXy, iLeftXy, iTopXy, iLeftTopXy, iRightTopXy = 0;
 
@@ -61,12 +60,10 @@ void PredPSkipMvFromNeighbor (PDqLayer pCurLayer, int16_t iMvp[2]) {
   iCurXy = pCurLayer->iMbXyIndex;
   iCurX  = pCurLayer->iMbX;
   iCurY  = pCurLayer->iMbY;
-  iCurSliceIdc = pCurLayer->pSliceIdc[iCurXy];
 
   if (iCurX != 0) {
     iLeftXy = iCurXy - 1;
-    iLeftSliceIdc = pCurLayer->pSliceIdc[iLeftXy];
-    bLeftAvail = (iLeftSliceIdc == iCurSliceIdc);
+    bLeftAvail = IsMbInCurSlice (pCurLayer, iLeftXy);
   } else {
     bLeftAvail = 0;
     bLeftTopAvail = 0;
@@ -74,19 +71,16 @@ void PredPSkipMvFromNeighbor (PDqLayer pCurLayer, int16_t iMvp[2]) {
 
   if (iCurY != 0) {
     iTopXy = iCurXy - pCurLayer->iMbWidth;
-    iTopSliceIdc = pCurLayer->pSliceIdc[iTopXy];
-    bTopAvail = (iTopSliceIdc == iCurSliceIdc);
+    bTopAvail = IsMbInCurSlice (pCurLayer, iTopXy);
     if (iCurX != 0) {
       iLeftTopXy = iTopXy - 1;
-      iLeftTopSliceIdc = pCurLayer->pSliceIdc[iLeftTopXy];
-      bLeftTopAvail = (iLeftTopSliceIdc  == iCurSliceIdc);
+      bLeftTopAvail = IsMbInCurSlice (pCurLayer, iLeftTopXy);
     } else {
       bLeftTopAvail = 0;
     }
     if (iCurX != (pCurLayer->iMbWidth - 1)) {
       iRightTopXy = iTopXy + 1;
-      iRightTopSliceIdc = pCurLayer->pSliceIdc[iRightTopXy];
-      bRightTopAvail = (iRightTopSliceIdc == iCurSliceIdc);
+      bRightTopAvail = IsMbInCurSlice (pCurLayer, iRightTopXy);
     } else {
       bRightTopAvail = 0;
     }
@@ -0,0 +1,395 @@
+/*!
+ * \copy
+ *     Copyright (c)  2014, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *	output_format.cpp:	conversion of decoded pictures to the output color format and size
+ *
+ *	RGB output follows BT.601 with video range YUV, chroma is upsampled by repeating samples. Downscaling is
+ *	bilinear, each output row blends the two source rows around its center.
+ */
+
+#include "codec_def.h"
+#include "output_format.h"
+#include "cpu_core.h"
+
+#if defined(X86_INTRINSICS)
+#include <emmintrin.h>
+#include "ls_defines.h"
+#endif//X86_INTRINSICS
+
+namespace WelsDec {
+
+bool IsOutputFormatSupported (const int32_t kiColorFormat) {
+  return kiColorFormat == videoFormatI420 || kiColorFormat == videoFormatInternal || kiColorFormat == videoFormatNV12
+         || kiColorFormat == videoFormatRGBA || kiColorFormat == videoFormatBGRA;
+}
+
+static inline bool IsRgbOutput (const SPicOutput* kpOut) {
+  return kpOut->iFormat == videoFormatRGBA || kpOut->iFormat == videoFormatBGRA;
+}
+
+static inline bool IsScaledOutput (const SPicOutput* kpOut) {
+  return kpOut->iWidth != kpOut->iSrcWidth || kpOut->iHeight != kpOut->iSrcHeight;
+}
+
+int32_t InitPicOutput (PWelsDecoderContext pCtx, PPicture pPic, const SPosOffset* pCrop) {
+  SPicOutput* pOut = &pPic->sOutput;
+  int32_t iSize;
+
+  pOut->iFormat		= (pCtx->iOutputColorFormat == videoFormatInternal) ? videoFormatI420 : pCtx->iOutputColorFormat;
+  pOut->iSrcX		= pCrop->iLeftOffset << 1;
+  pOut->iSrcY		= pCrop->iTopOffset << 1;
+  pOut->iSrcWidth	= pPic->iWidthInPixel - ((pCrop->iLeftOffset + pCrop->iRightOffset) << 1);
+  pOut->iSrcHeight	= pPic->iHeightInPixel - ((pCrop->iTopOffset + pCrop->iBottomOffset) << 1);
+  pOut->iWidth		= pOut->iSrcWidth;
+  pOut->iHeight		= pOut->iSrcHeight;
+  pOut->iLines		= 0;
+  if (pCtx->iOutputWidth > 0 && pCtx->iOutputHeight > 0) {
+    pOut->iWidth	= WELS_MIN (pCtx->iOutputWidth, pOut->iSrcWidth);
+    pOut->iHeight	= WELS_MIN (pCtx->iOutputHeight, pOut->iSrcHeight);
+    if (!IsRgbOutput (pOut)) {
+      pOut->iWidth	= WELS_MAX (pOut->iWidth & ~1, 2);
+      pOut->iHeight	= WELS_MAX (pOut->iHeight & ~1, 2);
+    }
+  }
+
+  memset (pOut->pDst, 0, sizeof (pOut->pDst));
+  memset (pOut->iStride, 0, sizeof (pOut->iStride));
+  memset (pOut->pRow, 0, sizeof (pOut->pRow));
+  if (pOut->iFormat == videoFormatI420 && !IsScaledOutput (pOut))
+    return ERR_NONE;	// the planes of the picture are output
+
+  if (IsRgbOutput (pOut)) {
+    pOut->iStride[0]	= WELS_ALIGN (pOut->iWidth << 2, 16);
+    iSize				= pOut->iStride[0] * pOut->iHeight;
+  } else {
+    pOut->iStride[0]	= WELS_ALIGN (pOut->iWidth, 16);
+    pOut->iStride[1]	= (pOut->iFormat == videoFormatNV12) ? pOut->iStride[0] : WELS_ALIGN (pOut->iWidth >> 1, 16);
+    pOut->iStride[2]	= (pOut->iFormat == videoFormatNV12) ? 0 : pOut->iStride[1];
+    iSize				= pOut->iStride[0] * pOut->iHeight + (pOut->iStride[1] + pOut->iStride[2]) * (pOut->iHeight >> 1);
+  }
+  if (IsScaledOutput (pOut))
+    iSize += WELS_ALIGN (pOut->iWidth, 16) + (WELS_ALIGN ((pOut->iWidth + 1) >> 1, 16) << 1);
+
+  if (pPic->iOutBufferSize < iSize) {
+    pCtx->pMemAlign->WelsFree (pPic->pOutBuffer, "pPic->pOutBuffer");
+    pPic->iOutBufferSize = 0;
+    pPic->pOutBuffer = static_cast<uint8_t*> (pCtx->pMemAlign->WelsMalloc (iSize, "pPic->pOutBuffer"));
+    WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == pPic->pOutBuffer);
+    pPic->iOutBufferSize = iSize;
+  }
+
+  pOut->pDst[0] = pPic->pOutBuffer;
+  if (!IsRgbOutput (pOut)) {
+    pOut->pDst[1] = pOut->pDst[0] + pOut->iStride[0] * pOut->iHeight;
+    if (pOut->iFormat == videoFormatI420)
+      pOut->pDst[2] = pOut->pDst[1] + pOut->iStride[1] * (pOut->iHeight >> 1);
+  }
+  if (IsScaledOutput (pOut)) {
+    pOut->pRow[0] = pPic->pOutBuffer + iSize - WELS_ALIGN (pOut->iWidth, 16) - (WELS_ALIGN ((pOut->iWidth + 1) >> 1, 16) << 1);
+    pOut->pRow[1] = pOut->pRow[0] + WELS_ALIGN (pOut->iWidth, 16);
+    pOut->pRow[2] = pOut->pRow[1] + WELS_ALIGN ((pOut->iWidth + 1) >> 1, 16);
+  }
+
+  return ERR_NONE;
+}
+
+static inline int32_t ScaleStep (const int32_t kiSrcSize, const int32_t kiDstSize) {
+  return (kiSrcSize << 16) / kiDstSize;
+}
+
+/* source position of the center of output sample kiIdx in 1/65536 */
+static inline int32_t ScalePos (const int32_t kiIdx, const int32_t kiStep, const int32_t kiSrcSize) {
+  const int32_t kiPos = kiIdx * kiStep + (kiStep >> 1) - (1 << 15);
+  return WELS_CLIP3 (kiPos, 0, (kiSrcSize - 1) << 16);
+}
+
+/* the two source rows output row kiIdx blends and the weight of the second in 1/256, returns the second row */
+static inline int32_t SourceRows (const int32_t kiIdx, const int32_t kiSrcSize, const int32_t kiDstSize,
+                                  int32_t* pRow0, int32_t* pFrac) {
+  int32_t iPos;
+
+  if (kiSrcSize == kiDstSize) {
+    *pRow0 = kiIdx;
+    *pFrac = 0;
+    return kiIdx;
+  }
+  iPos = ScalePos (kiIdx, ScaleStep (kiSrcSize, kiDstSize), kiSrcSize);
+  *pRow0 = iPos >> 16;
+  *pFrac = (iPos >> 8) & 0xff;
+  return (*pFrac > 0) ? WELS_MIN (*pRow0 + 1, kiSrcSize - 1) : *pRow0;
+}
+
+/* luma lines of the picture that have to be final to convert output row kiY */
+static int32_t SourceLinesOfRow (const SPicOutput* kpOut, const int32_t kiY) {
+  int32_t iRow0, iFrac;
+  const int32_t kiRowY = SourceRows (kiY, kpOut->iSrcHeight, kpOut->iHeight, &iRow0, &iFrac);
+  const int32_t kiRowC = SourceRows (kiY >> 1, kpOut->iSrcHeight >> 1, (kpOut->iHeight + 1) >> 1, &iRow0, &iFrac);
+
+  return WELS_MAX (kpOut->iSrcY + kiRowY + 1, ((kpOut->iSrcY >> 1) + kiRowC + 1) << 1);
+}
+
+static void ScalePlaneRow (SOutputFormatFunc* pFunc, uint8_t* pDst, const int32_t kiIdx, const uint8_t* pSrc,
+                           const int32_t kiStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
+                           const int32_t kiWidth, const int32_t kiHeight) {
+  int32_t iRow0, iFrac;
+  const int32_t kiRow1 = SourceRows (kiIdx, kiSrcHeight, kiHeight, &iRow0, &iFrac);
+
+  pFunc->pfScaleRow (pDst, kiWidth, pSrc + iRow0 * kiStride, pSrc + kiRow1 * kiStride, kiSrcWidth,
+                     ScaleStep (kiSrcWidth, kiWidth), iFrac);
+}
+
+static void ConvertPicOutputRow (SOutputFormatFunc* pFunc, PPicture pPic, const int32_t kiY) {
+  SPicOutput* pOut = &pPic->sOutput;
+  const bool kbRgb = IsRgbOutput (pOut);
+  const int32_t kiWidthC = (pOut->iWidth + 1) >> 1;
+  const int32_t kiHeightC = (pOut->iHeight + 1) >> 1;
+  const int32_t kiYc = kiY >> 1;
+  const uint8_t* pSrcY = pPic->pData[0] + pOut->iSrcY * pPic->iLinesize[0] + pOut->iSrcX;
+  const uint8_t* pSrcU = pPic->pData[1] + (pOut->iSrcY >> 1) * pPic->iLinesize[1] + (pOut->iSrcX >> 1);
+  const uint8_t* pSrcV = pPic->pData[2] + (pOut->iSrcY >> 1) * pPic->iLinesize[2] + (pOut->iSrcX >> 1);
+  const uint8_t* pY;
+  const uint8_t* pU;
+  const uint8_t* pV;
+
+  if (IsScaledOutput (pOut)) {
+    uint8_t* pRowY = kbRgb ? pOut->pRow[0] : pOut->pDst[0] + kiY * pOut->iStride[0];
+    uint8_t* pRowU = pOut->pRow[1];
+    uint8_t* pRowV = pOut->pRow[2];
+
+    if (pOut->iFormat == videoFormatI420) {
+      pRowU = pOut->pDst[1] + kiYc * pOut->iStride[1];
+      pRowV = pOut->pDst[2] + kiYc * pOut->iStride[2];
+    }
+    ScalePlaneRow (pFunc, pRowY, kiY, pSrcY, pPic->iLinesize[0], pOut->iSrcWidth, pOut->iSrcHeight, pOut->iWidth,
+                   pOut->iHeight);
+    if (0 == (kiY & 1)) {	// odd rows share the chroma row of the row above
+      ScalePlaneRow (pFunc, pRowU, kiYc, pSrcU, pPic->iLinesize[1], pOut->iSrcWidth >> 1, pOut->iSrcHeight >> 1,
+                     kiWidthC, kiHeightC);
+      ScalePlaneRow (pFunc, pRowV, kiYc, pSrcV, pPic->iLinesize[2], pOut->iSrcWidth >> 1, pOut->iSrcHeight >> 1,
+                     kiWidthC, kiHeightC);
+    }
+    pY = pRowY;
+    pU = pRowU;
+    pV = pRowV;
+  } else {
+    pY = pSrcY + kiY * pPic->iLinesize[0];
+    pU = pSrcU + kiYc * pPic->iLinesize[1];
+    pV = pSrcV + kiYc * pPic->iLinesize[2];
+    if (!kbRgb)
+      memcpy (pOut->pDst[0] + kiY * pOut->iStride[0], pY, pOut->iWidth);
+  }
+
+  if (pOut->iFormat == videoFormatNV12) {
+    if (0 == (kiY & 1))
+      pFunc->pfInterleaveUV (pOut->pDst[1] + kiYc * pOut->iStride[1], pU, pV, kiWidthC);
+  } else if (pOut->iFormat == videoFormatRGBA) {
+    pFunc->pfYuvToRgbaRow (pOut->pDst[0] + kiY * pOut->iStride[0], pY, pU, pV, pOut->iWidth);
+  } else if (pOut->iFormat == videoFormatBGRA) {
+    pFunc->pfYuvToBgraRow (pOut->pDst[0] + kiY * pOut->iStride[0], pY, pU, pV, pOut->iWidth);
+  }
+}
+
+void ConvertPicOutputLines (SOutputFormatFunc* pFunc, PPicture pPic, const int32_t kiEndLine) {
+  SPicOutput* pOut = &pPic->sOutput;
+
+  if (NULL == pOut->pDst[0])
+    return;
+
+  while (pOut->iLines < pOut->iHeight && SourceLinesOfRow (pOut, pOut->iLines) <= kiEndLine) {
+    ConvertPicOutputRow (pFunc, pPic, pOut->iLines);
+    ++ pOut->iLines;
+  }
+}
+
+void ConvertPicOutputRemaining (SOutputFormatFunc* pFunc, PPicture pPic) {
+  ConvertPicOutputLines (pFunc, pPic, pPic->iHeightInPixel);
+}
+
+void InterleaveUV_c (uint8_t* pDstUV, const uint8_t* pSrcU, const uint8_t* pSrcV, const int32_t kiWidth) {
+  int32_t i;
+
+  for (i = 0; i < kiWidth; i++) {
+    pDstUV[i << 1]		= pSrcU[i];
+    pDstUV[(i << 1) + 1]	= pSrcV[i];
+  }
+}
+
+/* video range BT.601 in 8 bit fixed point */
+#define YUV2RGB_Y		298
+#define YUV2RGB_RV	409
+#define YUV2RGB_GU	(-100)
+#define YUV2RGB_GV	(-208)
+#define YUV2RGB_BU	516
+
+static inline void YuvToRgbRow_c (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU, const uint8_t* pSrcV,
+                                  const int32_t kiWidth, const int32_t kiR, const int32_t kiB) {
+  int32_t i;
+
+  for (i = 0; i < kiWidth; i++) {
+    const int32_t kiC = YUV2RGB_Y * (pSrcY[i] - 16) + 128;
+    const int32_t kiD = pSrcU[i >> 1] - 128;
+    const int32_t kiE = pSrcV[i >> 1] - 128;
+
+    pDst[kiR]	= WelsClip1 ((kiC + YUV2RGB_RV * kiE) >> 8);
+    pDst[1]		= WelsClip1 ((kiC + YUV2RGB_GU * kiD + YUV2RGB_GV * kiE) >> 8);
+    pDst[kiB]	= WelsClip1 ((kiC + YUV2RGB_BU * kiD) >> 8);
+    pDst[3]		= 255;
+    pDst += 4;
+  }
+}
+
+void YuvToRgbaRow_c (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU, const uint8_t* pSrcV,
+                     const int32_t kiWidth) {
+  YuvToRgbRow_c (pDst, pSrcY, pSrcU, pSrcV, kiWidth, 0, 2);
+}
+
+void YuvToBgraRow_c (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU, const uint8_t* pSrcV,
+                     const int32_t kiWidth) {
+  YuvToRgbRow_c (pDst, pSrcY, pSrcU, pSrcV, kiWidth, 2, 0);
+}
+
+void ScaleRowBilinear_c (uint8_t* pDst, const int32_t kiDstWidth, const uint8_t* pSrc0, const uint8_t* pSrc1,
+                         const int32_t kiSrcWidth, const int32_t kiStepX, const int32_t kiFracY) {
+  int32_t i;
+
+  for (i = 0; i < kiDstWidth; i++) {
+    const int32_t kiPos = ScalePos (i, kiStepX, kiSrcWidth);
+    const int32_t kiX0 = kiPos >> 16;
+    const int32_t kiX1 = WELS_MIN (kiX0 + 1, kiSrcWidth - 1);
+    const int32_t kiFracX = (kiPos >> 8) & 0xff;
+    const int32_t kiTop = (pSrc0[kiX0] << 8) + (pSrc0[kiX1] - pSrc0[kiX0]) * kiFracX;
+    const int32_t kiBottom = (pSrc1[kiX0] << 8) + (pSrc1[kiX1] - pSrc1[kiX0]) * kiFracX;
+
+    pDst[i] = ((kiTop << 8) + (kiBottom - kiTop) * kiFracY + (1 << 15)) >> 16;
+  }
+}
+
+#if defined(X86_INTRINSICS)
+WELS_TARGET_SSE2 void InterleaveUV_sse2 (uint8_t* pDstUV, const uint8_t* pSrcU, const uint8_t* pSrcV,
+    const int32_t kiWidth) {
+  int32_t i;
+
+  for (i = 0; i + 16 <= kiWidth; i += 16) {
+    const __m128i kU = _mm_loadu_si128 ((const __m128i*) (pSrcU + i));
+    const __m128i kV = _mm_loadu_si128 ((const __m128i*) (pSrcV + i));
+
+    _mm_storeu_si128 ((__m128i*) (pDstUV + (i << 1)), _mm_unpacklo_epi8 (kU, kV));
+    _mm_storeu_si128 ((__m128i*) (pDstUV + (i << 1) + 16), _mm_unpackhi_epi8 (kU, kV));
+  }
+  InterleaveUV_c (pDstUV + (i << 1), pSrcU + i, pSrcV + i, kiWidth - i);
+}
+
+/* R, G and B of 4 pixels in 32 bit, same arithmetic as YuvToRgbRow_c */
+static inline WELS_TARGET_SSE2 __m128i YuvToRgbChannel_sse2 (const __m128i kCE, const __m128i kCoefCE,
+    const __m128i kDE, const __m128i kCoefDE) {
+  const __m128i kSum = _mm_add_epi32 (_mm_madd_epi16 (kCE, kCoefCE), _mm_madd_epi16 (kDE, kCoefDE));
+  return _mm_srai_epi32 (kSum, 8);
+}
+
+static inline WELS_TARGET_SSE2 void YuvToRgbRow_sse2 (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU,
+    const uint8_t* pSrcV, const int32_t kiWidth, const bool kbBgr) {
+  const __m128i kZero	= _mm_setzero_si128();
+  const __m128i k16		= _mm_set1_epi16 (16);
+  const __m128i k128	= _mm_set1_epi16 (128);
+  const __m128i kOne	= _mm_set1_epi16 (1);
+  const __m128i kAlpha	= _mm_set1_epi8 ((char)0xff);
+  // each channel is the sum of two products of interleaved 16 bit pairs: (C, E) and (D, 1) with C = Y - 16
+  const __m128i kCoefR0	= _mm_set_epi16 (YUV2RGB_RV, YUV2RGB_Y, YUV2RGB_RV, YUV2RGB_Y, YUV2RGB_RV, YUV2RGB_Y, YUV2RGB_RV,
+                                         YUV2RGB_Y);
+  const __m128i kCoefR1	= _mm_set_epi16 (128, 0, 128, 0, 128, 0, 128, 0);
+  const __m128i kCoefG0	= _mm_set_epi16 (YUV2RGB_GV, YUV2RGB_Y, YUV2RGB_GV, YUV2RGB_Y, YUV2RGB_GV, YUV2RGB_Y, YUV2RGB_GV,
+                                         YUV2RGB_Y);
+  const __m128i kCoefG1	= _mm_set_epi16 (128, YUV2RGB_GU, 128, YUV2RGB_GU, 128, YUV2RGB_GU, 128, YUV2RGB_GU);
+  const __m128i kCoefB0	= _mm_set_epi16 (0, YUV2RGB_Y, 0, YUV2RGB_Y, 0, YUV2RGB_Y, 0, YUV2RGB_Y);
+  const __m128i kCoefB1	= _mm_set_epi16 (128, YUV2RGB_BU, 128, YUV2RGB_BU, 128, YUV2RGB_BU, 128, YUV2RGB_BU);
+  int32_t i;
+
+  for (i = 0; i + 8 <= kiWidth; i += 8) {
+    const __m128i kY	= _mm_unpacklo_epi8 (_mm_loadl_epi64 ((const __m128i*) (pSrcY + i)), kZero);
+    __m128i iU			= _mm_cvtsi32_si128 (LD32 (pSrcU + (i >> 1)));
+    __m128i iV			= _mm_cvtsi32_si128 (LD32 (pSrcV + (i >> 1)));
+    __m128i iC, iD, iE, iCE[2], iDE[2], iR, iG, iB, iRG, iBA;
+
+    iU = _mm_unpacklo_epi8 (iU, iU);
+    iV = _mm_unpacklo_epi8 (iV, iV);
+    iC = _mm_sub_epi16 (kY, k16);
+    iD = _mm_sub_epi16 (_mm_unpacklo_epi8 (iU, kZero), k128);
+    iE = _mm_sub_epi16 (_mm_unpacklo_epi8 (iV, kZero), k128);
+    iCE[0] = _mm_unpacklo_epi16 (iC, iE);
+    iCE[1] = _mm_unpackhi_epi16 (iC, iE);
+    iDE[0] = _mm_unpacklo_epi16 (iD, kOne);
+    iDE[1] = _mm_unpackhi_epi16 (iD, kOne);
+
+    iR = _mm_packs_epi32 (YuvToRgbChannel_sse2 (iCE[0], kCoefR0, iDE[0], kCoefR1),
+                          YuvToRgbChannel_sse2 (iCE[1], kCoefR0, iDE[1], kCoefR1));
+    iG = _mm_packs_epi32 (YuvToRgbChannel_sse2 (iCE[0], kCoefG0, iDE[0], kCoefG1),
+                          YuvToRgbChannel_sse2 (iCE[1], kCoefG0, iDE[1], kCoefG1));
+    iB = _mm_packs_epi32 (YuvToRgbChannel_sse2 (iCE[0], kCoefB0, iDE[0], kCoefB1),
+                          YuvToRgbChannel_sse2 (iCE[1], kCoefB0, iDE[1], kCoefB1));
+    iR = _mm_packus_epi16 (iR, iR);
+    iG = _mm_packus_epi16 (iG, iG);
+    iB = _mm_packus_epi16 (iB, iB);
+
+    iRG = kbBgr ? _mm_unpacklo_epi8 (iB, iG) : _mm_unpacklo_epi8 (iR, iG);
+    iBA = kbBgr ? _mm_unpacklo_epi8 (iR, kAlpha) : _mm_unpacklo_epi8 (iB, kAlpha);
+    _mm_storeu_si128 ((__m128i*) (pDst + (i << 2)), _mm_unpacklo_epi16 (iRG, iBA));
+    _mm_storeu_si128 ((__m128i*) (pDst + (i << 2) + 16), _mm_unpackhi_epi16 (iRG, iBA));
+  }
+  YuvToRgbRow_c (pDst + (i << 2), pSrcY + i, pSrcU + (i >> 1), pSrcV + (i >> 1), kiWidth - i, kbBgr ? 2 : 0,
+                 kbBgr ? 0 : 2);
+}
+
+WELS_TARGET_SSE2 void YuvToRgbaRow_sse2 (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU,
+    const uint8_t* pSrcV, const int32_t kiWidth) {
+  YuvToRgbRow_sse2 (pDst, pSrcY, pSrcU, pSrcV, kiWidth, false);
+}
+
+WELS_TARGET_SSE2 void YuvToBgraRow_sse2 (uint8_t* pDst, const uint8_t* pSrcY, const uint8_t* pSrcU,
+    const uint8_t* pSrcV, const int32_t kiWidth) {
+  YuvToRgbRow_sse2 (pDst, pSrcY, pSrcU, pSrcV, kiWidth, true);
+}
+#endif//X86_INTRINSICS
+
+void InitOutputFormatFunc (SOutputFormatFunc* pFunc, const uint32_t kuiCpuFlags) {
+  pFunc->pfInterleaveUV	= InterleaveUV_c;
+  pFunc->pfYuvToRgbaRow	= YuvToRgbaRow_c;
+  pFunc->pfYuvToBgraRow	= YuvToBgraRow_c;
+  pFunc->pfScaleRow		= ScaleRowBilinear_c;
+
+#if defined(X86_INTRINSICS)
+  if (kuiCpuFlags & WELS_CPU_SSE2) {
+    pFunc->pfInterleaveUV	= InterleaveUV_sse2;
+    pFunc->pfYuvToRgbaRow	= YuvToRgbaRow_sse2;
+    pFunc->pfYuvToBgraRow	= YuvToBgraRow_sse2;
+  }
+#endif//X86_INTRINSICS
+}
+
+} // namespace WelsDec
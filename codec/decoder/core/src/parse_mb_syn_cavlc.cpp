@@ -46,18 +46,15 @@
 namespace WelsDec {
 #define MAX_LEVEL_PREFIX 15
 void GetNeighborAvailMbType (PNeighAvail pNeighAvail, PDqLayer pCurLayer) {
-  int32_t iCurSliceIdc, iTopSliceIdc, iLeftTopSliceIdc, iRightTopSliceIdc, iLeftSliceIdc;
   int32_t iCurXy, iTopXy = 0, iLeftXy = 0, iLeftTopXy = 0, iRightTopXy = 0;
   int32_t iCurX, iCurY;
 
   iCurXy = pCurLayer->iMbXyIndex;
   iCurX  = pCurLayer->iMbX;
   iCurY  = pCurLayer->iMbY;
-  iCurSliceIdc = pCurLayer->pSliceIdc[iCurXy];
   if (iCurX != 0) {
     iLeftXy = iCurXy - 1;
-    iLeftSliceIdc = pCurLayer->pSliceIdc[iLeftXy];
-    pNeighAvail->iLeftAvail = (iLeftSliceIdc == iCurSliceIdc);
+    pNeighAvail->iLeftAvail = IsMbInCurSlice (pCurLayer, iLeftXy);
   } else {
     pNeighAvail->iLeftAvail = 0;
     pNeighAvail->iLeftTopAvail = 0;
@@ -65,19 +62,16 @@ void GetNeighborAvailMbType (PNeighAvail pNeighAvail, PDqLayer pCurLayer) {
 
   if (iCurY != 0) {
     iTopXy = iCurXy - pCurLayer->iMbWidth;
-    iTopSliceIdc = pCurLayer->pSliceIdc[iTopXy];
-    pNeighAvail->iTopAvail = (iTopSliceIdc == iCurSliceIdc);
+    pNeighAvail->iTopAvail = IsMbInCurSlice (pCurLayer, iTopXy);
     if (iCurX != 0) {
       iLeftTopXy = iTopXy - 1;
-      iLeftTopSliceIdc = pCurLayer->pSliceIdc[iLeftTopXy];
-      pNeighAvail->iLeftTopAvail = (iLeftTopSliceIdc == iCurSliceIdc);
+      pNeighAvail->iLeftTopAvail = IsMbInCurSlice (pCurLayer, iLeftTopXy);
     } else {
       pNeighAvail->iLeftTopAvail = 0;
     }
     if (iCurX != (pCurLayer->iMbWidth - 1)) {
       iRightTopXy = iTopXy + 1;
-      iRightTopSliceIdc = pCurLayer->pSliceIdc[iRightTopXy];
-      pNeighAvail->iRightTopAvail = (iRightTopSliceIdc == iCurSliceIdc);
+      pNeighAvail->iRightTopAvail = IsMbInCurSlice (pCurLayer, iRightTopXy);
     } else {
       pNeighAvail->iRightTopAvail = 0;
     }
@@ -472,87 +466,66 @@ int32_t CheckIntra4x4PredMode (int32_t* pSampleAvail, int8_t* pMode, int32_t iIn
   return iFinalMode;
 }
 
-void BsStartCavlc (PBitStringAux pBs) {
-  pBs->iIndex = ((pBs->pCurBuf - pBs->pStartBuf) << 3) - (16 - pBs->iLeftBits);
-}
-void BsEndCavlc (PBitStringAux pBs) {
-  pBs->pCurBuf   = pBs->pStartBuf + (pBs->iIndex >> 3);
-  uint32_t uiCache32Bit = (uint32_t) ((((pBs->pCurBuf[0] << 8) | pBs->pCurBuf[1]) << 16) |
-                                      (pBs->pCurBuf[2] << 8) | pBs->pCurBuf[3]);
-  pBs->uiCurBits = uiCache32Bit << (pBs->iIndex & 0x07);
-  pBs->pCurBuf  += 4;
-  pBs->iLeftBits = -16 + (pBs->iIndex & 0x07);
-}
-
-
-// return: used bits
 static int32_t CavlcGetTrailingOnesAndTotalCoeff (uint8_t& uiTotalCoeff, uint8_t& uiTrailingOnes,
-    SReadBitsCache* pBitsCache, SVlcTable* pVlcTable, bool bChromaDc, int8_t nC) {
+    PBitStringAux pBs, SVlcTable* pVlcTable, bool bChromaDc, int8_t nC) {
   const uint8_t* kpVlcTableMoreBitsCountList[3] = {g_kuiVlcTableMoreBitsCount0, g_kuiVlcTableMoreBitsCount1, g_kuiVlcTableMoreBitsCount2};
-  int32_t iUsedBits = 0;
   int32_t iIndexVlc, iIndexValue, iNcMapIdx;
   uint32_t uiCount;
   uint32_t uiValue;
 
+  NEED_BITS (pBs, 16);
   if (bChromaDc) {
-    uiValue        = pBitsCache->uiCache32Bit >> 24;
+    uiValue        = UBITS (pBs, 8);
     iIndexVlc      = pVlcTable->kpChromaCoeffTokenVlcTable[uiValue][0];
     uiCount        = pVlcTable->kpChromaCoeffTokenVlcTable[uiValue][1];
-    POP_BUFFER (pBitsCache, uiCount);
-    iUsedBits     += uiCount;
+    DUMP_BITS (pBs, uiCount);
     uiTrailingOnes = g_kuiVlcTrailingOneTotalCoeffTable[iIndexVlc][0];
     uiTotalCoeff   = g_kuiVlcTrailingOneTotalCoeffTable[iIndexVlc][1];
   } else { //luma
     iNcMapIdx = g_kuiNcMapTable[nC];
     if (iNcMapIdx <= 2) {
-      uiValue = pBitsCache->uiCache32Bit >> 24;
+      uiValue = UBITS (pBs, 8);
       if (uiValue < g_kuiVlcTableNeedMoreBitsThread[iNcMapIdx]) {
-        POP_BUFFER (pBitsCache, 8);
-        iUsedBits  += 8;
-        iIndexValue = pBitsCache->uiCache32Bit >> (32 - kpVlcTableMoreBitsCountList[iNcMapIdx][uiValue]);
+        DUMP_BITS (pBs, 8);
+        iIndexValue = UBITS (pBs, kpVlcTableMoreBitsCountList[iNcMapIdx][uiValue]);
         iIndexVlc   = pVlcTable->kpCoeffTokenVlcTable[iNcMapIdx + 1][uiValue][iIndexValue][0];
         uiCount     = pVlcTable->kpCoeffTokenVlcTable[iNcMapIdx + 1][uiValue][iIndexValue][1];
-        POP_BUFFER (pBitsCache, uiCount);
-        iUsedBits  += uiCount;
+        DUMP_BITS (pBs, uiCount);
       } else {
         iIndexVlc  = pVlcTable->kpCoeffTokenVlcTable[0][iNcMapIdx][uiValue][0];
         uiCount    = pVlcTable->kpCoeffTokenVlcTable[0][iNcMapIdx][uiValue][1];
-        uiValue    = pBitsCache->uiCache32Bit >> (32 - uiCount);
-        POP_BUFFER (pBitsCache, uiCount);
-        iUsedBits += uiCount;
+        DUMP_BITS (pBs, uiCount);
       }
     } else {
-      uiValue    = pBitsCache->uiCache32Bit >> (32 - 6);
-      POP_BUFFER (pBitsCache, 6);
-      iUsedBits += 6;
+      uiValue    = UBITS (pBs, 6);
+      DUMP_BITS (pBs, 6);
       iIndexVlc  = pVlcTable->kpCoeffTokenVlcTable[0][3][uiValue][0];  //differ
     }
     uiTrailingOnes = g_kuiVlcTrailingOneTotalCoeffTable[iIndexVlc][0];
     uiTotalCoeff  = g_kuiVlcTrailingOneTotalCoeffTable[iIndexVlc][1];
   }
 
-  return iUsedBits;
+  return ERR_NONE;
 }
 
-static int32_t CavlcGetLevelVal (int32_t iLevel[16], SReadBitsCache* pBitsCache, uint8_t uiTotalCoeff,
+static int32_t CavlcGetLevelVal (int32_t iLevel[16], PBitStringAux pBs, uint8_t uiTotalCoeff,
                                  uint8_t uiTrailingOnes) {
-  int32_t i, iUsedBits = 0;
+  int32_t i;
   int32_t iSuffixLength, iSuffixLengthSize, iLevelPrefix, iPrefixBits, iLevelCode, iThreshold;
+  NEED_BITS (pBs, 3);
   for (i = 0; i < uiTrailingOnes; i++) {
-    iLevel[i] = 1 - ((pBitsCache->uiCache32Bit >> (30 - i)) & 0x02);
+    iLevel[i] = 1 - ((uint32_t) (pBs->uiCurBits >> (62 - i)) & 0x02);
   }
-  POP_BUFFER (pBitsCache, uiTrailingOnes);
-  iUsedBits += uiTrailingOnes;
+  DUMP_BITS (pBs, uiTrailingOnes);
 
   iSuffixLength = (uiTotalCoeff > 10 && uiTrailingOnes < 3);
 
   for (; i < uiTotalCoeff; i++) {
-    if (pBitsCache->uiRemainBits <= 16)		SHIFT_BUFFER (pBitsCache);
-    WELS_GET_PREFIX_BITS (pBitsCache->uiCache32Bit, iPrefixBits);
+    NEED_BITS (pBs, MAX_LEVEL_PREFIX + 1 + 12); //prefix and longest suffix
+    WELS_GET_PREFIX_BITS ((uint32_t) (pBs->uiCurBits >> 32), iPrefixBits);
     if (iPrefixBits > MAX_LEVEL_PREFIX + 1) //iPrefixBits includes leading "0"s and first "1", should +1
-      return -1;
-    POP_BUFFER (pBitsCache, iPrefixBits);
-    iUsedBits   += iPrefixBits;
+      return ERR_INFO_CAVLC_INVALID_LEVEL;
+    DUMP_BITS (pBs, iPrefixBits);
     iLevelPrefix = iPrefixBits - 1;
 
     iLevelCode = iLevelPrefix << iSuffixLength; //differ
@@ -569,10 +542,8 @@ static int32_t CavlcGetLevelVal (int32_t iLevel[16], SReadBitsCache* pBitsCache,
     }
 
     if (iSuffixLengthSize > 0) {
-      if (pBitsCache->uiRemainBits <= iSuffixLengthSize) SHIFT_BUFFER (pBitsCache);
-      iLevelCode += (pBitsCache->uiCache32Bit >> (32 - iSuffixLengthSize));
-      POP_BUFFER (pBitsCache, iSuffixLengthSize);
-      iUsedBits  += iSuffixLengthSize;
+      iLevelCode += UBITS (pBs, iSuffixLengthSize);
+      DUMP_BITS (pBs, iSuffixLengthSize);
     }
 
     iLevelCode += ((i == uiTrailingOnes) && (uiTrailingOnes < 3)) << 1;
@@ -584,12 +555,12 @@ static int32_t CavlcGetLevelVal (int32_t iLevel[16], SReadBitsCache* pBitsCache,
     iSuffixLength += ((iLevel[i] > iThreshold) || (iLevel[i] < -iThreshold)) && (iSuffixLength < 6);
   }
 
-  return iUsedBits;
+  return ERR_NONE;
 }
 
-static int32_t CavlcGetTotalZeros (int32_t& iZerosLeft, SReadBitsCache* pBitsCache, uint8_t uiTotalCoeff,
+static int32_t CavlcGetTotalZeros (int32_t& iZerosLeft, PBitStringAux pBs, uint8_t uiTotalCoeff,
                                    SVlcTable* pVlcTable, bool bChromaDc) {
-  int32_t iCount, iUsedBits = 0;
+  int32_t iCount;
   const uint8_t* kpBitNumMap;
   uint32_t uiValue;
 
@@ -608,51 +579,45 @@ static int32_t CavlcGetTotalZeros (int32_t& iZerosLeft, SReadBitsCache* pBitsCac
   }
 
   iCount = kpBitNumMap[iTotalZeroVlcIdx - 1];
-  if (pBitsCache->uiRemainBits < iCount) SHIFT_BUFFER (
-      pBitsCache); // if uiRemainBits+16 still smaller than iCount?? potential bug
-  uiValue    = pBitsCache->uiCache32Bit >> (32 - iCount);
+  NEED_BITS (pBs, iCount);
+  uiValue    = UBITS (pBs, iCount);
   iCount     = pVlcTable->kpTotalZerosTable[uiTableType][iTotalZeroVlcIdx - 1][uiValue][1];
-  POP_BUFFER (pBitsCache, iCount);
-  iUsedBits += iCount;
+  DUMP_BITS (pBs, iCount);
   iZerosLeft = pVlcTable->kpTotalZerosTable[uiTableType][iTotalZeroVlcIdx - 1][uiValue][0];
 
-  return iUsedBits;
+  return ERR_NONE;
 }
-static int32_t	CavlcGetRunBefore (int32_t iRun[16], SReadBitsCache* pBitsCache, uint8_t uiTotalCoeff,
+static int32_t	CavlcGetRunBefore (int32_t iRun[16], PBitStringAux pBs, uint8_t uiTotalCoeff,
                                    SVlcTable* pVlcTable, int32_t iZerosLeft) {
-  int32_t i, iUsedBits = 0;
+  int32_t i;
   uint32_t uiCount, uiValue, iPrefixBits;
 
   for (i = 0; i < uiTotalCoeff - 1; i++) {
     if (iZerosLeft > 0) {
+      NEED_BITS (pBs, 3 + 16); //longest code is 11 bits, the prefix is checked on 16 bits
       uiCount = g_kuiZeroLeftBitNumMap[iZerosLeft];
-      if (pBitsCache->uiRemainBits < uiCount) SHIFT_BUFFER (pBitsCache);
-      uiValue = pBitsCache->uiCache32Bit >> (32 - uiCount);
+      uiValue = UBITS (pBs, uiCount);
       if (iZerosLeft < 7) {
         uiCount = pVlcTable->kpZeroTable[iZerosLeft - 1][uiValue][1];
-        POP_BUFFER (pBitsCache, uiCount);
-        iUsedBits += uiCount;
+        DUMP_BITS (pBs, uiCount);
         iRun[i] = pVlcTable->kpZeroTable[iZerosLeft - 1][uiValue][0];
       } else {
-        POP_BUFFER (pBitsCache, uiCount);
-        iUsedBits += uiCount;
+        DUMP_BITS (pBs, uiCount);
         if (pVlcTable->kpZeroTable[6][uiValue][0] < 7) {
           iRun[i] = pVlcTable->kpZeroTable[6][uiValue][0];
         } else {
-          if (pBitsCache->uiRemainBits < 16) SHIFT_BUFFER (pBitsCache);
-          WELS_GET_PREFIX_BITS (pBitsCache->uiCache32Bit, iPrefixBits);
+          WELS_GET_PREFIX_BITS ((uint32_t) (pBs->uiCurBits >> 32), iPrefixBits);
           iRun[i] = iPrefixBits + 6;
           if (iRun[i] > iZerosLeft)
-            return -1;
-          POP_BUFFER (pBitsCache, iPrefixBits);
-          iUsedBits += iPrefixBits;
+            return ERR_INFO_CAVLC_INVALID_RUN_BEFORE;
+          DUMP_BITS (pBs, iPrefixBits);
         }
       }
     } else {
       for (int j = i; j < uiTotalCoeff; j++) {
 	iRun[j] = 0;
       }
-      return iUsedBits;
+      return ERR_NONE;
     }
 
     iZerosLeft -= iRun[i];
@@ -660,7 +625,7 @@ static int32_t	CavlcGetRunBefore (int32_t iRun[16], SReadBitsCache* pBitsCache,
 
   iRun[uiTotalCoeff - 1] = iZerosLeft;
 
-  return iUsedBits;
+  return ERR_NONE;
 }
 
 int32_t WelsResidualBlockCavlc (SVlcTable* pVlcTable, uint8_t* pNonZeroCountCache, PBitStringAux pBs, int32_t iIndex,
@@ -673,17 +638,9 @@ int32_t WelsResidualBlockCavlc (SVlcTable* pVlcTable, uint8_t* pNonZeroCountCach
   const uint16_t* kpDequantCoeff = g_kuiDequantCoeff[uiQp];
   int8_t nA, nB, nC;
   uint8_t uiTotalCoeff, uiTrailingOnes;
-  int32_t iUsedBits = 0;
-  int32_t iCurIdx   = pBs->iIndex;
-  uint8_t* pBuf     = ((uint8_t*)pBs->pStartBuf) + (iCurIdx >> 3);
   bool  bChromaDc = (CHROMA_DC == iResidualProperty);
   uint8_t bChroma   = (bChromaDc || CHROMA_AC == iResidualProperty);
-  SReadBitsCache sReadBitsCache;
-
-  uint32_t uiCache32Bit = (uint32_t) ((((pBuf[0] << 8) | pBuf[1]) << 16) | (pBuf[2] << 8) | pBuf[3]);
-  sReadBitsCache.uiCache32Bit = uiCache32Bit << (iCurIdx & 0x07);
-  sReadBitsCache.uiRemainBits = 32 - (iCurIdx & 0x07);
-  sReadBitsCache.pBuf = pBuf;
+  SBitStringAux sBs = *pBs; //local copy, lets the compiler keep the bits cache in registers
   //////////////////////////////////////////////////////////////////////////
 
   if (bChroma) {
@@ -698,26 +655,22 @@ int32_t WelsResidualBlockCavlc (SVlcTable* pVlcTable, uint8_t* pNonZeroCountCach
 
   WELS_NON_ZERO_COUNT_AVERAGE (nC, nA, nB);
 
-  iUsedBits += CavlcGetTrailingOnesAndTotalCoeff (uiTotalCoeff, uiTrailingOnes, &sReadBitsCache, pVlcTable, bChromaDc,
-               nC);
+  WELS_READ_VERIFY (CavlcGetTrailingOnesAndTotalCoeff (uiTotalCoeff, uiTrailingOnes, &sBs, pVlcTable, bChromaDc, nC));
 
   if (iResidualProperty != CHROMA_DC && iResidualProperty != I16_LUMA_DC) {
     pNonZeroCountCache[iCurNonZeroCacheIdx] = uiTotalCoeff;
     //////////////////////////////////////////////////////////////////////////
   }
   if (0 == uiTotalCoeff) {
-    pBs->iIndex += iUsedBits;
+    *pBs = sBs;
     return 0;
   }
   if ((uiTrailingOnes > 3) || (uiTotalCoeff > 16)) { /////////////////check uiTrailingOnes and uiTotalCoeff
     return ERR_INFO_CAVLC_INVALID_TOTAL_COEFF_OR_TRAILING_ONES;
   }
-  if ((i = CavlcGetLevelVal (iLevel, &sReadBitsCache, uiTotalCoeff, uiTrailingOnes)) == -1) {
-    return ERR_INFO_CAVLC_INVALID_LEVEL;
-  }
-  iUsedBits += i;
+  WELS_READ_VERIFY (CavlcGetLevelVal (iLevel, &sBs, uiTotalCoeff, uiTrailingOnes));
   if (uiTotalCoeff < iMaxNumCoeff) {
-    iUsedBits += CavlcGetTotalZeros (iZerosLeft, &sReadBitsCache, uiTotalCoeff, pVlcTable, bChromaDc);
+    WELS_READ_VERIFY (CavlcGetTotalZeros (iZerosLeft, &sBs, uiTotalCoeff, pVlcTable, bChromaDc));
   } else {
     iZerosLeft = 0;
   }
@@ -725,11 +678,8 @@ int32_t WelsResidualBlockCavlc (SVlcTable* pVlcTable, uint8_t* pNonZeroCountCach
   if ((iZerosLeft < 0) || ((iZerosLeft + uiTotalCoeff) > iMaxNumCoeff)) {
     return ERR_INFO_CAVLC_INVALID_ZERO_LEFT;
   }
-  if ((i = CavlcGetRunBefore (iRun, &sReadBitsCache, uiTotalCoeff, pVlcTable, iZerosLeft)) == -1) {
-    return ERR_INFO_CAVLC_INVALID_RUN_BEFORE;
-  }
-  iUsedBits += i;
-  pBs->iIndex += iUsedBits;
+  WELS_READ_VERIFY (CavlcGetRunBefore (iRun, &sBs, uiTotalCoeff, pVlcTable, iZerosLeft));
+  *pBs = sBs;
   iCoeffNum = -1;
 
   if (iResidualProperty == CHROMA_DC) {
@@ -970,13 +920,12 @@ int32_t ParseIntra16x16ModeConstrain1 (PNeighAvail pNeighAvail, PBitStringAux pB
   return 0;
 }
 
-int32_t ParseInterInfo (PWelsDecoderContext pCtx, int16_t iMvArray[LIST_A][30][MV_A], int8_t iRefIdxArray[LIST_A][30],
-                        PBitStringAux pBs) {
-  PSlice pSlice				= &pCtx->pCurDqLayer->sLayerInfo.sSliceInLayer;
+int32_t ParseInterInfo (PWelsDecoderContext pCtx, PDqLayer pCurDqLayer, int16_t iMvArray[LIST_A][30][MV_A],
+                        int8_t iRefIdxArray[LIST_A][30], PBitStringAux pBs) {
+  PSlice pSlice				= &pCurDqLayer->sLayerInfo.sSliceInLayer;
   PSliceHeader pSliceHeader	= &pSlice->sSliceHeaderExt.sSliceHeader;
-  PPicture* ppRefPic = pCtx->sRefPic.pRefList[LIST_0];
+  PPicture* ppRefPic = pCurDqLayer->pRefPicList;
   int32_t iRefCount[2];
-  PDqLayer pCurDqLayer = pCtx->pCurDqLayer;
   int32_t i, j;
   int32_t iMbXy = pCurDqLayer->iMbXyIndex;
   int32_t iMotionPredFlag[4];
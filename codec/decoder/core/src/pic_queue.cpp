@@ -40,11 +40,11 @@
 #include "pic_queue.h"
 #include "decoder_context.h"
 #include "codec_def.h"
-#include "mem_align.h"
+#include "decoder.h"
 
 namespace WelsDec {
 
-void FreePicture (PPicture pPic);
+void FreePicture (PPicture pPic, CMemoryAlign* pMa);
 
 
 ///////////////////////////////////Recycled queue management for pictures///////////////////////////////////
@@ -59,59 +59,139 @@ void FreePicture (PPicture pPic);
 
 
 
-PPicture AllocPicture (PWelsDecoderContext pCtx, const int32_t kiPicWidth, const int32_t kiPicHeight) {
-  PPicture pPic = NULL;
-  int32_t iPicWidth = 0;
-  int32_t iPicHeight = 0;
-
-  int32_t iPicChromaWidth	= 0;
-  int32_t iPicChromaHeight	= 0;
-  int32_t iLumaSize			= 0;
-  int32_t iChromaSize			= 0;
-
-  pPic	= (PPicture) WelsMalloc (sizeof (SPicture), "PPicture");
-  WELS_VERIFY_RETURN_IF (NULL, NULL == pPic);
-
-  memset (pPic, 0, sizeof (SPicture));
-
-  iPicWidth = WELS_ALIGN (kiPicWidth + (PADDING_LENGTH << 1), PICTURE_RESOLUTION_ALIGNMENT);
-  iPicHeight = WELS_ALIGN (kiPicHeight + (PADDING_LENGTH << 1), PICTURE_RESOLUTION_ALIGNMENT);
-  iPicChromaWidth	= iPicWidth >> 1;
-  iPicChromaHeight	= iPicHeight >> 1;
-
-  iLumaSize	= iPicWidth * iPicHeight;
-  iChromaSize	= iPicChromaWidth * iPicChromaHeight;
-    pPic->pBuffer[0]	= static_cast<uint8_t*> (WelsMalloc (iLumaSize /* luma */
-                        + (iChromaSize << 1) /* Cb,Cr */, "_pic->buffer[0]"));
+/* bytes of the buffer holding the padded luma and chroma planes of a kiPicWidth x kiPicHeight picture */
+static inline int32_t GetPicBufferSize (const int32_t kiPicWidth, const int32_t kiPicHeight) {
+  const int32_t kiLumaSize = WELS_ALIGN (kiPicWidth + (PADDING_LENGTH << 1), PICTURE_RESOLUTION_ALIGNMENT)
+                             * WELS_ALIGN (kiPicHeight + (PADDING_LENGTH << 1), PICTURE_RESOLUTION_ALIGNMENT);
+  return kiLumaSize + (kiLumaSize >> 1);
+}
 
-    WELS_VERIFY_RETURN_PROC_IF (NULL, NULL == pPic->pBuffer[0], FreePicture (pPic));
-    pPic->iLinesize[0] = iPicWidth;
-    pPic->iLinesize[1] = pPic->iLinesize[2] = iPicChromaWidth;
-    pPic->pBuffer[1]	= pPic->pBuffer[0] + iLumaSize;
-    pPic->pBuffer[2]	= pPic->pBuffer[1] + iChromaSize;
-    pPic->pData[0]	= pPic->pBuffer[0] + (1 + pPic->iLinesize[0]) * PADDING_LENGTH;
-    pPic->pData[1]	= pPic->pBuffer[1] + /*WELS_ALIGN*/ (((1 + pPic->iLinesize[1]) * PADDING_LENGTH) >> 1);
-    pPic->pData[2]	= pPic->pBuffer[2] + /*WELS_ALIGN*/ (((1 + pPic->iLinesize[2]) * PADDING_LENGTH) >> 1);
+/* point the planes of a kiPicWidth x kiPicHeight picture into the buffer of pPic, to NULL while it has none */
+static void LayoutPicture (PPicture pPic, const int32_t kiPicWidth, const int32_t kiPicHeight) {
+  const int32_t kiPicWidthAligned	= WELS_ALIGN (kiPicWidth + (PADDING_LENGTH << 1), PICTURE_RESOLUTION_ALIGNMENT);
+  const int32_t kiPicHeightAligned	= WELS_ALIGN (kiPicHeight + (PADDING_LENGTH << 1), PICTURE_RESOLUTION_ALIGNMENT);
+  const int32_t kiLumaSize			= kiPicWidthAligned * kiPicHeightAligned;
+  const int32_t kiChromaSize			= kiLumaSize >> 2;
+
+  pPic->iLinesize[0] = kiPicWidthAligned;
+  pPic->iLinesize[1] = pPic->iLinesize[2] = kiPicWidthAligned >> 1;
+  if (NULL == pPic->pBuffer[0]) {
+    pPic->pBuffer[1] = pPic->pBuffer[2] = NULL;
+    pPic->pData[0] = pPic->pData[1] = pPic->pData[2] = NULL;
+    return;
+  }
+  pPic->pBuffer[1]	= pPic->pBuffer[0] + kiLumaSize;
+  pPic->pBuffer[2]	= pPic->pBuffer[1] + kiChromaSize;
+  pPic->pData[0]	= pPic->pBuffer[0] + (1 + pPic->iLinesize[0]) * PADDING_LENGTH;
+  pPic->pData[1]	= pPic->pBuffer[1] + /*WELS_ALIGN*/ (((1 + pPic->iLinesize[1]) * PADDING_LENGTH) >> 1);
+  pPic->pData[2]	= pPic->pBuffer[2] + /*WELS_ALIGN*/ (((1 + pPic->iLinesize[2]) * PADDING_LENGTH) >> 1);
+}
 
+/* give the buffer of pPic back to the application or the allocator it came from */
+static void ReleasePictureBuffer (PPicture pPic, CMemoryAlign* pMa) {
+  if (NULL == pPic->pBuffer[0])
+    return;
+
+  if (NULL != pPic->pBufferProvider)
+    pPic->pBufferProvider->pReleaseBuffer (pPic->pBufferProvider->pCtx, pPic->pBuffer[0], pPic->pOpaque);
+  else
+    pMa->WelsFree (pPic->pBuffer[0], "pPic->pBuffer[0]");
+  pPic->pBuffer[0]		= NULL;
+  pPic->pBufferProvider	= NULL;
+  pPic->pOpaque			= NULL;
+  pPic->iBufferSize		= 0;
+}
 
+/*
+ * lay the planes of a kiPicWidth x kiPicHeight picture out over the buffer of pPic, the buffer is only reallocated
+ * if it is too small; new buffers are sized for the largest resolution decoded or configured so far
+ */
+int32_t ResizePicture (PWelsDecoderContext pCtx, PPicture pPic, const int32_t kiPicWidth, const int32_t kiPicHeight) {
+  const int32_t kiBufferSize	= GetPicBufferSize (kiPicWidth, kiPicHeight);
+  CMemoryAlign* pMa			= pCtx->pMemAlign;
+
+  if (pPic->iBufferSize < kiBufferSize) {
+    ReleasePictureBuffer (pPic, pMa);
+    // buffers of the application are taken frame by frame in RenewPictureBuffer()
+    if (NULL == pCtx->sBufferProvider.pGetBuffer) {
+      int32_t iBufferSize = WELS_MAX (kiBufferSize, pCtx->iPicBufferSize);
+      if (NULL != pCtx->pParam && pCtx->pParam->iMaxWidth > 0 && pCtx->pParam->iMaxHeight > 0)
+        iBufferSize = WELS_MAX (iBufferSize, GetPicBufferSize (pCtx->pParam->iMaxWidth, pCtx->pParam->iMaxHeight));
+
+      // every MB is reconstructed or concealed before the planes are read, as with buffers of the application
+      pPic->pBuffer[0]	= static_cast<uint8_t*> (pMa->WelsMalloc (iBufferSize, "_pic->buffer[0]"));
+      WELS_VERIFY_RETURN_IF (1, NULL == pPic->pBuffer[0]);
+      pPic->iBufferSize	= iBufferSize;
+      pCtx->iPicBufferSize	= iBufferSize;
+    }
+  }
+  LayoutPicture (pPic, kiPicWidth, kiPicHeight);
+  memset (&pPic->sOutput, 0, sizeof (pPic->sOutput));	// set up again once the next frame starts
 
   pPic->iPlanes		= 3;	// yv12 in default
   pPic->iWidthInPixel	= kiPicWidth;
   pPic->iHeightInPixel = kiPicHeight;
   pPic->iFrameNum		= -1;
+  pPic->iReadyLines	= kiPicHeight;
   pPic->bAvailableFlag = true;
 
+  return 0;
+}
+
+/*
+ * with buffers of the application every frame is reconstructed into a new one, taken here for pPic starting to be
+ * decoded; the buffers of the other pictures which left the DPB meanwhile are given back at the same time
+ */
+int32_t RenewPictureBuffer (PWelsDecoderContext pCtx, PPicture pPic) {
+  SPictureBufferProvider* pProvider	= &pCtx->sBufferProvider;
+  PPicBuff pPicBuf					= pCtx->pPicBuff[LIST_0];
+  const int32_t kiBufferSize			= GetPicBufferSize (pPic->iWidthInPixel, pPic->iHeightInPixel);
+  void* pOpaque						= NULL;
+  uint8_t* pBuffer					= static_cast<uint8_t*> (pProvider->pGetBuffer (pProvider->pCtx, kiBufferSize, &pOpaque));
+  int32_t iPicIdx;
+
+  WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == pBuffer);
+
+  ReleasePictureBuffer (pPic, pCtx->pMemAlign);
+  pPic->pBuffer[0]		= pBuffer;
+  pPic->pBufferProvider	= pProvider;
+  pPic->pOpaque			= pOpaque;
+  pPic->iBufferSize		= kiBufferSize;
+  LayoutPicture (pPic, pPic->iWidthInPixel, pPic->iHeightInPixel);
+
+  for (iPicIdx = 0; iPicIdx < pPicBuf->iCapacity; ++ iPicIdx) {
+    PPicture pOther = pPicBuf->ppPic[iPicIdx];
+    // the last decoded picture is kept for error concealment
+    if (NULL != pOther && pOther != pPic && pOther != pCtx->pPreviousDecodedPictureInDpb && NULL != pOther->pBuffer[0]
+        && !pOther->bUsedAsRef && 0 == pOther->uiRefCount) {
+      ReleasePictureBuffer (pOther, pCtx->pMemAlign);
+      LayoutPicture (pOther, pOther->iWidthInPixel, pOther->iHeightInPixel);
+    }
+  }
+
+  return ERR_NONE;
+}
+
+PPicture AllocPicture (PWelsDecoderContext pCtx, const int32_t kiPicWidth, const int32_t kiPicHeight) {
+  PPicture pPic = NULL;
+  CMemoryAlign* pMa			= pCtx->pMemAlign;
+
+  pPic	= (PPicture) pMa->WelsMallocz (sizeof (SPicture), "PPicture");
+  WELS_VERIFY_RETURN_IF (NULL, NULL == pPic);
+
+  memset (pPic, 0, sizeof (SPicture));
+
+  WELS_VERIFY_RETURN_PROC_IF (NULL, ResizePicture (pCtx, pPic, kiPicWidth, kiPicHeight), FreePicture (pPic, pMa));
+
   return pPic;
 }
 
-void FreePicture (PPicture pPic) {
+void FreePicture (PPicture pPic, CMemoryAlign* pMa) {
   if (NULL != pPic) {
+    ReleasePictureBuffer (pPic, pMa);
+    pMa->WelsFree (pPic->pOutBuffer, "pPic->pOutBuffer");
 
-    if (pPic->pBuffer[0]) {
-      WelsFree (pPic->pBuffer[0], "pPic->pBuffer[0]");
-    }
-
-    WelsFree (pPic, "pPic");
+    pMa->WelsFree (pPic, "pPic");
 
     pPic = NULL;
   }
@@ -126,7 +206,7 @@ PPicture PrefetchPic (PPicBuff pPicBuf) {
 
   for (iPicIdx = pPicBuf->iCurrentIdx + 1; iPicIdx < pPicBuf->iCapacity ; ++iPicIdx) {
     if (pPicBuf->ppPic[iPicIdx] != NULL && pPicBuf->ppPic[iPicIdx]->bAvailableFlag
-        && !pPicBuf->ppPic[iPicIdx]->bUsedAsRef) {
+        && !pPicBuf->ppPic[iPicIdx]->bUsedAsRef && 0 == pPicBuf->ppPic[iPicIdx]->uiRefCount) {
       pPic = pPicBuf->ppPic[iPicIdx];
       break;
     }
@@ -137,7 +217,7 @@ PPicture PrefetchPic (PPicBuff pPicBuf) {
   }
   for (iPicIdx = 0 ; iPicIdx < pPicBuf->iCurrentIdx ; ++iPicIdx) {
     if (pPicBuf->ppPic[iPicIdx] != NULL && pPicBuf->ppPic[iPicIdx]->bAvailableFlag
-        && !pPicBuf->ppPic[iPicIdx]->bUsedAsRef) {
+        && !pPicBuf->ppPic[iPicIdx]->bUsedAsRef && 0 == pPicBuf->ppPic[iPicIdx]->uiRefCount) {
       pPic = pPicBuf->ppPic[iPicIdx];
       break;
     }
@@ -41,11 +41,12 @@
 
 #include "rec_mb.h"
 #include "decode_slice.h"
+#include "dec_multi_threading.h"
 
 namespace WelsDec {
 
 void WelsFillRecNeededMbInfo (PWelsDecoderContext pCtx, bool bOutput, PDqLayer pCurLayer) {
-  PPicture pCurPic = pCtx->pDec;
+  PPicture pCurPic = pCurLayer->pDec;
   int32_t iLumaStride   = pCurPic->iLinesize[0];
   int32_t iChromaStride = pCurPic->iLinesize[1];
   int32_t iMbX = pCurLayer->iMbX;
@@ -104,7 +105,7 @@ int32_t RecI4x4Luma (int32_t iMBXY, PWelsDecoderContext pCtx, int16_t* pScoeffLe
 
 
 int32_t RecI4x4Chroma (int32_t iMBXY, PWelsDecoderContext pCtx, int16_t* pScoeffLevel, PDqLayer pDqLayer) {
-  int32_t iChromaStride = pCtx->pCurDqLayer->pDec->iLinesize[1];
+  int32_t iChromaStride = pDqLayer->pDec->iLinesize[1];
 
   int8_t iChromaPredMode = pDqLayer->pChromaPredMode[iMBXY];
 
@@ -128,7 +129,7 @@ int32_t RecI16x16Mb (int32_t iMBXY, PWelsDecoderContext pCtx, int16_t* pScoeffLe
   int8_t iChromaPredMode = pDqLayer->pChromaPredMode[iMBXY];
   PGetIntraPredFunc* pGetIChromaPredFunc = pCtx->pGetIChromaPredFunc;
   PGetIntraPredFunc* pGetI16x16LumaPredFunc = pCtx->pGetI16x16LumaPredFunc;
-  int32_t iUVStride = pCtx->pCurDqLayer->pDec->iLinesize[1];
+  int32_t iUVStride = pDqLayer->pDec->iLinesize[1];
 
   /*common use by decoder&encoder*/
   int32_t iYStride = pDqLayer->iLumaStride;
@@ -181,14 +182,21 @@ typedef struct TagMCRefMember {
 
   int32_t iPicWidth;
   int32_t iPicHeight;
+
+  PWelsDecoderContext pCtx;
+  PPicture pRefPic;
+  int32_t* pRefReadyLines;	// NULL unless the reference may still be under reconstruction
 } sMCRefMember;
 //according to current 8*8 block ref_index to gain reference picture
-static inline void GetRefPic (sMCRefMember* pMCRefMem, PWelsDecoderContext pCtx, int8_t* pRefIdxList,
+static inline void GetRefPic (sMCRefMember* pMCRefMem, PDqLayer pCurDqLayer, int8_t* pRefIdxList,
                                 int32_t iIndex) {
   PPicture pRefPic;
 
   int8_t iRefIdx = pRefIdxList[iIndex];
-  pRefPic = pCtx->sRefPic.pRefList[LIST_0][iRefIdx];
+  pRefPic = pCurDqLayer->pRefPicList[iRefIdx];
+
+  pMCRefMem->pRefPic = pRefPic;
+  pMCRefMem->pRefReadyLines = (NULL != pCurDqLayer->pRefReadyLines) ? &pCurDqLayer->pRefReadyLines[iRefIdx] : NULL;
 
   pMCRefMem->iSrcLineLuma   = pRefPic->iLinesize[0];
   pMCRefMem->iSrcLineChroma = pRefPic->iLinesize[1];
@@ -236,6 +244,7 @@ static inline void BaseMC (sMCRefMember* pMCRefMem, int32_t iXOffset, int32_t iY
   uint8_t* pDstU = pMCRefMem->pDstU;
   uint8_t* pDstV = pMCRefMem->pDstV;
   bool bExpand = false;
+  bool bForceExpand = false;
 
   ENFORCE_STACK_ALIGN_1D (uint8_t, uiExpandBuf, (PADDING_LENGTH + 6) * (PADDING_LENGTH + 6), 16);
 
@@ -246,13 +255,26 @@ static inline void BaseMC (sMCRefMember* pMCRefMem, int32_t iXOffset, int32_t iY
     iExpandHeight -= 3;
   }
 
+  if (NULL != pMCRefMem->pRefReadyLines && *pMCRefMem->pRefReadyLines < pMCRefMem->iPicHeight) {
+    // frame threading: the reference border is padded only once the whole picture is done, so blocks reaching
+    // out of the picture are emulated from the inner pixels and only the rows actually read are waited for
+    int32_t iLumaLines, iChromaLines, iNeededLines;
+    bForceExpand = (iIntMVx - 2 < 0 || iIntMVy - 2 < 0 || iIntMVx + iBlkWidth + 2 > pMCRefMem->iPicWidth - 1
+                    || iIntMVy + iBlkHeight + 2 > pMCRefMem->iPicHeight - 1);
+    iLumaLines = WELS_CLIP3 (iIntMVy + iBlkHeight + 3, 1, pMCRefMem->iPicHeight);
+    iChromaLines = (WELS_CLIP3 ((iFullMVy >> 3) + iBlkHeightChroma, 0, iPicHeightChroma - 1) << 1) + 2;
+    iNeededLines = WELS_MAX (iLumaLines, iChromaLines);
+    if (iNeededLines > *pMCRefMem->pRefReadyLines)
+      *pMCRefMem->pRefReadyLines = WaitRefPicLines (pMCRefMem->pCtx, pMCRefMem->pRefPic, iNeededLines);
+  }
+
 #ifdef MC_FLOW_SIMPLE_JUDGE
-  if (iIntMVx < -iExpandWidth ||
+  if (bForceExpand || iIntMVx < -iExpandWidth ||
       iIntMVy < -iExpandHeight ||
       iIntMVx + iBlkWidth > pMCRefMem->iPicWidth - 1 + iExpandWidth ||
       iIntMVy + iBlkHeight > pMCRefMem->iPicHeight - 1 + iExpandHeight)
 #else
-  if (iIntMVx < -iExpandWidth ||
+  if (bForceExpand || iIntMVx < -iExpandWidth ||
       iIntMVy < -iExpandHeight ||
       iIntMVx + PADDING_LENGTH > pMCRefMem->iPicWidth + iExpandWidth ||
       iIntMVy + PADDING_LENGTH > pMCRefMem->iPicHeight + iExpandHeight)
@@ -289,9 +311,9 @@ static inline void BaseMC (sMCRefMember* pMCRefMem, int32_t iXOffset, int32_t iY
   }
 }
 
-void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDecoderContext pCtx) {
+void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDecoderContext pCtx,
+                   PDqLayer pCurDqLayer) {
   sMCRefMember pMCRefMem;
-  PDqLayer pCurDqLayer = pCtx->pCurDqLayer;
   SMcFunc* pMCFunc = &pCtx->sMcFunc;
 
   int32_t iMBXY = pCurDqLayer->iMbXyIndex;
@@ -303,8 +325,8 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
   int32_t iMBOffsetX = pCurDqLayer->iMbX << 4;
   int32_t iMBOffsetY = pCurDqLayer->iMbY << 4;
 
-  int32_t iDstLineLuma   = pCtx->pDec->iLinesize[0];
-  int32_t iDstLineChroma = pCtx->pDec->iLinesize[1];
+  int32_t iDstLineLuma   = pCurDqLayer->pDec->iLinesize[0];
+  int32_t iDstLineChroma = pCurDqLayer->pDec->iLinesize[1];
 
   int32_t iBlk8X, iBlk8Y, iBlk4X, iBlk4Y, i, j, iIIdx, iJIdx;
 
@@ -317,23 +339,25 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
 
   pMCRefMem.iDstLineLuma   = iDstLineLuma;
   pMCRefMem.iDstLineChroma = iDstLineChroma;
+
+  pMCRefMem.pCtx = pCtx;
   switch (iMBType) {
   case MB_TYPE_SKIP:
   case MB_TYPE_16x16:
     iMVs[0] = pCurDqLayer->pMv[0][iMBXY][0][0];
     iMVs[1] = pCurDqLayer->pMv[0][iMBXY][0][1];
-    GetRefPic (&pMCRefMem, pCtx, pCurDqLayer->pRefIndex[0][iMBXY], 0);
+    GetRefPic (&pMCRefMem, pCurDqLayer, pCurDqLayer->pRefIndex[0][iMBXY], 0);
     BaseMC (&pMCRefMem, iMBOffsetX, iMBOffsetY, pMCFunc, 16, 16, iMVs);
     break;
   case MB_TYPE_16x8:
     iMVs[0] = pCurDqLayer->pMv[0][iMBXY][0][0];
     iMVs[1] = pCurDqLayer->pMv[0][iMBXY][0][1];
-    GetRefPic (&pMCRefMem, pCtx, pCurDqLayer->pRefIndex[0][iMBXY], 0);
+    GetRefPic (&pMCRefMem, pCurDqLayer, pCurDqLayer->pRefIndex[0][iMBXY], 0);
     BaseMC (&pMCRefMem, iMBOffsetX, iMBOffsetY, pMCFunc, 16, 8, iMVs);
 
     iMVs[0] = pCurDqLayer->pMv[0][iMBXY][8][0];
     iMVs[1] = pCurDqLayer->pMv[0][iMBXY][8][1];
-    GetRefPic (&pMCRefMem, pCtx, pCurDqLayer->pRefIndex[0][iMBXY], 8);
+    GetRefPic (&pMCRefMem, pCurDqLayer, pCurDqLayer->pRefIndex[0][iMBXY], 8);
     pMCRefMem.pDstY = pPredY  + (iDstLineLuma << 3);
     pMCRefMem.pDstU = pPredCb + (iDstLineChroma << 2);
     pMCRefMem.pDstV = pPredCr + (iDstLineChroma << 2);
@@ -342,12 +366,12 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
   case MB_TYPE_8x16:
     iMVs[0] = pCurDqLayer->pMv[0][iMBXY][0][0];
     iMVs[1] = pCurDqLayer->pMv[0][iMBXY][0][1];
-    GetRefPic (&pMCRefMem, pCtx, pCurDqLayer->pRefIndex[0][iMBXY], 0);
+    GetRefPic (&pMCRefMem, pCurDqLayer, pCurDqLayer->pRefIndex[0][iMBXY], 0);
     BaseMC (&pMCRefMem, iMBOffsetX, iMBOffsetY, pMCFunc, 8, 16, iMVs);
 
     iMVs[0] = pCurDqLayer->pMv[0][iMBXY][2][0];
     iMVs[1] = pCurDqLayer->pMv[0][iMBXY][2][1];
-    GetRefPic (&pMCRefMem, pCtx, pCurDqLayer->pRefIndex[0][iMBXY], 2);
+    GetRefPic (&pMCRefMem, pCurDqLayer, pCurDqLayer->pRefIndex[0][iMBXY], 2);
     pMCRefMem.pDstY = pPredY + 8;
     pMCRefMem.pDstU = pPredCb + 4;
     pMCRefMem.pDstV = pPredCr + 4;
@@ -366,7 +390,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
       iYOffset = iMBOffsetY + iBlk8Y;
 
       iIIdx = ((i >> 1) << 3) + ((i & 1) << 1);
-      GetRefPic (&pMCRefMem, pCtx, pCurDqLayer->pRefIndex[0][iMBXY], iIIdx);
+      GetRefPic (&pMCRefMem, pCurDqLayer, pCurDqLayer->pRefIndex[0][iMBXY], iIIdx);
 
       pDstY = pPredY + iBlk8X + iBlk8Y * iDstLineLuma;
       pDstU = pPredCb + (iBlk8X >> 1) + (iBlk8Y >> 1) * iDstLineChroma;
@@ -435,7 +459,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
 }
 
 int32_t RecChroma (int32_t iMBXY, PWelsDecoderContext pCtx, int16_t* pScoeffLevel, PDqLayer pDqLayer) {
-  int32_t iChromaStride = pCtx->pCurDqLayer->pDec->iLinesize[1];
+  int32_t iChromaStride = pDqLayer->pDec->iLinesize[1];
   PIdctResAddPredFunc pIdctResAddPredFunc = pCtx->pIdctResAddPredFunc;
 
   uint8_t i = 0, j = 0;
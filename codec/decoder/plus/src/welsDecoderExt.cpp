@@ -44,7 +44,7 @@
 #include "welsCodecTrace.h"
 #include "codec_def.h"
 #include "typedefs.h"
-#include "mem_align.h"
+#include "memory_align.h"
 #include "utils.h"
 
 //#include "macros.h"
@@ -54,6 +54,7 @@ extern "C" {
 #include "decoder_core.h"
 #include "manage_dec_ref.h"
 }
+#include "dec_multi_threading.h"
 #include "error_code.h"
 #include "crt_util_safe_x.h"	// Safe CRT routines like util for cross platforms
 #include <time.h>
@@ -213,7 +214,9 @@ void CWelsDecoder::UninitDecoder (void) {
   WelsEndDecoder (m_pDecContext);
 
   if (NULL != m_pDecContext) {
-    WelsFree (m_pDecContext, "m_pDecContext");
+    CMemoryAlign* pMemAlign = m_pDecContext->pMemAlign;
+    pMemAlign->WelsFree (m_pDecContext, "m_pDecContext");
+    delete pMemAlign;
 
     m_pDecContext	= NULL;
   }
@@ -225,7 +228,13 @@ void CWelsDecoder::UninitDecoder (void) {
 void CWelsDecoder::InitDecoder (void) {
   IWelsTrace::WelsVTrace (m_pTrace, IWelsTrace::WELS_LOG_INFO, "CWelsDecoder::init_decoder()..");
 
-  m_pDecContext	= (PWelsDecoderContext)WelsMalloc (sizeof (SWelsDecoderContext), "m_pDecContext");
+  CMemoryAlign* pMemAlign = new CMemoryAlign (16);
+  m_pDecContext	= (PWelsDecoderContext)pMemAlign->WelsMallocz (sizeof (SWelsDecoderContext), "m_pDecContext");
+  if (NULL == m_pDecContext) {
+    delete pMemAlign;
+    return;
+  }
+  m_pDecContext->pMemAlign = pMemAlign;
 
   WelsInitDecoder (m_pDecContext, m_pTrace, IWelsTrace::WelsTrace);
 
@@ -264,6 +273,29 @@ long CWelsDecoder::SetOption (DECODER_OPTION eOptID, void* pOption) {
       iVal = * ((int*)pOption); //EC method
     m_pDecContext->iErrorConMethod = iVal;
     return cmResultSuccess;
+  } else if (eOptID == DECODER_OPTION_ZERO_COPY_INPUT) { // Parse NALs in the application buffers
+    if (pOption == NULL)
+      return cmInitParaError;
+
+    iVal = * ((int*)pOption);
+
+    m_pDecContext->bZeroCopyInput = iVal ? true : false;
+
+    return cmResultSuccess;
+  } else if (eOptID == DECODER_OPTION_BUFFER_PROVIDER) { // Reconstruct into buffers of the application
+    const SPictureBufferProvider* kpProvider = static_cast<SPictureBufferProvider*> (pOption);
+
+    // pictures have their buffers from the start of decoding on
+    if (m_pDecContext->bHaveGotMemory
+        || (NULL != kpProvider && (NULL == kpProvider->pGetBuffer) != (NULL == kpProvider->pReleaseBuffer)))
+      return cmInitParaError;
+
+    if (NULL == kpProvider)
+      memset (&m_pDecContext->sBufferProvider, 0, sizeof (SPictureBufferProvider));
+    else
+      m_pDecContext->sBufferProvider = *kpProvider;
+
+    return cmResultSuccess;
   }
 
   return cmInitParaError;
@@ -321,6 +353,19 @@ long CWelsDecoder::GetOption (DECODER_OPTION eOptID, void* pOption) {
     iVal = m_pDecContext->iErrorConMethod;
     * ((int*)pOption) = iVal;
     return cmResultSuccess;
+  } else if (DECODER_OPTION_ZERO_COPY_INPUT == eOptID) {
+    iVal = m_pDecContext->bZeroCopyInput;
+    * ((int*)pOption) = iVal;
+    return cmResultSuccess;
+  } else if (DECODER_OPTION_MEMORY_USAGE == eOptID) {
+    SMemoryUsage* pUsage = static_cast<SMemoryUsage*> (pOption);
+    pUsage->uiCurrentBytes	= m_pDecContext->pMemAlign->WelsGetMemoryUsage();
+    pUsage->uiPeakBytes		= m_pDecContext->pMemAlign->WelsGetPeakMemoryUsage();
+    pUsage->uiIdleBytes		= m_pDecContext->pMemAlign->WelsGetIdleMemoryUsage();
+    return cmResultSuccess;
+  } else if (DECODER_OPTION_BUFFER_PROVIDER == eOptID) {
+    * ((SPictureBufferProvider*)pOption) = m_pDecContext->sBufferProvider;
+    return cmResultSuccess;
   }
 
   return cmInitParaError;
@@ -372,6 +417,11 @@ DECODING_STATE CWelsDecoder::DecodeFrame2 (const unsigned char* kpSrc,
   WelsDecodeBs (m_pDecContext, kpSrc, kiSrcLen, (unsigned char**)ppDst,
                 pDstInfo); //iErrorCode has been modified in this function
 
+  if (NULL != m_pDecContext->pThreadCtx) {
+    // frames come out in decoding order once their reconstruction is finished
+    FetchFrameTaskOutput (m_pDecContext, (unsigned char**)ppDst, pDstInfo);
+  }
+
   if (m_pDecContext->iErrorCode) {
     ENalUnitType eNalType =
       NAL_UNIT_UNSPEC_0;	//for NBR, IDR frames are expected to decode as followed if error decoding an IDR currently
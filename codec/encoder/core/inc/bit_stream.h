@@ -46,9 +46,8 @@ typedef struct TagBitStringAux {
   uint8_t*		pBuf;		// pBuffer to start position
   uint8_t*		pBufEnd;	// pBuffer + length
   uint8_t*		pBufPtr;	// current writing position
-  uint32_t    uiCurBits;
-  int32_t		iLeftBits;	// count number of available bits left ([1, 8]),
-  // need pointer to next byte start position in case 0 bit left then 8 instead
+  uint64_t    uiCurBits;	// pending bits in the low 64 - iLeftBits bits, stored 8 bytes at a time
+  int32_t		iLeftBits;	// count number of available bits left ([1, 64])
 } SBitStringAux;
 
 /*!
@@ -66,7 +65,7 @@ static inline int32_t InitBits (SBitStringAux* pBs, const uint8_t* kpBuf, const
   pBs->pBuf			= ptr;
   pBs->pBufPtr		= ptr;
   pBs->pBufEnd		= ptr + kiSize;
-  pBs->iLeftBits	= 32;
+  pBs->iLeftBits	= 64;
   pBs->uiCurBits = 0;
 
   return kiSize;
@@ -0,0 +1,125 @@
+/*!
+ * \copy
+ *     Copyright (c)  2014, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file	enc_pipeline.h
+ *
+ * \brief	pipelined encoding: the submitting thread copies, denoises and downsamples the next source
+ *			pictures while an internal thread codes the frames submitted before
+ *
+ * \date	10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+#ifndef WELS_ENC_PIPELINE_H__
+#define WELS_ENC_PIPELINE_H__
+
+#include "typedefs.h"
+#include "codec_app_def.h"
+#include "WelsThreadLib.h"
+#include "encoder_context.h"
+#include "wels_preprocess.h"
+
+namespace WelsSVCEnc {
+
+#define ENC_PIPELINE_DEPTH	4	// one frame held by the application, one being coded and two prepared ahead
+
+enum EEncPipelineFrameState {
+  PIPELINE_FRAME_IDLE = 0,	// slot free
+  PIPELINE_FRAME_QUEUED,		// source prepared, waiting for the coding thread
+  PIPELINE_FRAME_DONE,		// coded, bitstream pending
+  PIPELINE_FRAME_DELIVERED	// bitstream handed to application, released at next fetch
+};
+
+/* one submitted frame, from preprocessing up to delivery of its bitstream */
+typedef struct TagEncPipelineFrame {
+  EEncPipelineFrameState	eState;
+  SPreparedPicture	sPrepared;
+  SSourcePicture		sSrcPic;		// description of the submitted picture, its planes are not accessed any more
+  SFrameBSInfo		sBsInfo;		// layers point into pBs once coded
+  uint8_t*			pBs;
+  int32_t				iBsSize;
+  int32_t				iResult;		// ENC_RETURN_*
+} SEncPipelineFrame;
+
+struct TagEncPipeline {
+  WELS_THREAD_HANDLE	hThread;
+
+  WELS_MUTEX		hLock;			// guards the frame states and indices below
+  WELS_COND		hTaskCond;		// signaled on queued frame or exit request
+  WELS_COND		hDoneCond;		// broadcast when a frame is coded
+  bool			bExit;
+
+  SEncPipelineFrame	sFrames[ENC_PIPELINE_DEPTH];	// ring of frames in submission order
+  uint32_t		uiFirst;		// oldest frame not released
+  uint32_t		uiCoded;		// next frame to be coded
+  uint32_t		uiNext;			// slot of the next submitted frame
+  int32_t			iFatalError;	// ENC_RETURN_MEMALLOCERR once coding failed for lack of memory
+
+  sWelsEncCtx*	pCtx;
+};
+
+/*!
+ * \brief	allocate the frame slots and start the coding thread
+ * \return	ENC_RETURN_SUCCESS - successful; ENC_RETURN_UNSUPPORTED_PARA - no thread; otherwise - failed
+ */
+int32_t InitEncPipeline (sWelsEncCtx* pCtx);
+
+/*!
+ * \brief	wait for queued frames, stop the coding thread and free related memory, bitstreams not fetched are lost
+ */
+void UninitEncPipeline (sWelsEncCtx* pCtx);
+
+/*!
+ * \brief	prepare the source picture in the calling thread and queue it for coding
+ * \return	ENC_RETURN_SUCCESS - queued; ENC_RETURN_UNEXPECTED - no slot left before fetching; otherwise - failed
+ */
+int32_t SubmitPipelineFrame (sWelsEncCtx* pCtx, const SSourcePicture* kpSrcPic);
+
+/*!
+ * \brief	output the oldest submitted frame if coded, waiting for it when kbWait is true
+ * \return	result of coding the frame, pFbi->eOutputFrameType is videoFrameTypeInvalid when none is output
+ */
+int32_t FetchPipelineFrame (sWelsEncCtx* pCtx, SFrameBSInfo* pFbi, const bool kbWait);
+
+/*!
+ * \brief	wait until every submitted frame is coded, so that the context can be used by the calling thread
+ */
+void DrainEncPipeline (sWelsEncCtx* pCtx);
+
+/*!
+ * \brief	check for submitted frames whose bitstreams are not fetched yet, which a reset of the context would lose
+ * \return	true - some frames are not fetched; false - none
+ */
+bool PendingPipelineFrames (sWelsEncCtx* pCtx);
+
+} // namespace WelsSVCEnc
+
+#endif//WELS_ENC_PIPELINE_H__
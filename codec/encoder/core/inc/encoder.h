@@ -53,9 +53,16 @@ int32_t RequestMemorySvc (sWelsEncCtx** ppCtx);
 /*!
  * \brief	free memory	in SVC core encoder
  * \param	pEncCtx		sWelsEncCtx**
+ * \param	ppMemAlign	if not NULL, receives the allocator instead of deleting it
  * \return	none
  */
-void FreeMemorySvc (sWelsEncCtx** ppCtx);
+void FreeMemorySvc (sWelsEncCtx** ppCtx, CMemoryAlign** ppMemAlign = NULL);
+
+/*!
+ * \brief	enlarge pFrameBs so that kiNeededLen bytes fit behind iPosBsBuffer, keeping what was written
+ * \return	ENC_RETURN_SUCCESS if done; ENC_RETURN_MEMALLOCERR if out of memory
+ */
+int32_t GrowFrameBs (sWelsEncCtx* pCtx, const int32_t kiNeededLen);
 
 /*!
  * \brief	 allocate or reallocate the output bs buffer
@@ -59,6 +59,9 @@
 
 namespace WelsSVCEnc {
 
+typedef struct TagEncPipeline SEncPipeline;
+typedef struct TagLayerThreading SLayerThreading;
+
 /*
  *	reference list for each quality layer in SVC
  */
@@ -131,6 +134,7 @@ typedef struct TagWelsEncCtx {
   SWelsFuncPtrList*			pFuncList;
 
   SSliceThreading*				pSliceThreading;
+  SLayerThreading*				pLayerThreading;	// spatial layers coded concurrently, NULL unless bParallelSpatialLayers
 
   // SSlice context
   SSliceCtx*				pSliceCtxList;// slice context table for each dependency quality layer
@@ -171,6 +175,8 @@ typedef struct TagWelsEncCtx {
   // VAA
   SVAAFrameInfo*		    	pVaa;		    // VAA information of reference
   CWelsPreProcess*				pVpp;
+  SPreparedPicture*			pPreparedPic;	// source of the frame being coded made ready by the pipeline, NULL otherwise
+  SEncPipeline*				pPipeline;		// pipelined encoding, created by the first submitted frame
 
   SWelsSPS*							pSpsArray;		// MAX_SPS_COUNT by standard compatible
   SWelsSPS*							pSps;
@@ -187,6 +193,7 @@ typedef struct TagWelsEncCtx {
   uint8_t*						pFrameBs;		// restoring bitstream pBuffer of all NALs in a frame
   int32_t						iFrameBsSize;	// count size of frame bs in bytes allocated
   int32_t						iPosBsBuffer;	// current writing position of frame bs pBuffer
+  SFrameBSInfo*				pFrameBsInfo;	// output of the frame being coded, its layers are moved along when pFrameBs grows
 
   SSpatialPicIndex			sSpatialIndexMap[MAX_DEPENDENCY_LAYER];
 
@@ -222,5 +229,31 @@ typedef struct TagWelsEncCtx {
   WELS_MUTEX					mutexEncoderError;
 
 } sWelsEncCtx/*, *PWelsEncCtx*/;
+
+/*
+ *	spatial layer coded concurrently with the other layers of the frame, on a copy of the encoder context
+ *	refreshed at each frame while its buffers and function list below stay private to the layer
+ */
+typedef struct TagLayerTask {
+  sWelsEncCtx					sCtx;
+  SWelsFuncPtrList*			pFuncList;
+  SWelsEncoderOutput*			pOut;
+  SVAAFrameInfo*				pVaa;
+  uint8_t*						pFrameBs;		// moved to sCtx while coding, it may be enlarged there
+  int32_t						iFrameBsSize;
+  SFrameBSInfo				sFbi;			// layers written by the task, pBsBuf points into pFrameBs
+
+  int32_t						iSpatialIdx;
+  EVideoFrameType				eFrameType;
+  int32_t						iLayerNum;		// count of sFbi.sLayerInfo written
+  int32_t						iReturn;
+} SLayerTask;
+
+struct TagLayerThreading {
+  SWelsThreadPool*				pThreadPool;	// shared with other encoders of the process
+  SWelsTaskGroup				sLayerTasks;
+  WELS_MUTEX					mutexPreProcess;	// the preprocessing interface analyses one layer at a time
+  SLayerTask					sTask[MAX_DEPENDENCY_LAYER];	// [iDid]
+};
 }
 #endif//sWelsEncCtx_H__
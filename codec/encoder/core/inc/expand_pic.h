@@ -50,6 +50,12 @@ typedef void (*PExpandPictureFunc) (uint8_t* pDst, const int32_t kiStride, const
 
 void ExpandReferencingPicture (SPicture* pPic, PExpandPictureFunc pExpLuma, PExpandPictureFunc pExpChrom[2]);
 
+/*!
+ * \brief	pad the lines of MB row kiMbY of a picture, the top and bottom margins go with its first and last MB row
+ *			so that padding every MB row once the row is final gives what ExpandReferencingPicture() does
+ */
+void ExpandReferencingPictureMbRow (SPicture* pPic, const int32_t kiMbY);
+
 void InitExpandPictureFunc (void* pL, const uint32_t kuiCPUFlags);
 }
 #endif
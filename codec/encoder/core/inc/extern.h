@@ -73,16 +73,18 @@ void GomValidCheck (const int32_t kiMbWidth, const int32_t kiMbHeight, int32_t*
  * \brief	initialize Wels avc encoder core library
  * \param	ppCtx		sWelsEncCtx**
  * \param	para		SWelsSvcCodingParam*
+ * \param	pMemAlign	allocator handed back by WelsUninitEncoderExt() to reuse its idle blocks, owned by the call
  * \return	successful - 0; otherwise none 0 for failed
  */
-int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pPara);
+int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pPara, CMemoryAlign* pMemAlign = NULL);
 
 /*!
  * \brief	uninitialize Wels encoder core library
  * \param	pEncCtx		sWelsEncCtx*
+ * \param	ppMemAlign	if not NULL, receives the allocator instead of deleting it
  * \return	none
  */
-void WelsUninitEncoderExt (sWelsEncCtx** ppCtx);
+void WelsUninitEncoderExt (sWelsEncCtx** ppCtx, CMemoryAlign** ppMemAlign = NULL);
 
 /*!
  * \brief	core svc encoding process
@@ -104,6 +106,7 @@ int32_t ForceCodingIDR (sWelsEncCtx* pCtx);
 /*!
  * \brief	Wels SVC encoder parameters adjustment
  *			SVC adjustment results in new requirement in memory blocks adjustment
+ * \return	ENC_RETURN_SUCCESS - successful; ENC_RETURN_UNEXPECTED - a reset is needed while pipelined frames are not fetched
  */
 int32_t WelsEncoderParamAdjust (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pNew);
 void WelsEncoderApplyFrameRate (SWelsSvcCodingParam* pParam);
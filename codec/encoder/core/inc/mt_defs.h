@@ -44,6 +44,7 @@
 #include "codec_app_def.h"
 #include "wels_const.h"
 #include "WelsThreadLib.h"
+#include "WelsThreadPool.h"
 
 /*
  *	MT_DEBUG: output trace MT related into log file
@@ -61,8 +62,7 @@
 typedef struct TagSliceThreadPrivateData {
 void*		pWelsPEncCtx;
 SLayerBSInfo*	pLayerBs;
-int32_t		iSliceIndex;	// slice index, zero based
-int32_t		iThreadIndex;	// thread index, zero based
+int32_t		iSliceIndex;	// slice index, zero based; partition index for dynamic slicing mode
 
 // for dynamic slicing mode
 int32_t		iStartMbIndex;	// inclusive
@@ -70,19 +70,16 @@ int32_t		iEndMbIndex;	// exclusive
 } SSliceThreadPrivateData;
 
 typedef struct TagSliceThreading {
-SSliceThreadPrivateData*	pThreadPEncCtx;// thread context, [iThreadIdx]
-char eventNamespace[100];
-WELS_THREAD_HANDLE			pThreadHandles[MAX_THREADS_NUM];// thread handles, [iThreadIdx]
-WELS_EVENT					pSliceCodedEvent[MAX_THREADS_NUM];// events for slice coded state, [iThreadIdx]
-WELS_EVENT					pSliceCodedMasterEvent;	// events for signalling that some event in pSliceCodedEvent has been signalled
-WELS_EVENT					pReadySliceCodingEvent[MAX_THREADS_NUM];	// events for slice coding ready, [iThreadIdx]
-WELS_EVENT					pUpdateMbListEvent[MAX_THREADS_NUM];		// signal to update mb list neighbor for various slices
-WELS_EVENT					pFinUpdateMbListEvent[MAX_THREADS_NUM];	// signal to indicate finish updating mb list
-WELS_EVENT					pExitEncodeEvent[MAX_THREADS_NUM];			// event for exit encoding event
-WELS_EVENT					pThreadMasterEvent[MAX_THREADS_NUM];	// event for indicating that some event has been signalled to the thread
+SSliceThreadPrivateData*	pThreadPEncCtx;// task context, [iSliceIdx] or [iPartitionIdx]
+SWelsThreadPool*			pThreadPool;	// shared with other encoders of the process
+SWelsTaskGroup				sSliceTasks;	// tasks of the layer being coded
 
 WELS_MUTEX					mutexSliceNumUpdate;	// for dynamic slicing mode MT
 
+WELS_MUTEX					mutexDeblocking;	// for the wavefront deblocking of a whole picture
+WELS_COND					condDeblocking;		// broadcast on progress of a MB row someone waits for
+int32_t*					pDeblockedMbNum;	// count of filtered MBs in each row, [iMbY]
+
 uint32_t*					pSliceConsumeTime[MAX_DEPENDENCY_LAYER];	// consuming time for each slice, [iSpatialIdx][uiSliceIdx]
 float*						pSliceComplexRatio[MAX_DEPENDENCY_LAYER];
 
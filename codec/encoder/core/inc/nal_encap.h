@@ -83,6 +83,7 @@ int32_t				iNalIndex;			// coding NAL currently, 0 based
 typedef struct TagWelsSliceBs {
 uint8_t*				pBs;				// output bitstream, pBitStringAux not needed for slice 0 due to no dependency of pFrameBs available
 uint32_t			uiBsPos;				// position of output bitstream
+uint32_t			uiBsSize;			// size of pBs, allocated apart from pFrameBs so that either can grow
 uint8_t*				pBsBuffer;			// overall bitstream pBuffer allocation for a coded slice, recycling use intend.
 uint32_t			uiSize;				// size of allocation pBuffer above
 
@@ -121,6 +122,13 @@ void WelsLoadNalForSlice (SWelsSliceBs* pSliceBs, const int32_t/*EWelsNalUnitTyp
  */
 void WelsUnloadNalForSlice (SWelsSliceBs* pSliceBs);
 
+/*!
+ * \brief	upper bound of the size WelsEncodeNal() writes for a raw NAL
+ * \param	pRawNal			pRawNal NAL pData
+ * \return	size in bytes, not positive on unexpected payload size
+ */
+int32_t WelsGetNalMaxEncodedSize (SWelsNalRaw* pRawNal);
+
 /*!
  * \brief	encode NAL with emulation forbidden three bytes checking
  * \param	pDst			pDst NAL pData
@@ -151,6 +151,7 @@ static void FillDefault (SEncParamExt& param) {
   param.iTargetBitrate			= 0;	// overall target bitrate introduced in RC module
   param.iMaxBitrate             = MAX_BIT_RATE;
   param.iMultipleThreadIdc		= 1;
+  param.bParallelSpatialLayers	= false;
 
   param.iLTRRefNum				= 0;
   param.iLtrMarkPeriod			= 30;	//the min distance of two int32_t references
@@ -164,6 +165,8 @@ static void FillDefault (SEncParamExt& param) {
   param.iLoopFilterAlphaC0Offset	= 0;	// AlphaOffset: valid range [-6, 6], default 0
   param.iLoopFilterBetaOffset		= 0;	// BetaOffset:	valid range [-6, 6], default 0
 
+  param.bEnableHierarchicalMe		= false;	// seed motion search from the lower layer or a half resolution search
+
   /* Rate Control */
   param.iRCMode			= RC_QUALITY_MODE;
   param.iPaddingFlag	= 0;
@@ -317,6 +320,9 @@ int32_t ParamTranscode (const SEncParamExt& pCodingParam) {
 
   bEnableFrameCroppingFlag	= true;
 
+  /* Motion estimation */
+  bEnableHierarchicalMe	= pCodingParam.bEnableHierarchicalMe ? true : false;
+
   /* Rate Control */
   iRCMode = pCodingParam.iRCMode;    // rc mode
   iPaddingFlag = pCodingParam.iPaddingFlag;
@@ -345,6 +351,7 @@ int32_t ParamTranscode (const SEncParamExt& pCodingParam) {
   iLtrMarkPeriod = pCodingParam.iLtrMarkPeriod;
 
   iMultipleThreadIdc = pCodingParam.iMultipleThreadIdc;
+  bParallelSpatialLayers = pCodingParam.bParallelSpatialLayers ? true : false;
 
   /* For ssei information */
   bEnableSSEI		= true;
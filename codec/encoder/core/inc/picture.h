@@ -65,6 +65,7 @@ typedef struct TagPicture {
   uint8_t*    pBuffer;    // pointer to the first allocated byte, basical offset of pBuffer, dimension:
   uint8_t*    pData[3];    // pointer to picture planes respectively
   int32_t    iLineSize[3];  // iLineSize of picture planes respectively
+  bool       bExternalData;  // pData[] refer to the planes of a source picture of the application instead of pBuffer
 
   // picture information
   /*******************************from other standard syntax****************************/
@@ -91,6 +92,7 @@ typedef struct TagPicture {
   bool    bUsedAsRef;            //for pRef pic management
   bool    bIsLongRef;  // long term reference frame flag  //for pRef pic management
   bool    bIsSceneLTR;  //long term reference & large scene change
+  bool    bExpandedFlag;  // padded along with the deblocking, nothing left to expand for reference
   uint8_t    uiRecieveConfirmed;
   uint8_t    uiTemporalId;
   uint8_t    uiSpatialId;
@@ -68,5 +68,28 @@ void FreePicture (CMemoryAlign* pMa, SPicture** ppPic);
 * \return	none
 */
 void WelsExchangeSpatialPictures (SPicture** ppPic1, SPicture** ppPic2);
+
+/*!
+* \brief	exchange the sample buffers of two pictures of the same size, pictures keep their other members
+* \param	pPic1		picture 1
+* \param	pPic2		picture 2
+* \return	none
+*/
+void WelsExchangePictureData (SPicture* pPic1, SPicture* pPic2);
+
+/*!
+* \brief	let the planes of a picture refer to samples of the application, laid out like the own ones
+* \param	pPic		picture
+* \param	pData		planes to refer to
+* \return	none
+*/
+void WelsReferencePictureData (SPicture* pPic, uint8_t* pData[3]);
+
+/*!
+* \brief	point the planes of a picture back to its own buffer
+* \param	pPic		picture
+* \return	luma plane referred to before; NULL if the picture used its own buffer already
+*/
+uint8_t* WelsUnreferencePictureData (SPicture* pPic);
 }
 #endif//WELS_ENCODER_PICTURE_HANDLE_H__
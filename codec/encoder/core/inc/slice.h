@@ -164,7 +164,7 @@ typedef struct TagSlice {
 
   SMVUnitXY	sMvStartMin;
   SMVUnitXY	sMvStartMax;
-  SMVUnitXY	sMvc[5];
+  SMVUnitXY	sMvc[6];
   uint8_t		uiMvcNum;
   uint8_t		sScaleShift;
 
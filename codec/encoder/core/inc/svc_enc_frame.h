@@ -70,6 +70,13 @@ typedef struct TagFeatureSearchPreparation{
 	int32_t iHighFreMbCount;
 }SFeatureSearchPreparation;//maintain only one
 
+typedef struct TagHierarchicalMe {
+  SMVUnitXY*	pMbMv;			// seed of every MB in quarter pel of the layer, from the lower layer or the half resolution search
+  uint8_t*	pHalfEnc;		// luma of the picture to be coded at half resolution, one 8x8 block per MB
+  uint8_t*	pHalfRef;		// luma of the reference picture at half resolution
+  int32_t	iHalfStride;
+} SHierarchicalMe;
+
 typedef struct TagLayerInfo {
   SNalUnitHeaderExt		sNalHeaderExt;
   SSlice*
@@ -111,6 +118,7 @@ struct TagDqLayer {
   int32_t*					pLastMbIdxOfPartition;			// for dynamic slicing mode
 
   SFeatureSearchPreparation* pFeatureSearchPreparation;
+  SHierarchicalMe*	pHierarchicalMe;	// NULL unless bEnableHierarchicalMe
 
   SDqLayer*				pRefLayer;		// pointer to referencing dq_layer of current layer to be decoded
 
@@ -43,15 +43,19 @@
 #include "typedefs.h"
 #include "bit_stream.h"
 #include "macros.h"
+#include "ls_defines.h"
 
 namespace WelsSVCEnc {
 
-#define WRITE_BE_32(ptr, val) do { \
-        (ptr)[0] = (val) >> 24; \
-        (ptr)[1] = (val) >> 16; \
-        (ptr)[2] = (val) >>  8; \
-        (ptr)[3] = (val) >>  0; \
-    } while (0)
+static inline void WriteBE64 (uint8_t* pBuf, const uint64_t kuiValue) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+ST64 (pBuf, __builtin_bswap64 (kuiValue));
+#else
+for (int32_t i = 0; i < 8; i++) {
+  pBuf[i] = (uint8_t) (kuiValue >> (56 - (i << 3)));
+}
+#endif
+}
 /************************************************************************/
 /* GOLOMB CODIMG FOR WELS ENCODER                                       */
 /************************************************************************/
@@ -62,7 +66,7 @@ namespace WelsSVCEnc {
 
 #define    CAVLC_BS_INIT( pBs )  \
 	uint8_t  * pBufPtr = pBs->pBufPtr; \
-	uint32_t   uiCurBits = pBs->uiCurBits; \
+	uint64_t   uiCurBits = pBs->uiCurBits; \
 	int32_t    iLeftBits = pBs->iLeftBits;
 
 #define    CAVLC_BS_UNINIT( pBs ) \
@@ -79,10 +83,10 @@ namespace WelsSVCEnc {
 	else {\
 	    (n) -= iLeftBits;\
 		uiCurBits = (uiCurBits<<iLeftBits) | ((v)>>(n));\
-		WRITE_BE_32(pBufPtr, uiCurBits);\
-		pBufPtr += 4;\
+		WriteBE64(pBufPtr, uiCurBits);\
+		pBufPtr += 8;\
 		uiCurBits = (v) & ((1<<(n))-1);\
-		iLeftBits = 32 - (n);\
+		iLeftBits = 64 - (n);\
 	}\
 	} ;
 
@@ -147,10 +151,10 @@ if (n < pBs->iLeftBits) {
 } else {
   n -= pBs->iLeftBits;
   pBs->uiCurBits = (pBs->uiCurBits << pBs->iLeftBits) | (kuiValue >> n);
-  WRITE_BE_32(pBs->pBufPtr, pBs->uiCurBits);
-  pBs->pBufPtr += 4;
+  WriteBE64 (pBs->pBufPtr, pBs->uiCurBits);
+  pBs->pBufPtr += 8;
   pBs->uiCurBits = kuiValue & ((1 << n) - 1);
-  pBs->iLeftBits = 32 - n;
+  pBs->iLeftBits = 64 - n;
 }
 return 0;
 }
@@ -166,9 +170,13 @@ return 0;
 
 
 static inline void BsFlush (SBitStringAux* pBs) {
-WRITE_BE_32(pBs->pBufPtr, pBs->uiCurBits << pBs->iLeftBits);
-pBs->pBufPtr += 4 - pBs->iLeftBits / 8;
-pBs->iLeftBits = 32;
+//store the pending bytes only, nothing is written past the data
+const int32_t kiBytes = (64 - pBs->iLeftBits + 7) >> 3;
+for (int32_t i = 0; i < kiBytes; i++) {
+  pBs->pBufPtr[i] = (uint8_t) ((pBs->uiCurBits << pBs->iLeftBits) >> (56 - (i << 3)));
+}
+pBs->pBufPtr += kiBytes;
+pBs->iLeftBits = 64;
 pBs->uiCurBits = 0;	//  for future writing safe, 5/19/2010
 }
 
@@ -243,7 +251,7 @@ return ! (pBs->iLeftBits & 0x7);
 
 
 static inline int32_t BsGetBitsPos (SBitStringAux* pBs) {
-return (((pBs->pBufPtr - pBs->pBuf) << 3) + 32 - pBs->iLeftBits);
+return (((pBs->pBufPtr - pBs->pBuf) << 3) + 64 - pBs->iLeftBits);
 }
 
 }
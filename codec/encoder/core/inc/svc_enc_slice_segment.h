@@ -91,7 +91,7 @@ int32_t		iStartPos;
 int32_t		iCurrentPos;
 
 uint8_t*		pBsStackBufPtr;	// current writing position
-uint32_t    uiBsStackCurBits;
+uint64_t    uiBsStackCurBits;
 int32_t		iBsStackLeftBits;
 
 int32_t		iMbSkipRunStack;
@@ -216,6 +216,10 @@ void HorizontalFullSearchUsingSSE41( void *pFunc, void *vpMe,
                                       const int32_t kiMinPos, const int32_t kiMaxPos,
                                       const bool bVerticalSearch );
 #endif
+#if defined(X86_INTRINSICS)
+uint32_t SampleSad8x8Hor8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, uint16_t*, int32_t*);
+uint32_t SampleSad16x16Hor8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, uint16_t*, int32_t*);
+#endif//X86_INTRINSICS
 void WelsMotionCrossSearch(SWelsFuncPtrList *pFuncList,  SDqLayer* pCurLayer, SWelsME * pMe, const SSlice* pSlice);
 
 // Feature Search Basics
@@ -240,6 +244,20 @@ int32_t ReleaseFeatureSearchPreparation( CMemoryAlign *pMa, uint16_t*& pFeatureO
 #define FME_DEFAULT_FEATURE_INDEX (0)
 void PerformFMEPreprocess( SWelsFuncPtrList *pFunc, SPicture* pRef,
                           SScreenBlockFeatureStorage* pScreenBlockFeatureStorage);
+
+//hierarchical motion estimation related
+#define HIERARCHICAL_ME_RANGE (CAMERA_STARTMV_RANGE>>1) // in pixels of the half resolution picture
+int32_t RequestHierarchicalMe (CMemoryAlign* pMa, const int32_t kiMbWidth, const int32_t kiMbHeight,
+                               SHierarchicalMe* pHierarchicalMe);
+void ReleaseHierarchicalMe (CMemoryAlign* pMa, SHierarchicalMe* pHierarchicalMe);
+void HalfResolutionDownsample_c (uint8_t* pDst, const int32_t kiDstStride, uint8_t* pSrc, const int32_t kiSrcStride,
+                                 const int32_t kiDstWidth, const int32_t kiDstHeight);
+void HalfResolutionMotionSearch (SWelsFuncPtrList* pFuncList, uint8_t* pEnc, uint8_t* pRef, const int32_t kiStride,
+                                 const int32_t kiMbWidth, const int32_t kiMbHeight, SMVUnitXY* pMbMv);
+void ScaleLowerLayerMotion (const SDqLayer* kpLowerLayer, const int32_t kiLowerWidth, const int32_t kiLowerHeight,
+                            const int32_t kiWidth, const int32_t kiHeight, const int32_t kiMbWidth, const int32_t kiMbHeight,
+                            SMVUnitXY* pMbMv);
+void PerformHierarchicalMePreprocess (sWelsEncCtx* pCtx);
 //inline functions
 inline void SetMvWithinIntegerMvRange( const int32_t kiMbWidth, const int32_t kiMbHeight, const int32_t kiMbX, const int32_t kiMbY,
                         const int32_t kiMaxMvRange,
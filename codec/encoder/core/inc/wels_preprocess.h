@@ -60,6 +60,11 @@ typedef  struct {
   int32_t     iScaledHeight[MAX_DEPENDENCY_LAYER];
 } Scaled_Picture;
 
+/* source picture copied, denoised and downsampled ahead of coding, see CWelsPreProcess::PrepareSourcePicture */
+typedef struct {
+  SPicture*	pLayerPic[MAX_DEPENDENCY_LAYER];	// padded picture of each spatial layer
+} SPreparedPicture;
+
 
 typedef struct {
 	int32_t iMinFrameComplexity;
@@ -130,6 +135,18 @@ class CWelsPreProcess {
   void    AnalyzePictureComplexity (sWelsEncCtx* pCtx, SPicture* pCurPicture, SPicture* pRefPicture,
                                     const int32_t kiDependencyId, const bool kbCalculateBGD);
 
+  /* preparation of source pictures in a thread other than the coding one, BuildSpatialPicList then takes
+   * the samples of pCtx->pPreparedPic instead of processing its input */
+  int32_t InitSourcePreparation (sWelsEncCtx* pCtx);
+  void    UninitSourcePreparation (sWelsEncCtx* pCtx);
+  int32_t AllocPreparedPicture (sWelsEncCtx* pCtx, SPreparedPicture* pPrepared);
+  void    FreePreparedPicture (sWelsEncCtx* pCtx, SPreparedPicture* pPrepared);
+  int32_t PrepareSourcePicture (sWelsEncCtx* pCtx, const SSourcePicture* kpSrc, SPreparedPicture* pPrepared);
+
+  /* source pictures of the application referenced instead of copied, see SZeroCopySource */
+  void    SetZeroCopySource (const SZeroCopySource* kpZeroCopy);
+  void    GetZeroCopySource (sWelsEncCtx* pCtx, SZeroCopySource* pZeroCopy);
+
  private:
   int32_t WelsPreprocessCreate();
   int32_t WelsPreprocessDestroy();
@@ -138,10 +155,12 @@ class CWelsPreProcess {
  private:
   int32_t SingleLayerPreprocess (sWelsEncCtx* pEncCtx, const SSourcePicture* kpSrc, Scaled_Picture* m_sScaledPicture);
 
-  void	BilateralDenoising (SPicture* pSrc, const int32_t iWidth, const int32_t iHeight);
+  void	BilateralDenoising (IWelsVP* pVp, SPicture* pSrc, const int32_t iWidth, const int32_t iHeight);
   bool  DetectSceneChange (SPicture* pCurPicture, SPicture* pRefPicture);
-  int32_t DownsamplePadding (SPicture* pSrc, SPicture* pDstPic,  int32_t iSrcWidth, int32_t iSrcHeight,
+  int32_t DownsamplePadding (IWelsVP* pVp, SPicture* pSrc, SPicture* pDstPic,  int32_t iSrcWidth, int32_t iSrcHeight,
                              int32_t iShrinkWidth, int32_t iShrinkHeight, int32_t iTargetWidth, int32_t iTargetHeight);
+  int32_t DownsampleLayersPadding (IWelsVP* pVp, SWelsSvcCodingParam* pSvcParam, Scaled_Picture* pScaledPicture,
+                                   SPicture* pSrc, SPicture* pDstPic[MAX_DEPENDENCY_LAYER]);
 
   void    VaaCalculation (SVAAFrameInfo* pVaaInfo, SPicture* pCurPicture, SPicture* pRefPicture, bool bCalculateSQDiff,
                           bool bCalculateVar, bool bCalculateBGD);
@@ -151,10 +170,14 @@ class CWelsPreProcess {
                    int32_t iActualWidth, int32_t iPaddingWidth, int32_t iActualHeight, int32_t iPaddingHeight);
   void    SetRefMbType (sWelsEncCtx* pCtx, uint32_t** pRefMbTypeArray, int32_t iRefPicType);
 
-  int32_t ColorspaceConvert (SWelsSvcCodingParam* pSvcParam, SPicture* pDstPic, const SSourcePicture* kpSrc,
-                             const int32_t kiWidth, const int32_t kiHeight);
+  int32_t ColorspaceConvert (IWelsVP* pVp, SWelsSvcCodingParam* pSvcParam, Scaled_Picture* pScaledPicture,
+                             SPicture* pDstPic, const SSourcePicture* kpSrc, const int32_t kiTargetWidth,
+                             const int32_t kiTargetHeight, SPicture* pLayerPic[MAX_DEPENDENCY_LAYER]);
   void WelsMoveMemoryWrapper (SWelsSvcCodingParam* pSvcParam, SPicture* pDstPic, const SSourcePicture* kpSrc,
                               const int32_t kiWidth, const int32_t kiHeight);
+  bool ReferenceSource (sWelsEncCtx* pCtx, SPicture* pDstPic, const SSourcePicture* kpSrc);
+  void ReleaseSource (uint8_t* pData);
+  void ReleaseSourcePicture (SPicture* pPic);
 
   ESceneChangeIdc DetectSceneChangeScreen(sWelsEncCtx* pCtx,SPicture* pCurPicture);
   void InitPixMap( const SPicture *pPicture, SPixMap *pPixMap );
@@ -170,8 +193,11 @@ private:
   Scaled_Picture   m_sScaledPicture;
   SPicture*	   m_pLastSpatialPicture[MAX_DEPENDENCY_LAYER][2];
   IWelsVP*         m_pInterfaceVp;
+  Scaled_Picture   m_sPrepScaledPicture;	// for the preparing thread
+  IWelsVP*         m_pPrepInterfaceVp;
   sWelsEncCtx*     m_pEncCtx;
   bool             m_bInitDone;
+  SZeroCopySource  m_sZeroCopySource;
   uint8_t          m_uiSpatialLayersInTemporal[MAX_DEPENDENCY_LAYER];
   uint8_t          m_uiSpatialPicNum[MAX_DEPENDENCY_LAYER];
 public:
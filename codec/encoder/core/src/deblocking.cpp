@@ -40,6 +40,10 @@
 
 #include "deblocking.h"
 #include "cpu_core.h"
+#include "expand_pic.h"
+#if defined(X86_INTRINSICS)
+#include <immintrin.h>
+#endif//X86_INTRINSICS
 
 namespace WelsSVCEnc {
 
@@ -260,6 +264,31 @@ uint32_t DeblockingBSMarginalMBAvcbase (SMB* pCurMb, SMB* pNeighMb, int32_t iEdg
   return uiBSx4;
 }
 
+#if defined(X86_INTRINSICS)
+void DeblockingBSInsideMBNormal_avx2 (SMB* pCurMb, uint8_t uiBS[2][4][4], int8_t* pNnzTab) {
+  DeblockingBSInsideMB_avx2 (pNnzTab, NULL, (const int16_t*)pCurMb->sMv, uiBS);
+}
+
+// the four edge blocks are picked with pshufb/gather from g_kuiTableBIdx; like the
+// C version under SINGLE_REF_FRAME, reference indices are not compared
+WELS_TARGET_AVX2 uint32_t DeblockingBSMarginalMBAvcbase_avx2 (SMB* pCurMb, SMB* pNeighMb, int32_t iEdge) {
+  const __m128i kxOne = _mm_set1_epi8 (1);
+  const __m128i xBIdx  = _mm_cvtsi32_si128 (* (const int32_t*)&g_kuiTableBIdx[iEdge][0]);
+  const __m128i xBnIdx = _mm_cvtsi32_si128 (* (const int32_t*)&g_kuiTableBIdx[iEdge][4]);
+
+  __m128i xNnz = _mm_or_si128 (_mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*)pCurMb->pNonZeroCount), xBIdx),
+                               _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*)pNeighMb->pNonZeroCount), xBnIdx));
+  __m128i xMv = _mm_sub_epi16 (_mm_i32gather_epi32 ((const int*)pCurMb->sMv, _mm_cvtepu8_epi32 (xBIdx), 4),
+                               _mm_i32gather_epi32 ((const int*)pNeighMb->sMv, _mm_cvtepu8_epi32 (xBnIdx), 4));
+  xMv = _mm_cmpgt_epi16 (_mm_abs_epi16 (xMv), _mm_set1_epi16 (3));
+  xMv = _mm_packs_epi16 (_mm_packs_epi32 (xMv, xMv), xMv);
+
+  xNnz = _mm_min_epu8 (xNnz, kxOne);
+  __m128i xBs = _mm_max_epu8 (_mm_add_epi8 (xNnz, xNnz), _mm_min_epu8 (xMv, kxOne));
+  return (uint32_t)_mm_cvtsi128_si32 (xBs);
+}
+#endif//X86_INTRINSICS
+
 void FilteringEdgeLumaH (DeblockingFunc* pfDeblocking, SDeblockingFilter* pFilter, uint8_t* pPix, int32_t iStride,
                          uint8_t* pBS) {
   int32_t iIdexA;
@@ -623,14 +652,14 @@ void DeblockingMbAvcbase (SWelsFuncPtrList* pFunc, SMB* pCurMb, SDeblockingFilte
     }
 #else
     if (iLeftFlag) {
-      * (uint32_t*)uiBS[0][0] = IS_INTRA ((pCurMb - 1)->uiMbType) ? 0x04040404 : DeblockingBSMarginalMBAvcbase (pCurMb,
-                                pCurMb - 1, 0);
+      * (uint32_t*)uiBS[0][0] = IS_INTRA ((pCurMb - 1)->uiMbType) ? 0x04040404 :
+                                pFunc->pfDeblocking.pfDeblockingBSMarginalMB (pCurMb, pCurMb - 1, 0);
     } else {
       * (uint32_t*)uiBS[0][0] = 0;
     }
     if (iTopFlag) {
-      * (uint32_t*)uiBS[1][0] = IS_INTRA ((pCurMb - iMbStride)->uiMbType) ? 0x04040404 : DeblockingBSMarginalMBAvcbase (
-                                  pCurMb, (pCurMb - iMbStride), 1);
+      * (uint32_t*)uiBS[1][0] = IS_INTRA ((pCurMb - iMbStride)->uiMbType) ? 0x04040404 :
+                                pFunc->pfDeblocking.pfDeblockingBSMarginalMB (pCurMb, (pCurMb - iMbStride), 1);
     } else {
       * (uint32_t*)uiBS[1][0] = 0;
     }
@@ -641,7 +670,7 @@ void DeblockingMbAvcbase (SWelsFuncPtrList* pFunc, SMB* pCurMb, SDeblockingFilte
       if (uiCurMbType == MB_TYPE_16x16) {
         DeblockingBSInsideMBAvsbase (pCurMb->pNonZeroCount, uiBS, 1);
       } else {
-        DeblockingBSInsideMBNormal (pCurMb, uiBS, pCurMb->pNonZeroCount);
+        pFunc->pfDeblocking.pfDeblockingBSInsideMBNormal (pCurMb, uiBS, pCurMb->pNonZeroCount);
       }
     } else {
       * (uint32_t*)uiBS[0][1] = * (uint32_t*)uiBS[0][2] = * (uint32_t*)uiBS[0][3] =
@@ -739,14 +768,124 @@ void DeblockingFilterSliceAvcbase (SDqLayer* pCurDq, SWelsFuncPtrList* pFunc, co
   }
 }
 
+typedef struct TagDeblockingWavefront {
+SDqLayer*			pCurDq;
+SWelsFuncPtrList*	pFunc;
+SSliceThreading*	pSmt;
+int32_t				iNextMbY;		// next MB row to be claimed, under mutexDeblocking
+int32_t				iWaitingNum;	// tasks waiting on condDeblocking
+} SDeblockingWavefront;
+
+/*!
+ * \brief	filter the MB rows of a picture one after another as they are claimed, each MB waiting until the
+ *			row above has filtered the MBs it touches; padded for reference as soon as a row is final
+ * \note	rows are claimed in order and only by running tasks, so the row waited for is always in progress
+ */
+static void DeblockingMbRowsTask (void* pArg) {
+  SDeblockingWavefront* pWf		= (SDeblockingWavefront*)pArg;
+  SDqLayer* pCurDq				= pWf->pCurDq;
+  SSliceThreading* pSmt			= pWf->pSmt;
+  SSliceHeaderExt* sSliceHeaderExt	= &pCurDq->sLayerInfo.pSliceInLayer[0].sSliceHeaderExt;
+  const int32_t kiMbWidth		= pCurDq->iMbWidth;
+  const int32_t kiMbHeight		= pCurDq->iMbHeight;
+  SDeblockingFilter pFilter;
+
+  pFilter.uiFilterIdc = (sSliceHeaderExt->sSliceHeader.uiDisableDeblockingFilterIdc != 0);
+  pFilter.iCsStride[0] = pCurDq->pDecPic->iLineSize[0];
+  pFilter.iCsStride[1] = pCurDq->pDecPic->iLineSize[1];
+  pFilter.iCsStride[2] = pCurDq->pDecPic->iLineSize[2];
+  pFilter.iSliceAlphaC0Offset = sSliceHeaderExt->sSliceHeader.iSliceAlphaC0Offset;
+  pFilter.iSliceBetaOffset     = sSliceHeaderExt->sSliceHeader.iSliceBetaOffset;
+  pFilter.iMbStride = kiMbWidth;
+
+  for (; ;) {
+    int32_t iMbY, i;
+    int32_t iAboveDone = kiMbWidth;	// known progress of the row above
+
+    WelsMutexLock (&pSmt->mutexDeblocking);
+    iMbY = pWf->iNextMbY ++;
+    WelsMutexUnlock (&pSmt->mutexDeblocking);
+    if (iMbY >= kiMbHeight)
+      break;
+    if (iMbY > 0)
+      iAboveDone = 0;
+
+    SMB* pCurrentMbBlock	= pCurDq->sMbDataP + iMbY * kiMbWidth;
+    pFilter.pCsData[0] = pCurDq->pDecPic->pData[0] + ((iMbY * pFilter.iCsStride[0]) << 4);
+    pFilter.pCsData[1] = pCurDq->pDecPic->pData[1] + ((iMbY * pFilter.iCsStride[1]) << 3);
+    pFilter.pCsData[2] = pCurDq->pDecPic->pData[2] + ((iMbY * pFilter.iCsStride[2]) << 3);
+    for (i = 0; i < kiMbWidth; i++) {
+      // the top edge of MB i reads what the left edge filtering of MB i+1 above leaves
+      const int32_t kiNeeded = WELS_MIN (i + 2, kiMbWidth);
+      if (iAboveDone < kiNeeded) {
+        WelsMutexLock (&pSmt->mutexDeblocking);
+        while (pSmt->pDeblockedMbNum[iMbY - 1] < kiNeeded) {
+          ++ pWf->iWaitingNum;
+          WelsCondWait (&pSmt->condDeblocking, &pSmt->mutexDeblocking);
+          -- pWf->iWaitingNum;
+        }
+        iAboveDone = pSmt->pDeblockedMbNum[iMbY - 1];
+        WelsMutexUnlock (&pSmt->mutexDeblocking);
+      }
+
+      DeblockingMbAvcbase (pWf->pFunc, pCurrentMbBlock, &pFilter);
+      ++pCurrentMbBlock;
+      pFilter.pCsData[0] += MB_WIDTH_LUMA;
+      pFilter.pCsData[1] += MB_WIDTH_CHROMA;
+      pFilter.pCsData[2] += MB_WIDTH_CHROMA;
+
+      WelsMutexLock (&pSmt->mutexDeblocking);
+      pSmt->pDeblockedMbNum[iMbY] = i + 1;
+      if (pWf->iWaitingNum > 0)
+        WelsCondBroadcast (&pSmt->condDeblocking);
+      WelsMutexUnlock (&pSmt->mutexDeblocking);
+    }
+
+    // nothing touches the row above any more, nor this one once it is the last
+    if (iMbY > 0)
+      ExpandReferencingPictureMbRow (pCurDq->pDecPic, iMbY - 1);
+    if (iMbY == kiMbHeight - 1)
+      ExpandReferencingPictureMbRow (pCurDq->pDecPic, iMbY);
+  }
+}
+
+/*!
+ * \brief	DeblockingFilterFrameAvcbase() on the slice threads, padding the picture for reference on the way
+ */
+static void DeblockingFilterFrameWavefront (SDqLayer* pCurDq, SWelsFuncPtrList* pFunc, SSliceThreading* pSmt,
+    const int32_t kiTaskNum) {
+  SDeblockingWavefront sWf;
+  int32_t iTaskIdx = 0;
+
+  sWf.pCurDq		= pCurDq;
+  sWf.pFunc		= pFunc;
+  sWf.pSmt		= pSmt;
+  sWf.iNextMbY		= 0;
+  sWf.iWaitingNum	= 0;
+  memset (pSmt->pDeblockedMbNum, 0, pCurDq->iMbHeight * sizeof (int32_t));
+
+  while (iTaskIdx < kiTaskNum) {
+    WelsThreadPoolSubmit (pSmt->pThreadPool, &pSmt->sSliceTasks, DeblockingMbRowsTask, &sWf);
+    ++ iTaskIdx;
+  }
+  WelsThreadPoolWait (pSmt->pThreadPool, &pSmt->sSliceTasks);
+  pCurDq->pDecPic->bExpandedFlag = true;
+}
+
 void PerformDeblockingFilter (sWelsEncCtx* pEnc) {
   const int32_t kiCurDid				= pEnc->uiDependencyId;
   SWelsSvcCodingParam* pSvcParam	= pEnc->pSvcParam;
   SDLayerParam* pDlp					= &pSvcParam->sDependencyLayers[kiCurDid];
   SDqLayer* pCurLayer					= pEnc->pCurDqLayer;
 
+  pCurLayer->pDecPic->bExpandedFlag = false;
   if (pCurLayer->iLoopFilterDisableIdc == 0) {
-    DeblockingFilterFrameAvcbase (pCurLayer, pEnc->pFuncList);
+    const int32_t kiTaskNum	= WELS_MIN (pSvcParam->iCountThreadsNum, pCurLayer->iMbHeight);
+    if (NULL != pEnc->pSliceThreading && kiTaskNum > 1
+        && pCurLayer->sLayerInfo.pSliceInLayer[0].sSliceHeaderExt.sSliceHeader.uiDisableDeblockingFilterIdc != 1)
+      DeblockingFilterFrameWavefront (pCurLayer, pEnc->pFuncList, pEnc->pSliceThreading, kiTaskNum);
+    else
+      DeblockingFilterFrameAvcbase (pCurLayer, pEnc->pFuncList);
   } else if (pCurLayer->iLoopFilterDisableIdc == 2) {
     int32_t iSliceCount			= 0;
     int32_t iSliceIdx			= 0;
@@ -803,6 +942,8 @@ void  DeblockingInit (DeblockingFunc*   pFunc,  int32_t iCpu) {
   pFunc->pfChromaDeblockingLT4Hor	= DeblockChromaLt4H_c;
   pFunc->pfChromaDeblockingEQ4Hor	= DeblockChromaEq4H_c;
 
+  pFunc->pfDeblockingBSInsideMBNormal = DeblockingBSInsideMBNormal;
+  pFunc->pfDeblockingBSMarginalMB     = DeblockingBSMarginalMBAvcbase;
 
 #ifdef X86_ASM
   if (iCpu & WELS_CPU_SSSE3) {
@@ -815,7 +956,25 @@ void  DeblockingInit (DeblockingFunc*   pFunc,  int32_t iCpu) {
     pFunc->pfChromaDeblockingLT4Hor	= DeblockChromaLt4H_ssse3;
     pFunc->pfChromaDeblockingEQ4Hor	= DeblockChromaEq4H_ssse3;
   }
+#endif//X86_ASM
+
+#if defined(X86_INTRINSICS)
+  if (iCpu & WELS_CPU_AVX2) {
+    pFunc->pfLumaDeblockingLT4Ver	= DeblockLumaLt4V_avx2;
+    pFunc->pfLumaDeblockingEQ4Ver	= DeblockLumaEq4V_avx2;
+    pFunc->pfLumaDeblockingLT4Hor       = DeblockLumaLt4H_avx2;
+    pFunc->pfLumaDeblockingEQ4Hor       = DeblockLumaEq4H_avx2;
+    pFunc->pfChromaDeblockingLT4Ver	= DeblockChromaLt4V_avx2;
+    pFunc->pfChromaDeblockingEQ4Ver	= DeblockChromaEq4V_avx2;
+    pFunc->pfChromaDeblockingLT4Hor	= DeblockChromaLt4H_avx2;
+    pFunc->pfChromaDeblockingEQ4Hor	= DeblockChromaEq4H_avx2;
+
+    pFunc->pfDeblockingBSInsideMBNormal = DeblockingBSInsideMBNormal_avx2;
+#if defined(SINGLE_REF_FRAME)
+    pFunc->pfDeblockingBSMarginalMB     = DeblockingBSMarginalMBAvcbase_avx2;
 #endif
+  }
+#endif//X86_INTRINSICS
 
 #if defined(HAVE_NEON)
   if (iCpu & WELS_CPU_NEON ) {
@@ -0,0 +1,288 @@
+/*!
+ * \copy
+ *     Copyright (c)  2014, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file	enc_pipeline.cpp
+ *
+ * \brief	pipelined encoding: the submitting thread copies, denoises and downsamples the next source
+ *			pictures while an internal thread codes the frames submitted before
+ *
+ * \date	10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#include <string.h>
+#include "enc_pipeline.h"
+#include "extern.h"
+#include "utils.h"
+
+namespace WelsSVCEnc {
+
+static void OutputNoFrame (SFrameBSInfo* pFbi) {
+  pFbi->iLayerNum			= 0;
+  pFbi->eOutputFrameType	= videoFrameTypeInvalid;
+}
+
+/*
+ *	copy the bitstream of the frame just coded out of pFrameBs, which the next frame reuses
+ */
+static int32_t KeepFrameBitstream (sWelsEncCtx* pCtx, SEncPipelineFrame* pFrame) {
+  SFrameBSInfo* pFbi	= &pFrame->sBsInfo;
+  int32_t iSize		= 0;
+  int32_t i, j;
+
+  for (i = 0; i < pFbi->iLayerNum; i++) {
+    SLayerBSInfo* pLayerBsInfo = &pFbi->sLayerInfo[i];
+    int32_t iEnd = (int32_t) (pLayerBsInfo->pBsBuf - pCtx->pFrameBs);
+    for (j = 0; j < pLayerBsInfo->iNalCount; j++)
+      iEnd += pLayerBsInfo->iNalLengthInByte[j];
+    iSize = WELS_MAX (iSize, iEnd);
+  }
+  if (iSize > pFrame->iBsSize) {
+    pCtx->pMemAlign->WelsFree (pFrame->pBs, "pFrame->pBs");
+    pFrame->iBsSize	= 0;
+    pFrame->pBs		= (uint8_t*)pCtx->pMemAlign->WelsMalloc (iSize, "pFrame->pBs");
+    WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, (NULL == pFrame->pBs))
+    pFrame->iBsSize	= iSize;
+  }
+  if (iSize > 0)
+    memcpy (pFrame->pBs, pCtx->pFrameBs, iSize);	// confirmed_safe_unsafe_usage
+  for (i = 0; i < pFbi->iLayerNum; i++)
+    pFbi->sLayerInfo[i].pBsBuf = pFrame->pBs + (pFbi->sLayerInfo[i].pBsBuf - pCtx->pFrameBs);
+
+  return ENC_RETURN_SUCCESS;
+}
+
+static void CodePipelineFrame (SEncPipeline* pPipeline, SEncPipelineFrame* pFrame) {
+  sWelsEncCtx* pCtx = pPipeline->pCtx;
+
+  memset (&pFrame->sBsInfo, 0, sizeof (SFrameBSInfo));
+  if (pPipeline->iFatalError != ENC_RETURN_SUCCESS) {
+    pFrame->iResult = pPipeline->iFatalError;
+    OutputNoFrame (&pFrame->sBsInfo);
+    return;
+  }
+
+  pCtx->pPreparedPic	= &pFrame->sPrepared;
+  pFrame->iResult		= WelsEncoderEncodeExt (pCtx, &pFrame->sBsInfo, &pFrame->sSrcPic);
+  pCtx->pPreparedPic	= NULL;
+  pCtx->pFrameBsInfo	= NULL;
+
+  if (pFrame->iResult == ENC_RETURN_SUCCESS)
+    pFrame->iResult = KeepFrameBitstream (pCtx, pFrame);
+  if (pFrame->iResult == ENC_RETURN_MEMALLOCERR)
+    pPipeline->iFatalError = ENC_RETURN_MEMALLOCERR;
+}
+
+static WELS_THREAD_ROUTINE_TYPE EncPipelineThreadProc (void* pArg) {
+  SEncPipeline* pPipeline = (SEncPipeline*)pArg;
+
+  WelsMutexLock (&pPipeline->hLock);
+  for (;;) {
+    while (!pPipeline->bExit && pPipeline->uiCoded == pPipeline->uiNext)
+      WelsCondWait (&pPipeline->hTaskCond, &pPipeline->hLock);
+    if (pPipeline->uiCoded == pPipeline->uiNext)
+      break;
+    SEncPipelineFrame* pFrame = &pPipeline->sFrames[pPipeline->uiCoded % ENC_PIPELINE_DEPTH];
+    WelsMutexUnlock (&pPipeline->hLock);
+
+    CodePipelineFrame (pPipeline, pFrame);
+
+    WelsMutexLock (&pPipeline->hLock);
+    pFrame->eState = PIPELINE_FRAME_DONE;
+    ++ pPipeline->uiCoded;
+    WelsCondBroadcast (&pPipeline->hDoneCond);
+  }
+  WelsMutexUnlock (&pPipeline->hLock);
+
+  WELS_THREAD_ROUTINE_RETURN (0);
+}
+
+int32_t InitEncPipeline (sWelsEncCtx* pCtx) {
+  CMemoryAlign* pMa		= pCtx->pMemAlign;
+  SEncPipeline* pPipeline	= NULL;
+  int32_t i;
+
+  UninitEncPipeline (pCtx);
+
+  pPipeline = (SEncPipeline*)pMa->WelsMallocz (sizeof (SEncPipeline), "pPipeline");
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, (NULL == pPipeline))
+  pPipeline->pCtx	= pCtx;
+  WelsMutexInit (&pPipeline->hLock);
+  WelsCondInit (&pPipeline->hTaskCond);
+  WelsCondInit (&pPipeline->hDoneCond);
+  pCtx->pPipeline	= pPipeline;
+
+  if (pCtx->pVpp->InitSourcePreparation (pCtx) != 0) {
+    UninitEncPipeline (pCtx);
+    return ENC_RETURN_MEMALLOCERR;
+  }
+  for (i = 0; i < ENC_PIPELINE_DEPTH; i++) {
+    if (pCtx->pVpp->AllocPreparedPicture (pCtx, &pPipeline->sFrames[i].sPrepared) != 0) {
+      UninitEncPipeline (pCtx);
+      return ENC_RETURN_MEMALLOCERR;
+    }
+  }
+
+  if (WELS_THREAD_ERROR_OK != WelsThreadCreate (&pPipeline->hThread, EncPipelineThreadProc, pPipeline, 0)) {
+    WelsLog (pCtx, WELS_LOG_ERROR, "InitEncPipeline(), coding thread creation failed.\n");
+    pPipeline->hThread = 0;
+    UninitEncPipeline (pCtx);
+    return ENC_RETURN_UNSUPPORTED_PARA;
+  }
+
+  WelsLog (pCtx, WELS_LOG_INFO, "InitEncPipeline(), %d frames in flight.\n", ENC_PIPELINE_DEPTH);
+  return ENC_RETURN_SUCCESS;
+}
+
+void UninitEncPipeline (sWelsEncCtx* pCtx) {
+  SEncPipeline* pPipeline = pCtx->pPipeline;
+  int32_t i;
+
+  if (NULL == pPipeline)
+    return;
+
+  if (pPipeline->hThread) {
+    WelsMutexLock (&pPipeline->hLock);
+    pPipeline->bExit = true;	// the thread codes the frames queued so far before leaving
+    WelsCondSignal (&pPipeline->hTaskCond);
+    WelsMutexUnlock (&pPipeline->hLock);
+    WelsThreadJoin (pPipeline->hThread);
+  }
+
+  for (i = 0; i < ENC_PIPELINE_DEPTH; i++) {
+    pCtx->pVpp->FreePreparedPicture (pCtx, &pPipeline->sFrames[i].sPrepared);
+    if (NULL != pPipeline->sFrames[i].pBs)
+      pCtx->pMemAlign->WelsFree (pPipeline->sFrames[i].pBs, "pFrame->pBs");
+  }
+  pCtx->pVpp->UninitSourcePreparation (pCtx);
+
+  WelsCondDestroy (&pPipeline->hDoneCond);
+  WelsCondDestroy (&pPipeline->hTaskCond);
+  WelsMutexDestroy (&pPipeline->hLock);
+  pCtx->pMemAlign->WelsFree (pPipeline, "pPipeline");
+  pCtx->pPipeline = NULL;
+}
+
+int32_t SubmitPipelineFrame (sWelsEncCtx* pCtx, const SSourcePicture* kpSrcPic) {
+  SEncPipeline* pPipeline = pCtx->pPipeline;
+  SEncPipelineFrame* pFrame = NULL;
+
+  if (NULL == pPipeline) {
+    const int32_t kiRet = InitEncPipeline (pCtx);
+    WELS_VERIFY_RETURN_IFNEQ (kiRet, ENC_RETURN_SUCCESS)
+    pPipeline = pCtx->pPipeline;
+  }
+
+  // only the calling thread moves uiFirst and uiNext
+  if (pPipeline->uiNext - pPipeline->uiFirst >= ENC_PIPELINE_DEPTH)
+    return ENC_RETURN_UNEXPECTED;
+  pFrame = &pPipeline->sFrames[pPipeline->uiNext % ENC_PIPELINE_DEPTH];
+
+  if (pCtx->pVpp->PrepareSourcePicture (pCtx, kpSrcPic, &pFrame->sPrepared) != 0)
+    return ENC_RETURN_INVALIDINPUT;
+  memcpy (&pFrame->sSrcPic, kpSrcPic, sizeof (SSourcePicture));	// confirmed_safe_unsafe_usage
+  memset (pFrame->sSrcPic.pData, 0, sizeof (pFrame->sSrcPic.pData));
+
+  WelsMutexLock (&pPipeline->hLock);
+  pFrame->eState = PIPELINE_FRAME_QUEUED;
+  ++ pPipeline->uiNext;
+  WelsCondSignal (&pPipeline->hTaskCond);
+  WelsMutexUnlock (&pPipeline->hLock);
+
+  return ENC_RETURN_SUCCESS;
+}
+
+int32_t FetchPipelineFrame (sWelsEncCtx* pCtx, SFrameBSInfo* pFbi, const bool kbWait) {
+  SEncPipeline* pPipeline = pCtx->pPipeline;
+  SEncPipelineFrame* pFrame = NULL;
+
+  if (NULL == pPipeline) {
+    OutputNoFrame (pFbi);
+    return ENC_RETURN_SUCCESS;
+  }
+
+  WelsMutexLock (&pPipeline->hLock);
+  pFrame = &pPipeline->sFrames[pPipeline->uiFirst % ENC_PIPELINE_DEPTH];
+  if (pPipeline->uiFirst != pPipeline->uiNext && pFrame->eState == PIPELINE_FRAME_DELIVERED) {
+    pFrame->eState = PIPELINE_FRAME_IDLE;
+    ++ pPipeline->uiFirst;
+    pFrame = &pPipeline->sFrames[pPipeline->uiFirst % ENC_PIPELINE_DEPTH];
+  }
+  if (pPipeline->uiFirst == pPipeline->uiNext) {
+    WelsMutexUnlock (&pPipeline->hLock);
+    OutputNoFrame (pFbi);
+    return ENC_RETURN_SUCCESS;
+  }
+  while (kbWait && pFrame->eState != PIPELINE_FRAME_DONE)
+    WelsCondWait (&pPipeline->hDoneCond, &pPipeline->hLock);
+  if (pFrame->eState != PIPELINE_FRAME_DONE) {
+    WelsMutexUnlock (&pPipeline->hLock);
+    OutputNoFrame (pFbi);
+    return ENC_RETURN_SUCCESS;
+  }
+  pFrame->eState = PIPELINE_FRAME_DELIVERED;
+  WelsMutexUnlock (&pPipeline->hLock);
+
+  memcpy (pFbi, &pFrame->sBsInfo, sizeof (SFrameBSInfo));	// confirmed_safe_unsafe_usage
+  return pFrame->iResult;
+}
+
+void DrainEncPipeline (sWelsEncCtx* pCtx) {
+  SEncPipeline* pPipeline = (NULL != pCtx) ? pCtx->pPipeline : NULL;
+
+  if (NULL == pPipeline)
+    return;
+
+  WelsMutexLock (&pPipeline->hLock);
+  while (pPipeline->uiCoded != pPipeline->uiNext)
+    WelsCondWait (&pPipeline->hDoneCond, &pPipeline->hLock);
+  WelsMutexUnlock (&pPipeline->hLock);
+}
+
+bool PendingPipelineFrames (sWelsEncCtx* pCtx) {
+  SEncPipeline* pPipeline = (NULL != pCtx) ? pCtx->pPipeline : NULL;
+  uint32_t uiPending = 0;
+
+  if (NULL == pPipeline)
+    return false;
+
+  WelsMutexLock (&pPipeline->hLock);
+  uiPending = pPipeline->uiNext - pPipeline->uiFirst;
+  // the oldest frame may be the one fetched last, its slot is only released at the next fetch
+  if (uiPending > 0 && pPipeline->sFrames[pPipeline->uiFirst % ENC_PIPELINE_DEPTH].eState == PIPELINE_FRAME_DELIVERED)
+    -- uiPending;
+  WelsMutexUnlock (&pPipeline->hLock);
+
+  return uiPending > 0;
+}
+
+} // namespace WelsSVCEnc
@@ -52,6 +52,7 @@
 #include "ls_defines.h"
 #include "crt_util_safe_x.h"	// Safe CRT routines like utils for cross platforms
 #include "slice_multi_threading.h"
+#include "enc_pipeline.h"
 #include "measure_time.h"
 
 namespace WelsSVCEnc {
@@ -162,6 +163,20 @@ int32_t ParamValidationExt (sWelsEncCtx* pCtx, SWelsSvcCodingParam* pCodingParam
   }
 
 
+  // layers coded concurrently have no inter-layer dependency, screen content and LTR do share state across layers
+  if (pCodingParam->bParallelSpatialLayers) {
+    if (pCodingParam->iSpatialLayerNum < 2 || pCodingParam->iUsageType != CAMERA_VIDEO_REAL_TIME
+        || pCodingParam->bEnableLongTermReference) {
+      WelsLog (pCtx, WELS_LOG_WARNING,
+               "ParamValidationExt(), bParallelSpatialLayers disabled for iSpatialLayerNum= %d, iUsageType= %d, bEnableLongTermReference= %d!\n",
+               pCodingParam->iSpatialLayerNum, pCodingParam->iUsageType, pCodingParam->bEnableLongTermReference);
+      pCodingParam->bParallelSpatialLayers = false;
+    } else {
+      // the threads go to the spatial layers, slices of a layer are coded one after another
+      pCodingParam->iMultipleThreadIdc = 1;
+    }
+  }
+
   //about iMultipleThreadIdc, bDeblockingParallelFlag, iLoopFilterDisableIdc, & uiSliceMode
   // (1) Single Thread
   //	if (THREAD==1)//single thread
@@ -524,7 +539,7 @@ static  void  InitMbInfo (sWelsEncCtx* pEnc, SMB*   pList, SDqLayer* pLayer, con
   int32_t  iMbNum			= iMbWidth * iMbHeight;
   SSliceCtx* pSliceCtx = pLayer->pSliceEncCtx;
   uint32_t uiNeighborAvail;
-  const int32_t kiOffset	= (kiDlayerId & 0x01) * kiMaxMbNum;
+  const int32_t kiOffset	= kiDlayerId * kiMaxMbNum;	// layers own their MB buffers so that they can be coded concurrently
   SMVUnitXY (*pLayerMvUnitBlock4x4)[MB_BLOCK4x4_NUM]	= (SMVUnitXY (*)[MB_BLOCK4x4_NUM]) (
         &pEnc->pMvUnitBlock4x4[MB_BLOCK4x4_NUM * kiOffset]);
   int8_t (*pLayerRefIndexBlock8x8)[MB_BLOCK8x8_NUM]		= (int8_t (*)[MB_BLOCK8x8_NUM]) (
@@ -582,9 +597,9 @@ static  void  InitMbInfo (sWelsEncCtx* pEnc, SMB*   pList, SDqLayer* pLayer, con
 
     pList[iIdx].sMv					= pLayerMvUnitBlock4x4[iIdx];
     pList[iIdx].pRefIndex			= pLayerRefIndexBlock8x8[iIdx];
-    pList[iIdx].pSadCost				= &pEnc->pSadCostMb[iIdx];
-    pList[iIdx].pIntra4x4PredMode	= &pEnc->pIntra4x4PredModeBlocks[iIdx * INTRA_4x4_MODE_NUM];
-    pList[iIdx].pNonZeroCount		= &pEnc->pNonZeroCountBlocks[iIdx * MB_LUMA_CHROMA_BLOCK4x4_NUM];
+    pList[iIdx].pSadCost				= &pEnc->pSadCostMb[kiOffset + iIdx];
+    pList[iIdx].pIntra4x4PredMode	= &pEnc->pIntra4x4PredModeBlocks[(kiOffset + iIdx) * INTRA_4x4_MODE_NUM];
+    pList[iIdx].pNonZeroCount		= &pEnc->pNonZeroCountBlocks[(kiOffset + iIdx) * MB_LUMA_CHROMA_BLOCK4x4_NUM];
   }
 }
 
@@ -751,6 +766,9 @@ static inline int32_t InitDqLayers (sWelsEncCtx** ppCtx) {
     const int32_t kiMbH		= (pDlayer->iFrameHeight + 0x0f) >> 4;
     int32_t iMaxSliceNum	= 1;
     const int32_t kiSliceNum = GetInitialSliceNum (kiMbW, kiMbH, &pDlayer->sSliceCfg);
+    // a layer coded concurrently with the others writes through its own output
+    SBitStringAux* pLayerBsWrite	= (NULL != (*ppCtx)->pLayerThreading) ?
+                                  & (*ppCtx)->pLayerThreading->sTask[iDlayerIndex].pOut->sBsWrite : & (*ppCtx)->pOut->sBsWrite;
     if (iMaxSliceNum < kiSliceNum)
       iMaxSliceNum = kiSliceNum;
 
@@ -787,7 +805,7 @@ static inline int32_t InitDqLayers (sWelsEncCtx** ppCtx) {
           if (pParam->iMultipleThreadIdc > 1)
             pSlice->pSliceBsa = & (*ppCtx)->pSliceBs[iSliceIdx].sBsWrite;
           else
-            pSlice->pSliceBsa = & (*ppCtx)->pOut->sBsWrite;
+            pSlice->pSliceBsa = pLayerBsWrite;
           if (AllocMbCacheAligned (&pSlice->sMbCacheInfo, pMa)) {
             FreeMemorySvc (ppCtx);
             return 1;
@@ -799,7 +817,7 @@ static inline int32_t InitDqLayers (sWelsEncCtx** ppCtx) {
       else {	// only one pSlice
         SSlice* pSlice = &pDqLayer->sLayerInfo.pSliceInLayer[0];
         pSlice->uiSliceIdx	= 0;
-        pSlice->pSliceBsa	= & (*ppCtx)->pOut->sBsWrite;
+        pSlice->pSliceBsa	= pLayerBsWrite;
         if (AllocMbCacheAligned (&pSlice->sMbCacheInfo, pMa)) {
           FreeMemorySvc (ppCtx);
           return 1;
@@ -842,6 +860,15 @@ static inline int32_t InitDqLayers (sWelsEncCtx** ppCtx) {
       pDqLayer->pFeatureSearchPreparation = NULL;
     }
 
+    if (pParam->bEnableHierarchicalMe) {
+      pDqLayer->pHierarchicalMe	= static_cast<SHierarchicalMe*> (pMa->WelsMallocz (sizeof (SHierarchicalMe), "pHierarchicalMe"));
+      WELS_VERIFY_RETURN_PROC_IF (1, NULL == pDqLayer->pHierarchicalMe, FreeMemorySvc (ppCtx));
+      int32_t iReturn = RequestHierarchicalMe (pMa, kiMbW, kiMbH, pDqLayer->pHierarchicalMe);
+      WELS_VERIFY_RETURN_PROC_IF (1, ENC_RETURN_SUCCESS != iReturn, FreeMemorySvc (ppCtx));
+    } else {
+      pDqLayer->pHierarchicalMe = NULL;
+    }
+
     (*ppCtx)->ppDqLayerList[iDlayerIndex]	= pDqLayer;
 
     ++ iDlayerIndex;
@@ -1205,6 +1232,155 @@ void ReleaseMemoryVaaScreen (SVAAFrameInfo* pVaa,  CMemoryAlign* pMa, const int3
     }
   }
 }
+/*!
+ * \brief	allocate the VAA buffers of pVaa for kiCountMaxMbNum MBs
+ * \return	0 - successful; 1 - out of memory, the buffers got so far are left to ReleaseMemoryVaa()
+ */
+static int32_t RequestMemoryVaa (SVAAFrameInfo* pVaa, CMemoryAlign* pMa, SWelsSvcCodingParam* pParam,
+                                 const int32_t kiCountMaxMbNum) {
+  if (pParam->bEnableAdaptiveQuant) { //malloc mem
+    pVaa->sAdaptiveQuantParam.pMotionTextureUnit   = static_cast<SMotionTextureUnit*>
+        (pMa->WelsMallocz (kiCountMaxMbNum * sizeof (SMotionTextureUnit), "pVaa->sAdaptiveQuantParam.pMotionTextureUnit"));
+    WELS_VERIFY_RETURN_IF (1, (NULL == pVaa->sAdaptiveQuantParam.pMotionTextureUnit))
+    pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp   = static_cast<int8_t*>
+        (pMa->WelsMallocz (kiCountMaxMbNum * sizeof (int8_t), "pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp"));
+    WELS_VERIFY_RETURN_IF (1, (NULL == pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp))
+  }
+
+  pVaa->pVaaBackgroundMbFlag = (int8_t*)pMa->WelsMallocz (kiCountMaxMbNum * sizeof (int8_t),
+                               "pVaa->vaa_skip_mb_flag");
+  WELS_VERIFY_RETURN_IF (1, (NULL == pVaa->pVaaBackgroundMbFlag))
+
+  pVaa->sVaaCalcInfo.pSad8x8 = static_cast<int32_t (*)[4]>
+                               (pMa->WelsMallocz (kiCountMaxMbNum * 4 * sizeof (int32_t), "pVaa->sVaaCalcInfo.sad8x8"));
+  WELS_VERIFY_RETURN_IF (1, (NULL == pVaa->sVaaCalcInfo.pSad8x8))
+  pVaa->sVaaCalcInfo.pSsd16x16 = static_cast<int32_t*>
+      (pMa->WelsMallocz (kiCountMaxMbNum * sizeof (int32_t), "pVaa->sVaaCalcInfo.pSsd16x16"));
+  WELS_VERIFY_RETURN_IF (1, (NULL == pVaa->sVaaCalcInfo.pSsd16x16))
+  pVaa->sVaaCalcInfo.pSum16x16 = static_cast<int32_t*>
+      (pMa->WelsMallocz (kiCountMaxMbNum * sizeof (int32_t), "pVaa->sVaaCalcInfo.pSum16x16"));
+  WELS_VERIFY_RETURN_IF (1, (NULL == pVaa->sVaaCalcInfo.pSum16x16))
+  pVaa->sVaaCalcInfo.pSumOfSquare16x16 = static_cast<int32_t*>
+      (pMa->WelsMallocz (kiCountMaxMbNum * sizeof (int32_t), "pVaa->sVaaCalcInfo.pSumOfSquare16x16"));
+  WELS_VERIFY_RETURN_IF (1, (NULL == pVaa->sVaaCalcInfo.pSumOfSquare16x16))
+
+  if (pParam->bEnableBackgroundDetection) { //BGD control
+    pVaa->sVaaCalcInfo.pSumOfDiff8x8 = static_cast<int32_t (*)[4]>
+        (pMa->WelsMallocz (kiCountMaxMbNum * 4 * sizeof (int32_t), "pVaa->sVaaCalcInfo.sd_16x16"));
+    WELS_VERIFY_RETURN_IF (1, (NULL == pVaa->sVaaCalcInfo.pSumOfDiff8x8))
+    pVaa->sVaaCalcInfo.pMad8x8 = static_cast<uint8_t (*)[4]>
+                                 (pMa->WelsMallocz (kiCountMaxMbNum * 4 * sizeof (uint8_t), "pVaa->sVaaCalcInfo.mad_16x16"));
+    WELS_VERIFY_RETURN_IF (1, (NULL == pVaa->sVaaCalcInfo.pMad8x8))
+  }
+
+  return 0;
+}
+static void ReleaseMemoryVaa (SVAAFrameInfo* pVaa, CMemoryAlign* pMa, SWelsSvcCodingParam* pParam) {
+  if (pParam->bEnableAdaptiveQuant) { //free mem
+    pMa->WelsFree (pVaa->sAdaptiveQuantParam.pMotionTextureUnit, "pVaa->sAdaptiveQuantParam.pMotionTextureUnit");
+    pVaa->sAdaptiveQuantParam.pMotionTextureUnit = NULL;
+    pMa->WelsFree (pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp,
+                   "pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp");
+    pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp = NULL;
+  }
+
+  pMa->WelsFree (pVaa->pVaaBackgroundMbFlag, "pVaa->pVaaBackgroundMbFlag");
+  pVaa->pVaaBackgroundMbFlag	= NULL;
+  pMa->WelsFree (pVaa->sVaaCalcInfo.pSad8x8, "pVaa->sVaaCalcInfo.sad8x8");
+  pVaa->sVaaCalcInfo.pSad8x8		= NULL;
+  pMa->WelsFree (pVaa->sVaaCalcInfo.pSsd16x16, "pVaa->sVaaCalcInfo.pSsd16x16");
+  pVaa->sVaaCalcInfo.pSsd16x16	= NULL;
+  pMa->WelsFree (pVaa->sVaaCalcInfo.pSum16x16, "pVaa->sVaaCalcInfo.pSum16x16");
+  pVaa->sVaaCalcInfo.pSum16x16	= NULL;
+  pMa->WelsFree (pVaa->sVaaCalcInfo.pSumOfSquare16x16, "pVaa->sVaaCalcInfo.pSumOfSquare16x16");
+  pVaa->sVaaCalcInfo.pSumOfSquare16x16		= NULL;
+
+  if (pParam->bEnableBackgroundDetection) { //BGD control
+    pMa->WelsFree (pVaa->sVaaCalcInfo.pSumOfDiff8x8, "pVaa->sVaaCalcInfo.pSumOfDiff8x8");
+    pVaa->sVaaCalcInfo.pSumOfDiff8x8	= NULL;
+    pMa->WelsFree (pVaa->sVaaCalcInfo.pMad8x8, "pVaa->sVaaCalcInfo.pMad8x8");
+    pVaa->sVaaCalcInfo.pMad8x8	= NULL;
+  }
+}
+/*!
+ * \brief	request the private resources of the spatial layers coded concurrently
+ * \return	0 - successful; 1 - failed, what is got so far is left to ReleaseLayerThreading()
+ */
+static int32_t RequestLayerThreading (sWelsEncCtx* pCtx, const int32_t kiCountBsLen, const int32_t kiCountNals,
+                                      const int32_t kiCountMaxMbNum) {
+  SWelsSvcCodingParam* pParam	= pCtx->pSvcParam;
+  CMemoryAlign* pMa				= pCtx->pMemAlign;
+  SLayerThreading* pLt			= (SLayerThreading*)pMa->WelsMallocz (sizeof (SLayerThreading), "SLayerThreading");
+  int32_t iDid					= 0;
+
+  WELS_VERIFY_RETURN_IF (1, (NULL == pLt))
+  pCtx->pLayerThreading	= pLt;
+  WELS_VERIFY_RETURN_IF (1, (WELS_THREAD_ERROR_OK != WelsMutexInit (&pLt->mutexPreProcess)))
+
+  for (iDid = 0; iDid < pParam->iSpatialLayerNum; ++ iDid) {
+    SLayerTask* pTask	= &pLt->sTask[iDid];
+
+    pTask->pFuncList	= (SWelsFuncPtrList*)pMa->WelsMallocz (sizeof (SWelsFuncPtrList), "pTask->pFuncList");
+    WELS_VERIFY_RETURN_IF (1, (NULL == pTask->pFuncList))
+
+    pTask->pOut	= (SWelsEncoderOutput*)pMa->WelsMallocz (sizeof (SWelsEncoderOutput), "pTask->pOut");
+    WELS_VERIFY_RETURN_IF (1, (NULL == pTask->pOut))
+    pTask->pOut->pBsBuffer	= (uint8_t*)pMa->WelsMalloc (kiCountBsLen, "pTask->pOut->pBsBuffer");
+    WELS_VERIFY_RETURN_IF (1, (NULL == pTask->pOut->pBsBuffer))
+    pTask->pOut->uiSize		= kiCountBsLen;
+    pTask->pOut->sNalList	= (SWelsNalRaw*)pMa->WelsMalloc (kiCountNals * sizeof (SWelsNalRaw), "pTask->pOut->sNalList");
+    WELS_VERIFY_RETURN_IF (1, (NULL == pTask->pOut->sNalList))
+    pTask->pOut->iCountNals	= kiCountNals;
+
+    pTask->pVaa	= (SVAAFrameInfo*)pMa->WelsMallocz (sizeof (SVAAFrameInfo), "pTask->pVaa");
+    WELS_VERIFY_RETURN_IF (1, (NULL == pTask->pVaa))
+    WELS_VERIFY_RETURN_IF (1, RequestMemoryVaa (pTask->pVaa, pMa, pParam, kiCountMaxMbNum))
+
+    pTask->pFrameBs		= (uint8_t*)pMa->WelsMalloc (kiCountBsLen, "pTask->pFrameBs");
+    WELS_VERIFY_RETURN_IF (1, (NULL == pTask->pFrameBs))
+    pTask->iFrameBsSize	= kiCountBsLen;
+  }
+
+  // the calling thread codes one of the layers while waiting for the others
+  pLt->pThreadPool	= WelsThreadPoolAcquire (pParam->iSpatialLayerNum - 1);
+  WELS_VERIFY_RETURN_IF (1, (NULL == pLt->pThreadPool))
+  pLt->sLayerTasks.iPending	= 0;
+
+  return 0;
+}
+
+static void ReleaseLayerThreading (sWelsEncCtx* pCtx) {
+  CMemoryAlign* pMa		= pCtx->pMemAlign;
+  SLayerThreading* pLt	= pCtx->pLayerThreading;
+  int32_t iDid			= 0;
+
+  if (NULL == pLt)
+    return;
+
+  WelsThreadPoolRelease (pLt->pThreadPool);
+  pLt->pThreadPool	= NULL;
+  WelsMutexDestroy (&pLt->mutexPreProcess);
+
+  for (iDid = 0; iDid < MAX_DEPENDENCY_LAYER; ++ iDid) {
+    SLayerTask* pTask	= &pLt->sTask[iDid];
+
+    pMa->WelsFree (pTask->pFuncList, "pTask->pFuncList");
+    if (NULL != pTask->pOut) {
+      pMa->WelsFree (pTask->pOut->pBsBuffer, "pTask->pOut->pBsBuffer");
+      pMa->WelsFree (pTask->pOut->sNalList, "pTask->pOut->sNalList");
+      pMa->WelsFree (pTask->pOut, "pTask->pOut");
+    }
+    if (NULL != pTask->pVaa) {
+      ReleaseMemoryVaa (pTask->pVaa, pMa, pCtx->pSvcParam);
+      pMa->WelsFree (pTask->pVaa, "pTask->pVaa");
+    }
+    pMa->WelsFree (pTask->pFrameBs, "pTask->pFrameBs");
+  }
+
+  pMa->WelsFree (pLt, "SLayerThreading");
+  pCtx->pLayerThreading	= NULL;
+}
+
 /*!
  * \brief	request specific memory for SVC
  * \pParam	pEncCtx		sWelsEncCtx*
@@ -1291,16 +1467,10 @@ int32_t RequestMemorySvc (sWelsEncCtx** ppCtx) {
   (*ppCtx)->pOut->iCountNals		= iCountNals;
   (*ppCtx)->pOut->iNalIndex		= 0;
 
-  if (pParam->iMultipleThreadIdc > 1) {
-    const int32_t iTotalLength = iCountBsLen + (iTargetSpatialBsSize * ((*ppCtx)->iMaxSliceCount - 1));
-    (*ppCtx)->pFrameBs			= (uint8_t*)pMa->WelsMalloc (iTotalLength, "pFrameBs");
-    WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pFrameBs), FreeMemorySvc (ppCtx))
-    (*ppCtx)->iFrameBsSize = iTotalLength;
-  } else {
-    (*ppCtx)->pFrameBs			= (uint8_t*)pMa->WelsMalloc (iCountBsLen, "pFrameBs");
-    WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pFrameBs), FreeMemorySvc (ppCtx))
-    (*ppCtx)->iFrameBsSize		= iCountBsLen;
-  }
+  // slice bs buffers of the threads are allocated by RequestMtResource() apart from pFrameBs
+  (*ppCtx)->pFrameBs			= (uint8_t*)pMa->WelsMalloc (iCountBsLen, "pFrameBs");
+  WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pFrameBs), FreeMemorySvc (ppCtx))
+  (*ppCtx)->iFrameBsSize		= iCountBsLen;
   (*ppCtx)->iPosBsBuffer		= 0;
 
   // for pSlice bs buffers
@@ -1311,23 +1481,27 @@ int32_t RequestMemorySvc (sWelsEncCtx** ppCtx) {
   }
 
   (*ppCtx)->pIntra4x4PredModeBlocks = static_cast<int8_t*>
-                                      (pMa->WelsMallocz (iCountMaxMbNum * INTRA_4x4_MODE_NUM, "pIntra4x4PredModeBlocks"));
+                                      (pMa->WelsMallocz (iCountMaxMbNum * kiNumDependencyLayers * INTRA_4x4_MODE_NUM,
+                                          "pIntra4x4PredModeBlocks"));
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pIntra4x4PredModeBlocks), FreeMemorySvc (ppCtx))
 
   (*ppCtx)->pNonZeroCountBlocks = static_cast<int8_t*>
-                                  (pMa->WelsMallocz (iCountMaxMbNum * MB_LUMA_CHROMA_BLOCK4x4_NUM, "pNonZeroCountBlocks"));
+                                  (pMa->WelsMallocz (iCountMaxMbNum * kiNumDependencyLayers * MB_LUMA_CHROMA_BLOCK4x4_NUM,
+                                      "pNonZeroCountBlocks"));
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pNonZeroCountBlocks), FreeMemorySvc (ppCtx))
 
   (*ppCtx)->pMvUnitBlock4x4 = static_cast<SMVUnitXY*>
-                              (pMa->WelsMallocz (iCountMaxMbNum * 2 * MB_BLOCK4x4_NUM * sizeof (SMVUnitXY), "pMvUnitBlock4x4"));
+                              (pMa->WelsMallocz (iCountMaxMbNum * kiNumDependencyLayers * MB_BLOCK4x4_NUM * sizeof (SMVUnitXY),
+                                  "pMvUnitBlock4x4"));
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pMvUnitBlock4x4), FreeMemorySvc (ppCtx))
 
   (*ppCtx)->pRefIndexBlock4x4 = static_cast<int8_t*>
-                                (pMa->WelsMallocz (iCountMaxMbNum * 2 * MB_BLOCK8x8_NUM * sizeof (int8_t), "pRefIndexBlock4x4"));
+                                (pMa->WelsMallocz (iCountMaxMbNum * kiNumDependencyLayers * MB_BLOCK8x8_NUM * sizeof (int8_t),
+                                    "pRefIndexBlock4x4"));
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pRefIndexBlock4x4), FreeMemorySvc (ppCtx))
 
   (*ppCtx)->pSadCostMb	= static_cast<int32_t*>
-                          (pMa->WelsMallocz (iCountMaxMbNum * sizeof (int32_t), "pSadCostMb"));
+                          (pMa->WelsMallocz (iCountMaxMbNum * kiNumDependencyLayers * sizeof (int32_t), "pSadCostMb"));
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pSadCostMb), FreeMemorySvc (ppCtx))
 
   (*ppCtx)->bEncCurFrmAsIdrFlag = true;  // make sure first frame is IDR
@@ -1377,44 +1551,17 @@ int32_t RequestMemorySvc (sWelsEncCtx** ppCtx) {
         WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa), FreeMemorySvc (ppCtx))
     }
 
-  if ((*ppCtx)->pSvcParam->bEnableAdaptiveQuant) { //malloc mem
-    (*ppCtx)->pVaa->sAdaptiveQuantParam.pMotionTextureUnit   = static_cast<SMotionTextureUnit*>
-        (pMa->WelsMallocz (iCountMaxMbNum * sizeof (SMotionTextureUnit), "pVaa->sAdaptiveQuantParam.pMotionTextureUnit"));
-    WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa->sAdaptiveQuantParam.pMotionTextureUnit), FreeMemorySvc (ppCtx))
-    (*ppCtx)->pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp   = static_cast<int8_t*>
-        (pMa->WelsMallocz (iCountMaxMbNum * sizeof (int8_t), "pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp"));
-    WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp),
-                                FreeMemorySvc (ppCtx))
-  }
-
-  (*ppCtx)->pVaa->pVaaBackgroundMbFlag = (int8_t*)pMa->WelsMallocz (iCountMaxMbNum * sizeof (int8_t),
-                                         "pVaa->vaa_skip_mb_flag");
-  WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa->pVaaBackgroundMbFlag), FreeMemorySvc (ppCtx))
-
-  (*ppCtx)->pVaa->sVaaCalcInfo.pSad8x8 = static_cast<int32_t (*)[4]>
-                                         (pMa->WelsMallocz (iCountMaxMbNum * 4 * sizeof (int32_t), "pVaa->sVaaCalcInfo.sad8x8"));
-  WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa->sVaaCalcInfo.pSad8x8), FreeMemorySvc (ppCtx))
-  (*ppCtx)->pVaa->sVaaCalcInfo.pSsd16x16 = static_cast<int32_t*>
-      (pMa->WelsMallocz (iCountMaxMbNum * sizeof (int32_t), "pVaa->sVaaCalcInfo.pSsd16x16"));
-  WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa->sVaaCalcInfo.pSsd16x16), FreeMemorySvc (ppCtx))
-  (*ppCtx)->pVaa->sVaaCalcInfo.pSum16x16 = static_cast<int32_t*>
-      (pMa->WelsMallocz (iCountMaxMbNum * sizeof (int32_t), "pVaa->sVaaCalcInfo.pSum16x16"));
-  WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa->sVaaCalcInfo.pSum16x16), FreeMemorySvc (ppCtx))
-  (*ppCtx)->pVaa->sVaaCalcInfo.pSumOfSquare16x16 = static_cast<int32_t*>
-      (pMa->WelsMallocz (iCountMaxMbNum * sizeof (int32_t), "pVaa->sVaaCalcInfo.pSumOfSquare16x16"));
-  WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa->sVaaCalcInfo.pSumOfSquare16x16), FreeMemorySvc (ppCtx))
-
-  if ((*ppCtx)->pSvcParam->bEnableBackgroundDetection) { //BGD control
-    (*ppCtx)->pVaa->sVaaCalcInfo.pSumOfDiff8x8 = static_cast<int32_t (*)[4]>
-        (pMa->WelsMallocz (iCountMaxMbNum * 4 * sizeof (int32_t), "pVaa->sVaaCalcInfo.sd_16x16"));
-    WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa->sVaaCalcInfo.pSumOfDiff8x8), FreeMemorySvc (ppCtx))
-    (*ppCtx)->pVaa->sVaaCalcInfo.pMad8x8 = static_cast<uint8_t (*)[4]>
-                                           (pMa->WelsMallocz (iCountMaxMbNum * 4 * sizeof (uint8_t), "pVaa->sVaaCalcInfo.mad_16x16"));
-    WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pVaa->sVaaCalcInfo.pMad8x8), FreeMemorySvc (ppCtx))
-  }
+  WELS_VERIFY_RETURN_PROC_IF (1, RequestMemoryVaa ((*ppCtx)->pVaa, pMa, pParam, iCountMaxMbNum), FreeMemorySvc (ppCtx))
 
   //End of pVaa memory allocation
 
+  // private resources of the layers, InitDqLayers() needs their bs writers
+  if (pParam->bParallelSpatialLayers && RequestLayerThreading (*ppCtx, iCountBsLen, iCountNals, iCountMaxMbNum)) {
+    WelsLog (*ppCtx, WELS_LOG_WARNING, "RequestMemorySvc(), RequestLayerThreading failed!");
+    FreeMemorySvc (ppCtx);
+    return 1;
+  }
+
   iResult = InitDqLayers (ppCtx);
   if (iResult) {
     WelsLog (*ppCtx, WELS_LOG_WARNING, "RequestMemorySvc(), InitDqLayers failed(%d)!", iResult);
@@ -1449,7 +1596,7 @@ int32_t RequestMemorySvc (sWelsEncCtx** ppCtx) {
  * \pParam	pEncCtx		sWelsEncCtx*
  * \return	none
  */
-void FreeMemorySvc (sWelsEncCtx** ppCtx) {
+void FreeMemorySvc (sWelsEncCtx** ppCtx, CMemoryAlign** ppMemAlign) {
   if (NULL != *ppCtx) {
     sWelsEncCtx* pCtx	= *ppCtx;
     CMemoryAlign* pMa			= pCtx->pMemAlign;
@@ -1488,6 +1635,7 @@ void FreeMemorySvc (sWelsEncCtx** ppCtx) {
 
     if (pParam != NULL && pParam->iMultipleThreadIdc > 1)
       ReleaseMtResource (ppCtx);
+    ReleaseLayerThreading (pCtx);
 
     // frame bitstream pBuffer
     if (NULL != pCtx->pFrameBs) {
@@ -1590,6 +1738,12 @@ void FreeMemorySvc (sWelsEncCtx** ppCtx) {
             pDq->pFeatureSearchPreparation = NULL;
           }
 
+          if (pDq->pHierarchicalMe) {
+            ReleaseHierarchicalMe (pMa, pDq->pHierarchicalMe);
+            pMa->WelsFree (pDq->pHierarchicalMe, "pHierarchicalMe");
+            pDq->pHierarchicalMe = NULL;
+          }
+
           pMa->WelsFree (pDq, "pDq");
           pDq = NULL;
           pCtx->ppDqLayerList[ilayer] = NULL;
@@ -1638,31 +1792,7 @@ void FreeMemorySvc (sWelsEncCtx** ppCtx) {
 
     // VAA
     if (NULL != pCtx->pVaa) {
-      if (pCtx->pSvcParam->bEnableAdaptiveQuant) { //free mem
-        pMa->WelsFree (pCtx->pVaa->sAdaptiveQuantParam.pMotionTextureUnit, "pVaa->sAdaptiveQuantParam.pMotionTextureUnit");
-        pCtx->pVaa->sAdaptiveQuantParam.pMotionTextureUnit = NULL;
-        pMa->WelsFree (pCtx->pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp,
-                       "pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp");
-        pCtx->pVaa->sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp = NULL;
-      }
-
-      pMa->WelsFree (pCtx->pVaa->pVaaBackgroundMbFlag, "pVaa->pVaaBackgroundMbFlag");
-      pCtx->pVaa->pVaaBackgroundMbFlag	= NULL;
-      pMa->WelsFree (pCtx->pVaa->sVaaCalcInfo.pSad8x8, "pVaa->sVaaCalcInfo.sad8x8");
-      pCtx->pVaa->sVaaCalcInfo.pSad8x8		= NULL;
-      pMa->WelsFree (pCtx->pVaa->sVaaCalcInfo.pSsd16x16, "pVaa->sVaaCalcInfo.pSsd16x16");
-      pCtx->pVaa->sVaaCalcInfo.pSsd16x16	= NULL;
-      pMa->WelsFree (pCtx->pVaa->sVaaCalcInfo.pSum16x16, "pVaa->sVaaCalcInfo.pSum16x16");
-      pCtx->pVaa->sVaaCalcInfo.pSum16x16	= NULL;
-      pMa->WelsFree (pCtx->pVaa->sVaaCalcInfo.pSumOfSquare16x16, "pVaa->sVaaCalcInfo.pSumOfSquare16x16");
-      pCtx->pVaa->sVaaCalcInfo.pSumOfSquare16x16		= NULL;
-
-      if (pCtx->pSvcParam->bEnableBackgroundDetection) { //BGD control
-        pMa->WelsFree (pCtx->pVaa->sVaaCalcInfo.pSumOfDiff8x8, "pVaa->sVaaCalcInfo.pSumOfDiff8x8");
-        pCtx->pVaa->sVaaCalcInfo.pSumOfDiff8x8	= NULL;
-        pMa->WelsFree (pCtx->pVaa->sVaaCalcInfo.pMad8x8, "pVaa->sVaaCalcInfo.pMad8x8");
-        pCtx->pVaa->sVaaCalcInfo.pMad8x8	= NULL;
-      }
+      ReleaseMemoryVaa (pCtx->pVaa, pMa, pCtx->pSvcParam);
       if(pCtx->pSvcParam->iUsageType == SCREEN_CONTENT_REAL_TIME)
         ReleaseMemoryVaaScreen(pCtx->pVaa, pMa,pCtx->pSvcParam->iNumRefFrame);
       pMa->WelsFree (pCtx->pVaa, "pVaa");
@@ -1703,7 +1833,10 @@ void FreeMemorySvc (sWelsEncCtx** ppCtx) {
     if ((*ppCtx)->pMemAlign != NULL) {
       WelsLog (NULL, WELS_LOG_INFO, "FreeMemorySvc(), verify memory usage (%d bytes) after free..\n",
                (*ppCtx)->pMemAlign->WelsGetMemoryUsage());
-      delete (*ppCtx)->pMemAlign;
+      if (NULL != ppMemAlign)
+        *ppMemAlign = (*ppCtx)->pMemAlign;
+      else
+        delete (*ppCtx)->pMemAlign;
       (*ppCtx)->pMemAlign = NULL;
     }
 
@@ -1866,9 +1999,10 @@ void OutputCpuFeaturesLog (uint32_t uiCpuFeatureFlags, uint32_t uiCpuCores, int3
  * \brief	initialize Wels avc encoder core library
  * \pParam	ppCtx		sWelsEncCtx**
  * \pParam	pParam		SWelsSvcCodingParam*
+ * \pParam	pMemAlign	CMemoryAlign* to reuse, NULL to create one
  * \return	successful - 0; otherwise none 0 for failed
  */
-int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingParam) {
+int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingParam, CMemoryAlign* pMemAlign) {
   sWelsEncCtx* pCtx		= NULL;
   int32_t	iRet					= 0;
   uint32_t uiCpuFeatureFlags		= 0;	// CPU features
@@ -1880,12 +2014,14 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
   if (NULL == ppCtx || NULL == pCodingParam) {
     WelsLog (NULL, WELS_LOG_ERROR, "WelsInitEncoderExt(), NULL == ppCtx(0x%p) or NULL == pCodingParam(0x%p).\n",
              (void*)ppCtx, (void*)pCodingParam);
+    delete pMemAlign;
     return 1;
   }
 
   iRet	=	ParamValidationExt (*ppCtx, pCodingParam);
   if (iRet != 0) {
     WelsLog (NULL, WELS_LOG_ERROR, "WelsInitEncoderExt(), ParamValidationExt failed return %d.\n", iRet);
+    delete pMemAlign;
     return iRet;
   }
 
@@ -1933,6 +2069,7 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
 
   if (InitSliceSettings (pCodingParam, uiCpuCores, &iSliceNum)) {
     WelsLog (NULL, WELS_LOG_ERROR, "WelsInitEncoderExt(), InitSliceSettings failed.\n");
+    delete pMemAlign;
     return 1;
   }
 
@@ -1940,10 +2077,15 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
 
   pCtx	= static_cast<sWelsEncCtx*> (malloc (sizeof (sWelsEncCtx)));
 
-  WELS_VERIFY_RETURN_IF (1, (NULL == pCtx))
+  WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pCtx), delete pMemAlign)
   memset (pCtx, 0, sizeof (sWelsEncCtx));
 
-  pCtx->pMemAlign = new CMemoryAlign (iCacheLineSize);
+  if (NULL != pMemAlign && pMemAlign->WelsGetCacheLineSize() == (uint32_t)iCacheLineSize)
+    pCtx->pMemAlign = pMemAlign;
+  else {
+    delete pMemAlign;
+    pCtx->pMemAlign = new CMemoryAlign (iCacheLineSize);
+  }
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pCtx->pMemAlign), FreeMemorySvc (&pCtx))
 
   // for logs
@@ -1983,9 +2125,6 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
     return iRet;
   }
 
-  if (pCodingParam->iMultipleThreadIdc > 1)
-    iRet = CreateSliceThreads (pCtx);
-
   WelsRcInitModule (pCtx,  pCtx->pSvcParam->iRCMode != RC_OFF_MODE ? WELS_RC_GOM : WELS_RC_DISABLE);
 
   pCtx->pVpp = new CWelsPreProcess (pCtx);
@@ -2008,6 +2147,9 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
           );
 #endif//MEMORY_MONITOR
 
+  // blocks of the former configuration not taken again go back to the system
+  pCtx->pMemAlign->WelsReleaseIdleBlocks();
+
   *ppCtx	= pCtx;
 
   WelsLog (pCtx, WELS_LOG_DEBUG, "WelsInitEncoderExt(), pCtx= 0x%p.\n", (void*)pCtx);
@@ -2099,43 +2241,25 @@ void StatOverallEncodingExt (sWelsEncCtx* pCtx) {
  * \pParam	pEncCtx		sWelsEncCtx*
  * \return	none
  */
-void WelsUninitEncoderExt (sWelsEncCtx** ppCtx) {
+void WelsUninitEncoderExt (sWelsEncCtx** ppCtx, CMemoryAlign** ppMemAlign) {
   if (NULL == ppCtx || NULL == *ppCtx)
     return;
 
   WelsLog (*ppCtx, WELS_LOG_INFO, "WelsUninitEncoderExt(), pCtx= %p, iThreadCount= %d, iMultipleThreadIdc= %d.\n",
            (void*) (*ppCtx), (*ppCtx)->pSvcParam->iCountThreadsNum, (*ppCtx)->pSvcParam->iMultipleThreadIdc);
 
+  UninitEncPipeline (*ppCtx);
+
 #if defined(STAT_OUTPUT)
   StatOverallEncodingExt (*ppCtx);
 #endif
 
-  if ((*ppCtx)->pSvcParam->iMultipleThreadIdc > 1 && (*ppCtx)->pSliceThreading != NULL) {
-    const int32_t iThreadCount = (*ppCtx)->pSvcParam->iCountThreadsNum;
-    int32_t iThreadIdx = 0;
-
-    if ((*ppCtx)->pSliceThreading->pExitEncodeEvent != NULL) {
-      while (iThreadIdx < iThreadCount) {
-        int res = 0;
-        if ((*ppCtx)->pSliceThreading->pThreadHandles[iThreadIdx]) {
-          WelsEventSignal (& (*ppCtx)->pSliceThreading->pExitEncodeEvent[iThreadIdx]);
-          WelsEventSignal (& (*ppCtx)->pSliceThreading->pThreadMasterEvent[iThreadIdx]);
-          res = WelsThreadJoin ((*ppCtx)->pSliceThreading->pThreadHandles[iThreadIdx]);	// waiting thread exit
-          WelsLog (*ppCtx, WELS_LOG_INFO, "WelsUninitEncoderExt(), pthread_join(pThreadHandles%d) return %d..\n", iThreadIdx,
-                   res);
-          (*ppCtx)->pSliceThreading->pThreadHandles[iThreadIdx] = 0;
-        }
-        ++ iThreadIdx;
-      }
-    }
-  }
-
   if ((*ppCtx)->pVpp) {
     (*ppCtx)->pVpp->FreeSpatialPictures (*ppCtx);
     delete (*ppCtx)->pVpp;
     (*ppCtx)->pVpp = NULL;
   }
-  FreeMemorySvc (ppCtx);
+  FreeMemorySvc (ppCtx, ppMemAlign);
   *ppCtx = NULL;
 }
 
@@ -2445,6 +2569,8 @@ void PreprocessSliceCoding (sWelsEncCtx* pCtx) {
       pFuncList->pfCalculateSatd = CalculateSatdCost;
       pFuncList->pfInterFineMd = WelsMdInterFinePartition;
     }
+    if (NULL != pCurLayer->pHierarchicalMe)
+      PerformHierarchicalMePreprocess (pCtx);
   }
   
   return;
@@ -2575,6 +2701,54 @@ void ParasetIdAdditionIdAdjust (SParaSetOffsetVariable* sParaSetOffsetVariable,
 
 }
 
+/*!
+ * \brief	enlarge pFrameBs so that kiNeededLen bytes fit behind the data written so far
+ * \return	ENC_RETURN_SUCCESS if done; ENC_RETURN_MEMALLOCERR if out of memory
+ */
+int32_t GrowFrameBs (sWelsEncCtx* pCtx, const int32_t kiNeededLen) {
+  CMemoryAlign* pMa	= pCtx->pMemAlign;
+  uint8_t* pOldBs		= pCtx->pFrameBs;
+  const int32_t kiNewSize	= WELS_MAX (pCtx->iFrameBsSize << 1, WELS_ALIGN (pCtx->iPosBsBuffer + kiNeededLen, 4));
+
+  uint8_t* pNewBs = (uint8_t*)pMa->WelsMalloc (kiNewSize, "pFrameBs");
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, (NULL == pNewBs))
+  memcpy (pNewBs, pOldBs, pCtx->iPosBsBuffer);	// confirmed_safe_unsafe_usage
+
+  if (NULL != pCtx->pFrameBsInfo) {
+    for (int32_t i = 0; i < MAX_LAYER_NUM_OF_FRAME; ++ i) {
+      SLayerBSInfo* pLayerBsInfo = &pCtx->pFrameBsInfo->sLayerInfo[i];
+      if (pLayerBsInfo->pBsBuf >= pOldBs && pLayerBsInfo->pBsBuf <= pOldBs + pCtx->iFrameBsSize)
+        pLayerBsInfo->pBsBuf = pNewBs + (pLayerBsInfo->pBsBuf - pOldBs);
+    }
+  }
+
+  pMa->WelsFree (pOldBs, "pFrameBs");
+  pCtx->pFrameBs		= pNewBs;
+  pCtx->iFrameBsSize	= kiNewSize;
+
+  WelsLog (pCtx, WELS_LOG_INFO, "GrowFrameBs(), frame bs buffer enlarged to %d bytes\n", kiNewSize);
+  return ENC_RETURN_SUCCESS;
+}
+
+/*!
+ * \brief	encode a NAL at the current writing position of pFrameBs, growing it when needed
+ * \return	ERRCODE
+ */
+static inline int32_t WelsEncodeNalToFrameBs (sWelsEncCtx* pCtx, SWelsNalRaw* pRawNal, void* pNalHeaderExt,
+    int32_t* pNalLen) {
+  const int32_t kiNeededLen = WelsGetNalMaxEncodedSize (pRawNal);
+
+  if (pCtx->iFrameBsSize - pCtx->iPosBsBuffer < kiNeededLen) {
+    const int32_t kiReturn = GrowFrameBs (pCtx, kiNeededLen);
+    WELS_VERIFY_RETURN_IFNEQ (kiReturn, ENC_RETURN_SUCCESS)
+  }
+
+  return WelsEncodeNal (pRawNal, pNalHeaderExt,
+                        pCtx->iFrameBsSize - pCtx->iPosBsBuffer,	//available buffer to be written
+                        pCtx->pFrameBs + pCtx->iPosBsBuffer,
+                        pNalLen);
+}
+
 /*!
  * \brief	write all parameter sets introduced in SVC extension
  * \return	writing results, success or error
@@ -2634,10 +2808,7 @@ int32_t WelsWriteParameterSets (sWelsEncCtx* pCtx, int32_t* pNalLen, int32_t* pN
       WelsUnloadNal (pCtx->pOut);
     }
 
-    iReturn = WelsEncodeNal (&pCtx->pOut->sNalList[iNal], NULL,
-                             pCtx->iFrameBsSize - pCtx->iPosBsBuffer,//available buffer to be written, so need to substract the used length
-                             pCtx->pFrameBs + pCtx->iPosBsBuffer,
-                             &iNalLength);
+    iReturn = WelsEncodeNalToFrameBs (pCtx, &pCtx->pOut->sNalList[iNal], NULL, &iNalLength);
     WELS_VERIFY_RETURN_IFNEQ (iReturn, ENC_RETURN_SUCCESS)
     pNalLen[iCountNal] = iNalLength;
 
@@ -2663,10 +2834,7 @@ int32_t WelsWriteParameterSets (sWelsEncCtx* pCtx, int32_t* pNalLen, int32_t* pN
     WelsWritePpsSyntax (&pCtx->pPPSArray[iIdx], &pCtx->pOut->sBsWrite, & (pCtx->sPSOVector));
     WelsUnloadNal (pCtx->pOut);
 
-    iReturn = WelsEncodeNal (&pCtx->pOut->sNalList[iNal], NULL,
-                             pCtx->iFrameBsSize - pCtx->iPosBsBuffer,
-                             pCtx->pFrameBs + pCtx->iPosBsBuffer,
-                             &iNalLength);
+    iReturn = WelsEncodeNalToFrameBs (pCtx, &pCtx->pOut->sNalList[iNal], NULL, &iNalLength);
     WELS_VERIFY_RETURN_IFNEQ (iReturn, ENC_RETURN_SUCCESS)
     pNalLen[iCountNal] = iNalLength;
     pCtx->iPosBsBuffer	+= iNalLength;
@@ -2698,11 +2866,8 @@ static inline int32_t AddPrefixNal (sWelsEncCtx* pCtx,
 
     WelsUnloadNal (pCtx->pOut);
 
-    iReturn = WelsEncodeNal (&pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
-                             &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt,
-                             pCtx->iFrameBsSize - pCtx->iPosBsBuffer,
-                             pCtx->pFrameBs + pCtx->iPosBsBuffer,
-                             &pNalLen[*pNalIdxInLayer]);
+    iReturn = WelsEncodeNalToFrameBs (pCtx, &pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
+                                      &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt, &pNalLen[*pNalIdxInLayer]);
     WELS_VERIFY_RETURN_IFNEQ (iReturn, ENC_RETURN_SUCCESS)
     iPayloadSize = pNalLen[*pNalIdxInLayer];
 
@@ -2715,11 +2880,8 @@ static inline int32_t AddPrefixNal (sWelsEncCtx* pCtx,
     // No need write any syntax of prefix NAL Unit RBSP here
     WelsUnloadNal (pCtx->pOut);
 
-    iReturn = WelsEncodeNal (&pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
-                             &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt,
-                             pCtx->iFrameBsSize - pCtx->iPosBsBuffer,
-                             pCtx->pFrameBs + pCtx->iPosBsBuffer,
-                             &pNalLen[*pNalIdxInLayer]);
+    iReturn = WelsEncodeNalToFrameBs (pCtx, &pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
+                                      &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt, &pNalLen[*pNalIdxInLayer]);
     WELS_VERIFY_RETURN_IFNEQ (iReturn, ENC_RETURN_SUCCESS)
     iPayloadSize = pNalLen[*pNalIdxInLayer];
 
@@ -2762,10 +2924,7 @@ int32_t WritePadding (sWelsEncCtx* pCtx, int32_t iLen, int32_t& iSize) {
   BsFlush (pBs);
 
   WelsUnloadNal (pCtx->pOut);
-  int32_t iReturn = WelsEncodeNal (&pCtx->pOut->sNalList[iNal], NULL,
-                                   pCtx->iFrameBsSize - pCtx->iPosBsBuffer,
-                                   pCtx->pFrameBs + pCtx->iPosBsBuffer,
-                                   &iNalLen);
+  int32_t iReturn = WelsEncodeNalToFrameBs (pCtx, &pCtx->pOut->sNalList[iNal], NULL, &iNalLen);
   WELS_VERIFY_RETURN_IFNEQ (iReturn, ENC_RETURN_SUCCESS)
 
   pCtx->iPosBsBuffer	+= iNalLen;
@@ -2793,6 +2952,7 @@ int32_t WelsEncoderEncodeParameterSets (sWelsEncCtx* pCtx, void* pDst) {
   int32_t iNalLen[128]        = {0};
   int32_t iCountNal           = 0;
 
+  pCtx->pFrameBsInfo   = pFbi;
   pLayerBsInfo->pBsBuf = pCtx->pFrameBs;
   InitBits (&pCtx->pOut->sBsWrite, pCtx->pOut->pBsBuffer, pCtx->pOut->uiSize);
 
@@ -2818,580 +2978,702 @@ int32_t WelsEncoderEncodeParameterSets (sWelsEncCtx* pCtx, void* pDst) {
 }
 
 /*!
- * \brief	core svc encoding process
- *
- * \pParam	pCtx			sWelsEncCtx*, encoder context
- * \pParam	pFbi			FrameBSInfo*
- * \pParam	pSrcPic			Source Picture
- * \return	EFrameType (videoFrameTypeIDR/videoFrameTypeI/videoFrameTypeP)
+ * \brief	code one spatial layer of the frame, its NALs are appended behind *ppLayerBsInfo
+ * \return	ENC_RETURN_SUCCESS; ENC_RETURN_CORRECTED if the next frame is forced to be IDR; others on errors
  */
-int32_t WelsEncoderEncodeExt (sWelsEncCtx* pCtx, SFrameBSInfo* pFbi, const SSourcePicture* pSrcPic) {
-  SLayerBSInfo* pLayerBsInfo					= &pFbi->sLayerInfo[0];
+static int32_t WelsEncodeSpatialLayer (sWelsEncCtx* pCtx, const int32_t kiSpatialIdx, const EVideoFrameType keFrameType,
+                                       SLayerBSInfo** ppLayerBsInfo, int32_t* pLayerNum) {
   SWelsSvcCodingParam* pSvcParam	= pCtx->pSvcParam;
-  SSpatialPicIndex* pSpatialIndexMap = &pCtx->sSpatialIndexMap[0];
+  SSpatialPicIndex* pSpatialIndexMap	= &pCtx->sSpatialIndexMap[kiSpatialIdx];
+  const int32_t iDidIdx			= pSpatialIndexMap->iDid;	// get iDid
+  SDLayerParam* pParam		= &pSvcParam->sDependencyLayers[iDidIdx];
+  SLayerBSInfo* pLayerBsInfo	= *ppLayerBsInfo;
+  int32_t iLayerNum					= *pLayerNum;
 #if defined(ENABLE_FRAME_DUMP) || defined(ENABLE_PSNR_CALC)
   SPicture* fsnr						= NULL;
 #endif//ENABLE_FRAME_DUMP || ENABLE_PSNR_CALC
-  SPicture* pEncPic						= NULL;	// to be decided later
-  int32_t iDidList[MAX_DEPENDENCY_LAYER]	= {0};
-  int32_t iLayerNum					= 0;
+  SPicture* pEncPic						= NULL;
   int32_t iLayerSize					= 0;
-  int32_t iSpatialNum					= 0; // available count number of spatial layers due to frame size changed in this given frame
-  int32_t iSpatialIdx					= 0; // iIndex of spatial layers due to frame size changed in this given frame
-  int32_t iFrameSize					= 0;
   int32_t iNalLen[128]				= {0};
   int32_t iNalIdxInLayer			= 0;
-  int32_t iCountNal					= 0;
-  EVideoFrameType eFrameType				= videoFrameTypeInvalid;
-  int32_t iCurWidth					= 0;
-  int32_t iCurHeight					= 0;
+  const int32_t iCurWidth			= pParam->iFrameWidth;
+  const int32_t iCurHeight			= pParam->iFrameHeight;
   EWelsNalUnitType eNalType			= NAL_UNIT_UNSPEC_0;
   EWelsNalRefIdc eNalRefIdc			= NRI_PRI_LOWEST;
-  int8_t iCurDid						= 0;
-  int8_t iCurTid						= 0;
+  const int8_t iCurDid				= (int8_t)iDidIdx;
+  const int8_t iCurTid				= (int8_t)pCtx->uiTemporalId;
   bool bAvcBased					= false;
 #if defined(ENABLE_PSNR_CALC)
   float fSnrY = .0f, fSnrU = .0f, fSnrV = .0f;
 #endif//ENABLE_PSNR_CALC
 
-#if defined(_DEBUG)
-  int32_t i = 0, j = 0, k = 0;
-#endif//_DEBUG
-
-  pCtx->iEncoderError						= ENC_RETURN_SUCCESS;
-  pFbi->iLayerNum	= 0;	// for initialization
-  pFbi->uiTimeStamp = pSrcPic->uiTimeStamp;
-  // perform csc/denoise/downsample/padding, generate spatial layers
-  iSpatialNum = pCtx->pVpp->BuildSpatialPicList (pCtx, pSrcPic);
-  if (iSpatialNum < 1) {	// skip due to temporal layer settings (different frame rate)
-    ++ pCtx->iCodingIndex;
-    pFbi->eOutputFrameType = videoFrameTypeSkip;
-    return ENC_RETURN_SUCCESS;
-  }
 
-  eFrameType = DecideFrameType (pCtx, iSpatialNum);
-  if (eFrameType == videoFrameTypeSkip) {
-    pFbi->eOutputFrameType = eFrameType;
-    return ENC_RETURN_SUCCESS;
+  pCtx->uiDependencyId	= iCurDid;
+  if (NULL != pCtx->pLayerThreading) {
+    WelsMutexLock (&pCtx->pLayerThreading->mutexPreProcess);
+    pCtx->pVpp->AnalyzeSpatialPic (pCtx, iDidIdx);
+    WelsMutexUnlock (&pCtx->pLayerThreading->mutexPreProcess);
+  } else {
+    pCtx->pVpp->AnalyzeSpatialPic (pCtx, iDidIdx);
   }
 
-  InitFrameCoding (pCtx, eFrameType);
+  pCtx->pEncPic	 = pEncPic = pSpatialIndexMap->pSrc;
+  pCtx->pEncPic->iPictureType	= pCtx->eSliceType;
+  pCtx->pEncPic->iFramePoc		= pCtx->iPOC;
 
-  iCurTid	= GetTemporalLevel (&pSvcParam->sDependencyLayers[pSpatialIndexMap->iDid], pCtx->iCodingIndex,
-                              pSvcParam->uiGopSize);
-  pCtx->uiTemporalId	= iCurTid;
 
-  pLayerBsInfo->pBsBuf	= pCtx->pFrameBs ;
+  // Encoding this picture might mulitiple sQualityStat layers potentially be encoded as followed
 
-  if (eFrameType == videoFrameTypeIDR) {
-    ++ pCtx->sPSOVector.uiIdrPicId;
-    //if ( pSvcParam->bEnableSSEI )
-
-    // write parameter sets bitstream here
-    pCtx->iEncoderError = WelsWriteParameterSets (pCtx, &iNalLen[0], &iCountNal);
-    WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
-
-    pLayerBsInfo->uiPriorityId	= 0;
-    pLayerBsInfo->uiSpatialId		= 0;
-    pLayerBsInfo->uiTemporalId	= 0;
-    pLayerBsInfo->uiQualityId		= 0;
-    pLayerBsInfo->uiLayerType		= NON_VIDEO_CODING_LAYER;
-    pLayerBsInfo->iNalCount		= iCountNal;
-    for (int32_t iNalIndex	= 0; iNalIndex < iCountNal; ++ iNalIndex) {
-      pLayerBsInfo->iNalLengthInByte[iNalIndex]	= iNalLen[iNalIndex];
-    }
-
-    ++ pLayerBsInfo;
-    pLayerBsInfo->pBsBuf			= pCtx->pFrameBs + pCtx->iPosBsBuffer;
-    ++ iLayerNum;
+  switch (pParam->sSliceCfg.uiSliceMode) {
+  case SM_FIXEDSLCNUM_SLICE:
+  case SM_AUTO_SLICE: {
+    if ((iCurDid > 0) && (pSvcParam->iMultipleThreadIdc > 1) &&
+        (pSvcParam->sDependencyLayers[iCurDid].sSliceCfg.uiSliceMode == SM_FIXEDSLCNUM_SLICE
+         && pSvcParam->iMultipleThreadIdc >= pSvcParam->sDependencyLayers[iCurDid].sSliceCfg.sSliceArgument.uiSliceNum)
+       )
+      AdjustEnhanceLayer (pCtx, iCurDid);
+    break;
+  }
+  case SM_DYN_SLICE: {
+    int32_t iPicIPartitionNum = PicPartitionNumDecision (pCtx);
+    // MT compatibility
+    pCtx->iActiveThreadsNum	=
+      iPicIPartitionNum;	// we try to active number of threads, equal to number of picture partitions
+    WelsInitCurrentDlayerMltslc (pCtx, iPicIPartitionNum);
+    break;
+  }
+  default: {
+    break;
+  }
   }
 
-  pCtx->pCurDqLayer				= pCtx->ppDqLayerList[pSpatialIndexMap->iDid];
-  pCtx->pCurDqLayer->pRefLayer	= NULL;
-
-  while (iSpatialIdx < iSpatialNum) {
-    const int32_t iDidIdx			= (pSpatialIndexMap + iSpatialIdx)->iDid;	// get iDid
-    SDLayerParam* pParam		= &pSvcParam->sDependencyLayers[iDidIdx];
-
-    pCtx->uiDependencyId	= iCurDid = (int8_t)iDidIdx;
-    pCtx->pVpp->AnalyzeSpatialPic (pCtx, iDidIdx);
-
-    pCtx->pEncPic	 = pEncPic = (pSpatialIndexMap + iSpatialIdx)->pSrc;
-    pCtx->pEncPic->iPictureType	= pCtx->eSliceType;
-    pCtx->pEncPic->iFramePoc		= pCtx->iPOC;
-
-    iCurWidth	= pParam->iFrameWidth;
-    iCurHeight	= pParam->iFrameHeight;
-
-    iDidList[iSpatialIdx]	= iCurDid;
-
-    // Encoding this picture might mulitiple sQualityStat layers potentially be encoded as followed
-
-    switch (pParam->sSliceCfg.uiSliceMode) {
-    case SM_FIXEDSLCNUM_SLICE:
-    case SM_AUTO_SLICE: {
-      if ((iCurDid > 0) && (pSvcParam->iMultipleThreadIdc > 1) &&
-          (pSvcParam->sDependencyLayers[iCurDid].sSliceCfg.uiSliceMode == SM_FIXEDSLCNUM_SLICE
-           && pSvcParam->iMultipleThreadIdc >= pSvcParam->sDependencyLayers[iCurDid].sSliceCfg.sSliceArgument.uiSliceNum)
-         )
-        AdjustEnhanceLayer (pCtx, iCurDid);
-      break;
-    }
-    case SM_DYN_SLICE: {
-      int32_t iPicIPartitionNum = PicPartitionNumDecision (pCtx);
-      // MT compatibility
-      pCtx->iActiveThreadsNum	=
-        iPicIPartitionNum;	// we try to active number of threads, equal to number of picture partitions
-      WelsInitCurrentDlayerMltslc (pCtx, iPicIPartitionNum);
-      break;
-    }
-    default: {
-      break;
-    }
-    }
-
-    /* coding each spatial layer, only one sQualityStat layer within spatial support */
-    int32_t iSliceCount	= 1;
-    if (iLayerNum >= MAX_LAYER_NUM_OF_FRAME) {	// check available layer_bs_info writing as follows
-      WelsLog (pCtx, WELS_LOG_ERROR, "WelsEncoderEncodeExt(), iLayerNum(%d) overflow(max:%d)!", iLayerNum,
-               MAX_LAYER_NUM_OF_FRAME);
-      return ENC_RETURN_UNSUPPORTED_PARA;
-    }
+  /* coding each spatial layer, only one sQualityStat layer within spatial support */
+  int32_t iSliceCount	= 1;
+  if (iLayerNum >= MAX_LAYER_NUM_OF_FRAME) {	// check available layer_bs_info writing as follows
+    WelsLog (pCtx, WELS_LOG_ERROR, "WelsEncoderEncodeExt(), iLayerNum(%d) overflow(max:%d)!", iLayerNum,
+             MAX_LAYER_NUM_OF_FRAME);
+    return ENC_RETURN_UNSUPPORTED_PARA;
+  }
 
-    iNalIdxInLayer	= 0;
-    bAvcBased	= (iCurDid == BASE_DEPENDENCY_ID);
-    pCtx->bNeedPrefixNalFlag	= (bAvcBased &&
-                                 (pSvcParam->bPrefixNalAddingCtrl ||
-                                  (pSvcParam->iSpatialLayerNum > 1)));
-
-    if (eFrameType == videoFrameTypeP) {
-      eNalType	= bAvcBased ? NAL_UNIT_CODED_SLICE : NAL_UNIT_CODED_SLICE_EXT;
-    } else if (eFrameType == videoFrameTypeIDR) {
-      eNalType	= bAvcBased ? NAL_UNIT_CODED_SLICE_IDR : NAL_UNIT_CODED_SLICE_EXT;
-    }
-    if (iCurTid == 0 || pCtx->eSliceType == I_SLICE)
-      eNalRefIdc	= NRI_PRI_HIGHEST;
-    else if (iCurTid == pSvcParam->iDecompStages)
-      eNalRefIdc	= NRI_PRI_LOWEST;
-    else if (1 + iCurTid == pSvcParam->iDecompStages)
-      eNalRefIdc	= NRI_PRI_LOW;
-    else	// more details for other temporal layers?
-      eNalRefIdc	= NRI_PRI_HIGHEST;
-    pCtx->eNalType		= eNalType;
-    pCtx->eNalPriority	= eNalRefIdc;
-
-    pCtx->pDecPic					= pCtx->ppRefPicListExt[iCurDid]->pNextBuffer;
+  iNalIdxInLayer	= 0;
+  bAvcBased	= (iCurDid == BASE_DEPENDENCY_ID);
+  pCtx->bNeedPrefixNalFlag	= (bAvcBased &&
+                               (pSvcParam->bPrefixNalAddingCtrl ||
+                                (pSvcParam->iSpatialLayerNum > 1)));
+
+  if (keFrameType == videoFrameTypeP) {
+    eNalType	= bAvcBased ? NAL_UNIT_CODED_SLICE : NAL_UNIT_CODED_SLICE_EXT;
+  } else if (keFrameType == videoFrameTypeIDR) {
+    eNalType	= bAvcBased ? NAL_UNIT_CODED_SLICE_IDR : NAL_UNIT_CODED_SLICE_EXT;
+  }
+  if (iCurTid == 0 || pCtx->eSliceType == I_SLICE)
+    eNalRefIdc	= NRI_PRI_HIGHEST;
+  else if (iCurTid == pSvcParam->iDecompStages)
+    eNalRefIdc	= NRI_PRI_LOWEST;
+  else if (1 + iCurTid == pSvcParam->iDecompStages)
+    eNalRefIdc	= NRI_PRI_LOW;
+  else	// more details for other temporal layers?
+    eNalRefIdc	= NRI_PRI_HIGHEST;
+  pCtx->eNalType		= eNalType;
+  pCtx->eNalPriority	= eNalRefIdc;
+
+  pCtx->pDecPic					= pCtx->ppRefPicListExt[iCurDid]->pNextBuffer;
 #if defined(ENABLE_FRAME_DUMP) || defined(ENABLE_PSNR_CALC)
-    fsnr					= pCtx->pDecPic;
+  fsnr					= pCtx->pDecPic;
 #endif//#if defined(ENABLE_FRAME_DUMP) || defined(ENABLE_PSNR_CALC)
-    pCtx->pDecPic->iPictureType	= pCtx->eSliceType;
-    pCtx->pDecPic->iFramePoc		= pCtx->iPOC;
-
-    WelsInitCurrentLayer (pCtx, iCurWidth, iCurHeight);
-
-    pCtx->pFuncList->pMarkPic (pCtx);
-    if (!pCtx->pFuncList->pBuildRefList (pCtx, pCtx->iPOC, 0)) {
-      // Force coding IDR as followed
-      ForceCodingIDR (pCtx);
-      WelsLog (pCtx, WELS_LOG_WARNING,
-               "WelsEncoderEncodeExt(), WelsBuildRefList failed for P frames, pCtx->iNumRef0= %d. ForceCodingIDR!\n",
-               pCtx->iNumRef0);
-      pFbi->eOutputFrameType = videoFrameTypeIDR;
-      pCtx->iEncoderError = ENC_RETURN_CORRECTED;
-      return ENC_RETURN_CORRECTED;
-    }
+  pCtx->pDecPic->iPictureType	= pCtx->eSliceType;
+  pCtx->pDecPic->iFramePoc		= pCtx->iPOC;
+
+  WelsInitCurrentLayer (pCtx, iCurWidth, iCurHeight);
+
+  pCtx->pFuncList->pMarkPic (pCtx);
+  if (!pCtx->pFuncList->pBuildRefList (pCtx, pCtx->iPOC, 0)) {
+    // Force coding IDR as followed
+    ForceCodingIDR (pCtx);
+    WelsLog (pCtx, WELS_LOG_WARNING,
+             "WelsEncoderEncodeExt(), WelsBuildRefList failed for P frames, pCtx->iNumRef0= %d. ForceCodingIDR!\n",
+             pCtx->iNumRef0);
+    pCtx->pFrameBsInfo->eOutputFrameType = videoFrameTypeIDR;
+    pCtx->iEncoderError = ENC_RETURN_CORRECTED;
+    return ENC_RETURN_CORRECTED;
+  }
 #ifdef LONG_TERM_REF_DUMP
-    DumpRef (pCtx);
+  DumpRef (pCtx);
 #endif
-    if((pSvcParam->iUsageType == SCREEN_CONTENT_REAL_TIME)&&(pSvcParam->iRCMode != RC_OFF_MODE))
-      pCtx->pVpp->AnalyzePictureComplexity(pCtx,pCtx->pEncPic,((pCtx->eSliceType == P_SLICE)&&(pCtx->iNumRef0>0))?pCtx->pRefList0[0]:NULL,
-                                           iCurDid,pSvcParam->bEnableBackgroundDetection);
+  if((pSvcParam->iUsageType == SCREEN_CONTENT_REAL_TIME)&&(pSvcParam->iRCMode != RC_OFF_MODE))
+    pCtx->pVpp->AnalyzePictureComplexity(pCtx,pCtx->pEncPic,((pCtx->eSliceType == P_SLICE)&&(pCtx->iNumRef0>0))?pCtx->pRefList0[0]:NULL,
+                                         iCurDid,pSvcParam->bEnableBackgroundDetection);
 
-    WelsUpdateRefSyntax (pCtx,  pCtx->iPOC,
-                         eFrameType);	//get reordering syntax used for writing slice header and transmit to encoder.
-    PrefetchReferencePicture (pCtx, eFrameType);	// update reference picture for current pDq layer
+  WelsUpdateRefSyntax (pCtx,  pCtx->iPOC,
+                       keFrameType);	//get reordering syntax used for writing slice header and transmit to encoder.
+  PrefetchReferencePicture (pCtx, keFrameType);	// update reference picture for current pDq layer
 
-    pCtx->pFuncList->pfRc.pfWelsRcPictureInit (pCtx);
-    PreprocessSliceCoding (pCtx);	// MUST be called after pfWelsRcPictureInit() and WelsInitCurrentLayer()
+  pCtx->pFuncList->pfRc.pfWelsRcPictureInit (pCtx);
+  PreprocessSliceCoding (pCtx);	// MUST be called after pfWelsRcPictureInit() and WelsInitCurrentLayer()
 
-    //TODO Complexity Calculation here for screen content
-    iLayerSize	= 0;
+  //TODO Complexity Calculation here for screen content
+  iLayerSize	= 0;
 
-    if (SM_SINGLE_SLICE == pParam->sSliceCfg.uiSliceMode) {	// only one slice within a sQualityStat layer
-      int32_t iSliceSize = 0;
-      int32_t iPayloadSize	= 0;
+  if (SM_SINGLE_SLICE == pParam->sSliceCfg.uiSliceMode) {	// only one slice within a sQualityStat layer
+    int32_t iSliceSize = 0;
+    int32_t iPayloadSize	= 0;
 
-      if (pCtx->bNeedPrefixNalFlag) {
-        pCtx->iEncoderError = AddPrefixNal (pCtx, pLayerBsInfo, &iNalLen[0], &iNalIdxInLayer, eNalType, eNalRefIdc,
-                                            iPayloadSize);
-        WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
-        iLayerSize += iPayloadSize;
-      }
+    if (pCtx->bNeedPrefixNalFlag) {
+      pCtx->iEncoderError = AddPrefixNal (pCtx, pLayerBsInfo, &iNalLen[0], &iNalIdxInLayer, eNalType, eNalRefIdc,
+                                          iPayloadSize);
+      WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+      iLayerSize += iPayloadSize;
+    }
 
-      WelsLoadNal (pCtx->pOut, eNalType, eNalRefIdc);
+    WelsLoadNal (pCtx->pOut, eNalType, eNalRefIdc);
 
-      pCtx->iEncoderError = WelsCodeOneSlice (pCtx, 0, eNalType);
-      WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+    pCtx->iEncoderError = WelsCodeOneSlice (pCtx, 0, eNalType);
+    WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
 
-      WelsUnloadNal (pCtx->pOut);
+    WelsUnloadNal (pCtx->pOut);
 
-      pCtx->iEncoderError = WelsEncodeNal (&pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
-                                           &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt,
-                                           pCtx->iFrameBsSize - pCtx->iPosBsBuffer,
-                                           pCtx->pFrameBs + pCtx->iPosBsBuffer,
-                                           &iNalLen[iNalIdxInLayer]);
-      WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
-      iSliceSize = iNalLen[iNalIdxInLayer];
+    pCtx->iEncoderError = WelsEncodeNalToFrameBs (pCtx, &pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
+                                                  &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt, &iNalLen[iNalIdxInLayer]);
+    WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+    iSliceSize = iNalLen[iNalIdxInLayer];
 
-      iLayerSize += iSliceSize;
-      pCtx->iPosBsBuffer	+= iSliceSize;
-      pLayerBsInfo->uiLayerType		= VIDEO_CODING_LAYER;
-      pLayerBsInfo->uiSpatialId		= iCurDid;
-      pLayerBsInfo->uiTemporalId	= iCurTid;
-      pLayerBsInfo->uiQualityId		= 0;
-      pLayerBsInfo->uiPriorityId	= 0;
-      pLayerBsInfo->iNalLengthInByte[iNalIdxInLayer]	= iSliceSize;
-      pLayerBsInfo->iNalCount		= ++ iNalIdxInLayer;
-    }
-    // for dynamic slicing single threading..
-    else if ((SM_DYN_SLICE == pParam->sSliceCfg.uiSliceMode) && (pSvcParam->iMultipleThreadIdc <= 1)) {
-      const int32_t kiLastMbInFrame = pCtx->pCurDqLayer->pSliceEncCtx->iMbNumInFrame;
-      pCtx->iEncoderError = WelsCodeOnePicPartition (pCtx, pLayerBsInfo, &iNalIdxInLayer, &iLayerSize, 0, kiLastMbInFrame, 0);
-      WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
-    } else {
-      //other multi-slice uiSliceMode
-      int32_t iRet = 0;
-      // THREAD_FULLY_FIRE_MODE/THREAD_PICK_UP_MODE for any mode of non-SM_DYN_SLICE
-      if ((SM_DYN_SLICE != pParam->sSliceCfg.uiSliceMode) && (pSvcParam->iMultipleThreadIdc > 1)) {
-        iSliceCount	= GetCurrentSliceNum (pCtx->pCurDqLayer->pSliceEncCtx);
-        if (iLayerNum + 1 >= MAX_LAYER_NUM_OF_FRAME) {	// check available layer_bs_info for further writing as followed
-          WelsLog (pCtx, WELS_LOG_ERROR,
-                   "WelsEncoderEncodeExt(), iLayerNum(%d) overflow(max:%d) at iDid= %d uiSliceMode= %d, iSliceCount= %d!",
-                   iLayerNum, MAX_LAYER_NUM_OF_FRAME, iCurDid, pParam->sSliceCfg.uiSliceMode, iSliceCount);
-          return ENC_RETURN_UNSUPPORTED_PARA;
-        }
-        if (iSliceCount <= 1) {
-          WelsLog (pCtx, WELS_LOG_ERROR,
-                   "WelsEncoderEncodeExt(), iSliceCount(%d) from GetCurrentSliceNum() is untrusted due stack/heap crupted!\n",
-                   iSliceCount);
-          return ENC_RETURN_UNEXPECTED;
-        }
+    iLayerSize += iSliceSize;
+    pCtx->iPosBsBuffer	+= iSliceSize;
+    pLayerBsInfo->uiLayerType		= VIDEO_CODING_LAYER;
+    pLayerBsInfo->uiSpatialId		= iCurDid;
+    pLayerBsInfo->uiTemporalId	= iCurTid;
+    pLayerBsInfo->uiQualityId		= 0;
+    pLayerBsInfo->uiPriorityId	= 0;
+    pLayerBsInfo->iNalLengthInByte[iNalIdxInLayer]	= iSliceSize;
+    pLayerBsInfo->iNalCount		= ++ iNalIdxInLayer;
+  }
+  // for dynamic slicing single threading..
+  else if ((SM_DYN_SLICE == pParam->sSliceCfg.uiSliceMode) && (pSvcParam->iMultipleThreadIdc <= 1)) {
+    const int32_t kiLastMbInFrame = pCtx->pCurDqLayer->pSliceEncCtx->iMbNumInFrame;
+    pCtx->iEncoderError = WelsCodeOnePicPartition (pCtx, pLayerBsInfo, &iNalIdxInLayer, &iLayerSize, 0, kiLastMbInFrame, 0);
+    WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+  } else {
+    //other multi-slice uiSliceMode
+    int32_t iRet = 0;
+    // slice tasks over the thread pool for any mode of non-SM_DYN_SLICE
+    if ((SM_DYN_SLICE != pParam->sSliceCfg.uiSliceMode) && (pSvcParam->iMultipleThreadIdc > 1)) {
+      iSliceCount	= GetCurrentSliceNum (pCtx->pCurDqLayer->pSliceEncCtx);
+      if (iLayerNum + 1 >= MAX_LAYER_NUM_OF_FRAME) {	// check available layer_bs_info for further writing as followed
+        WelsLog (pCtx, WELS_LOG_ERROR,
+                 "WelsEncoderEncodeExt(), iLayerNum(%d) overflow(max:%d) at iDid= %d uiSliceMode= %d, iSliceCount= %d!",
+                 iLayerNum, MAX_LAYER_NUM_OF_FRAME, iCurDid, pParam->sSliceCfg.uiSliceMode, iSliceCount);
+        return ENC_RETURN_UNSUPPORTED_PARA;
+      }
+      if (iSliceCount <= 1) {
+        WelsLog (pCtx, WELS_LOG_ERROR,
+                 "WelsEncoderEncodeExt(), iSliceCount(%d) from GetCurrentSliceNum() is untrusted due stack/heap crupted!\n",
+                 iSliceCount);
+        return ENC_RETURN_UNEXPECTED;
+      }
 
-        if (pSvcParam->iCountThreadsNum >= iSliceCount) {	//THREAD_FULLY_FIRE_MODE
 #if defined(MT_DEBUG)
-          int64_t t_bs_append = 0;
+      int64_t t_bs_append = 0;
 #endif
 
-          pCtx->iActiveThreadsNum	= iSliceCount;
-          // to fire slice coding threads
-          iRet = FiredSliceThreads (&pCtx->pSliceThreading->pThreadPEncCtx[0], &pCtx->pSliceThreading->pReadySliceCodingEvent[0],
-                                   &pCtx->pSliceThreading->pThreadMasterEvent[0],
-                                   pLayerBsInfo, iSliceCount, pCtx->pCurDqLayer->pSliceEncCtx, false);
-          if (iRet) {
-            WelsLog (pCtx, WELS_LOG_ERROR,
-                     "[MT] WelsEncoderEncodeExt(), FiredSliceThreads return(%d) failed and exit encoding frame, iCountThreadsNum= %d, iSliceCount= %d, uiSliceMode= %d, iMultipleThreadIdc= %d!!\n",
-                     iRet, pSvcParam->iCountThreadsNum, iSliceCount, pParam->sSliceCfg.uiSliceMode, pSvcParam->iMultipleThreadIdc);
-            return ENC_RETURN_UNEXPECTED;
-          }
-
-          WelsMultipleEventsWaitAllBlocking (iSliceCount, &pCtx->pSliceThreading->pSliceCodedEvent[0],
-                                             &pCtx->pSliceThreading->pSliceCodedMasterEvent);
-
+      pCtx->iActiveThreadsNum	= WELS_MIN (pSvcParam->iCountThreadsNum, iSliceCount);
+      // slices are picked up by the pool threads as they get free, the calling thread joins them
+      iRet = CodeSliceTasks (pCtx, pLayerBsInfo, iSliceCount, false);
+      if (iRet) {
+        WelsLog (pCtx, WELS_LOG_ERROR,
+                 "[MT] WelsEncoderEncodeExt(), CodeSliceTasks return(%d) failed and exit encoding frame, iCountThreadsNum= %d, iSliceCount= %d, uiSliceMode= %d, iMultipleThreadIdc= %d!!\n",
+                 iRet, pSvcParam->iCountThreadsNum, iSliceCount, pParam->sSliceCfg.uiSliceMode, pSvcParam->iMultipleThreadIdc);
+        return ENC_RETURN_UNEXPECTED;
+      }
 
-          // all slices are finished coding here
-          WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+      // all slices are finished coding here
+      WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
 
-          // append exclusive slice 0 bs to pFrameBs
+      // append exclusive slice 0 bs to pFrameBs
 #if defined(MT_DEBUG)
-          t_bs_append = WelsTime();
+      t_bs_append = WelsTime();
 #endif//MT_DEBUG
-          iLayerSize = AppendSliceToFrameBs (pCtx, pLayerBsInfo, iSliceCount);
+      iLayerSize = AppendSliceToFrameBs (pCtx, pLayerBsInfo, iSliceCount);
+      WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
 #if defined(MT_DEBUG)
-          t_bs_append = WelsTime() - t_bs_append;
-          if (pCtx->pSliceThreading->pFSliceDiff) {
-            fprintf (pCtx->pSliceThreading->pFSliceDiff,
-                     "%6"PRId64" us consumed at AppendSliceToFrameBs() for coding_idx: %d iDid: %d qid: %d\n",
-                     t_bs_append, pCtx->iCodingIndex, iCurDid, 0);
-          }
+      t_bs_append = WelsTime() - t_bs_append;
+      if (pCtx->pSliceThreading->pFSliceDiff) {
+        fprintf (pCtx->pSliceThreading->pFSliceDiff,
+                 "%6"PRId64" us consumed at AppendSliceToFrameBs() for coding_idx: %d iDid: %d qid: %d\n",
+                 t_bs_append, pCtx->iCodingIndex, iCurDid, 0);
+      }
 #endif//MT_DEBUG
-        } else {	//THREAD_PICK_UP_MODE
-          int32_t iNumThreadsRunning = 0;
-          int32_t iNumThreadsScheduled = 0;
-          int32_t iIndexOfSliceToBeCoded = 0;
-
-          pCtx->iActiveThreadsNum	= pSvcParam->iCountThreadsNum;
-          iNumThreadsScheduled	= pCtx->iActiveThreadsNum;
-          iNumThreadsRunning		= iNumThreadsScheduled;
-          // to fire slice coding threads
-          iRet = FiredSliceThreads (&pCtx->pSliceThreading->pThreadPEncCtx[0], &pCtx->pSliceThreading->pReadySliceCodingEvent[0],
-                                   &pCtx->pSliceThreading->pThreadMasterEvent[0],
-                                   pLayerBsInfo, iNumThreadsRunning, pCtx->pCurDqLayer->pSliceEncCtx, false);
-          if (iRet) {
-            WelsLog (pCtx, WELS_LOG_ERROR,
-                     "[MT] WelsEncoderEncodeExt(), FiredSliceThreads return(%d) failed and exit encoding frame, iCountThreadsNum= %d, iSliceCount= %d, uiSliceMode= %d, iMultipleThreadIdc= %d!!\n",
-                     iRet, pSvcParam->iCountThreadsNum, iSliceCount, pParam->sSliceCfg.uiSliceMode, pSvcParam->iMultipleThreadIdc);
-            return ENC_RETURN_UNEXPECTED;
-          }
-
-          iIndexOfSliceToBeCoded = iNumThreadsRunning;
-          while (1) {
-            if (iIndexOfSliceToBeCoded >= iSliceCount && iNumThreadsRunning <= 0)
-              break;
-            WELS_THREAD_ERROR_CODE lwait	= 0;
-            int32_t iEventId				= -1;
-
-            lwait = WelsMultipleEventsWaitSingleBlocking (iNumThreadsScheduled,
-                    &pCtx->pSliceThreading->pSliceCodedEvent[0],
-                    &pCtx->pSliceThreading->pSliceCodedMasterEvent);
-            iEventId = (int32_t) (lwait - WELS_THREAD_ERROR_WAIT_OBJECT_0);
-            if (iEventId >= 0 && iEventId < iNumThreadsScheduled) {
-              if (iIndexOfSliceToBeCoded < iSliceCount) {
-                // pick up succeeding slice for threading
-                // thread_id equal to iEventId per implementation here
-                pCtx->pSliceThreading->pThreadPEncCtx[iEventId].iSliceIndex	= iIndexOfSliceToBeCoded;
-                WelsEventSignal (&pCtx->pSliceThreading->pReadySliceCodingEvent[iEventId]);
-                WelsEventSignal (&pCtx->pSliceThreading->pThreadMasterEvent[iEventId]);
-
-                ++ iIndexOfSliceToBeCoded;
-              } else {	// no other slices left for coding
-                -- iNumThreadsRunning;
-              }
-            }
-          }//while(1)
+    }
+    // picture partition tasks over the thread pool for SM_DYN_SLICE
+    else if ((SM_DYN_SLICE == pParam->sSliceCfg.uiSliceMode) && (pSvcParam->iMultipleThreadIdc > 1)) {
+      const int32_t kiPartitionCnt	= pCtx->iActiveThreadsNum; //pSvcParam->iCountThreadsNum;
 
-          // all slices are finished coding here
-          // append exclusive slice 0 bs to pFrameBs
-          iLayerSize = AppendSliceToFrameBs (pCtx, pLayerBsInfo, iSliceCount);
-        }
+      iRet = CodeSliceTasks (pCtx, pLayerBsInfo, kiPartitionCnt, true);
+      if (iRet) {
+        WelsLog (pCtx, WELS_LOG_ERROR,
+                 "[MT] WelsEncoderEncodeExt(), CodeSliceTasks return(%d) failed and exit encoding frame, iCountThreadsNum= %d, iSliceCount= %d, uiSliceMode= %d, iMultipleThreadIdc= %d!!\n",
+                 iRet, pSvcParam->iCountThreadsNum, iSliceCount, pParam->sSliceCfg.uiSliceMode, pSvcParam->iMultipleThreadIdc);
+        return ENC_RETURN_UNEXPECTED;
       }
-      // THREAD_FULLY_FIRE_MODE && SM_DYN_SLICE
-      else if ((SM_DYN_SLICE == pParam->sSliceCfg.uiSliceMode) && (pSvcParam->iMultipleThreadIdc > 1)) {
-        const int32_t kiPartitionCnt	= pCtx->iActiveThreadsNum; //pSvcParam->iCountThreadsNum;
-
-        // to fire slice coding threads
-        iRet = FiredSliceThreads (&pCtx->pSliceThreading->pThreadPEncCtx[0], &pCtx->pSliceThreading->pReadySliceCodingEvent[0],
-                                 &pCtx->pSliceThreading->pThreadMasterEvent[0],
-                                 pLayerBsInfo, kiPartitionCnt, pCtx->pCurDqLayer->pSliceEncCtx, true);
-        if (iRet) {
-          WelsLog (pCtx, WELS_LOG_ERROR,
-                   "[MT] WelsEncoderEncodeExt(), FiredSliceThreads return(%d) failed and exit encoding frame, iCountThreadsNum= %d, iSliceCount= %d, uiSliceMode= %d, iMultipleThreadIdc= %d!!\n",
-                   iRet, pSvcParam->iCountThreadsNum, iSliceCount, pParam->sSliceCfg.uiSliceMode, pSvcParam->iMultipleThreadIdc);
-          return ENC_RETURN_UNEXPECTED;
+      WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+
+      iLayerSize = AppendSliceToFrameBs (pCtx, pLayerBsInfo, kiPartitionCnt);
+      WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+    } else {	// for non-dynamic-slicing mode single threading branch..
+      const bool bNeedPrefix	= pCtx->bNeedPrefixNalFlag;
+      int32_t iSliceIdx			= 0;
+
+      iSliceCount	= GetCurrentSliceNum (pCtx->pCurDqLayer->pSliceEncCtx);
+      while (iSliceIdx < iSliceCount) {
+        int32_t iSliceSize	= 0;
+        int32_t iPayloadSize	= 0;
+        if (bNeedPrefix) {
+          pCtx->iEncoderError = AddPrefixNal (pCtx, pLayerBsInfo, &iNalLen[0], &iNalIdxInLayer, eNalType, eNalRefIdc,
+                                              iPayloadSize);
+          WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+          iLayerSize += iPayloadSize;
         }
 
-        WelsMultipleEventsWaitAllBlocking (kiPartitionCnt, &pCtx->pSliceThreading->pSliceCodedEvent[0],
-                                           &pCtx->pSliceThreading->pSliceCodedMasterEvent);
+        WelsLoadNal (pCtx->pOut, eNalType, eNalRefIdc);
+        pCtx->iEncoderError = WelsCodeOneSlice (pCtx, iSliceIdx, eNalType);
         WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
 
-        iLayerSize = AppendSliceToFrameBs (pCtx, pLayerBsInfo, kiPartitionCnt);
-      } else {	// for non-dynamic-slicing mode single threading branch..
-        const bool bNeedPrefix	= pCtx->bNeedPrefixNalFlag;
-        int32_t iSliceIdx			= 0;
-
-        iSliceCount	= GetCurrentSliceNum (pCtx->pCurDqLayer->pSliceEncCtx);
-        while (iSliceIdx < iSliceCount) {
-          int32_t iSliceSize	= 0;
-          int32_t iPayloadSize	= 0;
-          if (bNeedPrefix) {
-            pCtx->iEncoderError = AddPrefixNal (pCtx, pLayerBsInfo, &iNalLen[0], &iNalIdxInLayer, eNalType, eNalRefIdc,
-                                                iPayloadSize);
-            WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
-            iLayerSize += iPayloadSize;
-          }
-
-          WelsLoadNal (pCtx->pOut, eNalType, eNalRefIdc);
-          pCtx->iEncoderError = WelsCodeOneSlice (pCtx, iSliceIdx, eNalType);
-          WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
-
-          WelsUnloadNal (pCtx->pOut);
+        WelsUnloadNal (pCtx->pOut);
 
-          pCtx->iEncoderError = WelsEncodeNal (&pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
-                                               &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt,
-                                               pCtx->iFrameBsSize - pCtx->iPosBsBuffer,
-                                               pCtx->pFrameBs + pCtx->iPosBsBuffer, &iNalLen[iNalIdxInLayer]);
-          WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
-          iSliceSize = iNalLen[iNalIdxInLayer];
+        pCtx->iEncoderError = WelsEncodeNalToFrameBs (pCtx, &pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
+                                                      &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt, &iNalLen[iNalIdxInLayer]);
+        WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+        iSliceSize = iNalLen[iNalIdxInLayer];
 
-          pCtx->iPosBsBuffer	+= iSliceSize;
-          iLayerSize	+= iSliceSize;
-          pLayerBsInfo->iNalLengthInByte[iNalIdxInLayer]	= iSliceSize;
+        pCtx->iPosBsBuffer	+= iSliceSize;
+        iLayerSize	+= iSliceSize;
+        pLayerBsInfo->iNalLengthInByte[iNalIdxInLayer]	= iSliceSize;
 
 #if defined(SLICE_INFO_OUTPUT)
-          fprintf (stderr,
-                   "@slice=%-6d sliceType:%c idc:%d size:%-6d\n",
-                   iSliceIdx,
-                   (pCtx->eSliceType == P_SLICE ? 'P' : 'I'),
-                   eNalRefIdc,
-                   iSliceSize);
+        fprintf (stderr,
+                 "@slice=%-6d sliceType:%c idc:%d size:%-6d\n",
+                 iSliceIdx,
+                 (pCtx->eSliceType == P_SLICE ? 'P' : 'I'),
+                 eNalRefIdc,
+                 iSliceSize);
 #endif//SLICE_INFO_OUTPUT
-          ++ iNalIdxInLayer;
-          ++ iSliceIdx;
-        }
-
-        pLayerBsInfo->uiLayerType		= VIDEO_CODING_LAYER;
-        pLayerBsInfo->uiSpatialId		= iCurDid;
-        pLayerBsInfo->uiTemporalId	= iCurTid;
-        pLayerBsInfo->uiQualityId		= 0;
-        pLayerBsInfo->uiPriorityId	= 0;
-        pLayerBsInfo->iNalCount		= iNalIdxInLayer;
+        ++ iNalIdxInLayer;
+        ++ iSliceIdx;
       }
+
+      pLayerBsInfo->uiLayerType		= VIDEO_CODING_LAYER;
+      pLayerBsInfo->uiSpatialId		= iCurDid;
+      pLayerBsInfo->uiTemporalId	= iCurTid;
+      pLayerBsInfo->uiQualityId		= 0;
+      pLayerBsInfo->uiPriorityId	= 0;
+      pLayerBsInfo->iNalCount		= iNalIdxInLayer;
     }
+  }
 
-    // deblocking filter
-    if (
-      (!pCtx->pCurDqLayer->bDeblockingParallelFlag) &&
+  // deblocking filter
+  if (
+    (!pCtx->pCurDqLayer->bDeblockingParallelFlag) &&
 #if !defined(ENABLE_FRAME_DUMP)
-      ((eNalRefIdc != NRI_PRI_LOWEST) && (pParam->iHighestTemporalId == 0 || iCurTid < pParam->iHighestTemporalId)) &&
+    ((eNalRefIdc != NRI_PRI_LOWEST) && (pParam->iHighestTemporalId == 0 || iCurTid < pParam->iHighestTemporalId)) &&
 #endif//!ENABLE_FRAME_DUMP
-      true
-    ) {
-      PerformDeblockingFilter (pCtx);
-    }
+    true
+  ) {
+    PerformDeblockingFilter (pCtx);
+  }
 
-    // reference picture list update
-    if (eNalRefIdc != NRI_PRI_LOWEST) {
-      if (!pCtx->pFuncList->pUpdateRefList (pCtx)) {
-        // Force coding IDR as followed
-        ForceCodingIDR (pCtx);
-        WelsLog (pCtx, WELS_LOG_WARNING, "WelsEncoderEncodeExt(), WelsUpdateRefList failed. ForceCodingIDR!\n");
-        //the above is to set the next frame to be IDR
-        pFbi->eOutputFrameType = eFrameType;
-        return ENC_RETURN_CORRECTED;
-      }
+  // reference picture list update
+  if (eNalRefIdc != NRI_PRI_LOWEST) {
+    if (!pCtx->pFuncList->pUpdateRefList (pCtx)) {
+      // Force coding IDR as followed
+      ForceCodingIDR (pCtx);
+      WelsLog (pCtx, WELS_LOG_WARNING, "WelsEncoderEncodeExt(), WelsUpdateRefList failed. ForceCodingIDR!\n");
+      //the above is to set the next frame to be IDR
+      pCtx->pFrameBsInfo->eOutputFrameType = keFrameType;
+      return ENC_RETURN_CORRECTED;
     }
+  }
 
-    iFrameSize += iLayerSize;
-
-    pCtx->pFuncList->pfRc.pfWelsRcPictureInfoUpdate (pCtx, iLayerSize);
+  pCtx->pFuncList->pfRc.pfWelsRcPictureInfoUpdate (pCtx, iLayerSize);
 
 #ifdef ENABLE_FRAME_DUMP
-    // Dump reconstruction picture for each sQualityStat layer
-    if (iCurDid + 1 < pSvcParam->iSpatialLayerNum)
-      DumpDependencyRec (fsnr, &pParam->sRecFileName[0], iCurDid);
+  // Dump reconstruction picture for each sQualityStat layer
+  if (iCurDid + 1 < pSvcParam->iSpatialLayerNum)
+    DumpDependencyRec (fsnr, &pParam->sRecFileName[0], iCurDid);
 #endif//ENABLE_FRAME_DUMP
 
 #if defined(ENABLE_PSNR_CALC)
-    fSnrY	= WelsCalcPsnr (fsnr->pData[0],
-                          fsnr->iLineSize[0],
-                          pEncPic->pData[0],
-                          pEncPic->iLineSize[0],
-                          iCurWidth,
-                          iCurHeight);
-    fSnrU	= WelsCalcPsnr (fsnr->pData[1],
-                          fsnr->iLineSize[1],
-                          pEncPic->pData[1],
-                          pEncPic->iLineSize[1],
-                          (iCurWidth >> 1),
-                          (iCurHeight >> 1));
-    fSnrV	= WelsCalcPsnr (fsnr->pData[2],
-                          fsnr->iLineSize[2],
-                          pEncPic->pData[2],
-                          pEncPic->iLineSize[2],
-                          (iCurWidth >> 1),
-                          (iCurHeight >> 1));
+  fSnrY	= WelsCalcPsnr (fsnr->pData[0],
+                        fsnr->iLineSize[0],
+                        pEncPic->pData[0],
+                        pEncPic->iLineSize[0],
+                        iCurWidth,
+                        iCurHeight);
+  fSnrU	= WelsCalcPsnr (fsnr->pData[1],
+                        fsnr->iLineSize[1],
+                        pEncPic->pData[1],
+                        pEncPic->iLineSize[1],
+                        (iCurWidth >> 1),
+                        (iCurHeight >> 1));
+  fSnrV	= WelsCalcPsnr (fsnr->pData[2],
+                        fsnr->iLineSize[2],
+                        pEncPic->pData[2],
+                        pEncPic->iLineSize[2],
+                        (iCurWidth >> 1),
+                        (iCurHeight >> 1));
 #endif//ENABLE_PSNR_CALC
 
 #if defined(LAYER_INFO_OUTPUT)
-    fprintf (stderr, "%2s %5d: %-5d %2s   T%1d D%1d Q%-2d  QP%3d   Y%2.2f  U%2.2f  V%2.2f  %8d bits\n",
-             (iSpatialIdx == 0) ? "#AU" : "   ",
-             pCtx->iPOC,
-             pCtx->iFrameNum,
-             (uiFrameType == videoFrameTypeI || uiFrameType == videoFrameTypeIDR) ? "I" : "P",
-             iCurTid,
-             iCurDid,
-             0,
-             pCtx->pWelsSvcRc[pCtx->uiDependencyId].iAverageFrameQp,
-             fSnrY,
-             fSnrU,
-             fSnrV,
-             (iLayerSize << 3));
+  fprintf (stderr, "%2s %5d: %-5d %2s   T%1d D%1d Q%-2d  QP%3d   Y%2.2f  U%2.2f  V%2.2f  %8d bits\n",
+           (kiSpatialIdx == 0) ? "#AU" : "   ",
+           pCtx->iPOC,
+           pCtx->iFrameNum,
+           (uiFrameType == videoFrameTypeI || uiFrameType == videoFrameTypeIDR) ? "I" : "P",
+           iCurTid,
+           iCurDid,
+           0,
+           pCtx->pWelsSvcRc[pCtx->uiDependencyId].iAverageFrameQp,
+           fSnrY,
+           fSnrU,
+           fSnrV,
+           (iLayerSize << 3));
 #endif//LAYER_INFO_OUTPUT
 
 #if defined(STAT_OUTPUT)
 
 #if defined(ENABLE_PSNR_CALC)
-    {
-      pCtx->sStatData[iCurDid][0].sQualityStat.rYPsnr[pCtx->eSliceType]	+= fSnrY;
-      pCtx->sStatData[iCurDid][0].sQualityStat.rUPsnr[pCtx->eSliceType]	+= fSnrU;
-      pCtx->sStatData[iCurDid][0].sQualityStat.rVPsnr[pCtx->eSliceType]	+= fSnrV;
-    }
+  {
+    pCtx->sStatData[iCurDid][0].sQualityStat.rYPsnr[pCtx->eSliceType]	+= fSnrY;
+    pCtx->sStatData[iCurDid][0].sQualityStat.rUPsnr[pCtx->eSliceType]	+= fSnrU;
+    pCtx->sStatData[iCurDid][0].sQualityStat.rVPsnr[pCtx->eSliceType]	+= fSnrV;
+  }
 #endif//ENABLE_PSNR_CALC
 
 #if defined(MB_TYPES_CHECK) //091025, frame output
-    if (pCtx->eSliceType == P_SLICE) {
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Intra4x4] += pCtx->sPerInfo.iMbCount[P_SLICE][Intra4x4];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Intra16x16] += pCtx->sPerInfo.iMbCount[P_SLICE][Intra16x16];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Inter16x16] += pCtx->sPerInfo.iMbCount[P_SLICE][Inter16x16];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Inter16x8] += pCtx->sPerInfo.iMbCount[P_SLICE][Inter16x8];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Inter8x16] += pCtx->sPerInfo.iMbCount[P_SLICE][Inter8x16];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Inter8x8] += pCtx->sPerInfo.iMbCount[P_SLICE][Inter8x8];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][PSkip] += pCtx->sPerInfo.iMbCount[P_SLICE][PSkip];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][8] += pCtx->sPerInfo.iMbCount[P_SLICE][8];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][9] += pCtx->sPerInfo.iMbCount[P_SLICE][9];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][10] += pCtx->sPerInfo.iMbCount[P_SLICE][10];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][11] += pCtx->sPerInfo.iMbCount[P_SLICE][11];
-    } else if (pCtx->eSliceType == I_SLICE) {
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[I_SLICE][Intra4x4] += pCtx->sPerInfo.iMbCount[I_SLICE][Intra4x4];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[I_SLICE][Intra16x16] += pCtx->sPerInfo.iMbCount[I_SLICE][Intra16x16];
-      pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[I_SLICE][7] += pCtx->sPerInfo.iMbCount[I_SLICE][7];
-    }
-
-    memset (pCtx->sPerInfo.iMbCount[P_SLICE], 0, 18 * sizeof (int32_t));
-    memset (pCtx->sPerInfo.iMbCount[I_SLICE], 0, 18 * sizeof (int32_t));
+  if (pCtx->eSliceType == P_SLICE) {
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Intra4x4] += pCtx->sPerInfo.iMbCount[P_SLICE][Intra4x4];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Intra16x16] += pCtx->sPerInfo.iMbCount[P_SLICE][Intra16x16];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Inter16x16] += pCtx->sPerInfo.iMbCount[P_SLICE][Inter16x16];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Inter16x8] += pCtx->sPerInfo.iMbCount[P_SLICE][Inter16x8];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Inter8x16] += pCtx->sPerInfo.iMbCount[P_SLICE][Inter8x16];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][Inter8x8] += pCtx->sPerInfo.iMbCount[P_SLICE][Inter8x8];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][PSkip] += pCtx->sPerInfo.iMbCount[P_SLICE][PSkip];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][8] += pCtx->sPerInfo.iMbCount[P_SLICE][8];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][9] += pCtx->sPerInfo.iMbCount[P_SLICE][9];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][10] += pCtx->sPerInfo.iMbCount[P_SLICE][10];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[P_SLICE][11] += pCtx->sPerInfo.iMbCount[P_SLICE][11];
+  } else if (pCtx->eSliceType == I_SLICE) {
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[I_SLICE][Intra4x4] += pCtx->sPerInfo.iMbCount[I_SLICE][Intra4x4];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[I_SLICE][Intra16x16] += pCtx->sPerInfo.iMbCount[I_SLICE][Intra16x16];
+    pCtx->sStatData[iCurDid][0].sSliceData.iMbCount[I_SLICE][7] += pCtx->sPerInfo.iMbCount[I_SLICE][7];
+  }
+
+  memset (pCtx->sPerInfo.iMbCount[P_SLICE], 0, 18 * sizeof (int32_t));
+  memset (pCtx->sPerInfo.iMbCount[I_SLICE], 0, 18 * sizeof (int32_t));
 
 #endif//MB_TYPES_CHECK
-    {
-      ++ pCtx->sStatData[iCurDid][0].sSliceData.iSliceCount[pCtx->eSliceType];	// for multiple slices coding
-      pCtx->sStatData[iCurDid][0].sSliceData.iSliceSize[pCtx->eSliceType]	+= (iLayerSize << 3);	// bits
-    }
+  {
+    ++ pCtx->sStatData[iCurDid][0].sSliceData.iSliceCount[pCtx->eSliceType];	// for multiple slices coding
+    pCtx->sStatData[iCurDid][0].sSliceData.iSliceSize[pCtx->eSliceType]	+= (iLayerSize << 3);	// bits
+  }
 #endif//STAT_OUTPUT
 
-    ++ iLayerNum;
-    ++ pLayerBsInfo;
+  ++ iLayerNum;
+  ++ pLayerBsInfo;
 
-    pLayerBsInfo->pBsBuf	= pCtx->pFrameBs + pCtx->iPosBsBuffer;
+  pLayerBsInfo->pBsBuf	= pCtx->pFrameBs + pCtx->iPosBsBuffer;
 
-    if (pSvcParam->iPaddingFlag && pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize > 0) {
-      int32_t iPaddingNalSize = 0;
-      pCtx->iEncoderError =  WritePadding (pCtx, pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize, iPaddingNalSize);
-      WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+  if (pSvcParam->iPaddingFlag && pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize > 0) {
+    int32_t iPaddingNalSize = 0;
+    pCtx->iEncoderError =  WritePadding (pCtx, pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize, iPaddingNalSize);
+    WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
 
 #if GOM_TRACE_FLAG
-      WelsLog (pCtx, WELS_LOG_INFO, "[RC] encoding_qp%d Padding: %d\n", pCtx->uiDependencyId,
-               pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize);
+    WelsLog (pCtx, WELS_LOG_INFO, "[RC] encoding_qp%d Padding: %d\n", pCtx->uiDependencyId,
+             pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize);
 #endif
-      if (iPaddingNalSize <= 0)
-        return ENC_RETURN_UNEXPECTED;
+    if (iPaddingNalSize <= 0)
+      return ENC_RETURN_UNEXPECTED;
 
-      pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingBitrateStat += pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize;
+    pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingBitrateStat += pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize;
 
-      pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize = 0;
+    pCtx->pWelsSvcRc[pCtx->uiDependencyId].iPaddingSize = 0;
 
-      pLayerBsInfo->uiPriorityId	= 0;
-      pLayerBsInfo->uiSpatialId		= 0;
-      pLayerBsInfo->uiTemporalId	= 0;
-      pLayerBsInfo->uiQualityId		= 0;
-      pLayerBsInfo->uiLayerType		= NON_VIDEO_CODING_LAYER;
-      pLayerBsInfo->iNalCount		= 1;
-      pLayerBsInfo->iNalLengthInByte[0] = iPaddingNalSize;
-      ++ pLayerBsInfo;
-      pLayerBsInfo->pBsBuf	= pCtx->pFrameBs + pCtx->iPosBsBuffer;
-      ++ iLayerNum;
-    }
+    pLayerBsInfo->uiPriorityId	= 0;
+    pLayerBsInfo->uiSpatialId		= 0;
+    pLayerBsInfo->uiTemporalId	= 0;
+    pLayerBsInfo->uiQualityId		= 0;
+    pLayerBsInfo->uiLayerType		= NON_VIDEO_CODING_LAYER;
+    pLayerBsInfo->iNalCount		= 1;
+    pLayerBsInfo->iNalLengthInByte[0] = iPaddingNalSize;
+    ++ pLayerBsInfo;
+    pLayerBsInfo->pBsBuf	= pCtx->pFrameBs + pCtx->iPosBsBuffer;
+    ++ iLayerNum;
+  }
 
-    if ((pParam->sSliceCfg.uiSliceMode == SM_FIXEDSLCNUM_SLICE || pParam->sSliceCfg.uiSliceMode == SM_AUTO_SLICE)
-        && pSvcParam->iMultipleThreadIdc > 1 &&
-        pSvcParam->iMultipleThreadIdc >= pParam->sSliceCfg.sSliceArgument.uiSliceNum) {
-      CalcSliceComplexRatio (pCtx->pSliceThreading->pSliceComplexRatio[iCurDid], pCtx->pCurDqLayer->pSliceEncCtx,
-                             pCtx->pSliceThreading->pSliceConsumeTime[iCurDid]);
+  if ((pParam->sSliceCfg.uiSliceMode == SM_FIXEDSLCNUM_SLICE || pParam->sSliceCfg.uiSliceMode == SM_AUTO_SLICE)
+      && pSvcParam->iMultipleThreadIdc > 1 &&
+      pSvcParam->iMultipleThreadIdc >= pParam->sSliceCfg.sSliceArgument.uiSliceNum) {
+    CalcSliceComplexRatio (pCtx->pSliceThreading->pSliceComplexRatio[iCurDid], pCtx->pCurDqLayer->pSliceEncCtx,
+                           pCtx->pSliceThreading->pSliceConsumeTime[iCurDid]);
 #if defined(MT_DEBUG)
-      TrackSliceComplexities (pCtx, iCurDid);
+    TrackSliceComplexities (pCtx, iCurDid);
 #endif//#if defined(MT_DEBUG)
+  }
+
+  *ppLayerBsInfo	= pLayerBsInfo;
+  *pLayerNum		= iLayerNum;
+  return ENC_RETURN_SUCCESS;
+}
+
+static void EncodeLayerTask (void* pArg) {
+  SLayerTask* pTask				= (SLayerTask*)pArg;
+  SLayerBSInfo* pLayerBsInfo	= &pTask->sFbi.sLayerInfo[0];
+
+  pTask->iLayerNum	= 0;
+  pTask->iReturn	= WelsEncodeSpatialLayer (&pTask->sCtx, pTask->iSpatialIdx, pTask->eFrameType, &pLayerBsInfo,
+                    &pTask->iLayerNum);
+  WelsEmms();
+}
+
+/*!
+ * \brief	check that a layer copy of pCtx still shares what its layer must only read, or only write at its iDid
+ */
+static inline void AssertLayerCtxShared (const sWelsEncCtx* kpCtx, const sWelsEncCtx* kpLayerCtx) {
+  assert (kpLayerCtx->pSvcParam == kpCtx->pSvcParam);
+  assert (kpLayerCtx->pMvdCostTableInter == kpCtx->pMvdCostTableInter);
+  assert (kpLayerCtx->pSpsArray == kpCtx->pSpsArray && kpLayerCtx->pPPSArray == kpCtx->pPPSArray
+          && kpLayerCtx->pSubsetArray == kpCtx->pSubsetArray);
+  assert (0 == memcmp (&kpLayerCtx->sPSOVector, &kpCtx->sPSOVector, sizeof (kpCtx->sPSOVector)));
+  assert (kpLayerCtx->ppDqLayerList == kpCtx->ppDqLayerList && kpLayerCtx->pSliceCtxList == kpCtx->pSliceCtxList);
+  assert (kpLayerCtx->ppRefPicListExt == kpCtx->ppRefPicListExt && kpLayerCtx->pLtr == kpCtx->pLtr);
+  assert (kpLayerCtx->pWelsSvcRc == kpCtx->pWelsSvcRc);
+  assert (kpLayerCtx->pVpp == kpCtx->pVpp && kpLayerCtx->pMemAlign == kpCtx->pMemAlign);
+}
+
+/*!
+ * \brief	code the spatial layers of the frame concurrently, each on a private copy of pCtx without the
+ *			reference layer, and append their NALs behind *ppLayerBsInfo in coding order
+ * \return	as WelsEncodeSpatialLayer(), the first failure of the layers in coding order
+ */
+static int32_t WelsEncodeSpatialLayersParallel (sWelsEncCtx* pCtx, const int32_t kiSpatialNum,
+    const EVideoFrameType keFrameType, SLayerBSInfo** ppLayerBsInfo, int32_t* pLayerNum) {
+  SLayerThreading* pLt			= pCtx->pLayerThreading;
+  SLayerBSInfo* pLayerBsInfo	= *ppLayerBsInfo;
+  int32_t iLayerNum				= *pLayerNum;
+  int32_t iReturn				= ENC_RETURN_SUCCESS;
+  int32_t iSpatialIdx			= 0;
+
+  for (iSpatialIdx = 0; iSpatialIdx < kiSpatialNum; ++ iSpatialIdx) {
+    const int32_t kiDid		= pCtx->sSpatialIndexMap[iSpatialIdx].iDid;
+    SLayerTask* pTask		= &pLt->sTask[kiDid];
+    sWelsEncCtx* pLayerCtx	= &pTask->sCtx;
+
+    // The copy (under 1 KB) is taken for every frame, as frame number, POC, slice type and the like change.
+    // - replaced below: function list, NAL output, frame bitstream, VAA buffers and current DQ layer;
+    // - written by the layer into the copy only: current pictures, NAL type and priority, qp, error state,
+    //   taken over from the copy of the last layer once all of them are done;
+    // - shared and only read: pSvcParam, the parameter sets and sPSOVector, pMvdCostTableInter;
+    // - shared and only written at the iDid of the layer: ppDqLayerList, pSliceCtxList, ppRefPicListExt,
+    //   pLtr, pWelsSvcRc, sSpatialIndexMap[].pSrc;
+    // - shared and serialized: pVpp under mutexPreProcess, pMemAlign under its own lock.
+    // AssertLayerCtxShared() checks the shared part once the layers are coded.
+    *pLayerCtx				= *pCtx;
+    *pTask->pFuncList		= *pCtx->pFuncList;
+    pLayerCtx->pFuncList	= pTask->pFuncList;
+
+    pLayerCtx->pOut			= pTask->pOut;
+    pLayerCtx->pOut->iNalIndex	= 0;
+    InitBits (&pLayerCtx->pOut->sBsWrite, pLayerCtx->pOut->pBsBuffer, pLayerCtx->pOut->uiSize);
+    pLayerCtx->pFrameBs		= pTask->pFrameBs;
+    pLayerCtx->iFrameBsSize	= pTask->iFrameBsSize;
+    pLayerCtx->iPosBsBuffer	= 0;
+    pLayerCtx->pFrameBsInfo	= &pTask->sFbi;
+    pTask->sFbi.sLayerInfo[0].pBsBuf	= pTask->pFrameBs;
+
+    // frame level decisions are shared, the analysis of the layer goes to its own buffers
+    pTask->pVaa->eSceneChangeIdc	= pCtx->pVaa->eSceneChangeIdc;
+    pTask->pVaa->bSceneChangeFlag	= pCtx->pVaa->bSceneChangeFlag;
+    pTask->pVaa->bIdrPeriodFlag		= pCtx->pVaa->bIdrPeriodFlag;
+    pLayerCtx->pVaa			= pTask->pVaa;
+
+    pLayerCtx->pCurDqLayer	= pCtx->ppDqLayerList[kiDid];
+    pLayerCtx->pCurDqLayer->pRefLayer	= NULL;
+
+    pTask->iSpatialIdx	= iSpatialIdx;
+    pTask->eFrameType	= keFrameType;
+    WelsThreadPoolSubmit (pLt->pThreadPool, &pLt->sLayerTasks, EncodeLayerTask, pTask);
+  }
+  WelsThreadPoolWait (pLt->pThreadPool, &pLt->sLayerTasks);
+
+  for (iSpatialIdx = 0; iSpatialIdx < kiSpatialNum; ++ iSpatialIdx) {
+    const int32_t kiDid		= pCtx->sSpatialIndexMap[iSpatialIdx].iDid;
+    SLayerTask* pTask		= &pLt->sTask[kiDid];
+    sWelsEncCtx* pLayerCtx	= &pTask->sCtx;
+    const int32_t kiLayerBsLen	= pLayerCtx->iPosBsBuffer;
+    uint8_t* pBsBuf			= NULL;
+
+    AssertLayerCtxShared (pCtx, pLayerCtx);
+
+    pTask->pFrameBs		= pLayerCtx->pFrameBs;	// might have been enlarged
+    pTask->iFrameBsSize	= pLayerCtx->iFrameBsSize;
+    pCtx->bEncCurFrmAsIdrFlag	= pCtx->bEncCurFrmAsIdrFlag || pLayerCtx->bEncCurFrmAsIdrFlag;
+#if defined(STAT_OUTPUT)
+    memcpy (pCtx->sStatData[kiDid], pLayerCtx->sStatData[kiDid], sizeof (pCtx->sStatData[kiDid]));
+#endif//STAT_OUTPUT
+
+    if (ENC_RETURN_SUCCESS != iReturn)
+      continue;
+    if (ENC_RETURN_SUCCESS != pTask->iReturn) {
+      iReturn	= pTask->iReturn;
+      pCtx->iEncoderError	= pLayerCtx->iEncoderError;
+      if (ENC_RETURN_CORRECTED == iReturn) {
+        ForceCodingIDR (pCtx);
+        pCtx->pFrameBsInfo->eOutputFrameType	= pTask->sFbi.eOutputFrameType;
+      }
+      continue;
+    }
+    if (iLayerNum + pTask->iLayerNum >= MAX_LAYER_NUM_OF_FRAME) {
+      WelsLog (pCtx, WELS_LOG_ERROR, "WelsEncodeSpatialLayersParallel(), iLayerNum(%d) overflow(max:%d)!",
+               iLayerNum + pTask->iLayerNum, MAX_LAYER_NUM_OF_FRAME);
+      iReturn	= ENC_RETURN_UNSUPPORTED_PARA;
+      continue;
+    }
+    if (pCtx->iFrameBsSize - pCtx->iPosBsBuffer < kiLayerBsLen) {
+      iReturn	= GrowFrameBs (pCtx, kiLayerBsLen);
+      if (ENC_RETURN_SUCCESS != iReturn)
+        continue;
+    }
+
+    pBsBuf	= pCtx->pFrameBs + pCtx->iPosBsBuffer;
+    memcpy (pBsBuf, pTask->pFrameBs, kiLayerBsLen);	// confirmed_safe_unsafe_usage
+    for (int32_t i = 0; i < pTask->iLayerNum; ++ i) {
+      *pLayerBsInfo	= pTask->sFbi.sLayerInfo[i];
+      pLayerBsInfo->pBsBuf	= pBsBuf + (pTask->sFbi.sLayerInfo[i].pBsBuf - pTask->pFrameBs);
+      ++ pLayerBsInfo;
+    }
+    iLayerNum	+= pTask->iLayerNum;
+    pCtx->iPosBsBuffer	+= kiLayerBsLen;
+    pLayerBsInfo->pBsBuf	= pCtx->pFrameBs + pCtx->iPosBsBuffer;
+  }
+  WELS_VERIFY_RETURN_IFNEQ (iReturn, ENC_RETURN_SUCCESS)
+
+  // the frame goes on from the state its last layer is left in, as after serial coding
+  {
+    const sWelsEncCtx* kpLastCtx	= &pLt->sTask[pCtx->sSpatialIndexMap[kiSpatialNum - 1].iDid].sCtx;
+    pCtx->uiDependencyId	= kpLastCtx->uiDependencyId;
+    pCtx->pCurDqLayer		= kpLastCtx->pCurDqLayer;
+    pCtx->pEncPic			= kpLastCtx->pEncPic;
+    pCtx->pDecPic			= kpLastCtx->pDecPic;
+    pCtx->pRefPic			= kpLastCtx->pRefPic;
+    pCtx->iNumRef0			= kpLastCtx->iNumRef0;
+    pCtx->eNalType			= kpLastCtx->eNalType;
+    pCtx->eNalPriority		= kpLastCtx->eNalPriority;
+    pCtx->bNeedPrefixNalFlag	= kpLastCtx->bNeedPrefixNalFlag;
+    pCtx->iGlobalQp			= kpLastCtx->iGlobalQp;
+    pCtx->iSkipFrameFlag	= kpLastCtx->iSkipFrameFlag;
+  }
+
+  *ppLayerBsInfo	= pLayerBsInfo;
+  *pLayerNum		= iLayerNum;
+  return ENC_RETURN_SUCCESS;
+}
+
+/*!
+ * \brief	core svc encoding process
+ *
+ * \pParam	pCtx			sWelsEncCtx*, encoder context
+ * \pParam	pFbi			FrameBSInfo*
+ * \pParam	pSrcPic			Source Picture
+ * \return	EFrameType (videoFrameTypeIDR/videoFrameTypeI/videoFrameTypeP)
+ */
+int32_t WelsEncoderEncodeExt (sWelsEncCtx* pCtx, SFrameBSInfo* pFbi, const SSourcePicture* pSrcPic) {
+  SLayerBSInfo* pLayerBsInfo					= &pFbi->sLayerInfo[0];
+  SWelsSvcCodingParam* pSvcParam	= pCtx->pSvcParam;
+  SSpatialPicIndex* pSpatialIndexMap = &pCtx->sSpatialIndexMap[0];
+  int32_t iDidList[MAX_DEPENDENCY_LAYER]	= {0};
+  int32_t iLayerNum					= 0;
+  int32_t iSpatialNum					= 0; // available count number of spatial layers due to frame size changed in this given frame
+  int32_t iSpatialIdx					= 0; // iIndex of spatial layers due to frame size changed in this given frame
+  int32_t iNalLen[128]				= {0};
+  int32_t iCountNal					= 0;
+  EVideoFrameType eFrameType				= videoFrameTypeInvalid;
+  int8_t iCurDid						= 0;
+  int8_t iCurTid						= 0;
+
+#if defined(_DEBUG)
+  int32_t i = 0, j = 0, k = 0;
+#endif//_DEBUG
+
+  pCtx->iEncoderError						= ENC_RETURN_SUCCESS;
+  pCtx->pFrameBsInfo						= pFbi;
+  pFbi->iLayerNum	= 0;	// for initialization
+  pFbi->uiTimeStamp = pSrcPic->uiTimeStamp;
+  // perform csc/denoise/downsample/padding, generate spatial layers
+  iSpatialNum = pCtx->pVpp->BuildSpatialPicList (pCtx, pSrcPic);
+  if (iSpatialNum < 1) {	// skip due to temporal layer settings (different frame rate)
+    ++ pCtx->iCodingIndex;
+    pFbi->eOutputFrameType = videoFrameTypeSkip;
+    return ENC_RETURN_SUCCESS;
+  }
+
+  eFrameType = DecideFrameType (pCtx, iSpatialNum);
+  if (eFrameType == videoFrameTypeSkip) {
+    pFbi->eOutputFrameType = eFrameType;
+    return ENC_RETURN_SUCCESS;
+  }
+
+  InitFrameCoding (pCtx, eFrameType);
+
+  iCurTid	= GetTemporalLevel (&pSvcParam->sDependencyLayers[pSpatialIndexMap->iDid], pCtx->iCodingIndex,
+                              pSvcParam->uiGopSize);
+  pCtx->uiTemporalId	= iCurTid;
+
+  pLayerBsInfo->pBsBuf	= pCtx->pFrameBs ;
+
+  if (eFrameType == videoFrameTypeIDR) {
+    ++ pCtx->sPSOVector.uiIdrPicId;
+    //if ( pSvcParam->bEnableSSEI )
+
+    // write parameter sets bitstream here
+    pCtx->iEncoderError = WelsWriteParameterSets (pCtx, &iNalLen[0], &iCountNal);
+    WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+
+    pLayerBsInfo->uiPriorityId	= 0;
+    pLayerBsInfo->uiSpatialId		= 0;
+    pLayerBsInfo->uiTemporalId	= 0;
+    pLayerBsInfo->uiQualityId		= 0;
+    pLayerBsInfo->uiLayerType		= NON_VIDEO_CODING_LAYER;
+    pLayerBsInfo->iNalCount		= iCountNal;
+    for (int32_t iNalIndex	= 0; iNalIndex < iCountNal; ++ iNalIndex) {
+      pLayerBsInfo->iNalLengthInByte[iNalIndex]	= iNalLen[iNalIndex];
+    }
+
+    ++ pLayerBsInfo;
+    pLayerBsInfo->pBsBuf			= pCtx->pFrameBs + pCtx->iPosBsBuffer;
+    ++ iLayerNum;
+  }
+
+  pCtx->pCurDqLayer				= pCtx->ppDqLayerList[pSpatialIndexMap->iDid];
+  pCtx->pCurDqLayer->pRefLayer	= NULL;
+
+  if (NULL != pCtx->pLayerThreading) {
+    const int32_t kiReturn = WelsEncodeSpatialLayersParallel (pCtx, iSpatialNum, eFrameType, &pLayerBsInfo, &iLayerNum);
+    WELS_VERIFY_RETURN_IFNEQ (kiReturn, ENC_RETURN_SUCCESS)
+  }
+
+  while (iSpatialIdx < iSpatialNum) {
+    const int32_t iDidIdx			= (pSpatialIndexMap + iSpatialIdx)->iDid;	// get iDid
+
+    iCurDid	= (int8_t)iDidIdx;
+    iDidList[iSpatialIdx]	= iCurDid;
+
+    if (NULL == pCtx->pLayerThreading) {
+      const int32_t kiReturn = WelsEncodeSpatialLayer (pCtx, iSpatialIdx, eFrameType, &pLayerBsInfo, &iLayerNum);
+      WELS_VERIFY_RETURN_IFNEQ (kiReturn, ENC_RETURN_SUCCESS)
     }
 
     ++ iSpatialIdx;
 
-    if (iCurDid + 1 < pSvcParam->iSpatialLayerNum) {
+    if (NULL == pCtx->pLayerThreading && iCurDid + 1 < pSvcParam->iSpatialLayerNum) {
       WelsSwapDqLayers (pCtx);
     }
 
@@ -3430,12 +3712,12 @@ int32_t WelsEncoderEncodeExt (sWelsEncCtx* pCtx, SFrameBSInfo* pFbi, const SSour
   }
 
 #ifdef ENABLE_FRAME_DUMP
-  DumpRecFrame (fsnr, &pSvcParam->sDependencyLayers[pSvcParam->iSpatialLayerNum -
+  DumpRecFrame (pCtx->ppDqLayerList[iDidList[iSpatialNum - 1]]->pDecPic, &pSvcParam->sDependencyLayers[pSvcParam->iSpatialLayerNum -
                 1].sRecFileName[0]);	// pDecPic: final reconstruction output
 #endif//ENABLE_FRAME_DUMP
 
   ++ pCtx->iCodingIndex;
-  pCtx->eLastNalPriority	= eNalRefIdc;
+  pCtx->eLastNalPriority	= pCtx->eNalPriority;
   pFbi->iLayerNum			= iLayerNum;
 
   WelsEmms();
@@ -3473,7 +3755,9 @@ int32_t WelsEncoderParamAdjust (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pNewPa
                  || pOldParam->iPicHeight != pNewParam->iPicHeight) ||
                 (pOldParam->SUsedPicRect.iWidth != pNewParam->SUsedPicRect.iWidth
                  || pOldParam->SUsedPicRect.iHeight != pNewParam->SUsedPicRect.iHeight) ||
-                (pOldParam->bEnableLongTermReference != pNewParam->bEnableLongTermReference);
+                (pOldParam->bEnableLongTermReference != pNewParam->bEnableLongTermReference) ||
+                (pOldParam->bParallelSpatialLayers != pNewParam->bParallelSpatialLayers) ||
+                (pOldParam->bEnableHierarchicalMe != pNewParam->bEnableHierarchicalMe);
   if (!bNeedReset) {	// Check its picture resolutions/quality settings respectively in each dependency layer
     iIndexD = 0;
     assert (pOldParam->iSpatialLayerNum == pNewParam->iSpatialLayerNum);
@@ -3520,20 +3804,30 @@ int32_t WelsEncoderParamAdjust (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pNewPa
   }
 
   if (bNeedReset) {
+    if (PendingPipelineFrames (*ppCtx)) {
+      WelsLog (*ppCtx, WELS_LOG_WARNING,
+               "WelsEncoderParamAdjust(), reset refused, bitstreams of submitted frames not fetched yet.\n");
+      return ENC_RETURN_UNEXPECTED;
+    }
     SParaSetOffsetVariable sTmpPsoVariable[PARA_SET_TYPE];
     uint16_t	          uiTmpIdrPicId;//this is for LTR!
     memcpy (sTmpPsoVariable, (*ppCtx)->sPSOVector.sParaSetOffsetVariable,
             (PARA_SET_TYPE)*sizeof (SParaSetOffsetVariable)); // confirmed_safe_unsafe_usage
     uiTmpIdrPicId = (*ppCtx)->sPSOVector.uiIdrPicId;
+    SZeroCopySource sZeroCopySource;
+    (*ppCtx)->pVpp->GetZeroCopySource (*ppCtx, &sZeroCopySource);
 
-    WelsUninitEncoderExt (ppCtx);
+    // keep the allocator so that the new context reuses the blocks just freed
+    CMemoryAlign* pMa = NULL;
+    WelsUninitEncoderExt (ppCtx, &pMa);
 
     /* Update new parameters */
-    if (WelsInitEncoderExt (ppCtx, pNewParam))
+    if (WelsInitEncoderExt (ppCtx, pNewParam, pMa))
       return 1;
 
     // reset the scaled spatial picture size
     (*ppCtx)->pVpp->WelsPreprocessReset (*ppCtx);
+    (*ppCtx)->pVpp->SetZeroCopySource (&sZeroCopySource);
     //if WelsInitEncoderExt succeed
 
     //for FLEXIBLE_PARASET_ID
@@ -3670,11 +3964,8 @@ int32_t WelsCodeOnePicPartition (sWelsEncCtx* pCtx,
     WELS_VERIFY_RETURN_IFNEQ (iReturn, ENC_RETURN_SUCCESS)
     WelsUnloadNal (pCtx->pOut);
 
-    iReturn = WelsEncodeNal (&pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
-                             &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt,
-                             pCtx->iFrameBsSize - pCtx->iPosBsBuffer,
-                             pCtx->pFrameBs + pCtx->iPosBsBuffer,
-                             &iNalLen[iNalIdxInLayer]);
+    iReturn = WelsEncodeNalToFrameBs (pCtx, &pCtx->pOut->sNalList[pCtx->pOut->iNalIndex - 1],
+                                      &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt, &iNalLen[iNalIdxInLayer]);
     WELS_VERIFY_RETURN_IFNEQ (iReturn, ENC_RETURN_SUCCESS)
     iSliceSize = iNalLen[iNalIdxInLayer];
 
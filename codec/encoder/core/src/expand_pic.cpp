@@ -165,4 +165,46 @@ void ExpandReferencingPicture (SPicture* pPic, PExpandPictureFunc pExpLuma, PExp
 
 }
 
+// pad lines [kiLineStart, kiLineEnd) of a plane, along with the top/bottom margin when the first/last line is in
+static void ExpandPlaneLines_c (uint8_t* pDst, const int32_t kiStride, const int32_t kiPicW, const int32_t kiPicH,
+                                const int32_t kiPaddingLen, const int32_t kiLineStart, const int32_t kiLineEnd) {
+  const int32_t kiEnd	= WELS_MIN (kiLineEnd, kiPicH);
+  uint8_t* pTmp		= pDst + kiLineStart * kiStride;
+  int32_t i			= kiLineStart;
+
+  // pad left and right
+  while (i < kiEnd) {
+    memset (pTmp - kiPaddingLen, pTmp[0], kiPaddingLen);
+    memset (pTmp + kiPicW, pTmp[kiPicW - 1], kiPaddingLen);
+    pTmp += kiStride;
+    ++ i;
+  }
+
+  // pad top and bottom, the corners go with the padded lines
+  if (0 == kiLineStart) {
+    for (i = 1; i <= kiPaddingLen; ++ i)
+      memcpy (pDst - kiPaddingLen - i * kiStride, pDst - kiPaddingLen, kiPicW + (kiPaddingLen << 1));	// confirmed_safe_unsafe_usage
+  }
+  if (kiEnd == kiPicH) {
+    uint8_t* pLastLine	= pDst + (kiPicH - 1) * kiStride - kiPaddingLen;
+    for (i = 1; i <= kiPaddingLen; ++ i)
+      memcpy (pLastLine + i * kiStride, pLastLine, kiPicW + (kiPaddingLen << 1));	// confirmed_safe_unsafe_usage
+  }
+}
+
+void ExpandReferencingPictureMbRow (SPicture* pPic, const int32_t kiMbY) {
+  const int32_t kiWidthY	= pPic->iWidthInPixel;
+  const int32_t kiHeightY	= pPic->iHeightInPixel;
+  const int32_t kiWidthUV	= kiWidthY >> 1;
+  const int32_t kiHeightUV	= kiHeightY >> 1;
+  const int32_t kiLineY		= kiMbY << 4;
+  const int32_t kiLineUV	= kiMbY << 3;
+
+  ExpandPlaneLines_c (pPic->pData[0], pPic->iLineSize[0], kiWidthY, kiHeightY, PADDING_LENGTH, kiLineY, kiLineY + 16);
+  ExpandPlaneLines_c (pPic->pData[1], pPic->iLineSize[1], kiWidthUV, kiHeightUV, PADDING_LENGTH >> 1, kiLineUV,
+                      kiLineUV + 8);
+  ExpandPlaneLines_c (pPic->pData[2], pPic->iLineSize[2], kiWidthUV, kiHeightUV, PADDING_LENGTH >> 1, kiLineUV,
+                      kiLineUV + 8);
+}
+
 }
@@ -481,6 +481,59 @@ void McChroma_ssse3 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int
 
 #endif //X86_ASM
 
+#if defined(X86_INTRINSICS)
+//***************************************************************************//
+//                       AVX2 implementation                                 //
+//***************************************************************************//
+// the odd 9/17 column cases run an overlapping 8-wide block for the last columns
+void McHorVer20Width9Or17_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                int32_t iWidth, int32_t iHeight) {
+  if (iWidth == 17) {
+    McHorVer20WidthEq16_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+    McHorVer20WidthEq8_avx2 (pSrc + 9, iSrcStride, pDst + 9, iDstStride, iHeight);
+  } else {
+    McHorVer20WidthEq8_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+    McHorVer20WidthEq8_avx2 (pSrc + 1, iSrcStride, pDst + 1, iDstStride, iHeight);
+  }
+}
+void McHorVer02Height9Or17_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                                 int32_t iWidth, int32_t iHeight) {
+  if (iWidth == 16)
+    McHorVer02WidthEq16_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+  else
+    McHorVer02WidthEq8_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+}
+void McHorVer22Width9Or17Height9Or17_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+    int32_t iWidth, int32_t iHeight) {
+  if (iWidth == 17) {
+    McHorVer22WidthEq16_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+    McHorVer22WidthEq8_avx2 (pSrc + 9, iSrcStride, pDst + 9, iDstStride, iHeight);
+  } else {
+    McHorVer22WidthEq8_avx2 (pSrc, iSrcStride, pDst, iDstStride, iHeight);
+    McHorVer22WidthEq8_avx2 (pSrc + 1, iSrcStride, pDst + 1, iDstStride, iHeight);
+  }
+}
+
+void McChroma_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                    SMVUnitXY sMv, int32_t iWidth, int32_t iHeight) {
+  const int32_t kiD8x = sMv.iMvX & 0x07;
+  const int32_t kiD8y = sMv.iMvY & 0x07;
+
+  if (0 == kiD8x && 0 == kiD8y) {
+    McCopy (pSrc, iSrcStride, pDst, iDstStride, iWidth, iHeight);
+  } else if (iWidth == 8) {
+    McChromaWidthEq8_avx2 (pSrc, iSrcStride, pDst, iDstStride, g_kuiABCD[kiD8y][kiD8x], iHeight);
+  } else {
+#if defined(X86_ASM)
+    McChromaWidthEq4_mmx (pSrc, iSrcStride, pDst, iDstStride, g_kuiABCD[kiD8y][kiD8x], iHeight);
+#else
+    McChroma_c (pSrc, iSrcStride, pDst, iDstStride, sMv, iWidth, iHeight);
+#endif//X86_ASM
+  }
+}
+
+#endif //X86_INTRINSICS
+
     //***************************************************************************//
     //                       NEON implementation                      //
     //***************************************************************************//
@@ -591,6 +644,19 @@ void WelsInitMcFuncs (SWelsFuncPtrList* pFuncList, uint32_t uiCpuFlag) {
     McHorVer03WidthEq16, McHorVer13WidthEq16, McHorVer23WidthEq16, McHorVer33WidthEq16
   };
 #endif
+#if defined(X86_INTRINSICS)
+  static PWelsLumaQuarpelMcFunc pWelsMcFuncWidthEq16_avx2[16] = {
+#if defined(X86_ASM)
+    McCopyWidthEq16_sse2,
+#else
+    McCopyWidthEq16_c,
+#endif//X86_ASM
+    McHorVer10WidthEq16, McHorVer20WidthEq16_avx2,     McHorVer30WidthEq16,
+    McHorVer01WidthEq16, McHorVer11WidthEq16, McHorVer21WidthEq16, McHorVer31WidthEq16,
+    McHorVer02WidthEq16_avx2,     McHorVer12WidthEq16, McHorVer22WidthEq16_avx2,    McHorVer32WidthEq16,
+    McHorVer03WidthEq16, McHorVer13WidthEq16, McHorVer23WidthEq16, McHorVer33WidthEq16
+  };
+#endif//X86_INTRINSICS
 #if defined(HAVE_NEON)
   static PWelsLumaQuarpelMcFunc pWelsMcFuncWidthEq16_neon[16] = { //[x][y]
     McCopyWidthEq16_neon,        McHorVer10WidthEq16_neon,   McHorVer20WidthEq16_neon,    McHorVer30WidthEq16_neon,
@@ -637,9 +703,21 @@ void WelsInitMcFuncs (SWelsFuncPtrList* pFuncList, uint32_t uiCpuFlag) {
   if (uiCpuFlag & WELS_CPU_SSSE3) {
     pFuncList->sMcFuncs.pfChromaMc = McChroma_ssse3;
   }
-
 #endif //(X86_ASM)
 
+#if defined(X86_INTRINSICS)
+  if (uiCpuFlag & WELS_CPU_AVX2) {
+    pFuncList->sMcFuncs.pfLumaHalfpelHor = McHorVer20Width9Or17_avx2;
+    pFuncList->sMcFuncs.pfLumaHalfpelVer = McHorVer02Height9Or17_avx2;
+    pFuncList->sMcFuncs.pfLumaHalfpelCen = McHorVer22Width9Or17Height9Or17_avx2;
+    pFuncList->sMcFuncs.pfChromaMc = McChroma_avx2;
+    pfMcHorVer02WidthEq16 = McHorVer02WidthEq16_avx2;
+    pfMcHorVer20WidthEq16 = McHorVer20WidthEq16_avx2;
+    pfMcHorVer22WidthEq16 = McHorVer22WidthEq16_avx2;
+    pFuncList->sMcFuncs.pfLumaQuarpelMc = pWelsMcFuncWidthEq16_avx2;
+  }
+#endif //(X86_INTRINSICS)
+
 #if defined(HAVE_NEON)
   if (uiCpuFlag & WELS_CPU_NEON) {
     pFuncList->sMcFuncs.pfLumaQuarpelMc	= pWelsMcFuncWidthEq16_neon;
@@ -39,6 +39,12 @@
 #include "nal_encap.h"
 #include "svc_enc_golomb.h"
 #include "ls_defines.h"
+#include "macros.h"
+#if defined(X86_INTRINSICS) && (defined(__SSE2__) || defined(_M_X64))
+// SSE2 is part of the target baseline, the escaping needs no cpu dispatch
+#define NAL_ESCAPE_SSE2
+#include <emmintrin.h>
+#endif
 namespace WelsSVCEnc {
 /*!
  * \brief	load an initialize NAL pRawNal pData
@@ -110,6 +116,41 @@ void WelsUnloadNalForSlice (SWelsSliceBs* pSliceBsIn) {
   ++ (*pIdx);
 }
 
+/*!
+ * \brief	upper bound of the size WelsEncodeNal() writes for a raw NAL
+ * \param	pRawNal			pRawNal NAL pData
+ * \return	size in bytes, not positive on unexpected payload size
+ */
+int32_t WelsGetNalMaxEncodedSize (SWelsNalRaw* pRawNal) {
+  const bool kbNALExt = pRawNal->sNalExt.sNalHeader.eNalUnitType == NAL_UNIT_PREFIX
+                                        || pRawNal->sNalExt.sNalHeader.eNalUnitType == NAL_UNIT_CODED_SLICE_EXT;
+  int32_t iAssumedNeededLength		= NAL_HEADER_SIZE+(kbNALExt?3:0)+pRawNal->iPayloadSize+1;
+  if (iAssumedNeededLength <= 0)
+    return iAssumedNeededLength;
+
+  //since for each 0x000 need a 0x03, so the needed length will not exceed (iAssumeNeedLenth + iAssumeNeedLength/3), here adjust to >>1 to omit division
+  return iAssumedNeededLength + (iAssumedNeededLength>>1);
+}
+
+#if defined(NAL_ESCAPE_SSE2)
+/*!
+ * \brief	end of the run starting at pSrc that holds no 00 00 pair and ends with a non-zero byte,
+ *			checked 16 bytes at a time
+ */
+static inline uint8_t* SkipBlocksWithoutZeroPair_sse2 (uint8_t* pSrc, const uint8_t* kpSrcEnd) {
+  const __m128i kxZero = _mm_setzero_si128();
+
+  while (pSrc + 16 <= kpSrcEnd) {
+    const int32_t kiZeros = _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i*)pSrc), kxZero));
+    if (kiZeros & (kiZeros >> 1))
+      break;
+    // a zero in the last byte may start a pair with the next block
+    pSrc += (kiZeros & 0x8000) ? 15 : 16;
+  }
+  return pSrc;
+}
+#endif//NAL_ESCAPE_SSE2
+
 /*!
  * \brief	encode NAL with emulation forbidden three bytes checking
  * \param	pDst			pDst NAL pData
@@ -119,17 +160,15 @@ void WelsUnloadNalForSlice (SWelsSliceBs* pSliceBsIn) {
  * \return	ERRCODE
  */
 //TODO 1: refactor the calling of this func in multi-thread
-//TODO 2: complete the realloc&copy
 int32_t WelsEncodeNal (SWelsNalRaw* pRawNal, void* pNalHeaderExt, const int32_t kiDstBufferLen, void* pDst, int32_t* pDstLen) {
   const bool kbNALExt = pRawNal->sNalExt.sNalHeader.eNalUnitType == NAL_UNIT_PREFIX
                                         || pRawNal->sNalExt.sNalHeader.eNalUnitType == NAL_UNIT_CODED_SLICE_EXT;
-  int32_t iAssumedNeededLength		= NAL_HEADER_SIZE+(kbNALExt?3:0)+pRawNal->iPayloadSize+1;
-  WELS_VERIFY_RETURN_IF(ENC_RETURN_UNEXPECTED, (iAssumedNeededLength<=0))
+  const int32_t kiNeededLength		= WelsGetNalMaxEncodedSize (pRawNal);
+  WELS_VERIFY_RETURN_IF(ENC_RETURN_UNEXPECTED, (kiNeededLength<=0))
 
-  //since for each 0x000 need a 0x03, so the needed length will not exceed (iAssumeNeedLenth + iAssumeNeedLength/3), here adjust to >>1 to omit division
-  if (kiDstBufferLen < (iAssumedNeededLength + (iAssumedNeededLength>>1)) ) {
+  if (kiDstBufferLen < kiNeededLength) {
+    // WelsEncodeNalToFrameBs() and the slice bs writers of the threads grow their buffer before calling
     return ENC_RETURN_MEMALLOCERR;
-    //TODO: call the realloc&copy instead
   }
   uint8_t* pDstStart	    = (uint8_t*)pDst;
   uint8_t* pDstPointer	= pDstStart;
@@ -162,6 +201,23 @@ int32_t WelsEncodeNal (SWelsNalRaw* pRawNal, void* pNalHeaderExt, const int32_t
   }
 
   while (pSrcPointer < pSrcEnd) {
+    if (iZeroCount == 0) {
+      // a 03 is only ever inserted after two zero bytes, so runs without a zero pair are copied as they are
+#if defined(NAL_ESCAPE_SSE2)
+      uint8_t* pRunEnd = SkipBlocksWithoutZeroPair_sse2 (pSrcPointer, pSrcEnd);
+#else
+      uint8_t* pRunEnd = pSrcPointer;
+      while ((pRunEnd + 8 <= pSrcEnd) && WELS_NO_ZERO_BYTE_64 (LD64 (pRunEnd))) {
+        pRunEnd += 8;
+      }
+#endif//NAL_ESCAPE_SSE2
+      if (pRunEnd > pSrcPointer) {
+        memcpy (pDstPointer, pSrcPointer, pRunEnd - pSrcPointer);
+        pDstPointer += pRunEnd - pSrcPointer;
+        pSrcPointer = pRunEnd;
+        continue;
+      }
+    }
     if (iZeroCount == 2 && *pSrcPointer <= 3) {
       //add the code 03
       *pDstPointer++	= 3;
@@ -40,6 +40,17 @@
 #include "svc_motion_estimate.h"
 
 namespace WelsSVCEnc {
+/* planes within pBuffer, kiHeight lines (padding included) of luma */
+static void SetPictureData (SPicture* pPic, const int32_t kiHeight) {
+  const int32_t kiLumaSize		= pPic->iLineSize[0] * kiHeight;
+  const int32_t kiChromaSize	= pPic->iLineSize[1] * (kiHeight >> 1);
+
+  pPic->pData[0]	= pPic->pBuffer + (1 + pPic->iLineSize[0]) * PADDING_LENGTH;
+  pPic->pData[1]	= pPic->pBuffer + kiLumaSize + (((1 + pPic->iLineSize[1]) * PADDING_LENGTH) >> 1);
+  pPic->pData[2]	= pPic->pBuffer + kiLumaSize + kiChromaSize + (((1 + pPic->iLineSize[2]) * PADDING_LENGTH) >> 1);
+  pPic->bExternalData	= false;
+}
+
 /*!
  * \brief	alloc picture pData with borders for each plane based width and height of picture
  * \param	cx				width of picture in pixels
@@ -79,9 +90,7 @@ SPicture* AllocPicture (CMemoryAlign* pMa, const int32_t kiWidth , const int32_t
   WELS_VERIFY_RETURN_PROC_IF (NULL, NULL == pPic->pBuffer, FreePicture (pMa, &pPic));
   pPic->iLineSize[0]	= iPicWidth;
   pPic->iLineSize[1]	= pPic->iLineSize[2]	= iPicChromaWidth;
-  pPic->pData[0]	= pPic->pBuffer + (1 + pPic->iLineSize[0]) * PADDING_LENGTH;
-  pPic->pData[1]	= pPic->pBuffer + iLumaSize + (((1 + pPic->iLineSize[1]) * PADDING_LENGTH) >> 1);
-  pPic->pData[2]	= pPic->pBuffer + iLumaSize + iChromaSize + (((1 + pPic->iLineSize[2]) * PADDING_LENGTH) >> 1);
+  SetPictureData (pPic, iPicHeight);
 
   pPic->iWidthInPixel	= kiWidth;
   pPic->iHeightInPixel	= kiHeight;
@@ -193,5 +202,41 @@ void WelsExchangeSpatialPictures (SPicture** ppPic1, SPicture** ppPic2) {
   *ppPic2 = tmp;
 }
 
+/*!
+* \brief	exchange the sample buffers of two pictures of the same size, pictures keep their other members
+* \param	pPic1		picture 1
+* \param	pPic2		picture 2
+* \return	none
+*/
+void WelsExchangePictureData (SPicture* pPic1, SPicture* pPic2) {
+  uint8_t* pTmp	= pPic1->pBuffer;
+
+  assert (pPic1->iLineSize[0] == pPic2->iLineSize[0] && pPic1->iLineSize[1] == pPic2->iLineSize[1]);
+  assert (!pPic1->bExternalData && !pPic2->bExternalData);
+
+  pPic1->pBuffer	= pPic2->pBuffer;
+  pPic2->pBuffer	= pTmp;
+  for (int32_t i = 0; i < 3; i++) {
+    pTmp	= pPic1->pData[i];
+    pPic1->pData[i]	= pPic2->pData[i];
+    pPic2->pData[i]	= pTmp;
+  }
+}
+
+void WelsReferencePictureData (SPicture* pPic, uint8_t* pData[3]) {
+  for (int32_t i = 0; i < 3; i++)
+    pPic->pData[i]	= pData[i];
+  pPic->bExternalData	= true;
+}
+
+uint8_t* WelsUnreferencePictureData (SPicture* pPic) {
+  uint8_t* pExternal = pPic->pData[0];
+
+  if (!pPic->bExternalData)
+    return NULL;
+  SetPictureData (pPic, WELS_ALIGN (pPic->iHeightInPixel, MB_HEIGHT_LUMA) + (PADDING_LENGTH << 1));
+  return pExternal;
+}
+
 } // namespace WelsSVCEnc
 
@@ -580,7 +580,7 @@ SWelsSvcRc* RcJudgeBaseUsability (sWelsEncCtx* pEncCtx) {
   SWelsSvcRc* pWelsSvcRc  = NULL, *pWelsSvcRc_Base = NULL;
   SDLayerParam* pDlpBase = NULL, *pDLayerParam = NULL;
 
-  if (pEncCtx->uiDependencyId <= 0)
+  if (pEncCtx->uiDependencyId <= 0 || pEncCtx->pSvcParam->bParallelSpatialLayers)	// base layer not coded before
     return NULL;
 
   pDlpBase = &pEncCtx->pSvcParam->sDependencyLayers[pEncCtx->uiDependencyId - 1];
@@ -43,6 +43,10 @@
 
 #include "mc.h"
 #include "cpu_core.h"
+#include "macros.h"
+#if defined(X86_INTRINSICS)
+#include <immintrin.h>
+#endif//X86_INTRINSICS
 
 namespace WelsSVCEnc {
 int32_t WelsSampleSatd4x4_c (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2, int32_t iStride2) {
@@ -132,6 +136,103 @@ int32_t WelsSampleSatd16x16_c (uint8_t* pSample1, int32_t iStride1, uint8_t* pSa
   return iSatdSum;
 }
 
+#if defined(X86_INTRINSICS)
+// 4-point hadamard within every group of four words; output order and signs differ from the C
+// version, which does not matter once the absolute values are summed
+static inline WELS_TARGET_AVX2 __m256i HorizontalHadamard4_avx2 (const __m256i kRow) {
+  __m256i iSwap = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (kRow, 0xB1), 0xB1);
+  const __m256i kStage = _mm256_blend_epi16 (_mm256_add_epi16 (kRow, iSwap), _mm256_sub_epi16 (iSwap, kRow), 0xAA);
+  iSwap = _mm256_shuffle_epi32 (kStage, 0xB1);
+  return _mm256_blend_epi16 (_mm256_add_epi16 (kStage, iSwap), _mm256_sub_epi16 (iSwap, kStage), 0xCC);
+}
+
+// four rows of residual, 16 columns each: returns the rounded SATD of every 4x4 block, each one twice
+static inline WELS_TARGET_AVX2 __m256i Satd4x4Blocks_avx2 (const __m256i kDiff0, const __m256i kDiff1,
+    const __m256i kDiff2, const __m256i kDiff3) {
+  const __m256i kSum02 = _mm256_add_epi16 (kDiff0, kDiff2);
+  const __m256i kSum13 = _mm256_add_epi16 (kDiff1, kDiff3);
+  const __m256i kSub02 = _mm256_sub_epi16 (kDiff0, kDiff2);
+  const __m256i kSub13 = _mm256_sub_epi16 (kDiff1, kDiff3);
+  __m256i iAbsSum = _mm256_abs_epi16 (HorizontalHadamard4_avx2 (_mm256_add_epi16 (kSum02, kSum13)));
+  iAbsSum = _mm256_add_epi16 (iAbsSum, _mm256_abs_epi16 (HorizontalHadamard4_avx2 (_mm256_add_epi16 (kSub02, kSub13))));
+  iAbsSum = _mm256_add_epi16 (iAbsSum, _mm256_abs_epi16 (HorizontalHadamard4_avx2 (_mm256_sub_epi16 (kSub02, kSub13))));
+  iAbsSum = _mm256_add_epi16 (iAbsSum, _mm256_abs_epi16 (HorizontalHadamard4_avx2 (_mm256_sub_epi16 (kSum02, kSum13))));
+  __m256i iBlockSum = _mm256_madd_epi16 (iAbsSum, _mm256_set1_epi16 (1));
+  iBlockSum = _mm256_add_epi32 (iBlockSum, _mm256_shuffle_epi32 (iBlockSum, 0xB1));
+  return _mm256_srli_epi32 (_mm256_add_epi32 (iBlockSum, _mm256_set1_epi32 (1)), 1);
+}
+
+static inline WELS_TARGET_AVX2 __m256i LoadDiff16_avx2 (const uint8_t* pSample1, const uint8_t* pSample2) {
+  return _mm256_sub_epi16 (_mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i*)pSample1)),
+                           _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((const __m128i*)pSample2)));
+}
+
+// 8 columns of two rows kiRowDist apart, the second one going to the upper lane
+static inline WELS_TARGET_AVX2 __m256i LoadDiff8x2_avx2 (const uint8_t* pSample1, const int32_t kiRowDist1,
+    const uint8_t* pSample2, const int32_t kiRowDist2) {
+  const __m128i kRow1 = _mm_unpacklo_epi64 (_mm_loadl_epi64 ((const __m128i*)pSample1),
+                        _mm_loadl_epi64 ((const __m128i*) (pSample1 + kiRowDist1)));
+  const __m128i kRow2 = _mm_unpacklo_epi64 (_mm_loadl_epi64 ((const __m128i*)pSample2),
+                        _mm_loadl_epi64 ((const __m128i*) (pSample2 + kiRowDist2)));
+  return _mm256_sub_epi16 (_mm256_cvtepu8_epi16 (kRow1), _mm256_cvtepu8_epi16 (kRow2));
+}
+
+static inline WELS_TARGET_AVX2 int32_t SumSatd_avx2 (const __m256i kSatd) {
+  __m128i iSum = _mm_add_epi32 (_mm256_castsi256_si128 (kSatd), _mm256_extracti128_si256 (kSatd, 1));
+  iSum = _mm_add_epi32 (iSum, _mm_unpackhi_epi64 (iSum, iSum));
+  iSum = _mm_add_epi32 (iSum, _mm_shuffle_epi32 (iSum, 0xB1));
+  return _mm_cvtsi128_si32 (iSum) >> 1;
+}
+
+static inline WELS_TARGET_AVX2 int32_t SampleSatd16xN_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, const int32_t kiHeight) {
+  __m256i iSatd = _mm256_setzero_si256();
+  for (int32_t i = 0; i < kiHeight; i += 4) {
+    iSatd = _mm256_add_epi32 (iSatd, Satd4x4Blocks_avx2 (LoadDiff16_avx2 (pSample1, pSample2),
+                              LoadDiff16_avx2 (pSample1 + iStride1, pSample2 + iStride2),
+                              LoadDiff16_avx2 (pSample1 + (iStride1 << 1), pSample2 + (iStride2 << 1)),
+                              LoadDiff16_avx2 (pSample1 + 3 * iStride1, pSample2 + 3 * iStride2)));
+    pSample1 += iStride1 << 2;
+    pSample2 += iStride2 << 2;
+  }
+  return SumSatd_avx2 (iSatd);
+}
+
+// rows i and i+4 of an 8x8 block share one ymm
+static inline WELS_TARGET_AVX2 int32_t SampleSatd8xN_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2, const int32_t kiHeight) {
+  const int32_t kiRowDist1 = iStride1 << 2;
+  const int32_t kiRowDist2 = iStride2 << 2;
+  __m256i iSatd = _mm256_setzero_si256();
+  for (int32_t i = 0; i < kiHeight; i += 8) {
+    iSatd = _mm256_add_epi32 (iSatd, Satd4x4Blocks_avx2 (LoadDiff8x2_avx2 (pSample1, kiRowDist1, pSample2, kiRowDist2),
+                              LoadDiff8x2_avx2 (pSample1 + iStride1, kiRowDist1, pSample2 + iStride2, kiRowDist2),
+                              LoadDiff8x2_avx2 (pSample1 + (iStride1 << 1), kiRowDist1, pSample2 + (iStride2 << 1), kiRowDist2),
+                              LoadDiff8x2_avx2 (pSample1 + 3 * iStride1, kiRowDist1, pSample2 + 3 * iStride2, kiRowDist2)));
+    pSample1 += iStride1 << 3;
+    pSample2 += iStride2 << 3;
+  }
+  return SumSatd_avx2 (iSatd);
+}
+
+WELS_TARGET_AVX2 int32_t WelsSampleSatd16x16_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2) {
+  return SampleSatd16xN_avx2 (pSample1, iStride1, pSample2, iStride2, 16);
+}
+WELS_TARGET_AVX2 int32_t WelsSampleSatd16x8_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2) {
+  return SampleSatd16xN_avx2 (pSample1, iStride1, pSample2, iStride2, 8);
+}
+WELS_TARGET_AVX2 int32_t WelsSampleSatd8x16_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2) {
+  return SampleSatd8xN_avx2 (pSample1, iStride1, pSample2, iStride2, 16);
+}
+WELS_TARGET_AVX2 int32_t WelsSampleSatd8x8_avx2 (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2,
+    int32_t iStride2) {
+  return SampleSatd8xN_avx2 (pSample1, iStride1, pSample2, iStride2, 8);
+}
+#endif//X86_INTRINSICS
+
 
 extern void WelsI4x4LumaPredDc_c (uint8_t* pPred, uint8_t* pRef, const int32_t iStride);
 extern void WelsI4x4LumaPredH_c (uint8_t* pPred, uint8_t* pRef, const int32_t iStride);
@@ -383,9 +484,27 @@ void WelsInitSampleSadFunc (SWelsFuncPtrList* pFuncList, uint32_t uiCpuFlag) {
     //pFuncList->sSampleDealingFuncs.pfIntra16x16Combined3Satd = WelsIntra16x16Combined3Satd_sse41;
     //pFuncList->sSampleDealingFuncs.pfIntra8x8Combined3Satd = WelsIntraChroma8x8Combined3Satd_sse41;
   }
-
 #endif //(X86_ASM)
 
+#if defined(X86_INTRINSICS)
+  if (uiCpuFlag & WELS_CPU_AVX2) {
+    pFuncList->sSampleDealingFuncs.pfSampleSad[BLOCK_16x16] = WelsSampleSad16x16_avx2;
+    pFuncList->sSampleDealingFuncs.pfSampleSad[BLOCK_16x8 ] = WelsSampleSad16x8_avx2;
+    pFuncList->sSampleDealingFuncs.pfSampleSad[BLOCK_8x16] = WelsSampleSad8x16_avx2;
+    pFuncList->sSampleDealingFuncs.pfSampleSad[BLOCK_8x8] = WelsSampleSad8x8_avx2;
+
+    pFuncList->sSampleDealingFuncs.pfSample4Sad[BLOCK_16x16] = WelsSampleSadFour16x16_avx2;
+    pFuncList->sSampleDealingFuncs.pfSample4Sad[BLOCK_16x8] = WelsSampleSadFour16x8_avx2;
+    pFuncList->sSampleDealingFuncs.pfSample4Sad[BLOCK_8x16] = WelsSampleSadFour8x16_avx2;
+    pFuncList->sSampleDealingFuncs.pfSample4Sad[BLOCK_8x8] = WelsSampleSadFour8x8_avx2;
+
+    pFuncList->sSampleDealingFuncs.pfSampleSatd[BLOCK_16x16] = WelsSampleSatd16x16_avx2;
+    pFuncList->sSampleDealingFuncs.pfSampleSatd[BLOCK_16x8] = WelsSampleSatd16x8_avx2;
+    pFuncList->sSampleDealingFuncs.pfSampleSatd[BLOCK_8x16] = WelsSampleSatd8x16_avx2;
+    pFuncList->sSampleDealingFuncs.pfSampleSatd[BLOCK_8x8] = WelsSampleSatd8x8_avx2;
+  }
+#endif //(X86_INTRINSICS)
+
 #if defined (HAVE_NEON)
   if (uiCpuFlag & WELS_CPU_NEON) {
     pFuncList->sSampleDealingFuncs.pfSampleSad[BLOCK_4x4  ] = WelsSampleSad4x4_neon;
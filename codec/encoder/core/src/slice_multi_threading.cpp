@@ -40,14 +40,6 @@
 
 
 #include <assert.h>
-#if !defined(_WIN32)
-#include <semaphore.h>
-#include <unistd.h>
-#endif//!_WIN32
-#ifndef SEM_NAME_MAX
-// length of semaphore name should be system constrained at least on mac 10.7
-#define  SEM_NAME_MAX 32
-#endif//SEM_NAME_MAX
 #include "slice_multi_threading.h"
 #include "mt_defs.h"
 #include "nal_encap.h"
@@ -268,15 +260,15 @@ void DynamicAdjustSlicing (sWelsEncCtx* pCtx,
 
 
   if (DynamicAdjustSlicePEncCtxAll (pSliceCtx, iRunLen) == 0) {
-    const int32_t kiThreadNum	= pCtx->pSvcParam->iCountThreadsNum;
-    int32_t iThreadIdx			= 0;
+    SSliceThreading* pSmt	= pCtx->pSliceThreading;
+    iSliceIdx				= 0;
     do {
-      WelsEventSignal (&pCtx->pSliceThreading->pUpdateMbListEvent[iThreadIdx]);
-      WelsEventSignal (&pCtx->pSliceThreading->pThreadMasterEvent[iThreadIdx]);
-      ++ iThreadIdx;
-    } while (iThreadIdx < kiThreadNum);
+      pSmt->pThreadPEncCtx[iSliceIdx].iSliceIndex	= iSliceIdx;
+      WelsThreadPoolSubmit (pSmt->pThreadPool, &pSmt->sSliceTasks, UpdateMbListTask, &pSmt->pThreadPEncCtx[iSliceIdx]);
+      ++ iSliceIdx;
+    } while (iSliceIdx < kiCountSliceNum);
 
-    WelsMultipleEventsWaitAllBlocking (kiThreadNum, &pCtx->pSliceThreading->pFinUpdateMbListEvent[0]);
+    WelsThreadPoolWait (pSmt->pThreadPool, &pSmt->sSliceTasks);
   }
 }
 
@@ -287,12 +279,13 @@ int32_t RequestMtResource (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPara
   SWelsSvcCodingParam* pPara = NULL;
   SSliceThreading* pSmt		= NULL;
   SWelsSliceBs* pSliceB		= NULL;
-  uint8_t* pBsBase			= NULL;
   int32_t iNumSpatialLayers	= 0;
   int32_t iThreadNum			= 0;
+  int32_t iTaskNum				= 0;
   int32_t iIdx					= 0;
   int32_t iSliceBsBufferSize = 0;
   int16_t iMaxSliceNum		= 1;
+  int32_t iMaxMbHeight		= 0;
   int32_t iReturn = ENC_RETURN_SUCCESS;
 
   if (NULL == ppCtx || NULL == pCodingParam || NULL == *ppCtx || iCountBsLen <= 0)
@@ -304,20 +297,15 @@ int32_t RequestMtResource (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPara
   iThreadNum	= pPara->iCountThreadsNum;
   iMaxSliceNum = (*ppCtx)->iMaxSliceCount;
 
-  pSmt	= (SSliceThreading*)pMa->WelsMalloc (sizeof (SSliceThreading), "SSliceThreading");
+  pSmt	= (SSliceThreading*)pMa->WelsMallocz (sizeof (SSliceThreading), "SSliceThreading");
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pSmt), FreeMemorySvc (ppCtx))
   (*ppCtx)->pSliceThreading	= pSmt;
-  pSmt->pThreadPEncCtx	= (SSliceThreadPrivateData*)pMa->WelsMalloc (sizeof (SSliceThreadPrivateData) * iThreadNum,
+  // one task per slice, or per picture partition in dynamic slicing mode
+  iTaskNum	= WELS_MAX (iThreadNum, iMaxSliceNum);
+  pSmt->pThreadPEncCtx	= (SSliceThreadPrivateData*)pMa->WelsMalloc (sizeof (SSliceThreadPrivateData) * iTaskNum,
                           "pThreadPEncCtx");
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pSmt->pThreadPEncCtx), FreeMemorySvc (ppCtx))
 
-#ifdef _WIN32
-  // Dummy event namespace, the windows events don't actually use this
-  WelsSnprintf (pSmt->eventNamespace, sizeof(pSmt->eventNamespace), "%p", (void*) *ppCtx);
-#else
-  WelsSnprintf (pSmt->eventNamespace, sizeof(pSmt->eventNamespace), "%p%x", (void*) *ppCtx, getpid());
-#endif//!_WIN32
-
   iIdx = 0;
   while (iIdx < iNumSpatialLayers) {
     SSliceConfig* pMso	= &pPara->sDependencyLayers[iIdx].sSliceCfg;
@@ -332,6 +320,7 @@ int32_t RequestMtResource (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPara
       pSmt->pSliceConsumeTime[iIdx]	= NULL;
       pSmt->pSliceComplexRatio[iIdx]	= NULL;
     }
+    iMaxMbHeight	= WELS_MAX (iMaxMbHeight, (pPara->sDependencyLayers[iIdx].iFrameHeight + 15) >> 4);
     ++ iIdx;
   }
   // NULL for pSliceConsumeTime[iIdx]: iIdx from iNumSpatialLayers to MAX_DEPENDENCY_LAYERS
@@ -349,48 +338,21 @@ int32_t RequestMtResource (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPara
 
   MT_TRACE_LOG (*ppCtx, WELS_LOG_INFO, "encpEncCtx= 0x%p\n", (void*) *ppCtx);
 
-  char name[SEM_NAME_MAX] = {0};
-  WELS_GCC_UNUSED WELS_THREAD_ERROR_CODE err = 0;
-
   iIdx = 0;
-  while (iIdx < iThreadNum) {
+  while (iIdx < iTaskNum) {
     pSmt->pThreadPEncCtx[iIdx].pWelsPEncCtx	= (void*) *ppCtx;
     pSmt->pThreadPEncCtx[iIdx].iSliceIndex	= iIdx;
-    pSmt->pThreadPEncCtx[iIdx].iThreadIndex	= iIdx;
-    pSmt->pThreadHandles[iIdx]				= 0;
-
-    WelsSnprintf (name, SEM_NAME_MAX, "ee%d%s", iIdx, pSmt->eventNamespace);
-    err = WelsEventOpen (&pSmt->pExitEncodeEvent[iIdx], name);
-    MT_TRACE_LOG (*ppCtx, WELS_LOG_INFO, "[MT] Open pExitEncodeEvent%d named(%s) ret%d err%d\n", iIdx, name, err, errno);
-    WelsSnprintf (name, SEM_NAME_MAX, "tm%d%s", iIdx, pSmt->eventNamespace);
-    err = WelsEventOpen (&pSmt->pThreadMasterEvent[iIdx], name);
-    MT_TRACE_LOG (*ppCtx, WELS_LOG_INFO, "[MT] Open pThreadMasterEvent%d named(%s) ret%d err%d\n", iIdx, name, err, errno);
-    // length of semaphore name should be system constrained at least on mac 10.7
-    WelsSnprintf (name, SEM_NAME_MAX, "ud%d%s", iIdx, pSmt->eventNamespace);
-    err = WelsEventOpen (&pSmt->pUpdateMbListEvent[iIdx], name);
-    MT_TRACE_LOG (*ppCtx, WELS_LOG_INFO, "[MT] Open pUpdateMbListEvent%d named(%s) ret%d err%d\n", iIdx, name, err, errno);
-    WelsSnprintf (name, SEM_NAME_MAX, "fu%d%s", iIdx, pSmt->eventNamespace);
-    err = WelsEventOpen (&pSmt->pFinUpdateMbListEvent[iIdx], name);
-    MT_TRACE_LOG (*ppCtx, WELS_LOG_INFO, "[MT] Open pFinUpdateMbListEvent%d named(%s) ret%d err%d\n", iIdx, name, err, errno);
-    WelsSnprintf (name, SEM_NAME_MAX, "sc%d%s", iIdx, pSmt->eventNamespace);
-    err = WelsEventOpen (&pSmt->pSliceCodedEvent[iIdx], name);
-    MT_TRACE_LOG (*ppCtx, WELS_LOG_INFO, "[MT] Open pSliceCodedEvent%d named(%s) ret%d err%d\n", iIdx, name, err, errno);
-    WelsSnprintf (name, SEM_NAME_MAX, "rc%d%s", iIdx, pSmt->eventNamespace);
-    err = WelsEventOpen (&pSmt->pReadySliceCodingEvent[iIdx], name);
-    MT_TRACE_LOG (*ppCtx, WELS_LOG_INFO, "[MT] Open pReadySliceCodingEvent%d = 0x%p named(%s) ret%d err%d\n", iIdx,
-                  (void*)pSmt->pReadySliceCodingEvent[iIdx], name, err, errno);
-
     ++ iIdx;
   }
 
-  WelsSnprintf (name, SEM_NAME_MAX, "scm%s", pSmt->eventNamespace);
-  err = WelsEventOpen (&pSmt->pSliceCodedMasterEvent, name);
-  MT_TRACE_LOG (*ppCtx, WELS_LOG_INFO, "[MT] Open pSliceCodedMasterEvent named(%s) ret%d err%d\n", name, err, errno);
+  // the calling thread takes part in coding the slices while waiting for them
+  pSmt->pThreadPool	= WelsThreadPoolAcquire (iThreadNum - 1);
+  WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pSmt->pThreadPool), FreeMemorySvc (ppCtx))
+  pSmt->sSliceTasks.iPending	= 0;
 
   (*ppCtx)->pSliceBs	= (SWelsSliceBs*)pMa->WelsMalloc (sizeof (SWelsSliceBs) * iMaxSliceNum, "pSliceBs");
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == (*ppCtx)->pSliceBs), FreeMemorySvc (ppCtx))
 
-  pBsBase		= (*ppCtx)->pFrameBs + iCountBsLen;
   pSliceB	= (*ppCtx)->pSliceBs;
   iSliceBsBufferSize	= iTargetSpatialBsSize;
   iIdx = 0;
@@ -401,11 +363,13 @@ int32_t RequestMtResource (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPara
     pSliceB->uiSize	= iSliceBsBufferSize;
 
     if (iIdx > 0) {
-      pSliceB->pBs		= pBsBase;
+      pSliceB->pBs		= (uint8_t*)pMa->WelsMalloc (iSliceBsBufferSize, "pSliceB->pBs");
+      WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pSliceB->pBs), FreeMemorySvc (ppCtx))
+      pSliceB->uiBsSize	= iSliceBsBufferSize;
       pSliceB->uiBsPos	= 0;
-      pBsBase				+= iSliceBsBufferSize;
-    } else {
+    } else {	// slice 0 is written into pFrameBs directly
       pSliceB->pBs		= NULL;
+      pSliceB->uiBsSize	= 0;
       pSliceB->uiBsPos	= 0;
     }
     ++ pSliceB;
@@ -415,6 +379,13 @@ int32_t RequestMtResource (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPara
   iReturn = WelsMutexInit (&pSmt->mutexSliceNumUpdate);
   WELS_VERIFY_RETURN_PROC_IF (1, (WELS_THREAD_ERROR_OK != iReturn), FreeMemorySvc (ppCtx))
 
+  pSmt->pDeblockedMbNum	= (int32_t*)pMa->WelsMalloc (iMaxMbHeight * sizeof (int32_t), "pDeblockedMbNum");
+  WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pSmt->pDeblockedMbNum), FreeMemorySvc (ppCtx))
+  iReturn = WelsMutexInit (&pSmt->mutexDeblocking);
+  WELS_VERIFY_RETURN_PROC_IF (1, (WELS_THREAD_ERROR_OK != iReturn), FreeMemorySvc (ppCtx))
+  iReturn = WelsCondInit (&pSmt->condDeblocking);
+  WELS_VERIFY_RETURN_PROC_IF (1, (WELS_THREAD_ERROR_OK != iReturn), FreeMemorySvc (ppCtx))
+
   iReturn = WelsMutexInit (&(*ppCtx)->mutexEncoderError);
   WELS_VERIFY_RETURN_PROC_IF (1, (WELS_THREAD_ERROR_OK != iReturn), FreeMemorySvc (ppCtx))
 
@@ -430,7 +401,6 @@ void ReleaseMtResource (sWelsEncCtx** ppCtx) {
   SSliceThreading* pSmt			= NULL;
   CMemoryAlign* pMa				= NULL;
   int32_t iIdx						= 0;
-  int32_t iThreadNum				= 0;
   int16_t uiSliceNum				= 0;
 
   if (NULL == ppCtx || NULL == *ppCtx)
@@ -439,35 +409,23 @@ void ReleaseMtResource (sWelsEncCtx** ppCtx) {
   pMa			= (*ppCtx)->pMemAlign;
   pCodingParam		= (*ppCtx)->pSvcParam;
   uiSliceNum	= (*ppCtx)->iMaxSliceCount;
-  iThreadNum	= (*ppCtx)->pSvcParam->iCountThreadsNum;
   pSmt		= (*ppCtx)->pSliceThreading;
 
   if (NULL == pSmt)
     return;
 
-  char ename[SEM_NAME_MAX] = {0};
-  while (iIdx < iThreadNum) {
-    // length of semaphore name should be system constrained at least on mac 10.7
-    WelsSnprintf (ename, SEM_NAME_MAX, "ee%d%s", iIdx, pSmt->eventNamespace);
-    WelsEventClose (&pSmt->pExitEncodeEvent[iIdx], ename);
-    WelsSnprintf (ename, SEM_NAME_MAX, "tm%d%s", iIdx, pSmt->eventNamespace);
-    WelsEventClose (&pSmt->pThreadMasterEvent[iIdx], ename);
-    WelsSnprintf (ename, SEM_NAME_MAX, "sc%d%s", iIdx, pSmt->eventNamespace);
-    WelsEventClose (&pSmt->pSliceCodedEvent[iIdx], ename);
-    WelsSnprintf (ename, SEM_NAME_MAX, "rc%d%s", iIdx, pSmt->eventNamespace);
-    WelsEventClose (&pSmt->pReadySliceCodingEvent[iIdx], ename);
-    WelsSnprintf (ename, SEM_NAME_MAX, "ud%d%s", iIdx, pSmt->eventNamespace);
-    WelsEventClose (&pSmt->pUpdateMbListEvent[iIdx], ename);
-    WelsSnprintf (ename, SEM_NAME_MAX, "fu%d%s", iIdx, pSmt->eventNamespace);
-    WelsEventClose (&pSmt->pFinUpdateMbListEvent[iIdx], ename);
-
-    ++ iIdx;
-  }
-  WelsSnprintf (ename, SEM_NAME_MAX, "scm%s", pSmt->eventNamespace);
-  WelsEventClose (&pSmt->pSliceCodedMasterEvent, ename);
+  WelsThreadPoolRelease (pSmt->pThreadPool);
+  pSmt->pThreadPool = NULL;
 
   WelsMutexDestroy (&pSmt->mutexSliceNumUpdate);
   WelsMutexDestroy (&((*ppCtx)->mutexEncoderError));
+  WelsMutexDestroy (&pSmt->mutexDeblocking);
+  WelsCondDestroy (&pSmt->condDeblocking);
+
+  if (pSmt->pDeblockedMbNum != NULL) {
+    pMa->WelsFree (pSmt->pDeblockedMbNum, "pDeblockedMbNum");
+    pSmt->pDeblockedMbNum = NULL;
+  }
 
   if (pSmt->pThreadPEncCtx != NULL) {
     pMa->WelsFree (pSmt->pThreadPEncCtx, "pThreadPEncCtx");
@@ -482,6 +440,11 @@ void ReleaseMtResource (sWelsEncCtx** ppCtx) {
       pSliceB->pBsBuffer = NULL;
       pSliceB->uiSize = 0;
     }
+    if (pSliceB->pBs) {
+      pMa->WelsFree (pSliceB->pBs, "pSliceB->pBs");
+      pSliceB->pBs = NULL;
+      pSliceB->uiBsSize = 0;
+    }
     ++ iIdx;
     ++ pSliceB;
   }
@@ -522,6 +485,23 @@ int32_t AppendSliceToFrameBs (sWelsEncCtx* pCtx, SLayerBSInfo* pLbi, const int32
   int32_t iLayerSize					= 0;
   int32_t iNalIdxBase				= pLbi->iNalCount;
   int32_t iSliceIdx					= 0;
+  int32_t iAppendLen				= 0;
+
+  // pFrameBs is not touched by the slice threads any more, enlarge it once for all slices to append
+  if (!kbIsDynamicSlicingMode) {
+    for (iSliceIdx = 1; iSliceIdx < iSliceCount; ++ iSliceIdx)
+      iAppendLen += pCtx->pSliceBs[iSliceIdx].uiBsPos;
+  } else {	// partition 0 has been written to pFrameBs
+    for (int32_t iPartitionIdx = 1; iPartitionIdx < iSliceCount; ++ iPartitionIdx) {
+      const int32_t kiCountSlicesCoded = pCtx->pCurDqLayer->pNumSliceCodedOfPartition[iPartitionIdx];
+      for (int32_t iIdx = 0; iIdx < kiCountSlicesCoded; ++ iIdx)
+        iAppendLen += pCtx->pSliceBs[iPartitionIdx + iIdx * iSliceCount].uiBsPos;
+    }
+  }
+  if (pCtx->iFrameBsSize - pCtx->iPosBsBuffer < iAppendLen) {
+    pCtx->iEncoderError = GrowFrameBs (pCtx, iAppendLen);
+    WELS_VERIFY_RETURN_IFNEQ (pCtx->iEncoderError, ENC_RETURN_SUCCESS)
+  }
 
   if (!kbIsDynamicSlicingMode) {
     pSliceBs	= &pCtx->pSliceBs[0];
@@ -595,22 +575,33 @@ int32_t AppendSliceToFrameBs (sWelsEncCtx* pCtx, SLayerBSInfo* pLbi, const int32
   return iLayerSize;
 }
 
-int32_t WriteSliceToFrameBs (sWelsEncCtx* pCtx, SLayerBSInfo* pLbi, uint8_t* pFrameBsBuffer, const int32_t iSliceIdx, int32_t& iSliceSize) {
+int32_t WriteSliceToFrameBs (sWelsEncCtx* pCtx, SLayerBSInfo* pLbi, const int32_t iSliceIdx, int32_t& iSliceSize) {
   SWelsSliceBs* pSliceBs			= &pCtx->pSliceBs[iSliceIdx];
   SNalUnitHeaderExt* pNalHdrExt = &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt;
-  uint8_t* pDst					= pFrameBsBuffer;
+  uint8_t* pDst					= NULL;
   const int32_t kiNalCnt			= pSliceBs->iNalIndex;
   int32_t iNalIdx					= 0;
   int32_t iNalSize = 0;
   const int32_t iFirstSlice		= (iSliceIdx == 0);
   int32_t iNalBase				= iFirstSlice ? 0 : pLbi->iNalCount;
   int32_t iReturn = ENC_RETURN_SUCCESS;
-  const int32_t kiWrittenLength = pCtx->iPosBsBuffer;
+  int32_t iNeededLen				= 0;
   iSliceSize				= 0;
 
+  // only the thread writing slice 0 (partition 0 in dynamic slicing) touches pFrameBs while slices are coded
+  for (iNalIdx = 0; iNalIdx < kiNalCnt; ++ iNalIdx)
+    iNeededLen += WelsGetNalMaxEncodedSize (&pSliceBs->sNalList[iNalIdx]);
+  if (pCtx->iFrameBsSize - pCtx->iPosBsBuffer < iNeededLen) {
+    iReturn = GrowFrameBs (pCtx, iNeededLen);
+    WELS_VERIFY_RETURN_IFNEQ (iReturn, ENC_RETURN_SUCCESS)
+  }
+  pDst = pCtx->pFrameBs + pCtx->iPosBsBuffer;
+
+  iNalIdx = 0;
   while (iNalIdx < kiNalCnt) {
     iNalSize = 0;
-    iReturn = WelsEncodeNal (&pSliceBs->sNalList[iNalIdx], pNalHdrExt, pCtx->iFrameBsSize-kiWrittenLength-iSliceSize, pDst, &iNalSize);
+    iReturn = WelsEncodeNal (&pSliceBs->sNalList[iNalIdx], pNalHdrExt, pCtx->iFrameBsSize - pCtx->iPosBsBuffer - iSliceSize,
+                             pDst, &iNalSize);
     WELS_VERIFY_RETURN_IFNEQ(iReturn, ENC_RETURN_SUCCESS)
     iSliceSize += iNalSize;
     pDst += iNalSize;
@@ -635,25 +626,40 @@ int32_t WriteSliceToFrameBs (sWelsEncCtx* pCtx, SLayerBSInfo* pLbi, uint8_t* pFr
   return ENC_RETURN_SUCCESS;
 }
 
-int32_t WriteSliceBs (sWelsEncCtx* pCtx, uint8_t* pSliceBsBuf, const int32_t iSliceIdx, int32_t& iSliceSize) {
+int32_t WriteSliceBs (sWelsEncCtx* pCtx, const int32_t iSliceIdx, int32_t& iSliceSize) {
   SWelsSliceBs* pSliceBs			= &pCtx->pSliceBs[iSliceIdx];
   SNalUnitHeaderExt* pNalHdrExt = &pCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt;
-  uint8_t* pDst					= pSliceBsBuf;
+  uint8_t* pDst					= NULL;
   int32_t* pNalLen				= &pSliceBs->iNalLen[0];
   const int32_t kiNalCnt			= pSliceBs->iNalIndex;
   int32_t iNalIdx					= 0;
   int32_t iNalSize					= 0;
   int32_t iReturn = ENC_RETURN_SUCCESS;
-  const int32_t kiWrittenLength = pSliceBs->sBsWrite.pBufPtr - pSliceBs->sBsWrite.pBuf;
+  int32_t iNeededLen				= 0;
 
   iSliceSize				= 0;
   assert (kiNalCnt <= 2);
   if (kiNalCnt > 2)
     return 0;
 
+  // pBs holds nothing to keep at this point, so a fresh allocation replaces it when too small
+  for (iNalIdx = 0; iNalIdx < kiNalCnt; ++ iNalIdx)
+    iNeededLen += WelsGetNalMaxEncodedSize (&pSliceBs->sNalList[iNalIdx]);
+  if ((int32_t)pSliceBs->uiBsSize < iNeededLen) {
+    CMemoryAlign* pMa	= pCtx->pMemAlign;
+    const int32_t kiNewSize	= WELS_ALIGN (iNeededLen, 4);
+
+    pMa->WelsFree (pSliceBs->pBs, "pSliceB->pBs");
+    pSliceBs->pBs		= (uint8_t*)pMa->WelsMalloc (kiNewSize, "pSliceB->pBs");
+    pSliceBs->uiBsSize	= (NULL == pSliceBs->pBs) ? 0 : kiNewSize;
+    WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, (NULL == pSliceBs->pBs))
+  }
+  pDst = pSliceBs->pBs;
+
+  iNalIdx = 0;
   while (iNalIdx < kiNalCnt) {
     iNalSize = 0;
-    iReturn = WelsEncodeNal (&pSliceBs->sNalList[iNalIdx], pNalHdrExt, pSliceBs->uiSize-kiWrittenLength-iSliceSize, pDst, &iNalSize);
+    iReturn = WelsEncodeNal (&pSliceBs->sNalList[iNalIdx], pNalHdrExt, pSliceBs->uiBsSize - iSliceSize, pDst, &iNalSize);
     WELS_VERIFY_RETURN_IFNEQ(iReturn, ENC_RETURN_SUCCESS)
     pNalLen[iNalIdx] = iNalSize;
     iSliceSize += iNalSize;
@@ -665,78 +671,165 @@ int32_t WriteSliceBs (sWelsEncCtx* pCtx, uint8_t* pSliceBsBuf, const int32_t iSl
   return iReturn;
 }
 
-// thread process for coding one pSlice
-WELS_THREAD_ROUTINE_TYPE CodingSliceThreadProc (void* arg) {
-  SSliceThreadPrivateData* pPrivateData	= (SSliceThreadPrivateData*)arg;
-  sWelsEncCtx* pEncPEncCtx			= NULL;
+void UpdateMbListTask (void* pArg) {
+  SSliceThreadPrivateData* pPrivateData	= (SSliceThreadPrivateData*)pArg;
+  sWelsEncCtx* pEncPEncCtx			= (sWelsEncCtx*)pPrivateData->pWelsPEncCtx;
+  SDqLayer* pCurDq							= pEncPEncCtx->pCurDqLayer;
+
+  UpdateMbListNeighborParallel (pCurDq->pSliceEncCtx, pCurDq->sMbDataP, pPrivateData->iSliceIndex);
+}
+
+// task coding one pSlice, or the slices of one picture partition in dynamic slicing mode
+void CodingSliceTask (void* pArg) {
+  SSliceThreadPrivateData* pPrivateData	= (SSliceThreadPrivateData*)pArg;
+  sWelsEncCtx* pEncPEncCtx			= (sWelsEncCtx*)pPrivateData->pWelsPEncCtx;
   SDqLayer* pCurDq							= NULL;
   SSlice* pSlice								= NULL;
   SWelsSliceBs* pSliceBs						= NULL;
-  WELS_EVENT pEventsList[3];
-  int32_t iEventCount						= 0;
-  WELS_THREAD_ERROR_CODE iWaitRet				= WELS_THREAD_ERROR_GENERAL;
   uint32_t uiThrdRet							= 0;
   int32_t iSliceSize							= 0;
   int32_t iSliceIdx							= -1;
-  int32_t iThreadIdx							= -1;
-  int32_t iEventIdx							= -1;
   bool bNeedPrefix							= false;
   EWelsNalUnitType eNalType						= NAL_UNIT_UNSPEC_0;
   EWelsNalRefIdc eNalRefIdc						= NRI_PRI_LOWEST;
   int32_t iReturn = ENC_RETURN_SUCCESS;
 
-  if (NULL == pPrivateData)
-    WELS_THREAD_ROUTINE_RETURN (1);
+  do {
+    SLayerBSInfo* pLbi = pPrivateData->pLayerBs;
+    const int32_t kiCurDid			= pEncPEncCtx->uiDependencyId;
+    const int32_t kiCurTid			= pEncPEncCtx->uiTemporalId;
+    SWelsSvcCodingParam* pCodingParam	= pEncPEncCtx->pSvcParam;
+    SDLayerParam* pParamD			= &pCodingParam->sDependencyLayers[kiCurDid];
+
+    pCurDq			= pEncPEncCtx->pCurDqLayer;
+    eNalType		= pEncPEncCtx->eNalType;
+    eNalRefIdc		= pEncPEncCtx->eNalPriority;
+    bNeedPrefix		= pEncPEncCtx->bNeedPrefixNalFlag;
+
+    if (pParamD->sSliceCfg.uiSliceMode != SM_DYN_SLICE) {
+      int64_t iSliceStart	= 0;
+      bool bDsaFlag = false;
+      iSliceIdx		= pPrivateData->iSliceIndex;
+      pSlice			= &pCurDq->sLayerInfo.pSliceInLayer[iSliceIdx];
+      pSliceBs		= &pEncPEncCtx->pSliceBs[iSliceIdx];
+
+      bDsaFlag	= (((pParamD->sSliceCfg.uiSliceMode == SM_FIXEDSLCNUM_SLICE)||(pParamD->sSliceCfg.uiSliceMode == SM_AUTO_SLICE)) &&
+                   pCodingParam->iMultipleThreadIdc > 1 &&
+                   pCodingParam->iMultipleThreadIdc >= pParamD->sSliceCfg.sSliceArgument.uiSliceNum);
+      if (bDsaFlag)
+        iSliceStart = WelsTime();
+
+      pSliceBs->uiBsPos	= 0;
+      pSliceBs->iNalIndex	= 0;
+      assert ((void*) (&pSliceBs->sBsWrite) == (void*)pSlice->pSliceBsa);
+      InitBits (&pSliceBs->sBsWrite, pSliceBs->pBsBuffer, pSliceBs->uiSize);
+
+#if MT_DEBUG_BS_WR
+      pSliceBs->bSliceCodedFlag	= false;
+#endif//MT_DEBUG_BS_WR
+
+      if (bNeedPrefix) {
+        if (eNalRefIdc != NRI_PRI_LOWEST) {
+          WelsLoadNalForSlice (pSliceBs, NAL_UNIT_PREFIX, eNalRefIdc);
+          WelsWriteSVCPrefixNal (&pSliceBs->sBsWrite, eNalRefIdc, (NAL_UNIT_CODED_SLICE_IDR == eNalType));
+          WelsUnloadNalForSlice (pSliceBs);
+        } else { // No Prefix NAL Unit RBSP syntax here, but need add NAL Unit Header extension
+          WelsLoadNalForSlice (pSliceBs, NAL_UNIT_PREFIX, eNalRefIdc);
+          // No need write any syntax of prefix NAL Unit RBSP here
+          WelsUnloadNalForSlice (pSliceBs);
+        }
+      }
 
-  pEncPEncCtx	= (sWelsEncCtx*)pPrivateData->pWelsPEncCtx;
+      WelsLoadNalForSlice (pSliceBs, eNalType, eNalRefIdc);
 
-  iThreadIdx		= pPrivateData->iThreadIndex;
-  iEventIdx		= iThreadIdx;
+      iReturn = WelsCodeOneSlice (pEncPEncCtx, iSliceIdx, eNalType);
+      if (ENC_RETURN_SUCCESS!=iReturn) {
+        uiThrdRet = iReturn;
+        break;
+      }
 
-  pEventsList[iEventCount++]	= pEncPEncCtx->pSliceThreading->pReadySliceCodingEvent[iEventIdx];
-  pEventsList[iEventCount++]	= pEncPEncCtx->pSliceThreading->pExitEncodeEvent[iEventIdx];
-  pEventsList[iEventCount++] = pEncPEncCtx->pSliceThreading->pUpdateMbListEvent[iEventIdx];
+      WelsUnloadNalForSlice (pSliceBs);
+
+      if (0 == iSliceIdx) {
+        pLbi->pBsBuf	= pEncPEncCtx->pFrameBs + pEncPEncCtx->iPosBsBuffer;	// relocated by GrowFrameBs() if any
+        iReturn = WriteSliceToFrameBs (pEncPEncCtx, pLbi, iSliceIdx, iSliceSize);
+        if (ENC_RETURN_SUCCESS!=iReturn) {
+          uiThrdRet = iReturn;
+          break;
+        }
+        pEncPEncCtx->iPosBsBuffer += iSliceSize;
+      } else
+      {
+        iReturn = WriteSliceBs (pEncPEncCtx, iSliceIdx, iSliceSize);
+        if (ENC_RETURN_SUCCESS!=iReturn) {
+          uiThrdRet = iReturn;
+          break;
+        }
+      }
+
+      if (pCurDq->bDeblockingParallelFlag && pSlice->sSliceHeaderExt.sSliceHeader.uiDisableDeblockingFilterIdc != 1
+#if !defined(ENABLE_FRAME_DUMP)
+          && (eNalRefIdc != NRI_PRI_LOWEST) &&
+          (pParamD->iHighestTemporalId == 0 || kiCurTid < pParamD->iHighestTemporalId)
+#endif// !ENABLE_FRAME_DUMP
+         ) {
+        DeblockingFilterSliceAvcbase (pCurDq, pEncPEncCtx->pFuncList, iSliceIdx);
+      }
+
+      if (bDsaFlag) {
+        pEncPEncCtx->pSliceThreading->pSliceConsumeTime[pEncPEncCtx->uiDependencyId][iSliceIdx] = (uint32_t) (
+              WelsTime() - iSliceStart);
+        MT_TRACE_LOG (pEncPEncCtx, WELS_LOG_INFO,
+                      "[MT] CodingSliceTask(), coding_idx %d, uiSliceIdx %d, pSliceConsumeTime %d, iSliceSize %d, pFirstMbInSlice %d, count_num_mb_in_slice %d\n",
+                      pEncPEncCtx->iCodingIndex, iSliceIdx,
+                      pEncPEncCtx->pSliceThreading->pSliceConsumeTime[pEncPEncCtx->uiDependencyId][iSliceIdx], iSliceSize,
+                      pCurDq->pSliceEncCtx->pFirstMbInSlice[iSliceIdx], pCurDq->pSliceEncCtx->pCountMbNumInSlice[iSliceIdx]);
+      }
+
+#if defined(SLICE_INFO_OUTPUT)
+      fprintf (stderr,
+               "@pSlice=%-6d sliceType:%c idc:%d size:%-6d\n",
+               iSliceIdx,
+               (pEncPEncCtx->eSliceType == P_SLICE ? 'P' : 'I'),
+               eNalRefIdc,
+               iSliceSize
+              );
+#endif//SLICE_INFO_OUTPUT
+
+#if MT_DEBUG_BS_WR
+      pSliceBs->bSliceCodedFlag	= true;
+#endif//MT_DEBUG_BS_WR
+    } else {	// for SM_DYN_SLICE parallelization
+      SSliceCtx* pSliceCtx			= pCurDq->pSliceEncCtx;
+      const int32_t kiPartitionId			= pPrivateData->iSliceIndex;
+      const int32_t kiSliceIdxStep		= pEncPEncCtx->iActiveThreadsNum;
+      const int32_t kiFirstMbInPartition	= pPrivateData->iStartMbIndex;	// inclusive
+      const int32_t kiEndMbInPartition	= pPrivateData->iEndMbIndex;		// exclusive
+      int32_t iAnyMbLeftInPartition	= kiEndMbInPartition - kiFirstMbInPartition;
+
+      iSliceIdx		= pPrivateData->iSliceIndex;
+
+      pSliceCtx->pFirstMbInSlice[iSliceIdx]				= kiFirstMbInPartition;
+      pCurDq->pNumSliceCodedOfPartition[kiPartitionId]		= 1;	// one pSlice per partition intialized, dynamic slicing inside
+      pCurDq->pLastMbIdxOfPartition[kiPartitionId]			= kiEndMbInPartition - 1;
+
+      pCurDq->pLastCodedMbIdxOfPartition[kiPartitionId]		= 0;
+
+      while (iAnyMbLeftInPartition > 0) {
+        if (iSliceIdx >= pSliceCtx->iMaxSliceNumConstraint) {
+          // TODO: need exception handler for not large enough of MAX_SLICES_NUM related memory usage
+          // No idea about its solution due MAX_SLICES_NUM is fixed lenght in relevent pData structure
+          uiThrdRet	= 1;
+          break;
+        }
 
-  do {
-    MT_TRACE_LOG (pEncPEncCtx, WELS_LOG_INFO,
-                  "[MT] CodingSliceThreadProc(), try to call WelsMultipleEventsWaitSingleBlocking(pEventsList= %p %p %p), pEncPEncCtx= %p!\n",
-                  pEventsList[0], pEventsList[1], pEventsList[1], (void*)pEncPEncCtx);
-    iWaitRet = WelsMultipleEventsWaitSingleBlocking (iEventCount,
-               &pEventsList[0], &pEncPEncCtx->pSliceThreading->pThreadMasterEvent[iEventIdx]); // blocking until at least one event is signalled
-    if (WELS_THREAD_ERROR_WAIT_OBJECT_0 == iWaitRet) {	// start pSlice coding signal waited
-      SLayerBSInfo* pLbi = pPrivateData->pLayerBs;
-      const int32_t kiCurDid			= pEncPEncCtx->uiDependencyId;
-      const int32_t kiCurTid			= pEncPEncCtx->uiTemporalId;
-      SWelsSvcCodingParam* pCodingParam	= pEncPEncCtx->pSvcParam;
-      SDLayerParam* pParamD			= &pCodingParam->sDependencyLayers[kiCurDid];
-
-      pCurDq			= pEncPEncCtx->pCurDqLayer;
-      eNalType		= pEncPEncCtx->eNalType;
-      eNalRefIdc		= pEncPEncCtx->eNalPriority;
-      bNeedPrefix		= pEncPEncCtx->bNeedPrefixNalFlag;
-
-      if (pParamD->sSliceCfg.uiSliceMode != SM_DYN_SLICE) {
-        int64_t iSliceStart	= 0;
-        bool bDsaFlag = false;
-        iSliceIdx		= pPrivateData->iSliceIndex;
         pSlice			= &pCurDq->sLayerInfo.pSliceInLayer[iSliceIdx];
         pSliceBs		= &pEncPEncCtx->pSliceBs[iSliceIdx];
 
-        bDsaFlag	= (((pParamD->sSliceCfg.uiSliceMode == SM_FIXEDSLCNUM_SLICE)||(pParamD->sSliceCfg.uiSliceMode == SM_AUTO_SLICE)) &&
-                     pCodingParam->iMultipleThreadIdc > 1 &&
-                     pCodingParam->iMultipleThreadIdc >= pParamD->sSliceCfg.sSliceArgument.uiSliceNum);
-        if (bDsaFlag)
-          iSliceStart = WelsTime();
-
         pSliceBs->uiBsPos	= 0;
         pSliceBs->iNalIndex	= 0;
-        assert ((void*) (&pSliceBs->sBsWrite) == (void*)pSlice->pSliceBsa);
         InitBits (&pSliceBs->sBsWrite, pSliceBs->pBsBuffer, pSliceBs->uiSize);
 
-#if MT_DEBUG_BS_WR
-        pSliceBs->bSliceCodedFlag	= false;
-#endif//MT_DEBUG_BS_WR
-
         if (bNeedPrefix) {
           if (eNalRefIdc != NRI_PRI_LOWEST) {
             WelsLoadNalForSlice (pSliceBs, NAL_UNIT_PREFIX, eNalRefIdc);
@@ -759,9 +852,10 @@ WELS_THREAD_ROUTINE_TYPE CodingSliceThreadProc (void* arg) {
 
         WelsUnloadNalForSlice (pSliceBs);
 
-        if (0 == iSliceIdx) {
-          pLbi->pBsBuf	= pEncPEncCtx->pFrameBs + pEncPEncCtx->iPosBsBuffer;
-          iReturn = WriteSliceToFrameBs (pEncPEncCtx, pLbi, pLbi->pBsBuf, iSliceIdx, iSliceSize);
+        if (0 == kiPartitionId) {
+          if (0 == iSliceIdx)
+            pLbi->pBsBuf	= pEncPEncCtx->pFrameBs + pEncPEncCtx->iPosBsBuffer;
+          iReturn = WriteSliceToFrameBs (pEncPEncCtx, pLbi, iSliceIdx, iSliceSize);
           if (ENC_RETURN_SUCCESS!=iReturn) {
             uiThrdRet = iReturn;
             break;
@@ -769,7 +863,7 @@ WELS_THREAD_ROUTINE_TYPE CodingSliceThreadProc (void* arg) {
           pEncPEncCtx->iPosBsBuffer += iSliceSize;
         } else
         {
-          iReturn = WriteSliceBs (pEncPEncCtx, pSliceBs->pBs, iSliceIdx, iSliceSize);
+          iReturn = WriteSliceBs (pEncPEncCtx, iSliceIdx, iSliceSize);
           if (ENC_RETURN_SUCCESS!=iReturn) {
             uiThrdRet = iReturn;
             break;
@@ -785,16 +879,6 @@ WELS_THREAD_ROUTINE_TYPE CodingSliceThreadProc (void* arg) {
           DeblockingFilterSliceAvcbase (pCurDq, pEncPEncCtx->pFuncList, iSliceIdx);
         }
 
-        if (bDsaFlag) {
-          pEncPEncCtx->pSliceThreading->pSliceConsumeTime[pEncPEncCtx->uiDependencyId][iSliceIdx] = (uint32_t) (
-                WelsTime() - iSliceStart);
-          MT_TRACE_LOG (pEncPEncCtx, WELS_LOG_INFO,
-                        "[MT] CodingSliceThreadProc(), coding_idx %d, uiSliceIdx %d, pSliceConsumeTime %d, iSliceSize %d, pFirstMbInSlice %d, count_num_mb_in_slice %d\n",
-                        pEncPEncCtx->iCodingIndex, iSliceIdx,
-                        pEncPEncCtx->pSliceThreading->pSliceConsumeTime[pEncPEncCtx->uiDependencyId][iSliceIdx], iSliceSize,
-                        pCurDq->pSliceEncCtx->pFirstMbInSlice[iSliceIdx], pCurDq->pSliceEncCtx->pCountMbNumInSlice[iSliceIdx]);
-        }
-
 #if defined(SLICE_INFO_OUTPUT)
         fprintf (stderr,
                  "@pSlice=%-6d sliceType:%c idc:%d size:%-6d\n",
@@ -805,181 +889,43 @@ WELS_THREAD_ROUTINE_TYPE CodingSliceThreadProc (void* arg) {
                 );
 #endif//SLICE_INFO_OUTPUT
 
-#if MT_DEBUG_BS_WR
-        pSliceBs->bSliceCodedFlag	= true;
-#endif//MT_DEBUG_BS_WR
-
-        WelsEventSignal (
-          &pEncPEncCtx->pSliceThreading->pSliceCodedEvent[iEventIdx]);	// mean finished coding current pSlice
-        WelsEventSignal (
-          &pEncPEncCtx->pSliceThreading->pSliceCodedMasterEvent);
-      } else {	// for SM_DYN_SLICE parallelization
-        SSliceCtx* pSliceCtx			= pCurDq->pSliceEncCtx;
-        const int32_t kiPartitionId			= iThreadIdx;
-        const int32_t kiSliceIdxStep		= pEncPEncCtx->iActiveThreadsNum;
-        const int32_t kiFirstMbInPartition	= pPrivateData->iStartMbIndex;	// inclusive
-        const int32_t kiEndMbInPartition	= pPrivateData->iEndMbIndex;		// exclusive
-        int32_t iAnyMbLeftInPartition	= kiEndMbInPartition - kiFirstMbInPartition;
-
-        iSliceIdx		= pPrivateData->iSliceIndex;
-
-        pSliceCtx->pFirstMbInSlice[iSliceIdx]				= kiFirstMbInPartition;
-        pCurDq->pNumSliceCodedOfPartition[kiPartitionId]		= 1;	// one pSlice per partition intialized, dynamic slicing inside
-        pCurDq->pLastMbIdxOfPartition[kiPartitionId]			= kiEndMbInPartition - 1;
-
-        pCurDq->pLastCodedMbIdxOfPartition[kiPartitionId]		= 0;
-
-        while (iAnyMbLeftInPartition > 0) {
-          if (iSliceIdx >= pSliceCtx->iMaxSliceNumConstraint) {
-            // TODO: need exception handler for not large enough of MAX_SLICES_NUM related memory usage
-            // No idea about its solution due MAX_SLICES_NUM is fixed lenght in relevent pData structure
-            uiThrdRet	= 1;
-            break;
-          }
-
-          pSlice			= &pCurDq->sLayerInfo.pSliceInLayer[iSliceIdx];
-          pSliceBs		= &pEncPEncCtx->pSliceBs[iSliceIdx];
-
-          pSliceBs->uiBsPos	= 0;
-          pSliceBs->iNalIndex	= 0;
-          InitBits (&pSliceBs->sBsWrite, pSliceBs->pBsBuffer, pSliceBs->uiSize);
-
-          if (bNeedPrefix) {
-            if (eNalRefIdc != NRI_PRI_LOWEST) {
-              WelsLoadNalForSlice (pSliceBs, NAL_UNIT_PREFIX, eNalRefIdc);
-              WelsWriteSVCPrefixNal (&pSliceBs->sBsWrite, eNalRefIdc, (NAL_UNIT_CODED_SLICE_IDR == eNalType));
-              WelsUnloadNalForSlice (pSliceBs);
-            } else { // No Prefix NAL Unit RBSP syntax here, but need add NAL Unit Header extension
-              WelsLoadNalForSlice (pSliceBs, NAL_UNIT_PREFIX, eNalRefIdc);
-              // No need write any syntax of prefix NAL Unit RBSP here
-              WelsUnloadNalForSlice (pSliceBs);
-            }
-          }
-
-          WelsLoadNalForSlice (pSliceBs, eNalType, eNalRefIdc);
-
-          iReturn = WelsCodeOneSlice (pEncPEncCtx, iSliceIdx, eNalType);
-          if (ENC_RETURN_SUCCESS!=iReturn) {
-            uiThrdRet = iReturn;
-            break;
-          }
-
-          WelsUnloadNalForSlice (pSliceBs);
-
-          if (0 == kiPartitionId) {
-            if (0 == iSliceIdx)
-              pLbi->pBsBuf	= pEncPEncCtx->pFrameBs + pEncPEncCtx->iPosBsBuffer;
-            iReturn = WriteSliceToFrameBs (pEncPEncCtx, pLbi, pEncPEncCtx->pFrameBs + pEncPEncCtx->iPosBsBuffer, iSliceIdx, iSliceSize);
-            if (ENC_RETURN_SUCCESS!=iReturn) {
-              uiThrdRet = iReturn;
-              break;
-            }
-            pEncPEncCtx->iPosBsBuffer += iSliceSize;
-          } else
-          {
-            iSliceSize = WriteSliceBs (pEncPEncCtx, pSliceBs->pBs, iSliceIdx, iSliceSize);
-            if (ENC_RETURN_SUCCESS!=iReturn) {
-              uiThrdRet = iReturn;
-              break;
-            }
-          }
-
-          if (pCurDq->bDeblockingParallelFlag && pSlice->sSliceHeaderExt.sSliceHeader.uiDisableDeblockingFilterIdc != 1
-#if !defined(ENABLE_FRAME_DUMP)
-              && (eNalRefIdc != NRI_PRI_LOWEST) &&
-              (pParamD->iHighestTemporalId == 0 || kiCurTid < pParamD->iHighestTemporalId)
-#endif// !ENABLE_FRAME_DUMP
-             ) {
-            DeblockingFilterSliceAvcbase (pCurDq, pEncPEncCtx->pFuncList, iSliceIdx);
-          }
-
-#if defined(SLICE_INFO_OUTPUT)
-          fprintf (stderr,
-                   "@pSlice=%-6d sliceType:%c idc:%d size:%-6d\n",
-                   iSliceIdx,
-                   (pEncPEncCtx->eSliceType == P_SLICE ? 'P' : 'I'),
-                   eNalRefIdc,
-                   iSliceSize
-                  );
-#endif//SLICE_INFO_OUTPUT
-
-          MT_TRACE_LOG (pEncPEncCtx, WELS_LOG_INFO,
-                        "[MT] CodingSliceThreadProc(), coding_idx %d, iPartitionId %d, uiSliceIdx %d, iSliceSize %d, count_mb_slice %d, iEndMbInPartition %d, pCurDq->pLastCodedMbIdxOfPartition[%d] %d\n",
-                        pEncPEncCtx->iCodingIndex, kiPartitionId, iSliceIdx, iSliceSize, pCurDq->pSliceEncCtx->pCountMbNumInSlice[iSliceIdx],
-                        kiEndMbInPartition, kiPartitionId, pCurDq->pLastCodedMbIdxOfPartition[kiPartitionId]);
+        MT_TRACE_LOG (pEncPEncCtx, WELS_LOG_INFO,
+                      "[MT] CodingSliceTask(), coding_idx %d, iPartitionId %d, uiSliceIdx %d, iSliceSize %d, count_mb_slice %d, iEndMbInPartition %d, pCurDq->pLastCodedMbIdxOfPartition[%d] %d\n",
+                      pEncPEncCtx->iCodingIndex, kiPartitionId, iSliceIdx, iSliceSize, pCurDq->pSliceEncCtx->pCountMbNumInSlice[iSliceIdx],
+                      kiEndMbInPartition, kiPartitionId, pCurDq->pLastCodedMbIdxOfPartition[kiPartitionId]);
 
-          iAnyMbLeftInPartition = kiEndMbInPartition - (1 + pCurDq->pLastCodedMbIdxOfPartition[kiPartitionId]);
-          iSliceIdx += kiSliceIdxStep;
-        }
-
-        if (uiThrdRet)	// any exception??
-          break;
-
-        WelsEventSignal (&pEncPEncCtx->pSliceThreading->pSliceCodedEvent[iEventIdx]);	// mean finished coding current pSlice
-        WelsEventSignal (&pEncPEncCtx->pSliceThreading->pSliceCodedMasterEvent);
+        iAnyMbLeftInPartition = kiEndMbInPartition - (1 + pCurDq->pLastCodedMbIdxOfPartition[kiPartitionId]);
+        iSliceIdx += kiSliceIdxStep;
       }
     }
-    else if (WELS_THREAD_ERROR_WAIT_OBJECT_0 + 1 == iWaitRet) {	// exit thread signal
-      uiThrdRet	= 0;
-      break;
-    }
-    else if (WELS_THREAD_ERROR_WAIT_OBJECT_0 + 2 == iWaitRet) {	// update pMb list singal
-      iSliceIdx		=
-        iEventIdx;	// pPrivateData->iSliceIndex; old threads can not be terminated, pPrivateData is not correct for applicable
-      pCurDq			= pEncPEncCtx->pCurDqLayer;
-      UpdateMbListNeighborParallel (pCurDq->pSliceEncCtx, pCurDq->sMbDataP, iSliceIdx);
-      WelsEventSignal (
-        &pEncPEncCtx->pSliceThreading->pFinUpdateMbListEvent[iEventIdx]);	// mean finished update pMb list for this pSlice
-    }
-    else { // WELS_THREAD_ERROR_WAIT_TIMEOUT, or WELS_THREAD_ERROR_WAIT_FAILED
-      WelsLog (pEncPEncCtx, WELS_LOG_WARNING,
-               "[MT] CodingSliceThreadProc(), waiting pReadySliceCodingEvent[%d] failed(%d) and thread%d terminated!\n", iEventIdx,
-               iWaitRet, iThreadIdx);
-      uiThrdRet	= 1;
-      break;
-    }
-  } while (1);
+  } while (0);
 
   //sync multi-threading error
-  WelsMutexLock (&pEncPEncCtx->mutexEncoderError);
-  if (uiThrdRet) pEncPEncCtx->iEncoderError |= uiThrdRet;
-  WelsMutexUnlock (&pEncPEncCtx->mutexEncoderError);
-
-  WELS_THREAD_ROUTINE_RETURN (uiThrdRet);
-}
-
-int32_t CreateSliceThreads (sWelsEncCtx* pCtx) {
-  const int32_t kiThreadCount = pCtx->pSvcParam->iCountThreadsNum;
-  int32_t iIdx = 0;
-
-  while (iIdx < kiThreadCount) {
-    WelsThreadCreate (&pCtx->pSliceThreading->pThreadHandles[iIdx], CodingSliceThreadProc,
-                      &pCtx->pSliceThreading->pThreadPEncCtx[iIdx], 0);
-
-    ++ iIdx;
+  if (uiThrdRet) {
+    WelsMutexLock (&pEncPEncCtx->mutexEncoderError);
+    pEncPEncCtx->iEncoderError |= uiThrdRet;
+    WelsMutexUnlock (&pEncPEncCtx->mutexEncoderError);
   }
-  MT_TRACE_LOG (pCtx, WELS_LOG_INFO, "CreateSliceThreads() exit..\n");
-  return 0;
 }
 
-int32_t FiredSliceThreads (SSliceThreadPrivateData* pPriData, WELS_EVENT* pEventsList, WELS_EVENT* pMasterEventsList, SLayerBSInfo* pLbi,
-                           const uint32_t uiNumThreads, SSliceCtx* pSliceCtx, const bool bIsDynamicSlicingMode)
-{
+int32_t CodeSliceTasks (sWelsEncCtx* pCtx, SLayerBSInfo* pLbi, const int32_t kiTaskNum,
+                        const bool kbIsDynamicSlicingMode) {
+  SSliceThreading* pSmt				= pCtx->pSliceThreading;
+  SSliceThreadPrivateData* pPriData	= pSmt->pThreadPEncCtx;
+  SSliceCtx* pSliceCtx				= pCtx->pCurDqLayer->pSliceEncCtx;
   int32_t iEndMbIdx	= 0;
   int32_t iIdx		= 0;
-  const int32_t kiEventCnt = uiNumThreads;
 
-  if (pPriData == NULL || pLbi == NULL || kiEventCnt <= 0 || pEventsList == NULL) {
-    WelsLog (NULL, WELS_LOG_ERROR,
-             "FiredSliceThreads(), fail due pPriData == %p || pLbi == %p || iEventCnt(%d) <= 0 || pEventsList == %p!!\n",
-             (void*)pPriData, (void*)pLbi, uiNumThreads, (void*)pEventsList);
+  if (pLbi == NULL || kiTaskNum <= 0) {
+    WelsLog (pCtx, WELS_LOG_ERROR, "CodeSliceTasks(), fail due pLbi == %p || kiTaskNum(%d) <= 0!!\n", (void*)pLbi,
+             kiTaskNum);
     return 1;
   }
 
   ////////////////////////////////////////
-  if (bIsDynamicSlicingMode) {
+  if (kbIsDynamicSlicingMode) {
     iEndMbIdx	= pSliceCtx->iMbNumInFrame;
-    for (iIdx = kiEventCnt - 1; iIdx >= 0; --iIdx) {
+    for (iIdx = kiTaskNum - 1; iIdx >= 0; --iIdx) {
       const int32_t iFirstMbIdx		= pSliceCtx->pFirstMbInSlice[iIdx];
       pPriData[iIdx].iStartMbIndex	= iFirstMbIdx;
       pPriData[iIdx].iEndMbIndex		= iEndMbIdx;
@@ -987,16 +933,15 @@ int32_t FiredSliceThreads (SSliceThreadPrivateData* pPriData, WELS_EVENT* pEvent
     }
   }
 
+  // slices are picked up by whichever worker gets free first, the calling thread included
   iIdx = 0;
-  while (iIdx < kiEventCnt) {
-    pPriData[iIdx].pLayerBs = pLbi;
+  while (iIdx < kiTaskNum) {
+    pPriData[iIdx].pLayerBs		= pLbi;
     pPriData[iIdx].iSliceIndex	= iIdx;
-    if (pEventsList[iIdx])
-      WelsEventSignal (&pEventsList[iIdx]);
-    if (pMasterEventsList[iIdx])
-      WelsEventSignal (&pMasterEventsList[iIdx]);
+    WelsThreadPoolSubmit (pSmt->pThreadPool, &pSmt->sSliceTasks, CodingSliceTask, &pPriData[iIdx]);
     ++ iIdx;
   }
+  WelsThreadPoolWait (pSmt->pThreadPool, &pSmt->sSliceTasks);
 
   return 0;
 }
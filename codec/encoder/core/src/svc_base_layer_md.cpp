@@ -1016,6 +1016,12 @@ int32_t WelsMdP16x16 (SWelsFuncPtrList* pFunc, SDqLayer* pCurLayer, SWelsMD* pWe
       ++ pSlice->uiMvcNum;
     }
   }
+  //hierarchical motion vector predictor, from the lower layer or the half resolution search
+  if (NULL != pCurLayer->pHierarchicalMe) {
+    const SMVUnitXY ksSeedMv = pCurLayer->pHierarchicalMe->pMbMv[pCurMb->iMbXY];
+    if (ksSeedMv.iMvX != pMe16x16->sMvBase.iMvX || ksSeedMv.iMvY != pMe16x16->sMvBase.iMvY)
+      pSlice->sMvc[pSlice->uiMvcNum++] = ksSeedMv;
+  }
 
   PredMv (&pMbCache->sMvComponents, 0, 4, 0, & (pMe16x16->sMvp));
   pFunc->pfMotionSearch[0] (pFunc, pCurLayer, pMe16x16, pSlice);
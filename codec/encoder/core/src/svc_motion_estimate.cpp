@@ -42,6 +42,9 @@
 #include "ls_defines.h"
 #include "svc_motion_estimate.h"
 #include "wels_transpose_matrix.h"
+#if defined(X86_INTRINSICS)
+#include <immintrin.h>
+#endif//X86_INTRINSICS
 
 namespace WelsSVCEnc {
 
@@ -87,6 +90,13 @@ void WelsInitMeFunc( SWelsFuncPtrList* pFuncList, uint32_t uiCpuFlag, bool bScre
       pFuncList->pfVerticalFullSearch = VerticalFullSearchUsingSSE41;
       pFuncList->pfHorizontalFullSearch = HorizontalFullSearchUsingSSE41;
     }
+#if defined(X86_INTRINSICS)
+    if ( uiCpuFlag & WELS_CPU_AVX2 ) {
+      // the line search wrappers above only depend on pfSampleSadHor8 and the transposes
+      pFuncList->pfSampleSadHor8[0] = SampleSad8x8Hor8_avx2;
+      pFuncList->pfSampleSadHor8[1] = SampleSad16x16Hor8_avx2;
+    }
+#endif//X86_INTRINSICS
 
     //for feature search
     pFuncList->pfCalculateBlockFeatureOfFrame[0] = SumOf8x8BlockOfFrame_c;
@@ -458,7 +468,57 @@ void HorizontalFullSearchUsingSSE41( void *pFunc, void *vpMe,
     UpdateMeResults( sBestMv, uiBestCost, &pMe->pColoRefMb[sBestMv.iMvY], pMe );
   }
 }
-#endif
+
+#endif//X86_ASM
+
+#if defined(X86_INTRINSICS)
+// same results as the sse41 versions: ymm lanes cover two rows (8x8) or the two halves of a row (16x16)
+WELS_TARGET_AVX2 uint32_t SampleSad8x8Hor8_avx2( uint8_t* pSrc, int32_t iSrcStride, uint8_t* pRef, int32_t iRefStride,
+    uint16_t* pBaseCost, int32_t* pIndexMinPos ) {
+  __m256i iCost = _mm256_setzero_si256();
+  for (int32_t i = 0; i < 8; i += 2) {
+    const __m256i kSrc = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i*)pSrc ) ),
+                         _mm_loadu_si128( (const __m128i*)(pSrc + iSrcStride) ), 1 );
+    const __m256i kRef = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i*)pRef ) ),
+                         _mm_loadu_si128( (const __m128i*)(pRef + iRefStride) ), 1 );
+    iCost = _mm256_add_epi16( iCost, _mm256_mpsadbw_epu8( kRef, kSrc, 0x00 ) );
+    iCost = _mm256_add_epi16( iCost, _mm256_mpsadbw_epu8( kRef, kSrc, 0x2D ) );
+    pSrc += iSrcStride << 1;
+    pRef += iRefStride << 1;
+  }
+  // 16 bit wrap-around on the base cost as in the sse41 version
+  __m128i iCostSum = _mm_add_epi16( _mm256_castsi256_si128( iCost ), _mm256_extracti128_si256( iCost, 1 ) );
+  iCostSum = _mm_add_epi16( iCostSum, _mm_loadu_si128( (const __m128i*)pBaseCost ) );
+  const uint32_t kuiMinPos = _mm_cvtsi128_si32( _mm_minpos_epu16( iCostSum ) );
+  *pIndexMinPos = (kuiMinPos >> 16) & 0x07;
+  return kuiMinPos & 0xFFFF;
+}
+
+WELS_TARGET_AVX2 uint32_t SampleSad16x16Hor8_avx2( uint8_t* pSrc, int32_t iSrcStride, uint8_t* pRef, int32_t iRefStride,
+    uint16_t* pBaseCost, int32_t* pIndexMinPos ) {
+  __m256i iSad = _mm256_setzero_si256();
+  for (int32_t i = 0; i < 16; ++ i) {
+    const __m256i kSrc = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)pSrc ) );
+    const __m256i kRef = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( (const __m128i*)pRef ) ),
+                         _mm_loadu_si128( (const __m128i*)(pRef + 8) ), 1 );
+    iSad = _mm256_add_epi16( iSad, _mm256_mpsadbw_epu8( kRef, kSrc, 0x10 ) );
+    iSad = _mm256_add_epi16( iSad, _mm256_mpsadbw_epu8( kRef, kSrc, 0x3D ) );
+    pSrc += iSrcStride;
+    pRef += iRefStride;
+  }
+  const __m128i kSadSum = _mm_add_epi16( _mm256_castsi256_si128( iSad ), _mm256_extracti128_si256( iSad, 1 ) );
+  __m256i iCost = _mm256_add_epi32( _mm256_cvtepu16_epi32( kSadSum ),
+                                    _mm256_cvtepu16_epi32( _mm_loadu_si128( (const __m128i*)pBaseCost ) ) );
+  // costs stay below 1<<17, so carrying the index in the low bits keeps the first minimum on ties
+  iCost = _mm256_or_si256( _mm256_slli_epi32( iCost, 3 ), _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) );
+  __m128i iMin = _mm_min_epu32( _mm256_castsi256_si128( iCost ), _mm256_extracti128_si256( iCost, 1 ) );
+  iMin = _mm_min_epu32( iMin, _mm_shuffle_epi32( iMin, 0x4E ) );
+  iMin = _mm_min_epu32( iMin, _mm_shuffle_epi32( iMin, 0xB1 ) );
+  const uint32_t kuiMin = _mm_cvtsi128_si32( iMin );
+  *pIndexMinPos = kuiMin & 0x07;
+  return kuiMin >> 3;
+}
+#endif//X86_INTRINSICS
 void LineFullSearch_c( void *pFunc, void *vpMe,
              uint16_t* pMvdTable, const int32_t kiFixedMvd,
              const int32_t kiEncStride, const int32_t kiRefStride,
@@ -907,5 +967,198 @@ void WelsDiamondCrossFeatureSearch(SWelsFuncPtrList *pFunc, void* vpMe, void* vp
     }
 }
 
+/////////////////////////
+// Hierarchical Search
+/////////////////////////
+int32_t RequestHierarchicalMe (CMemoryAlign* pMa, const int32_t kiMbWidth, const int32_t kiMbHeight,
+                               SHierarchicalMe* pHierarchicalMe) {
+  const int32_t kiHalfSize = (kiMbWidth << 3) * (kiMbHeight << 3);
+
+  pHierarchicalMe->pMbMv = (SMVUnitXY*)pMa->WelsMallocz (kiMbWidth * kiMbHeight * sizeof (SMVUnitXY), "pHierarchicalMe->pMbMv");
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == pHierarchicalMe->pMbMv)
+  pHierarchicalMe->pHalfEnc = (uint8_t*)pMa->WelsMalloc (kiHalfSize << 1, "pHierarchicalMe->pHalfEnc");
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == pHierarchicalMe->pHalfEnc)
+  pHierarchicalMe->pHalfRef = pHierarchicalMe->pHalfEnc + kiHalfSize;
+  pHierarchicalMe->iHalfStride = kiMbWidth << 3;
+
+  return ENC_RETURN_SUCCESS;
+}
+void ReleaseHierarchicalMe (CMemoryAlign* pMa, SHierarchicalMe* pHierarchicalMe) {
+  if (pHierarchicalMe->pMbMv) {
+    pMa->WelsFree (pHierarchicalMe->pMbMv, "pHierarchicalMe->pMbMv");
+    pHierarchicalMe->pMbMv = NULL;
+  }
+  if (pHierarchicalMe->pHalfEnc) {
+    pMa->WelsFree (pHierarchicalMe->pHalfEnc, "pHierarchicalMe->pHalfEnc");
+    pHierarchicalMe->pHalfEnc = pHierarchicalMe->pHalfRef = NULL;
+  }
+}
+
+void HalfResolutionDownsample_c (uint8_t* pDst, const int32_t kiDstStride, uint8_t* pSrc, const int32_t kiSrcStride,
+                                 const int32_t kiDstWidth, const int32_t kiDstHeight) {
+  for (int32_t j = 0; j < kiDstHeight; j++) {
+    const uint8_t* kpSrc0 = pSrc + (j << 1) * kiSrcStride;
+    const uint8_t* kpSrc1 = kpSrc0 + kiSrcStride;
+    for (int32_t i = 0; i < kiDstWidth; i++) {
+      pDst[i] = (kpSrc0[i << 1] + kpSrc0[ (i << 1) + 1] + kpSrc1[i << 1] + kpSrc1[ (i << 1) + 1] + 2) >> 2;
+    }
+    pDst += kiDstStride;
+  }
+}
+
+// the best of the candidates refined by a diamond search, kept within [kiMin, kiMax] of the half resolution
+static inline void HalfResolutionBlockSearch (PSampleSadSatdCostFunc pSad, PSample4SadCostFunc pSad4, uint8_t* pEnc,
+    uint8_t* pRef, const int32_t kiStride, const SMVUnitXY* kpCand, const int32_t kiCandNum, const SMVUnitXY ksMin,
+    const SMVUnitXY ksMax, SMVUnitXY* pMv) {
+  ENFORCE_STACK_ALIGN_1D (int32_t, iSadCosts, 4, 16)
+  int32_t iBestX = 0, iBestY = 0, iBestSad = INT_MAX;
+
+  for (int32_t i = 0; i < kiCandNum; i++) {
+    const int32_t kiX = WELS_CLIP3 (kpCand[i].iMvX >> 3, ksMin.iMvX, ksMax.iMvX);
+    const int32_t kiY = WELS_CLIP3 (kpCand[i].iMvY >> 3, ksMin.iMvY, ksMax.iMvY);
+    const int32_t kiSad = pSad (pEnc, kiStride, pRef + kiY * kiStride + kiX, kiStride);
+    if (kiSad < iBestSad) {
+      iBestSad = kiSad;
+      iBestX = kiX;
+      iBestY = kiY;
+    }
+  }
+
+  int32_t iTimeThreshold = ITERATIVE_TIMES;
+  while (iTimeThreshold--) {
+    pSad4 (pEnc, kiStride, pRef + iBestY * kiStride + iBestX, kiStride, &iSadCosts[0]);
+    int32_t iX = 0, iY = 0;
+    // up, down, left and right, moves off the search window are not taken
+    if (iBestY > ksMin.iMvY && iSadCosts[0] < iBestSad) {
+      iBestSad = iSadCosts[0];
+      iY = -1;
+    }
+    if (iBestY < ksMax.iMvY && iSadCosts[1] < iBestSad) {
+      iBestSad = iSadCosts[1];
+      iY = 1;
+    }
+    if (iBestX > ksMin.iMvX && iSadCosts[2] < iBestSad) {
+      iBestSad = iSadCosts[2];
+      iX = -1;
+      iY = 0;
+    }
+    if (iBestX < ksMax.iMvX && iSadCosts[3] < iBestSad) {
+      iBestSad = iSadCosts[3];
+      iX = 1;
+      iY = 0;
+    }
+    if (0 == iX && 0 == iY)
+      break;
+    iBestX += iX;
+    iBestY += iY;
+  }
+
+  // to quarter pel of the full resolution
+  pMv->iMvX = iBestX << 3;
+  pMv->iMvY = iBestY << 3;
+}
+
+// diamond search of every 8x8 block of the half resolution pictures, started from zero and the neighbours searched
+// before in raster order, then once more backwards so that motion found late reaches the top and left blocks as well
+void HalfResolutionMotionSearch (SWelsFuncPtrList* pFuncList, uint8_t* pEnc, uint8_t* pRef, const int32_t kiStride,
+                                 const int32_t kiMbWidth, const int32_t kiMbHeight, SMVUnitXY* pMbMv) {
+  PSampleSadSatdCostFunc pSad = pFuncList->sSampleDealingFuncs.pfSampleSad[BLOCK_8x8];
+  PSample4SadCostFunc pSad4 = pFuncList->sSampleDealingFuncs.pfSample4Sad[BLOCK_8x8];
+  // the 4 neighbours of a position are read, so keep one pixel off the picture edges
+  const int32_t kiMaxPosX = (kiMbWidth << 3) - 9;
+  const int32_t kiMaxPosY = (kiMbHeight << 3) - 9;
+  SMVUnitXY sCand[4], sMin, sMax;
+
+  if (kiMaxPosX < 1 || kiMaxPosY < 1) {
+    memset (pMbMv, 0, kiMbWidth * kiMbHeight * sizeof (SMVUnitXY));
+    return;
+  }
+
+  for (int32_t iPass = 0; iPass < 2; iPass++) {
+    for (int32_t iIdx = 0; iIdx < kiMbWidth * kiMbHeight; iIdx++) {
+      const int32_t kiMbXY = iPass ? (kiMbWidth * kiMbHeight - 1 - iIdx) : iIdx;
+      const int32_t kiMbX = kiMbXY % kiMbWidth;
+      const int32_t kiMbY = kiMbXY / kiMbWidth;
+      const int32_t kiPixX = kiMbX << 3;
+      const int32_t kiPixY = kiMbY << 3;
+      SMVUnitXY* pMv = &pMbMv[kiMbXY];
+      int32_t iCandNum = 0;
+
+      sMin.iMvX = WELS_MAX (1 - kiPixX, -HIERARCHICAL_ME_RANGE);
+      sMax.iMvX = WELS_MIN (kiMaxPosX - kiPixX, HIERARCHICAL_ME_RANGE);
+      sMin.iMvY = WELS_MAX (1 - kiPixY, -HIERARCHICAL_ME_RANGE);
+      sMax.iMvY = WELS_MIN (kiMaxPosY - kiPixY, HIERARCHICAL_ME_RANGE);
+
+      if (0 == iPass) {
+        sCand[iCandNum].iMvX = sCand[iCandNum].iMvY = 0;
+        ++ iCandNum;
+        if (kiMbX > 0)
+          sCand[iCandNum++] = pMv[-1];
+        if (kiMbY > 0) {
+          sCand[iCandNum++] = pMv[-kiMbWidth];
+          if (kiMbX < kiMbWidth - 1)
+            sCand[iCandNum++] = pMv[1 - kiMbWidth];
+        }
+      } else {
+        sCand[iCandNum++] = *pMv;
+        if (kiMbX < kiMbWidth - 1)
+          sCand[iCandNum++] = pMv[1];
+        if (kiMbY < kiMbHeight - 1) {
+          sCand[iCandNum++] = pMv[kiMbWidth];
+          if (kiMbX > 0)
+            sCand[iCandNum++] = pMv[kiMbWidth - 1];
+        }
+      }
+      HalfResolutionBlockSearch (pSad, pSad4, pEnc + kiPixY * kiStride + kiPixX, pRef + kiPixY * kiStride + kiPixX, kiStride,
+                                 sCand, iCandNum, sMin, sMax, pMv);
+    }
+  }
+}
+
+// the motion of the co-located 4x4 block of the lower layer, scaled by the ratio of the picture sizes
+void ScaleLowerLayerMotion (const SDqLayer* kpLowerLayer, const int32_t kiLowerWidth, const int32_t kiLowerHeight,
+                            const int32_t kiWidth, const int32_t kiHeight, const int32_t kiMbWidth, const int32_t kiMbHeight,
+                            SMVUnitXY* pMbMv) {
+  for (int32_t iMbY = 0; iMbY < kiMbHeight; iMbY++) {
+    const int32_t kiLowerY = WELS_MIN ((((iMbY << 4) + 8) * kiLowerHeight) / kiHeight, kiLowerHeight - 1);
+    for (int32_t iMbX = 0; iMbX < kiMbWidth; iMbX++) {
+      const int32_t kiLowerX = WELS_MIN ((((iMbX << 4) + 8) * kiLowerWidth) / kiWidth, kiLowerWidth - 1);
+      const SMB* kpLowerMb = &kpLowerLayer->sMbDataP[ (kiLowerY >> 4) * kpLowerLayer->iMbWidth + (kiLowerX >> 4)];
+      if (IS_SVC_INTRA (kpLowerMb->uiMbType)) {
+        pMbMv->iMvX = pMbMv->iMvY = 0;
+      } else {
+        const SMVUnitXY ksMv = kpLowerMb->sMv[ (((kiLowerY >> 2) & 3) << 2) + ((kiLowerX >> 2) & 3)];
+        pMbMv->iMvX = (ksMv.iMvX * kiWidth) / kiLowerWidth;
+        pMbMv->iMvY = (ksMv.iMvY * kiHeight) / kiLowerHeight;
+      }
+      ++ pMbMv;
+    }
+  }
+}
+
+void PerformHierarchicalMePreprocess (sWelsEncCtx* pCtx) {
+  SDqLayer* pCurLayer = pCtx->pCurDqLayer;
+  SHierarchicalMe* pHierarchicalMe = pCurLayer->pHierarchicalMe;
+  const int32_t kiMbWidth = pCurLayer->iMbWidth;
+  const int32_t kiMbHeight = pCurLayer->iMbHeight;
+
+  if (NULL != pCurLayer->pRefLayer) {
+    // the next lower layer of the same frame was coded just before
+    const int32_t kiDid = pCurLayer->sLayerInfo.sNalHeaderExt.uiDependencyId;
+    const SDLayerParam* kpLowerParam = &pCtx->pSvcParam->sDependencyLayers[kiDid - 1];
+    const SDLayerParam* kpParam = &pCtx->pSvcParam->sDependencyLayers[kiDid];
+    ScaleLowerLayerMotion (pCurLayer->pRefLayer, kpLowerParam->iFrameWidth, kpLowerParam->iFrameHeight,
+                           kpParam->iFrameWidth, kpParam->iFrameHeight, kiMbWidth, kiMbHeight, pHierarchicalMe->pMbMv);
+  } else {
+    const int32_t kiHalfStride = pHierarchicalMe->iHalfStride;
+    HalfResolutionDownsample_c (pHierarchicalMe->pHalfEnc, kiHalfStride, pCurLayer->pEncData[0], pCurLayer->iEncStride[0],
+                                kiMbWidth << 3, kiMbHeight << 3);
+    HalfResolutionDownsample_c (pHierarchicalMe->pHalfRef, kiHalfStride, pCurLayer->pRefPic->pData[0],
+                                pCurLayer->pRefPic->iLineSize[0], kiMbWidth << 3, kiMbHeight << 3);
+    HalfResolutionMotionSearch (pCtx->pFuncList, pHierarchicalMe->pHalfEnc, pHierarchicalMe->pHalfRef, kiHalfStride,
+                                kiMbWidth, kiMbHeight, pHierarchicalMe->pMbMv);
+  }
+}
+
 } // namespace WelsSVCEnc
 
@@ -210,7 +210,8 @@ void WelsSpatialWriteSubMbPred (sWelsEncCtx* pEncCtx, SSlice* pSlice, SMB* pCurM
 
 int32_t CheckBitstreamBuffer(const uint8_t	kuiSliceIdx, sWelsEncCtx* pEncCtx,  SBitStringAux* pBs)
 {
-  const int32_t iLeftLength = pBs->pBufEnd - pBs->pBufPtr - 1;
+  //bits still in uiCurBits are written out before the next MB
+  const int32_t iLeftLength = pBs->pBufEnd - pBs->pBufPtr - ((64 - pBs->iLeftBits + 7) >> 3) - 1;
   assert(iLeftLength > 0);
 
   if (iLeftLength < MAX_MACROBLOCK_SIZE_IN_BYTE) {
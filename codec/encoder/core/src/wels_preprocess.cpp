@@ -72,16 +72,20 @@ inline  void   WelsUpdateSpatialIdxMap (sWelsEncCtx* pEncCtx, int32_t iPos, SPic
 
 CWelsPreProcess::CWelsPreProcess (sWelsEncCtx* pEncCtx) {
   m_pInterfaceVp = NULL;
+  m_pPrepInterfaceVp = NULL;
   m_bInitDone = false;
   m_pEncCtx = pEncCtx;
   memset (&m_sScaledPicture, 0, sizeof (m_sScaledPicture));
+  memset (&m_sPrepScaledPicture, 0, sizeof (m_sPrepScaledPicture));
   memset (m_pSpatialPic, 0, sizeof (m_pSpatialPic));
   memset (m_uiSpatialLayersInTemporal, 0, sizeof (m_uiSpatialLayersInTemporal));
   memset (m_uiSpatialPicNum, 0, sizeof (m_uiSpatialPicNum));
+  memset (&m_sZeroCopySource, 0, sizeof (m_sZeroCopySource));
 }
 
 CWelsPreProcess::~CWelsPreProcess() {
   FreeScaledPic (&m_sScaledPicture,  m_pEncCtx->pMemAlign);
+  UninitSourcePreparation (m_pEncCtx);
   WelsPreprocessDestroy();
 }
 
@@ -114,6 +118,15 @@ int32_t CWelsPreProcess::WelsPreprocessReset (sWelsEncCtx* pCtx) {
     FreeScaledPic (&m_sScaledPicture, pCtx->pMemAlign);
     iRet = InitLastSpatialPictures (pCtx);
     iRet = WelsInitScaledPic (pCtx->pSvcParam, &m_sScaledPicture, pCtx->pMemAlign);
+
+    if (m_pInterfaceVp) {
+      // layer tasks analyse under mutexPreProcess, waiting for stripes there might pick up another layer task
+      int32_t iStripeNum = pCtx->pSvcParam->iCountThreadsNum;
+      m_pInterfaceVp->Set (METHOD_COLORSPACE_CONVERT | METHOD_FLAG_STRIPE_THREADS, &iStripeNum);
+      m_pInterfaceVp->Set (METHOD_DOWNSAMPLE | METHOD_FLAG_STRIPE_THREADS, &iStripeNum);
+      iStripeNum = (NULL == pCtx->pLayerThreading) ? pCtx->pSvcParam->iCountThreadsNum : 1;
+      m_pInterfaceVp->Set (METHOD_VAA_STATISTICS | METHOD_FLAG_STRIPE_THREADS, &iStripeNum);
+    }
   }
 
   return iRet;
@@ -161,6 +174,7 @@ void CWelsPreProcess::FreeSpatialPictures (sWelsEncCtx* pCtx) {
 
     while (i < uiRefNumInTemporal) {
       if (NULL != m_pSpatialPic[j][i]) {
+        ReleaseSourcePicture (m_pSpatialPic[j][i]);
         FreePicture (pMa, &m_pSpatialPic[j][i]);
       }
       ++ i;
@@ -175,16 +189,18 @@ int32_t CWelsPreProcess::BuildSpatialPicList (sWelsEncCtx* pCtx, const SSourcePi
   int32_t iSpatialNum = 0;
 
   if (!m_bInitDone) {
-    if (WelsPreprocessCreate() != 0)
-      return -1;
-    if (WelsPreprocessReset (pCtx) != 0)
+    if (WelsPreprocessCreate() != 0 || WelsPreprocessReset (pCtx) != 0) {
+      ReleaseSource (kpSrcPic->pData[0]);
       return -1;
+    }
 
     m_bInitDone = true;
   }
 
-  if (m_pInterfaceVp == NULL)
+  if (m_pInterfaceVp == NULL) {
+    ReleaseSource (kpSrcPic->pData[0]);
     return -1;
+  }
 
   pCtx->pVaa->bSceneChangeFlag = pCtx->pVaa->bIdrPeriodFlag = false;
   if (pSvcParam->uiIntraPeriod)
@@ -283,6 +299,7 @@ int32_t CWelsPreProcess::SingleLayerPreprocess (sWelsEncCtx* pCtx, const SSource
   int8_t  iDependencyId             = pSvcParam->iSpatialLayerNum - 1;
   int32_t iPicturePos               = m_uiSpatialLayersInTemporal[iDependencyId] - 1;
 
+  SPreparedPicture* pPrepared	= pCtx->pPreparedPic;
   SPicture* pSrcPic					= NULL;	// large
   SPicture* pDstPic					= NULL;	// small
   SDLayerParam* pDlayerParam					= NULL;
@@ -301,25 +318,50 @@ int32_t CWelsPreProcess::SingleLayerPreprocess (sWelsEncCtx* pCtx, const SSource
   iSrcWidth   = pSvcParam->SUsedPicRect.iWidth;
   iSrcHeight  = pSvcParam->SUsedPicRect.iHeight;
 
-  pSrcPic = pScaledPicture->pScaledInputPicture ? pScaledPicture->pScaledInputPicture :
-            m_pSpatialPic[iDependencyId][iPicturePos];
+  if (NULL != pPrepared) {
+    // samples made ready by PrepareSourcePicture(), same as processing kpSrc here
+    pDstPic = m_pSpatialPic[iDependencyId][iPicturePos];
+    ReleaseSourcePicture (pDstPic);
+    WelsExchangePictureData (pDstPic, pPrepared->pLayerPic[iDependencyId]);
+  } else {
+    pSrcPic = pScaledPicture->pScaledInputPicture ? pScaledPicture->pScaledInputPicture :
+              m_pSpatialPic[iDependencyId][iPicturePos];
+
+    // different scaling in between input picture and dst highest spatial picture.
+    SPicture* pLayerPic[MAX_DEPENDENCY_LAYER] = { NULL };
+    if (pScaledPicture->pScaledInputPicture) {
+      // for highest downsampling
+      pLayerPic[iDependencyId] = m_pSpatialPic[iDependencyId][iPicturePos];
+    }
+    // the lower spatial layers to be coded are sampled in the same pass over pSrcPic
+    for (int32_t i = 0; i < iDependencyId; i++) {
+      if (pSvcParam->sDependencyLayers[i].uiCodingIdx2TemporalId[pCtx->iCodingIndex & (pSvcParam->uiGopSize - 1)]
+          != INVALID_TEMPORAL_ID)
+        pLayerPic[i] = m_pSpatialPic[i][m_uiSpatialLayersInTemporal[i] - 1];
+    }
 
-  WelsMoveMemoryWrapper (pSvcParam, pSrcPic, kpSrc, iSrcWidth, iSrcHeight);
+    // the samples of the picture taking this place are no longer needed
+    ReleaseSourcePicture (m_pSpatialPic[iDependencyId][iPicturePos]);
+    if (pScaledPicture->pScaledInputPicture || !ReferenceSource (pCtx, pSrcPic, kpSrc)) {
+      if (VIDEO_FORMAT_I420 == (kpSrc->iColorFormat & (~VIDEO_FORMAT_VFlip)))
+        WelsMoveMemoryWrapper (pSvcParam, pSrcPic, kpSrc, iSrcWidth, iSrcHeight);
+      else
+        ColorspaceConvert (m_pInterfaceVp, pSvcParam, pScaledPicture, pSrcPic, kpSrc, iSrcWidth, iSrcHeight, pLayerPic);
+      ReleaseSource (kpSrc->pData[0]);
+    }
 
-  if (pSvcParam->bEnableDenoise)
-    BilateralDenoising (pSrcPic, iSrcWidth, iSrcHeight);
+    if (pSvcParam->bEnableDenoise)
+      BilateralDenoising (m_pInterfaceVp, pSrcPic, iSrcWidth, iSrcHeight);
 
-  // different scaling in between input picture and dst highest spatial picture.
-  int32_t iShrinkWidth  = iSrcWidth;
-  int32_t iShrinkHeight = iSrcHeight;
-  pDstPic = pSrcPic;
-  if (pScaledPicture->pScaledInputPicture) {
-    // for highest downsampling
-    pDstPic		= m_pSpatialPic[iDependencyId][iPicturePos];
-    iShrinkWidth = pScaledPicture->iScaledWidth[iDependencyId];
-    iShrinkHeight = pScaledPicture->iScaledHeight[iDependencyId];
+    pDstPic = pSrcPic;
+    if (pScaledPicture->pScaledInputPicture) {
+      pDstPic		= m_pSpatialPic[iDependencyId][iPicturePos];
+    } else {
+      DownsamplePadding (m_pInterfaceVp, pSrcPic, pDstPic, iSrcWidth, iSrcHeight, iSrcWidth, iSrcHeight, iTargetWidth,
+                         iTargetHeight);
+    }
+    DownsampleLayersPadding (m_pInterfaceVp, pSvcParam, pScaledPicture, pSrcPic, pLayerPic);
   }
-  DownsamplePadding (pSrcPic, pDstPic, iSrcWidth, iSrcHeight, iShrinkWidth, iShrinkHeight, iTargetWidth, iTargetHeight);
 
   if (pSvcParam->bEnableSceneChangeDetect && !pCtx->pVaa->bIdrPeriodFlag) {
     if (pSvcParam->iUsageType == SCREEN_CONTENT_REAL_TIME) {
@@ -353,27 +395,19 @@ int32_t CWelsPreProcess::SingleLayerPreprocess (sWelsEncCtx* pCtx, const SSource
   m_pLastSpatialPicture[iDependencyId][1]	= m_pSpatialPic[iDependencyId][iPicturePos];
   -- iDependencyId;
 
-  // generate other spacial layer
-  // pSrc is
-  //	-- padded input pic, if downsample should be applied to generate highest layer, [if] block above
-  //	-- highest layer, if no downsampling, [else] block above
+  // other spacial layers, already downsampled together with the highest one unless prepared ahead
   if (pSvcParam->iSpatialLayerNum > 1) {
     while (iDependencyId >= 0) {
       pDlayerParam			= &pSvcParam->sDependencyLayers[iDependencyId];
-      iTargetWidth	= pDlayerParam->iFrameWidth;
-      iTargetHeight	= pDlayerParam->iFrameHeight;
       iTemporalId = pDlayerParam->uiCodingIdx2TemporalId[pCtx->iCodingIndex & (pSvcParam->uiGopSize - 1)];
       iPicturePos		= m_uiSpatialLayersInTemporal[iDependencyId] - 1;
 
       // NOT work for CGS, FIXME
       // spatial layer is able to encode indeed
       if ((iTemporalId != INVALID_TEMPORAL_ID)) {
-        // down sampling performed
-
         pDstPic	= m_pSpatialPic[iDependencyId][iPicturePos];	// small
-        iShrinkWidth = pScaledPicture->iScaledWidth[iDependencyId];
-        iShrinkHeight = pScaledPicture->iScaledHeight[iDependencyId];
-        DownsamplePadding (pSrcPic, pDstPic, iSrcWidth, iSrcHeight, iShrinkWidth, iShrinkHeight, iTargetWidth, iTargetHeight);
+        if (NULL != pPrepared)
+          WelsExchangePictureData (pDstPic, pPrepared->pLayerPic[iDependencyId]);
 
         WelsUpdateSpatialIdxMap (pCtx, iActualSpatialLayerNum - 1, pDstPic, iDependencyId);
 
@@ -390,6 +424,94 @@ int32_t CWelsPreProcess::SingleLayerPreprocess (sWelsEncCtx* pCtx, const SSource
 }
 
 
+int32_t CWelsPreProcess::InitSourcePreparation (sWelsEncCtx* pCtx) {
+  if (m_pPrepInterfaceVp != NULL)
+    return 0;
+
+  // own instance so that the preparing thread does not contend with the analysis of the coding thread
+  CreateVpInterface ((void**) &m_pPrepInterfaceVp, WELSVP_INTERFACE_VERION);
+  WELS_VERIFY_RETURN_IF (1, (NULL == m_pPrepInterfaceVp))
+  int32_t iStripeNum = pCtx->pSvcParam->iCountThreadsNum;
+  m_pPrepInterfaceVp->Set (METHOD_COLORSPACE_CONVERT | METHOD_FLAG_STRIPE_THREADS, &iStripeNum);
+  m_pPrepInterfaceVp->Set (METHOD_DOWNSAMPLE | METHOD_FLAG_STRIPE_THREADS, &iStripeNum);
+  if (WelsInitScaledPic (pCtx->pSvcParam, &m_sPrepScaledPicture, pCtx->pMemAlign) != 0) {
+    UninitSourcePreparation (pCtx);
+    return 1;
+  }
+  return 0;
+}
+
+void CWelsPreProcess::UninitSourcePreparation (sWelsEncCtx* pCtx) {
+  FreeScaledPic (&m_sPrepScaledPicture, pCtx->pMemAlign);
+  memset (&m_sPrepScaledPicture, 0, sizeof (m_sPrepScaledPicture));
+  if (m_pPrepInterfaceVp != NULL) {
+    DestroyVpInterface (m_pPrepInterfaceVp, WELSVP_INTERFACE_VERION);
+    m_pPrepInterfaceVp = NULL;
+  }
+}
+
+int32_t CWelsPreProcess::AllocPreparedPicture (sWelsEncCtx* pCtx, SPreparedPicture* pPrepared) {
+  SWelsSvcCodingParam* pParam	= pCtx->pSvcParam;
+
+  memset (pPrepared, 0, sizeof (SPreparedPicture));
+  for (int32_t i = 0; i < pParam->iSpatialLayerNum; i++) {
+    pPrepared->pLayerPic[i] = AllocPicture (pCtx->pMemAlign, pParam->sDependencyLayers[i].iFrameWidth,
+                                            pParam->sDependencyLayers[i].iFrameHeight, false, 0);
+    WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pPrepared->pLayerPic[i]), FreePreparedPicture (pCtx, pPrepared))
+  }
+  return 0;
+}
+
+void CWelsPreProcess::FreePreparedPicture (sWelsEncCtx* pCtx, SPreparedPicture* pPrepared) {
+  for (int32_t i = 0; i < MAX_DEPENDENCY_LAYER; i++) {
+    if (NULL != pPrepared->pLayerPic[i])
+      FreePicture (pCtx->pMemAlign, &pPrepared->pLayerPic[i]);
+  }
+}
+
+/*
+*	PrepareSourcePicture: the sample processing of SingleLayerPreprocess, for every spatial layer as the temporal
+*	layers to be coded are not known yet
+*	@return:	0 - successful; none 0 - failed
+*/
+int32_t CWelsPreProcess::PrepareSourcePicture (sWelsEncCtx* pCtx, const SSourcePicture* kpSrc,
+    SPreparedPicture* pPrepared) {
+  SWelsSvcCodingParam* pSvcParam	= pCtx->pSvcParam;
+  Scaled_Picture* pScaledPicture	= &m_sPrepScaledPicture;
+  int32_t iDependencyId				= pSvcParam->iSpatialLayerNum - 1;
+  const int32_t kiSrcWidth			= pSvcParam->SUsedPicRect.iWidth;
+  const int32_t kiSrcHeight			= pSvcParam->SUsedPicRect.iHeight;
+  SPicture* pSrcPic					= NULL;
+  SPicture* pDstPic					= pPrepared->pLayerPic[iDependencyId];
+  SPicture* pLayerPic[MAX_DEPENDENCY_LAYER] = { NULL };
+
+  WELS_VERIFY_RETURN_IF (1, (NULL == m_pPrepInterfaceVp))
+
+  pSrcPic = pScaledPicture->pScaledInputPicture ? pScaledPicture->pScaledInputPicture : pDstPic;
+  if (pScaledPicture->pScaledInputPicture)
+    pLayerPic[iDependencyId] = pDstPic;
+  for (int32_t i = 0; i < iDependencyId; i++)
+    pLayerPic[i] = pPrepared->pLayerPic[i];
+
+  if (VIDEO_FORMAT_I420 == (kpSrc->iColorFormat & (~VIDEO_FORMAT_VFlip)))
+    WelsMoveMemoryWrapper (pSvcParam, pSrcPic, kpSrc, kiSrcWidth, kiSrcHeight);
+  else
+    ColorspaceConvert (m_pPrepInterfaceVp, pSvcParam, pScaledPicture, pSrcPic, kpSrc, kiSrcWidth, kiSrcHeight, pLayerPic);
+  ReleaseSource (kpSrc->pData[0]);	// prepared pictures are always copies
+
+  if (pSvcParam->bEnableDenoise)
+    BilateralDenoising (m_pPrepInterfaceVp, pSrcPic, kiSrcWidth, kiSrcHeight);
+
+  if (NULL == pScaledPicture->pScaledInputPicture) {
+    DownsamplePadding (m_pPrepInterfaceVp, pSrcPic, pDstPic, kiSrcWidth, kiSrcHeight, kiSrcWidth, kiSrcHeight,
+                       pSvcParam->sDependencyLayers[iDependencyId].iFrameWidth,
+                       pSvcParam->sDependencyLayers[iDependencyId].iFrameHeight);
+  }
+  DownsampleLayersPadding (m_pPrepInterfaceVp, pSvcParam, pScaledPicture, pSrcPic, pLayerPic);
+  return 0;
+}
+
+
 /*!
  * \brief	Whether input picture need be scaled?
  */
@@ -462,13 +584,99 @@ int32_t CWelsPreProcess::InitLastSpatialPictures (sWelsEncCtx* pCtx) {
 }
 //*********************************************************************************************************/
 
-int32_t CWelsPreProcess::ColorspaceConvert (SWelsSvcCodingParam* pSvcParam, SPicture* pDstPic,
-    const SSourcePicture* kpSrc, const int32_t kiWidth, const int32_t kiHeight) {
-  return 1;
-  //not support yet
+/*!
+ * \brief	convert a NV12, BGRA or RGBA source into pDstPic of kiTargetWidth x kiTargetHeight as
+ *			WelsMoveMemoryWrapper() copies I420 ones; a layer of pLayerPic[] that is the dyadic downsample of it is
+ *			made in the same pass over the source and taken out of pLayerPic[]
+ * \return	0 - successful; none 0 - failed
+ */
+int32_t CWelsPreProcess::ColorspaceConvert (IWelsVP* pVp, SWelsSvcCodingParam* pSvcParam,
+    Scaled_Picture* pScaledPicture, SPicture* pDstPic, const SSourcePicture* kpSrc, const int32_t kiTargetWidth,
+    const int32_t kiTargetHeight, SPicture* pLayerPic[MAX_DEPENDENCY_LAYER]) {
+  const int32_t kiFormat = kpSrc->iColorFormat & (~VIDEO_FORMAT_VFlip);
+  const bool kbFlip = (kpSrc->iColorFormat & VIDEO_FORMAT_VFlip) != 0;
+  const int32_t kiBytesPerPixel = (VIDEO_FORMAT_NV12 == kiFormat) ? 1 : 4;
+  const int32_t kiSrcLeft = pSvcParam->SUsedPicRect.iLeft;
+  int32_t iSrcWidth = WELS_MIN (kpSrc->iPicWidth, kiTargetWidth);
+  int32_t iSrcHeight = WELS_MIN (kpSrc->iPicHeight, kiTargetHeight);
+  int32_t iHalfDid = -1;
+  SPixMap sSrcPixMap;
+  SColorspaceConvertLayers sLayers;
+
+  if (NULL == pVp || (VIDEO_FORMAT_NV12 != kiFormat && VIDEO_FORMAT_BGRA != kiFormat && VIDEO_FORMAT_RGBA != kiFormat))
+    return 1;
+  iSrcWidth -= (iSrcWidth & 1);
+  iSrcHeight -= (iSrcHeight & 1);
+  if (iSrcWidth <= 0 || iSrcHeight <= 0 || (kiSrcLeft + iSrcWidth) * kiBytesPerPixel > kpSrc->iStride[0])
+    return 1;
+  // rows of the used rectangle counted in memory order
+  const int32_t kiSrcTop = kbFlip ? kpSrc->iPicHeight - pSvcParam->SUsedPicRect.iTop - iSrcHeight :
+                           pSvcParam->SUsedPicRect.iTop;
+  if (kiSrcTop < 0)
+    return 1;
+
+  memset (&sSrcPixMap, 0, sizeof (sSrcPixMap));
+  sSrcPixMap.pPixel[0]   = kpSrc->pData[0] + kpSrc->iStride[0] * kiSrcTop + kiSrcLeft * kiBytesPerPixel;
+  sSrcPixMap.iStride[0]  = kpSrc->iStride[0];
+  if (VIDEO_FORMAT_NV12 == kiFormat) {
+    sSrcPixMap.pPixel[1]  = kpSrc->pData[1] + kpSrc->iStride[1] * (kiSrcTop >> 1) + (kiSrcLeft & (~1));
+    sSrcPixMap.iStride[1] = kpSrc->iStride[1];
+  }
+  sSrcPixMap.iSizeInBits = g_kiPixMapSizeInBits * kiBytesPerPixel;
+  sSrcPixMap.sRect.iRectWidth  = iSrcWidth;
+  sSrcPixMap.sRect.iRectHeight = iSrcHeight;
+  sSrcPixMap.eFormat     = (EVideoFormat)kpSrc->iColorFormat;
+
+  memset (&sLayers, 0, sizeof (sLayers));
+  for (int32_t i = 0; i < 3; i++) {
+    sLayers.sDstPicMap.pPixel[i]  = pDstPic->pData[i];
+    sLayers.sDstPicMap.iStride[i] = pDstPic->iLineSize[i];
+  }
+  sLayers.sDstPicMap.iSizeInBits = g_kiPixMapSizeInBits;
+  sLayers.sDstPicMap.sRect.iRectWidth  = iSrcWidth;
+  sLayers.sDstPicMap.sRect.iRectHeight = iSrcHeight;
+  sLayers.sDstPicMap.eFormat     = VIDEO_FORMAT_I420;
+
+  // the denoised picture is what the layers are sampled from, otherwise the halved one can be made on the way
+  if (!pSvcParam->bEnableDenoise && iSrcWidth == kiTargetWidth && iSrcHeight == kiTargetHeight) {
+    for (int32_t i = 0; i < pSvcParam->iSpatialLayerNum; i++) {
+      if (NULL != pLayerPic[i] && pScaledPicture->iScaledWidth[i] == (kiTargetWidth >> 1)
+          && pScaledPicture->iScaledHeight[i] == (kiTargetHeight >> 1)) {
+        iHalfDid = i;
+        for (int32_t k = 0; k < 3; k++) {
+          sLayers.sHalfPicMap.pPixel[k]  = pLayerPic[i]->pData[k];
+          sLayers.sHalfPicMap.iStride[k] = pLayerPic[i]->iLineSize[k];
+        }
+        sLayers.sHalfPicMap.iSizeInBits = g_kiPixMapSizeInBits;
+        sLayers.sHalfPicMap.sRect.iRectWidth  = kiTargetWidth >> 1;
+        sLayers.sHalfPicMap.sRect.iRectHeight = kiTargetHeight >> 1;
+        sLayers.sHalfPicMap.eFormat     = VIDEO_FORMAT_I420;
+        break;
+      }
+    }
+  }
+
+  if (RET_SUCCESS != pVp->SpecialFeature (METHOD_COLORSPACE_CONVERT, &sSrcPixMap, &sLayers))
+    return 1;
+
+  if (kiTargetWidth > iSrcWidth || kiTargetHeight > iSrcHeight) {
+    Padding (pDstPic->pData[0], pDstPic->pData[1], pDstPic->pData[2], pDstPic->iLineSize[0], pDstPic->iLineSize[1],
+             iSrcWidth, kiTargetWidth, iSrcHeight, kiTargetHeight);
+  }
+  if (iHalfDid >= 0) {
+    const SPixMap* kpHalf = &sLayers.sHalfPicMap;
+    // get rid of odd line
+    const int32_t kiShrinkWidth = kpHalf->sRect.iRectWidth - (kpHalf->sRect.iRectWidth & 1);
+    const int32_t kiShrinkHeight = kpHalf->sRect.iRectHeight - (kpHalf->sRect.iRectHeight & 1);
+    Padding ((uint8_t*)kpHalf->pPixel[0], (uint8_t*)kpHalf->pPixel[1], (uint8_t*)kpHalf->pPixel[2], kpHalf->iStride[0],
+             kpHalf->iStride[1], kiShrinkWidth, pSvcParam->sDependencyLayers[iHalfDid].iFrameWidth, kiShrinkHeight,
+             pSvcParam->sDependencyLayers[iHalfDid].iFrameHeight);
+    pLayerPic[iHalfDid] = NULL;
+  }
+  return 0;
 }
 
-void CWelsPreProcess::BilateralDenoising (SPicture* pSrc, const int32_t kiWidth, const int32_t kiHeight) {
+void CWelsPreProcess::BilateralDenoising (IWelsVP* pVp, SPicture* pSrc, const int32_t kiWidth, const int32_t kiHeight) {
   int32_t iMethodIdx = METHOD_DENOISE;
   SPixMap sSrcPixMap;
   memset (&sSrcPixMap, 0, sizeof (sSrcPixMap));
@@ -483,7 +691,7 @@ void CWelsPreProcess::BilateralDenoising (SPicture* pSrc, const int32_t kiWidth,
   sSrcPixMap.iStride[2] = pSrc->iLineSize[2];
   sSrcPixMap.eFormat = VIDEO_FORMAT_I420;
 
-  m_pInterfaceVp->Process (iMethodIdx, &sSrcPixMap, NULL);
+  pVp->Process (iMethodIdx, &sSrcPixMap, NULL);
 }
 
 bool CWelsPreProcess::DetectSceneChange (SPicture* pCurPicture, SPicture* pRefPicture) {
@@ -518,7 +726,8 @@ bool CWelsPreProcess::DetectSceneChange (SPicture* pCurPicture, SPicture* pRefPi
   return bSceneChangeFlag;
 }
 
-int32_t CWelsPreProcess::DownsamplePadding (SPicture* pSrc, SPicture* pDstPic,  int32_t iSrcWidth, int32_t iSrcHeight,
+int32_t CWelsPreProcess::DownsamplePadding (IWelsVP* pVp, SPicture* pSrc, SPicture* pDstPic,  int32_t iSrcWidth,
+    int32_t iSrcHeight,
     int32_t iShrinkWidth, int32_t iShrinkHeight, int32_t iTargetWidth, int32_t iTargetHeight) {
   int32_t iRet = 0;
   SPixMap sSrcPixMap;
@@ -549,7 +758,7 @@ int32_t CWelsPreProcess::DownsamplePadding (SPicture* pSrc, SPicture* pDstPic,
     sDstPicMap.iStride[2]  = pDstPic->iLineSize[2];
     sDstPicMap.eFormat     = VIDEO_FORMAT_I420;
 
-    iRet = m_pInterfaceVp->Process (iMethodIdx, &sSrcPixMap, &sDstPicMap);
+    iRet = pVp->Process (iMethodIdx, &sSrcPixMap, &sDstPicMap);
   } else {
     memcpy (&sDstPicMap, &sSrcPixMap, sizeof (sDstPicMap));	// confirmed_safe_unsafe_usage
   }
@@ -563,6 +772,73 @@ int32_t CWelsPreProcess::DownsamplePadding (SPicture* pSrc, SPicture* pDstPic,
   return iRet;
 }
 
+/*!
+ * \brief	downsample pSrc into every non NULL pDstPic[] in one pass and pad them, the ratios are taken from
+ *			pScaledPicture; a layer that is not smaller than the source goes through DownsamplePadding()
+ */
+int32_t CWelsPreProcess::DownsampleLayersPadding (IWelsVP* pVp, SWelsSvcCodingParam* pSvcParam,
+    Scaled_Picture* pScaledPicture, SPicture* pSrc, SPicture* pDstPic[MAX_DEPENDENCY_LAYER]) {
+  const int32_t kiSrcWidth	= pSvcParam->SUsedPicRect.iWidth;
+  const int32_t kiSrcHeight	= pSvcParam->SUsedPicRect.iHeight;
+  int32_t iLayerDid[MAX_DEPENDENCY_LAYER];
+  int32_t iRet = 0;
+  SPixMap sSrcPixMap;
+  SDownsampleLayers sLayers;
+  memset (&sSrcPixMap, 0, sizeof (sSrcPixMap));
+  memset (&sLayers, 0, sizeof (sLayers));
+  sSrcPixMap.pPixel[0]   = pSrc->pData[0];
+  sSrcPixMap.pPixel[1]   = pSrc->pData[1];
+  sSrcPixMap.pPixel[2]   = pSrc->pData[2];
+  sSrcPixMap.iSizeInBits = g_kiPixMapSizeInBits;
+  sSrcPixMap.sRect.iRectWidth  = kiSrcWidth;
+  sSrcPixMap.sRect.iRectHeight = kiSrcHeight;
+  sSrcPixMap.iStride[0]  = pSrc->iLineSize[0];
+  sSrcPixMap.iStride[1]  = pSrc->iLineSize[1];
+  sSrcPixMap.iStride[2]  = pSrc->iLineSize[2];
+  sSrcPixMap.eFormat     = VIDEO_FORMAT_I420;
+
+  for (int32_t i = pSvcParam->iSpatialLayerNum - 1; i >= 0; i--) {
+    const int32_t kiShrinkWidth = pScaledPicture->iScaledWidth[i];
+    const int32_t kiShrinkHeight = pScaledPicture->iScaledHeight[i];
+    if (NULL == pDstPic[i])
+      continue;
+    if (kiShrinkWidth >= kiSrcWidth || kiShrinkHeight >= kiSrcHeight) {
+      iRet |= DownsamplePadding (pVp, pSrc, pDstPic[i], kiSrcWidth, kiSrcHeight, kiShrinkWidth, kiShrinkHeight,
+                                 pSvcParam->sDependencyLayers[i].iFrameWidth, pSvcParam->sDependencyLayers[i].iFrameHeight);
+      continue;
+    }
+
+    SPixMap* pDstPicMap = &sLayers.sDstPicMap[sLayers.iLayerNum];
+    pDstPicMap->pPixel[0]   = pDstPic[i]->pData[0];
+    pDstPicMap->pPixel[1]   = pDstPic[i]->pData[1];
+    pDstPicMap->pPixel[2]   = pDstPic[i]->pData[2];
+    pDstPicMap->iSizeInBits = g_kiPixMapSizeInBits;
+    pDstPicMap->sRect.iRectWidth  = kiShrinkWidth;
+    pDstPicMap->sRect.iRectHeight = kiShrinkHeight;
+    pDstPicMap->iStride[0]  = pDstPic[i]->iLineSize[0];
+    pDstPicMap->iStride[1]  = pDstPic[i]->iLineSize[1];
+    pDstPicMap->iStride[2]  = pDstPic[i]->iLineSize[2];
+    pDstPicMap->eFormat     = VIDEO_FORMAT_I420;
+    iLayerDid[sLayers.iLayerNum++] = i;
+  }
+  if (0 == sLayers.iLayerNum)
+    return iRet;
+
+  iRet |= pVp->SpecialFeature (METHOD_DOWNSAMPLE, &sSrcPixMap, &sLayers);
+
+  for (int32_t k = 0; k < sLayers.iLayerNum; k++) {
+    const int32_t kiDid = iLayerDid[k];
+    SPixMap* pDstPicMap = &sLayers.sDstPicMap[k];
+    // get rid of odd line
+    const int32_t kiShrinkWidth = pDstPicMap->sRect.iRectWidth - (pDstPicMap->sRect.iRectWidth & 1);
+    const int32_t kiShrinkHeight = pDstPicMap->sRect.iRectHeight - (pDstPicMap->sRect.iRectHeight & 1);
+    Padding ((uint8_t*)pDstPicMap->pPixel[0], (uint8_t*)pDstPicMap->pPixel[1], (uint8_t*)pDstPicMap->pPixel[2],
+             pDstPicMap->iStride[0], pDstPicMap->iStride[1], kiShrinkWidth, pSvcParam->sDependencyLayers[kiDid].iFrameWidth,
+             kiShrinkHeight, pSvcParam->sDependencyLayers[kiDid].iFrameHeight);
+  }
+  return iRet;
+}
+
 //*********************************************************************************************************/
 void CWelsPreProcess::VaaCalculation (SVAAFrameInfo* pVaaInfo, SPicture* pCurPicture, SPicture* pRefPicture,
                                       bool bCalculateSQDiff, bool bCalculateVar, bool bCalculateBGD) {
@@ -1124,6 +1400,74 @@ void  WelsMoveMemory_c (uint8_t* pDstY, uint8_t* pDstU, uint8_t* pDstV,  int32_t
   }
 }
 
+void CWelsPreProcess::SetZeroCopySource (const SZeroCopySource* kpZeroCopy) {
+  // pictures still referenced are copied in and passed back to the callback they were given with
+  for (int32_t j = 0; j < MAX_DEPENDENCY_LAYER; j++) {
+    for (int32_t i = 0; i < m_uiSpatialPicNum[j]; i++) {
+      SPicture* pPic = m_pSpatialPic[j][i];
+      if (NULL == pPic || !pPic->bExternalData)
+        continue;
+      uint8_t* pData[3] = { pPic->pData[0], pPic->pData[1], pPic->pData[2] };
+      WelsUnreferencePictureData (pPic);
+      WelsMoveMemory_c (pPic->pData[0], pPic->pData[1], pPic->pData[2], pPic->iLineSize[0], pPic->iLineSize[1],
+                        pData[0], pData[1], pData[2], pPic->iLineSize[0], pPic->iLineSize[1],
+                        pPic->iWidthInPixel, pPic->iHeightInPixel);
+      ReleaseSource (pData[0]);
+    }
+  }
+  m_sZeroCopySource.pCtx				= kpZeroCopy->pCtx;
+  m_sZeroCopySource.pReleaseSource	= kpZeroCopy->pReleaseSource;
+}
+
+void CWelsPreProcess::GetZeroCopySource (sWelsEncCtx* pCtx, SZeroCopySource* pZeroCopy) {
+  const SPicture* kpPic = m_pSpatialPic[pCtx->pSvcParam->iSpatialLayerNum - 1][0];
+
+  *pZeroCopy	= m_sZeroCopySource;
+  pZeroCopy->iStride[0]	= kpPic ? kpPic->iLineSize[0] : 0;
+  pZeroCopy->iStride[1]	= kpPic ? kpPic->iLineSize[1] : 0;
+  pZeroCopy->iPadding	= PADDING_LENGTH;
+}
+
+/*
+ *	let pDstPic refer to the planes of kpSrc if they can be coded as they are, which leaves pDstPic unchanged by
+ *	denoising and padding
+ */
+bool CWelsPreProcess::ReferenceSource (sWelsEncCtx* pCtx, SPicture* pDstPic, const SSourcePicture* kpSrc) {
+  SWelsSvcCodingParam* pSvcParam = pCtx->pSvcParam;
+  const SDLayerParam* kpDlayerParam = &pSvcParam->sDependencyLayers[pSvcParam->iSpatialLayerNum - 1];
+
+  if (NULL == m_sZeroCopySource.pReleaseSource || pSvcParam->bEnableDenoise)
+    return false;
+  if (VIDEO_FORMAT_I420 != kpSrc->iColorFormat)
+    return false;
+  if (pSvcParam->SUsedPicRect.iLeft != 0 || pSvcParam->SUsedPicRect.iTop != 0
+      || kpSrc->iPicWidth != kpDlayerParam->iFrameWidth || kpSrc->iPicHeight != kpDlayerParam->iFrameHeight
+      || pSvcParam->SUsedPicRect.iWidth != kpDlayerParam->iFrameWidth
+      || pSvcParam->SUsedPicRect.iHeight != kpDlayerParam->iFrameHeight
+      || (kpSrc->iPicWidth & 15) != 0 || (kpSrc->iPicHeight & 15) != 0)
+    return false;
+  for (int32_t i = 0; i < 3; i++) {
+    if (kpSrc->iStride[i] != pDstPic->iLineSize[i] || ((uintptr_t)kpSrc->pData[i] & 15) != 0)
+      return false;
+  }
+
+  uint8_t* pData[3] = { kpSrc->pData[0], kpSrc->pData[1], kpSrc->pData[2] };
+  WelsReferencePictureData (pDstPic, pData);
+  return true;
+}
+
+/* hand a source picture back to the application */
+void CWelsPreProcess::ReleaseSource (uint8_t* pData) {
+  if (NULL != m_sZeroCopySource.pReleaseSource)
+    m_sZeroCopySource.pReleaseSource (m_sZeroCopySource.pCtx, pData);
+}
+
+void CWelsPreProcess::ReleaseSourcePicture (SPicture* pPic) {
+  uint8_t* pData = WelsUnreferencePictureData (pPic);
+  if (NULL != pData)
+    ReleaseSource (pData);
+}
+
 void  CWelsPreProcess::WelsMoveMemoryWrapper (SWelsSvcCodingParam* pSvcParam, SPicture* pDstPic,
     const SSourcePicture* kpSrc,
     const int32_t kiTargetWidth, const int32_t kiTargetHeight) {
@@ -64,7 +64,7 @@ class CWelsH264SVCEncoder : public ISVCEncoder {
 
   /* Interfaces override from ISVCEncoder */
   /*
-   * return: CM_RETURN: 0 - success; otherwise - failed;
+   * return: CM_RETURN: 0 - success; cmOutputPending - get encoded frames before reinitializing; otherwise - failed;
    */
   virtual int EXTAPI Initialize (const SEncParamBase* argv);
   virtual int EXTAPI InitializeExt (const SEncParamExt* argv);
@@ -98,11 +98,17 @@ class CWelsH264SVCEncoder : public ISVCEncoder {
    * InDataFormat, IDRInterval, SVC Encode Param, Frame Rate, Bitrate,..
    ************************************************************************/
   /*
-   * return: CM_RETURN: 0 - success; otherwise - failed;
+   * return: CM_RETURN: 0 - success; cmOutputPending - get encoded frames before a reset of the encoder; otherwise - failed;
    */
   virtual int EXTAPI SetOption (ENCODER_OPTION opt_id, void* option);
   virtual int EXTAPI GetOption (ENCODER_OPTION opt_id, void* option);
 
+  /*
+   * return: CM_RETURN: 0 - success; cmOutputPending - get encoded frames first; otherwise - failed;
+   */
+  virtual int EXTAPI SubmitFrame (const SSourcePicture* kpSrcPic);
+  virtual int EXTAPI GetEncodedFrame (SFrameBSInfo* pBsInfo, bool bWait);
+
  private:
   int InitializeInternal (SWelsSvcCodingParam* argv);
 
@@ -33,6 +33,7 @@
 #include <assert.h>
 #include "welsEncoderExt.h"
 #include "welsCodecTrace.h"
+#include "enc_pipeline.h"
 #include "typedefs.h"
 #include "wels_const.h"
 #include "utils.h"
@@ -247,6 +248,11 @@ int CWelsH264SVCEncoder::InitializeInternal(SWelsSvcCodingParam* pCfg) {
   }
 
   if (m_bInitialFlag) {
+    if (PendingPipelineFrames (m_pEncContext)) {
+      WelsLog (m_pEncContext, WELS_LOG_WARNING,
+               "CWelsH264SVCEncoder::Initialize(), reinitialize refused, submitted frames not fetched yet.\n");
+      return cmOutputPending;
+    }
     WelsLog (m_pEncContext, WELS_LOG_WARNING, "CWelsH264SVCEncoder::Initialize(), reinitialize, m_bInitialFlag= %d.\n",
              m_bInitialFlag);
     Uninitialize();
@@ -294,7 +300,9 @@ int CWelsH264SVCEncoder::InitializeInternal(SWelsSvcCodingParam* pCfg) {
 #endif//REC_FRAME_COUNT
 
   const int32_t iColorspace = pCfg->iInputCsp;
-  if (videoFormatI420 != iColorspace) {
+  // other than I420 the sources are converted in the preprocessing
+  if (videoFormatI420 != iColorspace && videoFormatNV12 != iColorspace && videoFormatBGRA != iColorspace
+      && videoFormatRGBA != iColorspace) {
     WelsLog (m_pEncContext, WELS_LOG_ERROR, "CWelsH264SVCEncoder::Initialize(), invalid iInputCsp= %d.\n", iColorspace);
     Uninitialize();
     return cmInitParaError;
@@ -426,6 +434,7 @@ int CWelsH264SVCEncoder::EncodeFrame (const SSourcePicture* kpSrcPic, SFrameBSIn
     return cmInitParaError;
   }
 
+  DrainEncPipeline (m_pEncContext);
   const int32_t kiEncoderReturn = EncodeFrameInternal(kpSrcPic, pBsInfo);
 
   if(kiEncoderReturn != cmResultSuccess)
@@ -507,6 +516,7 @@ int CWelsH264SVCEncoder::EncodeFrameInternal(const SSourcePicture*  pSrcPic, SFr
 }
 
 int CWelsH264SVCEncoder::EncodeParameterSets (SFrameBSInfo* pBsInfo) {
+    DrainEncPipeline (m_pEncContext);
     return WelsEncoderEncodeParameterSets (m_pEncContext, pBsInfo);
 }
 
@@ -516,6 +526,7 @@ int CWelsH264SVCEncoder::EncodeParameterSets (SFrameBSInfo* pBsInfo) {
 int CWelsH264SVCEncoder::PauseFrame (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo) {
   int32_t  iReturn = 1;
 
+  DrainEncPipeline (m_pEncContext);
   ForceIntraFrame (true);
 
   if (EncodeFrameInternal (kpSrcPic, pBsInfo) != videoFrameTypeInvalid) {
@@ -531,6 +542,46 @@ int CWelsH264SVCEncoder::PauseFrame (const SSourcePicture* kpSrcPic, SFrameBSInf
 }
 
 
+/*
+ *	Pipelined encoding
+ */
+int CWelsH264SVCEncoder::SubmitFrame (const SSourcePicture* kpSrcPic) {
+  if (! (kpSrcPic && m_pEncContext && m_bInitialFlag)) {
+    return cmInitParaError;
+  }
+
+  const int32_t kiEncoderReturn = SubmitPipelineFrame (m_pEncContext, kpSrcPic);
+  switch (kiEncoderReturn) {
+  case ENC_RETURN_SUCCESS:
+    return cmResultSuccess;
+  case ENC_RETURN_UNEXPECTED:	// every slot is in use
+    return cmOutputPending;
+  case ENC_RETURN_MEMALLOCERR:
+    return cmMallocMemeError;
+  case ENC_RETURN_UNSUPPORTED_PARA:
+    return cmUnsupportedData;
+  default:
+    return cmInitParaError;
+  }
+}
+
+int CWelsH264SVCEncoder::GetEncodedFrame (SFrameBSInfo* pBsInfo, bool bWait) {
+  if (! (pBsInfo && m_pEncContext && m_bInitialFlag)) {
+    return cmInitParaError;
+  }
+
+  const int32_t kiEncoderReturn = FetchPipelineFrame (m_pEncContext, pBsInfo, bWait);
+  if (kiEncoderReturn == ENC_RETURN_MEMALLOCERR) {
+    WelsUninitEncoderExt (&m_pEncContext);
+    return cmMallocMemeError;
+  } else if (kiEncoderReturn == ENC_RETURN_CORRECTED) {
+    WelsLog (m_pEncContext, WELS_LOG_ERROR, "unexpected return(%d) from FetchPipelineFrame()!\n", kiEncoderReturn);
+    return cmUnkonwReason;
+  }
+
+  return cmResultSuccess;
+}
+
 /*
  *	Force key frame
  */
@@ -545,6 +596,7 @@ int CWelsH264SVCEncoder::ForceIntraFrame (bool bIDR) {
            m_uiCountFrameNum, m_iCspInternal);
 #endif//REC_FRAME_COUNT
 
+  DrainEncPipeline (m_pEncContext);
   ForceCodingIDR (m_pEncContext);
 
   return 0;
@@ -562,6 +614,7 @@ int CWelsH264SVCEncoder::SetOption (ENCODER_OPTION eOptionId, void* pOption) {
     return cmInitExpected;
   }
 
+  DrainEncPipeline (m_pEncContext);
   switch (eOptionId) {
   case ENCODER_OPTION_INTER_SPATIAL_PRED: {	// Inter spatial layer prediction flag
     WelsLog (m_pEncContext, WELS_LOG_INFO, "ENCODER_OPTION_INTER_SPATIAL_PRED, this feature not supported at present.\n");
@@ -689,7 +742,8 @@ int CWelsH264SVCEncoder::SetOption (ENCODER_OPTION eOptionId, void* pOption) {
     sConfig.DetermineTemporalSettings();
 
     /* Check every field whether there is new request for memory block changed or else, Oct. 24, 2008 */
-    WelsEncoderParamAdjust (&m_pEncContext, &sConfig);
+    if (WelsEncoderParamAdjust (&m_pEncContext, &sConfig) == ENC_RETURN_UNEXPECTED)
+      return cmOutputPending;
   }
   break;
   case ENCODER_OPTION_FRAME_RATE: {	// Maximal input frame rate
@@ -861,6 +915,10 @@ int CWelsH264SVCEncoder::SetOption (ENCODER_OPTION eOptionId, void* pOption) {
 	}
   }
   break;
+  case ENCODER_OPTION_ZERO_COPY_SOURCE: {
+    m_pEncContext->pVpp->SetZeroCopySource (static_cast<SZeroCopySource*> (pOption));
+  }
+  break;
   default:
     return cmInitParaError;
   }
@@ -876,6 +934,7 @@ int CWelsH264SVCEncoder::GetOption (ENCODER_OPTION eOptionId, void* pOption) {
     return cmInitExpected;
   }
 
+  DrainEncPipeline (m_pEncContext);
   switch (eOptionId) {
   case ENCODER_OPTION_INTER_SPATIAL_PRED: {	// Inter spatial layer prediction flag
     WelsLog (m_pEncContext, WELS_LOG_INFO, "ENCODER_OPTION_INTER_SPATIAL_PRED, this feature not supported at present.\n");
@@ -959,6 +1018,17 @@ int CWelsH264SVCEncoder::GetOption (ENCODER_OPTION eOptionId, void* pOption) {
 	}
   }
   break;
+  case ENCODER_OPTION_MEMORY_USAGE: {	// Memory allocated by the encoder
+    SMemoryUsage* pUsage = static_cast<SMemoryUsage*> (pOption);
+    pUsage->uiCurrentBytes	= m_pEncContext->pMemAlign->WelsGetMemoryUsage();
+    pUsage->uiPeakBytes		= m_pEncContext->pMemAlign->WelsGetPeakMemoryUsage();
+    pUsage->uiIdleBytes		= m_pEncContext->pMemAlign->WelsGetIdleMemoryUsage();
+  }
+  break;
+  case ENCODER_OPTION_ZERO_COPY_SOURCE: {
+    m_pEncContext->pVpp->GetZeroCopySource (m_pEncContext, static_cast<SZeroCopySource*> (pOption));
+  }
+  break;
   default:
     return cmInitParaError;
   }
@@ -3,6 +3,7 @@ ENCODER_CPP_SRCS=\
 	$(ENCODER_SRCDIR)/core/src/au_set.cpp\
 	$(ENCODER_SRCDIR)/core/src/deblocking.cpp\
 	$(ENCODER_SRCDIR)/core/src/decode_mb_aux.cpp\
+	$(ENCODER_SRCDIR)/core/src/enc_pipeline.cpp\
 	$(ENCODER_SRCDIR)/core/src/encode_mb_aux.cpp\
 	$(ENCODER_SRCDIR)/core/src/encoder.cpp\
 	$(ENCODER_SRCDIR)/core/src/encoder_data_tables.cpp\
@@ -11,7 +12,6 @@ ENCODER_CPP_SRCS=\
 	$(ENCODER_SRCDIR)/core/src/get_intra_predictor.cpp\
 	$(ENCODER_SRCDIR)/core/src/mc.cpp\
 	$(ENCODER_SRCDIR)/core/src/md.cpp\
-	$(ENCODER_SRCDIR)/core/src/memory_align.cpp\
 	$(ENCODER_SRCDIR)/core/src/mv_pred.cpp\
 	$(ENCODER_SRCDIR)/core/src/nal_encap.cpp\
 	$(ENCODER_SRCDIR)/core/src/picture_handle.cpp\
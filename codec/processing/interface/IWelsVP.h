@@ -120,7 +120,7 @@ typedef struct {
 
 typedef enum {
   METHOD_NULL              = 0,
-  METHOD_COLORSPACE_CONVERT    ,//not support yet
+  METHOD_COLORSPACE_CONVERT    ,
   METHOD_DENOISE              ,
   METHOD_SCENE_CHANGE_DETECTION_VIDEO ,
   METHOD_SCENE_CHANGE_DETECTION_SCREEN ,
@@ -135,6 +135,11 @@ typedef enum {
   METHOD_MASK
 } EMethods;
 
+// or'ed to the method given to Set()/Get(), pParam is then an int: the number of threads one picture of
+// that method may be split across in horizontal stripes, 1 (default) keeps it on the calling thread;
+// METHOD_COLORSPACE_CONVERT, METHOD_DOWNSAMPLE and METHOD_VAA_STATISTICS honour it
+#define METHOD_FLAG_STRIPE_THREADS 0x0100
+
 //-----------------------------------------------------------------//
 //  Algorithm parameters define
 //-----------------------------------------------------------------//
@@ -146,6 +151,23 @@ typedef struct{
   bool bScrollDetectFlag; // 0:false ; 1:ltr; 2: scene change
 } SScrollDetectionParam;
 
+#define MAX_DOWNSAMPLE_LAYER_NUM 4
+
+// METHOD_DOWNSAMPLE via SpecialFeature(): pIn is the source SPixMap, pOut this struct; all layers are
+// sampled in one pass over the source rows, each destination must be smaller than the source
+typedef struct {
+  int     iLayerNum;
+  SPixMap sDstPicMap[MAX_DOWNSAMPLE_LAYER_NUM];
+} SDownsampleLayers;
+
+// METHOD_COLORSPACE_CONVERT via SpecialFeature(): pIn is the NV12, BGRA or RGBA source SPixMap (VIDEO_FORMAT_VFlip
+// for bottom-up rows), pOut this struct; sDstPicMap gets the I420 picture of the source size and, unless its
+// pPixel[0] is NULL, sHalfPicMap the dyadic downsample of it as METHOD_DOWNSAMPLE makes it, in one pass over the source
+typedef struct {
+  SPixMap sDstPicMap;
+  SPixMap sHalfPicMap;
+} SColorspaceConvertLayers;
+
 typedef enum {
   SIMILAR_SCENE,   //similar scene
   MEDIUM_CHANGED_SCENE,   //medium changed scene
@@ -0,0 +1,203 @@
+/*!
+ * \copy
+ *     Copyright (c)  2013, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "colorspace.h"
+#include "cpu.h"
+
+WELSVP_NAMESPACE_BEGIN
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CColorspaceConvert::CColorspaceConvert (int32_t iCpuFlag) {
+  m_iCPUFlag = iCpuFlag;
+  m_eMethod   = METHOD_COLORSPACE_CONVERT;
+  WelsMemset (&m_pfColorspace, 0, sizeof (m_pfColorspace));
+  InitColorspaceFuncs (m_pfColorspace, m_iCPUFlag);
+}
+
+CColorspaceConvert::~CColorspaceConvert() {
+}
+
+void CColorspaceConvert::InitColorspaceFuncs (SColorspaceFuncs& sColorspaceFuncs, int32_t iCpuFlag) {
+  sColorspaceFuncs.pfDeinterleaveRow	= DeinterleaveRow_c;
+  sColorspaceFuncs.pfRgbToI420RowPair	= RgbToI420RowPair_c;
+  sColorspaceFuncs.pfHalfAverage		= DyadicBilinearDownsampler_c;
+#if defined(X86_INTRINSICS)
+  if (iCpuFlag & WELS_CPU_SSE2) {
+    sColorspaceFuncs.pfDeinterleaveRow	= DeinterleaveRow_sse2;
+    sColorspaceFuncs.pfRgbToI420RowPair	= RgbToI420RowPair_sse2;
+    sColorspaceFuncs.pfHalfAverage		= DyadicBilinearDownsampler_sse2;
+  }
+  if (iCpuFlag & WELS_CPU_AVX2) {
+    sColorspaceFuncs.pfDeinterleaveRow	= DeinterleaveRow_avx2;
+    sColorspaceFuncs.pfRgbToI420RowPair	= RgbToI420RowPair_avx2;
+    sColorspaceFuncs.pfHalfAverage		= DyadicBilinearDownsampler_avx2;
+  }
+#endif//X86_INTRINSICS
+#if defined(HAVE_NEON)
+  if (iCpuFlag & WELS_CPU_NEON)
+    sColorspaceFuncs.pfHalfAverage		= DyadicBilinearDownsampler_neon;
+#endif//HAVE_NEON
+}
+
+EResult CColorspaceConvert::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* pDstPixMap) {
+  SColorspaceConvertLayers sLayers;
+  WelsMemset (&sLayers, 0, sizeof (sLayers));
+  sLayers.sDstPicMap = *pDstPixMap;
+  return ProcessLayers (pSrcPixMap, &sLayers);
+}
+
+EResult CColorspaceConvert::SpecialFeature (int32_t iType, void* pIn, void* pOut) {
+  if (NULL == pIn || NULL == pOut)
+    return RET_INVALIDPARAM;
+
+  return ProcessLayers ((SPixMap*)pIn, (SColorspaceConvertLayers*)pOut);
+}
+
+typedef struct {
+  const SColorspaceFuncs* pFuncs;
+  const int16_t (*pCoef)[4];	// packed RGB, NULL for NV12
+  const uint8_t* pSrc[2];	// first row of the picture, the row order of VIDEO_FORMAT_VFlip is in the strides
+  int32_t iSrcStride[2];
+  const SPixMap* pDst;
+  const SPixMap* pHalf;		// NULL if not wanted
+  int32_t iWidth;
+  int32_t iRowStart;		// luma rows, a multiple of 4 so that the half chroma rows line up
+  int32_t iRowEnd;
+} SColorspaceStripe;
+
+#define COLORSPACE_BAND_ROWS 16	// luma rows converted before they are halved, the band stays in cache
+
+static void ConvertStripe (void* pArg) {
+  const SColorspaceStripe* pStripe = (const SColorspaceStripe*)pArg;
+  const SColorspaceFuncs* pFuncs = pStripe->pFuncs;
+  const SPixMap* pDst = pStripe->pDst;
+  const SPixMap* pHalf = pStripe->pHalf;
+  const int32_t kiWidth = pStripe->iWidth;
+  uint8_t* pDstY = (uint8_t*)pDst->pPixel[0];
+  uint8_t* pDstU = (uint8_t*)pDst->pPixel[1];
+  uint8_t* pDstV = (uint8_t*)pDst->pPixel[2];
+
+  for (int32_t iBand = pStripe->iRowStart; iBand < pStripe->iRowEnd; iBand += COLORSPACE_BAND_ROWS) {
+    const int32_t kiBandEnd = WELS_MIN (iBand + COLORSPACE_BAND_ROWS, pStripe->iRowEnd);
+    for (int32_t j = iBand; j < kiBandEnd; j += 2) {
+      uint8_t* pY = pDstY + j * pDst->iStride[0];
+      uint8_t* pU = pDstU + (j >> 1) * pDst->iStride[1];
+      uint8_t* pV = pDstV + (j >> 1) * pDst->iStride[2];
+      const uint8_t* pSrc = pStripe->pSrc[0] + j * pStripe->iSrcStride[0];
+      if (NULL == pStripe->pCoef) {
+        WelsMemcpy (pY, pSrc, kiWidth);
+        WelsMemcpy (pY + pDst->iStride[0], pSrc + pStripe->iSrcStride[0], kiWidth);
+        pFuncs->pfDeinterleaveRow (pU, pV, pStripe->pSrc[1] + (j >> 1) * pStripe->iSrcStride[1], kiWidth >> 1);
+      } else {
+        pFuncs->pfRgbToI420RowPair (pY, pY + pDst->iStride[0], pU, pV, pSrc, pSrc + pStripe->iSrcStride[0], kiWidth,
+                                    pStripe->pCoef);
+      }
+    }
+    if (NULL == pHalf)
+      continue;
+
+    // the band just written, its last chroma row is left out when odd as in the whole picture
+    const int32_t kiChromaRow = iBand >> 1;
+    const int32_t kiChromaRows = (kiBandEnd - iBand) >> 1;
+    pFuncs->pfHalfAverage ((uint8_t*)pHalf->pPixel[0] + (iBand >> 1) * pHalf->iStride[0], pHalf->iStride[0],
+                           pDstY + iBand * pDst->iStride[0], pDst->iStride[0], kiWidth, kiBandEnd - iBand);
+    pFuncs->pfHalfAverage ((uint8_t*)pHalf->pPixel[1] + (kiChromaRow >> 1) * pHalf->iStride[1], pHalf->iStride[1],
+                           pDstU + kiChromaRow * pDst->iStride[1], pDst->iStride[1], kiWidth >> 1, kiChromaRows);
+    pFuncs->pfHalfAverage ((uint8_t*)pHalf->pPixel[2] + (kiChromaRow >> 1) * pHalf->iStride[2], pHalf->iStride[2],
+                           pDstV + kiChromaRow * pDst->iStride[2], pDst->iStride[2], kiWidth >> 1, kiChromaRows);
+  }
+}
+
+EResult CColorspaceConvert::ProcessLayers (SPixMap* pSrcPixMap, SColorspaceConvertLayers* pLayers) {
+  SColorspaceStripe sStripes[WELS_THREAD_POOL_MAX_THREADS];
+  const int32_t kiFormat = pSrcPixMap->eFormat & (~VIDEO_FORMAT_VFlip);
+  const bool kbFlip = (pSrcPixMap->eFormat & VIDEO_FORMAT_VFlip) != 0;
+  const int32_t kiSrcWidth = pSrcPixMap->sRect.iRectWidth;
+  const int32_t kiSrcHeight = pSrcPixMap->sRect.iRectHeight;
+  // an odd last column or row is left out as by the copy of I420 sources
+  const int32_t kiWidth = kiSrcWidth & (~1);
+  const int32_t kiHeight = kiSrcHeight & (~1);
+  const SPixMap* pHalf = (NULL != pLayers->sHalfPicMap.pPixel[0]) ? &pLayers->sHalfPicMap : NULL;
+  const int16_t (*pCoef)[4] = NULL;
+  int32_t iPlaneNum = 1;
+
+  switch (kiFormat) {
+  case VIDEO_FORMAT_NV12:
+    iPlaneNum = 2;
+    break;
+  case VIDEO_FORMAT_BGRA:
+    pCoef = g_kBgraCoef;
+    break;
+  case VIDEO_FORMAT_RGBA:
+    pCoef = g_kRgbaCoef;
+    break;
+  default:
+    return RET_NOTSUPPORTED;
+  }
+  if (kiWidth <= 0 || kiHeight <= 0 || VIDEO_FORMAT_I420 != pLayers->sDstPicMap.eFormat)
+    return RET_INVALIDPARAM;
+  if (NULL != pHalf && (kiWidth != kiSrcWidth || kiHeight != kiSrcHeight
+                        || pHalf->sRect.iRectWidth != (kiWidth >> 1) || pHalf->sRect.iRectHeight != (kiHeight >> 1)))
+    return RET_INVALIDPARAM;
+
+  // rows of 4 luma lines spread over the stripes, at least a band each
+  const int32_t kiUnitNum = (kiHeight + 3) >> 2;
+  const int32_t kiStripeNum = WELS_CLAMP (kiHeight / COLORSPACE_BAND_ROWS, 1, m_iStripeNum);
+  SWelsTaskGroup sGroup;
+  WelsMemset (&sGroup, 0, sizeof (sGroup));
+  for (int32_t i = 0; i < kiStripeNum; i++) {
+    SColorspaceStripe* pStripe = &sStripes[i];
+    pStripe->pFuncs	= &m_pfColorspace;
+    pStripe->pCoef	= pCoef;
+    for (int32_t k = 0; k < iPlaneNum; k++) {
+      const int32_t kiStride = pSrcPixMap->iStride[k];
+      const int32_t kiLastRow = (kiHeight >> (k > 0)) - 1;
+      pStripe->pSrc[k]		= (const uint8_t*)pSrcPixMap->pPixel[k] + (kbFlip ? kiLastRow * kiStride : 0);
+      pStripe->iSrcStride[k]	= kbFlip ? -kiStride : kiStride;
+    }
+    pStripe->pDst		= &pLayers->sDstPicMap;
+    pStripe->pHalf		= pHalf;
+    pStripe->iWidth		= kiWidth;
+    pStripe->iRowStart	= (kiUnitNum * i / kiStripeNum) << 2;
+    pStripe->iRowEnd	= WELS_MIN ((kiUnitNum * (i + 1) / kiStripeNum) << 2, kiHeight);
+    if (i > 0)
+      WelsThreadPoolSubmit (m_pThreadPool, &sGroup, ConvertStripe, pStripe);
+  }
+  ConvertStripe (&sStripes[0]);
+  if (kiStripeNum > 1)
+    WelsThreadPoolWait (m_pThreadPool, &sGroup);
+  return RET_SUCCESS;
+}
+
+WELSVP_NAMESPACE_END
@@ -0,0 +1,105 @@
+/*!
+ * \copy
+ *     Copyright (c)  2013, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file	    :  colorspace.h
+ *
+ * \brief	    :  colorspace conversion class of wels video processor class
+ *
+ * \date        :  2026/10/18
+ *
+ * \description :  NV12 and packed 32 bit RGB sources to I420
+ *
+ *************************************************************************************
+ */
+
+#ifndef WELSVP_COLORSPACE_H
+#define WELSVP_COLORSPACE_H
+
+#include "util.h"
+#include "macros.h"
+#include "WelsFrameWork.h"
+#include "IWelsVP.h"
+#include "../downsample/downsample.h"
+
+WELSVP_NAMESPACE_BEGIN
+
+// Y, U and V weights of the bytes of a pixel, BT.601 studio swing in 1/256
+typedef int16_t SRgbCoef[3][4];
+
+// the U and V planes of one NV12 chroma row of kiWidth samples
+typedef void (DeinterleaveRowFunc) (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* pSrcUV, const int32_t kiWidth);
+
+// two rows of kiWidth (even) pixels to two luma rows and one row of each chroma plane
+typedef void (RgbToI420RowPairFunc) (uint8_t* pDstY0, uint8_t* pDstY1, uint8_t* pDstU, uint8_t* pDstV,
+                                     const uint8_t* pSrc0, const uint8_t* pSrc1, const int32_t kiWidth, const SRgbCoef kCoef);
+
+typedef DeinterleaveRowFunc*		PDeinterleaveRowFunc;
+typedef RgbToI420RowPairFunc*	PRgbToI420RowPairFunc;
+
+DeinterleaveRowFunc		DeinterleaveRow_c;
+RgbToI420RowPairFunc	RgbToI420RowPair_c;
+
+#if defined(X86_INTRINSICS)
+DeinterleaveRowFunc		DeinterleaveRow_sse2;
+RgbToI420RowPairFunc	RgbToI420RowPair_sse2;
+DeinterleaveRowFunc		DeinterleaveRow_avx2;
+RgbToI420RowPairFunc	RgbToI420RowPair_avx2;
+#endif//X86_INTRINSICS
+
+extern const SRgbCoef g_kBgraCoef;
+extern const SRgbCoef g_kRgbaCoef;
+
+typedef struct {
+  PDeinterleaveRowFunc	pfDeinterleaveRow;
+  PRgbToI420RowPairFunc	pfRgbToI420RowPair;
+  PHalveDownsampleFunc	pfHalfAverage;	// the fused half picture, same results as METHOD_DOWNSAMPLE
+} SColorspaceFuncs;
+
+class CColorspaceConvert : public IStrategy {
+ public:
+  CColorspaceConvert (int32_t iCpuFlag);
+  ~CColorspaceConvert();
+
+  EResult Process (int32_t iType, SPixMap* pSrc, SPixMap* pDst);
+  // pIn: SPixMap* source, pOut: SColorspaceConvertLayers* I420 picture and its optional half
+  EResult SpecialFeature (int32_t iType, void* pIn, void* pOut);
+
+ private:
+  void InitColorspaceFuncs (SColorspaceFuncs& sColorspaceFuncs, int32_t iCpuFlag);
+  EResult ProcessLayers (SPixMap* pSrc, SColorspaceConvertLayers* pLayers);
+
+ private:
+  SColorspaceFuncs m_pfColorspace;
+  int32_t          m_iCPUFlag;
+};
+
+WELSVP_NAMESPACE_END
+
+#endif
@@ -0,0 +1,266 @@
+/*!
+ * \copy
+ *     Copyright (c)  2013, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  colorspacefuncs.cpp
+ *
+ *  Abstract
+ *      Row kernels converting NV12 and packed 32 bit RGB sources to I420.
+ *
+ *****************************************************************************/
+
+#include "colorspace.h"
+#include "macros.h"
+#if defined(X86_INTRINSICS)
+#include <immintrin.h>
+#endif//X86_INTRINSICS
+
+
+WELSVP_NAMESPACE_BEGIN
+
+// bytes B, G, R, A
+const SRgbCoef g_kBgraCoef = {
+  {  25,  129,   66, 0 },
+  { 112,  -74,  -38, 0 },
+  { -18,  -94,  112, 0 }
+};
+// bytes R, G, B, A
+const SRgbCoef g_kRgbaCoef = {
+  {  66,  129,   25, 0 },
+  { -38,  -74,  112, 0 },
+  { 112,  -94,  -18, 0 }
+};
+
+void DeinterleaveRow_c (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* pSrcUV, const int32_t kiWidth) {
+  for (int32_t i = 0; i < kiWidth; i++) {
+    pDstU[i] = pSrcUV[i << 1];
+    pDstV[i] = pSrcUV[ (i << 1) + 1];
+  }
+}
+
+static inline int32_t WeightPixel (const uint8_t* kpPix, const int16_t* kpCoef) {
+  return (kpCoef[0] * kpPix[0] + kpCoef[1] * kpPix[1] + kpCoef[2] * kpPix[2] + kpCoef[3] * kpPix[3] + 128) >> 8;
+}
+
+/*
+ *	Y = ((66 R + 129 G + 25 B + 128) >> 8) + 16 for every pixel, U and V from the rounded average of each 2x2 block:
+ *	U = ((-38 R - 74 G + 112 B + 128) >> 8) + 128, V = ((112 R - 94 G - 18 B + 128) >> 8) + 128
+ */
+void RgbToI420RowPair_c (uint8_t* pDstY0, uint8_t* pDstY1, uint8_t* pDstU, uint8_t* pDstV,
+                         const uint8_t* pSrc0, const uint8_t* pSrc1, const int32_t kiWidth, const SRgbCoef kCoef) {
+  for (int32_t i = 0; i < kiWidth; i += 2) {
+    const uint8_t* kpPix00 = pSrc0 + (i << 2);
+    const uint8_t* kpPix10 = pSrc1 + (i << 2);
+    uint8_t uiAvg[4];
+    pDstY0[i]     = (uint8_t) (WeightPixel (kpPix00, kCoef[0]) + 16);
+    pDstY0[i + 1] = (uint8_t) (WeightPixel (kpPix00 + 4, kCoef[0]) + 16);
+    pDstY1[i]     = (uint8_t) (WeightPixel (kpPix10, kCoef[0]) + 16);
+    pDstY1[i + 1] = (uint8_t) (WeightPixel (kpPix10 + 4, kCoef[0]) + 16);
+    for (int32_t k = 0; k < 4; k++)
+      uiAvg[k] = (uint8_t) ((kpPix00[k] + kpPix00[4 + k] + kpPix10[k] + kpPix10[4 + k] + 2) >> 2);
+    pDstU[i >> 1] = (uint8_t) (WeightPixel (uiAvg, kCoef[1]) + 128);
+    pDstV[i >> 1] = (uint8_t) (WeightPixel (uiAvg, kCoef[2]) + 128);
+  }
+}
+
+#if defined(X86_INTRINSICS)
+
+WELS_TARGET_SSE2 void DeinterleaveRow_sse2 (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* pSrcUV,
+    const int32_t kiWidth) {
+  const __m128i kxLowBytes = _mm_set1_epi16 (0x00ff);
+  int32_t i = 0;
+  for (; i + 16 <= kiWidth; i += 16) {
+    const __m128i kxUV0 = _mm_loadu_si128 ((const __m128i*) (pSrcUV + (i << 1)));
+    const __m128i kxUV1 = _mm_loadu_si128 ((const __m128i*) (pSrcUV + (i << 1) + 16));
+    _mm_storeu_si128 ((__m128i*) (pDstU + i), _mm_packus_epi16 (_mm_and_si128 (kxUV0, kxLowBytes),
+                      _mm_and_si128 (kxUV1, kxLowBytes)));
+    _mm_storeu_si128 ((__m128i*) (pDstV + i), _mm_packus_epi16 (_mm_srli_epi16 (kxUV0, 8), _mm_srli_epi16 (kxUV1, 8)));
+  }
+  DeinterleaveRow_c (pDstU + i, pDstV + i, pSrcUV + (i << 1), kiWidth - i);
+}
+
+// xLo and xHi hold two pixels each as 16 bit channels, the weighted sums of the four pixels as 32 bit
+static inline WELS_TARGET_SSE2 __m128i WeightPixels4_sse2 (const __m128i kxLo, const __m128i kxHi,
+    const __m128i kxCoef) {
+  const __m128 kfLo = _mm_castsi128_ps (_mm_madd_epi16 (kxLo, kxCoef));
+  const __m128 kfHi = _mm_castsi128_ps (_mm_madd_epi16 (kxHi, kxCoef));
+  return _mm_add_epi32 (_mm_castps_si128 (_mm_shuffle_ps (kfLo, kfHi, _MM_SHUFFLE (2, 0, 2, 0))),
+                        _mm_castps_si128 (_mm_shuffle_ps (kfLo, kfHi, _MM_SHUFFLE (3, 1, 3, 1))));
+}
+
+// (x + 128) >> 8 of the two weighted sums packed to 16 bit with kxOffset added
+static inline WELS_TARGET_SSE2 __m128i RoundPack_sse2 (const __m128i kxSum0, const __m128i kxSum1,
+    const __m128i kxOffset) {
+  const __m128i kxRound = _mm_set1_epi32 (128);
+  return _mm_add_epi16 (_mm_packs_epi32 (_mm_srai_epi32 (_mm_add_epi32 (kxSum0, kxRound), 8),
+                                         _mm_srai_epi32 (_mm_add_epi32 (kxSum1, kxRound), 8)), kxOffset);
+}
+
+// rounded average of the 2x2 blocks of four pixels in two rows, 16 bit channels of the two blocks
+static inline WELS_TARGET_SSE2 __m128i AverageBlocks_sse2 (const __m128i kxRow0, const __m128i kxRow1) {
+  const __m128i kxZero = _mm_setzero_si128();
+  const __m128i kxSumLo = _mm_add_epi16 (_mm_unpacklo_epi8 (kxRow0, kxZero), _mm_unpacklo_epi8 (kxRow1, kxZero));
+  const __m128i kxSumHi = _mm_add_epi16 (_mm_unpackhi_epi8 (kxRow0, kxZero), _mm_unpackhi_epi8 (kxRow1, kxZero));
+  const __m128i kxSum = _mm_add_epi16 (_mm_unpacklo_epi64 (kxSumLo, kxSumHi), _mm_unpackhi_epi64 (kxSumLo, kxSumHi));
+  return _mm_srli_epi16 (_mm_add_epi16 (kxSum, _mm_set1_epi16 (2)), 2);
+}
+
+static inline WELS_TARGET_SSE2 __m128i WeightRow4_sse2 (const __m128i kxRow, const __m128i kxCoef) {
+  const __m128i kxZero = _mm_setzero_si128();
+  return WeightPixels4_sse2 (_mm_unpacklo_epi8 (kxRow, kxZero), _mm_unpackhi_epi8 (kxRow, kxZero), kxCoef);
+}
+
+WELS_TARGET_SSE2 void RgbToI420RowPair_sse2 (uint8_t* pDstY0, uint8_t* pDstY1, uint8_t* pDstU, uint8_t* pDstV,
+    const uint8_t* pSrc0, const uint8_t* pSrc1, const int32_t kiWidth, const SRgbCoef kCoef) {
+  const __m128i kxCoefY = _mm_set_epi16 (kCoef[0][3], kCoef[0][2], kCoef[0][1], kCoef[0][0],
+                                         kCoef[0][3], kCoef[0][2], kCoef[0][1], kCoef[0][0]);
+  const __m128i kxCoefU = _mm_set_epi16 (kCoef[1][3], kCoef[1][2], kCoef[1][1], kCoef[1][0],
+                                         kCoef[1][3], kCoef[1][2], kCoef[1][1], kCoef[1][0]);
+  const __m128i kxCoefV = _mm_set_epi16 (kCoef[2][3], kCoef[2][2], kCoef[2][1], kCoef[2][0],
+                                         kCoef[2][3], kCoef[2][2], kCoef[2][1], kCoef[2][0]);
+  const __m128i kxOffsetY = _mm_set1_epi16 (16);
+  const __m128i kxOffsetUV = _mm_set1_epi16 (128);
+  int32_t i = 0;
+  for (; i + 8 <= kiWidth; i += 8) {
+    const __m128i kxRow00 = _mm_loadu_si128 ((const __m128i*) (pSrc0 + (i << 2)));
+    const __m128i kxRow01 = _mm_loadu_si128 ((const __m128i*) (pSrc0 + (i << 2) + 16));
+    const __m128i kxRow10 = _mm_loadu_si128 ((const __m128i*) (pSrc1 + (i << 2)));
+    const __m128i kxRow11 = _mm_loadu_si128 ((const __m128i*) (pSrc1 + (i << 2) + 16));
+    __m128i xPix;
+
+    xPix = RoundPack_sse2 (WeightRow4_sse2 (kxRow00, kxCoefY), WeightRow4_sse2 (kxRow01, kxCoefY), kxOffsetY);
+    _mm_storel_epi64 ((__m128i*) (pDstY0 + i), _mm_packus_epi16 (xPix, xPix));
+    xPix = RoundPack_sse2 (WeightRow4_sse2 (kxRow10, kxCoefY), WeightRow4_sse2 (kxRow11, kxCoefY), kxOffsetY);
+    _mm_storel_epi64 ((__m128i*) (pDstY1 + i), _mm_packus_epi16 (xPix, xPix));
+
+    const __m128i kxAvg0 = AverageBlocks_sse2 (kxRow00, kxRow10);
+    const __m128i kxAvg1 = AverageBlocks_sse2 (kxRow01, kxRow11);
+    xPix = RoundPack_sse2 (WeightPixels4_sse2 (kxAvg0, kxAvg1, kxCoefU), _mm_setzero_si128(), kxOffsetUV);
+    * (int32_t*) (pDstU + (i >> 1)) = _mm_cvtsi128_si32 (_mm_packus_epi16 (xPix, xPix));
+    xPix = RoundPack_sse2 (WeightPixels4_sse2 (kxAvg0, kxAvg1, kxCoefV), _mm_setzero_si128(), kxOffsetUV);
+    * (int32_t*) (pDstV + (i >> 1)) = _mm_cvtsi128_si32 (_mm_packus_epi16 (xPix, xPix));
+  }
+  RgbToI420RowPair_c (pDstY0 + i, pDstY1 + i, pDstU + (i >> 1), pDstV + (i >> 1), pSrc0 + (i << 2), pSrc1 + (i << 2),
+                      kiWidth - i, kCoef);
+}
+
+WELS_TARGET_AVX2 void DeinterleaveRow_avx2 (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* pSrcUV,
+    const int32_t kiWidth) {
+  const __m256i kxLowBytes = _mm256_set1_epi16 (0x00ff);
+  int32_t i = 0;
+  for (; i + 32 <= kiWidth; i += 32) {
+    const __m256i kxUV0 = _mm256_loadu_si256 ((const __m256i*) (pSrcUV + (i << 1)));
+    const __m256i kxUV1 = _mm256_loadu_si256 ((const __m256i*) (pSrcUV + (i << 1) + 32));
+    // the packs work within 128 bit lanes, the quadwords are put back in order
+    const __m256i kxU = _mm256_packus_epi16 (_mm256_and_si256 (kxUV0, kxLowBytes), _mm256_and_si256 (kxUV1, kxLowBytes));
+    const __m256i kxV = _mm256_packus_epi16 (_mm256_srli_epi16 (kxUV0, 8), _mm256_srli_epi16 (kxUV1, 8));
+    _mm256_storeu_si256 ((__m256i*) (pDstU + i), _mm256_permute4x64_epi64 (kxU, 0xd8));
+    _mm256_storeu_si256 ((__m256i*) (pDstV + i), _mm256_permute4x64_epi64 (kxV, 0xd8));
+  }
+  DeinterleaveRow_sse2 (pDstU + i, pDstV + i, pSrcUV + (i << 1), kiWidth - i);
+}
+
+// as WeightPixels4_sse2 in each 128 bit lane
+static inline WELS_TARGET_AVX2 __m256i WeightPixels8_avx2 (const __m256i kxLo, const __m256i kxHi,
+    const __m256i kxCoef) {
+  const __m256 kfLo = _mm256_castsi256_ps (_mm256_madd_epi16 (kxLo, kxCoef));
+  const __m256 kfHi = _mm256_castsi256_ps (_mm256_madd_epi16 (kxHi, kxCoef));
+  return _mm256_add_epi32 (_mm256_castps_si256 (_mm256_shuffle_ps (kfLo, kfHi, _MM_SHUFFLE (2, 0, 2, 0))),
+                           _mm256_castps_si256 (_mm256_shuffle_ps (kfLo, kfHi, _MM_SHUFFLE (3, 1, 3, 1))));
+}
+
+static inline WELS_TARGET_AVX2 __m256i WeightRow8_avx2 (const __m256i kxRow, const __m256i kxCoef) {
+  const __m256i kxZero = _mm256_setzero_si256();
+  return WeightPixels8_avx2 (_mm256_unpacklo_epi8 (kxRow, kxZero), _mm256_unpackhi_epi8 (kxRow, kxZero), kxCoef);
+}
+
+static inline WELS_TARGET_AVX2 __m256i Round_avx2 (const __m256i kxSum) {
+  return _mm256_srai_epi32 (_mm256_add_epi32 (kxSum, _mm256_set1_epi32 (128)), 8);
+}
+
+// 16 luma samples of the weighted sums of pixels 0-7 and 8-15, each in lane order 0-3 | 4-7
+static inline WELS_TARGET_AVX2 __m128i PackLuma16_avx2 (const __m256i kxSum0, const __m256i kxSum1) {
+  const __m256i kxPix = _mm256_permute4x64_epi64 (_mm256_packs_epi32 (Round_avx2 (kxSum0), Round_avx2 (kxSum1)), 0xd8);
+  const __m128i kxOffset = _mm_set1_epi16 (16);
+  return _mm_packus_epi16 (_mm_add_epi16 (_mm256_castsi256_si128 (kxPix), kxOffset),
+                           _mm_add_epi16 (_mm256_extracti128_si256 (kxPix, 1), kxOffset));
+}
+
+// 8 chroma samples of the weighted sums in lane order 0 1 4 5 | 2 3 6 7
+static inline WELS_TARGET_AVX2 __m128i PackChroma8_avx2 (const __m256i kxSum) {
+  const __m256i kxPix = _mm256_permutevar8x32_epi32 (Round_avx2 (kxSum), _mm256_setr_epi32 (0, 1, 4, 5, 2, 3, 6, 7));
+  const __m128i kxWord = _mm_add_epi16 (_mm_packs_epi32 (_mm256_castsi256_si128 (kxPix),
+                                        _mm256_extracti128_si256 (kxPix, 1)), _mm_set1_epi16 (128));
+  return _mm_packus_epi16 (kxWord, kxWord);
+}
+
+// as AverageBlocks_sse2 in each 128 bit lane
+static inline WELS_TARGET_AVX2 __m256i AverageBlocks_avx2 (const __m256i kxRow0, const __m256i kxRow1) {
+  const __m256i kxZero = _mm256_setzero_si256();
+  const __m256i kxSumLo = _mm256_add_epi16 (_mm256_unpacklo_epi8 (kxRow0, kxZero), _mm256_unpacklo_epi8 (kxRow1,
+                          kxZero));
+  const __m256i kxSumHi = _mm256_add_epi16 (_mm256_unpackhi_epi8 (kxRow0, kxZero), _mm256_unpackhi_epi8 (kxRow1,
+                          kxZero));
+  const __m256i kxSum = _mm256_add_epi16 (_mm256_unpacklo_epi64 (kxSumLo, kxSumHi), _mm256_unpackhi_epi64 (kxSumLo,
+                                          kxSumHi));
+  return _mm256_srli_epi16 (_mm256_add_epi16 (kxSum, _mm256_set1_epi16 (2)), 2);
+}
+
+WELS_TARGET_AVX2 void RgbToI420RowPair_avx2 (uint8_t* pDstY0, uint8_t* pDstY1, uint8_t* pDstU, uint8_t* pDstV,
+    const uint8_t* pSrc0, const uint8_t* pSrc1, const int32_t kiWidth, const SRgbCoef kCoef) {
+  const __m256i kxCoefY = _mm256_set1_epi64x ((int64_t) (uint16_t)kCoef[0][0] | ((int64_t) (uint16_t)kCoef[0][1] << 16)
+                          | ((int64_t) (uint16_t)kCoef[0][2] << 32) | ((int64_t) (uint16_t)kCoef[0][3] << 48));
+  const __m256i kxCoefU = _mm256_set1_epi64x ((int64_t) (uint16_t)kCoef[1][0] | ((int64_t) (uint16_t)kCoef[1][1] << 16)
+                          | ((int64_t) (uint16_t)kCoef[1][2] << 32) | ((int64_t) (uint16_t)kCoef[1][3] << 48));
+  const __m256i kxCoefV = _mm256_set1_epi64x ((int64_t) (uint16_t)kCoef[2][0] | ((int64_t) (uint16_t)kCoef[2][1] << 16)
+                          | ((int64_t) (uint16_t)kCoef[2][2] << 32) | ((int64_t) (uint16_t)kCoef[2][3] << 48));
+  int32_t i = 0;
+  for (; i + 16 <= kiWidth; i += 16) {
+    const __m256i kxRow00 = _mm256_loadu_si256 ((const __m256i*) (pSrc0 + (i << 2)));
+    const __m256i kxRow01 = _mm256_loadu_si256 ((const __m256i*) (pSrc0 + (i << 2) + 32));
+    const __m256i kxRow10 = _mm256_loadu_si256 ((const __m256i*) (pSrc1 + (i << 2)));
+    const __m256i kxRow11 = _mm256_loadu_si256 ((const __m256i*) (pSrc1 + (i << 2) + 32));
+
+    _mm_storeu_si128 ((__m128i*) (pDstY0 + i), PackLuma16_avx2 (WeightRow8_avx2 (kxRow00, kxCoefY),
+                      WeightRow8_avx2 (kxRow01, kxCoefY)));
+    _mm_storeu_si128 ((__m128i*) (pDstY1 + i), PackLuma16_avx2 (WeightRow8_avx2 (kxRow10, kxCoefY),
+                      WeightRow8_avx2 (kxRow11, kxCoefY)));
+
+    const __m256i kxAvg0 = AverageBlocks_avx2 (kxRow00, kxRow10);
+    const __m256i kxAvg1 = AverageBlocks_avx2 (kxRow01, kxRow11);
+    _mm_storel_epi64 ((__m128i*) (pDstU + (i >> 1)), PackChroma8_avx2 (WeightPixels8_avx2 (kxAvg0, kxAvg1, kxCoefU)));
+    _mm_storel_epi64 ((__m128i*) (pDstV + (i >> 1)), PackChroma8_avx2 (WeightPixels8_avx2 (kxAvg0, kxAvg1, kxCoefV)));
+  }
+  RgbToI420RowPair_sse2 (pDstY0 + i, pDstY1 + i, pDstU + (i >> 1), pDstV + (i >> 1), pSrc0 + (i << 2),
+                         pSrc1 + (i << 2), kiWidth - i, kCoef);
+}
+
+#endif//X86_INTRINSICS
+
+WELSVP_NAMESPACE_END
@@ -31,6 +31,7 @@
  */
 
 #include "WelsFrameWork.h"
+#include "../colorspace/colorspace.h"
 #include "../denoise/denoise.h"
 #include "../downsample/downsample.h"
 #include "../scrolldetection/ScrollDetection.h"
@@ -94,9 +95,11 @@ CVpFrameWork::CVpFrameWork (uint32_t uiThreadsNum, EResult& eReturn) {
     IStrategy* pStrategy = m_pStgChain[i];
     pStrategy = CreateStrategy (WelsStaticCast (EMethods, i + 1), uiCPUFlag);
     m_pStgChain[i] = pStrategy;
+    WelsMutexInit (&m_mutes[i]);
   }
 
-  WelsMutexInit (&m_mutes);
+  m_pThreadPool = NULL;
+  WelsMutexInit (&m_mutexThreadPool);
 
   eReturn = RET_SUCCESS;
 }
@@ -107,9 +110,12 @@ CVpFrameWork::~CVpFrameWork() {
       Uninit (m_pStgChain[i]->m_eMethod);
       _SafeDelete (m_pStgChain[i]);
     }
+    WelsMutexDestroy (&m_mutes[i]);
   }
 
-  WelsMutexDestroy (&m_mutes);
+  if (m_pThreadPool)
+    WelsThreadPoolRelease (m_pThreadPool);
+  WelsMutexDestroy (&m_mutexThreadPool);
 }
 
 EResult CVpFrameWork::Init (int32_t iType, void* pCfg) {
@@ -118,13 +124,13 @@ EResult CVpFrameWork::Init (int32_t iType, void* pCfg) {
 
   Uninit (iType);
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
   if (pStrategy)
     eReturn = pStrategy->Init (0, pCfg);
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
@@ -133,13 +139,13 @@ EResult CVpFrameWork::Uninit (int32_t iType) {
   EResult eReturn        = RET_SUCCESS;
   int32_t iCurIdx    = WelsStaticCast (int32_t, WelsVpGetValidMethod (iType)) - 1;
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
   if (pStrategy)
     eReturn = pStrategy->Uninit (0);
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
@@ -164,13 +170,13 @@ EResult CVpFrameWork::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* pDst
   if (!CheckValid (eMethod, sSrcPic, sDstPic))
     return RET_INVALIDPARAM;
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
   if (pStrategy)
     eReturn = pStrategy->Process (0, &sSrcPic, &sDstPic);
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
@@ -182,13 +188,17 @@ EResult CVpFrameWork::Get (int32_t iType, void* pParam) {
   if (!pParam)
     return RET_INVALIDPARAM;
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
-  if (pStrategy)
-    eReturn = pStrategy->Get (0, pParam);
+  if (pStrategy) {
+    if (iType & METHOD_FLAG_STRIPE_THREADS)
+      * (int32_t*)pParam = pStrategy->m_iStripeNum;
+    else
+      eReturn = pStrategy->Get (0, pParam);
+  }
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
@@ -199,24 +209,72 @@ EResult CVpFrameWork::Set (int32_t iType, void* pParam) {
 
   if (!pParam)
     return RET_INVALIDPARAM;
+  if (iType & METHOD_FLAG_STRIPE_THREADS)
+    return SetStripeThreads (iCurIdx, * (int32_t*)pParam);
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
   if (pStrategy)
     eReturn = pStrategy->Set (0, pParam);
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
 
 EResult CVpFrameWork::SpecialFeature (int32_t iType, void* pIn, void* pOut) {
   EResult eReturn        = RET_SUCCESS;
+  int32_t iCurIdx    = WelsStaticCast (int32_t, WelsVpGetValidMethod (iType)) - 1;
+
+  if (!pIn || !pOut)
+    return RET_INVALIDPARAM;
+
+  WelsMutexLock (&m_mutes[iCurIdx]);
+
+  IStrategy* pStrategy = m_pStgChain[iCurIdx];
+  if (pStrategy)
+    eReturn = pStrategy->SpecialFeature (0, pIn, pOut);
+
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
 
+EResult CVpFrameWork::SetStripeThreads (int32_t iCurIdx, int32_t iThreadNum) {
+  SWelsThreadPool* pThreadPool = NULL;
+
+  iThreadNum = WELS_CLAMP (iThreadNum, 1, WELS_THREAD_POOL_MAX_THREADS);
+
+  // a single reference to the pool of the process, grown when a method asks for more stripes
+  WelsMutexLock (&m_mutexThreadPool);
+  if (iThreadNum > 1 && (NULL == m_pThreadPool || WelsThreadPoolThreadNum (m_pThreadPool) < iThreadNum - 1)) {
+    pThreadPool = WelsThreadPoolAcquire (iThreadNum - 1);
+    if (pThreadPool) {
+      if (m_pThreadPool)
+        WelsThreadPoolRelease (m_pThreadPool);
+      m_pThreadPool = pThreadPool;
+    }
+  }
+  pThreadPool = m_pThreadPool;
+  WelsMutexUnlock (&m_mutexThreadPool);
+
+  if (NULL == pThreadPool)
+    iThreadNum = 1;
+
+  WelsMutexLock (&m_mutes[iCurIdx]);
+
+  IStrategy* pStrategy = m_pStgChain[iCurIdx];
+  if (pStrategy) {
+    pStrategy->m_pThreadPool = iThreadNum > 1 ? pThreadPool : NULL;
+    pStrategy->m_iStripeNum  = iThreadNum;
+  }
+
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
+
+  return RET_SUCCESS;
+}
+
 bool  CVpFrameWork::CheckValid (EMethods eMethod, SPixMap& pSrcPixMap, SPixMap& pDstPixMap) {
   bool eReturn = false;
 
@@ -261,7 +319,7 @@ IStrategy* CVpFrameWork::CreateStrategy (EMethods m_eMethod, int32_t iCpuFlag) {
 
   switch (m_eMethod) {
   case METHOD_COLORSPACE_CONVERT:
-    //not support yet
+    pStrategy = WelsDynamicCast (IStrategy*, new CColorspaceConvert (iCpuFlag));
     break;
   case METHOD_DENOISE:
     pStrategy = WelsDynamicCast (IStrategy*, new CDenoiser (iCpuFlag));
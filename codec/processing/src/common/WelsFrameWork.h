@@ -45,6 +45,7 @@
 #include "IWelsVP.h"
 #include "util.h"
 #include "WelsThreadLib.h"
+#include "WelsThreadPool.h"
 
 WELSVP_NAMESPACE_BEGIN
 
@@ -63,6 +64,8 @@ class IStrategy : public IWelsVP {
     m_eFormat  = VIDEO_FORMAT_I420;
     m_iIndex   = 0;
     m_bInit    = false;
+    m_pThreadPool = NULL;
+    m_iStripeNum  = 1;
   };
 
   virtual ~IStrategy() {}
@@ -93,6 +96,8 @@ class IStrategy : public IWelsVP {
   EVideoFormat m_eFormat;
   int32_t           m_iIndex;
   bool            m_bInit;
+  SWelsThreadPool* m_pThreadPool;	// set along with m_iStripeNum > 1, the caller runs one stripe itself
+  int32_t          m_iStripeNum;
 };
 
 class CVpFrameWork : public IWelsVP {
@@ -118,11 +123,16 @@ class CVpFrameWork : public IWelsVP {
  private:
   bool  CheckValid (EMethods eMethod, SPixMap& sSrc, SPixMap& sDst);
   IStrategy* CreateStrategy (EMethods eMethod, int32_t iCpuFlag);
+  EResult SetStripeThreads (int32_t iCurIdx, int32_t iThreadNum);
 
  private:
   IStrategy* m_pStgChain[MAX_STRATEGY_NUM];
 
-  WELS_MUTEX m_mutes;
+  // one lock per method: a strategy keeps state between calls, different methods run concurrently
+  WELS_MUTEX m_mutes[MAX_STRATEGY_NUM];
+
+  SWelsThreadPool* m_pThreadPool;
+  WELS_MUTEX m_mutexThreadPool;
 };
 
 WELSVP_NAMESPACE_END
@@ -55,25 +55,31 @@ void CDownsampling::InitDownsampleFuncs (SDownsampleFuncs& sDownsampleFunc,  int
   sDownsampleFunc.pfHalfAverage[3] = DyadicBilinearDownsampler_c;
   sDownsampleFunc.pfGeneralRatioChroma = GeneralBilinearAccurateDownsampler_c;
   sDownsampleFunc.pfGeneralRatioLuma	 = GeneralBilinearFastDownsampler_c;
-#if defined(X86_ASM)
-  if (iCpuFlag & WELS_CPU_SSE) {
-    /*  sDownsampleFunc.pfHalfAverage[0]	= DyadicBilinearDownsamplerWidthx32_sse;
-      sDownsampleFunc.pfHalfAverage[1]	= DyadicBilinearDownsamplerWidthx16_sse;
-      sDownsampleFunc.pfHalfAverage[2]	= DyadicBilinearDownsamplerWidthx8_sse;*/
-  }
+  sDownsampleFunc.pfGeneralRatioChromaRows = GeneralBilinearAccurateDownsamplerRows_c;
+  sDownsampleFunc.pfGeneralRatioLumaRows	 = GeneralBilinearFastDownsamplerRows_c;
+#if defined(X86_INTRINSICS)
+  // the asm kernels of downsample_bilinear.asm only exist for X86_32, these are intrinsics of any width
   if (iCpuFlag & WELS_CPU_SSE2) {
-    //  sDownsampleFunc.pfGeneralRatioChroma = GeneralBilinearAccurateDownsamplerWrap_sse2;
-    //  sDownsampleFunc.pfGeneralRatioLuma   = GeneralBilinearFastDownsamplerWrap_sse2;
-  }
-  if (iCpuFlag & WELS_CPU_SSSE3) {
-    //  sDownsampleFunc.pfHalfAverage[0]	= DyadicBilinearDownsamplerWidthx32_ssse3;
-    //  sDownsampleFunc.pfHalfAverage[1]	= DyadicBilinearDownsamplerWidthx16_ssse3;
+    sDownsampleFunc.pfHalfAverage[0] = DyadicBilinearDownsampler_sse2;
+    sDownsampleFunc.pfHalfAverage[1] = DyadicBilinearDownsampler_sse2;
+    sDownsampleFunc.pfHalfAverage[2] = DyadicBilinearDownsampler_sse2;
+    sDownsampleFunc.pfHalfAverage[3] = DyadicBilinearDownsampler_sse2;
+    sDownsampleFunc.pfGeneralRatioChroma = GeneralBilinearAccurateDownsamplerWrap_sse2;
+    sDownsampleFunc.pfGeneralRatioLuma	 = GeneralBilinearFastDownsamplerWrap_sse2;
+    sDownsampleFunc.pfGeneralRatioChromaRows = GeneralBilinearAccurateDownsamplerRows_sse2;
+    sDownsampleFunc.pfGeneralRatioLumaRows	 = GeneralBilinearFastDownsamplerRows_sse2;
   }
-  if (iCpuFlag & WELS_CPU_SSE41) {
-    //  sDownsampleFunc.pfHalfAverage[0]	= DyadicBilinearDownsamplerWidthx32_sse4;
-    //  sDownsampleFunc.pfHalfAverage[1]	= DyadicBilinearDownsamplerWidthx16_sse4;
+  if (iCpuFlag & WELS_CPU_AVX2) {
+    sDownsampleFunc.pfHalfAverage[0] = DyadicBilinearDownsampler_avx2;
+    sDownsampleFunc.pfHalfAverage[1] = DyadicBilinearDownsampler_avx2;
+    sDownsampleFunc.pfHalfAverage[2] = DyadicBilinearDownsampler_avx2;
+    sDownsampleFunc.pfHalfAverage[3] = DyadicBilinearDownsampler_avx2;
+    sDownsampleFunc.pfGeneralRatioChroma = GeneralBilinearAccurateDownsampler_avx2;
+    sDownsampleFunc.pfGeneralRatioLuma	 = GeneralBilinearFastDownsampler_avx2;
+    sDownsampleFunc.pfGeneralRatioChromaRows = GeneralBilinearAccurateDownsamplerRows_avx2;
+    sDownsampleFunc.pfGeneralRatioLumaRows	 = GeneralBilinearFastDownsamplerRows_avx2;
   }
-#endif//X86_ASM
+#endif//X86_INTRINSICS
 
 #if defined(HAVE_NEON)
   if (iCpuFlag & WELS_CPU_NEON) {
@@ -83,6 +89,9 @@ void CDownsampling::InitDownsampleFuncs (SDownsampleFuncs& sDownsampleFunc,  int
     sDownsampleFunc.pfHalfAverage[3] = DyadicBilinearDownsampler_neon;
     sDownsampleFunc.pfGeneralRatioChroma = GeneralBilinearAccurateDownsamplerWrap_neon;
     sDownsampleFunc.pfGeneralRatioLuma	 = GeneralBilinearAccurateDownsamplerWrap_neon;
+    // no row range variants, layers are then sampled one after the other
+    sDownsampleFunc.pfGeneralRatioChromaRows = NULL;
+    sDownsampleFunc.pfGeneralRatioLumaRows	 = NULL;
   }
 #endif
 }
@@ -102,6 +111,14 @@ EResult CDownsampling::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* pDs
     return RET_INVALIDPARAM;
   }
 
+  if (m_iStripeNum > 1 && NULL != m_pfDownsample.pfGeneralRatioLumaRows) {
+    // the row range kernels split the picture into stripes
+    SDownsampleLayers sLayers;
+    sLayers.iLayerNum = 1;
+    sLayers.sDstPicMap[0] = *pDstPixMap;
+    return ProcessLayers (pSrcPixMap, &sLayers);
+  }
+
   if ((iSrcWidthY >> 1) == iDstWidthY && (iSrcHeightY >> 1) == iDstHeightY) {
     // use half average functions
     uint8_t iAlignIndex = GetAlignedIndex (iSrcWidthY);
@@ -126,6 +143,146 @@ EResult CDownsampling::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* pDs
   return RET_SUCCESS;
 }
 
+EResult CDownsampling::SpecialFeature (int32_t iType, void* pIn, void* pOut) {
+  if (NULL == pIn || NULL == pOut)
+    return RET_INVALIDPARAM;
+
+  return ProcessLayers ((SPixMap*)pIn, (SDownsampleLayers*)pOut);
+}
+
+typedef struct {
+  uint8_t* pDst;
+  int32_t  iDstStride;
+  int32_t  iDstWidth;
+  int32_t  iDstHeight;
+  uint8_t* pSrc;
+  int32_t  iSrcStride;
+  int32_t  iSrcWidth;
+  int32_t  iSrcHeight;
+  PHalveDownsampleFunc       pfHalf;	// dyadic layers
+  PGeneralDownsampleRowsFunc pfRows;	// general ratio layers
+} SDownsamplePlane;
+
+typedef struct {
+  const SDownsamplePlane* pPlanes;
+  int32_t iPlaneNum;
+  int32_t iSrcHeight;	// luma
+  int32_t iStripe;
+  int32_t iStripeNum;
+} SDownsampleStripe;
+
+#define DOWNSAMPLE_BAND_ROWS 32	// luma source rows visited per step, the band stays in cache for all layers
+
+/*
+ *	produce the dst rows [iDstHeight * iStripe / iStripeNum, iDstHeight * (iStripe + 1) / iStripeNum) of every plane,
+ *	walking down the source in bands and emitting every dst row whose source rows lie above the band end
+ */
+static void DownsampleStripe (void* pArg) {
+  const SDownsampleStripe* pStripe = (const SDownsampleStripe*)pArg;
+  int32_t iNextRow[MAX_DOWNSAMPLE_LAYER_NUM * 3];
+  int32_t iLastRow[MAX_DOWNSAMPLE_LAYER_NUM * 3];
+
+  for (int32_t i = 0; i < pStripe->iPlaneNum; i++) {
+    const int32_t kiDstHeight = pStripe->pPlanes[i].iDstHeight;
+    iNextRow[i] = kiDstHeight * pStripe->iStripe / pStripe->iStripeNum;
+    iLastRow[i] = kiDstHeight * (pStripe->iStripe + 1) / pStripe->iStripeNum;
+  }
+
+  const int32_t kiBandStart = pStripe->iSrcHeight * pStripe->iStripe / pStripe->iStripeNum / DOWNSAMPLE_BAND_ROWS
+                              * DOWNSAMPLE_BAND_ROWS;
+  for (int32_t iBandEnd = kiBandStart + DOWNSAMPLE_BAND_ROWS; ; iBandEnd += DOWNSAMPLE_BAND_ROWS) {
+    const bool kbLastBand = iBandEnd >= pStripe->iSrcHeight;
+    bool bDone = true;
+    for (int32_t i = 0; i < pStripe->iPlaneNum; i++) {
+      const SDownsamplePlane* pPlane = &pStripe->pPlanes[i];
+      const int32_t kiSrcRows = (i % 3) ? (iBandEnd >> 1) : iBandEnd;
+      int32_t iRowEnd;
+      if (kbLastBand)
+        iRowEnd = iLastRow[i];
+      else if (pPlane->pfHalf)
+        iRowEnd = WELS_MIN (kiSrcRows >> 1, iLastRow[i]);
+      else
+        iRowEnd = WELS_MIN ((kiSrcRows - 1) * pPlane->iDstHeight / pPlane->iSrcHeight, iLastRow[i]);
+      bDone = bDone && iRowEnd >= iLastRow[i];
+      if (iRowEnd <= iNextRow[i])
+        continue;
+
+      if (pPlane->pfHalf) {
+        pPlane->pfHalf (pPlane->pDst + iNextRow[i] * pPlane->iDstStride, pPlane->iDstStride,
+                        pPlane->pSrc + (iNextRow[i] << 1) * pPlane->iSrcStride, pPlane->iSrcStride,
+                        pPlane->iSrcWidth, (iRowEnd - iNextRow[i]) << 1);
+      } else {
+        pPlane->pfRows (pPlane->pDst, pPlane->iDstStride, pPlane->iDstWidth, pPlane->iDstHeight,
+                        pPlane->pSrc, pPlane->iSrcStride, pPlane->iSrcWidth, pPlane->iSrcHeight,
+                        iNextRow[i], iRowEnd);
+      }
+      iNextRow[i] = iRowEnd;
+    }
+    if (bDone)
+      break;
+  }
+}
+
+EResult CDownsampling::ProcessLayers (SPixMap* pSrcPixMap, SDownsampleLayers* pLayers) {
+  SDownsamplePlane sPlanes[MAX_DOWNSAMPLE_LAYER_NUM * 3];
+  SDownsampleStripe sStripes[WELS_THREAD_POOL_MAX_THREADS];
+  const int32_t kiSrcWidthY = pSrcPixMap->sRect.iRectWidth;
+  const int32_t kiSrcHeightY = pSrcPixMap->sRect.iRectHeight;
+  const int32_t kiLayerNum = pLayers->iLayerNum;
+  int32_t iPlaneNum = 0;
+
+  if (kiLayerNum <= 0 || kiLayerNum > MAX_DOWNSAMPLE_LAYER_NUM)
+    return RET_INVALIDPARAM;
+  for (int32_t i = 0; i < kiLayerNum; i++) {
+    if (kiSrcWidthY <= pLayers->sDstPicMap[i].sRect.iRectWidth || kiSrcHeightY <= pLayers->sDstPicMap[i].sRect.iRectHeight)
+      return RET_INVALIDPARAM;
+  }
+
+  if (NULL == m_pfDownsample.pfGeneralRatioLumaRows) {
+    for (int32_t i = 0; i < kiLayerNum; i++)
+      Process (0, pSrcPixMap, &pLayers->sDstPicMap[i]);
+    return RET_SUCCESS;
+  }
+
+  for (int32_t i = 0; i < kiLayerNum; i++) {
+    SPixMap* pDstPixMap = &pLayers->sDstPicMap[i];
+    const bool kbHalf = (kiSrcWidthY >> 1) == pDstPixMap->sRect.iRectWidth
+                        && (kiSrcHeightY >> 1) == pDstPixMap->sRect.iRectHeight;
+    for (int32_t k = 0; k < 3; k++) {
+      SDownsamplePlane* pPlane = &sPlanes[iPlaneNum++];
+      const int32_t kiShift = k > 0;
+      pPlane->pDst       = (uint8_t*)pDstPixMap->pPixel[k];
+      pPlane->iDstStride = pDstPixMap->iStride[k];
+      pPlane->iDstWidth  = pDstPixMap->sRect.iRectWidth >> kiShift;
+      pPlane->iDstHeight = pDstPixMap->sRect.iRectHeight >> kiShift;
+      pPlane->pSrc       = (uint8_t*)pSrcPixMap->pPixel[k];
+      pPlane->iSrcStride = pSrcPixMap->iStride[k];
+      pPlane->iSrcWidth  = kiSrcWidthY >> kiShift;
+      pPlane->iSrcHeight = kiSrcHeightY >> kiShift;
+      pPlane->pfHalf     = kbHalf ? m_pfDownsample.pfHalfAverage[GetAlignedIndex (pPlane->iSrcWidth)] : NULL;
+      pPlane->pfRows     = k > 0 ? m_pfDownsample.pfGeneralRatioChromaRows : m_pfDownsample.pfGeneralRatioLumaRows;
+    }
+  }
+
+  // at least a band of source rows per stripe
+  const int32_t kiStripeNum = WELS_CLAMP (kiSrcHeightY / DOWNSAMPLE_BAND_ROWS, 1, m_iStripeNum);
+  SWelsTaskGroup sGroup;
+  WelsMemset (&sGroup, 0, sizeof (sGroup));
+  for (int32_t i = 0; i < kiStripeNum; i++) {
+    sStripes[i].pPlanes    = sPlanes;
+    sStripes[i].iPlaneNum  = iPlaneNum;
+    sStripes[i].iSrcHeight = kiSrcHeightY;
+    sStripes[i].iStripe    = i;
+    sStripes[i].iStripeNum = kiStripeNum;
+    if (i > 0)
+      WelsThreadPoolSubmit (m_pThreadPool, &sGroup, DownsampleStripe, &sStripes[i]);
+  }
+  DownsampleStripe (&sStripes[0]);
+  if (kiStripeNum > 1)
+    WelsThreadPoolWait (m_pThreadPool, &sGroup);
+  return RET_SUCCESS;
+}
+
 int32_t CDownsampling::GetAlignedIndex (const int32_t kiSrcWidth) {
   int32_t iAlignIndex;
   if ((kiSrcWidth & 0x1f) == 0)	// x32
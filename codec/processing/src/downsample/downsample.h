@@ -43,6 +43,7 @@
 #define WELSVP_DOWNSAMPLE_H
 
 #include "util.h"
+#include "macros.h"
 #include "WelsFrameWork.h"
 #include "IWelsVP.h"
 
@@ -57,18 +58,30 @@ typedef void (GeneralDownsampleFunc) (uint8_t* pDst, const int32_t kiDstStride,
                                       const int32_t kiDstHeight,
                                       uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight);
 
+// produces only the destination rows [kiRowStart, kiRowEnd) of a kiDstWidth x kiDstHeight picture
+typedef void (GeneralDownsampleRowsFunc) (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
+    const int32_t kiRowStart, const int32_t kiRowEnd);
+
 typedef HalveDownsampleFunc*		PHalveDownsampleFunc;
 typedef GeneralDownsampleFunc*	PGeneralDownsampleFunc;
+typedef GeneralDownsampleRowsFunc*	PGeneralDownsampleRowsFunc;
 
 HalveDownsampleFunc   DyadicBilinearDownsampler_c;
 GeneralDownsampleFunc GeneralBilinearFastDownsampler_c;
 GeneralDownsampleFunc GeneralBilinearAccurateDownsampler_c;
+GeneralDownsampleRowsFunc GeneralBilinearFastDownsamplerRows_c;
+GeneralDownsampleRowsFunc GeneralBilinearAccurateDownsamplerRows_c;
 
 typedef struct {
   // align_index: 0 = x32; 1 = x16; 2 = x8; 3 = common case left;
   PHalveDownsampleFunc			pfHalfAverage[4];
   PGeneralDownsampleFunc		pfGeneralRatioLuma;
   PGeneralDownsampleFunc		pfGeneralRatioChroma;
+  // row range variants used when several layers are sampled in one pass, NULL if not available
+  PGeneralDownsampleRowsFunc	pfGeneralRatioLumaRows;
+  PGeneralDownsampleRowsFunc	pfGeneralRatioChromaRows;
 } SDownsampleFuncs;
 
 
@@ -89,9 +102,6 @@ HalveDownsampleFunc		DyadicBilinearDownsamplerWidthx16_sse4;
 // iSrcWidth= x32 pixels
 HalveDownsampleFunc		DyadicBilinearDownsamplerWidthx32_sse4;
 
-GeneralDownsampleFunc GeneralBilinearFastDownsamplerWrap_sse2;
-GeneralDownsampleFunc GeneralBilinearAccurateDownsamplerWrap_sse2;
-
 void GeneralBilinearFastDownsampler_sse2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
     const int32_t kiDstHeight,
     uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
@@ -101,7 +111,23 @@ void GeneralBilinearAccurateDownsampler_sse2 (uint8_t* pDst, const int32_t kiDst
     uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
     const uint32_t kuiScaleX, const uint32_t kuiScaleY);
 WELSVP_EXTERN_C_END
-#endif
+#endif//X86_ASM
+
+#if defined(X86_INTRINSICS)
+// intrinsics, any width
+HalveDownsampleFunc		DyadicBilinearDownsampler_sse2;
+GeneralDownsampleFunc		GeneralBilinearFastDownsamplerWrap_sse2;
+GeneralDownsampleFunc		GeneralBilinearAccurateDownsamplerWrap_sse2;
+GeneralDownsampleRowsFunc	GeneralBilinearFastDownsamplerRows_sse2;
+GeneralDownsampleRowsFunc	GeneralBilinearAccurateDownsamplerRows_sse2;
+
+// intrinsics, selected when WELS_CPU_AVX2 is reported
+HalveDownsampleFunc		DyadicBilinearDownsampler_avx2;
+GeneralDownsampleFunc		GeneralBilinearFastDownsampler_avx2;
+GeneralDownsampleFunc		GeneralBilinearAccurateDownsampler_avx2;
+GeneralDownsampleRowsFunc	GeneralBilinearFastDownsamplerRows_avx2;
+GeneralDownsampleRowsFunc	GeneralBilinearAccurateDownsamplerRows_avx2;
+#endif//X86_INTRINSICS
 
 #ifdef HAVE_NEON
 WELSVP_EXTERN_C_BEGIN
@@ -125,9 +151,12 @@ class CDownsampling : public IStrategy {
   ~CDownsampling();
 
   EResult Process (int32_t iType, SPixMap* pSrc, SPixMap* pDst);
+  // pIn: SPixMap* source, pOut: SDownsampleLayers* destinations, all sampled in one pass over the source
+  EResult SpecialFeature (int32_t iType, void* pIn, void* pOut);
 
  private:
   void InitDownsampleFuncs (SDownsampleFuncs& sDownsampleFunc, int32_t iCpuFlag);
+  EResult ProcessLayers (SPixMap* pSrc, SDownsampleLayers* pLayers);
 
   int32_t GetAlignedIndex (const int32_t kiSrcWidth);
 
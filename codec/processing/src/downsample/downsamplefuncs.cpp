@@ -39,6 +39,10 @@
  *****************************************************************************/
 
 #include "downsample.h"
+#include "macros.h"
+#if defined(X86_INTRINSICS)
+#include <immintrin.h>
+#endif//X86_INTRINSICS
 
 
 WELSVP_NAMESPACE_BEGIN
@@ -68,166 +72,480 @@ void DyadicBilinearDownsampler_c (uint8_t* pDst, const int32_t kiDstStride,
   }
 }
 
-void GeneralBilinearFastDownsampler_c (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
-                                       const int32_t kiDstHeight,
-                                       uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+typedef void (GeneralBilinearRowFunc) (uint8_t* pDst, const uint8_t* pSrc, const int32_t kiSrcStride,
+                                       const int32_t kiStart, const int32_t kiEnd, const int32_t kiScaleX, const int32_t kiFv);
+typedef GeneralBilinearRowFunc* PGeneralBilinearRowFunc;
+
+// interpolates dst pixels [kiStart, kiEnd) of one row, pSrc points to the upper of the two source rows
+static void GeneralBilinearFastRow_c (uint8_t* pDst, const uint8_t* pSrc, const int32_t kiSrcStride,
+                                      const int32_t kiStart, const int32_t kiEnd, const int32_t kiScaleX, const int32_t kiFv) {
   const uint32_t kuiScaleBitWidth = 16, kuiScaleBitHeight = 15;
   const uint32_t kuiScaleWidth = (1 << kuiScaleBitWidth), kuiScaleHeight = (1 << kuiScaleBitHeight);
-  int32_t fScalex = (int32_t) ((float)kiSrcWidth / (float)kiDstWidth * kuiScaleWidth);
-  int32_t fScaley = (int32_t) ((float)kiSrcHeight / (float)kiDstHeight * kuiScaleHeight);
+  const int32_t fv = kiFv;
+  int32_t iXInverse = (1 << (kuiScaleBitWidth - 1)) + kiStart * kiScaleX;
   uint32_t x;
-  int32_t iYInverse, iXInverse;
-
-  uint8_t* pByDst = pDst;
-  uint8_t* pByLineDst = pDst;
-
-  iYInverse = 1 << (kuiScaleBitHeight - 1);
-  for (int32_t i = 0; i < kiDstHeight - 1; i++) {
-    int32_t iYy = iYInverse >> kuiScaleBitHeight;
-    int32_t fv = iYInverse & (kuiScaleHeight - 1);
-
-    uint8_t* pBySrc = pSrc + iYy * kiSrcStride;
-
-    pByDst = pByLineDst;
-    iXInverse = 1 << (kuiScaleBitWidth - 1);
-    for (int32_t j = 0; j < kiDstWidth - 1; j++) {
-      int32_t iXx = iXInverse >> kuiScaleBitWidth;
-      int32_t iFu = iXInverse & (kuiScaleWidth - 1);
-
-      uint8_t* pByCurrent = pBySrc + iXx;
-      uint8_t a, b, c, d;
-
-      a = *pByCurrent;
-      b = * (pByCurrent + 1);
-      c = * (pByCurrent + kiSrcStride);
-      d = * (pByCurrent + kiSrcStride + 1);
-
-      x  = (((uint32_t) (kuiScaleWidth - 1 - iFu)) * (kuiScaleHeight - 1 - fv) >> kuiScaleBitWidth) * a;
-      x += (((uint32_t) (iFu)) * (kuiScaleHeight - 1 - fv) >> kuiScaleBitWidth) * b;
-      x += (((uint32_t) (kuiScaleWidth - 1 - iFu)) * (fv) >> kuiScaleBitWidth) * c;
-      x += (((uint32_t) (iFu)) * (fv) >> kuiScaleBitWidth) * d;
-      x >>= (kuiScaleBitHeight - 1);
-      x += 1;
-      x >>= 1;
-      //x = (((__int64)(SCALE_BIG - 1 - iFu))*(SCALE_BIG - 1 - fv)*a + ((__int64)iFu)*(SCALE_BIG - 1 -fv)*b + ((__int64)(SCALE_BIG - 1 -iFu))*fv*c +
-      //		 ((__int64)iFu)*fv*d + (1 << (2*SCALE_BIT_BIG-1)) ) >> (2*SCALE_BIT_BIG);
-      x = WELS_CLAMP (x, 0, 255);
-      *pByDst++ = (uint8_t)x;
-
-      iXInverse += fScalex;
-    }
-    *pByDst = * (pBySrc + (iXInverse >> kuiScaleBitWidth));
-    pByLineDst += kiDstStride;
-    iYInverse += fScaley;
+
+  for (int32_t j = kiStart; j < kiEnd; j++) {
+    int32_t iXx = iXInverse >> kuiScaleBitWidth;
+    int32_t iFu = iXInverse & (kuiScaleWidth - 1);
+
+    const uint8_t* pByCurrent = pSrc + iXx;
+    uint8_t a, b, c, d;
+
+    a = *pByCurrent;
+    b = * (pByCurrent + 1);
+    c = * (pByCurrent + kiSrcStride);
+    d = * (pByCurrent + kiSrcStride + 1);
+
+    x  = (((uint32_t) (kuiScaleWidth - 1 - iFu)) * (kuiScaleHeight - 1 - fv) >> kuiScaleBitWidth) * a;
+    x += (((uint32_t) (iFu)) * (kuiScaleHeight - 1 - fv) >> kuiScaleBitWidth) * b;
+    x += (((uint32_t) (kuiScaleWidth - 1 - iFu)) * (fv) >> kuiScaleBitWidth) * c;
+    x += (((uint32_t) (iFu)) * (fv) >> kuiScaleBitWidth) * d;
+    x >>= (kuiScaleBitHeight - 1);
+    x += 1;
+    x >>= 1;
+    //x = (((__int64)(SCALE_BIG - 1 - iFu))*(SCALE_BIG - 1 - fv)*a + ((__int64)iFu)*(SCALE_BIG - 1 -fv)*b + ((__int64)(SCALE_BIG - 1 -iFu))*fv*c +
+    //		 ((__int64)iFu)*fv*d + (1 << (2*SCALE_BIT_BIG-1)) ) >> (2*SCALE_BIT_BIG);
+    x = WELS_CLAMP (x, 0, 255);
+    pDst[j] = (uint8_t)x;
+
+    iXInverse += kiScaleX;
   }
+}
+
+static void GeneralBilinearAccurateRow_c (uint8_t* pDst, const uint8_t* pSrc, const int32_t kiSrcStride,
+    const int32_t kiStart, const int32_t kiEnd, const int32_t kiScaleX, const int32_t kiFv) {
+  const int32_t kiScaleBit = 15;
+  const int32_t kiScale = (1 << kiScaleBit);
+  const int32_t iFv = kiFv;
+  int32_t iXInverse = (1 << (kiScaleBit - 1)) + kiStart * kiScaleX;
+  int64_t x;
+
+  for (int32_t j = kiStart; j < kiEnd; j++) {
+    int32_t iXx = iXInverse >> kiScaleBit;
+    int32_t iFu = iXInverse & (kiScale - 1);
 
-  // last row special
-  {
-    int32_t iYy = iYInverse >> kuiScaleBitHeight;
-    uint8_t* pBySrc = pSrc + iYy * kiSrcStride;
+    const uint8_t* pByCurrent = pSrc + iXx;
+    uint8_t a, b, c, d;
 
-    pByDst = pByLineDst;
-    iXInverse = 1 << (kuiScaleBitWidth - 1);
-    for (int32_t j = 0; j < kiDstWidth; j++) {
-      int32_t iXx = iXInverse >> kuiScaleBitWidth;
-      *pByDst++ = * (pBySrc + iXx);
+    a = *pByCurrent;
+    b = * (pByCurrent + 1);
+    c = * (pByCurrent + kiSrcStride);
+    d = * (pByCurrent + kiSrcStride + 1);
 
-      iXInverse += fScalex;
+    x = (((int64_t) (kiScale - 1 - iFu)) * (kiScale - 1 - iFv) * a + ((int64_t)iFu) * (kiScale - 1 - iFv) * b + ((int64_t) (
+           kiScale - 1 - iFu)) * iFv * c +
+         ((int64_t)iFu) * iFv * d + (int64_t) (1 << (2 * kiScaleBit - 1))) >> (2 * kiScaleBit);
+    x = WELS_CLAMP (x, 0, 255);
+    pDst[j] = (uint8_t)x;
+
+    iXInverse += kiScaleX;
+  }
+}
+
+/*
+ * Common frame of the general ratio downsamplers: each dst row but the last one interpolates between two source rows
+ * and copies its last pixel, the last row is nearest sampled. Rows do not depend on each other, so any range
+ * [kiRowStart, kiRowEnd) gives the same pixels as a run over the whole picture.
+ */
+static void GeneralBilinearDownsampleRows (PGeneralBilinearRowFunc pfRow, const int32_t kiScaleBitWidth,
+    const int32_t kiScaleBitHeight,
+    uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth, const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
+    const int32_t kiRowStart, const int32_t kiRowEnd) {
+  const int32_t kiScaleWidth = (1 << kiScaleBitWidth), kiScaleHeight = (1 << kiScaleBitHeight);
+  const int32_t kiScalex = (int32_t) ((float)kiSrcWidth / (float)kiDstWidth * kiScaleWidth);
+  const int32_t kiScaley = (int32_t) ((float)kiSrcHeight / (float)kiDstHeight * kiScaleHeight);
+  const int32_t kiLastXx = ((1 << (kiScaleBitWidth - 1)) + (kiDstWidth - 1) * kiScalex) >> kiScaleBitWidth;
+
+  for (int32_t i = kiRowStart; i < kiRowEnd; i++) {
+    const int32_t kiYInverse = (1 << (kiScaleBitHeight - 1)) + i * kiScaley;
+    uint8_t* pByDst = pDst + i * kiDstStride;
+    uint8_t* pBySrc = pSrc + (kiYInverse >> kiScaleBitHeight) * kiSrcStride;
+
+    if (i < kiDstHeight - 1) {
+      pfRow (pByDst, pBySrc, kiSrcStride, 0, kiDstWidth - 1, kiScalex, kiYInverse & (kiScaleHeight - 1));
+      pByDst[kiDstWidth - 1] = pBySrc[kiLastXx];
+    } else {
+      // last row special
+      int32_t iXInverse = 1 << (kiScaleBitWidth - 1);
+      for (int32_t j = 0; j < kiDstWidth; j++) {
+        pByDst[j] = pBySrc[iXInverse >> kiScaleBitWidth];
+        iXInverse += kiScalex;
+      }
     }
   }
 }
 
+void GeneralBilinearFastDownsamplerRows_c (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
+    const int32_t kiRowStart, const int32_t kiRowEnd) {
+  GeneralBilinearDownsampleRows (GeneralBilinearFastRow_c, 16, 15, pDst, kiDstStride, kiDstWidth, kiDstHeight,
+                                 pSrc, kiSrcStride, kiSrcWidth, kiSrcHeight, kiRowStart, kiRowEnd);
+}
+
+void GeneralBilinearAccurateDownsamplerRows_c (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
+    const int32_t kiRowStart, const int32_t kiRowEnd) {
+  GeneralBilinearDownsampleRows (GeneralBilinearAccurateRow_c, 15, 15, pDst, kiDstStride, kiDstWidth, kiDstHeight,
+                                 pSrc, kiSrcStride, kiSrcWidth, kiSrcHeight, kiRowStart, kiRowEnd);
+}
+
+void GeneralBilinearFastDownsampler_c (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+                                       const int32_t kiDstHeight,
+                                       uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  GeneralBilinearFastDownsamplerRows_c (pDst, kiDstStride, kiDstWidth, kiDstHeight, pSrc, kiSrcStride, kiSrcWidth,
+                                        kiSrcHeight, 0, kiDstHeight);
+}
+
 void GeneralBilinearAccurateDownsampler_c (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
     const int32_t kiDstHeight,
     uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
-  const int32_t kiScaleBit = 15;
-  const int32_t kiScale = (1 << kiScaleBit);
-  int32_t iScalex = (int32_t) ((float)kiSrcWidth / (float)kiDstWidth * kiScale);
-  int32_t iScaley = (int32_t) ((float)kiSrcHeight / (float)kiDstHeight * kiScale);
-  int64_t x;
-  int32_t iYInverse, iXInverse;
+  GeneralBilinearAccurateDownsamplerRows_c (pDst, kiDstStride, kiDstWidth, kiDstHeight, pSrc, kiSrcStride, kiSrcWidth,
+      kiSrcHeight, 0, kiDstHeight);
+}
 
-  uint8_t* pByDst = pDst;
-  uint8_t* pByLineDst = pDst;
 
-  iYInverse = 1 << (kiScaleBit - 1);
-  for (int32_t i = 0; i < kiDstHeight - 1; i++) {
-    int32_t iYy = iYInverse >> kiScaleBit;
-    int32_t iFv = iYInverse & (kiScale - 1);
+#if defined(X86_INTRINSICS)
+// (a, b) of the pixel pair at pSrc as two 16 bit lanes, the layout _mm_madd_epi16 expects
+static inline uint32_t LoadPixelPair (const uint8_t* pSrc) {
+  return (uint32_t)pSrc[0] | ((uint32_t)pSrc[1] << 16);
+}
 
-    uint8_t* pBySrc = pSrc + iYy * kiSrcStride;
+// 16 bit fractions of kiCount consecutive dst pixels starting at iXInverse, only the low bits are needed
+static inline void InitFractions (uint16_t* pFrac, const int32_t kiCount, const int32_t kiXInverse, const int32_t kiScaleX,
+                                  const int32_t kiMask) {
+  for (int32_t k = 0; k < kiCount; k++)
+    pFrac[k] = (uint16_t) ((kiXInverse + k * kiScaleX) & kiMask);
+}
 
-    pByDst = pByLineDst;
-    iXInverse = 1 << (kiScaleBit - 1);
-    for (int32_t j = 0; j < kiDstWidth - 1; j++) {
-      int32_t iXx = iXInverse >> kiScaleBit;
-      int32_t iFu = iXInverse & (kiScale - 1);
+static inline WELS_TARGET_SSE2 __m128i HalfAverage_sse2 (__m128i xRow0, __m128i xRow1) {
+  const __m128i kxMask = _mm_set1_epi16 (0x00ff);
+  __m128i xAvg0 = _mm_avg_epu16 (_mm_and_si128 (xRow0, kxMask), _mm_srli_epi16 (xRow0, 8));
+  __m128i xAvg1 = _mm_avg_epu16 (_mm_and_si128 (xRow1, kxMask), _mm_srli_epi16 (xRow1, 8));
+  return _mm_avg_epu16 (xAvg0, xAvg1);
+}
 
-      uint8_t* pByCurrent = pBySrc + iXx;
-      uint8_t a, b, c, d;
+WELS_TARGET_SSE2 void DyadicBilinearDownsampler_sse2 (uint8_t* pDst, const int32_t kiDstStride,
+    uint8_t* pSrc, const int32_t kiSrcStride,
+    const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  const int32_t kiDstWidth	= kiSrcWidth >> 1;
+  const int32_t kiDstHeight	= kiSrcHeight >> 1;
 
-      a = *pByCurrent;
-      b = * (pByCurrent + 1);
-      c = * (pByCurrent + kiSrcStride);
-      d = * (pByCurrent + kiSrcStride + 1);
+  for (int32_t j = 0; j < kiDstHeight; j++) {
+    const uint8_t* pRow0 = pSrc + (j << 1) * kiSrcStride;
+    const uint8_t* pRow1 = pRow0 + kiSrcStride;
+    uint8_t* pDstLine = pDst + j * kiDstStride;
+    int32_t i = 0;
+    for (; i + 16 <= kiDstWidth; i += 16) {
+      const int32_t kiSrcX = i << 1;
+      __m128i xLow = HalfAverage_sse2 (_mm_loadu_si128 ((const __m128i*) (pRow0 + kiSrcX)),
+                                       _mm_loadu_si128 ((const __m128i*) (pRow1 + kiSrcX)));
+      __m128i xHigh = HalfAverage_sse2 (_mm_loadu_si128 ((const __m128i*) (pRow0 + kiSrcX + 16)),
+                                        _mm_loadu_si128 ((const __m128i*) (pRow1 + kiSrcX + 16)));
+      _mm_storeu_si128 ((__m128i*) (pDstLine + i), _mm_packus_epi16 (xLow, xHigh));
+    }
+    for (; i < kiDstWidth; i++) {
+      const int32_t kiSrcX = i << 1;
+      const int32_t kiTempRow1 = (pRow0[kiSrcX] + pRow0[kiSrcX + 1] + 1) >> 1;
+      const int32_t kiTempRow2 = (pRow1[kiSrcX] + pRow1[kiSrcX + 1] + 1) >> 1;
+      pDstLine[i] = (uint8_t) ((kiTempRow1 + kiTempRow2 + 1) >> 1);
+    }
+  }
+}
 
-      x = (((int64_t) (kiScale - 1 - iFu)) * (kiScale - 1 - iFv) * a + ((int64_t)iFu) * (kiScale - 1 - iFv) * b + ((int64_t) (
-             kiScale - 1 - iFu)) * iFv * c +
-           ((int64_t)iFu) * iFv * d + (int64_t) (1 << (2 * kiScaleBit - 1))) >> (2 * kiScaleBit);
-      x = WELS_CLAMP (x, 0, 255);
-      *pByDst++ = (uint8_t)x;
+// (a, b) and (c, d) pairs of 4 dst pixels, iXInverse is the position of the first one
+static inline WELS_TARGET_SSE2 void LoadPairs4_sse2 (const uint8_t* pSrc, const int32_t kiSrcStride,
+    int32_t iXInverse, const int32_t kiScaleX, const int32_t kiScaleBit, __m128i& xTop, __m128i& xBottom) {
+  const uint8_t* p0 = pSrc + (iXInverse >> kiScaleBit);
+  const uint8_t* p1 = pSrc + ((iXInverse + kiScaleX) >> kiScaleBit);
+  const uint8_t* p2 = pSrc + ((iXInverse + 2 * kiScaleX) >> kiScaleBit);
+  const uint8_t* p3 = pSrc + ((iXInverse + 3 * kiScaleX) >> kiScaleBit);
+  xTop = _mm_setr_epi32 (LoadPixelPair (p0), LoadPixelPair (p1), LoadPixelPair (p2), LoadPixelPair (p3));
+  xBottom = _mm_setr_epi32 (LoadPixelPair (p0 + kiSrcStride), LoadPixelPair (p1 + kiSrcStride),
+                            LoadPixelPair (p2 + kiSrcStride), LoadPixelPair (p3 + kiSrcStride));
+}
 
-      iXInverse += iScalex;
-    }
-    *pByDst = * (pBySrc + (iXInverse >> kiScaleBit));
-    pByLineDst += kiDstStride;
-    iYInverse += iScaley;
+static WELS_TARGET_SSE2 void GeneralBilinearFastRow_sse2 (uint8_t* pDst, const uint8_t* pSrc, const int32_t kiSrcStride,
+    const int32_t kiStart, const int32_t kiEnd, const int32_t kiScaleX, const int32_t kiFv) {
+  ENFORCE_STACK_ALIGN_1D (uint16_t, uiFu, 8, 16);
+  const __m128i kxFv = _mm_set1_epi16 ((int16_t)kiFv);
+  const __m128i kxFvInv = _mm_set1_epi16 ((int16_t) (32767 - kiFv));
+  const __m128i kxFuStep = _mm_set1_epi16 ((int16_t) (kiScaleX << 3));
+  const __m128i kxOne = _mm_set1_epi32 (1);
+  int32_t iXInverse = (1 << 15) + kiStart * kiScaleX;
+  int32_t j = kiStart;
+
+  InitFractions (uiFu, 8, iXInverse, kiScaleX, 0xffff);
+  __m128i xFu = _mm_load_si128 ((const __m128i*)uiFu);
+  for (; j + 8 <= kiEnd; j += 8) {
+    __m128i xTop0, xBottom0, xTop1, xBottom1;
+    LoadPairs4_sse2 (pSrc, kiSrcStride, iXInverse, kiScaleX, 16, xTop0, xBottom0);
+    LoadPairs4_sse2 (pSrc, kiSrcStride, iXInverse + 4 * kiScaleX, kiScaleX, 16, xTop1, xBottom1);
+
+    // the four weights as the C code computes them: (u * v) >> 16
+    __m128i xFuInv = _mm_xor_si128 (xFu, _mm_set1_epi16 (-1));
+    __m128i xWa = _mm_mulhi_epu16 (xFuInv, kxFvInv);
+    __m128i xWb = _mm_mulhi_epu16 (xFu, kxFvInv);
+    __m128i xWc = _mm_mulhi_epu16 (xFuInv, kxFv);
+    __m128i xWd = _mm_mulhi_epu16 (xFu, kxFv);
+
+    __m128i xSum0 = _mm_add_epi32 (_mm_madd_epi16 (xTop0, _mm_unpacklo_epi16 (xWa, xWb)),
+                                   _mm_madd_epi16 (xBottom0, _mm_unpacklo_epi16 (xWc, xWd)));
+    __m128i xSum1 = _mm_add_epi32 (_mm_madd_epi16 (xTop1, _mm_unpackhi_epi16 (xWa, xWb)),
+                                   _mm_madd_epi16 (xBottom1, _mm_unpackhi_epi16 (xWc, xWd)));
+    xSum0 = _mm_srli_epi32 (_mm_add_epi32 (_mm_srli_epi32 (xSum0, 14), kxOne), 1);
+    xSum1 = _mm_srli_epi32 (_mm_add_epi32 (_mm_srli_epi32 (xSum1, 14), kxOne), 1);
+    __m128i xPix = _mm_packs_epi32 (xSum0, xSum1);
+    _mm_storel_epi64 ((__m128i*) (pDst + j), _mm_packus_epi16 (xPix, xPix));
+
+    xFu = _mm_add_epi16 (xFu, kxFuStep);
+    iXInverse += kiScaleX << 3;
+  }
+  GeneralBilinearFastRow_c (pDst, pSrc, kiSrcStride, j, kiEnd, kiScaleX, kiFv);
+}
+
+// ((32767 - fv) * kxTop + fv * kxBottom + (1 << 29)) >> 30 in 64 bit precision, kxFvInv/kxFv in the even 32 bit lanes
+static inline WELS_TARGET_SSE2 __m128i VerticalAccurate4_sse2 (__m128i xTop, __m128i xBottom, const __m128i kxFvInv,
+    const __m128i kxFv) {
+  const __m128i kxRound = _mm_set1_epi64x (1 << 29);
+  __m128i xEven = _mm_add_epi64 (_mm_mul_epu32 (xTop, kxFvInv), _mm_mul_epu32 (xBottom, kxFv));
+  __m128i xOdd = _mm_add_epi64 (_mm_mul_epu32 (_mm_srli_epi64 (xTop, 32), kxFvInv),
+                                _mm_mul_epu32 (_mm_srli_epi64 (xBottom, 32), kxFv));
+  xEven = _mm_srli_epi64 (_mm_add_epi64 (xEven, kxRound), 30);
+  xOdd = _mm_srli_epi64 (_mm_add_epi64 (xOdd, kxRound), 30);
+  return _mm_or_si128 (xEven, _mm_slli_epi64 (xOdd, 32));
+}
+
+static WELS_TARGET_SSE2 void GeneralBilinearAccurateRow_sse2 (uint8_t* pDst, const uint8_t* pSrc,
+    const int32_t kiSrcStride, const int32_t kiStart, const int32_t kiEnd, const int32_t kiScaleX, const int32_t kiFv) {
+  ENFORCE_STACK_ALIGN_1D (uint16_t, uiFu, 8, 16);
+  const __m128i kxFv = _mm_set1_epi32 (kiFv);
+  const __m128i kxFvInv = _mm_set1_epi32 (32767 - kiFv);
+  const __m128i kxFuMask = _mm_set1_epi16 (0x7fff);
+  const __m128i kxFuStep = _mm_set1_epi16 ((int16_t) (kiScaleX << 3));
+  int32_t iXInverse = (1 << 14) + kiStart * kiScaleX;
+  int32_t j = kiStart;
+
+  InitFractions (uiFu, 8, iXInverse, kiScaleX, 0xffff);
+  __m128i xFuAll = _mm_load_si128 ((const __m128i*)uiFu);
+  for (; j + 8 <= kiEnd; j += 8) {
+    __m128i xTop0, xBottom0, xTop1, xBottom1;
+    LoadPairs4_sse2 (pSrc, kiSrcStride, iXInverse, kiScaleX, 15, xTop0, xBottom0);
+    LoadPairs4_sse2 (pSrc, kiSrcStride, iXInverse + 4 * kiScaleX, kiScaleX, 15, xTop1, xBottom1);
+
+    // horizontal pass (32767 - fu) * a + fu * b stays below 2^23
+    __m128i xFu = _mm_and_si128 (xFuAll, kxFuMask);
+    __m128i xFuInv = _mm_xor_si128 (xFu, kxFuMask);
+    __m128i xW0 = _mm_unpacklo_epi16 (xFuInv, xFu);
+    __m128i xW1 = _mm_unpackhi_epi16 (xFuInv, xFu);
+    __m128i xSum0 = VerticalAccurate4_sse2 (_mm_madd_epi16 (xTop0, xW0), _mm_madd_epi16 (xBottom0, xW0), kxFvInv, kxFv);
+    __m128i xSum1 = VerticalAccurate4_sse2 (_mm_madd_epi16 (xTop1, xW1), _mm_madd_epi16 (xBottom1, xW1), kxFvInv, kxFv);
+    __m128i xPix = _mm_packs_epi32 (xSum0, xSum1);
+    _mm_storel_epi64 ((__m128i*) (pDst + j), _mm_packus_epi16 (xPix, xPix));
+
+    xFuAll = _mm_add_epi16 (xFuAll, kxFuStep);
+    iXInverse += kiScaleX << 3;
   }
+  GeneralBilinearAccurateRow_c (pDst, pSrc, kiSrcStride, j, kiEnd, kiScaleX, kiFv);
+}
+
+void GeneralBilinearFastDownsamplerRows_sse2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
+    const int32_t kiRowStart, const int32_t kiRowEnd) {
+  GeneralBilinearDownsampleRows (GeneralBilinearFastRow_sse2, 16, 15, pDst, kiDstStride, kiDstWidth, kiDstHeight,
+                                 pSrc, kiSrcStride, kiSrcWidth, kiSrcHeight, kiRowStart, kiRowEnd);
+}
+
+void GeneralBilinearAccurateDownsamplerRows_sse2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
+    const int32_t kiRowStart, const int32_t kiRowEnd) {
+  GeneralBilinearDownsampleRows (GeneralBilinearAccurateRow_sse2, 15, 15, pDst, kiDstStride, kiDstWidth, kiDstHeight,
+                                 pSrc, kiSrcStride, kiSrcWidth, kiSrcHeight, kiRowStart, kiRowEnd);
+}
+
+void GeneralBilinearFastDownsamplerWrap_sse2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  GeneralBilinearFastDownsamplerRows_sse2 (pDst, kiDstStride, kiDstWidth, kiDstHeight, pSrc, kiSrcStride, kiSrcWidth,
+      kiSrcHeight, 0, kiDstHeight);
+}
+
+void GeneralBilinearAccurateDownsamplerWrap_sse2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  GeneralBilinearAccurateDownsamplerRows_sse2 (pDst, kiDstStride, kiDstWidth, kiDstHeight, pSrc, kiSrcStride,
+      kiSrcWidth, kiSrcHeight, 0, kiDstHeight);
+}
 
-  // last row special
-  {
-    int32_t iYy = iYInverse >> kiScaleBit;
-    uint8_t* pBySrc = pSrc + iYy * kiSrcStride;
+static inline WELS_TARGET_AVX2 __m256i HalfAverage_avx2 (__m256i yRow0, __m256i yRow1) {
+  const __m256i kyMask = _mm256_set1_epi16 (0x00ff);
+  __m256i yAvg0 = _mm256_avg_epu16 (_mm256_and_si256 (yRow0, kyMask), _mm256_srli_epi16 (yRow0, 8));
+  __m256i yAvg1 = _mm256_avg_epu16 (_mm256_and_si256 (yRow1, kyMask), _mm256_srli_epi16 (yRow1, 8));
+  return _mm256_avg_epu16 (yAvg0, yAvg1);
+}
 
-    pByDst = pByLineDst;
-    iXInverse = 1 << (kiScaleBit - 1);
-    for (int32_t j = 0; j < kiDstWidth; j++) {
-      int32_t iXx = iXInverse >> kiScaleBit;
-      *pByDst++ = * (pBySrc + iXx);
+WELS_TARGET_AVX2 void DyadicBilinearDownsampler_avx2 (uint8_t* pDst, const int32_t kiDstStride,
+    uint8_t* pSrc, const int32_t kiSrcStride,
+    const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  const int32_t kiDstWidth	= kiSrcWidth >> 1;
+  const int32_t kiDstHeight	= kiSrcHeight >> 1;
 
-      iXInverse += iScalex;
+  for (int32_t j = 0; j < kiDstHeight; j++) {
+    const uint8_t* pRow0 = pSrc + (j << 1) * kiSrcStride;
+    const uint8_t* pRow1 = pRow0 + kiSrcStride;
+    uint8_t* pDstLine = pDst + j * kiDstStride;
+    int32_t i = 0;
+    for (; i + 32 <= kiDstWidth; i += 32) {
+      const int32_t kiSrcX = i << 1;
+      __m256i yLow = HalfAverage_avx2 (_mm256_loadu_si256 ((const __m256i*) (pRow0 + kiSrcX)),
+                                       _mm256_loadu_si256 ((const __m256i*) (pRow1 + kiSrcX)));
+      __m256i yHigh = HalfAverage_avx2 (_mm256_loadu_si256 ((const __m256i*) (pRow0 + kiSrcX + 32)),
+                                        _mm256_loadu_si256 ((const __m256i*) (pRow1 + kiSrcX + 32)));
+      // packus works per 128 bit lane, restore the pixel order
+      __m256i yPix = _mm256_permute4x64_epi64 (_mm256_packus_epi16 (yLow, yHigh), 0xd8);
+      _mm256_storeu_si256 ((__m256i*) (pDstLine + i), yPix);
+    }
+    for (; i < kiDstWidth; i++) {
+      const int32_t kiSrcX = i << 1;
+      const int32_t kiTempRow1 = (pRow0[kiSrcX] + pRow0[kiSrcX + 1] + 1) >> 1;
+      const int32_t kiTempRow2 = (pRow1[kiSrcX] + pRow1[kiSrcX + 1] + 1) >> 1;
+      pDstLine[i] = (uint8_t) ((kiTempRow1 + kiTempRow2 + 1) >> 1);
     }
   }
 }
 
+// pairs of dst pixels 0-3 and 8-11 in xTop/xBottom, 4-7 and 12-15 in the second call, matching unpack lo/hi lanes
+static inline WELS_TARGET_AVX2 void LoadPairs8_avx2 (const uint8_t* pSrc, const int32_t kiSrcStride,
+    int32_t iXInverse, const int32_t kiScaleX, const int32_t kiScaleBit, __m256i& yTop, __m256i& yBottom) {
+  __m128i xTopLow, xBottomLow, xTopHigh, xBottomHigh;
+  LoadPairs4_sse2 (pSrc, kiSrcStride, iXInverse, kiScaleX, kiScaleBit, xTopLow, xBottomLow);
+  LoadPairs4_sse2 (pSrc, kiSrcStride, iXInverse + 8 * kiScaleX, kiScaleX, kiScaleBit, xTopHigh, xBottomHigh);
+  yTop = _mm256_inserti128_si256 (_mm256_castsi128_si256 (xTopLow), xTopHigh, 1);
+  yBottom = _mm256_inserti128_si256 (_mm256_castsi128_si256 (xBottomLow), xBottomHigh, 1);
+}
 
-#ifdef X86_ASM
-//void GeneralBilinearFastDownsamplerWrap_sse2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
-//    const int32_t kiDstHeight,
-//    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
-//  const int32_t kiScaleBitWidth = 16, kiScaleBitHeight = 15;
-//  const uint32_t kuiScaleWidth = (1 << kiScaleBitWidth), kuiScaleHeight = (1 << kiScaleBitHeight);
-//
-//  uint32_t uiScalex = (uint32_t) ((float)kiSrcWidth / (float)kiDstWidth * kuiScaleWidth);
-//  uint32_t uiScaley = (uint32_t) ((float)kiSrcHeight / (float)kiDstHeight * kuiScaleHeight);
-//
-//  GeneralBilinearFastDownsampler_sse2 (pDst, kiDstStride, kiDstWidth, kiDstHeight,
-//                                       pSrc, kiSrcStride, kiSrcWidth, kiSrcHeight, uiScalex, uiScaley);
-//}
-//
-//void GeneralBilinearAccurateDownsamplerWrap_sse2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
-//    const int32_t kiDstHeight,
-//    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
-//  const int32_t kiScaleBit = 15;
-//  const uint32_t kuiScale = (1 << kiScaleBit);
-//
-//  uint32_t uiScalex = (uint32_t) ((float)kiSrcWidth / (float)kiDstWidth * kuiScale);
-//  uint32_t uiScaley = (uint32_t) ((float)kiSrcHeight / (float)kiDstHeight * kuiScale);
-//
-//  GeneralBilinearAccurateDownsampler_sse2 (pDst, kiDstStride, kiDstWidth, kiDstHeight,
-//      pSrc, kiSrcStride, kiSrcWidth, kiSrcHeight, uiScalex, uiScaley);
-//}
-#endif //X86_ASM
+static inline WELS_TARGET_AVX2 void StorePixels16_avx2 (uint8_t* pDst, __m256i ySum0, __m256i ySum1) {
+  __m256i yPix = _mm256_packs_epi32 (ySum0, ySum1);
+  _mm_storeu_si128 ((__m128i*)pDst, _mm_packus_epi16 (_mm256_castsi256_si128 (yPix),
+                    _mm256_extracti128_si256 (yPix, 1)));
+}
+
+static WELS_TARGET_AVX2 void GeneralBilinearFastRow_avx2 (uint8_t* pDst, const uint8_t* pSrc, const int32_t kiSrcStride,
+    const int32_t kiStart, const int32_t kiEnd, const int32_t kiScaleX, const int32_t kiFv) {
+  ENFORCE_STACK_ALIGN_1D (uint16_t, uiFu, 16, 32);
+  const __m256i kyFv = _mm256_set1_epi16 ((int16_t)kiFv);
+  const __m256i kyFvInv = _mm256_set1_epi16 ((int16_t) (32767 - kiFv));
+  const __m256i kyFuStep = _mm256_set1_epi16 ((int16_t) (kiScaleX << 4));
+  const __m256i kyOne = _mm256_set1_epi32 (1);
+  int32_t iXInverse = (1 << 15) + kiStart * kiScaleX;
+  int32_t j = kiStart;
+
+  InitFractions (uiFu, 16, iXInverse, kiScaleX, 0xffff);
+  __m256i yFu = _mm256_load_si256 ((const __m256i*)uiFu);
+  for (; j + 16 <= kiEnd; j += 16) {
+    __m256i yTop0, yBottom0, yTop1, yBottom1;
+    LoadPairs8_avx2 (pSrc, kiSrcStride, iXInverse, kiScaleX, 16, yTop0, yBottom0);
+    LoadPairs8_avx2 (pSrc, kiSrcStride, iXInverse + 4 * kiScaleX, kiScaleX, 16, yTop1, yBottom1);
+
+    __m256i yFuInv = _mm256_xor_si256 (yFu, _mm256_set1_epi16 (-1));
+    __m256i yWa = _mm256_mulhi_epu16 (yFuInv, kyFvInv);
+    __m256i yWb = _mm256_mulhi_epu16 (yFu, kyFvInv);
+    __m256i yWc = _mm256_mulhi_epu16 (yFuInv, kyFv);
+    __m256i yWd = _mm256_mulhi_epu16 (yFu, kyFv);
+
+    __m256i ySum0 = _mm256_add_epi32 (_mm256_madd_epi16 (yTop0, _mm256_unpacklo_epi16 (yWa, yWb)),
+                                      _mm256_madd_epi16 (yBottom0, _mm256_unpacklo_epi16 (yWc, yWd)));
+    __m256i ySum1 = _mm256_add_epi32 (_mm256_madd_epi16 (yTop1, _mm256_unpackhi_epi16 (yWa, yWb)),
+                                      _mm256_madd_epi16 (yBottom1, _mm256_unpackhi_epi16 (yWc, yWd)));
+    ySum0 = _mm256_srli_epi32 (_mm256_add_epi32 (_mm256_srli_epi32 (ySum0, 14), kyOne), 1);
+    ySum1 = _mm256_srli_epi32 (_mm256_add_epi32 (_mm256_srli_epi32 (ySum1, 14), kyOne), 1);
+    StorePixels16_avx2 (pDst + j, ySum0, ySum1);
+
+    yFu = _mm256_add_epi16 (yFu, kyFuStep);
+    iXInverse += kiScaleX << 4;
+  }
+  GeneralBilinearFastRow_c (pDst, pSrc, kiSrcStride, j, kiEnd, kiScaleX, kiFv);
+}
+
+static inline WELS_TARGET_AVX2 __m256i VerticalAccurate8_avx2 (__m256i yTop, __m256i yBottom, const __m256i kyFvInv,
+    const __m256i kyFv) {
+  const __m256i kyRound = _mm256_set1_epi64x (1 << 29);
+  __m256i yEven = _mm256_add_epi64 (_mm256_mul_epu32 (yTop, kyFvInv), _mm256_mul_epu32 (yBottom, kyFv));
+  __m256i yOdd = _mm256_add_epi64 (_mm256_mul_epu32 (_mm256_srli_epi64 (yTop, 32), kyFvInv),
+                                   _mm256_mul_epu32 (_mm256_srli_epi64 (yBottom, 32), kyFv));
+  yEven = _mm256_srli_epi64 (_mm256_add_epi64 (yEven, kyRound), 30);
+  yOdd = _mm256_srli_epi64 (_mm256_add_epi64 (yOdd, kyRound), 30);
+  return _mm256_or_si256 (yEven, _mm256_slli_epi64 (yOdd, 32));
+}
+
+static WELS_TARGET_AVX2 void GeneralBilinearAccurateRow_avx2 (uint8_t* pDst, const uint8_t* pSrc,
+    const int32_t kiSrcStride, const int32_t kiStart, const int32_t kiEnd, const int32_t kiScaleX, const int32_t kiFv) {
+  ENFORCE_STACK_ALIGN_1D (uint16_t, uiFu, 16, 32);
+  const __m256i kyFv = _mm256_set1_epi32 (kiFv);
+  const __m256i kyFvInv = _mm256_set1_epi32 (32767 - kiFv);
+  const __m256i kyFuMask = _mm256_set1_epi16 (0x7fff);
+  const __m256i kyFuStep = _mm256_set1_epi16 ((int16_t) (kiScaleX << 4));
+  int32_t iXInverse = (1 << 14) + kiStart * kiScaleX;
+  int32_t j = kiStart;
+
+  InitFractions (uiFu, 16, iXInverse, kiScaleX, 0xffff);
+  __m256i yFuAll = _mm256_load_si256 ((const __m256i*)uiFu);
+  for (; j + 16 <= kiEnd; j += 16) {
+    __m256i yTop0, yBottom0, yTop1, yBottom1;
+    LoadPairs8_avx2 (pSrc, kiSrcStride, iXInverse, kiScaleX, 15, yTop0, yBottom0);
+    LoadPairs8_avx2 (pSrc, kiSrcStride, iXInverse + 4 * kiScaleX, kiScaleX, 15, yTop1, yBottom1);
+
+    __m256i yFu = _mm256_and_si256 (yFuAll, kyFuMask);
+    __m256i yFuInv = _mm256_xor_si256 (yFu, kyFuMask);
+    __m256i yW0 = _mm256_unpacklo_epi16 (yFuInv, yFu);
+    __m256i yW1 = _mm256_unpackhi_epi16 (yFuInv, yFu);
+    __m256i ySum0 = VerticalAccurate8_avx2 (_mm256_madd_epi16 (yTop0, yW0), _mm256_madd_epi16 (yBottom0, yW0), kyFvInv,
+                                            kyFv);
+    __m256i ySum1 = VerticalAccurate8_avx2 (_mm256_madd_epi16 (yTop1, yW1), _mm256_madd_epi16 (yBottom1, yW1), kyFvInv,
+                                            kyFv);
+    StorePixels16_avx2 (pDst + j, ySum0, ySum1);
+
+    yFuAll = _mm256_add_epi16 (yFuAll, kyFuStep);
+    iXInverse += kiScaleX << 4;
+  }
+  GeneralBilinearAccurateRow_c (pDst, pSrc, kiSrcStride, j, kiEnd, kiScaleX, kiFv);
+}
+
+void GeneralBilinearFastDownsamplerRows_avx2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
+    const int32_t kiRowStart, const int32_t kiRowEnd) {
+  GeneralBilinearDownsampleRows (GeneralBilinearFastRow_avx2, 16, 15, pDst, kiDstStride, kiDstWidth, kiDstHeight,
+                                 pSrc, kiSrcStride, kiSrcWidth, kiSrcHeight, kiRowStart, kiRowEnd);
+}
+
+void GeneralBilinearAccurateDownsamplerRows_avx2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight,
+    const int32_t kiRowStart, const int32_t kiRowEnd) {
+  GeneralBilinearDownsampleRows (GeneralBilinearAccurateRow_avx2, 15, 15, pDst, kiDstStride, kiDstWidth, kiDstHeight,
+                                 pSrc, kiSrcStride, kiSrcWidth, kiSrcHeight, kiRowStart, kiRowEnd);
+}
+
+void GeneralBilinearFastDownsampler_avx2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  GeneralBilinearFastDownsamplerRows_avx2 (pDst, kiDstStride, kiDstWidth, kiDstHeight, pSrc, kiSrcStride, kiSrcWidth,
+      kiSrcHeight, 0, kiDstHeight);
+}
+
+void GeneralBilinearAccurateDownsampler_avx2 (uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth,
+    const int32_t kiDstHeight,
+    uint8_t* pSrc, const int32_t kiSrcStride, const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  GeneralBilinearAccurateDownsamplerRows_avx2 (pDst, kiDstStride, kiDstWidth, kiDstHeight, pSrc, kiSrcStride,
+      kiSrcWidth, kiSrcHeight, 0, kiDstHeight);
+}
+#endif //X86_INTRINSICS
 
 #ifdef HAVE_NEON
 void GeneralBilinearAccurateDownsamplerWrap_neon(uint8_t* pDst, const int32_t kiDstStride, const int32_t kiDstWidth, const int32_t kiDstHeight,
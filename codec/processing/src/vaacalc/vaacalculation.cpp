@@ -76,6 +76,63 @@ void CVAACalculation::InitVaaFuncs (SVaaFuncs& sVaaFuncs, int32_t iCpuFlag) {
 #endif//HAVE_NEON
 }
 
+typedef struct {
+  CVAACalculation* pVaa;
+  uint8_t* pCurData;
+  uint8_t* pRefData;
+  int32_t  iPicWidth;
+  int32_t  iPicStride;
+  int32_t  iMbRowStart;
+  int32_t  iMbRowEnd;
+  int32_t  iFrameSad;
+} SVaaStripe;
+
+void CVAACalculation::CalcStripe (void* pArg) {
+  SVaaStripe* pStripe = (SVaaStripe*)pArg;
+  pStripe->pVaa->CalcMbRows (pStripe->pCurData, pStripe->pRefData, pStripe->iPicWidth, pStripe->iPicStride,
+                             pStripe->iMbRowStart, pStripe->iMbRowEnd, &pStripe->iFrameSad);
+}
+
+/*
+ *	statistics of the MB rows [iMbRowStart, iMbRowEnd), the results are stored at the MB positions of the picture
+ */
+void CVAACalculation::CalcMbRows (uint8_t* pCurData, uint8_t* pRefData, int32_t iPicWidth, int32_t iPicStride,
+                                  int32_t iMbRowStart, int32_t iMbRowEnd, int32_t* pFrameSad) {
+  SVAACalcResult* pResult = m_sCalcParam.pCalcResult;
+  const int32_t kiMbOffset = iMbRowStart * (iPicWidth >> 4);
+  const int32_t kiHeight = (iMbRowEnd - iMbRowStart) << 4;
+
+  pCurData += (iMbRowStart << 4) * iPicStride;
+  pRefData += (iMbRowStart << 4) * iPicStride;
+  if (m_sCalcParam.iCalcBgd) {
+    if (m_sCalcParam.iCalcSsd) {
+      m_sVaaFuncs.pfVAACalcSadSsdBgd (pCurData, pRefData, iPicWidth, kiHeight, iPicStride, pFrameSad,
+                                      (int32_t*) (pResult->pSad8x8 + kiMbOffset), pResult->pSum16x16 + kiMbOffset,
+                                      pResult->pSumOfSquare16x16 + kiMbOffset, pResult->pSsd16x16 + kiMbOffset,
+                                      (int32_t*) (pResult->pSumOfDiff8x8 + kiMbOffset), (uint8_t*) (pResult->pMad8x8 + kiMbOffset));
+    } else {
+      m_sVaaFuncs.pfVAACalcSadBgd (pCurData, pRefData, iPicWidth, kiHeight, iPicStride, pFrameSad,
+                                   (int32_t*) (pResult->pSad8x8 + kiMbOffset), (int32_t*) (pResult->pSumOfDiff8x8 + kiMbOffset),
+                                   (uint8_t*) (pResult->pMad8x8 + kiMbOffset));
+    }
+  } else {
+    if (m_sCalcParam.iCalcSsd) {
+      m_sVaaFuncs.pfVAACalcSadSsd (pCurData, pRefData, iPicWidth, kiHeight, iPicStride, pFrameSad,
+                                   (int32_t*) (pResult->pSad8x8 + kiMbOffset), pResult->pSum16x16 + kiMbOffset,
+                                   pResult->pSumOfSquare16x16 + kiMbOffset, pResult->pSsd16x16 + kiMbOffset);
+    } else {
+      if (m_sCalcParam.iCalcVar) {
+        m_sVaaFuncs.pfVAACalcSadVar (pCurData, pRefData, iPicWidth, kiHeight, iPicStride, pFrameSad,
+                                     (int32_t*) (pResult->pSad8x8 + kiMbOffset), pResult->pSum16x16 + kiMbOffset,
+                                     pResult->pSumOfSquare16x16 + kiMbOffset);
+      } else {
+        m_sVaaFuncs.pfVAACalcSad (pCurData, pRefData, iPicWidth, kiHeight, iPicStride, pFrameSad,
+                                  (int32_t*) (pResult->pSad8x8 + kiMbOffset));
+      }
+    }
+  }
+}
+
 EResult CVAACalculation::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* pRefPixMap) {
   uint8_t* pCurData	= (uint8_t*)pSrcPixMap->pPixel[0];
   uint8_t* pRefData	= (uint8_t*)pRefPixMap->pPixel[0];
@@ -91,29 +148,36 @@ EResult CVAACalculation::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* p
 
   pResult->pCurY = pCurData;
   pResult->pRefY = pRefData;
-  if (m_sCalcParam.iCalcBgd) {
-    if (m_sCalcParam.iCalcSsd) {
-      m_sVaaFuncs.pfVAACalcSadSsdBgd (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                      (int32_t*)pResult->pSad8x8, pResult->pSum16x16, pResult->pSumOfSquare16x16, pResult->pSsd16x16,
-                                      (int32_t*)pResult->pSumOfDiff8x8, (uint8_t*)pResult->pMad8x8);
-    } else {
-      m_sVaaFuncs.pfVAACalcSadBgd (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                   (int32_t*) (pResult->pSad8x8), (int32_t*) (pResult->pSumOfDiff8x8), (uint8_t*)pResult->pMad8x8);
-    }
-  } else {
-    if (m_sCalcParam.iCalcSsd) {
-      m_sVaaFuncs.pfVAACalcSadSsd (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                   (int32_t*)pResult->pSad8x8, pResult->pSum16x16, pResult->pSumOfSquare16x16, pResult->pSsd16x16);
-    } else {
-      if (m_sCalcParam.iCalcVar) {
-        m_sVaaFuncs.pfVAACalcSadVar (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                     (int32_t*)pResult->pSad8x8, pResult->pSum16x16, pResult->pSumOfSquare16x16);
-      } else {
-        m_sVaaFuncs.pfVAACalcSad (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                  (int32_t*)pResult->pSad8x8);
-      }
-    }
+
+  const int32_t kiMbHeight = iPicHeight >> 4;
+  const int32_t kiStripeNum = WELS_CLAMP (kiMbHeight, 1, m_iStripeNum);
+  if (kiStripeNum <= 1) {
+    CalcMbRows (pCurData, pRefData, iPicWidth, iPicStride, 0, kiMbHeight, &pResult->iFrameSad);
+    return RET_SUCCESS;
+  }
+
+  // the MB rows are independent, each stripe sums the SAD of its own rows
+  SVaaStripe sStripes[WELS_THREAD_POOL_MAX_THREADS];
+  SWelsTaskGroup sGroup;
+  WelsMemset (&sGroup, 0, sizeof (sGroup));
+  for (int32_t i = 0; i < kiStripeNum; i++) {
+    sStripes[i].pVaa        = this;
+    sStripes[i].pCurData    = pCurData;
+    sStripes[i].pRefData    = pRefData;
+    sStripes[i].iPicWidth   = iPicWidth;
+    sStripes[i].iPicStride  = iPicStride;
+    sStripes[i].iMbRowStart = kiMbHeight * i / kiStripeNum;
+    sStripes[i].iMbRowEnd   = kiMbHeight * (i + 1) / kiStripeNum;
+    sStripes[i].iFrameSad   = 0;
+    if (i > 0)
+      WelsThreadPoolSubmit (m_pThreadPool, &sGroup, CalcStripe, &sStripes[i]);
   }
+  CalcStripe (&sStripes[0]);
+  WelsThreadPoolWait (m_pThreadPool, &sGroup);
+
+  pResult->iFrameSad = 0;
+  for (int32_t i = 0; i < kiStripeNum; i++)
+    pResult->iFrameSad += sStripes[i].iFrameSad;
 
   return RET_SUCCESS;
 }
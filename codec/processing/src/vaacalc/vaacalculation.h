@@ -123,6 +123,9 @@ class CVAACalculation : public IStrategy {
 
  private:
   void InitVaaFuncs (SVaaFuncs& sVaaFunc, int32_t iCpuFlag);
+  void CalcMbRows (uint8_t* pCurData, uint8_t* pRefData, int32_t iPicWidth, int32_t iPicStride, int32_t iMbRowStart,
+                   int32_t iMbRowEnd, int32_t* pFrameSad);
+  static void CalcStripe (void* pArg);
 
  private:
   SVaaFuncs      m_sVaaFuncs;
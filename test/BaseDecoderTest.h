@@ -4,6 +4,7 @@
 #include "test_stdint.h"
 #include <limits.h>
 #include <fstream>
+#include <vector>
 #include "codec_api.h"
 
 #include "utils/BufferedData.h"
@@ -28,17 +29,26 @@ class BaseDecoderTest {
   };
 
   BaseDecoderTest();
+  static void GetDefaultParam(SDecodingParam* param);
   void SetUp();
+  void SetUp(const SDecodingParam& param);
   void TearDown();
   void DecodeFile(const char* fileName, Callback* cbk);
+  void DecodeFileZeroCopy(const char* fileName, Callback* cbk);
 
   bool Open(const char* fileName);
   bool DecodeNextFrame(Callback* cbk);
 
+  ISVCDecoder* decoder() {
+    return decoder_;
+  }
+
  private:
   void DecodeFrame(const uint8_t* src, int sliceSize, Callback* cbk);
+  void FlushFrames(Callback* cbk);
 
   ISVCDecoder* decoder_;
+  int frameCount_;
   std::ifstream file_;
   BufferedData buf_;
   enum {
@@ -11,11 +11,27 @@ class BaseEncoderTest {
     virtual void onEncodeFrame(const SFrameBSInfo& frameInfo) = 0;
   };
 
+  // how the source pictures reach the encoder, all of them give the same bitstream
+  enum InputMode {
+    InputCopied,
+    InputPipelined,	// submitted ahead of their coding, see SubmitFrame()
+    InputZeroCopy,	// planes of the application coded by reference
+    InputNV12	// NV12 sources converted in the preprocessing
+  };
+
+  // the way a file is coded beyond its SEncParamBase, all off when zeroed
+  struct Options {
+    bool parallelLayers;	// spatial layers coded concurrently
+    bool singleSliceBase;	// single slice base layer under sliced enhancement layers
+    bool hierarchicalMe;	// motion search seeded from the lower layer or a half resolution search
+    InputMode inputMode;
+  };
+
   BaseEncoderTest();
   void SetUp();
   void TearDown();
-  void EncodeFile(const char* fileName, EUsageType usageType, int width, int height, float frameRate, SliceModeEnum slices, bool denoise, int layers, Callback* cbk);
-  void EncodeStream(InputStream* in, EUsageType usageType, int width, int height, float frameRate, SliceModeEnum slices, bool denoise, int layers, Callback* cbk);
+  void EncodeFile(const char* fileName, EUsageType usageType, int width, int height, float frameRate, SliceModeEnum slices, bool denoise, int layers, Callback* cbk, const Options& options = Options());
+  void EncodeStream(InputStream* in, EUsageType usageType, int width, int height, float frameRate, SliceModeEnum slices, bool denoise, int layers, Callback* cbk, const Options& options = Options());
 
  private:
   ISVCEncoder* encoder_;
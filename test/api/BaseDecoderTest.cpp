@@ -44,21 +44,28 @@ static void ReadFrame(std::ifstream* file, BufferedData* buf) {
 }
 
 BaseDecoderTest::BaseDecoderTest()
-  : decoder_(NULL), decodeStatus_(OpenFile) {}
+  : decoder_(NULL), frameCount_(0), decodeStatus_(OpenFile) {}
+
+void BaseDecoderTest::GetDefaultParam(SDecodingParam* param) {
+  memset(param, 0, sizeof(SDecodingParam));
+  param->iOutputColorFormat  = videoFormatI420;
+  param->uiTargetDqLayer = UCHAR_MAX;
+  param->uiEcActiveFlag  = 1;
+  param->sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_DEFAULT;
+}
 
 void BaseDecoderTest::SetUp() {
+  SDecodingParam decParam;
+  GetDefaultParam(&decParam);
+  SetUp(decParam);
+}
+
+void BaseDecoderTest::SetUp(const SDecodingParam& param) {
   long rv = WelsCreateDecoder(&decoder_);
   ASSERT_EQ(0, rv);
   ASSERT_TRUE(decoder_ != NULL);
 
-  SDecodingParam decParam;
-  memset(&decParam, 0, sizeof(SDecodingParam));
-  decParam.iOutputColorFormat  = videoFormatI420;
-  decParam.uiTargetDqLayer = UCHAR_MAX;
-  decParam.uiEcActiveFlag  = 1;
-  decParam.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_DEFAULT;
-
-  rv = decoder_->Initialize(&decParam);
+  rv = decoder_->Initialize(&param);
   ASSERT_EQ(0, rv);
 }
 
@@ -79,6 +86,9 @@ void BaseDecoderTest::DecodeFrame(const uint8_t* src, int sliceSize, Callback* c
   DECODING_STATE rv = decoder_->DecodeFrame2(src, sliceSize, data, &bufInfo);
   ASSERT_TRUE(rv == dsErrorFree);
 
+  if (bufInfo.iBufferStatus == 1) {
+    frameCount_++;
+  }
   if (bufInfo.iBufferStatus == 1 && cbk != NULL) {
     const Frame frame = {
         { // y plane
@@ -103,6 +113,18 @@ void BaseDecoderTest::DecodeFrame(const uint8_t* src, int sliceSize, Callback* c
     cbk->onDecodeFrame(frame);
   }
 }
+
+void BaseDecoderTest::FlushFrames(Callback* cbk) {
+  int32_t iEndOfStreamFlag = 1;
+  decoder_->SetOption(DECODER_OPTION_END_OF_STREAM, &iEndOfStreamFlag);
+
+  // Get pending last frames, more than one may be in flight with threads
+  int frameCount;
+  do {
+    frameCount = frameCount_;
+    DecodeFrame(NULL, 0, cbk);
+  } while (frameCount_ != frameCount && !::testing::Test::HasFatalFailure());
+}
 void BaseDecoderTest::DecodeFile(const char* fileName, Callback* cbk) {
   std::ifstream file(fileName, std::ios::in | std::ios::binary);
   ASSERT_TRUE(file.is_open());
@@ -122,11 +144,37 @@ void BaseDecoderTest::DecodeFile(const char* fileName, Callback* cbk) {
     }
   }
 
-  int32_t iEndOfStreamFlag = 1;
-  decoder_->SetOption(DECODER_OPTION_END_OF_STREAM, &iEndOfStreamFlag);
+  FlushFrames(cbk);
+}
+
+void BaseDecoderTest::DecodeFileZeroCopy(const char* fileName, Callback* cbk) {
+  std::ifstream file(fileName, std::ios::in | std::ios::binary);
+  ASSERT_TRUE(file.is_open());
+
+  // the whole stream stays in memory, frames are passed without padding as nothing past them is read
+  std::vector<uint8_t> data;
+  char b;
+  while (file.get(b)) {
+    data.push_back(static_cast<uint8_t>(b));
+  }
+  const int size = static_cast<int>(data.size());
+
+  int zeroCopy = 1;
+  ASSERT_EQ(0, decoder_->SetOption(DECODER_OPTION_ZERO_COPY_INPUT, &zeroCopy));
 
-  // Get pending last frame
-  DecodeFrame(NULL, 0, cbk);
+  // start code of a frame is {0, 0, 0, 1}
+  int start = 0;
+  for (int i = 1; i <= size; ++i) {
+    if (i == size || (i + 4 <= size && data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 0 && data[i + 3] == 1)) {
+      DecodeFrame(&data[start], i - start, cbk);
+      if (::testing::Test::HasFatalFailure()) {
+        return;
+      }
+      start = i;
+    }
+  }
+
+  FlushFrames(cbk);
 }
 
 bool BaseDecoderTest::Open(const char* fileName) {
@@ -156,13 +204,10 @@ bool BaseDecoderTest::DecodeNextFrame(Callback* cbk) {
       return false;
     }
     return true;
-  case EndOfStream: {
-    int32_t iEndOfStreamFlag = 1;
-    decoder_->SetOption(DECODER_OPTION_END_OF_STREAM, &iEndOfStreamFlag);
-    DecodeFrame(NULL, 0, cbk);
+  case EndOfStream:
+    FlushFrames(cbk);
     decodeStatus_ = End;
     break;
-  }
   case OpenFile:
   case End:
     break;
@@ -1,4 +1,5 @@
 #include <fstream>
+#include <map>
 #include <gtest/gtest.h>
 #include "codec_def.h"
 #include "utils/BufferedData.h"
@@ -6,8 +7,9 @@
 #include "BaseEncoderTest.h"
 
 static int InitWithParam(ISVCEncoder* encoder, EUsageType usageType,int width,
-    int height, float frameRate, SliceModeEnum sliceMode, bool denoise, int layers) {
-  if (SM_SINGLE_SLICE == sliceMode && !denoise && layers == 1) {
+    int height, float frameRate, SliceModeEnum sliceMode, bool denoise, int layers,
+    const BaseEncoderTest::Options& options, int colorFormat) {
+  if (SM_SINGLE_SLICE == sliceMode && !denoise && layers == 1 && !options.hierarchicalMe) {
     SEncParamBase param;
     memset (&param, 0, sizeof(SEncParamBase));
     
@@ -16,7 +18,7 @@ static int InitWithParam(ISVCEncoder* encoder, EUsageType usageType,int width,
     param.iPicWidth = width;
     param.iPicHeight = height;
     param.iTargetBitrate = 5000000;
-    param.iInputCsp = videoFormatI420;
+    param.iInputCsp = colorFormat;
 
     return encoder->Initialize(&param);
   } else {
@@ -28,12 +30,16 @@ static int InitWithParam(ISVCEncoder* encoder, EUsageType usageType,int width,
     param.iPicWidth = width;
     param.iPicHeight = height;
     param.iTargetBitrate = 5000000;
-    param.iInputCsp = videoFormatI420;
+    param.iInputCsp = colorFormat;
     param.bEnableDenoise = denoise;
     param.iSpatialLayerNum = layers;
+    param.bParallelSpatialLayers = options.parallelLayers;
+    param.bEnableHierarchicalMe = options.hierarchicalMe;
 
     if (sliceMode != SM_SINGLE_SLICE)
       param.iMultipleThreadIdc = 2;
+    if (sliceMode == SM_DYN_SLICE)
+      param.uiMaxNalSize = 1500;
 
     for (int i = 0; i < param.iSpatialLayerNum; i++) {
       param.sSpatialLayers[i].iVideoWidth = width >> (param.iSpatialLayerNum - 1 - i);
@@ -41,13 +47,48 @@ static int InitWithParam(ISVCEncoder* encoder, EUsageType usageType,int width,
       param.sSpatialLayers[i].fFrameRate = frameRate;
       param.sSpatialLayers[i].iSpatialBitrate = param.iTargetBitrate;
 
-      param.sSpatialLayers[i].sSliceCfg.uiSliceMode = sliceMode;
+      param.sSpatialLayers[i].sSliceCfg.uiSliceMode = (options.singleSliceBase && i == 0) ? SM_SINGLE_SLICE : sliceMode;
     }
 
     return encoder->InitializeExt(&param);
   }
 }
 
+// pictures handed to the encoder by reference, by luma plane with the allocation holding it
+typedef std::map<unsigned char*, unsigned char*> ZeroCopyPictures;
+
+static void ReleaseZeroCopySource(void* ctx, unsigned char* data) {
+  ZeroCopyPictures* pictures = static_cast<ZeroCopyPictures*>(ctx);
+  ZeroCopyPictures::iterator it = pictures->find(data);
+  ASSERT_TRUE(it != pictures->end()) << "picture released twice or never given";
+  free(it->second);
+  pictures->erase(it);
+}
+
+// an I420 picture laid out the way the encoder can reference it, filled from src
+static void AllocZeroCopyPicture(ZeroCopyPictures* pictures, const SZeroCopySource& zeroCopy, SSourcePicture* pic,
+    const unsigned char* src) {
+  const int padding = zeroCopy.iPadding;
+  const int lumaSize = zeroCopy.iStride[0] * (pic->iPicHeight + 2 * padding);
+  const int chromaSize = zeroCopy.iStride[1] * ((pic->iPicHeight + 2 * padding) >> 1);
+  unsigned char* buffer = static_cast<unsigned char*>(malloc(lumaSize + 2 * chromaSize + 16));
+  unsigned char* aligned = buffer + ((16 - ((size_t)buffer & 15)) & 15);
+  memset(aligned, 0, lumaSize + 2 * chromaSize);
+
+  pic->iStride[0] = zeroCopy.iStride[0];
+  pic->iStride[1] = pic->iStride[2] = zeroCopy.iStride[1];
+  pic->pData[0] = aligned + (1 + pic->iStride[0]) * padding;
+  pic->pData[1] = aligned + lumaSize + (((1 + pic->iStride[1]) * padding) >> 1);
+  pic->pData[2] = aligned + lumaSize + chromaSize + (((1 + pic->iStride[2]) * padding) >> 1);
+  for (int i = 0; i < 3; i++) {
+    const int width = i ? pic->iPicWidth >> 1 : pic->iPicWidth;
+    const int height = i ? pic->iPicHeight >> 1 : pic->iPicHeight;
+    for (int y = 0; y < height; y++, src += width)
+      memcpy(pic->pData[i] + y * pic->iStride[i], src, width);
+  }
+  (*pictures)[pic->pData[0]] = buffer;
+}
+
 BaseEncoderTest::BaseEncoderTest() : encoder_(NULL) {}
 
 void BaseEncoderTest::SetUp() {
@@ -64,8 +105,11 @@ void BaseEncoderTest::TearDown() {
 }
 
 void BaseEncoderTest::EncodeStream(InputStream* in, EUsageType usageType, int width, int height,
-    float frameRate, SliceModeEnum slices, bool denoise, int layers, Callback* cbk) {
-  int rv = InitWithParam(encoder_, usageType, width, height, frameRate, slices, denoise, layers);
+    float frameRate, SliceModeEnum slices, bool denoise, int layers, Callback* cbk, const Options& options) {
+  const bool pipelined = options.inputMode == InputPipelined;
+  const bool zeroCopy = options.inputMode == InputZeroCopy;
+  const int colorFormat = options.inputMode == InputNV12 ? videoFormatNV12 : videoFormatI420;
+  int rv = InitWithParam(encoder_, usageType, width, height, frameRate, slices, denoise, layers, options, colorFormat);
   ASSERT_TRUE(rv == cmResultSuccess);
 
   // I420: 1(Y) + 1/4(U) + 1/4(V)
@@ -88,18 +132,81 @@ void BaseEncoderTest::EncodeStream(InputStream* in, EUsageType usageType, int wi
   pic.pData[0] = buf.data();
   pic.pData[1] = pic.pData[0] + width *height;
   pic.pData[2] = pic.pData[1] + (width*height>>2);
+
+  // NV12 pictures interleave the chroma planes of the file
+  BufferedData nv12;
+  if (colorFormat == videoFormatNV12) {
+    nv12.SetLength(frameSize);
+    ASSERT_TRUE(nv12.Length() == frameSize);
+    pic.iColorFormat = videoFormatNV12;
+    pic.iStride[1] = pic.iPicWidth;
+    pic.iStride[2] = 0;
+    pic.pData[0] = nv12.data();
+    pic.pData[1] = pic.pData[0] + width * height;
+    pic.pData[2] = NULL;
+  }
+
+  ZeroCopyPictures zeroCopyPictures;
+  SZeroCopySource zeroCopySource;
+  if (zeroCopy) {
+    ASSERT_EQ(0, encoder_->GetOption(ENCODER_OPTION_ZERO_COPY_SOURCE, &zeroCopySource));
+    zeroCopySource.pCtx = &zeroCopyPictures;
+    zeroCopySource.pReleaseSource = ReleaseZeroCopySource;
+    ASSERT_EQ(0, encoder_->SetOption(ENCODER_OPTION_ZERO_COPY_SOURCE, &zeroCopySource));
+  }
   while (in->read(buf.data(), frameSize) == frameSize) {
+    if (zeroCopy) {
+      // a new picture per frame, given back through ReleaseZeroCopySource()
+      AllocZeroCopyPicture(&zeroCopyPictures, zeroCopySource, &pic, buf.data());
+    }
+    if (colorFormat == videoFormatNV12) {
+      const unsigned char* u = buf.data() + width * height;
+      const unsigned char* v = u + (width * height >> 2);
+      memcpy(pic.pData[0], buf.data(), width * height);
+      for (int i = 0; i < (width * height >> 2); i++) {
+        pic.pData[1][2 * i] = u[i];
+        pic.pData[1][2 * i + 1] = v[i];
+      }
+    }
+    if (pipelined) {
+      // the picture is copied on submission, buf can be refilled right away
+      while ((rv = encoder_->SubmitFrame(&pic)) == cmOutputPending) {
+        rv = encoder_->GetEncodedFrame(&info, true);
+        ASSERT_TRUE(rv == cmResultSuccess);
+        ASSERT_TRUE(info.eOutputFrameType != videoFrameTypeInvalid);
+        if (info.eOutputFrameType != videoFrameTypeSkip && cbk != NULL) {
+          cbk->onEncodeFrame(info);
+        }
+      }
+      ASSERT_TRUE(rv == cmResultSuccess);
+      continue;
+    }
     rv = encoder_->EncodeFrame(&pic, &info);
     ASSERT_TRUE(rv == cmResultSuccess);
     if (info.eOutputFrameType != videoFrameTypeSkip && cbk != NULL) {
       cbk->onEncodeFrame(info);
     }
   }
+  while (pipelined) {
+    rv = encoder_->GetEncodedFrame(&info, true);
+    ASSERT_TRUE(rv == cmResultSuccess);
+    if (info.eOutputFrameType == videoFrameTypeInvalid) {
+      break;
+    }
+    if (info.eOutputFrameType != videoFrameTypeSkip && cbk != NULL) {
+      cbk->onEncodeFrame(info);
+    }
+  }
+  if (zeroCopy) {
+    // the pictures still referenced are released by the encoder at the latest
+    encoder_->Uninitialize();
+    EXPECT_TRUE(zeroCopyPictures.empty()) << zeroCopyPictures.size() << " pictures never released";
+  }
 }
 
 void BaseEncoderTest::EncodeFile(const char* fileName, EUsageType usageType, int width, int height,
-    float frameRate, SliceModeEnum slices, bool denoise, int layers, Callback* cbk) {
+    float frameRate, SliceModeEnum slices, bool denoise, int layers, Callback* cbk, const Options& options) {
   FileInputStream fileStream;
   ASSERT_TRUE(fileStream.Open(fileName));
-  EncodeStream(&fileStream, usageType, width, height, frameRate, slices, denoise, layers, cbk);
+  EncodeStream(&fileStream, usageType, width, height, frameRate, slices, denoise, layers, cbk, options);
 }
@@ -20,6 +20,8 @@ void CheckEncoderInterface(ISVCEncoder* p, CheckFunc check) {
   CHECK(8, p, ForceIntraFrame);
   CHECK(9, p, SetOption);
   CHECK(10, p, GetOption);
+  CHECK(11, p, SubmitFrame);
+  CHECK(12, p, GetEncodedFrame);
 }
 
 void CheckDecoderInterface(ISVCDecoder* p, CheckFunc check) {
@@ -64,6 +64,14 @@ struct SVCEncoderImpl : public ISVCEncoder {
     EXPECT_TRUE(gThis == this);
     return 10;
   }
+  virtual int EXTAPI SubmitFrame(const SSourcePicture* kpSrcPic) {
+    EXPECT_TRUE(gThis == this);
+    return 11;
+  }
+  virtual int EXTAPI GetEncodedFrame(SFrameBSInfo* pBsInfo, bool bWait) {
+    EXPECT_TRUE(gThis == this);
+    return 12;
+  }
 };
 
 struct SVCDecoderImpl : public ISVCDecoder {
@@ -28,8 +28,8 @@ struct FileParam {
   const char* hashStr;
 };
 
-class DecoderOutputTest : public ::testing::WithParamInterface<FileParam>,
-    public DecoderInitTest, public BaseDecoderTest::Callback {
+// hashes the I420 planes of each decoded frame
+class DecoderHashTest : public DecoderInitTest, public BaseDecoderTest::Callback {
  public:
   virtual void SetUp() {
     DecoderInitTest::SetUp();
@@ -50,6 +50,9 @@ class DecoderOutputTest : public ::testing::WithParamInterface<FileParam>,
   SHA1Context ctx_;
 };
 
+class DecoderOutputTest : public ::testing::WithParamInterface<FileParam>, public DecoderHashTest {
+};
+
 TEST_P(DecoderOutputTest, CompareOutput) {
   FileParam p = GetParam();
   DecodeFile(p.fileName, this);
@@ -61,6 +64,17 @@ TEST_P(DecoderOutputTest, CompareOutput) {
   }
 }
 
+TEST_P(DecoderOutputTest, CompareOutputZeroCopy) {
+  FileParam p = GetParam();
+  DecodeFileZeroCopy(p.fileName, this);
+
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1Result(&ctx_, digest);
+  if (!HasFatalFailure()) {
+    CompareHash(digest, p.hashStr);
+  }
+}
+
 static const FileParam kFileParamArray[] = {
   {"res/test_vd_1d.264", "5827d2338b79ff82cd091c707823e466197281d3"},
   {"res/test_vd_rc.264", "eea02e97bfec89d0418593a8abaaf55d02eaa1ca"},
@@ -98,3 +112,343 @@ static const FileParam kFileParamArray[] = {
 
 INSTANTIATE_TEST_CASE_P(DecodeFile, DecoderOutputTest,
     ::testing::ValuesIn(kFileParamArray));
+
+// decoder set up each file of kFileParamArray is decoded with besides the default one, all of them output the same samples
+struct DecoderConfig {
+  int threadCount;
+  int rowThreadCount;
+  bool pipelineDeblocking;
+  bool bufferProvider;
+  int outputFormat;
+  int sliceThreadCount;
+};
+
+static const DecoderConfig kDecoderConfigArray[] = {
+  // threads, row threads, pipelined deblocking, buffer provider, output format, slice threads
+  {4, 0, false, false, videoFormatI420, 0},
+  {0, 4, false, false, videoFormatI420, 0},
+  {0, 0, true, false, videoFormatI420, 0},
+  {2, 4, true, false, videoFormatI420, 0},
+  // frames reconstructed into buffers of the application, which keeps each frame till the next one is output
+  {0, 0, false, true, videoFormatI420, 0},
+  {4, 0, false, true, videoFormatI420, 0},
+  // NV12 output carries the same samples as I420, with U and V interleaved
+  {0, 0, false, false, videoFormatNV12, 0},
+  // rows converted right behind pipelined deblocking, in the worker threads reconstructing the frames
+  {4, 0, true, false, videoFormatNV12, 0},
+  // slices of a picture reconstructed on threads, deblocked across slice edges afterwards
+  {0, 0, false, false, videoFormatI420, 4},
+  // slice threads reconstructing their slices as wavefronts, single slice pictures deblocked along
+  {0, 3, true, false, videoFormatI420, 3}
+};
+
+class DecoderConfigTest : public ::testing::WithParamInterface< ::testing::tuple<FileParam, DecoderConfig> >,
+    public DecoderHashTest {
+ public:
+  struct Buffer {
+    std::vector<uint8_t> memory;
+    uint8_t* data;
+    int size;
+    int refs;
+  };
+
+  virtual void SetUp() {
+    SDecodingParam param;
+    config_ = ::testing::get<1>(GetParam());
+    kept_ = NULL;
+    getCount_ = 0;
+    GetDefaultParam(&param);
+    param.iOutputColorFormat = config_.outputFormat;
+    param.iThreadCount = config_.threadCount;
+    param.iRowThreadCount = config_.rowThreadCount;
+    param.bPipelineDeblocking = config_.pipelineDeblocking;
+    param.iSliceThreadCount = config_.sliceThreadCount;
+    BaseDecoderTest::SetUp(param);
+    ASSERT_FALSE(HasFatalFailure());
+    SHA1Reset(&ctx_);
+
+    if (config_.bufferProvider) {
+      SPictureBufferProvider provider = {this, GetBuffer, ReleaseBuffer};
+      ASSERT_EQ(0, decoder()->SetOption(DECODER_OPTION_BUFFER_PROVIDER, &provider));
+    }
+  }
+  virtual void TearDown() {
+    BaseDecoderTest::TearDown();
+    ReleaseKeptFrame();
+    if (config_.bufferProvider) {
+      EXPECT_GT(getCount_, 0);
+    }
+    for (size_t i = 0; i < buffers_.size(); i++) {
+      EXPECT_EQ(0, buffers_[i]->refs);	// the decoder gave all its buffers back
+      delete buffers_[i];
+    }
+  }
+  virtual void onDecodeFrame(const Frame& frame) {
+    if (config_.outputFormat == videoFormatNV12) {
+      UpdateHashFromNV12(frame);
+    } else {
+      DecoderHashTest::onDecodeFrame(frame);
+    }
+    if (config_.bufferProvider) {
+      KeepFrame(frame);
+    }
+  }
+
+ protected:
+  DecoderConfig config_;
+
+ private:
+  void UpdateHashFromNV12(const Frame& frame) {
+    std::vector<uint8_t> u(frame.u.width), v(frame.u.width);
+    UpdateHashFromPlane(&ctx_, frame.y.data, frame.y.width, frame.y.height, frame.y.stride);
+    ASSERT_TRUE(frame.v.data == NULL);
+    for (int pass = 0; pass < 2; pass++) {
+      for (int i = 0; i < frame.u.height; i++) {
+        const uint8_t* uv = frame.u.data + i * frame.u.stride;
+        for (int j = 0; j < frame.u.width; j++) {
+          u[j] = uv[2 * j];
+          v[j] = uv[2 * j + 1];
+        }
+        SHA1Input(&ctx_, pass == 0 ? &u[0] : &v[0], frame.u.width);
+      }
+    }
+  }
+  void KeepFrame(const Frame& frame) {
+    // the decoder must not have written to the frame kept since the last output
+    if (kept_ != NULL) {
+      EXPECT_EQ(keptSum_, PlaneSum(keptFrame_.y));
+      ReleaseKeptFrame();
+    }
+    for (size_t i = 0; i < buffers_.size(); i++) {
+      Buffer* buf = buffers_[i];
+      if (frame.y.data >= buf->data && frame.y.data < buf->data + buf->size) {
+        kept_ = buf;
+        break;
+      }
+    }
+    ASSERT_TRUE(kept_ != NULL);
+    ++kept_->refs;
+    keptFrame_ = frame;
+    keptSum_ = PlaneSum(frame.y);
+  }
+  static void* GetBuffer(void* ctx, int size, void** opaque) {
+    DecoderConfigTest* self = static_cast<DecoderConfigTest*>(ctx);
+    Buffer* buf = NULL;
+    for (size_t i = 0; i < self->buffers_.size() && buf == NULL; i++) {
+      if (self->buffers_[i]->refs == 0 && self->buffers_[i]->size >= size) {
+        buf = self->buffers_[i];
+      }
+    }
+    if (buf == NULL) {
+      buf = new Buffer;
+      buf->memory.resize(size + 16);
+      buf->data = &buf->memory[0] + (16 - (reinterpret_cast<uintptr_t>(&buf->memory[0]) & 15));
+      buf->size = size;
+      buf->refs = 0;
+      self->buffers_.push_back(buf);
+    }
+    buf->refs = 1;
+    self->getCount_++;
+    *opaque = buf;
+    return buf->data;
+  }
+  static void ReleaseBuffer(void* ctx, void* data, void* opaque) {
+    Buffer* buf = static_cast<Buffer*>(opaque);
+    EXPECT_EQ(buf->data, data);
+    EXPECT_GT(buf->refs, 0);
+    --buf->refs;
+  }
+  static uint32_t PlaneSum(const Plane& plane) {
+    uint32_t sum = 0;
+    for (int i = 0; i < plane.height; i++) {
+      for (int j = 0; j < plane.width; j++) {
+        sum = sum * 31 + plane.data[i * plane.stride + j];
+      }
+    }
+    return sum;
+  }
+  void ReleaseKeptFrame() {
+    if (kept_ != NULL) {
+      --kept_->refs;
+      kept_ = NULL;
+    }
+  }
+
+  std::vector<Buffer*> buffers_;
+  Buffer* kept_;
+  Frame keptFrame_;
+  uint32_t keptSum_;
+  int getCount_;
+};
+
+TEST_P(DecoderConfigTest, CompareOutput) {
+  const FileParam& p = ::testing::get<0>(GetParam());
+  DecodeFile(p.fileName, this);
+
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1Result(&ctx_, digest);
+  if (!HasFatalFailure()) {
+    CompareHash(digest, p.hashStr);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(DecodeFile, DecoderConfigTest,
+    ::testing::Combine(::testing::ValuesIn(kFileParamArray), ::testing::ValuesIn(kDecoderConfigArray)));
+
+static const char* const kResolutionChangeFiles[] = {
+  "res/test_vd_1d.264",	// 320x192
+  "res/Static.264",	// 152x100
+  "res/SVA_BA1_B.264",	// 176x144
+  "res/test_vd_1d.264"
+};
+
+// one decoder going through streams of different resolutions outputs what a decoder per stream does
+class DecoderResolutionChangeTest : public DecoderHashTest {
+ public:
+  virtual void SetUp() {
+    SHA1Reset(&ctx_);
+  }
+  virtual void TearDown() {
+    BaseDecoderTest::TearDown();
+  }
+  void DecodeAndCompare() {
+    const int fileNum = sizeof(kResolutionChangeFiles) / sizeof(kResolutionChangeFiles[0]);
+    for (int i = 0; i < fileNum; i++) {
+      DecodeFile(kResolutionChangeFiles[i], this);
+      ASSERT_FALSE(HasFatalFailure());
+    }
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    SHA1Result(&ctx_, digest);
+
+    SHA1Reset(&ctx_);
+    for (int i = 0; i < fileNum; i++) {
+      BaseDecoderTest decoder;
+      decoder.SetUp();
+      decoder.DecodeFile(kResolutionChangeFiles[i], this);
+      decoder.TearDown();
+      ASSERT_FALSE(HasFatalFailure());
+    }
+    unsigned char refDigest[SHA_DIGEST_LENGTH];
+    SHA1Result(&ctx_, refDigest);
+    EXPECT_EQ(0, memcmp(digest, refDigest, SHA_DIGEST_LENGTH));
+  }
+};
+
+TEST_F(DecoderResolutionChangeTest, ReusePictures) {
+  BaseDecoderTest::SetUp();
+  ASSERT_FALSE(HasFatalFailure());
+  DecodeAndCompare();
+}
+
+TEST_F(DecoderResolutionChangeTest, ReusePicturesThreaded) {
+  SDecodingParam param;
+  GetDefaultParam(&param);
+  param.iThreadCount = 4;
+  BaseDecoderTest::SetUp(param);
+  ASSERT_FALSE(HasFatalFailure());
+  DecodeAndCompare();
+}
+
+TEST_F(DecoderResolutionChangeTest, ReusePicturesOfMaxSize) {
+  SDecodingParam param;
+  GetDefaultParam(&param);
+  param.iMaxWidth = 352;
+  param.iMaxHeight = 288;
+  BaseDecoderTest::SetUp(param);
+  ASSERT_FALSE(HasFatalFailure());
+  DecodeAndCompare();
+}
+
+static uint8_t ClipPixel(int x) {
+  return x < 0 ? 0 : (x > 255 ? 255 : x);
+}
+
+// RGBA or BGRA output compared to the I420 output converted here, both at the same, possibly downscaled, size
+class RgbOutputTest : public ::testing::Test, public BaseDecoderTest, public BaseDecoderTest::Callback {
+ public:
+  virtual void onDecodeFrame(const Frame& frame) {
+    if (format_ == videoFormatI420) {
+      std::vector<uint8_t> row(frame.y.width * 4);
+      for (int i = 0; i < frame.y.height; i++) {
+        for (int j = 0; j < frame.y.width; j++) {
+          const int c = 298 * (frame.y.data[i * frame.y.stride + j] - 16) + 128;
+          const int d = frame.u.data[(i / 2) * frame.u.stride + j / 2] - 128;
+          const int e = frame.v.data[(i / 2) * frame.v.stride + j / 2] - 128;
+          row[4 * j + (bgr_ ? 2 : 0)] = ClipPixel((c + 409 * e) >> 8);
+          row[4 * j + 1] = ClipPixel((c - 100 * d - 208 * e) >> 8);
+          row[4 * j + (bgr_ ? 0 : 2)] = ClipPixel((c + 516 * d) >> 8);
+          row[4 * j + 3] = 255;
+        }
+        SHA1Input(&ctx_, &row[0], frame.y.width * 4);
+      }
+    } else {
+      UpdateHashFromPlane(&ctx_, frame.y.data, frame.y.width * 4, frame.y.height, frame.y.stride);
+    }
+    EXPECT_TRUE(frame.y.width <= width_ || width_ == 0);
+    EXPECT_TRUE(frame.y.height <= height_ || height_ == 0);
+  }
+
+ protected:
+  void Decode(const char* fileName, int format, int threadCount, unsigned char* digest) {
+    SDecodingParam param;
+    format_ = format;
+    SHA1Reset(&ctx_);
+    GetDefaultParam(&param);
+    param.iOutputColorFormat = format;
+    param.iThreadCount = threadCount;
+    param.bPipelineDeblocking = true;
+    param.iOutputWidth = width_;
+    param.iOutputHeight = height_;
+    BaseDecoderTest::SetUp(param);
+    ASSERT_FALSE(HasFatalFailure());
+    DecodeFile(fileName, this);
+    BaseDecoderTest::TearDown();
+    SHA1Result(&ctx_, digest);
+  }
+  void CompareWithI420(const char* fileName, int format, int threadCount) {
+    unsigned char expected[SHA_DIGEST_LENGTH], digest[SHA_DIGEST_LENGTH];
+    bgr_ = format == videoFormatBGRA;
+    Decode(fileName, videoFormatI420, threadCount, expected);
+    ASSERT_FALSE(HasFatalFailure());
+    Decode(fileName, format, threadCount, digest);
+    ASSERT_FALSE(HasFatalFailure());
+    EXPECT_EQ(0, memcmp(expected, digest, SHA_DIGEST_LENGTH));
+  }
+
+  SHA1Context ctx_;
+  int format_;
+  bool bgr_;
+  int width_;
+  int height_;
+};
+
+TEST_F(RgbOutputTest, RGBA) {
+  width_ = height_ = 0;
+  CompareWithI420("res/BA1_FT_C.264", videoFormatRGBA, 0);
+}
+
+TEST_F(RgbOutputTest, BGRA) {
+  width_ = height_ = 0;
+  CompareWithI420("res/SVA_BA1_B.264", videoFormatBGRA, 0);
+}
+
+TEST_F(RgbOutputTest, DownscaledRGBAThreaded) {
+  width_ = 234;
+  height_ = 190;
+  CompareWithI420("res/BA1_FT_C.264", videoFormatRGBA, 4);
+}
+
+TEST_F(RgbOutputTest, DownscaledBGRA) {
+  width_ = 100;
+  height_ = 64;
+  CompareWithI420("res/test_vd_1d.264", videoFormatBGRA, 0);
+}
+
+TEST_F(DecoderInitTest, UnsupportedOutputFormat) {
+  int format = videoFormatYUY2;
+  EXPECT_NE(0, decoder()->SetOption(DECODER_OPTION_DATAFORMAT, &format));
+  format = videoFormatNV12;
+  EXPECT_EQ(0, decoder()->SetOption(DECODER_OPTION_DATAFORMAT, &format));
+  EXPECT_EQ(0, decoder()->GetOption(DECODER_OPTION_DATAFORMAT, &format));
+  EXPECT_EQ(videoFormatNV12, format);
+}
@@ -1,3 +1,4 @@
+#include <vector>
 #include <gtest/gtest.h>
 #include "utils/HashFunctions.h"
 #include "BaseEncoderTest.h"
@@ -25,6 +26,138 @@ class EncoderInitTest : public ::testing::Test, public BaseEncoderTest {
 
 TEST_F(EncoderInitTest, JustInit) {}
 
+// uniform noise at QP 0 in 4 slices, each slice fits its own slice bs buffer but the frame
+// overflows the 1.5 bytes per pixel frame bs buffer sized at init
+static void EncodeNoise(int threads, std::vector<unsigned char>* out) {
+  const int width = 320, height = 192, frames = 3;
+  ISVCEncoder* encoder = NULL;
+  ASSERT_EQ(0, WelsCreateSVCEncoder(&encoder));
+  ASSERT_TRUE(encoder != NULL);
+
+  SEncParamExt param;
+  encoder->GetDefaultParams(&param);
+  param.iUsageType = CAMERA_VIDEO_REAL_TIME;
+  param.fMaxFrameRate = 12.0f;
+  param.iPicWidth = width;
+  param.iPicHeight = height;
+  param.iTargetBitrate = 5000000;
+  param.iRCMode = RC_OFF_MODE;
+  param.iMultipleThreadIdc = threads;
+  param.iSpatialLayerNum = 1;
+  param.sSpatialLayers[0].iVideoWidth = width;
+  param.sSpatialLayers[0].iVideoHeight = height;
+  param.sSpatialLayers[0].fFrameRate = param.fMaxFrameRate;
+  param.sSpatialLayers[0].iSpatialBitrate = param.iTargetBitrate;
+  param.sSpatialLayers[0].iDLayerQp = 0;
+  param.sSpatialLayers[0].sSliceCfg.uiSliceMode = SM_FIXEDSLCNUM_SLICE;
+  param.sSpatialLayers[0].sSliceCfg.sSliceArgument.uiSliceNum = 4;
+  ASSERT_EQ(cmResultSuccess, encoder->InitializeExt(&param));
+
+  std::vector<unsigned char> yuv(width * height * 3 / 2);
+  SSourcePicture pic;
+  memset(&pic, 0, sizeof(SSourcePicture));
+  pic.iPicWidth = width;
+  pic.iPicHeight = height;
+  pic.iColorFormat = videoFormatI420;
+  pic.iStride[0] = width;
+  pic.iStride[1] = pic.iStride[2] = width >> 1;
+  pic.pData[0] = &yuv[0];
+  pic.pData[1] = pic.pData[0] + width * height;
+  pic.pData[2] = pic.pData[1] + (width * height >> 2);
+
+  unsigned int seed = 1;
+  for (int i = 0; i < frames; i++) {
+    for (size_t j = 0; j < yuv.size(); j++) {
+      seed = seed * 1103515245 + 12345;
+      yuv[j] = seed >> 16;
+    }
+    SFrameBSInfo info;
+    memset(&info, 0, sizeof(SFrameBSInfo));
+    ASSERT_EQ(cmResultSuccess, encoder->EncodeFrame(&pic, &info));
+    int frameSize = 0;
+    for (int k = 0; k < info.iLayerNum; k++) {
+      const SLayerBSInfo& layerInfo = info.sLayerInfo[k];
+      int layerSize = 0;
+      for (int n = 0; n < layerInfo.iNalCount; n++)
+        layerSize += layerInfo.iNalLengthInByte[n];
+      out->insert(out->end(), layerInfo.pBsBuf, layerInfo.pBsBuf + layerSize);
+      frameSize += layerSize;
+    }
+    EXPECT_GT(frameSize, width * height * 3 / 2);
+  }
+
+  encoder->Uninitialize();
+  WelsDestroySVCEncoder(encoder);
+}
+
+TEST(EncoderBsGrowthTest, SlicesCodedOnThreads) {
+  // fewer threads than slices, so that the slices are not rebalanced by their coding time
+  std::vector<unsigned char> twoThreads, threeThreads;
+  EncodeNoise(2, &twoThreads);
+  EncodeNoise(3, &threeThreads);
+  ASSERT_FALSE(twoThreads.empty());
+  EXPECT_TRUE(twoThreads == threeThreads);
+}
+
+// a reset while submitted frames are not fetched is refused instead of losing their bitstreams
+TEST(EncoderPipelineTest, ResetKeepsUnfetchedFrames) {
+  const int width = 160, height = 96, frames = 2;
+  ISVCEncoder* encoder = NULL;
+  ASSERT_EQ(0, WelsCreateSVCEncoder(&encoder));
+  ASSERT_TRUE(encoder != NULL);
+
+  SEncParamExt param;
+  encoder->GetDefaultParams(&param);
+  param.iUsageType = CAMERA_VIDEO_REAL_TIME;
+  param.fMaxFrameRate = 12.0f;
+  param.iPicWidth = width;
+  param.iPicHeight = height;
+  param.iTargetBitrate = 500000;
+  param.iSpatialLayerNum = 1;
+  param.sSpatialLayers[0].iVideoWidth = width;
+  param.sSpatialLayers[0].iVideoHeight = height;
+  param.sSpatialLayers[0].fFrameRate = param.fMaxFrameRate;
+  param.sSpatialLayers[0].iSpatialBitrate = param.iTargetBitrate;
+  ASSERT_EQ(cmResultSuccess, encoder->InitializeExt(&param));
+
+  std::vector<unsigned char> yuv(width * height * 3 / 2, 128);
+  SSourcePicture pic;
+  memset(&pic, 0, sizeof(SSourcePicture));
+  pic.iPicWidth = width;
+  pic.iPicHeight = height;
+  pic.iColorFormat = videoFormatI420;
+  pic.iStride[0] = width;
+  pic.iStride[1] = pic.iStride[2] = width >> 1;
+  pic.pData[0] = &yuv[0];
+  pic.pData[1] = pic.pData[0] + width * height;
+  pic.pData[2] = pic.pData[1] + (width * height >> 2);
+  for (int i = 0; i < frames; i++)
+    ASSERT_EQ(cmResultSuccess, encoder->SubmitFrame(&pic));
+
+  SEncParamExt smaller = param;
+  smaller.iPicWidth = smaller.sSpatialLayers[0].iVideoWidth = width / 2;
+  smaller.iPicHeight = smaller.sSpatialLayers[0].iVideoHeight = height / 2;
+  EXPECT_EQ(cmOutputPending, encoder->SetOption(ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &smaller));
+  EXPECT_EQ(cmOutputPending, encoder->InitializeExt(&param));
+
+  SFrameBSInfo info;
+  for (int i = 0; i < frames; i++) {
+    memset(&info, 0, sizeof(SFrameBSInfo));
+    ASSERT_EQ(cmResultSuccess, encoder->GetEncodedFrame(&info, true));
+    EXPECT_NE(videoFrameTypeInvalid, info.eOutputFrameType);
+    EXPECT_GT(info.iLayerNum, 0);
+  }
+  memset(&info, 0, sizeof(SFrameBSInfo));
+  ASSERT_EQ(cmResultSuccess, encoder->GetEncodedFrame(&info, true));
+  EXPECT_EQ(videoFrameTypeInvalid, info.eOutputFrameType);
+
+  EXPECT_EQ(cmResultSuccess, encoder->SetOption(ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &smaller));
+  EXPECT_EQ(cmResultSuccess, encoder->InitializeExt(&param));
+
+  encoder->Uninitialize();
+  WelsDestroySVCEncoder(encoder);
+}
+
 struct EncodeFileParam {
   const char* fileName;
   const char* hashStr;
@@ -35,9 +168,10 @@ struct EncodeFileParam {
   SliceModeEnum slices;
   bool denoise;
   int layers;
+  BaseEncoderTest::Options options;
 };
 
-class EncoderOutputTest : public ::testing::WithParamInterface<EncodeFileParam>,
+class EncoderOutputTest : public ::testing::WithParamInterface< ::testing::tuple<EncodeFileParam, BaseEncoderTest::InputMode> >,
     public EncoderInitTest , public BaseEncoderTest::Callback {
  public:
   virtual void SetUp() {
@@ -56,8 +190,9 @@ class EncoderOutputTest : public ::testing::WithParamInterface<EncodeFileParam>,
 
 
 TEST_P(EncoderOutputTest, CompareOutput) {
-  EncodeFileParam p = GetParam();
-  EncodeFile(p.fileName, p.usageType ,p.width, p.height, p.frameRate, p.slices, p.denoise, p.layers, this);
+  EncodeFileParam p = ::testing::get<0>(GetParam());
+  p.options.inputMode = ::testing::get<1>(GetParam());
+  EncodeFile(p.fileName, p.usageType ,p.width, p.height, p.frameRate, p.slices, p.denoise, p.layers, this, p.options);
 
   //will remove this after screen content algorithms are ready,
   //because the bitstream output will vary when the different algorithms are added.
@@ -95,6 +230,46 @@ static const EncodeFileParam kFileParamArray[] = {
       "res/CiscoVT2people_320x192_12fps.yuv",
       "ba81a0f1a14214e6d3c7f1608991b3ac97789370", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_SINGLE_SLICE, false, 2
   },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "b8352e733a34c0c1efaa5ff1149dabc0b936b29e", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_DYN_SLICE, false, 1
+  },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "0933e836d02fc8afaa41bf72c3fe4bab9e71a84e", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_DYN_SLICE, false, 2
+  },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "9d25d4ebe3b046207b27e05cb97c0d59e43e436f", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_ROWMB_SLICE, false, 2
+  },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "db5fd2aa4874259b1ebfb3280e555cfbd13ddd59", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_SINGLE_SLICE, false, 3
+  },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "2ef7b479c321d6b057a3f7a6a77970c5b5e557a9", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_ROWMB_SLICE, false, 3
+  },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "06062aacfe83111621f0da9be1643489207a4080", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_SINGLE_SLICE, false, 3, {true} // Spatial layers coded concurrently
+  },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "9b86b9599760e34ca07326769e1d53c7f2cb4829", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_ROWMB_SLICE, false, 3, {true}
+  },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "520497abc39543f8154c62daf4a01d1a32d6df61", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_ROWMB_SLICE, false, 2, {false, true} // Single slice base layer deblocked on the slice threads
+  },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "b7121c112b2a628544d5635008e4952dd350f2ff", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_SINGLE_SLICE, false, 1, {false, false, true} // Seeded by the half resolution search
+  },
+  {
+      "res/CiscoVT2people_320x192_12fps.yuv",
+      "d683495ac8510053879f029cdc5139b6a78a4348", CAMERA_VIDEO_REAL_TIME, 320, 192, 12.0f, SM_SINGLE_SLICE, false, 3, {false, false, true} // Seeded by the lower layers
+  },
   {
       "res/CiscoVT2people_320x192_12fps.yuv",
       "", SCREEN_CONTENT_REAL_TIME, 320, 192, 12.0f, SM_SINGLE_SLICE, false, 1
@@ -110,4 +285,6 @@ static const EncodeFileParam kFileParamArray[] = {
 };
 
 INSTANTIATE_TEST_CASE_P(EncodeFile, EncoderOutputTest,
-    ::testing::ValuesIn(kFileParamArray));
+    ::testing::Combine(::testing::ValuesIn(kFileParamArray),
+        ::testing::Values(BaseEncoderTest::InputCopied, BaseEncoderTest::InputPipelined,
+            BaseEncoderTest::InputZeroCopy, BaseEncoderTest::InputNV12)));
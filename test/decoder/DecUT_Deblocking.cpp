@@ -0,0 +1,172 @@
+#include<gtest/gtest.h>
+#include "codec_def.h"
+#include "deblocking.h"
+#include "deblocking_common.h"
+#include "cpu_core.h"
+#include "cpu.h"
+using namespace WelsDec;
+
+#if defined(X86_INTRINSICS)
+
+#define DEBLOCK_BUFF_STRIDE 32
+
+// smooth content with a step at row/column iEdge, so that all filter branches are taken
+static void FillEdgeBuf (uint8_t* pBuf, int32_t iSize, bool bHorEdge, int32_t iEdge) {
+  int32_t iBase = rand() % 256;
+  int32_t iStep = rand() % 48 - 24;
+  for (int32_t i = 0; i < iSize; i++) {
+    int32_t iPos = bHorEdge ? i / DEBLOCK_BUFF_STRIDE : i % DEBLOCK_BUFF_STRIDE;
+    int32_t iVal = iBase + (rand() % 9 - 4) + (iPos >= iEdge ? iStep : 0);
+    pBuf[i] = WELS_CLIP3 (iVal, 0, 255);
+  }
+}
+
+static void RandTc (int8_t iTc[4], bool bChroma) {
+  for (int32_t i = 0; i < 4; i++)
+    iTc[i] = bChroma ? rand() % 27 : rand() % 27 - 1;
+}
+
+TEST (DeblockingLuma_avx2, CompareWithC) {
+  int32_t iTmp = 1;
+  if (0 == (WelsCPUFeatureDetect (&iTmp) & WELS_CPU_AVX2))
+    return;
+
+  SDeblockingFunc sFuncC, sFuncAvx2;
+  DeblockingInit (&sFuncC, 0);
+  DeblockingInit (&sFuncAvx2, WELS_CPU_AVX2);
+  uint8_t uiAnchor[DEBLOCK_BUFF_STRIDE * DEBLOCK_BUFF_STRIDE];
+  uint8_t uiTest[DEBLOCK_BUFF_STRIDE * DEBLOCK_BUFF_STRIDE];
+  // horizontal edges start at row 16, vertical edges at column 16
+  const int32_t kiVerOffset = 16 * DEBLOCK_BUFF_STRIDE + 8;
+  const int32_t kiHorOffset = 8 * DEBLOCK_BUFF_STRIDE + 16;
+  int8_t iTc[4];
+  srand ((unsigned int)time (0));
+  for (int32_t k = 0; k < 2000; k++) {
+    int32_t iAlpha = rand() % 256;
+    int32_t iBeta  = rand() % 19;
+    RandTc (iTc, false);
+    for (int32_t iFunc = 0; iFunc < 4; iFunc++) {
+      FillEdgeBuf (uiAnchor, sizeof (uiAnchor), iFunc < 2, 16);
+      memcpy (uiTest, uiAnchor, sizeof (uiAnchor));
+      switch (iFunc) {
+      case 0:
+        sFuncC.pfLumaDeblockingLT4Ver (uiAnchor + kiVerOffset, DEBLOCK_BUFF_STRIDE, iAlpha, iBeta, iTc);
+        sFuncAvx2.pfLumaDeblockingLT4Ver (uiTest + kiVerOffset, DEBLOCK_BUFF_STRIDE, iAlpha, iBeta, iTc);
+        break;
+      case 1:
+        sFuncC.pfLumaDeblockingEQ4Ver (uiAnchor + kiVerOffset, DEBLOCK_BUFF_STRIDE, iAlpha, iBeta);
+        sFuncAvx2.pfLumaDeblockingEQ4Ver (uiTest + kiVerOffset, DEBLOCK_BUFF_STRIDE, iAlpha, iBeta);
+        break;
+      case 2:
+        sFuncC.pfLumaDeblockingLT4Hor (uiAnchor + kiHorOffset, DEBLOCK_BUFF_STRIDE, iAlpha, iBeta, iTc);
+        sFuncAvx2.pfLumaDeblockingLT4Hor (uiTest + kiHorOffset, DEBLOCK_BUFF_STRIDE, iAlpha, iBeta, iTc);
+        break;
+      default:
+        sFuncC.pfLumaDeblockingEQ4Hor (uiAnchor + kiHorOffset, DEBLOCK_BUFF_STRIDE, iAlpha, iBeta);
+        sFuncAvx2.pfLumaDeblockingEQ4Hor (uiTest + kiHorOffset, DEBLOCK_BUFF_STRIDE, iAlpha, iBeta);
+        break;
+      }
+      ASSERT_EQ (0, memcmp (uiAnchor, uiTest, sizeof (uiAnchor))) << "func " << iFunc << " alpha " << iAlpha << " beta "
+          << iBeta;
+    }
+  }
+}
+
+TEST (DeblockingChroma_avx2, CompareWithC) {
+  int32_t iTmp = 1;
+  if (0 == (WelsCPUFeatureDetect (&iTmp) & WELS_CPU_AVX2))
+    return;
+
+  SDeblockingFunc sFuncC, sFuncAvx2;
+  DeblockingInit (&sFuncC, 0);
+  DeblockingInit (&sFuncAvx2, WELS_CPU_AVX2);
+  uint8_t uiAnchor[2][DEBLOCK_BUFF_STRIDE * DEBLOCK_BUFF_STRIDE];
+  uint8_t uiTest[2][DEBLOCK_BUFF_STRIDE * DEBLOCK_BUFF_STRIDE];
+  // horizontal edges start at row 16, vertical edges at column 16
+  const int32_t kiVerOffset = 16 * DEBLOCK_BUFF_STRIDE + 12;
+  const int32_t kiHorOffset = 12 * DEBLOCK_BUFF_STRIDE + 16;
+  int8_t iTc[4];
+  srand ((unsigned int)time (0));
+  for (int32_t k = 0; k < 2000; k++) {
+    int32_t iAlpha = rand() % 256;
+    int32_t iBeta  = rand() % 19;
+    RandTc (iTc, true);
+    for (int32_t iFunc = 0; iFunc < 4; iFunc++) {
+      FillEdgeBuf (uiAnchor[0], sizeof (uiAnchor[0]), iFunc < 2, 16);
+      FillEdgeBuf (uiAnchor[1], sizeof (uiAnchor[1]), iFunc < 2, 16);
+      memcpy (uiTest, uiAnchor, sizeof (uiAnchor));
+      switch (iFunc) {
+      case 0:
+        sFuncC.pfChromaDeblockingLT4Ver (uiAnchor[0] + kiVerOffset, uiAnchor[1] + kiVerOffset, DEBLOCK_BUFF_STRIDE, iAlpha,
+                                         iBeta, iTc);
+        sFuncAvx2.pfChromaDeblockingLT4Ver (uiTest[0] + kiVerOffset, uiTest[1] + kiVerOffset, DEBLOCK_BUFF_STRIDE, iAlpha,
+                                            iBeta, iTc);
+        break;
+      case 1:
+        sFuncC.pfChromaDeblockingEQ4Ver (uiAnchor[0] + kiVerOffset, uiAnchor[1] + kiVerOffset, DEBLOCK_BUFF_STRIDE, iAlpha,
+                                         iBeta);
+        sFuncAvx2.pfChromaDeblockingEQ4Ver (uiTest[0] + kiVerOffset, uiTest[1] + kiVerOffset, DEBLOCK_BUFF_STRIDE, iAlpha,
+                                            iBeta);
+        break;
+      case 2:
+        sFuncC.pfChromaDeblockingLT4Hor (uiAnchor[0] + kiHorOffset, uiAnchor[1] + kiHorOffset, DEBLOCK_BUFF_STRIDE, iAlpha,
+                                         iBeta, iTc);
+        sFuncAvx2.pfChromaDeblockingLT4Hor (uiTest[0] + kiHorOffset, uiTest[1] + kiHorOffset, DEBLOCK_BUFF_STRIDE, iAlpha,
+                                            iBeta, iTc);
+        break;
+      default:
+        sFuncC.pfChromaDeblockingEQ4Hor (uiAnchor[0] + kiHorOffset, uiAnchor[1] + kiHorOffset, DEBLOCK_BUFF_STRIDE, iAlpha,
+                                         iBeta);
+        sFuncAvx2.pfChromaDeblockingEQ4Hor (uiTest[0] + kiHorOffset, uiTest[1] + kiHorOffset, DEBLOCK_BUFF_STRIDE, iAlpha,
+                                            iBeta);
+        break;
+      }
+      ASSERT_EQ (0, memcmp (uiAnchor, uiTest, sizeof (uiAnchor))) << "func " << iFunc << " alpha " << iAlpha << " beta "
+          << iBeta;
+    }
+  }
+}
+
+TEST (DeblockingBS_avx2, CompareWithC) {
+  int32_t iTmp = 1;
+  if (0 == (WelsCPUFeatureDetect (&iTmp) & WELS_CPU_AVX2))
+    return;
+
+  SDeblockingFunc sFuncC, sFuncAvx2;
+  DeblockingInit (&sFuncC, 0);
+  DeblockingInit (&sFuncAvx2, WELS_CPU_AVX2);
+  // three MBs in a row: 0 is the top neighbour, 1 the left one and 2 the current MB
+  int8_t iNzc[3][24];
+  int8_t iRefIndex[3][MB_BLOCK4x4_NUM];
+  int16_t iMv[3][MB_BLOCK4x4_NUM][MV_A];
+  SDqLayer sLayer;
+  memset (&sLayer, 0, sizeof (sLayer));
+  sLayer.pNzc = iNzc;
+  sLayer.pRefIndex[LIST_0] = iRefIndex;
+  sLayer.pMv[LIST_0] = iMv;
+  srand ((unsigned int)time (0));
+  for (int32_t k = 0; k < 10000; k++) {
+    for (int32_t iMb = 0; iMb < 3; iMb++) {
+      for (int32_t i = 0; i < 24; i++)
+        iNzc[iMb][i] = (rand() % 4) == 0;
+      for (int32_t i = 0; i < MB_BLOCK4x4_NUM; i++) {
+        iRefIndex[iMb][i] = (rand() % 8) == 0;
+        iMv[iMb][i][0] = rand() % 11 - 5;
+        iMv[iMb][i][1] = rand() % 11 - 5;
+      }
+    }
+    for (int32_t iEdge = 0; iEdge < 2; iEdge++) {
+      EXPECT_EQ (sFuncC.pfDeblockingBSMarginalMB (&sLayer, iEdge, 1 - iEdge, 2),
+                 sFuncAvx2.pfDeblockingBSMarginalMB (&sLayer, iEdge, 1 - iEdge, 2));
+    }
+
+    uint8_t uiBsAnchor[2][4][4], uiBsTest[2][4][4];
+    memset (uiBsAnchor, 0x55, sizeof (uiBsAnchor));
+    memset (uiBsTest, 0x55, sizeof (uiBsTest));
+    sFuncC.pfDeblockingBSInsideMBNormal (&sLayer, uiBsAnchor, iNzc[2], 2);
+    sFuncAvx2.pfDeblockingBSInsideMBNormal (&sLayer, uiBsTest, iNzc[2], 2);
+    ASSERT_EQ (0, memcmp (uiBsAnchor, uiBsTest, sizeof (uiBsAnchor)));
+  }
+}
+
+#endif//X86_INTRINSICS
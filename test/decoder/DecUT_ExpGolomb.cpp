@@ -0,0 +1,129 @@
+#include<gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dec_golomb.h"
+
+using namespace WelsDec;
+
+#define EXP_GOLOMB_TEST_NUM 200
+#define EXP_GOLOMB_SYNTAX_NUM 64
+#define EXP_GOLOMB_BUF_SIZE 1024
+
+enum {
+  SYNTAX_BITS = 0,
+  SYNTAX_UE,
+  SYNTAX_SE,
+  SYNTAX_TYPE_NUM
+};
+
+typedef struct TagExpGolombSyntax {
+  int32_t iType;
+  int32_t iBits;	// SYNTAX_BITS only
+  uint32_t uiValue;
+  int32_t iValue;
+} SExpGolombSyntax;
+
+//Anchor writer, MSB first
+void AnchorPutBits (uint8_t* pBuf, int32_t* pPos, uint32_t uiValue, int32_t iBits) {
+  for (int32_t i = iBits - 1; i >= 0; i--) {
+    if ((uiValue >> i) & 1)
+      pBuf[*pPos >> 3] |= 0x80 >> (*pPos & 7);
+    ++ (*pPos);
+  }
+}
+
+void AnchorPutUe (uint8_t* pBuf, int32_t* pPos, uint32_t uiValue) {
+  const uint64_t kuiCode = (uint64_t)uiValue + 1;
+  int32_t iLeadingZeroBits = 0;
+  while ((kuiCode >> (iLeadingZeroBits + 1)) != 0)
+    ++ iLeadingZeroBits;
+  *pPos += iLeadingZeroBits;
+  AnchorPutBits (pBuf, pPos, 1, 1);
+  AnchorPutBits (pBuf, pPos, (uint32_t) (kuiCode & ((1ULL << iLeadingZeroBits) - 1)), iLeadingZeroBits);
+}
+
+//short codes mostly, long ones from time to time
+uint32_t RandomUeValue() {
+  const int32_t kiLeadingZeroBits = (rand() % 8 == 0) ? rand() % 31 : rand() % 8;
+  const uint32_t kuiInfo = (((uint32_t)rand() << 16) ^ rand()) & ((1U << kiLeadingZeroBits) - 1);
+  return (1U << kiLeadingZeroBits) - 1 + kuiInfo;
+}
+
+TEST (ExpGolomb, ReadBack) {
+  uint8_t uiBuf[EXP_GOLOMB_BUF_SIZE];
+  SExpGolombSyntax sSyntax[EXP_GOLOMB_SYNTAX_NUM];
+  srand ((unsigned int)time (NULL));
+
+  for (int32_t iTestIdx = 0; iTestIdx < EXP_GOLOMB_TEST_NUM; iTestIdx++) {
+    const int32_t kiStart = rand() % 8;
+    int32_t iPos = 0;
+    memset (uiBuf, 0, sizeof (uiBuf));
+    for (int32_t i = 0; i < EXP_GOLOMB_SYNTAX_NUM; i++) {
+      sSyntax[i].iType = rand() % SYNTAX_TYPE_NUM;
+      if (SYNTAX_BITS == sSyntax[i].iType) {
+        sSyntax[i].iBits = 1 + rand() % 32;
+        sSyntax[i].uiValue = (((uint32_t)rand() << 16) ^ rand()) >> (32 - sSyntax[i].iBits);
+        AnchorPutBits (uiBuf + kiStart, &iPos, sSyntax[i].uiValue, sSyntax[i].iBits);
+      } else if (SYNTAX_UE == sSyntax[i].iType) {
+        sSyntax[i].uiValue = RandomUeValue();
+        AnchorPutUe (uiBuf + kiStart, &iPos, sSyntax[i].uiValue);
+      } else {
+        const uint32_t kuiCodeNum = RandomUeValue() & 0x7fffffff;
+        sSyntax[i].iValue = (kuiCodeNum & 1) ? (int32_t) ((kuiCodeNum + 1) >> 1) : - (int32_t) (kuiCodeNum >> 1);
+        AnchorPutUe (uiBuf + kiStart, &iPos, kuiCodeNum);
+      }
+    }
+    AnchorPutBits (uiBuf + kiStart, &iPos, 1, 1); //stop bit
+
+    SBitStringAux sBs;
+    InitBits (&sBs, uiBuf + kiStart, iPos);
+    for (int32_t i = 0; i < EXP_GOLOMB_SYNTAX_NUM; i++) {
+      uint32_t uiCode = 0;
+      int32_t iCode = 0;
+      if (SYNTAX_BITS == sSyntax[i].iType) {
+        ASSERT_EQ (ERR_NONE, BsGetBits (&sBs, sSyntax[i].iBits, &uiCode));
+        EXPECT_EQ (sSyntax[i].uiValue, uiCode);
+      } else if (SYNTAX_UE == sSyntax[i].iType) {
+        ASSERT_EQ (ERR_NONE, BsGetUe (&sBs, &uiCode));
+        EXPECT_EQ (sSyntax[i].uiValue, uiCode);
+      } else {
+        ASSERT_EQ (ERR_NONE, BsGetSe (&sBs, &iCode));
+        EXPECT_EQ (sSyntax[i].iValue, iCode);
+      }
+    }
+    uint32_t uiStopBit = 0;
+    ASSERT_EQ (ERR_NONE, BsGetOneBit (&sBs, &uiStopBit));
+    EXPECT_EQ (1U, uiStopBit);
+    EXPECT_EQ (iPos, BsGetUsedBits (&sBs));
+  }
+}
+
+TEST (ExpGolomb, ReadOverflow) {
+  uint8_t uiBuf[EXP_GOLOMB_BUF_SIZE];
+  srand ((unsigned int)time (NULL));
+
+  for (int32_t iTestIdx = 0; iTestIdx < EXP_GOLOMB_TEST_NUM; iTestIdx++) {
+    const int32_t kiBytes = 1 + rand() % 32;
+    for (int32_t i = 0; i < EXP_GOLOMB_BUF_SIZE; i++)
+      uiBuf[i] = rand();
+
+    SBitStringAux sBs;
+    InitBits (&sBs, uiBuf, kiBytes << 3);
+    int32_t iRet = ERR_NONE;
+    int32_t iReadBits = 0;
+    uint32_t uiCode;
+    while (iRet == ERR_NONE && iReadBits < (EXP_GOLOMB_BUF_SIZE << 3)) {
+      const int32_t kiBits = 1 + rand() % 32;
+      iRet = BsGetBits (&sBs, kiBits, &uiCode);
+      if (iRet == ERR_NONE && iReadBits + kiBits <= (kiBytes << 3)) {
+        EXPECT_EQ (iReadBits + kiBits, BsGetUsedBits (&sBs));
+      }
+      iReadBits += kiBits;
+    }
+    EXPECT_EQ (ERR_INFO_READ_OVERFLOW, iRet);
+    //the end of buffer is found within the next refill
+    EXPECT_LE (iReadBits, (kiBytes << 3) + 64 + 32);
+  }
+}
@@ -1,12 +1,12 @@
 #include<gtest/gtest.h>
 #include "codec_def.h"
 #include "expand_pic.h"
-#include "mem_align.h"
+#include "memory_align.h"
 using namespace WelsDec;
 #define EXPAND_PIC_TEST_NUM 10
 namespace WelsDec {
 extern PPicture AllocPicture (PWelsDecoderContext pCtx, const int32_t kPicWidth, const int32_t kPicHeight);
-extern void FreePicture (PPicture pPic);
+extern void FreePicture (PPicture pPic, CMemoryAlign* pMa);
 }
 #define H264_PADDING_LENGTH_LUMA (PADDING_LENGTH)
 #define H264_PADDING_LENGTH_CHROMA (PADDING_LENGTH>>1)
@@ -99,6 +99,7 @@ bool CompareBuff (uint8_t* pSrc0, uint8_t* pSrc1, int32_t iStride, int32_t iWidt
 TEST (ExpandPicture, ExpandPictureLuma) {
   SExpandPicFunc	    sExpandPicFunc;
   InitExpandPictureFunc (&sExpandPicFunc, 0);
+  CMemoryAlign cMa (16);
   srand ((unsigned int)time (0));
   for (int32_t iTestIdx = 0; iTestIdx < EXPAND_PIC_TEST_NUM; iTestIdx++) {
     int32_t iPicWidth = 16 + (rand() % 200) * 16;
@@ -107,10 +108,10 @@ TEST (ExpandPicture, ExpandPictureLuma) {
     int32_t iStride = iPicWidth + H264_PADDING_LENGTH_LUMA * 2;
     int32_t iBuffHeight = iPicHeight + H264_PADDING_LENGTH_LUMA * 2;
     int32_t iBuffSize =  iBuffHeight * iStride * sizeof (uint8_t);
-    uint8_t* pAnchorDstBuff = static_cast<uint8_t*> (WelsMalloc (iBuffSize, "pAnchorDstBuff"));
+    uint8_t* pAnchorDstBuff = static_cast<uint8_t*> (cMa.WelsMallocz (iBuffSize, "pAnchorDstBuff"));
     uint8_t* pAnchorDst = pAnchorDstBuff + H264_PADDING_LENGTH_LUMA * iStride + H264_PADDING_LENGTH_LUMA;
 
-    uint8_t* pTestDstBuff = static_cast<uint8_t*> (WelsMalloc (iBuffSize, "pTestDstBuff"));
+    uint8_t* pTestDstBuff = static_cast<uint8_t*> (cMa.WelsMallocz (iBuffSize, "pTestDstBuff"));
     uint8_t* pTestDst = pTestDstBuff + H264_PADDING_LENGTH_LUMA * iStride + H264_PADDING_LENGTH_LUMA;
 
     // Generate Src
@@ -124,8 +125,8 @@ TEST (ExpandPicture, ExpandPictureLuma) {
     EXPECT_EQ (CompareBuff (pAnchorDstBuff, pTestDstBuff, iStride, iPicWidth + H264_PADDING_LENGTH_LUMA * 2,
                             iPicHeight + H264_PADDING_LENGTH_LUMA * 2), true);
 
-    WELS_SAFE_FREE (pAnchorDstBuff, "pAnchorDstBuff");
-    WELS_SAFE_FREE (pTestDstBuff, "pTestDstBuff");
+    cMa.WelsFree (pAnchorDstBuff, "pAnchorDstBuff");
+    cMa.WelsFree (pTestDstBuff, "pTestDstBuff");
   }
 
 }
@@ -133,6 +134,7 @@ TEST (ExpandPicture, ExpandPictureLuma) {
 TEST (ExpandPicture, ExpandPictureChroma) {
   SExpandPicFunc	    sExpandPicFunc;
   InitExpandPictureFunc (&sExpandPicFunc, 0);
+  CMemoryAlign cMa (16);
   srand ((unsigned int)time (0));
 
   for (int32_t iTestIdx = 0; iTestIdx < EXPAND_PIC_TEST_NUM; iTestIdx++) {
@@ -142,10 +144,10 @@ TEST (ExpandPicture, ExpandPictureChroma) {
     int32_t iStride = (iPicWidth + H264_PADDING_LENGTH_CHROMA * 2 + 8) >> 4 << 4;
     int32_t iBuffHeight = iPicHeight + H264_PADDING_LENGTH_CHROMA * 2;
     int32_t iBuffSize =  iBuffHeight * iStride * sizeof (uint8_t);
-    uint8_t* pAnchorDstBuff = static_cast<uint8_t*> (WelsMalloc (iBuffSize, "pAnchorDstBuff"));
+    uint8_t* pAnchorDstBuff = static_cast<uint8_t*> (cMa.WelsMallocz (iBuffSize, "pAnchorDstBuff"));
     uint8_t* pAnchorDst = pAnchorDstBuff + H264_PADDING_LENGTH_CHROMA * iStride + H264_PADDING_LENGTH_CHROMA;
 
-    uint8_t* pTestDstBuff = static_cast<uint8_t*> (WelsMalloc (iBuffSize, "pTestDstBuff"));
+    uint8_t* pTestDstBuff = static_cast<uint8_t*> (cMa.WelsMallocz (iBuffSize, "pTestDstBuff"));
     uint8_t* pTestDst = pTestDstBuff + H264_PADDING_LENGTH_CHROMA * iStride + H264_PADDING_LENGTH_CHROMA;
 
     // Generate Src
@@ -159,8 +161,8 @@ TEST (ExpandPicture, ExpandPictureChroma) {
     EXPECT_EQ (CompareBuff (pAnchorDstBuff, pTestDstBuff, iStride, iPicWidth + H264_PADDING_LENGTH_CHROMA * 2,
                             iPicHeight + H264_PADDING_LENGTH_CHROMA * 2), true);
 
-    WELS_SAFE_FREE (pAnchorDstBuff, "pAnchorDstBuff");
-    WELS_SAFE_FREE (pTestDstBuff, "pTestDstBuff");
+    cMa.WelsFree (pAnchorDstBuff, "pAnchorDstBuff");
+    cMa.WelsFree (pTestDstBuff, "pTestDstBuff");
   }
 
 }
@@ -168,8 +170,11 @@ TEST (ExpandPicture, ExpandPictureChroma) {
 TEST (ExpandPicture, ExpandPicForMotion) {
   SExpandPicFunc	    sExpandPicFunc;
   InitExpandPictureFunc (&sExpandPicFunc, 0);
+  CMemoryAlign cMa (16);
   srand ((unsigned int)time (0));
   SWelsDecoderContext sCtx;
+  memset (&sCtx, 0, sizeof (sCtx));
+  sCtx.pMemAlign = &cMa;
   PPicture pPicAnchor = NULL;
   PPicture pPicTest = NULL;
   for (int32_t iTestIdx = 0; iTestIdx < EXPAND_PIC_TEST_NUM; iTestIdx++) {
@@ -208,8 +213,8 @@ TEST (ExpandPicture, ExpandPicForMotion) {
     EXPECT_EQ (CompareBuff (pPicAnchor->pBuffer[2], pPicTest->pBuffer[2], iStrideC, iPicWidth / 2 + PADDING_LENGTH,
                             iPicHeight / 2 + PADDING_LENGTH), true);
 
-    FreePicture (pPicAnchor);
-    FreePicture (pPicTest);
+    FreePicture (pPicAnchor, &cMa);
+    FreePicture (pPicTest, &cMa);
   }
 }
 
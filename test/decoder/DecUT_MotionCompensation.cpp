@@ -1,8 +1,9 @@
 #include<gtest/gtest.h>
 #include "codec_def.h"
 #include "mc.h"
-#include "mem_align.h"
+#include "memory_align.h"
 #include "cpu_core.h"
+#include "cpu.h"
 using namespace WelsDec;
 #ifdef X86_ASM
 #define TEST_CASE 0
@@ -332,3 +333,74 @@ DEF_CHROMA_MCTEST (7, 4)
 DEF_CHROMA_MCTEST (7, 5)
 DEF_CHROMA_MCTEST (7, 6)
 DEF_CHROMA_MCTEST (7, 7)
+
+#if defined(X86_INTRINSICS)
+TEST (McLuma_avx2, AllPositionsAndSizes) {
+  static const int32_t kiSizes[7][2] = { {4, 4}, {4, 8}, {8, 4}, {8, 8}, {16, 8}, {8, 16}, {16, 16} };
+  int32_t iTmp = 1;
+  if (0 == (WelsCPUFeatureDetect (&iTmp) & WELS_CPU_AVX2))
+    return;
+
+  SMcFunc sMcFunc;
+  InitMcFunc (&sMcFunc, WELS_CPU_MMX | WELS_CPU_SSE2 | WELS_CPU_AVX2);
+  uint8_t uSrcAnchor[4][MC_BUFF_HEIGHT][MC_BUFF_SRC_STRIDE];
+  uint8_t uSrcTest[MC_BUFF_HEIGHT][MC_BUFF_SRC_STRIDE];
+  uint8_t uDstAnchor[MC_BUFF_HEIGHT][MC_BUFF_DST_STRIDE];
+  uint8_t uDstTest[MC_BUFF_HEIGHT][MC_BUFF_DST_STRIDE];
+  uint8_t* uSrcInputAnchor[4];
+  int16_t pBuf[MC_BUFF_DST_STRIDE];
+  for (int32_t k = 0; k < 4; k++)
+    uSrcInputAnchor[k] = &uSrcAnchor[k][4][4];
+  srand ((unsigned int)time (0));
+  for (int32_t iSize = 0; iSize < 7; iSize++) {
+    const int32_t kiW = kiSizes[iSize][0];
+    const int32_t kiH = kiSizes[iSize][1];
+    for (int32_t iMv = 0; iMv < 16; iMv++) {
+      for (int32_t j = 0; j < MC_BUFF_HEIGHT; j++)
+        for (int32_t i = 0; i < MC_BUFF_SRC_STRIDE; i++)
+          uSrcAnchor[0][j][i] = uSrcTest[j][i] = rand() % 256;
+      memset (uDstAnchor, 0, sizeof (uDstAnchor));
+      memset (uDstTest, 0, sizeof (uDstTest));
+      MCHalfPelFilterAnchor (uSrcInputAnchor[1], uSrcInputAnchor[2], uSrcInputAnchor[3], uSrcInputAnchor[0],
+                             MC_BUFF_SRC_STRIDE, kiW + 1, kiH + 1, pBuf + 4);
+      MCLumaAnchor (uDstAnchor[0], MC_BUFF_DST_STRIDE, uSrcInputAnchor, MC_BUFF_SRC_STRIDE, iMv & 3, iMv >> 2, kiW, kiH);
+      sMcFunc.pMcLumaFunc (&uSrcTest[4][4], MC_BUFF_SRC_STRIDE, uDstTest[0], MC_BUFF_DST_STRIDE, iMv & 3, iMv >> 2, kiW,
+                           kiH);
+      ASSERT_EQ (0, memcmp (uDstAnchor, uDstTest, sizeof (uDstTest))) << kiW << "x" << kiH << " mv " << (iMv & 3) << ","
+          << (iMv >> 2);
+    }
+  }
+}
+
+TEST (McChroma_avx2, AllPositionsAndSizes) {
+  static const int32_t kiSizes[7][2] = { {2, 2}, {2, 4}, {4, 2}, {4, 4}, {4, 8}, {8, 4}, {8, 8} };
+  int32_t iTmp = 1;
+  if (0 == (WelsCPUFeatureDetect (&iTmp) & WELS_CPU_AVX2))
+    return;
+
+  SMcFunc sMcFunc;
+  InitMcFunc (&sMcFunc, WELS_CPU_MMX | WELS_CPU_SSE2 | WELS_CPU_AVX2);
+  uint8_t uSrcAnchor[MC_BUFF_HEIGHT][MC_BUFF_SRC_STRIDE * 2];
+  uint8_t uSrcTest[MC_BUFF_HEIGHT][MC_BUFF_SRC_STRIDE];
+  uint8_t uDstAnchor[2][MC_BUFF_HEIGHT][MC_BUFF_DST_STRIDE];
+  uint8_t uDstTest[MC_BUFF_HEIGHT][MC_BUFF_DST_STRIDE];
+  srand ((unsigned int)time (0));
+  for (int32_t iSize = 0; iSize < 7; iSize++) {
+    const int32_t kiW = kiSizes[iSize][0];
+    const int32_t kiH = kiSizes[iSize][1];
+    for (int32_t iMv = 0; iMv < 64; iMv++) {
+      for (int32_t j = 0; j < MC_BUFF_HEIGHT; j++)
+        for (int32_t i = 0; i < MC_BUFF_SRC_STRIDE; i++)
+          uSrcAnchor[j][i * 2] = uSrcTest[j][i] = rand() % 256;
+      memset (uDstAnchor[0], 0, sizeof (uDstAnchor[0]));
+      memset (uDstTest, 0, sizeof (uDstTest));
+      MCChromaAnchor (uDstAnchor[0][0], uDstAnchor[1][0], MC_BUFF_DST_STRIDE, uSrcAnchor[0], MC_BUFF_SRC_STRIDE * 2,
+                      iMv & 7, iMv >> 3, kiW, kiH);
+      sMcFunc.pMcChromaFunc (uSrcTest[0], MC_BUFF_SRC_STRIDE, uDstTest[0], MC_BUFF_DST_STRIDE, iMv & 7, iMv >> 3, kiW,
+                             kiH);
+      ASSERT_EQ (0, memcmp (uDstAnchor[0], uDstTest, sizeof (uDstTest))) << kiW << "x" << kiH << " mv " << (iMv & 7) << ","
+          << (iMv >> 3);
+    }
+  }
+}
+#endif//X86_INTRINSICS
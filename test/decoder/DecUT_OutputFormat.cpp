@@ -0,0 +1,99 @@
+#include<gtest/gtest.h>
+#include <stdlib.h>
+#include "codec_def.h"
+#include "cpu.h"
+#include "output_format.h"
+using namespace WelsDec;
+
+#define OUTPUT_FORMAT_TEST_WIDTH 77
+
+static void FillWithRandomData (uint8_t* pData, int32_t iLen) {
+  for (int32_t i = 0; i < iLen; i++)
+    pData[i] = rand() & 0xff;
+}
+
+TEST (OutputFormatTest, YuvToRgba_c) {
+  uint8_t uiY[2] = {235, 16}, uiU[1] = {128}, uiV[1] = {128};
+  uint8_t uiRgba[8];
+
+  YuvToRgbaRow_c (uiRgba, uiY, uiU, uiV, 2);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ (255, uiRgba[i]);
+    EXPECT_EQ (0, uiRgba[4 + i]);
+  }
+  EXPECT_EQ (255, uiRgba[3]);
+  EXPECT_EQ (255, uiRgba[7]);
+
+  // saturated red, swapped in BGRA
+  uiY[0] = uiY[1] = 81;
+  uiU[0] = 90;
+  uiV[0] = 240;
+  YuvToRgbaRow_c (uiRgba, uiY, uiU, uiV, 2);
+  EXPECT_GE (uiRgba[0], 250);
+  EXPECT_LE (uiRgba[1], 5);
+  EXPECT_LE (uiRgba[2], 5);
+  uint8_t uiBgra[8];
+  YuvToBgraRow_c (uiBgra, uiY, uiU, uiV, 2);
+  EXPECT_EQ (uiRgba[0], uiBgra[2]);
+  EXPECT_EQ (uiRgba[1], uiBgra[1]);
+  EXPECT_EQ (uiRgba[2], uiBgra[0]);
+  EXPECT_EQ (uiRgba[3], uiBgra[3]);
+}
+
+TEST (OutputFormatTest, InterleaveUV_c) {
+  uint8_t uiU[OUTPUT_FORMAT_TEST_WIDTH], uiV[OUTPUT_FORMAT_TEST_WIDTH], uiUV[OUTPUT_FORMAT_TEST_WIDTH * 2];
+
+  FillWithRandomData (uiU, OUTPUT_FORMAT_TEST_WIDTH);
+  FillWithRandomData (uiV, OUTPUT_FORMAT_TEST_WIDTH);
+  InterleaveUV_c (uiUV, uiU, uiV, OUTPUT_FORMAT_TEST_WIDTH);
+  for (int i = 0; i < OUTPUT_FORMAT_TEST_WIDTH; i++) {
+    EXPECT_EQ (uiU[i], uiUV[2 * i]);
+    EXPECT_EQ (uiV[i], uiUV[2 * i + 1]);
+  }
+}
+
+TEST (OutputFormatTest, ScaleRowBilinear_c) {
+  uint8_t uiSrc0[OUTPUT_FORMAT_TEST_WIDTH], uiSrc1[OUTPUT_FORMAT_TEST_WIDTH], uiDst[OUTPUT_FORMAT_TEST_WIDTH];
+
+  FillWithRandomData (uiSrc0, OUTPUT_FORMAT_TEST_WIDTH);
+  FillWithRandomData (uiSrc1, OUTPUT_FORMAT_TEST_WIDTH);
+  // unit step and no vertical weight copy the first row
+  ScaleRowBilinear_c (uiDst, OUTPUT_FORMAT_TEST_WIDTH, uiSrc0, uiSrc1, OUTPUT_FORMAT_TEST_WIDTH, 1 << 16, 0);
+  EXPECT_EQ (0, memcmp (uiDst, uiSrc0, OUTPUT_FORMAT_TEST_WIDTH));
+
+  // halving averages pairs of samples of both rows
+  memset (uiSrc0, 10, sizeof (uiSrc0));
+  memset (uiSrc1, 30, sizeof (uiSrc1));
+  for (int i = 0; i < OUTPUT_FORMAT_TEST_WIDTH; i += 2)
+    uiSrc0[i] = 50;
+  ScaleRowBilinear_c (uiDst, OUTPUT_FORMAT_TEST_WIDTH / 2, uiSrc0, uiSrc1, OUTPUT_FORMAT_TEST_WIDTH, 2 << 16, 128);
+  for (int i = 0; i < OUTPUT_FORMAT_TEST_WIDTH / 2; i++)
+    EXPECT_EQ (30, uiDst[i]);
+}
+
+#if defined(X86_INTRINSICS)
+TEST (OutputFormatTest, Sse2MatchesC) {
+  int32_t iCpuCores = 0;
+  if (! (WelsCPUFeatureDetect (&iCpuCores) & WELS_CPU_SSE2))
+    return;
+
+  for (int32_t iWidth = 1; iWidth <= OUTPUT_FORMAT_TEST_WIDTH; iWidth++) {
+    uint8_t uiY[OUTPUT_FORMAT_TEST_WIDTH], uiU[OUTPUT_FORMAT_TEST_WIDTH], uiV[OUTPUT_FORMAT_TEST_WIDTH];
+    uint8_t uiRef[OUTPUT_FORMAT_TEST_WIDTH * 4], uiDst[OUTPUT_FORMAT_TEST_WIDTH * 4];
+
+    FillWithRandomData (uiY, iWidth);
+    FillWithRandomData (uiU, (iWidth + 1) >> 1);
+    FillWithRandomData (uiV, (iWidth + 1) >> 1);
+
+    YuvToRgbaRow_c (uiRef, uiY, uiU, uiV, iWidth);
+    YuvToRgbaRow_sse2 (uiDst, uiY, uiU, uiV, iWidth);
+    EXPECT_EQ (0, memcmp (uiRef, uiDst, iWidth * 4));
+    YuvToBgraRow_c (uiRef, uiY, uiU, uiV, iWidth);
+    YuvToBgraRow_sse2 (uiDst, uiY, uiU, uiV, iWidth);
+    EXPECT_EQ (0, memcmp (uiRef, uiDst, iWidth * 4));
+    InterleaveUV_c (uiRef, uiU, uiV, iWidth);
+    InterleaveUV_sse2 (uiDst, uiU, uiV, iWidth);
+    EXPECT_EQ (0, memcmp (uiRef, uiDst, iWidth * 2));
+  }
+}
+#endif//X86_INTRINSICS
@@ -3,7 +3,7 @@
 #include <time.h>
 
 #include "wels_common_basis.h"
-#include "mem_align.h"
+#include "memory_align.h"
 #include "mv_pred.h"
 #include "ls_defines.h"
 
@@ -418,24 +418,24 @@ void AnchorPredPSkipMvFromNeighbor (PDqLayer pCurLayer, int16_t iMvp[2]) {
 
 
 
-int32_t AllocLayerData (PDqLayer pDqLayer) {
+int32_t AllocLayerData (PDqLayer pDqLayer, CMemoryAlign* pMa) {
 
-  pDqLayer->pSliceIdc = (int32_t*) WelsMalloc (pDqLayer->iMbWidth * pDqLayer->iMbHeight * sizeof (int32_t),
+  pDqLayer->pSliceIdc = (int32_t*) pMa->WelsMallocz (pDqLayer->iMbWidth * pDqLayer->iMbHeight * sizeof (int32_t),
                         "pDqLayer->pSliceIdc");
   if (pDqLayer->pSliceIdc == NULL)
     return 1;
 
-  pDqLayer->pMbType = (int8_t*) WelsMalloc (pDqLayer->iMbWidth * pDqLayer->iMbHeight * sizeof (int8_t),
+  pDqLayer->pMbType = (int8_t*) pMa->WelsMallocz (pDqLayer->iMbWidth * pDqLayer->iMbHeight * sizeof (int8_t),
                       "pDqLayer->pMbType");
   if (pDqLayer->pMbType == NULL)
     return 1;
 
-  pDqLayer->pMv[0] = (int16_t (*)[MB_BLOCK4x4_NUM][MV_A]) WelsMalloc (pDqLayer->iMbWidth * pDqLayer->iMbHeight * sizeof (
+  pDqLayer->pMv[0] = (int16_t (*)[MB_BLOCK4x4_NUM][MV_A]) pMa->WelsMallocz (pDqLayer->iMbWidth * pDqLayer->iMbHeight * sizeof (
                        int16_t) * MV_A * MB_BLOCK4x4_NUM, "pDqLayer->pMv");
   if (pDqLayer->pMv[0] == NULL)
     return 1;
 
-  pDqLayer->pRefIndex[0] = (int8_t (*)[MB_BLOCK4x4_NUM]) WelsMalloc (pDqLayer->iMbWidth * pDqLayer->iMbHeight * sizeof (
+  pDqLayer->pRefIndex[0] = (int8_t (*)[MB_BLOCK4x4_NUM]) pMa->WelsMallocz (pDqLayer->iMbWidth * pDqLayer->iMbHeight * sizeof (
                              int8_t) * MB_BLOCK4x4_NUM, "pDqLayer->pRefIndex");
   if (pDqLayer->pRefIndex[0] == NULL)
     return 1;
@@ -443,25 +443,25 @@ int32_t AllocLayerData (PDqLayer pDqLayer) {
   return 0;
 }
 
-int32_t FreeLayerData (PDqLayer pDqLayer) {
+int32_t FreeLayerData (PDqLayer pDqLayer, CMemoryAlign* pMa) {
 
   if (pDqLayer->pSliceIdc != NULL) {
-    WelsFree (pDqLayer->pSliceIdc, "pDqLayer->pSliceIdc");
+    pMa->WelsFree (pDqLayer->pSliceIdc, "pDqLayer->pSliceIdc");
     pDqLayer->pSliceIdc = NULL;
   }
 
   if (pDqLayer->pMbType != NULL) {
-    WelsFree (pDqLayer->pMbType, "pDqLayer->pMbType");
+    pMa->WelsFree (pDqLayer->pMbType, "pDqLayer->pMbType");
     pDqLayer->pMbType = NULL;
   }
 
   if (pDqLayer->pMv[0] != NULL) {
-    WelsFree (pDqLayer->pMv[0], "pDqlayer->pMv[0]");
+    pMa->WelsFree (pDqLayer->pMv[0], "pDqlayer->pMv[0]");
     pDqLayer->pMv[0] = NULL;
   }
 
   if (pDqLayer->pRefIndex[0] != NULL) {
-    WelsFree (pDqLayer->pRefIndex[0], "pDqlayer->pRefIndex[0]");
+    pMa->WelsFree (pDqLayer->pRefIndex[0], "pDqlayer->pRefIndex[0]");
     pDqLayer->pRefIndex[0] = NULL;
   }
 
@@ -515,7 +515,16 @@ void InitRandomLayerData (PDqLayer pDqLayer) {
   InitRandomLayerRefIdxData (pDqLayer);
 }
 
+// slices without FMO cover the MBs from their first one on, which the prediction goes by instead of pSliceIdc
+void InitLayerFirstMbInSlice (PDqLayer pDqLayer) {
+  int32_t iFirstMb = pDqLayer->iMbXyIndex;
+  while (iFirstMb > 0 && pDqLayer->pSliceIdc[iFirstMb - 1] == pDqLayer->pSliceIdc[pDqLayer->iMbXyIndex])
+    -- iFirstMb;
+  pDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.iFirstMbInSlice = iFirstMb;
+}
+
 #define TEST_SKIP_MV_PRED \
+  InitLayerFirstMbInSlice (&sDqLayer); \
   PredPSkipMvFromNeighbor (&sDqLayer, iWelsMvp); \
   bOK = ((iWelsMvp[0] == iAncMvp[0]) && (iWelsMvp[1] == iAncMvp[1])); \
   EXPECT_EQ (bOK, true);
@@ -524,15 +533,20 @@ TEST (PredMvTest, PredSkipMvFromNeighbor) {
   const int32_t kiRandTime = 100;
   bool bOK = true;
   SDqLayer sDqLayer;
+  SPps sPps;
+  CMemoryAlign cMa (16);
   int16_t iAncMvp[2], iWelsMvp[2];
 
   memset (&sDqLayer, 0, sizeof (SDqLayer));
+  memset (&sPps, 0, sizeof (SPps));
+  sPps.uiNumSliceGroups = 1;
+  sDqLayer.sLayerInfo.pPps = &sPps;
   //Assume the input data as 352x288 size
   //allocate the data
   sDqLayer.iMbWidth = 11;
   sDqLayer.iMbHeight = 9;
-  if (AllocLayerData (&sDqLayer)) { //memory allocate failed
-    FreeLayerData (&sDqLayer);
+  if (AllocLayerData (&sDqLayer, &cMa)) { //memory allocate failed
+    FreeLayerData (&sDqLayer, &cMa);
     return;
   }
   InitRandomLayerData (&sDqLayer); //init MV data, as it would not affect the following logic test
@@ -666,5 +680,5 @@ TEST (PredMvTest, PredSkipMvFromNeighbor) {
     TEST_SKIP_MV_PRED;
   }
 
-  FreeLayerData (&sDqLayer);
+  FreeLayerData (&sDqLayer, &cMa);
 }
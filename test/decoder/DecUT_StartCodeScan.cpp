@@ -0,0 +1,66 @@
+#include<gtest/gtest.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "au_parser.h"
+
+using namespace WelsDec;
+
+#define START_CODE_SCAN_TEST_NUM 1000
+#define START_CODE_SCAN_BUF_SIZE 256
+
+//Anchor functions
+int32_t AnchorFindStartCodeCandidate (const uint8_t* kpBuf, const int32_t kiBufSize) {
+  for (int32_t i = 0; i + 2 < kiBufSize; i++) {
+    if (kpBuf[i] == 0 && kpBuf[i + 1] == 0 && kpBuf[i + 2] <= 3)
+      return i;
+  }
+  return kiBufSize;
+}
+
+uint8_t* AnchorDetectStartCodePrefix (const uint8_t* kpBuf, int32_t* pOffset, int32_t iBufSize) {
+  for (int32_t i = 0; i + 2 < iBufSize; i++) {
+    if (kpBuf[i] == 0 && kpBuf[i + 1] == 0 && kpBuf[i + 2] == 1) {
+      *pOffset = i + 3;
+      return (uint8_t*)kpBuf + i + 3;
+    }
+  }
+  return NULL;
+}
+
+//sparse zeros so that long runs without candidates are common
+void FillStartCodeScanBuf (uint8_t* pBuf, const int32_t kiBufSize) {
+  const int32_t kiZeroRate = 1 + rand() % 64;
+  for (int32_t i = 0; i < kiBufSize; i++) {
+    pBuf[i] = (rand() % kiZeroRate == 0) ? 0 : (rand() % 6 == 0 ? rand() % 4 : 1 + rand() % 255);
+  }
+}
+
+TEST (StartCodeScan, FindStartCodeCandidate) {
+  uint8_t uiBuf[START_CODE_SCAN_BUF_SIZE];
+  srand ((unsigned int)time (NULL));
+
+  for (int32_t iTestIdx = 0; iTestIdx < START_CODE_SCAN_TEST_NUM; iTestIdx++) {
+    FillStartCodeScanBuf (uiBuf, START_CODE_SCAN_BUF_SIZE);
+    const int32_t kiStart = rand() % 16;
+    const int32_t kiSize  = rand() % (START_CODE_SCAN_BUF_SIZE - kiStart);
+    EXPECT_EQ (AnchorFindStartCodeCandidate (uiBuf + kiStart, kiSize),
+               FindStartCodeCandidate (uiBuf + kiStart, kiSize));
+  }
+}
+
+TEST (StartCodeScan, DetectStartCodePrefix) {
+  uint8_t uiBuf[START_CODE_SCAN_BUF_SIZE];
+  srand ((unsigned int)time (NULL));
+
+  for (int32_t iTestIdx = 0; iTestIdx < START_CODE_SCAN_TEST_NUM; iTestIdx++) {
+    FillStartCodeScanBuf (uiBuf, START_CODE_SCAN_BUF_SIZE);
+    const int32_t kiStart = rand() % 16;
+    const int32_t kiSize  = rand() % (START_CODE_SCAN_BUF_SIZE - kiStart);
+    int32_t iAnchorOffset = -1, iOffset = -1;
+    uint8_t* pAnchor = AnchorDetectStartCodePrefix (uiBuf + kiStart, &iAnchorOffset, kiSize);
+    uint8_t* pResult = DetectStartCodePrefix (uiBuf + kiStart, &iOffset, kiSize);
+    EXPECT_EQ (pAnchor, pResult);
+    EXPECT_EQ (iAnchorOffset, iOffset);
+  }
+}
@@ -1,10 +1,14 @@
 DECODER_UNITTEST_SRCDIR=test/decoder
 DECODER_UNITTEST_CPP_SRCS=\
+	$(DECODER_UNITTEST_SRCDIR)/DecUT_Deblocking.cpp\
 	$(DECODER_UNITTEST_SRCDIR)/DecUT_ExpandPicture.cpp\
+	$(DECODER_UNITTEST_SRCDIR)/DecUT_ExpGolomb.cpp\
 	$(DECODER_UNITTEST_SRCDIR)/DecUT_IdctResAddPred.cpp\
 	$(DECODER_UNITTEST_SRCDIR)/DecUT_IntraPrediction.cpp\
 	$(DECODER_UNITTEST_SRCDIR)/DecUT_MotionCompensation.cpp\
+	$(DECODER_UNITTEST_SRCDIR)/DecUT_OutputFormat.cpp\
 	$(DECODER_UNITTEST_SRCDIR)/DecUT_PredMv.cpp\
+	$(DECODER_UNITTEST_SRCDIR)/DecUT_StartCodeScan.cpp\
 
 DECODER_UNITTEST_OBJS += $(DECODER_UNITTEST_CPP_SRCS:.cpp=.$(OBJ))
 
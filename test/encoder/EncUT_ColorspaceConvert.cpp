@@ -0,0 +1,213 @@
+#include<gtest/gtest.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+
+#include "typedefs.h"
+#include "macros.h"
+#include "IWelsVP.h"
+
+#define CSC_TEST_WIDTH  720
+#define CSC_TEST_HEIGHT 480
+#define CSC_TEST_STRIDE 768
+#define CSC_TEST_PLANE_SIZE (CSC_TEST_STRIDE * CSC_TEST_HEIGHT)
+
+// reference of the conversions, the kernels of every CPU have to give the same pixels
+static int32_t WeightRef (const uint8_t* p, int32_t iR, int32_t iG, int32_t iB, bool bBgra) {
+  const int32_t kiR = bBgra ? p[2] : p[0], kiB = bBgra ? p[0] : p[2];
+  return (iR * kiR + iG * p[1] + iB * kiB + 128) >> 8;
+}
+
+static void RgbToI420Ref (uint8_t* pDst[3], int32_t iDstStride, const uint8_t* pSrc, int32_t iSrcStride,
+                          int32_t iWidth, int32_t iHeight, bool bBgra) {
+  for (int32_t j = 0; j < iHeight; j++) {
+    for (int32_t i = 0; i < iWidth; i++)
+      pDst[0][j * iDstStride + i] = (uint8_t) (WeightRef (pSrc + j * iSrcStride + 4 * i, 66, 129, 25, bBgra) + 16);
+  }
+  for (int32_t j = 0; j < (iHeight >> 1); j++) {
+    for (int32_t i = 0; i < (iWidth >> 1); i++) {
+      const uint8_t* p = pSrc + 2 * j * iSrcStride + 8 * i;
+      uint8_t uiAvg[4];
+      for (int32_t k = 0; k < 4; k++)
+        uiAvg[k] = (uint8_t) ((p[k] + p[4 + k] + p[iSrcStride + k] + p[iSrcStride + 4 + k] + 2) >> 2);
+      pDst[1][j * iDstStride + i] = (uint8_t) (WeightRef (uiAvg, -38, -74, 112, bBgra) + 128);
+      pDst[2][j * iDstStride + i] = (uint8_t) (WeightRef (uiAvg, 112, -94, -18, bBgra) + 128);
+    }
+  }
+}
+
+static void Nv12ToI420Ref (uint8_t* pDst[3], int32_t iDstStride, const uint8_t* pSrcY, const uint8_t* pSrcUV,
+                           int32_t iSrcStride, int32_t iWidth, int32_t iHeight) {
+  for (int32_t j = 0; j < iHeight; j++)
+    memcpy (pDst[0] + j * iDstStride, pSrcY + j * iSrcStride, iWidth);
+  for (int32_t j = 0; j < (iHeight >> 1); j++) {
+    for (int32_t i = 0; i < (iWidth >> 1); i++) {
+      pDst[1][j * iDstStride + i] = pSrcUV[j * iSrcStride + 2 * i];
+      pDst[2][j * iDstStride + i] = pSrcUV[j * iSrcStride + 2 * i + 1];
+    }
+  }
+}
+
+static void DyadicDownsampleRef (uint8_t* pDst, int32_t iDstStride, const uint8_t* pSrc, int32_t iSrcStride,
+                                 int32_t iSrcWidth, int32_t iSrcHeight) {
+  for (int32_t j = 0; j < (iSrcHeight >> 1); j++) {
+    for (int32_t i = 0; i < (iSrcWidth >> 1); i++) {
+      const uint8_t* p = pSrc + 2 * j * iSrcStride + 2 * i;
+      int32_t iRow1 = (p[0] + p[1] + 1) >> 1;
+      int32_t iRow2 = (p[iSrcStride] + p[iSrcStride + 1] + 1) >> 1;
+      pDst[j * iDstStride + i] = (uint8_t) ((iRow1 + iRow2 + 1) >> 1);
+    }
+  }
+}
+
+static const EVideoFormat g_keCscTestFormat[3] = { VIDEO_FORMAT_NV12, VIDEO_FORMAT_BGRA, VIDEO_FORMAT_RGBA };
+
+class ColorspaceConvertTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    m_pVp = NULL;
+    CreateVpInterface ((void**)&m_pVp, WELSVP_INTERFACE_VERION);
+    ASSERT_TRUE (NULL != m_pVp);
+    srand ((unsigned int)time (0));
+    // the RGB pictures take four bytes a pixel, NV12 ones the first two planes of the buffers
+    m_pTopDown = new uint8_t[CSC_TEST_PLANE_SIZE * 4];
+    m_pSrc = new uint8_t[CSC_TEST_PLANE_SIZE * 4];
+    m_pBuf = new uint8_t[CSC_TEST_PLANE_SIZE * 9];
+  }
+  virtual void TearDown() {
+    delete [] m_pBuf;
+    delete [] m_pSrc;
+    delete [] m_pTopDown;
+    DestroyVpInterface (m_pVp, WELSVP_INTERFACE_VERION);
+  }
+
+  void InitI420PixMap (SPixMap* pPixMap, uint8_t* pPlane[3], int32_t iWidth, int32_t iHeight) {
+    memset (pPixMap, 0, sizeof (SPixMap));
+    for (int32_t i = 0; i < 3; i++) {
+      pPixMap->pPixel[i]  = pPlane[i];
+      pPixMap->iStride[i] = CSC_TEST_STRIDE;
+    }
+    pPixMap->iSizeInBits = 8;
+    pPixMap->sRect.iRectWidth  = iWidth;
+    pPixMap->sRect.iRectHeight = iHeight;
+    pPixMap->eFormat = VIDEO_FORMAT_I420;
+  }
+
+  // random source of eFormat with bottom-up rows when bFlip, its reference conversion is written to pRef
+  void InitSource (SPixMap* pSrcPixMap, EVideoFormat eFormat, bool bFlip, int32_t iWidth, int32_t iHeight,
+                   uint8_t* pRef[3]) {
+    const bool kbNv12 = (VIDEO_FORMAT_NV12 == eFormat);
+    const int32_t kiStride = kbNv12 ? CSC_TEST_STRIDE : CSC_TEST_STRIDE * 4;
+    for (int32_t i = 0; i < CSC_TEST_PLANE_SIZE * 4; i++)
+      m_pTopDown[i] = rand() % 256;
+    if (kbNv12)
+      Nv12ToI420Ref (pRef, CSC_TEST_STRIDE, m_pTopDown, m_pTopDown + CSC_TEST_PLANE_SIZE, kiStride, iWidth, iHeight);
+    else
+      RgbToI420Ref (pRef, CSC_TEST_STRIDE, m_pTopDown, kiStride, iWidth, iHeight, VIDEO_FORMAT_BGRA == eFormat);
+
+    uint8_t* pSrc = m_pTopDown;
+    if (bFlip) {
+      const int32_t kiRowBytes = kbNv12 ? iWidth : iWidth * 4;
+      for (int32_t j = 0; j < iHeight; j++)
+        memcpy (m_pSrc + j * kiStride, m_pTopDown + (iHeight - 1 - j) * kiStride, kiRowBytes);
+      if (kbNv12) {
+        for (int32_t j = 0; j < (iHeight >> 1); j++)
+          memcpy (m_pSrc + CSC_TEST_PLANE_SIZE + j * kiStride,
+                  m_pTopDown + CSC_TEST_PLANE_SIZE + ((iHeight >> 1) - 1 - j) * kiStride, iWidth);
+      }
+      pSrc = m_pSrc;
+    }
+    memset (pSrcPixMap, 0, sizeof (SPixMap));
+    pSrcPixMap->pPixel[0]  = pSrc;
+    pSrcPixMap->iStride[0] = kiStride;
+    if (kbNv12) {
+      pSrcPixMap->pPixel[1]  = pSrc + CSC_TEST_PLANE_SIZE;
+      pSrcPixMap->iStride[1] = kiStride;
+    }
+    pSrcPixMap->iSizeInBits = kbNv12 ? 8 : 32;
+    pSrcPixMap->sRect.iRectWidth  = iWidth;
+    pSrcPixMap->sRect.iRectHeight = iHeight;
+    pSrcPixMap->eFormat = (EVideoFormat) (eFormat | (bFlip ? VIDEO_FORMAT_VFlip : 0));
+  }
+
+  bool PlanesEqual (uint8_t* pA[3], uint8_t* pB[3], int32_t iWidth, int32_t iHeight) {
+    for (int32_t i = 0; i < 3; i++) {
+      const int32_t kiShift = i ? 1 : 0;
+      for (int32_t j = 0; j < (iHeight >> kiShift); j++) {
+        if (memcmp (pA[i] + j * CSC_TEST_STRIDE, pB[i] + j * CSC_TEST_STRIDE, iWidth >> kiShift))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  IWelsVP* m_pVp;
+  uint8_t* m_pTopDown;
+  uint8_t* m_pSrc;
+  uint8_t* m_pBuf;
+};
+
+TEST_F (ColorspaceConvertTest, ProcessMatchesReference) {
+  uint8_t* pRef[3] = { m_pBuf, m_pBuf + CSC_TEST_PLANE_SIZE, m_pBuf + CSC_TEST_PLANE_SIZE * 2 };
+  uint8_t* pDst[3] = { m_pBuf + CSC_TEST_PLANE_SIZE * 3, m_pBuf + CSC_TEST_PLANE_SIZE * 4, m_pBuf + CSC_TEST_PLANE_SIZE * 5 };
+  SPixMap sSrc, sDst;
+
+  for (int32_t k = 0; k < 30; k++) {
+    const EVideoFormat keFormat = g_keCscTestFormat[k % 3];
+    const bool kbFlip = ((k / 3) & 1) != 0;
+    const int32_t kiWidth = 2 + 2 * (rand() % (CSC_TEST_WIDTH >> 1));
+    const int32_t kiHeight = 2 + 2 * (rand() % (CSC_TEST_HEIGHT >> 1));
+    InitSource (&sSrc, keFormat, kbFlip, kiWidth, kiHeight, pRef);
+    InitI420PixMap (&sDst, pDst, kiWidth, kiHeight);
+    ASSERT_EQ (RET_SUCCESS, m_pVp->Process (METHOD_COLORSPACE_CONVERT, &sSrc, &sDst));
+    ASSERT_TRUE (PlanesEqual (pRef, pDst, kiWidth, kiHeight)) << "format " << keFormat << " flip " << kbFlip << " "
+        << kiWidth << "x" << kiHeight;
+  }
+}
+
+TEST_F (ColorspaceConvertTest, FusedHalfMatchesDownsample) {
+  uint8_t* pRef[3] = { m_pBuf, m_pBuf + CSC_TEST_PLANE_SIZE, m_pBuf + CSC_TEST_PLANE_SIZE * 2 };
+  uint8_t* pDst[3] = { m_pBuf + CSC_TEST_PLANE_SIZE * 3, m_pBuf + CSC_TEST_PLANE_SIZE * 4, m_pBuf + CSC_TEST_PLANE_SIZE * 5 };
+  uint8_t* pHalf[3] = { m_pBuf + CSC_TEST_PLANE_SIZE * 6, m_pBuf + CSC_TEST_PLANE_SIZE * 7, m_pBuf + CSC_TEST_PLANE_SIZE * 8 };
+  uint8_t* pHalfRef[3] = { m_pSrc, m_pSrc + CSC_TEST_PLANE_SIZE, m_pSrc + CSC_TEST_PLANE_SIZE * 2 };
+  SColorspaceConvertLayers sLayers;
+  SPixMap sSrc;
+
+  for (int32_t k = 0; k < 30; k++) {
+    const EVideoFormat keFormat = g_keCscTestFormat[k % 3];
+    const int32_t kiWidth = 4 + 4 * (rand() % (CSC_TEST_WIDTH >> 2));
+    const int32_t kiHeight = 4 + 4 * (rand() % ((CSC_TEST_HEIGHT >> 2) - 1));
+    InitSource (&sSrc, keFormat, false, kiWidth, kiHeight, pRef);
+    InitI420PixMap (&sLayers.sDstPicMap, pDst, kiWidth, kiHeight);
+    InitI420PixMap (&sLayers.sHalfPicMap, pHalf, kiWidth >> 1, kiHeight >> 1);
+    ASSERT_EQ (RET_SUCCESS, m_pVp->SpecialFeature (METHOD_COLORSPACE_CONVERT, &sSrc, &sLayers));
+    ASSERT_TRUE (PlanesEqual (pRef, pDst, kiWidth, kiHeight)) << "format " << keFormat << " " << kiWidth << "x" <<
+        kiHeight;
+
+    for (int32_t i = 0; i < 3; i++) {
+      const int32_t kiShift = i ? 1 : 0;
+      DyadicDownsampleRef (pHalfRef[i], CSC_TEST_STRIDE, pRef[i], CSC_TEST_STRIDE, kiWidth >> kiShift, kiHeight >> kiShift);
+    }
+    ASSERT_TRUE (PlanesEqual (pHalfRef, pHalf, kiWidth >> 1, kiHeight >> 1)) << "format " << keFormat << " " << kiWidth
+        << "x" << kiHeight;
+  }
+}
+
+TEST_F (ColorspaceConvertTest, StripesMatchReference) {
+  uint8_t* pRef[3] = { m_pBuf, m_pBuf + CSC_TEST_PLANE_SIZE, m_pBuf + CSC_TEST_PLANE_SIZE * 2 };
+  uint8_t* pDst[3] = { m_pBuf + CSC_TEST_PLANE_SIZE * 3, m_pBuf + CSC_TEST_PLANE_SIZE * 4, m_pBuf + CSC_TEST_PLANE_SIZE * 5 };
+  SPixMap sSrc, sDst;
+
+  for (int32_t k = 0; k < 12; k++) {
+    const EVideoFormat keFormat = g_keCscTestFormat[k % 3];
+    const int32_t kiWidth = 2 + 2 * (rand() % (CSC_TEST_WIDTH >> 1));
+    const int32_t kiHeight = 2 + 2 * (rand() % (CSC_TEST_HEIGHT >> 1));
+    int32_t iStripeNum = 2 + rand() % 6;
+    ASSERT_EQ (RET_SUCCESS, m_pVp->Set (METHOD_COLORSPACE_CONVERT | METHOD_FLAG_STRIPE_THREADS, &iStripeNum));
+    InitSource (&sSrc, keFormat, (k & 1) != 0, kiWidth, kiHeight, pRef);
+    InitI420PixMap (&sDst, pDst, kiWidth, kiHeight);
+    ASSERT_EQ (RET_SUCCESS, m_pVp->Process (METHOD_COLORSPACE_CONVERT, &sSrc, &sDst));
+    ASSERT_TRUE (PlanesEqual (pRef, pDst, kiWidth, kiHeight)) << "format " << keFormat << " stripes " << iStripeNum << " "
+        << kiWidth << "x" << kiHeight;
+  }
+}
@@ -0,0 +1,202 @@
+#include<gtest/gtest.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+
+#include "typedefs.h"
+#include "macros.h"
+#include "IWelsVP.h"
+
+#define DOWNSAMPLE_TEST_STRIDE 800
+#define DOWNSAMPLE_TEST_HEIGHT 520
+
+// reference of the dyadic and general ratio downsamplers, the SIMD paths have to give the same pixels
+static void DyadicDownsampleRef (uint8_t* pDst, int32_t iDstStride, const uint8_t* pSrc, int32_t iSrcStride,
+                                 int32_t iSrcWidth, int32_t iSrcHeight) {
+  for (int32_t j = 0; j < (iSrcHeight >> 1); j++) {
+    for (int32_t i = 0; i < (iSrcWidth >> 1); i++) {
+      const uint8_t* p = pSrc + 2 * j * iSrcStride + 2 * i;
+      int32_t iRow1 = (p[0] + p[1] + 1) >> 1;
+      int32_t iRow2 = (p[iSrcStride] + p[iSrcStride + 1] + 1) >> 1;
+      pDst[j * iDstStride + i] = (uint8_t) ((iRow1 + iRow2 + 1) >> 1);
+    }
+  }
+}
+
+static void GeneralDownsampleRef (uint8_t* pDst, int32_t iDstStride, int32_t iDstWidth, int32_t iDstHeight,
+                                  const uint8_t* pSrc, int32_t iSrcStride, int32_t iSrcWidth, int32_t iSrcHeight, bool bFast) {
+  const int32_t kiBitX = bFast ? 16 : 15, kiBitY = 15;
+  const int32_t kiScaleX = (int32_t) ((float)iSrcWidth / (float)iDstWidth * (1 << kiBitX));
+  const int32_t kiScaleY = (int32_t) ((float)iSrcHeight / (float)iDstHeight * (1 << kiBitY));
+  for (int32_t j = 0; j < iDstHeight; j++) {
+    const int32_t kiY = (1 << (kiBitY - 1)) + j * kiScaleY;
+    const uint8_t* pRow = pSrc + (kiY >> kiBitY) * iSrcStride;
+    const uint32_t kuiV = kiY & ((1 << kiBitY) - 1);
+    for (int32_t i = 0; i < iDstWidth; i++) {
+      const int32_t kiX = (1 << (kiBitX - 1)) + i * kiScaleX;
+      const uint8_t* p = pRow + (kiX >> kiBitX);
+      const uint32_t kuiU = kiX & ((1 << kiBitX) - 1);
+      const uint32_t kuiUMax = (1 << kiBitX) - 1, kuiVMax = (1 << kiBitY) - 1;
+      int64_t iVal;
+      if (j == iDstHeight - 1 || i == iDstWidth - 1) {
+        iVal = p[0];
+      } else if (bFast) {
+        iVal = ((kuiUMax - kuiU) * (kuiVMax - kuiV) >> 16) * p[0] + (kuiU * (kuiVMax - kuiV) >> 16) * p[1]
+               + ((kuiUMax - kuiU) * kuiV >> 16) * p[iSrcStride] + (kuiU * kuiV >> 16) * p[iSrcStride + 1];
+        iVal = ((iVal >> 14) + 1) >> 1;
+      } else {
+        iVal = ((int64_t) (kuiUMax - kuiU) * (kuiVMax - kuiV) * p[0] + (int64_t)kuiU * (kuiVMax - kuiV) * p[1]
+                + (int64_t) (kuiUMax - kuiU) * kuiV * p[iSrcStride] + (int64_t)kuiU * kuiV * p[iSrcStride + 1]
+                + (1 << 29)) >> 30;
+      }
+      pDst[j * iDstStride + i] = (uint8_t)WELS_CLIP3 (iVal, 0, 255);
+    }
+  }
+}
+
+class DownsampleTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    m_pVp = NULL;
+    CreateVpInterface ((void**)&m_pVp, WELSVP_INTERFACE_VERION);
+    ASSERT_TRUE (NULL != m_pVp);
+    srand ((unsigned int)time (0));
+  }
+  virtual void TearDown() {
+    DestroyVpInterface (m_pVp, WELSVP_INTERFACE_VERION);
+  }
+
+  void InitPixMap (SPixMap* pPixMap, uint8_t* pPlane[3], int32_t iWidth, int32_t iHeight) {
+    memset (pPixMap, 0, sizeof (SPixMap));
+    for (int32_t i = 0; i < 3; i++) {
+      pPixMap->pPixel[i]  = pPlane[i];
+      pPixMap->iStride[i] = DOWNSAMPLE_TEST_STRIDE;
+    }
+    pPixMap->iSizeInBits = 8;
+    pPixMap->sRect.iRectWidth  = iWidth;
+    pPixMap->sRect.iRectHeight = iHeight;
+    pPixMap->eFormat = VIDEO_FORMAT_I420;
+  }
+
+  void DownsampleRef (uint8_t* pDst[3], uint8_t* pSrc[3], int32_t iSrcWidth, int32_t iSrcHeight, int32_t iDstWidth,
+                      int32_t iDstHeight) {
+    const bool kbHalf = (iSrcWidth >> 1) == iDstWidth && (iSrcHeight >> 1) == iDstHeight;
+    for (int32_t i = 0; i < 3; i++) {
+      const int32_t kiShift = i > 0;
+      if (kbHalf)
+        DyadicDownsampleRef (pDst[i], DOWNSAMPLE_TEST_STRIDE, pSrc[i], DOWNSAMPLE_TEST_STRIDE, iSrcWidth >> kiShift,
+                             iSrcHeight >> kiShift);
+      else
+        GeneralDownsampleRef (pDst[i], DOWNSAMPLE_TEST_STRIDE, iDstWidth >> kiShift, iDstHeight >> kiShift, pSrc[i],
+                              DOWNSAMPLE_TEST_STRIDE, iSrcWidth >> kiShift, iSrcHeight >> kiShift, i == 0);
+    }
+  }
+
+  IWelsVP* m_pVp;
+};
+
+#define DOWNSAMPLE_PLANE_SIZE (DOWNSAMPLE_TEST_STRIDE * DOWNSAMPLE_TEST_HEIGHT)
+
+TEST_F (DownsampleTest, ProcessMatchesReference) {
+  uint8_t* pBuf = new uint8_t[DOWNSAMPLE_PLANE_SIZE * 9];
+  uint8_t* pSrc[3] = { pBuf, pBuf + DOWNSAMPLE_PLANE_SIZE, pBuf + DOWNSAMPLE_PLANE_SIZE * 2 };
+  uint8_t* pRef[3] = { pSrc[2] + DOWNSAMPLE_PLANE_SIZE, pSrc[2] + DOWNSAMPLE_PLANE_SIZE * 2,
+                       pSrc[2] + DOWNSAMPLE_PLANE_SIZE * 3
+                     };
+  uint8_t* pDst[3] = { pRef[2] + DOWNSAMPLE_PLANE_SIZE, pRef[2] + DOWNSAMPLE_PLANE_SIZE * 2,
+                       pRef[2] + DOWNSAMPLE_PLANE_SIZE * 3
+                     };
+  SPixMap sSrc, sDst;
+
+  for (int32_t k = 0; k < 100; k++) {
+    const int32_t kiSrcWidth = 16 + rand() % (DOWNSAMPLE_TEST_STRIDE - 16);
+    const int32_t kiSrcHeight = 16 + rand() % (DOWNSAMPLE_TEST_HEIGHT - 16);
+    const bool kbHalf = (k & 1) != 0;
+    const int32_t kiDstWidth = kbHalf ? kiSrcWidth >> 1 : 2 + rand() % (kiSrcWidth - 2);
+    const int32_t kiDstHeight = kbHalf ? kiSrcHeight >> 1 : 2 + rand() % (kiSrcHeight - 2);
+    for (int32_t i = 0; i < DOWNSAMPLE_PLANE_SIZE * 3; i++)
+      pBuf[i] = rand() % 256;
+    memset (pRef[0], 0, DOWNSAMPLE_PLANE_SIZE * 6);
+
+    DownsampleRef (pRef, pSrc, kiSrcWidth, kiSrcHeight, kiDstWidth, kiDstHeight);
+    InitPixMap (&sSrc, pSrc, kiSrcWidth, kiSrcHeight);
+    InitPixMap (&sDst, pDst, kiDstWidth, kiDstHeight);
+    ASSERT_EQ (RET_SUCCESS, m_pVp->Process (METHOD_DOWNSAMPLE, &sSrc, &sDst));
+    ASSERT_EQ (0, memcmp (pRef[0], pDst[0], DOWNSAMPLE_PLANE_SIZE * 3)) << kiSrcWidth << "x" << kiSrcHeight << " -> "
+        << kiDstWidth << "x" << kiDstHeight;
+  }
+  delete [] pBuf;
+}
+
+TEST_F (DownsampleTest, FusedLayersMatchPerLayer) {
+  uint8_t* pBuf = new uint8_t[DOWNSAMPLE_PLANE_SIZE * 3 * (1 + 2 * MAX_DOWNSAMPLE_LAYER_NUM)];
+  uint8_t* pSrc[3] = { pBuf, pBuf + DOWNSAMPLE_PLANE_SIZE, pBuf + DOWNSAMPLE_PLANE_SIZE * 2 };
+  uint8_t* pLayerBuf = pBuf + DOWNSAMPLE_PLANE_SIZE * 3;
+  const int32_t kiLayerBufSize = DOWNSAMPLE_PLANE_SIZE * 3 * MAX_DOWNSAMPLE_LAYER_NUM;
+  SDownsampleLayers sLayers;
+  SPixMap sSrc, sDst;
+
+  for (int32_t k = 0; k < 50; k++) {
+    const int32_t kiSrcWidth = 16 + rand() % (DOWNSAMPLE_TEST_STRIDE - 16);
+    const int32_t kiSrcHeight = 16 + rand() % (DOWNSAMPLE_TEST_HEIGHT - 16);
+    for (int32_t i = 0; i < DOWNSAMPLE_PLANE_SIZE * 3; i++)
+      pBuf[i] = rand() % 256;
+    memset (pLayerBuf, 0, kiLayerBufSize * 2);
+
+    memset (&sLayers, 0, sizeof (sLayers));
+    sLayers.iLayerNum = 1 + rand() % MAX_DOWNSAMPLE_LAYER_NUM;
+    for (int32_t l = 0; l < sLayers.iLayerNum; l++) {
+      const bool kbHalf = (rand() & 1) != 0;
+      const int32_t kiDstWidth = kbHalf ? kiSrcWidth >> 1 : 2 + rand() % (kiSrcWidth - 2);
+      const int32_t kiDstHeight = kbHalf ? kiSrcHeight >> 1 : 2 + rand() % (kiSrcHeight - 2);
+      uint8_t* pLayer = pLayerBuf + DOWNSAMPLE_PLANE_SIZE * 3 * l;
+      uint8_t* pFused[3] = { pLayer, pLayer + DOWNSAMPLE_PLANE_SIZE, pLayer + DOWNSAMPLE_PLANE_SIZE * 2 };
+      uint8_t* pSingle[3] = { pFused[0] + kiLayerBufSize, pFused[1] + kiLayerBufSize, pFused[2] + kiLayerBufSize };
+      InitPixMap (&sLayers.sDstPicMap[l], pFused, kiDstWidth, kiDstHeight);
+      InitPixMap (&sSrc, pSrc, kiSrcWidth, kiSrcHeight);
+      InitPixMap (&sDst, pSingle, kiDstWidth, kiDstHeight);
+      ASSERT_EQ (RET_SUCCESS, m_pVp->Process (METHOD_DOWNSAMPLE, &sSrc, &sDst));
+    }
+    InitPixMap (&sSrc, pSrc, kiSrcWidth, kiSrcHeight);
+    ASSERT_EQ (RET_SUCCESS, m_pVp->SpecialFeature (METHOD_DOWNSAMPLE, &sSrc, &sLayers));
+    ASSERT_EQ (0, memcmp (pLayerBuf, pLayerBuf + kiLayerBufSize, kiLayerBufSize)) << kiSrcWidth << "x" << kiSrcHeight
+        << " layers " << sLayers.iLayerNum;
+  }
+  delete [] pBuf;
+}
+
+TEST_F (DownsampleTest, StripesMatchReference) {
+  uint8_t* pBuf = new uint8_t[DOWNSAMPLE_PLANE_SIZE * 9];
+  uint8_t* pSrc[3] = { pBuf, pBuf + DOWNSAMPLE_PLANE_SIZE, pBuf + DOWNSAMPLE_PLANE_SIZE * 2 };
+  uint8_t* pRef[3] = { pSrc[2] + DOWNSAMPLE_PLANE_SIZE, pSrc[2] + DOWNSAMPLE_PLANE_SIZE * 2,
+                       pSrc[2] + DOWNSAMPLE_PLANE_SIZE * 3
+                     };
+  uint8_t* pDst[3] = { pRef[2] + DOWNSAMPLE_PLANE_SIZE, pRef[2] + DOWNSAMPLE_PLANE_SIZE * 2,
+                       pRef[2] + DOWNSAMPLE_PLANE_SIZE * 3
+                     };
+  SPixMap sSrc, sDst;
+  int32_t iStripeNum = 4;
+
+  ASSERT_EQ (RET_SUCCESS, m_pVp->Set (METHOD_DOWNSAMPLE | METHOD_FLAG_STRIPE_THREADS, &iStripeNum));
+  iStripeNum = 0;
+  ASSERT_EQ (RET_SUCCESS, m_pVp->Get (METHOD_DOWNSAMPLE | METHOD_FLAG_STRIPE_THREADS, &iStripeNum));
+  ASSERT_EQ (4, iStripeNum);
+  for (int32_t k = 0; k < 100; k++) {
+    const int32_t kiSrcWidth = 16 + rand() % (DOWNSAMPLE_TEST_STRIDE - 16);
+    const int32_t kiSrcHeight = 16 + rand() % (DOWNSAMPLE_TEST_HEIGHT - 16);
+    const bool kbHalf = (k & 1) != 0;
+    const int32_t kiDstWidth = kbHalf ? kiSrcWidth >> 1 : 2 + rand() % (kiSrcWidth - 2);
+    const int32_t kiDstHeight = kbHalf ? kiSrcHeight >> 1 : 2 + rand() % (kiSrcHeight - 2);
+    for (int32_t i = 0; i < DOWNSAMPLE_PLANE_SIZE * 3; i++)
+      pBuf[i] = rand() % 256;
+    memset (pRef[0], 0, DOWNSAMPLE_PLANE_SIZE * 6);
+
+    DownsampleRef (pRef, pSrc, kiSrcWidth, kiSrcHeight, kiDstWidth, kiDstHeight);
+    InitPixMap (&sSrc, pSrc, kiSrcWidth, kiSrcHeight);
+    InitPixMap (&sDst, pDst, kiDstWidth, kiDstHeight);
+    ASSERT_EQ (RET_SUCCESS, m_pVp->Process (METHOD_DOWNSAMPLE, &sSrc, &sDst));
+    ASSERT_EQ (0, memcmp (pRef[0], pDst[0], DOWNSAMPLE_PLANE_SIZE * 3)) << kiSrcWidth << "x" << kiSrcHeight << " -> "
+        << kiDstWidth << "x" << kiDstHeight;
+  }
+  delete [] pBuf;
+}
@@ -2,9 +2,9 @@
 
 #include "memory_align.h"
 #include "utils/DataGenerator.h"
+#include "encode_mb_aux.h"
 
 using namespace WelsSVCEnc;
-#include "encode_mb_aux.h"
 
 __align16( const int16_t, g_kiQuantInterFFCompare[104][8] ) = {
 /* 0*/	{   0,     1,     0,     1,     1,     1,     1,     1 },
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "svc_enc_golomb.h"
 #include "macros.h"
 
@@ -39,3 +42,71 @@ TEST(UeExpGolombTest, TestBsSizeUeRangeFrom65535ToPlus256) {
     EXPECT_EQ(uiActVal, uiExpVal);
   }
 }
+
+#define BS_WRITE_TEST_NUM 200
+#define BS_WRITE_SYNTAX_NUM 128
+#define BS_WRITE_BUF_SIZE 1024
+
+//Anchor writer, MSB first
+static void AnchorWriteBits (uint8_t* pBuf, int32_t* pPos, uint32_t uiValue, int32_t iBits) {
+  for (int32_t i = iBits - 1; i >= 0; i--) {
+    if ((uiValue >> i) & 1)
+      pBuf[*pPos >> 3] |= 0x80 >> (*pPos & 7);
+    ++ (*pPos);
+  }
+}
+
+static void AnchorWriteUe (uint8_t* pBuf, int32_t* pPos, uint32_t uiValue) {
+  const uint32_t kuiLeadingZeroBits = (BsSizeUE (uiValue) - 1) >> 1;
+  *pPos += kuiLeadingZeroBits;
+  AnchorWriteBits (pBuf, pPos, uiValue + 1, kuiLeadingZeroBits + 1);
+}
+
+TEST(BsWriteTest, TestWriteBitsUeSe) {
+  uint8_t uiAnchor[BS_WRITE_BUF_SIZE];
+  uint8_t uiBuf[BS_WRITE_BUF_SIZE];
+  SBitStringAux sBs;
+  srand ((unsigned int)time (NULL));
+
+  for (int32_t iTestIdx = 0; iTestIdx < BS_WRITE_TEST_NUM; iTestIdx++) {
+    int32_t iPos = 0;
+    memset (uiAnchor, 0, sizeof (uiAnchor));
+    memset (uiBuf, 0xcc, sizeof (uiBuf));
+    InitBits (&sBs, uiBuf, BS_WRITE_BUF_SIZE);
+
+    for (int32_t i = 0; i < BS_WRITE_SYNTAX_NUM; i++) {
+      switch (rand() % 3) {
+      case 0: {
+        const int32_t kiBits = 1 + rand() % 31;
+        const uint32_t kuiValue = (((uint32_t)rand() << 16) ^ rand()) & ((1U << kiBits) - 1);
+        BsWriteBits (&sBs, kiBits, kuiValue);
+        AnchorWriteBits (uiAnchor, &iPos, kuiValue, kiBits);
+        break;
+      }
+      case 1: {
+        const uint32_t kuiValue = rand() % ((rand() % 4) ? 64 : 65535);
+        BsWriteUE (&sBs, kuiValue);
+        AnchorWriteUe (uiAnchor, &iPos, kuiValue);
+        break;
+      }
+      default: {
+        const int32_t kiValue = rand() % 4097 - 2048;
+        BsWriteSE (&sBs, kiValue);
+        AnchorWriteUe (uiAnchor, &iPos, kiValue <= 0 ? -2 * kiValue : 2 * kiValue - 1);
+        break;
+      }
+      }
+      EXPECT_EQ (iPos, BsGetBitsPos (&sBs));
+    }
+    BsRbspTrailingBits (&sBs);
+    AnchorWriteBits (uiAnchor, &iPos, 1, 1);
+
+    const int32_t kiBytes = (iPos + 7) >> 3;
+    EXPECT_EQ (kiBytes << 3, BsGetBitsPos (&sBs));
+    EXPECT_EQ (0, memcmp (uiAnchor, uiBuf, kiBytes));
+    //nothing written past the data
+    for (int32_t i = kiBytes; i < BS_WRITE_BUF_SIZE; i++) {
+      ASSERT_EQ (0xcc, uiBuf[i]);
+    }
+  }
+}
@@ -148,3 +148,45 @@ TEST(ExpandPicTest, TestExpandPictureChroma_c) {
 
   delete []pRef;
 }
+
+TEST(ExpandPicTest, TestExpandReferencingPictureMbRow) {
+  SWelsFuncPtrList sFuncList;
+  InitExpandPictureFunc( &sFuncList, 0 );
+
+  const int32_t kiPicW = (rand()%128 + 1) << 1;
+  const int32_t kiPicH = (rand()%128 + 1) << 1;
+  const int32_t kiMbHeight = (kiPicH + 15) >> 4;
+  SPicture sPic[2];
+  uint8_t *pBuf[2][3];
+  int32_t iMemSize[3];
+
+  for (int n=0; n<2; n++) {
+    memset(&sPic[n], 0, sizeof(SPicture));
+    sPic[n].iWidthInPixel = kiPicW;
+    sPic[n].iHeightInPixel = kiPicH;
+  }
+  for (int c=0; c<3; c++) {
+    const int32_t kiPaddingLen = c ? (PADDING_LENGTH>>1) : PADDING_LENGTH;
+    const int32_t kiStride = (kiPicW >> !!c) + rand()%16 + kiPaddingLen*2;
+    iMemSize[c] = kiStride * ((kiMbHeight << (4 - !!c)) + kiPaddingLen*2);
+    pBuf[0][c] = new uint8_t[iMemSize[c]];
+    pBuf[1][c] = new uint8_t[iMemSize[c]];
+    for (int i=0; i<iMemSize[c]; i++)
+      pBuf[0][c][i] = pBuf[1][c][i] = rand()%256;
+    for (int n=0; n<2; n++) {
+      sPic[n].iLineSize[c] = kiStride;
+      sPic[n].pData[c] = pBuf[n][c] + kiPaddingLen * kiStride + kiPaddingLen;
+    }
+  }
+
+  ExpandReferencingPicture(&sPic[0], sFuncList.pfExpandLumaPicture, sFuncList.pfExpandChromaPicture);
+  //rows in any order, each once
+  for (int i=kiMbHeight-1; i>=0; i--)
+    ExpandReferencingPictureMbRow(&sPic[1], i);
+
+  for (int c=0; c<3; c++) {
+    EXPECT_EQ(0, memcmp(pBuf[0][c], pBuf[1][c], iMemSize[c]));
+    delete []pBuf[0][c];
+    delete []pBuf[1][c];
+  }
+}
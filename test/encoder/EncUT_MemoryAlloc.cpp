@@ -3,8 +3,6 @@
 #include "gtest/gtest.h"
 #include "memory_align.h"
 
-using namespace WelsSVCEnc;
-
 //Tests of WelsGetCacheLineSize Begin
 TEST(MemoryAlignTest, GetCacheLineSize_LoopWithin16K) {
   const unsigned int kuiTestBoundary16K = 16 * 1024;
@@ -55,3 +53,51 @@ TEST(MemoryAlignTest, WelsMallocAndFreeOnceFunctionVerify) {
     }
   }
 }
+//Tests of WelsMallocAndFree End
+//Tests of idle block pool Begin
+TEST(MemoryAlignTest, PeakMemoryUsage) {
+  CMemoryAlign cTestMa(16);
+  void *pSmall = cTestMa.WelsMalloc(100, "pSmall");
+  void *pBig = cTestMa.WelsMalloc(100000, "pBig");
+  ASSERT_TRUE( pSmall != NULL && pBig != NULL );
+  const uint32_t kuiUsage = cTestMa.WelsGetMemoryUsage();
+  EXPECT_EQ( kuiUsage, cTestMa.WelsGetPeakMemoryUsage() );
+  cTestMa.WelsFree(pBig, "pBig");
+  EXPECT_EQ( kuiUsage, cTestMa.WelsGetPeakMemoryUsage() );
+  cTestMa.WelsFree(pSmall, "pSmall");
+  EXPECT_EQ( 0, cTestMa.WelsGetMemoryUsage() );
+  EXPECT_EQ( kuiUsage, cTestMa.WelsGetPeakMemoryUsage() );
+}
+
+TEST(MemoryAlignTest, ReuseIdleBlocks) {
+  CMemoryAlign cTestMa(64);
+  uint8_t *pBig = static_cast<uint8_t *>(cTestMa.WelsMalloc(100000, "pBig"));
+  uint8_t *pSmall = static_cast<uint8_t *>(cTestMa.WelsMalloc(100, "pSmall"));
+  ASSERT_TRUE( pSmall != NULL && pBig != NULL );
+  cTestMa.WelsFree(pSmall, "pSmall");
+  EXPECT_EQ( 0, cTestMa.WelsGetIdleMemoryUsage() );	// too small to be kept
+  cTestMa.WelsFree(pBig, "pBig");
+  EXPECT_LE( 100000, cTestMa.WelsGetIdleMemoryUsage() );
+
+  // a request of the same size class takes the idle block, zeroed if asked for
+  memset(pBig, 0xff, 100000);
+  uint8_t *pReused = static_cast<uint8_t *>(cTestMa.WelsMallocz(99000, "pReused"));
+  ASSERT_TRUE( pReused != NULL );
+  EXPECT_EQ( pBig, pReused );
+  EXPECT_EQ( 0, cTestMa.WelsGetIdleMemoryUsage() );
+  EXPECT_EQ( 0, ((uintptr_t)pReused) & 63 );
+  for (int i = 0; i < 99000; i++)
+    ASSERT_EQ( 0, pReused[i] );
+  cTestMa.WelsFree(pReused, "pReused");
+
+  // a different size class does not
+  uint8_t *pOther = static_cast<uint8_t *>(cTestMa.WelsMalloc(50000, "pOther"));
+  ASSERT_TRUE( pOther != NULL );
+  EXPECT_LE( 100000, cTestMa.WelsGetIdleMemoryUsage() );
+  cTestMa.WelsFree(pOther, "pOther");
+
+  cTestMa.WelsReleaseIdleBlocks();
+  EXPECT_EQ( 0, cTestMa.WelsGetIdleMemoryUsage() );
+  EXPECT_EQ( 0, cTestMa.WelsGetMemoryUsage() );
+}
+//Tests of idle block pool End
@@ -1,8 +1,10 @@
 #include <stdlib.h>
+#include <math.h>
 #include "gtest/gtest.h"
 #include "utils/DataGenerator.h"
 #include "md.h"
 #include "sample.h"
+#include "sad_common.h"
 #include "svc_motion_estimate.h"
 #include "wels_func_ptr_def.h"
 #include "cpu.h"
@@ -126,6 +128,52 @@ TEST_F(MotionEstimateTest, TestDiamondSearch) {
 }
 
 
+// smooth content moved by a whole number of pixels of the half resolution
+static uint8_t SmoothPixel (const int32_t kiX, const int32_t kiY) {
+  return (uint8_t)WELS_CLIP3 (128 + 60 * sin (kiX / 13.0 + kiY / 29.0) + 50 * cos (kiY / 11.0 - kiX / 37.0), 0, 255);
+}
+
+TEST_F(MotionEstimateTest, TestHalfResolutionSearch) {
+  const int32_t kiMbWidth = 20;
+  const int32_t kiMbHeight = 12;
+  const int32_t kiStride = kiMbWidth << 3;
+  const int32_t kiShift[3][2] = {{0, 0}, {13, -7}, {-22, 18}};
+  uint8_t* pEnc = new uint8_t[kiStride * (kiMbHeight << 3)];
+  uint8_t* pRef = new uint8_t[kiStride * (kiMbHeight << 3)];
+  SMVUnitXY* pMbMv = new SMVUnitXY[kiMbWidth * kiMbHeight];
+  SWelsFuncPtrList sFuncList;
+  WelsInitSampleSadFunc( &sFuncList, 0 );//test c functions
+
+  for (int32_t k = 0; k < 3; k++) {
+    for (int32_t y = 0; y < (kiMbHeight << 3); y++) {
+      for (int32_t x = 0; x < kiStride; x++) {
+        pRef[y * kiStride + x] = SmoothPixel (x, y);
+        pEnc[y * kiStride + x] = SmoothPixel (x + kiShift[k][0], y + kiShift[k][1]);
+      }
+    }
+    HalfResolutionMotionSearch (&sFuncList, pEnc, pRef, kiStride, kiMbWidth, kiMbHeight, pMbMv);
+
+    // every block whose match lies in the picture finds it, in quarter pel of the full resolution
+    int32_t iInside = 0, iFound = 0;
+    for (int32_t iMbY = 0; iMbY < kiMbHeight; iMbY++) {
+      for (int32_t iMbX = 0; iMbX < kiMbWidth; iMbX++) {
+        const int32_t kiX = (iMbX << 3) + kiShift[k][0];
+        const int32_t kiY = (iMbY << 3) + kiShift[k][1];
+        if (kiX < 1 || kiY < 1 || kiX > kiStride - 9 || kiY > (kiMbHeight << 3) - 9)
+          continue;
+        ++ iInside;
+        const SMVUnitXY sMv = pMbMv[iMbY * kiMbWidth + iMbX];
+        if (sMv.iMvX == (kiShift[k][0] << 3) && sMv.iMvY == (kiShift[k][1] << 3))
+          ++ iFound;
+      }
+    }
+    EXPECT_EQ (iInside, iFound) << "shift " << kiShift[k][0] << "," << kiShift[k][1];
+  }
+  delete [] pMbMv;
+  delete [] pRef;
+  delete [] pEnc;
+}
+
 TEST_F(MotionEstimateTest, TestVerticalSearch) {
   const int32_t kiMaxBlock16Sad = 72000;//a rough number
   SWelsFuncPtrList sFuncList;
@@ -316,6 +364,72 @@ TEST_F(MotionEstimateTest, TestVerticalSearch_SSE41)
     //it is possible that ref at differnt position is identical, but that should be under a low probability
   }
 }
+TEST_F(MotionEstimateTest, TestVerticalSearch_AVX2)
+{
+  const int32_t kiMaxBlock16Sad = 72000;//a rough number
+  SWelsFuncPtrList sFuncList;
+  SWelsME sMe;
+
+  srand((uint32_t)time(NULL));
+  const uint8_t kuiQp = rand()%52;
+  InitMe(kuiQp, 648, m_uiMvdTableSize, m_pMvdCostTable, &sMe);
+  int32_t iTmp = 1;
+  uint32_t uiCPUFlags = WelsCPUFeatureDetect( &iTmp);
+  if ((uiCPUFlags & WELS_CPU_AVX2) == 0) return ;
+
+  SMVUnitXY sTargetMv;
+  WelsInitSampleSadFunc( &sFuncList, 0 );//test c functions
+  WelsInitMeFunc(&sFuncList, WELS_CPU_SSE41 | WELS_CPU_AVX2, 1);
+
+  uint8_t *pRefPicCenter = m_pRefPic+(m_iHeight/2)*m_iWidth+(m_iWidth/2);
+  sMe.iCurMeBlockPixX = (m_iWidth/2);
+  sMe.iCurMeBlockPixY = (m_iHeight/2);
+
+  bool bDataGeneratorSucceed = false;
+  bool bFoundMatch = false;
+  int32_t iTryTimes=100;
+
+  sTargetMv.iMvX = 0;
+  sTargetMv.iMvY = WELS_MAX(INTPEL_NEEDED_MARGIN, rand()%m_iHeight-INTPEL_NEEDED_MARGIN);
+  bDataGeneratorSucceed = false;
+  bFoundMatch = false;
+  while (!bFoundMatch && (iTryTimes--)>0) {
+    if (!YUVPixelDataGenerator( m_pRefPic, m_iWidth, m_iHeight, m_iWidth ))
+      continue;
+
+    bDataGeneratorSucceed = true;
+    CopyTargetBlock( m_pSrcBlock, 16, sTargetMv, m_iWidth, pRefPicCenter);
+
+    //clean the sMe status
+    sMe.uiBlockSize = rand()%5;
+    sMe.pEncMb = m_pSrcBlock;
+    sMe.pRefMb = pRefPicCenter;
+    sMe.pColoRefMb = pRefPicCenter;
+    sMe.sMv.iMvX = sMe.sMv.iMvY = 0;
+    sMe.uiSadCost = sMe.uiSatdCost = kiMaxBlock16Sad;
+    const int32_t iCurMeBlockPixX = sMe.iCurMeBlockPixX;
+    const int32_t iCurMeBlockQpelPixX = ((iCurMeBlockPixX)<<2);
+    const int32_t iCurMeBlockPixY = sMe.iCurMeBlockPixY;
+    const int32_t iCurMeBlockQpelPixY = ((iCurMeBlockPixY)<<2);
+    uint16_t* pMvdCostX = sMe.pMvdCost - iCurMeBlockQpelPixX - sMe.sMvp.iMvX;	//do the offset here
+    uint16_t* pMvdCostY = sMe.pMvdCost - iCurMeBlockQpelPixY - sMe.sMvp.iMvY;
+    VerticalFullSearchUsingSSE41 ( &sFuncList, &sMe,
+                      pMvdCostY, pMvdCostX[ iCurMeBlockQpelPixX ],
+                      m_iMaxSearchBlock, m_iWidth,
+                      INTPEL_NEEDED_MARGIN,
+                      m_iHeight-INTPEL_NEEDED_MARGIN, true );
+
+    //the last selection may be affected by MVDcost, that is when smaller MvY will be better
+    bFoundMatch = (sMe.sMv.iMvX==0
+                   &&(sMe.sMv.iMvY==sTargetMv.iMvY||abs(sMe.sMv.iMvY)<abs(sTargetMv.iMvY)));
+    //printf("TestVerticalSearch Target: %d,%d\n", sTargetMv.iMvX, sTargetMv.iMvY);
+  }
+  if (bDataGeneratorSucceed) {
+    //if DataGenerator never succeed, there is no meaning to check iTryTimes
+    ASSERT_TRUE(iTryTimes > 0);
+    //it is possible that ref at differnt position is identical, but that should be under a low probability
+  }
+}
 /*
 TEST_F(MotionEstimateTest, TestHorizontalSearch_SSE41)
 {
@@ -383,4 +497,43 @@ TEST_F(MotionEstimateTest, TestHorizontalSearch_SSE41)
   }
 }
 */
-#endif
\ No newline at end of file
+#endif
+
+#if defined(X86_INTRINSICS)
+// the line search wrappers need the nasm transposes, so check the kernels against the sads of the 8 candidates
+TEST_F(MotionEstimateTest, TestSampleSadHor8_AVX2)
+{
+  int32_t iTmp = 1;
+  uint32_t uiCPUFlags = WelsCPUFeatureDetect( &iTmp);
+  if ((uiCPUFlags & WELS_CPU_AVX2) == 0) return ;
+
+  srand((uint32_t)time(NULL));
+  for (int32_t i = 0; i < m_iWidth*m_iHeight; i++)
+    m_pRefPic[i] = rand()%256;
+  for (int32_t i = 0; i < m_iMaxSearchBlock*m_iMaxSearchBlock; i++)
+    m_pSrcBlock[i] = rand()%256;
+  uint16_t uiBaseCost[8];
+  for (int32_t i = 0; i < 8; i++)
+    uiBaseCost[i] = rand()%1024;
+
+  for (int32_t iBlockSize = 8; iBlockSize <= 16; iBlockSize += 8) {
+    uint32_t uiBestCost = 0xFFFFFFFF;
+    int32_t iBestPos = 0;
+    for (int32_t i = 0; i < 8; i++) {
+      const uint32_t kuiCost = uiBaseCost[i] + (iBlockSize == 8 ?
+                               WelsSampleSad8x8_c( m_pSrcBlock, 8, m_pRefPic+i, m_iWidth ) :
+                               WelsSampleSad16x16_c( m_pSrcBlock, 16, m_pRefPic+i, m_iWidth ));
+      if (kuiCost < uiBestCost) {
+        uiBestCost = kuiCost;
+        iBestPos = i;
+      }
+    }
+    int32_t iIndexMinPos = -1;
+    const uint32_t kuiCost = iBlockSize == 8 ?
+                             SampleSad8x8Hor8_avx2( m_pSrcBlock, 8, m_pRefPic, m_iWidth, uiBaseCost, &iIndexMinPos ) :
+                             SampleSad16x16Hor8_avx2( m_pSrcBlock, 16, m_pRefPic, m_iWidth, uiBaseCost, &iIndexMinPos );
+    EXPECT_EQ(uiBestCost, kuiCost);
+    EXPECT_EQ(iBestPos, iIndexMinPos);
+  }
+}
+#endif//X86_INTRINSICS
\ No newline at end of file
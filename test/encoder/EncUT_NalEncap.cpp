@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <time.h>
+#include "nal_encap.h"
+
+using namespace WelsSVCEnc;
+
+#define NAL_ENCAP_TEST_NUM 1000
+#define NAL_ENCAP_PAYLOAD_SIZE 256
+
+//Anchor function, payload part of WelsEncodeNal() byte by byte
+static int32_t AnchorEmulationPrevention (const uint8_t* pSrc, const int32_t kiSrcLen, uint8_t* pDst) {
+  int32_t iZeroCount = 0;
+  int32_t iDstLen = 0;
+  for (int32_t i = 0; i < kiSrcLen; i++) {
+    if (iZeroCount == 2 && pSrc[i] <= 3) {
+      pDst[iDstLen++] = 3;
+      iZeroCount = 0;
+    }
+    iZeroCount = (pSrc[i] == 0) ? iZeroCount + 1 : 0;
+    pDst[iDstLen++] = pSrc[i];
+  }
+  return iDstLen;
+}
+
+TEST(NalEncapTest, WelsEncodeNal) {
+  uint8_t uiPayload[NAL_ENCAP_PAYLOAD_SIZE];
+  uint8_t uiAnchor[NAL_ENCAP_PAYLOAD_SIZE * 2];
+  uint8_t uiDst[NAL_ENCAP_PAYLOAD_SIZE * 2];
+  SWelsNalRaw sRawNal;
+  srand ((unsigned int)time (NULL));
+
+  for (int32_t iTestIdx = 0; iTestIdx < NAL_ENCAP_TEST_NUM; iTestIdx++) {
+    // sparse zeros so that long runs without them are common
+    const int32_t kiZeroRate = 1 + rand() % 64;
+    for (int32_t i = 0; i < NAL_ENCAP_PAYLOAD_SIZE; i++) {
+      uiPayload[i] = (rand() % kiZeroRate == 0) ? 0 : (rand() % 6 == 0 ? rand() % 4 : 1 + rand() % 255);
+    }
+
+    memset (&sRawNal, 0, sizeof (SWelsNalRaw));
+    sRawNal.pRawData = uiPayload;
+    sRawNal.iPayloadSize = rand() % NAL_ENCAP_PAYLOAD_SIZE;
+    sRawNal.sNalExt.sNalHeader.eNalUnitType = NAL_UNIT_CODED_SLICE;
+    sRawNal.sNalExt.sNalHeader.uiNalRefIdc = NRI_PRI_HIGHEST;
+
+    int32_t iDstLen = 0;
+    ASSERT_EQ (ENC_RETURN_SUCCESS, WelsEncodeNal (&sRawNal, NULL, sizeof (uiDst), uiDst, &iDstLen));
+    ASSERT_LE (iDstLen, WelsGetNalMaxEncodedSize (&sRawNal));
+
+    const int32_t kiAnchorLen = AnchorEmulationPrevention (uiPayload, sRawNal.iPayloadSize, uiAnchor);
+    ASSERT_EQ (kiAnchorLen + 5, iDstLen);	// start code and NAL header
+    EXPECT_EQ (0, memcmp (uiAnchor, uiDst + 5, kiAnchorLen));
+  }
+}
+
+TEST(NalEncapTest, WelsEncodeNalInsufficientBuffer) {
+  uint8_t uiPayload[NAL_ENCAP_PAYLOAD_SIZE] = {0};
+  uint8_t uiDst[NAL_ENCAP_PAYLOAD_SIZE * 2];
+  SWelsNalRaw sRawNal;
+
+  memset (&sRawNal, 0, sizeof (SWelsNalRaw));
+  sRawNal.pRawData = uiPayload;
+  sRawNal.iPayloadSize = NAL_ENCAP_PAYLOAD_SIZE;
+  sRawNal.sNalExt.sNalHeader.eNalUnitType = NAL_UNIT_CODED_SLICE;
+
+  int32_t iDstLen = 0;
+  EXPECT_EQ (ENC_RETURN_MEMALLOCERR, WelsEncodeNal (&sRawNal, NULL, WelsGetNalMaxEncodedSize (&sRawNal) - 1, uiDst,
+             &iDstLen));
+  EXPECT_EQ (ENC_RETURN_SUCCESS, WelsEncodeNal (&sRawNal, NULL, WelsGetNalMaxEncodedSize (&sRawNal), uiDst, &iDstLen));
+}
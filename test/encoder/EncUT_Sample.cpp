@@ -341,7 +341,7 @@ TEST_F(SadSatdCFuncTest, WelsSampleSadFour4x4_c) {
   EXPECT_EQ(m_pSad[0]+m_pSad[1]+m_pSad[2]+m_pSad[3],iSumSad);
 }
 
-#ifdef X86_ASM
+#if defined(X86_INTRINSICS)
 class SadSatdAssemblyFuncTest : public testing::Test {
 public:
   virtual void SetUp() {
@@ -373,6 +373,7 @@ public:
   CMemoryAlign* pMemAlign;
 };
 
+#if defined(X86_ASM)
 TEST_F(SadSatdAssemblyFuncTest, WelsSampleSad4x4_mmx) {
   if (0 == (m_uiCpuFeatureFlag & WELS_CPU_MMXEXT))
     return;
@@ -701,4 +702,177 @@ TEST_F(SadSatdAssemblyFuncTest, WelsSampleSadFour4x4_sse2) {
   WelsSampleSadFour4x4_sse2(m_pPixSrcA, m_iStrideA, m_pPixSrcB+m_iStrideB, m_iStrideB, m_pSad);
   EXPECT_EQ(m_pSad[0]+m_pSad[1]+m_pSad[2]+m_pSad[3],iSumSad);
 }
-#endif
+#endif//X86_ASM
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSad8x8_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<3); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<3); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  EXPECT_EQ(WelsSampleSad8x8_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB), WelsSampleSad8x8_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB));
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSad8x16_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<4); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<4); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  EXPECT_EQ(WelsSampleSad8x16_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB), WelsSampleSad8x16_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB));
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSad16x8_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<3); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<3); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  EXPECT_EQ(WelsSampleSad16x8_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB), WelsSampleSad16x8_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB));
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSad16x16_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<4); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<4); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  EXPECT_EQ(WelsSampleSad16x16_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB), WelsSampleSad16x16_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB));
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSatd8x8_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<3); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<3); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  EXPECT_EQ(WelsSampleSatd8x8_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB), WelsSampleSatd8x8_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB));
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSatd8x16_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<4); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<4); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  EXPECT_EQ(WelsSampleSatd8x16_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB), WelsSampleSatd8x16_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB));
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSatd16x8_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<3); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<3); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  EXPECT_EQ(WelsSampleSatd16x8_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB), WelsSampleSatd16x8_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB));
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSatd16x16_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<4); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<4); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  EXPECT_EQ(WelsSampleSatd16x16_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB), WelsSampleSatd16x16_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB));
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSadFour8x8_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<5); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<5); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  int32_t iSadC[4];
+  WelsSampleSadFour8x8_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB+m_iStrideB+1, m_iStrideB, iSadC);
+  WelsSampleSadFour8x8_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB+m_iStrideB+1, m_iStrideB, m_pSad);
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(iSadC[i], m_pSad[i]);
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSadFour8x16_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<5); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<5); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  int32_t iSadC[4];
+  WelsSampleSadFour8x16_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB+m_iStrideB+1, m_iStrideB, iSadC);
+  WelsSampleSadFour8x16_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB+m_iStrideB+1, m_iStrideB, m_pSad);
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(iSadC[i], m_pSad[i]);
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSadFour16x8_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<5); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<5); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  int32_t iSadC[4];
+  WelsSampleSadFour16x8_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB+m_iStrideB+1, m_iStrideB, iSadC);
+  WelsSampleSadFour16x8_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB+m_iStrideB+1, m_iStrideB, m_pSad);
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(iSadC[i], m_pSad[i]);
+}
+
+TEST_F(SadSatdAssemblyFuncTest, WelsSampleSadFour16x16_avx2) {
+  if (0 == (m_uiCpuFeatureFlag & WELS_CPU_AVX2))
+    return;
+
+  srand((uint32_t)time(NULL));
+  for(int i=0; i<(m_iStrideA<<5); i++)
+    m_pPixSrcA[i]=rand()%256;
+  for(int i=0; i<(m_iStrideB<<5); i++)
+    m_pPixSrcB[i]=rand()%256;
+
+  int32_t iSadC[4];
+  WelsSampleSadFour16x16_c(m_pPixSrcA, m_iStrideA, m_pPixSrcB+m_iStrideB+1, m_iStrideB, iSadC);
+  WelsSampleSadFour16x16_avx2(m_pPixSrcA, m_iStrideA, m_pPixSrcB+m_iStrideB+1, m_iStrideB, m_pSad);
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(iSadC[i], m_pSad[i]);
+}
+#endif//X86_INTRINSICS
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "WelsThreadPool.h"
+
+#define THREAD_POOL_TEST_TASK_NUM 1000
+#define THREAD_POOL_TEST_SUBMITTER_NUM 3
+
+typedef struct TagTaskCounter {
+  WELS_MUTEX	hMutex;
+  int32_t		iDone;
+} STaskCounter;
+
+static void CountTask (void* pArg) {
+  STaskCounter* pCounter = (STaskCounter*)pArg;
+  WelsMutexLock (&pCounter->hMutex);
+  ++ pCounter->iDone;
+  WelsMutexUnlock (&pCounter->hMutex);
+}
+
+static void FlagTask (void* pArg) {
+  ++ * (int32_t*)pArg;	// one task per flag, Wait() makes the writes visible
+}
+
+TEST (ThreadPoolTest, RunAllTasksOfGroup) {
+  SWelsThreadPool* pPool = WelsThreadPoolAcquire (3);
+  ASSERT_TRUE (pPool != NULL);
+  EXPECT_GE (WelsThreadPoolThreadNum (pPool), 1);
+
+  int32_t iFlags[THREAD_POOL_TEST_TASK_NUM] = {0};
+  SWelsTaskGroup sGroup = {0};
+  for (int32_t iRound = 0; iRound < 4; iRound++) {
+    for (int32_t i = 0; i < THREAD_POOL_TEST_TASK_NUM; i++)
+      WelsThreadPoolSubmit (pPool, &sGroup, FlagTask, &iFlags[i]);	// more than the queues hold, some run inline
+    WelsThreadPoolWait (pPool, &sGroup);
+    EXPECT_EQ (0, sGroup.iPending);
+    for (int32_t i = 0; i < THREAD_POOL_TEST_TASK_NUM; i++)
+      ASSERT_EQ (iRound + 1, iFlags[i]);
+  }
+  WelsThreadPoolRelease (pPool);
+}
+
+TEST (ThreadPoolTest, SharedBetweenUsers) {
+  SWelsThreadPool* pPool1 = WelsThreadPoolAcquire (1);
+  ASSERT_TRUE (pPool1 != NULL);
+  SWelsThreadPool* pPool2 = WelsThreadPoolAcquire (2);
+  ASSERT_TRUE (pPool2 != NULL);
+  EXPECT_EQ (pPool1, pPool2);
+  EXPECT_GE (WelsThreadPoolThreadNum (pPool2), 2);
+
+  STaskCounter sCounter1, sCounter2;
+  WelsMutexInit (&sCounter1.hMutex);
+  WelsMutexInit (&sCounter2.hMutex);
+  sCounter1.iDone = sCounter2.iDone = 0;
+  SWelsTaskGroup sGroup1 = {0}, sGroup2 = {0};
+  for (int32_t i = 0; i < THREAD_POOL_TEST_TASK_NUM; i++) {
+    WelsThreadPoolSubmit (pPool1, &sGroup1, CountTask, &sCounter1);
+    WelsThreadPoolSubmit (pPool2, &sGroup2, CountTask, &sCounter2);
+  }
+  WelsThreadPoolWait (pPool2, &sGroup2);
+  EXPECT_EQ (THREAD_POOL_TEST_TASK_NUM, sCounter2.iDone);
+  WelsThreadPoolRelease (pPool2);
+
+  // the pool keeps running for the remaining user
+  WelsThreadPoolWait (pPool1, &sGroup1);
+  EXPECT_EQ (THREAD_POOL_TEST_TASK_NUM, sCounter1.iDone);
+  WelsThreadPoolRelease (pPool1);
+
+  WelsMutexDestroy (&sCounter1.hMutex);
+  WelsMutexDestroy (&sCounter2.hMutex);
+}
+
+typedef struct TagSubmitterCtx {
+  SWelsThreadPool*	pPool;
+  SWelsTaskGroup		sGroup;
+  STaskCounter		sCounter;
+} SSubmitterCtx;
+
+static WELS_THREAD_ROUTINE_TYPE SubmitterProc (void* pArg) {
+  SSubmitterCtx* pCtx = (SSubmitterCtx*)pArg;
+  for (int32_t i = 0; i < THREAD_POOL_TEST_TASK_NUM; i++) {
+    WelsThreadPoolSubmit (pCtx->pPool, &pCtx->sGroup, CountTask, &pCtx->sCounter);
+    if ((i & 63) == 63)
+      WelsThreadPoolWait (pCtx->pPool, &pCtx->sGroup);
+  }
+  WelsThreadPoolWait (pCtx->pPool, &pCtx->sGroup);
+  return 0;
+}
+
+TEST (ThreadPoolTest, ConcurrentSubmitters) {
+  SSubmitterCtx sCtx[THREAD_POOL_TEST_SUBMITTER_NUM];
+  WELS_THREAD_HANDLE hThreads[THREAD_POOL_TEST_SUBMITTER_NUM];
+  SWelsThreadPool* pPool = WelsThreadPoolAcquire (2);
+  ASSERT_TRUE (pPool != NULL);
+
+  for (int32_t i = 0; i < THREAD_POOL_TEST_SUBMITTER_NUM; i++) {
+    sCtx[i].pPool = pPool;
+    sCtx[i].sGroup.iPending = 0;
+    sCtx[i].sCounter.iDone = 0;
+    WelsMutexInit (&sCtx[i].sCounter.hMutex);
+    ASSERT_EQ (WELS_THREAD_ERROR_OK, WelsThreadCreate (&hThreads[i], SubmitterProc, &sCtx[i], 0));
+  }
+  for (int32_t i = 0; i < THREAD_POOL_TEST_SUBMITTER_NUM; i++) {
+    WelsThreadJoin (hThreads[i]);
+    EXPECT_EQ (THREAD_POOL_TEST_TASK_NUM, sCtx[i].sCounter.iDone);
+    EXPECT_EQ (0, sCtx[i].sGroup.iPending);
+    WelsMutexDestroy (&sCtx[i].sCounter.hMutex);
+  }
+  WelsThreadPoolRelease (pPool);
+}
@@ -0,0 +1,155 @@
+#include<gtest/gtest.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+
+#include "typedefs.h"
+#include "macros.h"
+#include "WelsThreadLib.h"
+#include "IWelsVP.h"
+
+#define VAA_TEST_WIDTH  352
+#define VAA_TEST_HEIGHT 288
+#define VAA_TEST_MB_NUM ((VAA_TEST_WIDTH >> 4) * (VAA_TEST_HEIGHT >> 4))
+
+typedef struct TagVaaTestResult {
+  int iSad8x8[VAA_TEST_MB_NUM][4];
+  int iSsd16x16[VAA_TEST_MB_NUM];
+  int iSum16x16[VAA_TEST_MB_NUM];
+  int iSumOfSquare16x16[VAA_TEST_MB_NUM];
+  int iSumOfDiff8x8[VAA_TEST_MB_NUM][4];
+  unsigned char uiMad8x8[VAA_TEST_MB_NUM][4];
+} SVaaTestResult;
+
+class VaaCalculationTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    m_pVp = NULL;
+    CreateVpInterface ((void**)&m_pVp, WELSVP_INTERFACE_VERION);
+    ASSERT_TRUE (NULL != m_pVp);
+    srand ((unsigned int)time (0));
+  }
+  virtual void TearDown() {
+    DestroyVpInterface (m_pVp, WELSVP_INTERFACE_VERION);
+  }
+
+  void InitPixMap (SPixMap* pPixMap, uint8_t* pY, int32_t iWidth, int32_t iHeight) {
+    memset (pPixMap, 0, sizeof (SPixMap));
+    pPixMap->pPixel[0]  = pY;
+    pPixMap->iStride[0] = VAA_TEST_WIDTH;
+    pPixMap->iSizeInBits = 8;
+    pPixMap->sRect.iRectWidth  = iWidth;
+    pPixMap->sRect.iRectHeight = iHeight;
+    pPixMap->eFormat = VIDEO_FORMAT_I420;
+  }
+
+  // every flag combination runs a different kernel
+  int32_t Calculate (int32_t iMode, SPixMap* pCur, SPixMap* pRef, SVaaTestResult* pOut) {
+    SVAACalcResult sResult;
+    SVAACalcParam sParam;
+    memset (pOut, 0, sizeof (SVaaTestResult));
+    memset (&sResult, 0, sizeof (sResult));
+    sResult.pSad8x8           = pOut->iSad8x8;
+    sResult.pSsd16x16         = pOut->iSsd16x16;
+    sResult.pSum16x16         = pOut->iSum16x16;
+    sResult.pSumOfSquare16x16 = pOut->iSumOfSquare16x16;
+    sResult.pSumOfDiff8x8     = pOut->iSumOfDiff8x8;
+    sResult.pMad8x8           = pOut->uiMad8x8;
+    memset (&sParam, 0, sizeof (sParam));
+    sParam.iCalcBgd    = iMode & 1;
+    sParam.iCalcSsd    = (iMode >> 1) & 1;
+    sParam.iCalcVar    = (iMode >> 2) & 1;
+    sParam.pCalcResult = &sResult;
+    EXPECT_EQ (RET_SUCCESS, m_pVp->Set (METHOD_VAA_STATISTICS, &sParam));
+    EXPECT_EQ (RET_SUCCESS, m_pVp->Process (METHOD_VAA_STATISTICS, pCur, pRef));
+    return sResult.iFrameSad;
+  }
+
+  IWelsVP* m_pVp;
+};
+
+TEST_F (VaaCalculationTest, StripesMatchSingleThread) {
+  uint8_t* pCurY = new uint8_t[VAA_TEST_WIDTH * VAA_TEST_HEIGHT];
+  uint8_t* pRefY = new uint8_t[VAA_TEST_WIDTH * VAA_TEST_HEIGHT];
+  SVaaTestResult* pSingle = new SVaaTestResult;
+  SVaaTestResult* pStripes = new SVaaTestResult;
+  SPixMap sCur, sRef;
+
+  for (int32_t k = 0; k < 40; k++) {
+    const int32_t kiWidth = 16 * (1 + rand() % (VAA_TEST_WIDTH >> 4));
+    const int32_t kiHeight = 16 * (1 + rand() % (VAA_TEST_HEIGHT >> 4));
+    const int32_t kiMode = k % 6;
+    for (int32_t i = 0; i < VAA_TEST_WIDTH * VAA_TEST_HEIGHT; i++) {
+      pCurY[i] = rand() % 256;
+      pRefY[i] = WELS_CLIP3 (pCurY[i] + rand() % 17 - 8, 0, 255);
+    }
+    InitPixMap (&sCur, pCurY, kiWidth, kiHeight);
+    InitPixMap (&sRef, pRefY, kiWidth, kiHeight);
+
+    int32_t iStripeNum = 1;
+    ASSERT_EQ (RET_SUCCESS, m_pVp->Set (METHOD_VAA_STATISTICS | METHOD_FLAG_STRIPE_THREADS, &iStripeNum));
+    const int32_t kiSingleSad = Calculate (kiMode, &sCur, &sRef, pSingle);
+    iStripeNum = 2 + rand() % 6;
+    ASSERT_EQ (RET_SUCCESS, m_pVp->Set (METHOD_VAA_STATISTICS | METHOD_FLAG_STRIPE_THREADS, &iStripeNum));
+    const int32_t kiStripesSad = Calculate (kiMode, &sCur, &sRef, pStripes);
+
+    ASSERT_EQ (kiSingleSad, kiStripesSad) << kiWidth << "x" << kiHeight << " mode " << kiMode;
+    ASSERT_EQ (0, memcmp (pSingle, pStripes, sizeof (SVaaTestResult))) << kiWidth << "x" << kiHeight << " mode " << kiMode;
+  }
+  delete pStripes;
+  delete pSingle;
+  delete [] pRefY;
+  delete [] pCurY;
+}
+
+typedef struct TagDownsampleThreadArg {
+  IWelsVP* pVp;
+  SPixMap  sSrc;
+  SPixMap  sDst;
+  int32_t  iFailed;
+} SDownsampleThreadArg;
+
+static WELS_THREAD_ROUTINE_TYPE DownsampleThreadProc (void* pArg) {
+  SDownsampleThreadArg* pDownsample = (SDownsampleThreadArg*)pArg;
+  for (int32_t i = 0; i < 50; i++) {
+    if (RET_SUCCESS != pDownsample->pVp->Process (METHOD_DOWNSAMPLE, &pDownsample->sSrc, &pDownsample->sDst))
+      ++ pDownsample->iFailed;
+  }
+  WELS_THREAD_ROUTINE_RETURN (0);
+}
+
+TEST_F (VaaCalculationTest, ConcurrentWithOtherMethod) {
+  uint8_t* pCurY = new uint8_t[VAA_TEST_WIDTH * VAA_TEST_HEIGHT * 3];
+  uint8_t* pRefY = pCurY + VAA_TEST_WIDTH * VAA_TEST_HEIGHT;
+  uint8_t* pHalf = pRefY + VAA_TEST_WIDTH * VAA_TEST_HEIGHT;
+  SVaaTestResult* pExpected = new SVaaTestResult;
+  SVaaTestResult* pResult = new SVaaTestResult;
+  SDownsampleThreadArg sArg;
+  SPixMap sCur, sRef;
+  WELS_THREAD_HANDLE hThread;
+
+  for (int32_t i = 0; i < VAA_TEST_WIDTH * VAA_TEST_HEIGHT * 2; i++)
+    pCurY[i] = rand() % 256;
+  InitPixMap (&sCur, pCurY, VAA_TEST_WIDTH, VAA_TEST_HEIGHT);
+  InitPixMap (&sRef, pRefY, VAA_TEST_WIDTH, VAA_TEST_HEIGHT);
+  const int32_t kiExpectedSad = Calculate (2, &sCur, &sRef, pExpected);
+
+  // the reference picture is downsampled by another thread meanwhile, both planes of chroma on the luma one
+  memset (&sArg, 0, sizeof (sArg));
+  sArg.pVp = m_pVp;
+  InitPixMap (&sArg.sSrc, pRefY, VAA_TEST_WIDTH, VAA_TEST_HEIGHT);
+  InitPixMap (&sArg.sDst, pHalf, VAA_TEST_WIDTH >> 1, VAA_TEST_HEIGHT >> 1);
+  sArg.sSrc.pPixel[1] = sArg.sSrc.pPixel[2] = pRefY;
+  sArg.sDst.pPixel[1] = sArg.sDst.pPixel[2] = pHalf + (VAA_TEST_WIDTH >> 1);
+  ASSERT_EQ (WELS_THREAD_ERROR_OK, WelsThreadCreate (&hThread, DownsampleThreadProc, &sArg, 0));
+  for (int32_t i = 0; i < 50; i++) {
+    EXPECT_EQ (kiExpectedSad, Calculate (2, &sCur, &sRef, pResult));
+    EXPECT_EQ (0, memcmp (pExpected, pResult, sizeof (SVaaTestResult)));
+  }
+  WelsThreadJoin (hThread);
+  EXPECT_EQ (0, sArg.iFailed);
+
+  delete pResult;
+  delete pExpected;
+  delete [] pCurY;
+}
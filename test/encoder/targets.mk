@@ -1,6 +1,8 @@
 ENCODER_UNITTEST_SRCDIR=test/encoder
 ENCODER_UNITTEST_CPP_SRCS=\
+	$(ENCODER_UNITTEST_SRCDIR)/EncUT_ColorspaceConvert.cpp\
 	$(ENCODER_UNITTEST_SRCDIR)/EncUT_DecodeMbAux.cpp\
+	$(ENCODER_UNITTEST_SRCDIR)/EncUT_Downsample.cpp\
 	$(ENCODER_UNITTEST_SRCDIR)/EncUT_EncoderMb.cpp\
 	$(ENCODER_UNITTEST_SRCDIR)/EncUT_EncoderMbAux.cpp\
 	$(ENCODER_UNITTEST_SRCDIR)/EncUT_ExpandPic.cpp\
@@ -8,7 +10,10 @@ ENCODER_UNITTEST_CPP_SRCS=\
 	$(ENCODER_UNITTEST_SRCDIR)/EncUT_GetIntraPredictor.cpp\
 	$(ENCODER_UNITTEST_SRCDIR)/EncUT_MemoryAlloc.cpp\
 	$(ENCODER_UNITTEST_SRCDIR)/EncUT_MotionEstimate.cpp\
-        $(ENCODER_UNITTEST_SRCDIR)/EncUT_Sample.cpp\
+	$(ENCODER_UNITTEST_SRCDIR)/EncUT_NalEncap.cpp\
+	$(ENCODER_UNITTEST_SRCDIR)/EncUT_Sample.cpp\
+	$(ENCODER_UNITTEST_SRCDIR)/EncUT_ThreadPool.cpp\
+	$(ENCODER_UNITTEST_SRCDIR)/EncUT_VaaCalculation.cpp\
 
 ENCODER_UNITTEST_OBJS += $(ENCODER_UNITTEST_CPP_SRCS:.cpp=.$(OBJ))
 